@@ -0,0 +1,18 @@
+#include "ubench.h"
+#include "ubitset_bench.h"
+#include "ubtree_bench.h"
+#include "uhash_bench.h"
+#include "ustring_bench.h"
+#include "utime_bench.h"
+#include "utrace_bench.h"
+#include "uvec_bench.h"
+
+ubench_main({
+    ubench_run("ubitset", UBITSET_BENCHES);
+    ubench_run("ubtree", UBTREE_BENCHES);
+    ubench_run("uhash", UHASH_BENCHES);
+    ubench_run("ustring", USTRING_BENCHES);
+    ubench_run("utime", UTIME_BENCHES);
+    ubench_run("utrace", UTRACE_BENCHES);
+    ubench_run("uvec", UVEC_BENCHES);
+})
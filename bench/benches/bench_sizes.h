@@ -0,0 +1,42 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef BENCH_SIZES_H
+#define BENCH_SIZES_H
+
+#include "ubench.h"
+
+// Problem sizes of the container benchmarks.
+static size_t const bench_sizes[] = { 1U << 8U, 1U << 12U, 1U << 16U, 1U << 20U };
+
+// Largest problem size, the highest power of two that fits in ulib_uint.
+#define BENCH_SIZE_MAX ((ulib_uint)((ULIB_UINT_MAX >> 1U) + 1U))
+
+// Returns the i-th problem size, clamped to BENCH_SIZE_MAX.
+static inline ulib_uint bench_size(size_t i) {
+    return bench_sizes[i] > BENCH_SIZE_MAX ? BENCH_SIZE_MAX : (ulib_uint)bench_sizes[i];
+}
+
+/*
+ * Runs a benchmark case for each problem size. Fixtures of type T are created by the
+ * T make(ulib_uint n) factory, and released by void deinit(T *ctx). Sizes above
+ * BENCH_SIZE_MAX are only run once, clamped to BENCH_SIZE_MAX.
+ */
+#define bench_run_sizes(T, name, fn, make, deinit)                                                 \
+    do {                                                                                           \
+        for (size_t p_bench_i = 0; p_bench_i < ulib_array_count(bench_sizes); ++p_bench_i) {       \
+            ulib_uint const p_bench_n = bench_size(p_bench_i);                                     \
+            T p_bench_ctx = make(p_bench_n);                                                       \
+            ubench_case(name, p_bench_n, fn, &p_bench_ctx);                                        \
+            deinit(&p_bench_ctx);                                                                  \
+            if (p_bench_n == BENCH_SIZE_MAX) break;                                                \
+        }                                                                                          \
+    } while (0)
+
+#endif // BENCH_SIZES_H
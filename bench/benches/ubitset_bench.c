@@ -0,0 +1,76 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "ubitset_bench.h"
+#include "bench_sizes.h"
+#include "ubench.h"
+#include "ubitset.h"
+#include "urand.h"
+
+typedef struct BenchBits {
+    UBitSet a;
+    UBitSet b;
+} BenchBits;
+
+// Bitsets with about one bit in eight set.
+static BenchBits bench_bits(ulib_uint n) {
+    BenchBits ctx = { ubitset(), ubitset() };
+    URandGen gen = urand_gen(n);
+    ubitset_resize(&ctx.a, n);
+    ubitset_resize(&ctx.b, n);
+    for (ulib_uint i = 0; i < n; ++i) {
+        uint64_t const r = urand_gen_next(&gen);
+        if (!(r & 7U)) ubitset_set(&ctx.a, i);
+        if (!((r >> 8U) & 7U)) ubitset_set(&ctx.b, i);
+    }
+    return ctx;
+}
+
+static void bench_bits_deinit(BenchBits *ctx) {
+    ubitset_deinit(&ctx->a);
+    ubitset_deinit(&ctx->b);
+}
+
+static void bench_and(void *ctx, size_t iterations) {
+    BenchBits *c = (BenchBits *)ctx;
+    for (size_t i = 0; i < iterations; ++i) {
+        ubitset_and(&c->a, &c->b);
+        ubench_do_not_optimize(&c->a);
+    }
+}
+
+static void bench_count(void *ctx, size_t iterations) {
+    BenchBits *c = (BenchBits *)ctx;
+    ulib_uint sum = 0;
+    for (size_t i = 0; i < iterations; ++i) sum += ubitset_count_set(&c->a);
+    ubench_do_not_optimize(&sum);
+}
+
+static void bench_foreach(void *ctx, size_t iterations) {
+    BenchBits *c = (BenchBits *)ctx;
+    ulib_uint sum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        ubitset_foreach (&c->a, bit) {
+            sum += bit;
+        }
+    }
+    ubench_do_not_optimize(&sum);
+}
+
+void ubitset_bench_and(void) {
+    bench_run_sizes(BenchBits, "and", bench_and, bench_bits, bench_bits_deinit);
+}
+
+void ubitset_bench_count(void) {
+    bench_run_sizes(BenchBits, "count", bench_count, bench_bits, bench_bits_deinit);
+}
+
+void ubitset_bench_foreach(void) {
+    bench_run_sizes(BenchBits, "foreach", bench_foreach, bench_bits, bench_bits_deinit);
+}
@@ -0,0 +1,19 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UBITSET_BENCH_H
+#define UBITSET_BENCH_H
+
+void ubitset_bench_and(void);
+void ubitset_bench_count(void);
+void ubitset_bench_foreach(void);
+
+#define UBITSET_BENCHES ubitset_bench_and, ubitset_bench_count, ubitset_bench_foreach
+
+#endif // UBITSET_BENCH_H
@@ -0,0 +1,118 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "ubtree_bench.h"
+#include "bench_sizes.h"
+#include "ubench.h"
+#include "ubtree.h"
+#include "urand.h"
+#include "uvec_builtin.h"
+
+UBTREE_INIT(BenchTree, ulib_uint, ulib_uint, ubtree_identical, ubtree_less_than)
+
+typedef struct BenchTree {
+    UBTree(BenchTree) tree;
+    UVec(ulib_uint) src;
+    ulib_uint n;
+    ulib_uint next;
+} BenchTree;
+
+// Keys are sorted and unique, with random gaps narrow enough for the keys to fit in ulib_uint.
+static BenchTree bench_tree(ulib_uint n) {
+    BenchTree ctx = { ubtree(BenchTree), uvec(ulib_uint), n, 0 };
+    URandGen gen = urand_gen(n);
+    ulib_uint const gap = ulib_min(16U, ULIB_UINT_MAX / n);
+    for (ulib_uint i = 0, key = 0; i < n; ++i) {
+        key += 1 + (ulib_uint)(urand_gen_next(&gen) % gap);
+        uvec_push(ulib_uint, &ctx.src, key);
+    }
+    return ctx;
+}
+
+static void bench_tree_deinit(BenchTree *ctx) {
+    ubtree_deinit(BenchTree, &ctx->tree);
+    uvec_deinit(ulib_uint, &ctx->src);
+}
+
+static BenchTree bench_tree_loaded(ulib_uint n) {
+    BenchTree ctx = bench_tree(n);
+    ulib_uint const *keys = uvec_data(ulib_uint, &ctx.src);
+    ubtree_from_sorted(BenchTree, &ctx.tree, keys, keys, ctx.n);
+    return ctx;
+}
+
+static void bench_tree_reset(BenchTree *ctx) {
+    ubench_pause();
+    ubtree_deinit(BenchTree, &ctx->tree);
+    ctx->next = 0;
+    ubench_resume();
+}
+
+// Trees grow from empty, in random key order.
+static void bench_insert(void *ctx, size_t iterations) {
+    BenchTree *c = (BenchTree *)ctx;
+    ulib_uint const *data = uvec_data(ulib_uint, &c->src);
+    for (size_t i = 0; i < iterations; ++i) {
+        if (c->next == c->n) bench_tree_reset(c);
+        ulib_uint const key = data[((ulib_uint)c->next++ * 7919U) % c->n];
+        ubmap_set(BenchTree, &c->tree, key, key, NULL);
+    }
+}
+
+// Trees grow from empty, in increasing key order, as when indexing time-ordered data.
+static void bench_append(void *ctx, size_t iterations) {
+    BenchTree *c = (BenchTree *)ctx;
+    ulib_uint const *data = uvec_data(ulib_uint, &c->src);
+    for (size_t i = 0; i < iterations; ++i) {
+        if (c->next == c->n) bench_tree_reset(c);
+        ulib_uint const key = data[c->next++];
+        ubmap_set(BenchTree, &c->tree, key, key, NULL);
+    }
+}
+
+static void bench_search(void *ctx, size_t iterations) {
+    BenchTree *c = (BenchTree *)ctx;
+    ulib_uint const *data = uvec_data(ulib_uint, &c->src);
+    ulib_uint sum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        ulib_uint const key = data[(c->next++ * 7919U) % c->n];
+        sum += ubmap_get(BenchTree, &c->tree, key, 0);
+    }
+    ubench_do_not_optimize(&sum);
+}
+
+// Each iteration visits the keys in a range of width 512, about 60 keys on average.
+static void bench_range(void *ctx, size_t iterations) {
+    BenchTree *c = (BenchTree *)ctx;
+    ulib_uint const *data = uvec_data(ulib_uint, &c->src);
+    ulib_uint sum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        ulib_uint const start = data[(c->next++ * 7919U) % c->n];
+        ubtree_foreach_range (BenchTree, &c->tree, start, start + 512U, loop) {
+            sum += *loop.val;
+        }
+    }
+    ubench_do_not_optimize(&sum);
+}
+
+void ubtree_bench_insert(void) {
+    bench_run_sizes(BenchTree, "insert", bench_insert, bench_tree, bench_tree_deinit);
+}
+
+void ubtree_bench_append(void) {
+    bench_run_sizes(BenchTree, "append", bench_append, bench_tree, bench_tree_deinit);
+}
+
+void ubtree_bench_search(void) {
+    bench_run_sizes(BenchTree, "search", bench_search, bench_tree_loaded, bench_tree_deinit);
+}
+
+void ubtree_bench_range(void) {
+    bench_run_sizes(BenchTree, "range", bench_range, bench_tree_loaded, bench_tree_deinit);
+}
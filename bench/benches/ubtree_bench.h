@@ -0,0 +1,21 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UBTREE_BENCH_H
+#define UBTREE_BENCH_H
+
+void ubtree_bench_insert(void);
+void ubtree_bench_append(void);
+void ubtree_bench_search(void);
+void ubtree_bench_range(void);
+
+#define UBTREE_BENCHES                                                                             \
+    ubtree_bench_insert, ubtree_bench_append, ubtree_bench_search, ubtree_bench_range
+
+#endif // UBTREE_BENCH_H
@@ -0,0 +1,113 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "uhash_bench.h"
+#include "bench_sizes.h"
+#include "ubench.h"
+#include "uhash.h"
+
+UHASH_INIT(BenchSplit, uint32_t, uint32_t, uhash_int32_hash, uhash_identical)
+UHASH_INIT_INTERLEAVED(BenchSlot, uint32_t, uint32_t, uhash_int32_hash, uhash_identical)
+
+// Multiplying by an odd constant is a bijection, so generated keys are distinct.
+#define bench_key(i) ((uint32_t)((i)*0x9e3779b9U))
+
+#define BenchCtx(T) P_ULIB_MACRO_CONCAT(BenchCtx_, T)
+
+// Defines the benchmarks of the T hash table type.
+#define BENCH_HASH_DEF(T)                                                                          \
+    typedef struct BenchCtx(T) {                                                                   \
+        UHash(T) h;                                                                                \
+        ulib_uint n;                                                                               \
+        ulib_uint next;                                                                            \
+    } BenchCtx(T);                                                                                 \
+                                                                                                   \
+    static void bench_fill_##T(BenchCtx(T) *ctx) {                                                 \
+        for (ulib_uint i = 0; i < ctx->n; ++i) uhmap_set(T, &ctx->h, bench_key(i), i, NULL);       \
+        ctx->next = 0;                                                                             \
+    }                                                                                              \
+                                                                                                   \
+    static BenchCtx(T) bench_ctx_##T(ulib_uint n) {                                                \
+        BenchCtx(T) ctx = { uhmap(T), n, 0 };                                                      \
+        return ctx;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    static BenchCtx(T) bench_filled_##T(ulib_uint n) {                                             \
+        BenchCtx(T) ctx = bench_ctx_##T(n);                                                        \
+        bench_fill_##T(&ctx);                                                                      \
+        return ctx;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    static void bench_ctx_deinit_##T(BenchCtx(T) *ctx) {                                           \
+        uhash_deinit(T, &ctx->h);                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    /* Tables grow from empty, so that resizing is part of the measurement. */                     \
+    static void bench_put_##T(void *ctx, size_t iterations) {                                      \
+        BenchCtx(T) *c = (BenchCtx(T) *)ctx;                                                       \
+        for (size_t i = 0; i < iterations; ++i) {                                                  \
+            if (c->next == c->n) {                                                                 \
+                ubench_pause();                                                                    \
+                uhash_deinit(T, &c->h);                                                            \
+                c->h = uhmap(T);                                                                   \
+                c->next = 0;                                                                       \
+                ubench_resume();                                                                   \
+            }                                                                                      \
+            uhmap_set(T, &c->h, bench_key(c->next), c->next, NULL);                                \
+            c->next++;                                                                             \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static void bench_get_##T(void *ctx, size_t iterations) {                                      \
+        BenchCtx(T) *c = (BenchCtx(T) *)ctx;                                                       \
+        uint32_t sum = 0;                                                                          \
+        for (size_t i = 0; i < iterations; ++i) {                                                  \
+            sum += uhmap_get(T, &c->h, bench_key((c->next++ * 7919U) % c->n), 0);                  \
+        }                                                                                          \
+        ubench_do_not_optimize(&sum);                                                              \
+    }                                                                                              \
+                                                                                                   \
+    static void bench_delete_##T(void *ctx, size_t iterations) {                                   \
+        BenchCtx(T) *c = (BenchCtx(T) *)ctx;                                                       \
+        for (size_t i = 0; i < iterations; ++i) {                                                  \
+            if (c->next == c->n) {                                                                 \
+                ubench_pause();                                                                    \
+                bench_fill_##T(c);                                                                 \
+                ubench_resume();                                                                   \
+            }                                                                                      \
+            uhmap_remove(T, &c->h, bench_key(c->next));                                            \
+            c->next++;                                                                             \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static void bench_run_##T(char const *name, ubench_fn fn, bool fill) {                         \
+        if (fill) {                                                                                \
+            bench_run_sizes(BenchCtx(T), name, fn, bench_filled_##T, bench_ctx_deinit_##T);        \
+        } else {                                                                                   \
+            bench_run_sizes(BenchCtx(T), name, fn, bench_ctx_##T, bench_ctx_deinit_##T);           \
+        }                                                                                          \
+    }
+
+BENCH_HASH_DEF(BenchSplit)
+BENCH_HASH_DEF(BenchSlot)
+
+void uhash_bench_put(void) {
+    bench_run_BenchSplit("put/split", bench_put_BenchSplit, false);
+    bench_run_BenchSlot("put/interleaved", bench_put_BenchSlot, false);
+}
+
+void uhash_bench_get(void) {
+    bench_run_BenchSplit("get/split", bench_get_BenchSplit, true);
+    bench_run_BenchSlot("get/interleaved", bench_get_BenchSlot, true);
+}
+
+void uhash_bench_delete(void) {
+    bench_run_BenchSplit("delete/split", bench_delete_BenchSplit, true);
+    bench_run_BenchSlot("delete/interleaved", bench_delete_BenchSlot, true);
+}
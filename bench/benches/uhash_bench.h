@@ -0,0 +1,19 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UHASH_BENCH_H
+#define UHASH_BENCH_H
+
+void uhash_bench_put(void);
+void uhash_bench_get(void);
+void uhash_bench_delete(void);
+
+#define UHASH_BENCHES uhash_bench_put, uhash_bench_get, uhash_bench_delete
+
+#endif // UHASH_BENCH_H
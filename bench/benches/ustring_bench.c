@@ -0,0 +1,109 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "ustring_bench.h"
+#include "ubench.h"
+#include "ustring.h"
+
+#define BENCH_STRINGS 256U
+#define BENCH_MAX_LENGTH 1024U
+
+// Lengths around the inline capacity of small strings, and longer ones.
+static size_t const bench_lengths[] = { 8, 15, 23, 31, 48, 64, 256, BENCH_MAX_LENGTH };
+
+typedef struct BenchStrings {
+    char buf[BENCH_STRINGS][BENCH_MAX_LENGTH + 1];
+    UString strings[BENCH_STRINGS];
+    UString needle;
+    size_t len;
+    ulib_uint next;
+} BenchStrings;
+
+static BenchStrings bench_ctx;
+
+// Builds distinct strings of the specified length, which must be at least 8,
+// ending with the needle searched by the find benchmark.
+static BenchStrings *bench_strings(size_t len) {
+    BenchStrings *ctx = &bench_ctx;
+    ctx->len = len;
+    ctx->next = 0;
+    ctx->needle = ustring_literal("needle");
+
+    for (size_t i = 0; i < BENCH_STRINGS; ++i) {
+        char *str = ctx->buf[i];
+        memset(str, 'a' + (int)(i % 26), len);
+        str[0] = (char)('A' + i % 26);
+        str[1] = (char)('A' + i / 26 % 26);
+        memcpy(str + len - 6, "needle", 6);
+        str[len] = '\0';
+        ctx->strings[i] = ustring_wrap(str, len);
+    }
+
+    return ctx;
+}
+
+static void bench_copy(void *ctx, size_t iterations) {
+    BenchStrings *c = (BenchStrings *)ctx;
+    for (size_t i = 0; i < iterations; ++i) {
+        UString str = ustring_copy(c->buf[c->next++ % BENCH_STRINGS], c->len);
+        ubench_do_not_optimize(&str);
+        ustring_deinit(&str);
+    }
+}
+
+static void bench_hash(void *ctx, size_t iterations) {
+    BenchStrings *c = (BenchStrings *)ctx;
+    ulib_uint sum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        sum += ustring_hash(c->strings[c->next++ % BENCH_STRINGS]);
+    }
+    ubench_do_not_optimize(&sum);
+}
+
+static void bench_find(void *ctx, size_t iterations) {
+    BenchStrings *c = (BenchStrings *)ctx;
+    ulib_uint sum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        sum += ustring_find(c->strings[c->next++ % BENCH_STRINGS], c->needle);
+    }
+    ubench_do_not_optimize(&sum);
+}
+
+static void bench_format(void *ctx, size_t iterations) {
+    BenchStrings *c = (BenchStrings *)ctx;
+    int const len = (int)c->len - 8;
+    for (size_t i = 0; i < iterations; ++i) {
+        UString str = ustring_with_format("%.*s-%06u", len, c->buf[c->next++ % BENCH_STRINGS],
+                                          (unsigned)(i % 1000000));
+        ubench_do_not_optimize(&str);
+        ustring_deinit(&str);
+    }
+}
+
+static void bench_run(char const *name, ubench_fn fn) {
+    for (size_t i = 0; i < ulib_array_count(bench_lengths); ++i) {
+        ubench_case(name, (ulib_uint)bench_lengths[i], fn, bench_strings(bench_lengths[i]));
+    }
+}
+
+void ustring_bench_copy(void) {
+    bench_run("copy", bench_copy);
+}
+
+void ustring_bench_hash(void) {
+    bench_run("hash", bench_hash);
+}
+
+void ustring_bench_find(void) {
+    bench_run("find", bench_find);
+}
+
+void ustring_bench_format(void) {
+    bench_run("format", bench_format);
+}
@@ -0,0 +1,21 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef USTRING_BENCH_H
+#define USTRING_BENCH_H
+
+void ustring_bench_copy(void);
+void ustring_bench_hash(void);
+void ustring_bench_find(void);
+void ustring_bench_format(void);
+
+#define USTRING_BENCHES                                                                            \
+    ustring_bench_copy, ustring_bench_hash, ustring_bench_find, ustring_bench_format
+
+#endif // USTRING_BENCH_H
@@ -0,0 +1,74 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "utime_bench.h"
+#include "ubench.h"
+#include "utime.h"
+
+// Timestamps advance by one millisecond per iteration, as when stamping log lines.
+#define BENCH_START_MS 1690000000000LL
+
+static void bench_from_timestamp(ulib_unused void *ctx, size_t iterations) {
+    char buf[UTIME_FORMAT_SIZE];
+    for (size_t i = 0; i < iterations; ++i) {
+        UTime const time = utime_from_timestamp((BENCH_START_MS + (utime_stamp)i) / 1000);
+        utime_format(&time, buf);
+        ubench_do_not_optimize(buf);
+    }
+}
+
+static void bench_cache(ulib_unused void *ctx, size_t iterations) {
+    UTimeCache cache = utime_cache();
+    for (size_t i = 0; i < iterations; ++i) {
+        ulib_uint len;
+        char const *str = utime_cache_format(&cache, BENCH_START_MS + (utime_stamp)i,
+                                             UTIME_MILLISECONDS, &len);
+        ubench_do_not_optimize(str);
+    }
+}
+
+static void bench_cache_now(ulib_unused void *ctx, size_t iterations) {
+    UTimeCache cache = utime_cache();
+    for (size_t i = 0; i < iterations; ++i) {
+        ulib_uint len;
+        char const *str = utime_cache_now(&cache, UTIME_MICROSECONDS, &len);
+        ubench_do_not_optimize(str);
+    }
+}
+
+static void bench_parse(void *ctx, size_t iterations) {
+    UString const *str = (UString const *)ctx;
+    UTime time;
+    for (size_t i = 0; i < iterations; ++i) {
+        utime_parse(&time, NULL, ustring_data(*str), ustring_length(*str));
+        ubench_do_not_optimize(&time);
+    }
+}
+
+static void bench_from_string(void *ctx, size_t iterations) {
+    UString const *str = (UString const *)ctx;
+    UTime time;
+    for (size_t i = 0; i < iterations; ++i) {
+        utime_from_string(&time, str);
+        ubench_do_not_optimize(&time);
+    }
+}
+
+void utime_bench_format(void) {
+    ubench_case("format", 1, bench_from_timestamp, NULL);
+    ubench_case("cache_format", 1, bench_cache, NULL);
+    ubench_case("cache_now", 1, bench_cache_now, NULL);
+}
+
+void utime_bench_parse(void) {
+    UString fixed = ustring_literal("2023-07-22T04:26:40Z");
+    UString lenient = ustring_literal("2023 7 22 4.26.40");
+    ubench_case("parse", 1, bench_parse, &fixed);
+    ubench_case("from_string_lenient", 1, bench_from_string, &lenient);
+}
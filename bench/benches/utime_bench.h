@@ -0,0 +1,18 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UTIME_BENCH_H
+#define UTIME_BENCH_H
+
+void utime_bench_format(void);
+void utime_bench_parse(void);
+
+#define UTIME_BENCHES utime_bench_format, utime_bench_parse
+
+#endif // UTIME_BENCH_H
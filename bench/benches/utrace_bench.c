@@ -0,0 +1,43 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "utrace_bench.h"
+#include "ubench.h"
+#include "utrace.h"
+
+// Reference for the cost of the tick counter.
+static void bench_clock(ulib_unused void *ctx, size_t iterations) {
+    utime_ns sum = 0;
+    for (size_t i = 0; i < iterations; ++i) sum += utime_get_ns();
+    ubench_do_not_optimize(&sum);
+}
+
+static void bench_ticks(ulib_unused void *ctx, size_t iterations) {
+    utrace_tick sum = 0;
+    for (size_t i = 0; i < iterations; ++i) sum += utrace_ticks();
+    ubench_do_not_optimize(&sum);
+}
+
+static void bench_span(ulib_unused void *ctx, size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+        utrace_scope("bench") {
+            ubench_do_not_optimize(&i);
+        }
+    }
+}
+
+void utrace_bench_ticks(void) {
+    ubench_case("utime_get_ns", 1, bench_clock, NULL);
+    ubench_case("ticks", 1, bench_ticks, NULL);
+}
+
+void utrace_bench_span(void) {
+    ubench_case("span", 1, bench_span, NULL);
+    utrace_reset();
+}
@@ -0,0 +1,18 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UTRACE_BENCH_H
+#define UTRACE_BENCH_H
+
+void utrace_bench_ticks(void);
+void utrace_bench_span(void);
+
+#define UTRACE_BENCHES utrace_bench_ticks, utrace_bench_span
+
+#endif // UTRACE_BENCH_H
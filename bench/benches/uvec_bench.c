@@ -0,0 +1,90 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "uvec_bench.h"
+#include "bench_sizes.h"
+#include "ubench.h"
+#include "urand.h"
+#include "uvec_builtin.h"
+
+typedef struct BenchVec {
+    UVec(ulib_uint) vec;
+    UVec(ulib_uint) src;
+    ulib_uint n;
+    ulib_uint next;
+} BenchVec;
+
+static BenchVec bench_vec(ulib_uint n) {
+    BenchVec ctx = { uvec(ulib_uint), uvec(ulib_uint), n, 0 };
+    URandGen gen = urand_gen(n);
+    for (ulib_uint i = 0; i < n; ++i) {
+        uvec_push(ulib_uint, &ctx.src, (ulib_uint)urand_gen_next(&gen));
+    }
+    return ctx;
+}
+
+static BenchVec bench_vec_sorted(ulib_uint n) {
+    BenchVec ctx = bench_vec(n);
+    uvec_sort(ulib_uint, &ctx.src);
+    return ctx;
+}
+
+static void bench_vec_deinit(BenchVec *ctx) {
+    uvec_deinit(ulib_uint, &ctx->vec);
+    uvec_deinit(ulib_uint, &ctx->src);
+}
+
+// Vectors grow from empty, so that reallocation is part of the measurement.
+static void bench_push(void *ctx, size_t iterations) {
+    BenchVec *c = (BenchVec *)ctx;
+    for (size_t i = 0; i < iterations; ++i) {
+        if (c->next == c->n) {
+            ubench_pause();
+            uvec_deinit(ulib_uint, &c->vec);
+            c->vec = uvec(ulib_uint);
+            c->next = 0;
+            ubench_resume();
+        }
+        uvec_push(ulib_uint, &c->vec, c->next++);
+    }
+}
+
+// Each iteration sorts the whole vector.
+static void bench_sort(void *ctx, size_t iterations) {
+    BenchVec *c = (BenchVec *)ctx;
+    for (size_t i = 0; i < iterations; ++i) {
+        ubench_pause();
+        uvec_copy(ulib_uint, &c->src, &c->vec);
+        ubench_resume();
+        uvec_sort(ulib_uint, &c->vec);
+    }
+}
+
+static void bench_search(void *ctx, size_t iterations) {
+    BenchVec *c = (BenchVec *)ctx;
+    ulib_uint const *data = uvec_data(ulib_uint, &c->src);
+    ulib_uint sum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        ulib_uint const item = data[(c->next++ * 7919U) % c->n];
+        sum += uvec_index_of_sorted(ulib_uint, &c->src, item);
+    }
+    ubench_do_not_optimize(&sum);
+}
+
+void uvec_bench_push(void) {
+    bench_run_sizes(BenchVec, "push", bench_push, bench_vec, bench_vec_deinit);
+}
+
+void uvec_bench_sort(void) {
+    bench_run_sizes(BenchVec, "sort", bench_sort, bench_vec, bench_vec_deinit);
+}
+
+void uvec_bench_search(void) {
+    bench_run_sizes(BenchVec, "search", bench_search, bench_vec_sorted, bench_vec_deinit);
+}
@@ -0,0 +1,19 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UVEC_BENCH_H
+#define UVEC_BENCH_H
+
+void uvec_bench_push(void);
+void uvec_bench_sort(void);
+void uvec_bench_search(void);
+
+#define UVEC_BENCHES uvec_bench_push, uvec_bench_sort, uvec_bench_search
+
+#endif // UVEC_BENCH_H
@@ -12,6 +12,9 @@
 #ifndef UALLOC_H
 #define UALLOC_H
 
+#include "ucompat.h"
+#include <stddef.h>
+
 /**
  * Declares the default allocator and allows specifying custom allocators.
  *
@@ -69,6 +72,63 @@
  */
 #define ulib_alloc(ptr) ulib_malloc(sizeof(*(ptr)))
 
+/**
+ * Allocator interface, for data structures that support custom allocators at runtime.
+ */
+typedef struct UAllocator {
+
+    /// Allocator context, passed to the allocation functions.
+    void *ctx;
+
+    /**
+     * Allocates or reallocates memory.
+     *
+     * @param ctx Allocator context.
+     * @param ptr Pointer to the memory area to reallocate, or NULL to allocate a new one.
+     * @param old_size Size of the memory area to reallocate, or zero if ptr is NULL.
+     * @param size Size of the memory area to allocate.
+     * @return Pointer to the beginning of the allocated memory, or NULL on failure.
+     */
+    void *(*alloc)(void *ctx, void *ptr, size_t old_size, size_t size);
+
+    /**
+     * Deallocates memory.
+     *
+     * @param ctx Allocator context.
+     * @param ptr Pointer to the memory area to deallocate.
+     * @param size Size of the memory area.
+     */
+    void (*dealloc)(void *ctx, void *ptr, size_t size);
+
+} UAllocator;
+
 /// @}
 
+// Private API
+
+#if defined(ULIB_PROFILE)
+
+ULIB_BEGIN_DECLS
+
+ULIB_PUBLIC
+void *p_uprof_malloc_impl(size_t size, char const *file, char const *fn, int line);
+
+ULIB_PUBLIC
+void *p_uprof_calloc_impl(size_t num, size_t size, char const *file, char const *fn, int line);
+
+ULIB_PUBLIC
+void *p_uprof_realloc_impl(void *ptr, size_t size, char const *file, char const *fn, int line);
+
+ULIB_PUBLIC
+void p_uprof_free_impl(void *ptr);
+
+ULIB_END_DECLS
+
+#define p_uprof_malloc(size) p_uprof_malloc_impl(size, __FILE__, __func__, __LINE__)
+#define p_uprof_calloc(num, size) p_uprof_calloc_impl(num, size, __FILE__, __func__, __LINE__)
+#define p_uprof_realloc(ptr, size) p_uprof_realloc_impl(ptr, size, __FILE__, __func__, __LINE__)
+#define p_uprof_free(ptr) p_uprof_free_impl(ptr)
+
+#endif
+
 #endif // UALLOC_H
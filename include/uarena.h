@@ -0,0 +1,295 @@
+/**
+ * Memory arenas and pools.
+ *
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UARENA_H
+#define UARENA_H
+
+#include "ualloc.h"
+#include "ustd.h"
+
+ULIB_BEGIN_DECLS
+
+/**
+ * Default size of the storage chunks allocated by a memory arena, in bytes.
+ *
+ * @note Can be overridden at compile time.
+ */
+#ifndef UARENA_CHUNK_SIZE
+#define UARENA_CHUNK_SIZE 65536
+#endif
+
+/// @cond
+typedef struct P_UArenaChunk P_UArenaChunk;
+/// @endcond
+
+/**
+ * Memory arena, also known as region allocator.
+ *
+ * Allocations are carved out of large chunks by bumping a pointer, and are released
+ * all at once by resetting or deinitializing the arena. Chunks are retained on reset,
+ * so that an arena that is reused, e.g. once per request, stops allocating
+ * after the first few uses.
+ *
+ * @note Allocations are aligned for any object type.
+ */
+typedef struct UArena {
+    /// @cond
+    P_UArenaChunk *_head;
+    P_UArenaChunk *_chunk;
+    size_t _used;
+    size_t _chunk_size;
+    /// @endcond
+} UArena;
+
+/// Position in a memory arena, to which the arena can be reset.
+typedef struct UArenaMark {
+    /// @cond
+    P_UArenaChunk *_chunk;
+    size_t _used;
+    /// @endcond
+} UArenaMark;
+
+/**
+ * Initializes a new memory arena.
+ *
+ * @param chunk_size Size of the storage chunks, or zero to use @ref UARENA_CHUNK_SIZE.
+ * @return Initialized arena.
+ *
+ * @note No memory is allocated until the first allocation.
+ *
+ * @public @memberof UArena
+ */
+ULIB_PUBLIC
+UArena uarena(size_t chunk_size);
+
+/**
+ * Deinitializes a memory arena, releasing all its memory.
+ *
+ * @param arena Arena.
+ *
+ * @public @memberof UArena
+ */
+ULIB_PUBLIC
+void uarena_deinit(UArena *arena);
+
+/**
+ * Allocates memory from the arena.
+ *
+ * @param arena Arena.
+ * @param size Number of bytes to allocate.
+ * @return Pointer to the allocated memory, or NULL on failure.
+ *
+ * @note Allocations larger than the chunk size get a dedicated chunk.
+ *
+ * @public @memberof UArena
+ */
+ULIB_PUBLIC
+void *uarena_alloc(UArena *arena, size_t size);
+
+/**
+ * Resizes memory allocated from the arena.
+ *
+ * @param arena Arena.
+ * @param ptr Memory to resize, or NULL to allocate new memory.
+ * @param old_size Size of the memory to resize.
+ * @param size New size.
+ * @return Pointer to the resized memory, or NULL on failure.
+ *
+ * @note The most recent allocation is resized in place if possible,
+ *       otherwise the data is copied to a new allocation.
+ *
+ * @public @memberof UArena
+ */
+ULIB_PUBLIC
+void *uarena_realloc(UArena *arena, void *ptr, size_t old_size, size_t size);
+
+/**
+ * Checks whether the specified memory has been allocated from the arena.
+ *
+ * @param arena Arena.
+ * @param ptr Pointer to the memory.
+ * @return True if the memory belongs to the arena, false otherwise.
+ *
+ * @public @memberof UArena
+ */
+ULIB_PUBLIC
+bool uarena_owns(UArena const *arena, void const *ptr);
+
+/**
+ * Returns the current position of the arena.
+ *
+ * @param arena Arena.
+ * @return Position.
+ *
+ * @public @memberof UArena
+ */
+ULIB_INLINE
+UArenaMark uarena_mark(UArena const *arena) {
+    UArenaMark mark = { arena->_chunk, arena->_used };
+    return mark;
+}
+
+/**
+ * Releases all the memory allocated after the specified position.
+ *
+ * @param arena Arena.
+ * @param mark Position, obtained via `uarena_mark`.
+ *
+ * @public @memberof UArena
+ */
+ULIB_INLINE
+void uarena_reset_to(UArena *arena, UArenaMark mark) {
+    arena->_chunk = mark._chunk;
+    arena->_used = mark._used;
+}
+
+/**
+ * Releases all the memory allocated from the arena, retaining its chunks for reuse.
+ *
+ * @param arena Arena.
+ *
+ * @public @memberof UArena
+ */
+ULIB_INLINE
+void uarena_reset(UArena *arena) {
+    arena->_chunk = NULL;
+    arena->_used = 0;
+}
+
+/**
+ * Returns an allocator that allocates from the arena, for use with data structures
+ * that support per-instance allocators.
+ *
+ * @param arena Arena.
+ * @return Allocator.
+ *
+ * @note Deallocating is a no-op, unless the memory is the most recent allocation.
+ *
+ * @public @memberof UArena
+ */
+ULIB_PUBLIC
+UAllocator uarena_allocator(UArena *arena);
+
+#if defined(ULIB_ALLOC_SCOPES)
+
+/**
+ * Makes `ulib_malloc`, `ulib_calloc`, `ulib_realloc` and `ulib_free` allocate from
+ * the specified arena on the calling thread, until `uarena_scope_end` is called.
+ *
+ * This affects every allocation made by the library, so that vectors, hash tables,
+ * strings and string buffers used within the scope do not allocate from the heap,
+ * and are released in bulk when the arena is reset.
+ *
+ * @param arena Arena, or NULL to allocate from the heap.
+ * @return Arena of the enclosing scope, to be passed to `uarena_scope_end`.
+ *
+ * @note Freeing or reallocating heap memory within the scope is supported.
+ *       Memory allocated within the scope must not be freed or reallocated outside of it.
+ * @note Scopes are per thread: threads started within the scope, such as those of
+ *       parallel algorithms and asynchronous streams, allocate from the heap.
+ * @note Only available if the library has been built with the `ULIB_ALLOC_SCOPES` option.
+ *
+ * @public @memberof UArena
+ */
+ULIB_PUBLIC
+UArena *uarena_scope_begin(UArena *arena);
+
+/**
+ * Ends an allocation scope started by `uarena_scope_begin`.
+ *
+ * @param prev Arena of the enclosing scope.
+ *
+ * @public @memberof UArena
+ */
+ULIB_PUBLIC
+void uarena_scope_end(UArena *prev);
+
+/// @cond
+ULIB_PUBLIC
+void *p_uarena_scope_malloc(size_t size);
+
+ULIB_PUBLIC
+void *p_uarena_scope_calloc(size_t num, size_t size);
+
+ULIB_PUBLIC
+void *p_uarena_scope_realloc(void *ptr, size_t size);
+
+ULIB_PUBLIC
+void p_uarena_scope_free(void *ptr);
+/// @endcond
+
+#endif
+
+/**
+ * Pool of fixed-size objects.
+ *
+ * Objects are carved out of chunks holding several of them, and released objects
+ * are recycled by subsequent allocations, so that allocating and releasing objects
+ * is constant time and does not touch the heap once the pool has grown large enough.
+ */
+typedef struct UPool {
+    /// @cond
+    void *_free;
+    void *_chunks;
+    size_t _size;
+    size_t _count;
+    /// @endcond
+} UPool;
+
+/**
+ * Initializes a new object pool.
+ *
+ * @param size Size of the objects.
+ * @param count Number of objects per chunk, or zero to fill @ref UARENA_CHUNK_SIZE bytes.
+ * @return Initialized pool.
+ *
+ * @note No memory is allocated until the first allocation.
+ *
+ * @public @memberof UPool
+ */
+ULIB_PUBLIC
+UPool upool(size_t size, size_t count);
+
+/**
+ * Deinitializes an object pool, releasing all its objects at once.
+ *
+ * @param pool Pool.
+ *
+ * @public @memberof UPool
+ */
+ULIB_PUBLIC
+void upool_deinit(UPool *pool);
+
+/**
+ * Allocates an object from the pool.
+ *
+ * @param pool Pool.
+ * @return Pointer to the object, or NULL on failure.
+ *
+ * @public @memberof UPool
+ */
+ULIB_PUBLIC
+void *upool_alloc(UPool *pool);
+
+/**
+ * Returns an object to the pool.
+ *
+ * @param pool Pool.
+ * @param ptr Object, allocated from the same pool.
+ *
+ * @public @memberof UPool
+ */
+ULIB_PUBLIC
+void upool_free(UPool *pool, void *ptr);
+
+ULIB_END_DECLS
+
+#endif // UARENA_H
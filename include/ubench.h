@@ -0,0 +1,232 @@
+/**
+ * Essential benchmarking utilities.
+ *
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UBENCH_H
+#define UBENCH_H
+
+#include "ustd.h"
+#include "ustream.h"
+#include "utime.h"
+
+ULIB_BEGIN_DECLS
+
+/**
+ * Essential benchmarking utilities.
+ *
+ * Benchmarks are functions that run the benchmarked operation a given number
+ * of times. Each benchmark is warmed up, then the harness picks the number of
+ * iterations so that a sample lasts about @ref UBenchConfig.sample_time, and
+ * collects @ref UBenchConfig.samples samples. Results are reported per iteration.
+ *
+ * @defgroup bench UBench
+ * @{
+ */
+
+/**
+ * Maximum number of samples per benchmark.
+ *
+ * @note Can be overridden at compile time.
+ */
+#ifndef UBENCH_MAX_SAMPLES
+#define UBENCH_MAX_SAMPLES 1000
+#endif
+
+/// Output formats of benchmark results.
+typedef enum ubench_format {
+
+    /// Human-readable text.
+    UBENCH_FORMAT_TEXT = 0,
+
+    /// Comma-separated values, one benchmark per line.
+    UBENCH_FORMAT_CSV,
+
+    /// JSON array of objects, one per benchmark.
+    UBENCH_FORMAT_JSON
+
+} ubench_format;
+
+/// Benchmark configuration.
+typedef struct UBenchConfig {
+
+    /// Output format.
+    ubench_format format;
+
+    /// Output stream, or NULL for the standard output.
+    UOStream *stream;
+
+    /// Only run benchmarks whose "group/name" contains this string, if not NULL.
+    char const *filter;
+
+    /// Number of samples.
+    unsigned samples;
+
+    /// Target duration of each sample.
+    utime_ns sample_time;
+
+    /// Minimum duration of the warmup phase.
+    utime_ns warmup_time;
+
+} UBenchConfig;
+
+/// Benchmark results, in nanoseconds per iteration.
+typedef struct UBenchResult {
+
+    /// Number of iterations per sample.
+    size_t iterations;
+
+    /// Number of samples.
+    unsigned samples;
+
+    /// Fastest sample.
+    double min;
+
+    /// Median.
+    double median;
+
+    /// 99th percentile.
+    double p99;
+
+    /// Mean.
+    double mean;
+
+    /// Standard deviation.
+    double stddev;
+
+} UBenchResult;
+
+/**
+ * Benchmark function.
+ *
+ * @param ctx Benchmark context.
+ * @param iterations Number of times the benchmarked operation must be run.
+ */
+typedef void (*ubench_fn)(void *ctx, size_t iterations);
+
+/**
+ * Defines the main benchmark function.
+ *
+ * Recognized command line arguments:
+ *
+ * - `--csv`, `--json`: output format.
+ * - `--quick`: fewer and shorter samples, e.g. for smoke tests.
+ * - Any other argument: only run benchmarks whose "group/name" contains it.
+ *
+ * @param CODE Code to execute, generally a sequence of ubench_run statements.
+ */
+#define ubench_main(CODE)                                                                          \
+    int main(int argc, char **argv) {                                                              \
+        setbuf(stdout, NULL);                                                                      \
+        if (!ubench_start(argc, argv)) return EXIT_FAILURE;                                        \
+        { CODE }                                                                                   \
+        ubench_end();                                                                              \
+        return EXIT_SUCCESS;                                                                       \
+    }
+
+/**
+ * Runs a benchmark batch.
+ *
+ * @param NAME Name of the benchmark batch (must be a string literal).
+ * @param ... Comma separated list of [void] -> void functions, generally
+ *            a sequence of ubench_case statements.
+ */
+#define ubench_run(NAME, ...)                                                                      \
+    do {                                                                                           \
+        p_ubench_group(NAME);                                                                      \
+        void (*benches_to_run[])(void) = { __VA_ARGS__ };                                          \
+        for (size_t bench_i = 0; bench_i < ulib_array_count(benches_to_run); ++bench_i) {          \
+            benches_to_run[bench_i]();                                                             \
+        }                                                                                          \
+    } while (0)
+
+/**
+ * Prevents the compiler from optimizing away the computation of the pointed data.
+ *
+ * @param ptr [void const *] Pointer to the data.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define ubench_do_not_optimize(ptr) __asm__ __volatile__("" : : "g"(ptr) : "memory")
+#else
+#define ubench_do_not_optimize(ptr) p_ubench_escape(ptr)
+#endif
+
+/**
+ * Returns the benchmark configuration, which can be modified before running benchmarks.
+ *
+ * @return Configuration.
+ */
+ULIB_PUBLIC
+UBenchConfig *ubench_config(void);
+
+/**
+ * Parses the command line arguments and starts the benchmark output.
+ *
+ * @param argc Number of arguments.
+ * @param argv Arguments.
+ * @return True on success, false if the arguments are invalid.
+ */
+ULIB_PUBLIC
+bool ubench_start(int argc, char **argv);
+
+/**
+ * Ends the benchmark output.
+ */
+ULIB_PUBLIC
+void ubench_end(void);
+
+/**
+ * Measures the specified benchmark.
+ *
+ * @param fn Benchmark function.
+ * @param ctx Benchmark context.
+ * @return Results.
+ */
+ULIB_PUBLIC
+UBenchResult ubench_measure(ubench_fn fn, void *ctx);
+
+/**
+ * Measures the specified benchmark and reports its results, unless it is filtered out.
+ *
+ * @param name Name of the benchmark.
+ * @param size Problem size, reported alongside the results.
+ * @param fn Benchmark function.
+ * @param ctx Benchmark context.
+ */
+ULIB_PUBLIC
+void ubench_case(char const *name, ulib_uint size, ubench_fn fn, void *ctx);
+
+/**
+ * Stops the clock, e.g. to reset the state of the benchmark between iterations.
+ *
+ * @note Pausing and resuming takes a few tens of nanoseconds,
+ *       so it should not be done on every iteration of fast operations.
+ */
+ULIB_PUBLIC
+void ubench_pause(void);
+
+/**
+ * Restarts the clock after a call to @ref ubench_pause.
+ */
+ULIB_PUBLIC
+void ubench_resume(void);
+
+/// @}
+
+// Private API
+
+ULIB_PUBLIC
+void p_ubench_group(char const *name);
+
+ULIB_PUBLIC
+void p_ubench_escape(void const *ptr);
+
+ULIB_END_DECLS
+
+#endif // UBENCH_H
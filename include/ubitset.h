@@ -0,0 +1,327 @@
+/**
+ * Dynamic bitsets.
+ *
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UBITSET_H
+#define UBITSET_H
+
+#include "ulib_ret.h"
+#include "ustd.h"
+
+ULIB_BEGIN_DECLS
+
+/**
+ * A growable set of bits, stored as an array of 64-bit words.
+ *
+ * Bulk operations process two words at a time via SIMD instructions, when available.
+ * Bits past the size of the bitset are never set, so they can be ignored by bulk operations.
+ */
+typedef struct UBitSet {
+    /// @cond
+    uint64_t *_words;
+    ulib_uint _size;
+    ulib_uint _capacity;
+    /// @endcond
+} UBitSet;
+
+/**
+ * Iterates over the set bits of the bitset, in increasing order.
+ *
+ * @param set [UBitSet const *] Bitset.
+ * @param bit [symbol] Name of the variable holding the index of the current bit.
+ *
+ * @note Bits set or unset while iterating, past the current one, are visited or skipped.
+ *
+ * @public @related UBitSet
+ */
+#define ubitset_foreach(set, bit)                                                                  \
+    for (ulib_uint bit = ubitset_next_set(set, 0); bit != ubitset_size(set);                       \
+         bit = ubitset_next_set(set, bit + 1))
+
+/**
+ * Returns a new, empty bitset.
+ *
+ * @return Bitset.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_INLINE
+UBitSet ubitset(void) {
+    UBitSet set = { NULL, 0, 0 };
+    return set;
+}
+
+/**
+ * Deinitializes the bitset.
+ *
+ * @param set Bitset.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_PUBLIC
+void ubitset_deinit(UBitSet *set);
+
+/**
+ * Returns the size of the bitset, in bits.
+ *
+ * @param set Bitset.
+ * @return Size.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_INLINE
+ulib_uint ubitset_size(UBitSet const *set) {
+    return set->_size;
+}
+
+/**
+ * Ensures that the bitset can hold the specified number of bits without reallocating.
+ *
+ * @param set Bitset.
+ * @param size Number of bits.
+ * @return Return code.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_PUBLIC
+ulib_ret ubitset_reserve(UBitSet *set, ulib_uint size);
+
+/**
+ * Resizes the bitset. New bits are unset, and bits past the new size are discarded.
+ *
+ * @param set Bitset.
+ * @param size New size, in bits.
+ * @return Return code.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_PUBLIC
+ulib_ret ubitset_resize(UBitSet *set, ulib_uint size);
+
+/**
+ * Copies the bitset.
+ *
+ * @param src Source bitset.
+ * @param dest Destination bitset.
+ * @return Return code.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_PUBLIC
+ulib_ret ubitset_copy(UBitSet const *src, UBitSet *dest);
+
+/**
+ * Checks whether the specified bit is set.
+ *
+ * @param set Bitset.
+ * @param bit Bit index.
+ * @return True if the bit is set, false otherwise, or if the bit is past the size of the bitset.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_INLINE
+bool ubitset_is_set(UBitSet const *set, ulib_uint bit) {
+    return bit < set->_size && ((set->_words[bit / 64] >> (bit % 64)) & 1U);
+}
+
+/**
+ * Sets the specified bit, growing the bitset if needed.
+ *
+ * @param set Bitset.
+ * @param bit Bit index.
+ * @return Return code.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_PUBLIC
+ulib_ret ubitset_set(UBitSet *set, ulib_uint bit);
+
+/**
+ * Unsets the specified bit.
+ *
+ * @param set Bitset.
+ * @param bit Bit index. Bits past the size of the bitset are ignored.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_INLINE
+void ubitset_unset(UBitSet *set, ulib_uint bit) {
+    if (bit < set->_size) set->_words[bit / 64] &= ~((uint64_t)1 << (bit % 64));
+}
+
+/**
+ * Sets the bits in the specified range, growing the bitset if needed.
+ *
+ * @param set Bitset.
+ * @param start Index of the first bit.
+ * @param len Number of bits.
+ * @return Return code.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_PUBLIC
+ulib_ret ubitset_set_range(UBitSet *set, ulib_uint start, ulib_uint len);
+
+/**
+ * Unsets the bits in the specified range.
+ *
+ * @param set Bitset.
+ * @param start Index of the first bit.
+ * @param len Number of bits. Bits past the size of the bitset are ignored.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_PUBLIC
+void ubitset_unset_range(UBitSet *set, ulib_uint start, ulib_uint len);
+
+/**
+ * Unsets all the bits, retaining the size of the bitset.
+ *
+ * @param set Bitset.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_PUBLIC
+void ubitset_clear(UBitSet *set);
+
+/**
+ * Returns the number of set bits.
+ *
+ * @param set Bitset.
+ * @return Number of set bits.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_PUBLIC
+ulib_uint ubitset_count_set(UBitSet const *set);
+
+/**
+ * Returns the number of set bits in the specified range.
+ *
+ * @param set Bitset.
+ * @param start Index of the first bit.
+ * @param len Number of bits.
+ * @return Number of set bits.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_PUBLIC
+ulib_uint ubitset_count_set_range(UBitSet const *set, ulib_uint start, ulib_uint len);
+
+/**
+ * Returns the index of the first set bit starting from the specified one.
+ *
+ * @param set Bitset.
+ * @param start Index of the first bit to check.
+ * @return Index of the set bit, or the size of the bitset if there is none.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_PUBLIC
+ulib_uint ubitset_next_set(UBitSet const *set, ulib_uint start);
+
+/**
+ * Returns the index of the first unset bit starting from the specified one.
+ *
+ * @param set Bitset.
+ * @param start Index of the first bit to check.
+ * @return Index of the unset bit, or the size of the bitset if there is none.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_PUBLIC
+ulib_uint ubitset_next_unset(UBitSet const *set, ulib_uint start);
+
+/**
+ * Intersects the bitset with another one. The size of the bitset is unchanged.
+ *
+ * @param set Bitset.
+ * @param other Other bitset.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_PUBLIC
+void ubitset_and(UBitSet *set, UBitSet const *other);
+
+/**
+ * Unsets the bits of the bitset that are set in another one. The size of the bitset is unchanged.
+ *
+ * @param set Bitset.
+ * @param other Other bitset.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_PUBLIC
+void ubitset_and_not(UBitSet *set, UBitSet const *other);
+
+/**
+ * Merges another bitset into the bitset, growing it to the size of the other bitset if needed.
+ *
+ * @param set Bitset.
+ * @param other Other bitset.
+ * @return Return code.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_PUBLIC
+ulib_ret ubitset_or(UBitSet *set, UBitSet const *other);
+
+/**
+ * Toggles the bits of the bitset that are set in another one,
+ * growing it to the size of the other bitset if needed.
+ *
+ * @param set Bitset.
+ * @param other Other bitset.
+ * @return Return code.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_PUBLIC
+ulib_ret ubitset_xor(UBitSet *set, UBitSet const *other);
+
+/**
+ * Checks whether two bitsets have the same set bits, regardless of their size.
+ *
+ * @param a First bitset.
+ * @param b Second bitset.
+ * @return True if the bitsets are equal, false otherwise.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_PUBLIC
+bool ubitset_equals(UBitSet const *a, UBitSet const *b);
+
+/**
+ * Checks whether all the set bits of a bitset are also set in another one.
+ *
+ * @param set Bitset.
+ * @param other Other bitset.
+ * @return True if the bitset is a subset of the other one, false otherwise.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_PUBLIC
+bool ubitset_is_subset(UBitSet const *set, UBitSet const *other);
+
+/**
+ * Checks whether two bitsets have at least one set bit in common.
+ *
+ * @param a First bitset.
+ * @param b Second bitset.
+ * @return True if the bitsets intersect, false otherwise.
+ *
+ * @public @memberof UBitSet
+ */
+ULIB_PUBLIC
+bool ubitset_intersects(UBitSet const *a, UBitSet const *b);
+
+ULIB_END_DECLS
+
+#endif // UBITSET_H
@@ -0,0 +1,1053 @@
+/**
+ * A type-safe, generic C ordered map, backed by a B+ tree.
+ *
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UBTREE_H
+#define UBTREE_H
+
+#include "ustd.h"
+#include "uvec.h"
+
+ULIB_BEGIN_DECLS
+
+/**
+ * A type safe, generic ordered map, backed by a B+ tree.
+ *
+ * Keys are unique, and kept sorted according to the comparison function of the tree.
+ * Elements are stored in leaves linked in key order, so that ordered and range iteration
+ * only touch leaves. Nodes span multiple cache lines (see @ref UBTREE_NODE_SIZE),
+ * and are searched via the same kernel as sorted vectors.
+ *
+ * Appending keys greater than all the others leaves full leaves behind, and inner nodes
+ * one key short of full, so that trees indexing time-ordered data stay compact.
+ *
+ * @struct UBTree
+ */
+
+/// Return codes.
+typedef enum ubtree_ret {
+
+    /**
+     * The operation failed.
+     * As of right now, it can only happen if memory cannot be allocated.
+     */
+    UBTREE_ERR = -1,
+
+    /// The operation succeeded.
+    UBTREE_OK = 0,
+
+    /// The key is already present.
+    UBTREE_PRESENT = 0,
+
+    /// The key has been inserted (it was absent).
+    UBTREE_INSERTED = 1
+
+} ubtree_ret;
+
+/**
+ * Use it as the value type in declarations if
+ * you're only going to use the tree as a set.
+ */
+#define UBTREE_VAL_IGNORE char
+
+/// Size of the key array of each node (B).
+#ifndef UBTREE_NODE_SIZE
+#define UBTREE_NODE_SIZE (4 * UVEC_CACHE_LINE_SIZE)
+#endif
+
+/*
+ * Maximum number of keys of each node.
+ *
+ * @param ub_key [type] Key type.
+ */
+#define P_UBTREE_CAP(ub_key)                                                                       \
+    (UBTREE_NODE_SIZE / sizeof(ub_key) > 4 ? UBTREE_NODE_SIZE / sizeof(ub_key) : 4)
+
+/*
+ * Maximum number of keys of each node of the specified tree type.
+ *
+ * @param T [symbol] Tree name.
+ */
+#define p_ubtree_cap(T) P_UBTREE_CAP(ubtree_##T##_key)
+
+// Maximum height of a tree, as each inner node has at least two children.
+#define P_UBTREE_MAX_HEIGHT (sizeof(ulib_uint) * 8)
+
+/*
+ * Defines a new tree struct.
+ *
+ * @param T [symbol] Tree name.
+ * @param ub_key [type] Key type.
+ * @param ub_val [type] Value type.
+ */
+#define P_UBTREE_DEF_TYPE(T, ub_key, ub_val)                                                       \
+    /** @cond */                                                                                   \
+    typedef ub_key ubtree_##T##_key;                                                               \
+    typedef ub_val ubtree_##T##_val;                                                               \
+                                                                                                   \
+    typedef struct P_UBTree_Leaf_##T {                                                             \
+        ub_key _keys[P_UBTREE_CAP(ub_key)];                                                        \
+        ub_val _vals[P_UBTREE_CAP(ub_key)];                                                        \
+        struct P_UBTree_Leaf_##T *_next;                                                           \
+        ulib_uint _count;                                                                          \
+    } P_UBTree_Leaf_##T;                                                                           \
+                                                                                                   \
+    typedef struct P_UBTree_Node_##T {                                                             \
+        ub_key _keys[P_UBTREE_CAP(ub_key)];                                                        \
+        void *_children[P_UBTREE_CAP(ub_key) + 1];                                                 \
+        ulib_uint _count;                                                                          \
+    } P_UBTree_Node_##T;                                                                           \
+    /** @endcond */                                                                                \
+                                                                                                   \
+    typedef struct UBTree_##T {                                                                    \
+        /** @cond */                                                                               \
+        void *_root;                                                                               \
+        P_UBTree_Leaf_##T *_first;                                                                 \
+        ulib_uint _count;                                                                          \
+        ulib_uint _height;                                                                         \
+        /** @endcond */                                                                            \
+    } UBTree_##T;                                                                                  \
+                                                                                                   \
+    /** @cond */                                                                                   \
+    typedef struct UBTree_Loop_##T {                                                               \
+        ub_key *key;                                                                               \
+        ub_val *val;                                                                               \
+        P_UBTree_Leaf_##T *_leaf;                                                                  \
+        ulib_uint _i;                                                                              \
+    } UBTree_Loop_##T;                                                                             \
+    /** @endcond */
+
+/*
+ * Generates function declarations for the specified tree type.
+ *
+ * @param T [symbol] Tree name.
+ * @param SCOPE [scope] Scope of the declarations.
+ * @param ub_key [type] Key type.
+ * @param ub_val [type] Value type.
+ */
+#define P_UBTREE_DECL(T, SCOPE, ub_key, ub_val)                                                    \
+    /** @cond */                                                                                   \
+    SCOPE void ubtree_deinit_##T(UBTree_##T *tree);                                                \
+    SCOPE ubtree_ret ubtree_from_sorted_##T(UBTree_##T *tree, ub_key const *keys,                  \
+                                            ub_val const *vals, ulib_uint n);                      \
+    SCOPE UBTree_Loop_##T ubtree_find_##T(UBTree_##T const *tree, ub_key key);                     \
+    SCOPE UBTree_Loop_##T ubtree_lower_bound_##T(UBTree_##T const *tree, ub_key key);              \
+    SCOPE UBTree_Loop_##T ubtree_upper_bound_##T(UBTree_##T const *tree, ub_key key);              \
+    SCOPE UBTree_Loop_##T ubtree_last_##T(UBTree_##T const *tree);                                 \
+    SCOPE bool ubtree_pop_##T(UBTree_##T *tree, ub_key key, ub_key *r_key, ub_val *r_val);         \
+    SCOPE UBTree_Loop_##T p_ubtree_range_##T(UBTree_##T const *tree, ub_key start, ub_key end,     \
+                                             UBTree_Loop_##T *end_loop);                           \
+    SCOPE ubtree_ret p_ubtree_insert_##T(UBTree_##T *tree, ub_key key, ub_val const *val,          \
+                                         ub_val *existing);                                        \
+    /** @endcond */
+
+/*
+ * Generates inline function definitions for the specified tree type.
+ *
+ * @param T [symbol] Tree name.
+ * @param SCOPE [scope] Scope of the definitions.
+ * @param ub_key [type] Key type.
+ * @param ub_val [type] Value type.
+ */
+#define P_UBTREE_DEF_INLINE(T, SCOPE, ub_key, ub_val)                                              \
+    /** @cond */                                                                                   \
+    SCOPE static inline UBTree_##T ubtree_##T(void) {                                              \
+        UBTree_##T tree = { NULL, NULL, 0, 0 };                                                    \
+        return tree;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline UBTree_Loop_##T p_ubtree_loop_##T(P_UBTree_Leaf_##T *leaf, ulib_uint i) {  \
+        if (leaf && i == leaf->_count) {                                                           \
+            leaf = leaf->_next;                                                                    \
+            i = 0;                                                                                 \
+        }                                                                                          \
+        UBTree_Loop_##T loop = { NULL, NULL, leaf, i };                                            \
+        if (leaf) {                                                                                \
+            loop.key = leaf->_keys + i;                                                            \
+            loop.val = leaf->_vals + i;                                                            \
+        }                                                                                          \
+        return loop;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline UBTree_Loop_##T ubtree_first_##T(UBTree_##T const *tree) {                 \
+        return p_ubtree_loop_##T(tree->_first, 0);                                                 \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline void ubtree_loop_next_##T(UBTree_Loop_##T *loop) {                         \
+        *loop = p_ubtree_loop_##T(loop->_leaf, loop->_i + 1);                                      \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline bool ubtree_contains_##T(UBTree_##T const *tree, ub_key key) {             \
+        return ubtree_find_##T(tree, key).key != NULL;                                             \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline ub_val ubmap_get_##T(UBTree_##T const *tree, ub_key key,                   \
+                                             ub_val if_missing) {                                  \
+        UBTree_Loop_##T loop = ubtree_find_##T(tree, key);                                         \
+        return loop.key ? *loop.val : if_missing;                                                  \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline ubtree_ret ubmap_set_##T(UBTree_##T *tree, ub_key key, ub_val val,         \
+                                                 ub_val *existing) {                               \
+        return p_ubtree_insert_##T(tree, key, &val, existing);                                     \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline ubtree_ret ubset_insert_##T(UBTree_##T *tree, ub_key key) {                \
+        return p_ubtree_insert_##T(tree, key, NULL, NULL);                                         \
+    }                                                                                              \
+    /** @endcond */
+
+/*
+ * Generates function definitions for the specified tree type.
+ *
+ * @param T [symbol] Tree name.
+ * @param SCOPE [scope] Scope of the definitions.
+ * @param equal_func [(ub_key, ub_key) -> bool] Equality function.
+ * @param compare_func [(ub_key, ub_key) -> bool] Comparison function (a < b).
+ */
+#define P_UBTREE_IMPL(T, SCOPE, equal_func, compare_func)                                          \
+                                                                                                   \
+    P_UVEC_DEF_LOWER_BOUND(p_ubtree_lower_bound_##T, ubtree_##T##_key, compare_func)               \
+                                                                                                   \
+    /* Index of the child of an inner node whose subtree may contain the key. */                   \
+    static inline ulib_uint p_ubtree_child_##T(P_UBTree_Node_##T const *node,                      \
+                                               ubtree_##T##_key key) {                             \
+        ulib_uint const i = p_ubtree_lower_bound_##T(node->_keys, node->_count, key);              \
+        return i < node->_count && equal_func(node->_keys[i], key) ? i + 1 : i;                    \
+    }                                                                                              \
+                                                                                                   \
+    static P_UBTree_Leaf_##T *p_ubtree_leaf_##T(UBTree_##T const *tree, ubtree_##T##_key key) {    \
+        void *node = tree->_root;                                                                  \
+        for (ulib_uint h = tree->_height; h; --h) {                                                \
+            P_UBTree_Node_##T *inner = (P_UBTree_Node_##T *)node;                                  \
+            node = inner->_children[p_ubtree_child_##T(inner, key)];                               \
+        }                                                                                          \
+        return (P_UBTree_Leaf_##T *)node;                                                          \
+    }                                                                                              \
+                                                                                                   \
+    /* Frees an inner node and its inner descendants. Leaves are freed via their links. */         \
+    static void p_ubtree_free_node_##T(P_UBTree_Node_##T *node, ulib_uint height) {                \
+        if (height > 1) {                                                                          \
+            for (ulib_uint i = 0; i <= node->_count; ++i) {                                        \
+                p_ubtree_free_node_##T((P_UBTree_Node_##T *)node->_children[i], height - 1);       \
+            }                                                                                      \
+        }                                                                                          \
+        ulib_free(node);                                                                           \
+    }                                                                                              \
+                                                                                                   \
+    static void p_ubtree_free_leaves_##T(P_UBTree_Leaf_##T *leaf) {                                \
+        while (leaf) {                                                                             \
+            P_UBTree_Leaf_##T *next = leaf->_next;                                                 \
+            ulib_free(leaf);                                                                       \
+            leaf = next;                                                                           \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static inline void p_ubtree_leaf_insert_##T(P_UBTree_Leaf_##T *leaf, ulib_uint i,              \
+                                                ubtree_##T##_key key,                              \
+                                                ubtree_##T##_val const *val) {                     \
+        ulib_uint const n = leaf->_count - i;                                                      \
+        memmove(leaf->_keys + i + 1, leaf->_keys + i, n * sizeof(*leaf->_keys));                   \
+        memmove(leaf->_vals + i + 1, leaf->_vals + i, n * sizeof(*leaf->_vals));                   \
+        leaf->_keys[i] = key;                                                                      \
+        if (val) leaf->_vals[i] = *val;                                                            \
+        leaf->_count++;                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    static inline void p_ubtree_leaf_remove_##T(P_UBTree_Leaf_##T *leaf, ulib_uint i) {            \
+        ulib_uint const n = --leaf->_count - i;                                                    \
+        memmove(leaf->_keys + i, leaf->_keys + i + 1, n * sizeof(*leaf->_keys));                   \
+        memmove(leaf->_vals + i, leaf->_vals + i + 1, n * sizeof(*leaf->_vals));                   \
+    }                                                                                              \
+                                                                                                   \
+    /* Inserts the key at index i, and the child to its right. */                                  \
+    static inline void p_ubtree_node_insert_##T(P_UBTree_Node_##T *node, ulib_uint i,              \
+                                                ubtree_##T##_key key, void *child) {               \
+        ulib_uint const n = node->_count - i;                                                      \
+        memmove(node->_keys + i + 1, node->_keys + i, n * sizeof(*node->_keys));                   \
+        memmove(node->_children + i + 2, node->_children + i + 1, n * sizeof(*node->_children));   \
+        node->_keys[i] = key;                                                                      \
+        node->_children[i + 1] = child;                                                            \
+        node->_count++;                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    /* Removes the key at index i, and the child to its right. */                                  \
+    static inline void p_ubtree_node_remove_##T(P_UBTree_Node_##T *node, ulib_uint i) {            \
+        ulib_uint const n = --node->_count - i;                                                    \
+        memmove(node->_keys + i, node->_keys + i + 1, n * sizeof(*node->_keys));                   \
+        memmove(node->_children + i + 1, node->_children + i + 2, n * sizeof(*node->_children));   \
+    }                                                                                              \
+                                                                                                   \
+    /*                                                                                             \
+     * Splits a full inner node into node and right while inserting the key at index i,            \
+     * and the child to its right. The key is replaced by the one moving to the parent.            \
+     */                                                                                            \
+    static void p_ubtree_node_split_##T(P_UBTree_Node_##T *node, P_UBTree_Node_##T *right,         \
+                                        ulib_uint i, ubtree_##T##_key *key, void *child,           \
+                                        bool append) {                                             \
+        ulib_uint const cap = p_ubtree_cap(T);                                                     \
+        ubtree_##T##_key keys[p_ubtree_cap(T) + 1];                                                \
+        void *children[p_ubtree_cap(T) + 2];                                                       \
+                                                                                                   \
+        memcpy(keys, node->_keys, i * sizeof(*keys));                                              \
+        keys[i] = *key;                                                                            \
+        memcpy(keys + i + 1, node->_keys + i, (cap - i) * sizeof(*keys));                          \
+        memcpy(children, node->_children, (i + 1) * sizeof(*children));                            \
+        children[i + 1] = child;                                                                   \
+        memcpy(children + i + 2, node->_children + i + 1, (cap - i) * sizeof(*children));          \
+                                                                                                   \
+        /* Appends leave a key in the right node, so that it has a sibling to merge with. */       \
+        ulib_uint const mid = append ? cap - 1 : cap / 2;                                          \
+        node->_count = mid;                                                                        \
+        memcpy(node->_keys, keys, mid * sizeof(*keys));                                            \
+        memcpy(node->_children, children, (mid + 1) * sizeof(*children));                          \
+        *key = keys[mid];                                                                          \
+        right->_count = cap - mid;                                                                 \
+        memcpy(right->_keys, keys + mid + 1, (cap - mid) * sizeof(*keys));                         \
+        memcpy(right->_children, children + mid + 1, (cap - mid + 1) * sizeof(*children));         \
+    }                                                                                              \
+                                                                                                   \
+    /*                                                                                             \
+     * Fixes an underfull leaf, child i of the parent, by merging it with a sibling                \
+     * or by moving elements from it. Returns true if the parent lost a key.                       \
+     */                                                                                            \
+    static bool p_ubtree_rebalance_leaf_##T(P_UBTree_Node_##T *parent, ulib_uint i) {              \
+        ulib_uint const s = i ? i - 1 : 0;                                                         \
+        P_UBTree_Leaf_##T *a = (P_UBTree_Leaf_##T *)parent->_children[s];                          \
+        P_UBTree_Leaf_##T *b = (P_UBTree_Leaf_##T *)parent->_children[s + 1];                      \
+                                                                                                   \
+        if (a->_count + b->_count <= p_ubtree_cap(T)) {                                            \
+            memcpy(a->_keys + a->_count, b->_keys, b->_count * sizeof(*b->_keys));                 \
+            memcpy(a->_vals + a->_count, b->_vals, b->_count * sizeof(*b->_vals));                 \
+            a->_count += b->_count;                                                                \
+            a->_next = b->_next;                                                                   \
+            ulib_free(b);                                                                          \
+            p_ubtree_node_remove_##T(parent, s);                                                   \
+            return true;                                                                           \
+        }                                                                                          \
+                                                                                                   \
+        /* Even out the two leaves. */                                                             \
+        if (i) {                                                                                   \
+            ulib_uint n = (a->_count - b->_count) / 2;                                             \
+            if (!n) n = 1;                                                                         \
+            memmove(b->_keys + n, b->_keys, b->_count * sizeof(*b->_keys));                        \
+            memmove(b->_vals + n, b->_vals, b->_count * sizeof(*b->_vals));                        \
+            a->_count -= n;                                                                        \
+            memcpy(b->_keys, a->_keys + a->_count, n * sizeof(*b->_keys));                         \
+            memcpy(b->_vals, a->_vals + a->_count, n * sizeof(*b->_vals));                         \
+            b->_count += n;                                                                        \
+        } else {                                                                                   \
+            ulib_uint n = (b->_count - a->_count) / 2;                                             \
+            if (!n) n = 1;                                                                         \
+            memcpy(a->_keys + a->_count, b->_keys, n * sizeof(*a->_keys));                         \
+            memcpy(a->_vals + a->_count, b->_vals, n * sizeof(*a->_vals));                         \
+            a->_count += n;                                                                        \
+            b->_count -= n;                                                                        \
+            memmove(b->_keys, b->_keys + n, b->_count * sizeof(*b->_keys));                        \
+            memmove(b->_vals, b->_vals + n, b->_count * sizeof(*b->_vals));                        \
+        }                                                                                          \
+                                                                                                   \
+        parent->_keys[s] = b->_keys[0];                                                            \
+        return false;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    /*                                                                                             \
+     * Fixes an underfull inner node, child i of the parent, by merging it with a sibling          \
+     * or by rotating a key through the parent. Returns true if the parent lost a key.             \
+     */                                                                                            \
+    static bool p_ubtree_rebalance_node_##T(P_UBTree_Node_##T *parent, ulib_uint i) {              \
+        ulib_uint const s = i ? i - 1 : 0;                                                         \
+        P_UBTree_Node_##T *a = (P_UBTree_Node_##T *)parent->_children[s];                          \
+        P_UBTree_Node_##T *b = (P_UBTree_Node_##T *)parent->_children[s + 1];                      \
+                                                                                                   \
+        if (a->_count + b->_count < p_ubtree_cap(T)) {                                             \
+            a->_keys[a->_count] = parent->_keys[s];                                                \
+            memcpy(a->_keys + a->_count + 1, b->_keys, b->_count * sizeof(*b->_keys));             \
+            memcpy(a->_children + a->_count + 1, b->_children,                                     \
+                   (b->_count + 1) * sizeof(*b->_children));                                       \
+            a->_count += b->_count + 1;                                                            \
+            ulib_free(b);                                                                          \
+            p_ubtree_node_remove_##T(parent, s);                                                   \
+            return true;                                                                           \
+        }                                                                                          \
+                                                                                                   \
+        if (i) {                                                                                   \
+            memmove(b->_keys + 1, b->_keys, b->_count * sizeof(*b->_keys));                        \
+            memmove(b->_children + 1, b->_children, (b->_count + 1) * sizeof(*b->_children));      \
+            b->_keys[0] = parent->_keys[s];                                                        \
+            b->_children[0] = a->_children[a->_count];                                             \
+            b->_count++;                                                                           \
+            parent->_keys[s] = a->_keys[--a->_count];                                              \
+        } else {                                                                                   \
+            a->_keys[a->_count] = parent->_keys[s];                                                \
+            a->_children[++a->_count] = b->_children[0];                                           \
+            parent->_keys[s] = b->_keys[0];                                                        \
+            b->_count--;                                                                           \
+            memmove(b->_keys, b->_keys + 1, b->_count * sizeof(*b->_keys));                        \
+            memmove(b->_children, b->_children + 1, (b->_count + 1) * sizeof(*b->_children));      \
+        }                                                                                          \
+                                                                                                   \
+        return false;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE void ubtree_deinit_##T(UBTree_##T *tree) {                                               \
+        if (tree->_height) {                                                                       \
+            p_ubtree_free_node_##T((P_UBTree_Node_##T *)tree->_root, tree->_height);               \
+        }                                                                                          \
+        p_ubtree_free_leaves_##T(tree->_first);                                                    \
+        *tree = ubtree_##T();                                                                      \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE ubtree_ret ubtree_from_sorted_##T(UBTree_##T *tree, ubtree_##T##_key const *keys,        \
+                                            ubtree_##T##_val const *vals, ulib_uint n) {           \
+        ubtree_deinit_##T(tree);                                                                   \
+        if (!n) return UBTREE_OK;                                                                  \
+                                                                                                   \
+        ulib_uint const cap = p_ubtree_cap(T);                                                     \
+        ulib_uint count = n / cap + (n % cap != 0);                                                \
+        void **nodes = (void **)ulib_malloc(count * sizeof(*nodes));                               \
+        ubtree_##T##_key *mins = (ubtree_##T##_key *)ulib_malloc(count * sizeof(*mins));           \
+        ulib_uint built = 0;                                                                       \
+                                                                                                   \
+        /* Elements are spread evenly across the leaves, and so are nodes across levels. */        \
+        if (nodes && mins) {                                                                       \
+            P_UBTree_Leaf_##T *prev = NULL;                                                        \
+            for (ulib_uint start = 0; built < count; ++built) {                                    \
+                P_UBTree_Leaf_##T *leaf = (P_UBTree_Leaf_##T *)ulib_malloc(sizeof(*leaf));         \
+                if (!leaf) break;                                                                  \
+                                                                                                   \
+                ulib_uint const len = n / count + (built < n % count);                             \
+                memcpy(leaf->_keys, keys + start, len * sizeof(*keys));                            \
+                if (vals) memcpy(leaf->_vals, vals + start, len * sizeof(*vals));                  \
+                leaf->_count = len;                                                                \
+                leaf->_next = NULL;                                                                \
+                                                                                                   \
+                if (prev) {                                                                        \
+                    prev->_next = leaf;                                                            \
+                } else {                                                                           \
+                    tree->_first = leaf;                                                           \
+                }                                                                                  \
+                                                                                                   \
+                prev = leaf;                                                                       \
+                nodes[built] = leaf;                                                               \
+                mins[built] = keys[start];                                                         \
+                start += len;                                                                      \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        ulib_uint height = 0;                                                                      \
+        bool ok = built == count;                                                                  \
+                                                                                                   \
+        while (ok && count > 1) {                                                                  \
+            ulib_uint const parents = count / (cap + 1) + (count % (cap + 1) != 0);                \
+            ulib_uint start = 0, p = 0;                                                            \
+                                                                                                   \
+            /* Parents are stored in place of their children, which come at or after them. */      \
+            for (; p < parents; ++p) {                                                             \
+                P_UBTree_Node_##T *node = (P_UBTree_Node_##T *)ulib_malloc(sizeof(*node));         \
+                if (!node) break;                                                                  \
+                                                                                                   \
+                ulib_uint const len = count / parents + (p < count % parents);                     \
+                memcpy(node->_children, nodes + start, len * sizeof(*nodes));                      \
+                memcpy(node->_keys, mins + start + 1, (len - 1) * sizeof(*mins));                  \
+                node->_count = len - 1;                                                            \
+                                                                                                   \
+                mins[p] = mins[start];                                                             \
+                nodes[p] = node;                                                                   \
+                start += len;                                                                      \
+            }                                                                                      \
+                                                                                                   \
+            if (p < parents) {                                                                     \
+                for (ulib_uint i = 0; i < p; ++i) {                                                \
+                    p_ubtree_free_node_##T((P_UBTree_Node_##T *)nodes[i], height + 1);             \
+                }                                                                                  \
+                for (ulib_uint i = start; height && i < count; ++i) {                              \
+                    p_ubtree_free_node_##T((P_UBTree_Node_##T *)nodes[i], height);                 \
+                }                                                                                  \
+                ok = false;                                                                        \
+                break;                                                                             \
+            }                                                                                      \
+                                                                                                   \
+            count = parents;                                                                       \
+            height++;                                                                              \
+        }                                                                                          \
+                                                                                                   \
+        ubtree_ret ret = UBTREE_ERR;                                                               \
+                                                                                                   \
+        if (ok) {                                                                                  \
+            tree->_root = nodes[0];                                                                \
+            tree->_height = height;                                                                \
+            tree->_count = n;                                                                      \
+            ret = UBTREE_OK;                                                                       \
+        } else {                                                                                   \
+            p_ubtree_free_leaves_##T(tree->_first);                                                \
+            tree->_first = NULL;                                                                   \
+        }                                                                                          \
+                                                                                                   \
+        ulib_free(nodes);                                                                          \
+        ulib_free(mins);                                                                           \
+        return ret;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE UBTree_Loop_##T ubtree_find_##T(UBTree_##T const *tree, ubtree_##T##_key key) {          \
+        if (!tree->_root) return p_ubtree_loop_##T(NULL, 0);                                       \
+        P_UBTree_Leaf_##T *leaf = p_ubtree_leaf_##T(tree, key);                                    \
+        ulib_uint const i = p_ubtree_lower_bound_##T(leaf->_keys, leaf->_count, key);              \
+        bool const found = i < leaf->_count && equal_func(leaf->_keys[i], key);                    \
+        return p_ubtree_loop_##T(found ? leaf : NULL, i);                                          \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE UBTree_Loop_##T ubtree_lower_bound_##T(UBTree_##T const *tree, ubtree_##T##_key key) {   \
+        if (!tree->_root) return p_ubtree_loop_##T(NULL, 0);                                       \
+        P_UBTree_Leaf_##T *leaf = p_ubtree_leaf_##T(tree, key);                                    \
+        return p_ubtree_loop_##T(leaf, p_ubtree_lower_bound_##T(leaf->_keys, leaf->_count, key));  \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE UBTree_Loop_##T ubtree_upper_bound_##T(UBTree_##T const *tree, ubtree_##T##_key key) {   \
+        if (!tree->_root) return p_ubtree_loop_##T(NULL, 0);                                       \
+        P_UBTree_Leaf_##T *leaf = p_ubtree_leaf_##T(tree, key);                                    \
+        ulib_uint i = p_ubtree_lower_bound_##T(leaf->_keys, leaf->_count, key);                    \
+        if (i < leaf->_count && equal_func(leaf->_keys[i], key)) ++i;                              \
+        return p_ubtree_loop_##T(leaf, i);                                                         \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE UBTree_Loop_##T ubtree_last_##T(UBTree_##T const *tree) {                                \
+        void *node = tree->_root;                                                                  \
+        if (!node) return p_ubtree_loop_##T(NULL, 0);                                              \
+        for (ulib_uint h = tree->_height; h; --h) {                                                \
+            P_UBTree_Node_##T *inner = (P_UBTree_Node_##T *)node;                                  \
+            node = inner->_children[inner->_count];                                                \
+        }                                                                                          \
+        P_UBTree_Leaf_##T *leaf = (P_UBTree_Leaf_##T *)node;                                       \
+        return p_ubtree_loop_##T(leaf, leaf->_count - 1);                                          \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE UBTree_Loop_##T p_ubtree_range_##T(UBTree_##T const *tree, ubtree_##T##_key start,       \
+                                             ubtree_##T##_key end, UBTree_Loop_##T *end_loop) {    \
+        *end_loop = ubtree_lower_bound_##T(tree, end);                                             \
+        return compare_func(start, end) ? ubtree_lower_bound_##T(tree, start) : *end_loop;         \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE ubtree_ret p_ubtree_insert_##T(UBTree_##T *tree, ubtree_##T##_key key,                   \
+                                         ubtree_##T##_val const *val,                              \
+                                         ubtree_##T##_val *existing) {                             \
+        ulib_uint const cap = p_ubtree_cap(T);                                                     \
+                                                                                                   \
+        if (!tree->_root) {                                                                        \
+            P_UBTree_Leaf_##T *leaf = (P_UBTree_Leaf_##T *)ulib_malloc(sizeof(*leaf));             \
+            if (!leaf) return UBTREE_ERR;                                                          \
+            leaf->_keys[0] = key;                                                                  \
+            if (val) leaf->_vals[0] = *val;                                                        \
+            leaf->_next = NULL;                                                                    \
+            leaf->_count = 1;                                                                      \
+            tree->_root = tree->_first = leaf;                                                     \
+            tree->_count = 1;                                                                      \
+            return UBTREE_INSERTED;                                                                \
+        }                                                                                          \
+                                                                                                   \
+        P_UBTree_Node_##T *path[P_UBTREE_MAX_HEIGHT];                                              \
+        ulib_uint idx[P_UBTREE_MAX_HEIGHT];                                                        \
+        ulib_uint const height = tree->_height;                                                    \
+        bool rightmost = true;                                                                     \
+        void *node = tree->_root;                                                                  \
+                                                                                                   \
+        for (ulib_uint h = 0; h < height; ++h) {                                                   \
+            P_UBTree_Node_##T *inner = (P_UBTree_Node_##T *)node;                                  \
+            ulib_uint const i = p_ubtree_child_##T(inner, key);                                    \
+            path[h] = inner;                                                                       \
+            idx[h] = i;                                                                            \
+            rightmost = rightmost && i == inner->_count;                                           \
+            node = inner->_children[i];                                                            \
+        }                                                                                          \
+                                                                                                   \
+        P_UBTree_Leaf_##T *leaf = (P_UBTree_Leaf_##T *)node;                                       \
+        ulib_uint const i = p_ubtree_lower_bound_##T(leaf->_keys, leaf->_count, key);              \
+                                                                                                   \
+        if (i < leaf->_count && equal_func(leaf->_keys[i], key)) {                                 \
+            if (val) {                                                                             \
+                if (existing) *existing = leaf->_vals[i];                                          \
+                leaf->_vals[i] = *val;                                                             \
+            }                                                                                      \
+            return UBTREE_PRESENT;                                                                 \
+        }                                                                                          \
+                                                                                                   \
+        if (leaf->_count < cap) {                                                                  \
+            p_ubtree_leaf_insert_##T(leaf, i, key, val);                                           \
+            tree->_count++;                                                                        \
+            return UBTREE_INSERTED;                                                                \
+        }                                                                                          \
+                                                                                                   \
+        /* Splits cascade through full inner nodes, so all new nodes are allocated upfront. */     \
+        ulib_uint splits = 0;                                                                      \
+        while (splits < height && path[height - 1 - splits]->_count == cap) ++splits;              \
+        ulib_uint const new_nodes = splits + (splits == height);                                   \
+        P_UBTree_Node_##T *nodes[P_UBTREE_MAX_HEIGHT + 1];                                         \
+        P_UBTree_Leaf_##T *right = (P_UBTree_Leaf_##T *)ulib_malloc(sizeof(*right));               \
+        ulib_uint allocated = 0;                                                                   \
+                                                                                                   \
+        for (; right && allocated < new_nodes; ++allocated) {                                      \
+            nodes[allocated] = (P_UBTree_Node_##T *)ulib_malloc(sizeof(*nodes[allocated]));        \
+            if (!nodes[allocated]) break;                                                          \
+        }                                                                                          \
+                                                                                                   \
+        if (!right || allocated < new_nodes) {                                                     \
+            while (allocated) ulib_free(nodes[--allocated]);                                       \
+            ulib_free(right);                                                                      \
+            return UBTREE_ERR;                                                                     \
+        }                                                                                          \
+                                                                                                   \
+        /* Appending to the rightmost leaf leaves full leaves behind. */                           \
+        bool const append = rightmost && i == cap;                                                 \
+        ulib_uint const mid = append ? cap : cap / 2;                                              \
+        right->_count = cap - mid;                                                                 \
+        memcpy(right->_keys, leaf->_keys + mid, right->_count * sizeof(*right->_keys));            \
+        memcpy(right->_vals, leaf->_vals + mid, right->_count * sizeof(*right->_vals));            \
+        leaf->_count = mid;                                                                        \
+        right->_next = leaf->_next;                                                                \
+        leaf->_next = right;                                                                       \
+                                                                                                   \
+        if (i < mid) {                                                                             \
+            p_ubtree_leaf_insert_##T(leaf, i, key, val);                                           \
+        } else {                                                                                   \
+            p_ubtree_leaf_insert_##T(right, i - mid, key, val);                                    \
+        }                                                                                          \
+                                                                                                   \
+        tree->_count++;                                                                            \
+        ubtree_##T##_key sep = right->_keys[0];                                                    \
+        void *child = right;                                                                       \
+                                                                                                   \
+        for (ulib_uint h = height, next = 0; h-- > 0;) {                                           \
+            P_UBTree_Node_##T *inner = path[h];                                                    \
+                                                                                                   \
+            if (inner->_count < cap) {                                                             \
+                p_ubtree_node_insert_##T(inner, idx[h], sep, child);                               \
+                return UBTREE_INSERTED;                                                            \
+            }                                                                                      \
+                                                                                                   \
+            P_UBTree_Node_##T *split = nodes[next++];                                              \
+            p_ubtree_node_split_##T(inner, split, idx[h], &sep, child, append);                    \
+            child = split;                                                                         \
+        }                                                                                          \
+                                                                                                   \
+        P_UBTree_Node_##T *root = nodes[new_nodes - 1];                                            \
+        root->_keys[0] = sep;                                                                      \
+        root->_children[0] = tree->_root;                                                          \
+        root->_children[1] = child;                                                                \
+        root->_count = 1;                                                                          \
+        tree->_root = root;                                                                        \
+        tree->_height++;                                                                           \
+        return UBTREE_INSERTED;                                                                    \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE bool ubtree_pop_##T(UBTree_##T *tree, ubtree_##T##_key key, ubtree_##T##_key *r_key,     \
+                              ubtree_##T##_val *r_val) {                                           \
+        if (!tree->_root) return false;                                                            \
+                                                                                                   \
+        P_UBTree_Node_##T *path[P_UBTREE_MAX_HEIGHT];                                              \
+        ulib_uint idx[P_UBTREE_MAX_HEIGHT];                                                        \
+        ulib_uint const height = tree->_height;                                                    \
+        void *node = tree->_root;                                                                  \
+                                                                                                   \
+        for (ulib_uint h = 0; h < height; ++h) {                                                   \
+            P_UBTree_Node_##T *inner = (P_UBTree_Node_##T *)node;                                  \
+            path[h] = inner;                                                                       \
+            idx[h] = p_ubtree_child_##T(inner, key);                                               \
+            node = inner->_children[idx[h]];                                                       \
+        }                                                                                          \
+                                                                                                   \
+        P_UBTree_Leaf_##T *leaf = (P_UBTree_Leaf_##T *)node;                                       \
+        ulib_uint const i = p_ubtree_lower_bound_##T(leaf->_keys, leaf->_count, key);              \
+        if (i == leaf->_count || !equal_func(leaf->_keys[i], key)) return false;                   \
+                                                                                                   \
+        if (r_key) *r_key = leaf->_keys[i];                                                        \
+        if (r_val) *r_val = leaf->_vals[i];                                                        \
+        p_ubtree_leaf_remove_##T(leaf, i);                                                         \
+        tree->_count--;                                                                            \
+                                                                                                   \
+        ulib_uint const min = p_ubtree_cap(T) / 2;                                                 \
+                                                                                                   \
+        if (!height) {                                                                             \
+            if (!leaf->_count) {                                                                   \
+                ulib_free(leaf);                                                                   \
+                *tree = ubtree_##T();                                                              \
+            }                                                                                      \
+            return true;                                                                           \
+        }                                                                                          \
+                                                                                                   \
+        if (leaf->_count >= min) return true;                                                      \
+        if (!p_ubtree_rebalance_leaf_##T(path[height - 1], idx[height - 1])) return true;          \
+                                                                                                   \
+        for (ulib_uint h = height - 1; h; --h) {                                                   \
+            if (path[h]->_count >= min) return true;                                               \
+            if (!p_ubtree_rebalance_node_##T(path[h - 1], idx[h - 1])) return true;                \
+        }                                                                                          \
+                                                                                                   \
+        P_UBTree_Node_##T *root = path[0];                                                         \
+                                                                                                   \
+        if (!root->_count) {                                                                       \
+            tree->_root = root->_children[0];                                                      \
+            tree->_height--;                                                                       \
+            ulib_free(root);                                                                       \
+        }                                                                                          \
+                                                                                                   \
+        return true;                                                                               \
+    }
+
+/// @name Type definitions
+
+/**
+ * Declares a new tree type.
+ *
+ * @param T [symbol] Tree name.
+ * @param ub_key [symbol] Type of the keys.
+ * @param ub_val [symbol] Type of the values.
+ *
+ * @public @related UBTree
+ */
+#define UBTREE_DECL(T, ub_key, ub_val)                                                             \
+    P_UBTREE_DEF_TYPE(T, ub_key, ub_val)                                                           \
+    P_UBTREE_DECL(T, ulib_unused, ub_key, ub_val)                                                  \
+    P_UBTREE_DEF_INLINE(T, ulib_unused, ub_key, ub_val)
+
+/**
+ * Declares a new tree type, prepending a specifier to the generated declarations.
+ *
+ * @param T [symbol] Tree name.
+ * @param ub_key [symbol] Type of the keys.
+ * @param ub_val [symbol] Type of the values.
+ * @param SPEC [specifier] Specifier.
+ *
+ * @public @related UBTree
+ */
+#define UBTREE_DECL_SPEC(T, ub_key, ub_val, SPEC)                                                  \
+    P_UBTREE_DEF_TYPE(T, ub_key, ub_val)                                                           \
+    P_UBTREE_DECL(T, SPEC ulib_unused, ub_key, ub_val)                                             \
+    P_UBTREE_DEF_INLINE(T, ulib_unused, ub_key, ub_val)
+
+/**
+ * Implements a previously declared tree type.
+ *
+ * @param T [symbol] Tree name.
+ * @param equal_func [(ub_key, ub_key) -> bool] Equality function.
+ * @param compare_func [(ub_key, ub_key) -> bool] Comparison function (a < b).
+ *
+ * @public @related UBTree
+ */
+#define UBTREE_IMPL(T, equal_func, compare_func)                                                   \
+    P_UBTREE_IMPL(T, ulib_unused, equal_func, compare_func)
+
+/**
+ * Defines a new static tree type.
+ *
+ * @param T [symbol] Tree name.
+ * @param ub_key [symbol] Type of the keys.
+ * @param ub_val [symbol] Type of the values.
+ * @param equal_func [(ub_key, ub_key) -> bool] Equality function.
+ * @param compare_func [(ub_key, ub_key) -> bool] Comparison function (a < b).
+ *
+ * @public @related UBTree
+ */
+#define UBTREE_INIT(T, ub_key, ub_val, equal_func, compare_func)                                   \
+    P_UBTREE_DEF_TYPE(T, ub_key, ub_val)                                                           \
+    P_UBTREE_DECL(T, static inline ulib_unused, ub_key, ub_val)                                    \
+    P_UBTREE_DEF_INLINE(T, ulib_unused, ub_key, ub_val)                                            \
+    P_UBTREE_IMPL(T, static inline ulib_unused, equal_func, compare_func)
+
+/**
+ * Tree type.
+ *
+ * @param T [symbol] Tree name.
+ *
+ * @public @related UBTree
+ */
+#define UBTree(T) P_ULIB_MACRO_CONCAT(UBTree_, T)
+
+/**
+ * Tree iterator type.
+ *
+ * Iterators expose pointers to the current key and value as the `key` and `val` fields,
+ * which are NULL once the iterator is past the last element.
+ *
+ * @param T [symbol] Tree name.
+ *
+ * @note Iterators are invalidated by insertions and removals.
+ *
+ * @public @related UBTree
+ */
+#define UBTreeLoop(T) P_ULIB_MACRO_CONCAT(UBTree_Loop_, T)
+
+/**
+ * Identity macro.
+ *
+ * @param a LHS of the identity.
+ * @param b RHS of the identity.
+ * @return a == b
+ *
+ * @public @related UBTree
+ */
+#define ubtree_identical(a, b) ((a) == (b))
+
+/**
+ * "Less than" comparison macro.
+ *
+ * @param a LHS of the comparison.
+ * @param b RHS of the comparison.
+ * @return a < b
+ *
+ * @public @related UBTree
+ */
+#define ubtree_less_than(a, b) ((a) < (b))
+
+/// @name Memory management
+
+/**
+ * Initializes a new, empty tree.
+ *
+ * @param T [symbol] Tree name.
+ * @return [UBTree(T)] Initialized tree instance.
+ *
+ * @note The returned tree must be deinitialized via ubtree_deinit.
+ *
+ * @public @related UBTree
+ */
+#define ubtree(T) P_ULIB_MACRO_CONCAT(ubtree_, T)()
+
+/**
+ * De-initializes a tree previously initialized via ubtree.
+ *
+ * @param T [symbol] Tree name.
+ * @param tree [UBTree(T)*] Tree to de-initialize.
+ *
+ * @public @related UBTree
+ */
+#define ubtree_deinit(T, tree) P_ULIB_MACRO_CONCAT(ubtree_deinit_, T)(tree)
+
+/**
+ * Replaces the contents of the tree with the specified elements, in linear time.
+ *
+ * @param T [symbol] Tree name.
+ * @param tree [UBTree(T)*] Tree instance.
+ * @param keys [ub_key const *] Keys, sorted and unique, e.g. the storage of a sorted UVec.
+ * @param vals [ub_val const *] Values of the keys, or NULL if the tree is used as a set.
+ * @param n [ulib_uint] Number of elements.
+ * @return [ubtree_ret] UBTREE_OK on success, UBTREE_ERR on failure, in which case
+ *         the tree is empty.
+ *
+ * @note Elements are spread evenly across as few nodes as possible, so this is faster
+ *       and leads to a more compact tree than inserting the elements one by one.
+ *
+ * @public @related UBTree
+ */
+#define ubtree_from_sorted(T, tree, keys, vals, n)                                                 \
+    P_ULIB_MACRO_CONCAT(ubtree_from_sorted_, T)(tree, keys, vals, n)
+
+/// @name Primitives
+
+/**
+ * Returns the number of elements in the tree.
+ *
+ * @param T [symbol] Tree name.
+ * @param tree [UBTree(T)*] Tree instance.
+ * @return [ulib_uint] Number of elements.
+ *
+ * @public @related UBTree
+ */
+#define ubtree_count(T, tree) (((UBTree(T) *)(tree))->_count)
+
+/**
+ * Checks whether the tree contains the specified key.
+ *
+ * @param T [symbol] Tree name.
+ * @param tree [UBTree(T)*] Tree instance.
+ * @param key [ub_key] Key.
+ * @return [bool] True if the tree contains the key, false otherwise.
+ *
+ * @public @related UBTree
+ */
+#define ubtree_contains(T, tree, key) P_ULIB_MACRO_CONCAT(ubtree_contains_, T)(tree, key)
+
+/**
+ * Removes the specified key from the tree.
+ *
+ * @param T [symbol] Tree name.
+ * @param tree [UBTree(T)*] Tree instance.
+ * @param key [ub_key] Key.
+ * @return [bool] True if the key was present (it was removed), false otherwise.
+ *
+ * @public @related UBTree
+ */
+#define ubtree_remove(T, tree, key) P_ULIB_MACRO_CONCAT(ubtree_pop_, T)(tree, key, NULL, NULL)
+
+/**
+ * Removes the specified key from the tree, returning the removed key and value.
+ *
+ * @param T [symbol] Tree name.
+ * @param tree [UBTree(T)*] Tree instance.
+ * @param key [ub_key] Key.
+ * @param[out] r_key [ub_key*] Removed key, only set if the key was present.
+ * @param[out] r_val [ub_val*] Removed value, only set if the key was present.
+ * @return [bool] True if the key was present (it was removed), false otherwise.
+ *
+ * @public @related UBTree
+ */
+#define ubtree_pop(T, tree, key, r_key, r_val)                                                     \
+    P_ULIB_MACRO_CONCAT(ubtree_pop_, T)(tree, key, r_key, r_val)
+
+/// @name Iteration
+
+/**
+ * Returns an iterator to the specified key.
+ *
+ * @param T [symbol] Tree name.
+ * @param tree [UBTree(T)*] Tree instance.
+ * @param key [ub_key] Key.
+ * @return [UBTreeLoop(T)] Iterator, past the last element if the key is not present.
+ *
+ * @public @related UBTree
+ */
+#define ubtree_find(T, tree, key) P_ULIB_MACRO_CONCAT(ubtree_find_, T)(tree, key)
+
+/**
+ * Returns an iterator to the first element of the tree.
+ *
+ * @param T [symbol] Tree name.
+ * @param tree [UBTree(T)*] Tree instance.
+ * @return [UBTreeLoop(T)] Iterator, past the last element if the tree is empty.
+ *
+ * @public @related UBTree
+ */
+#define ubtree_first(T, tree) P_ULIB_MACRO_CONCAT(ubtree_first_, T)(tree)
+
+/**
+ * Returns an iterator to the last element of the tree.
+ *
+ * @param T [symbol] Tree name.
+ * @param tree [UBTree(T)*] Tree instance.
+ * @return [UBTreeLoop(T)] Iterator, past the last element if the tree is empty.
+ *
+ * @public @related UBTree
+ */
+#define ubtree_last(T, tree) P_ULIB_MACRO_CONCAT(ubtree_last_, T)(tree)
+
+/**
+ * Returns an iterator to the first element whose key is not less than the specified one.
+ *
+ * @param T [symbol] Tree name.
+ * @param tree [UBTree(T)*] Tree instance.
+ * @param key [ub_key] Key.
+ * @return [UBTreeLoop(T)] Iterator, past the last element if there is no such element.
+ *
+ * @public @related UBTree
+ */
+#define ubtree_lower_bound(T, tree, key) P_ULIB_MACRO_CONCAT(ubtree_lower_bound_, T)(tree, key)
+
+/**
+ * Returns an iterator to the first element whose key is greater than the specified one.
+ *
+ * @param T [symbol] Tree name.
+ * @param tree [UBTree(T)*] Tree instance.
+ * @param key [ub_key] Key.
+ * @return [UBTreeLoop(T)] Iterator, past the last element if there is no such element.
+ *
+ * @public @related UBTree
+ */
+#define ubtree_upper_bound(T, tree, key) P_ULIB_MACRO_CONCAT(ubtree_upper_bound_, T)(tree, key)
+
+/**
+ * Advances the iterator to the next element.
+ *
+ * @param T [symbol] Tree name.
+ * @param loop [UBTreeLoop(T)*] Iterator, which must not be past the last element.
+ *
+ * @public @related UBTree
+ */
+#define ubtree_loop_next(T, loop) P_ULIB_MACRO_CONCAT(ubtree_loop_next_, T)(loop)
+
+/**
+ * Iterates over the elements of the tree, in key order.
+ *
+ * @param T [symbol] Tree name.
+ * @param tree [UBTree(T)*] Tree instance.
+ * @param loop [symbol] Name of the iterator variable.
+ *
+ * @public @related UBTree
+ */
+#define ubtree_foreach(T, tree, loop)                                                              \
+    for (UBTreeLoop(T) loop = ubtree_first(T, tree); loop.key; ubtree_loop_next(T, &loop))
+
+/**
+ * Iterates over the elements of the tree whose keys are in the range [start, end), in key order.
+ *
+ * @param T [symbol] Tree name.
+ * @param tree [UBTree(T)*] Tree instance.
+ * @param start [ub_key] Start of the range.
+ * @param end [ub_key] End of the range (excluded).
+ * @param loop [symbol] Name of the iterator variable.
+ *
+ * @note Keys are compared against the bounds only once, before iterating.
+ *
+ * @public @related UBTree
+ */
+#define ubtree_foreach_range(T, tree, start, end, loop)                                            \
+    for (UBTreeLoop(T) p_bt_end_##loop,                                                            \
+         loop = P_ULIB_MACRO_CONCAT(p_ubtree_range_, T)(tree, start, end, &p_bt_end_##loop);       \
+         loop._leaf != p_bt_end_##loop._leaf || loop._i != p_bt_end_##loop._i;                     \
+         ubtree_loop_next(T, &loop))
+
+/// @name Map-specific API
+
+/**
+ * Returns the value associated with the specified key.
+ *
+ * @param T [symbol] Tree name.
+ * @param tree [UBTree(T)*] Tree instance.
+ * @param key [ub_key] Key.
+ * @param if_missing [ub_val] Value returned if the key is not present.
+ * @return [ub_val] Value associated with the key, or if_missing.
+ *
+ * @public @related UBTree
+ */
+#define ubmap_get(T, tree, key, if_missing)                                                        \
+    P_ULIB_MACRO_CONCAT(ubmap_get_, T)(tree, key, if_missing)
+
+/**
+ * Adds a key:value pair to the map, returning the replaced value (if any).
+ *
+ * @param T [symbol] Tree name.
+ * @param tree [UBTree(T)*] Tree instance.
+ * @param key [ub_key] Key.
+ * @param val [ub_val] Value.
+ * @param[out] existing [ub_val*] Existing value, only set if the key was already in the map.
+ * @return [ubtree_ret] Return code (see ubtree_ret).
+ *
+ * @public @related UBTree
+ */
+#define ubmap_set(T, tree, key, val, existing)                                                     \
+    P_ULIB_MACRO_CONCAT(ubmap_set_, T)(tree, key, val, existing)
+
+/// @name Set-specific API
+
+/**
+ * Inserts a key into the set.
+ *
+ * @param T [symbol] Tree name.
+ * @param tree [UBTree(T)*] Tree instance.
+ * @param key [ub_key] Key.
+ * @return [ubtree_ret] Return code (see ubtree_ret).
+ *
+ * @note The value associated with the key is left uninitialized.
+ *
+ * @public @related UBTree
+ */
+#define ubset_insert(T, tree, key) P_ULIB_MACRO_CONCAT(ubset_insert_, T)(tree, key)
+
+ULIB_END_DECLS
+
+#endif // UBTREE_H
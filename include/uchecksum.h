@@ -0,0 +1,138 @@
+/**
+ * Checksums and checksumming streams.
+ *
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UCHECKSUM_H
+#define UCHECKSUM_H
+
+#include "ustd.h"
+#include "ustream.h"
+
+ULIB_BEGIN_DECLS
+
+/// Checksum algorithms.
+typedef enum uchecksum_type {
+
+    /// CRC-32C (Castagnoli), hardware-accelerated where available.
+    UCHECKSUM_CRC32C = 0,
+
+    /// 64-bit xxHash (XXH64), with a zero seed.
+    UCHECKSUM_XXH64
+
+} uchecksum_type;
+
+/// Incrementally computed checksum.
+typedef struct UChecksum {
+
+    /// Checksum algorithm.
+    uchecksum_type type;
+
+    /// @cond
+    uint64_t _state[4];
+    uint64_t _length;
+    ulib_byte _buf[32];
+    /// @endcond
+
+} UChecksum;
+
+/**
+ * Initializes a new checksum.
+ *
+ * @param type Checksum algorithm.
+ * @return Checksum of no data.
+ *
+ * @public @memberof UChecksum
+ */
+ULIB_PUBLIC
+UChecksum uchecksum(uchecksum_type type);
+
+/**
+ * Updates the checksum with the specified data.
+ *
+ * @param checksum Checksum.
+ * @param data Data.
+ * @param size Size of the data.
+ *
+ * @public @memberof UChecksum
+ */
+ULIB_PUBLIC
+void uchecksum_update(UChecksum *checksum, void const *data, size_t size);
+
+/**
+ * Returns the checksum of the data it has been updated with.
+ *
+ * @param checksum Checksum.
+ * @return Checksum value.
+ *
+ * @note The checksum can still be updated after calling this function.
+ *
+ * @public @memberof UChecksum
+ */
+ULIB_PUBLIC
+uint64_t uchecksum_value(UChecksum const *checksum);
+
+/**
+ * Updates a CRC-32C checksum with the specified data.
+ *
+ * @param crc Checksum of the preceding data, or zero.
+ * @param data Data.
+ * @param size Size of the data.
+ * @return Updated checksum.
+ */
+ULIB_PUBLIC
+uint32_t ucrc32c(uint32_t crc, void const *data, size_t size);
+
+/**
+ * Computes the 64-bit xxHash of the specified data.
+ *
+ * @param data Data.
+ * @param size Size of the data.
+ * @param seed Seed.
+ * @return Hash value.
+ */
+ULIB_PUBLIC
+uint64_t uxxh64(void const *data, size_t size, uint64_t seed);
+
+/**
+ * Initializes a stream that reads from the specified stream, checksumming the data it reads.
+ *
+ * @param stream Input stream.
+ * @param src Stream to read from.
+ * @param checksum Checksum to update.
+ * @return Return code.
+ *
+ * @note Peeking is forwarded to the source stream, and peeked data is checksummed in place
+ *       as it is consumed. Resetting the stream also resets the checksum.
+ *       Calling `uistream_deinit` also deinitializes the source stream.
+ *
+ * @public @memberof UIStream
+ */
+ULIB_PUBLIC
+ustream_ret uistream_checksum(UIStream *stream, UIStream *src, UChecksum *checksum);
+
+/**
+ * Initializes a stream that writes to the specified stream, checksumming the data it writes.
+ *
+ * @param stream Output stream.
+ * @param dst Stream to write to.
+ * @param checksum Checksum to update.
+ * @return Return code.
+ *
+ * @note Data is passed through to the destination stream as is.
+ *       Calling `uostream_deinit` also deinitializes the destination stream.
+ *
+ * @public @memberof UOStream
+ */
+ULIB_PUBLIC
+ustream_ret uostream_checksum(UOStream *stream, UOStream *dst, UChecksum *checksum);
+
+ULIB_END_DECLS
+
+#endif // UCHECKSUM_H
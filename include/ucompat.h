@@ -87,6 +87,33 @@
     #define p_ulib_analyzer_assert(exp)
 #endif
 
+// Prefetches the cache line containing the specified address.
+#if (defined __clang__ && __clang_major__ >= 3) || (defined __GNUC__ && __GNUC__ >= 4)
+    #define p_ulib_prefetch(addr) __builtin_prefetch(addr)
+#else
+    #define p_ulib_prefetch(addr) ((void)(addr))
+#endif
+
+// SIMD instruction sets available to generic code (define ULIB_NO_SIMD to disable).
+#if !defined(ULIB_NO_SIMD)
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define P_ULIB_SIMD_SSE2 1
+    #elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+        #define P_ULIB_SIMD_NEON 1
+    #endif
+#endif
+
+// Storage class of per-thread variables (plain static storage if threads are disabled).
+#if defined(ULIB_NO_THREADS)
+    #define p_ulib_thread_local
+#elif defined(__cplusplus)
+    #define p_ulib_thread_local thread_local
+#elif defined(_MSC_VER)
+    #define p_ulib_thread_local __declspec(thread)
+#else
+    #define p_ulib_thread_local _Thread_local
+#endif
+
 // Concatenates the 'a' and 'b' tokens, allowing 'a' and 'b' to be macro-expanded.
 #define P_ULIB_MACRO_CONCAT(a, b) P_ULIB_MACRO_CONCAT_INNER(a, b)
 #define P_ULIB_MACRO_CONCAT_INNER(a, b) a##b
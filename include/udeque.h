@@ -0,0 +1,575 @@
+/**
+ * A type-safe, generic C double-ended queue.
+ *
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UDEQUE_H
+#define UDEQUE_H
+
+#include "ulib_ret.h"
+#include "ustd.h"
+
+ULIB_BEGIN_DECLS
+
+/**
+ * A type safe, generic double-ended queue, backed by a ring buffer.
+ *
+ * Elements can be pushed and popped at both ends in constant time. The capacity of the buffer
+ * is always a power of two, so that indices can be wrapped via masking.
+ *
+ * @struct UDeque
+ */
+
+/// Minimum capacity of dynamically allocated deques.
+#ifndef UDEQUE_MIN_SIZE
+#define UDEQUE_MIN_SIZE 8
+#endif
+
+/*
+ * Defines a new deque struct.
+ *
+ * @param T [symbol] Deque type.
+ */
+#define P_UDEQUE_DEF_TYPE(T)                                                                       \
+    typedef struct UDeque_##T {                                                                    \
+        /** @cond */                                                                               \
+        T *_data;                                                                                  \
+        ulib_uint _size;                                                                           \
+        ulib_uint _head;                                                                           \
+        ulib_uint _count;                                                                          \
+        bool _fixed;                                                                               \
+        /** @endcond */                                                                            \
+    } UDeque_##T;
+
+/*
+ * Generates function declarations for the specified deque type.
+ *
+ * @param T [symbol] Deque type.
+ * @param SCOPE [scope] Scope of the declarations.
+ */
+#define P_UDEQUE_DECL(T, SCOPE)                                                                    \
+    /** @cond */                                                                                   \
+    SCOPE ulib_ret udeque_reserve_##T(UDeque_##T *dq, ulib_uint size);                             \
+    SCOPE ulib_ret udeque_push_back_array_##T(UDeque_##T *dq, T const *array, ulib_uint n);        \
+    SCOPE ulib_uint udeque_pop_front_array_##T(UDeque_##T *dq, T *array, ulib_uint n);             \
+    /** @endcond */
+
+/*
+ * Generates inline function definitions for the specified deque type.
+ *
+ * @param T [symbol] Deque type.
+ * @param SCOPE [scope] Scope of the definitions.
+ */
+#define P_UDEQUE_DEF_INLINE(T, SCOPE)                                                              \
+    /** @cond */                                                                                   \
+    SCOPE static inline UDeque_##T udeque_##T(void) {                                              \
+        UDeque_##T dq = { 0 };                                                                     \
+        return dq;                                                                                 \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline UDeque_##T udeque_with_buffer_##T(T *buffer, ulib_uint size) {             \
+        while (size & (size - 1)) size &= size - 1;                                                \
+        UDeque_##T dq = { 0 };                                                                     \
+        dq._data = buffer;                                                                         \
+        dq._size = size;                                                                           \
+        dq._fixed = true;                                                                          \
+        return dq;                                                                                 \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline void udeque_deinit_##T(UDeque_##T *dq) {                                   \
+        if (!dq->_fixed) {                                                                         \
+            ulib_free(dq->_data);                                                                  \
+            dq->_data = NULL;                                                                      \
+            dq->_size = 0;                                                                         \
+        }                                                                                          \
+        dq->_head = dq->_count = 0;                                                                \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline T *udeque_at_##T(UDeque_##T const *dq, ulib_uint idx) {                    \
+        return dq->_data + ((dq->_head + idx) & (dq->_size - 1));                                  \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline ulib_ret udeque_push_back_##T(UDeque_##T *dq, T item) {                    \
+        if (dq->_count == dq->_size) {                                                             \
+            ulib_ret ret = udeque_reserve_##T(dq, dq->_count + 1);                                 \
+            if (ret) return ret;                                                                   \
+        }                                                                                          \
+        *udeque_at_##T(dq, dq->_count++) = item;                                                   \
+        return ULIB_OK;                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline ulib_ret udeque_push_front_##T(UDeque_##T *dq, T item) {                   \
+        if (dq->_count == dq->_size) {                                                             \
+            ulib_ret ret = udeque_reserve_##T(dq, dq->_count + 1);                                 \
+            if (ret) return ret;                                                                   \
+        }                                                                                          \
+        dq->_head = (dq->_head - 1) & (dq->_size - 1);                                             \
+        dq->_data[dq->_head] = item;                                                               \
+        dq->_count++;                                                                              \
+        return ULIB_OK;                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline T udeque_pop_back_##T(UDeque_##T *dq) {                                    \
+        return *udeque_at_##T(dq, --dq->_count);                                                   \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline T udeque_pop_front_##T(UDeque_##T *dq) {                                   \
+        T item = dq->_data[dq->_head];                                                             \
+        dq->_head = (dq->_head + 1) & (dq->_size - 1);                                             \
+        dq->_count--;                                                                              \
+        return item;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline T *udeque_front_span_##T(UDeque_##T const *dq, ulib_uint *n) {             \
+        ulib_uint const tail = dq->_size - dq->_head;                                              \
+        *n = dq->_count < tail ? dq->_count : tail;                                                \
+        return dq->_data + dq->_head;                                                              \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline T *udeque_back_span_##T(UDeque_##T const *dq, ulib_uint *n) {              \
+        ulib_uint const tail = dq->_size - dq->_head;                                              \
+        *n = dq->_count > tail ? dq->_count - tail : 0;                                            \
+        return dq->_data;                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline T *udeque_free_span_##T(UDeque_##T const *dq, ulib_uint *n) {              \
+        if (dq->_count == dq->_size) {                                                             \
+            *n = 0;                                                                                \
+            return dq->_data;                                                                      \
+        }                                                                                          \
+        ulib_uint const start = (dq->_head + dq->_count) & (dq->_size - 1);                        \
+        *n = start < dq->_head ? dq->_head - start : dq->_size - start;                            \
+        return dq->_data + start;                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline void udeque_commit_back_##T(UDeque_##T *dq, ulib_uint n) {                 \
+        dq->_count += n;                                                                           \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline void udeque_consume_front_##T(UDeque_##T *dq, ulib_uint n) {               \
+        dq->_head = (dq->_head + n) & (dq->_size - 1);                                             \
+        dq->_count -= n;                                                                           \
+    }                                                                                              \
+    /** @endcond */
+
+/*
+ * Generates function definitions for the specified deque type.
+ *
+ * @param T [symbol] Deque type.
+ * @param SCOPE [scope] Scope of the definitions.
+ */
+#define P_UDEQUE_IMPL(T, SCOPE)                                                                    \
+                                                                                                   \
+    SCOPE ulib_ret udeque_reserve_##T(UDeque_##T *dq, ulib_uint size) {                            \
+        if (size <= dq->_size) return ULIB_OK;                                                     \
+        if (dq->_fixed) return ULIB_ERR;                                                           \
+                                                                                                   \
+        ulib_uint new_size = dq->_size ? dq->_size : UDEQUE_MIN_SIZE;                              \
+        while (new_size < size) {                                                                  \
+            if (new_size > ULIB_UINT_MAX / 2) return ULIB_ERR_MEM;                                 \
+            new_size <<= 1;                                                                        \
+        }                                                                                          \
+                                                                                                   \
+        T *data = (T *)ulib_malloc(new_size * sizeof(T));                                          \
+        if (!data) return ULIB_ERR_MEM;                                                            \
+                                                                                                   \
+        ulib_uint first, second;                                                                   \
+        T *front = udeque_front_span_##T(dq, &first);                                              \
+        T *back = udeque_back_span_##T(dq, &second);                                               \
+        if (first) memcpy(data, front, first * sizeof(T));                                         \
+        if (second) memcpy(data + first, back, second * sizeof(T));                                \
+                                                                                                   \
+        ulib_free(dq->_data);                                                                      \
+        dq->_data = data;                                                                          \
+        dq->_size = new_size;                                                                      \
+        dq->_head = 0;                                                                             \
+        return ULIB_OK;                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE ulib_ret udeque_push_back_array_##T(UDeque_##T *dq, T const *array, ulib_uint n) {       \
+        if (n > ULIB_UINT_MAX - dq->_count) return ULIB_ERR_MEM;                                   \
+        ulib_ret ret = udeque_reserve_##T(dq, dq->_count + n);                                     \
+        if (ret) return ret;                                                                       \
+                                                                                                   \
+        while (n) {                                                                                \
+            ulib_uint span;                                                                        \
+            T *dst = udeque_free_span_##T(dq, &span);                                              \
+            if (span > n) span = n;                                                                \
+            memcpy(dst, array, span * sizeof(T));                                                  \
+            dq->_count += span;                                                                    \
+            array += span;                                                                         \
+            n -= span;                                                                             \
+        }                                                                                          \
+                                                                                                   \
+        return ULIB_OK;                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE ulib_uint udeque_pop_front_array_##T(UDeque_##T *dq, T *array, ulib_uint n) {            \
+        if (n > dq->_count) n = dq->_count;                                                        \
+                                                                                                   \
+        for (ulib_uint left = n; left;) {                                                          \
+            ulib_uint span;                                                                        \
+            T *src = udeque_front_span_##T(dq, &span);                                             \
+            if (span > left) span = left;                                                          \
+            memcpy(array, src, span * sizeof(T));                                                  \
+            udeque_consume_front_##T(dq, span);                                                    \
+            array += span;                                                                         \
+            left -= span;                                                                          \
+        }                                                                                          \
+                                                                                                   \
+        return n;                                                                                  \
+    }
+
+/// @name Type definitions
+
+/**
+ * Declares a new deque type.
+ *
+ * @param T [symbol] Deque type.
+ *
+ * @public @related UDeque
+ */
+#define UDEQUE_DECL(T)                                                                             \
+    P_UDEQUE_DEF_TYPE(T)                                                                           \
+    P_UDEQUE_DECL(T, ulib_unused)                                                                  \
+    P_UDEQUE_DEF_INLINE(T, ulib_unused)
+
+/**
+ * Declares a new deque type, prepending a specifier to the generated declarations.
+ *
+ * @param T [symbol] Deque type.
+ * @param SPEC [specifier] Specifier.
+ *
+ * @public @related UDeque
+ */
+#define UDEQUE_DECL_SPEC(T, SPEC)                                                                  \
+    P_UDEQUE_DEF_TYPE(T)                                                                           \
+    P_UDEQUE_DECL(T, SPEC ulib_unused)                                                             \
+    P_UDEQUE_DEF_INLINE(T, ulib_unused)
+
+/**
+ * Implements a previously declared deque type.
+ *
+ * @param T [symbol] Deque type.
+ *
+ * @public @related UDeque
+ */
+#define UDEQUE_IMPL(T) P_UDEQUE_IMPL(T, ulib_unused)
+
+/**
+ * Defines a new static deque type.
+ *
+ * @param T [symbol] Deque type.
+ *
+ * @public @related UDeque
+ */
+#define UDEQUE_INIT(T)                                                                             \
+    P_UDEQUE_DEF_TYPE(T)                                                                           \
+    P_UDEQUE_DECL(T, static inline ulib_unused)                                                    \
+    P_UDEQUE_DEF_INLINE(T, ulib_unused)                                                            \
+    P_UDEQUE_IMPL(T, static inline ulib_unused)
+
+/**
+ * Deque type.
+ *
+ * @param T [symbol] Deque type.
+ *
+ * @public @related UDeque
+ */
+#define UDeque(T) P_ULIB_MACRO_CONCAT(UDeque_, T)
+
+/// @name Memory management
+
+/**
+ * Initializes a new, empty deque.
+ *
+ * @param T [symbol] Deque type.
+ * @return [UDeque(T)] Initialized deque instance.
+ *
+ * @note The returned deque must be deinitialized via udeque_deinit.
+ *
+ * @public @related UDeque
+ */
+#define udeque(T) P_ULIB_MACRO_CONCAT(udeque_, T)()
+
+/**
+ * Initializes a new fixed-capacity deque, backed by the specified buffer.
+ *
+ * @param T [symbol] Deque type.
+ * @param buffer [T*] Buffer.
+ * @param size [ulib_uint] Number of elements the buffer can hold.
+ * @return [UDeque(T)] Initialized deque instance.
+ *
+ * @note The deque never allocates, and operations that would exceed its capacity
+ *       return ULIB_ERR. If the size of the buffer is not a power of two,
+ *       only its largest power of two prefix is used.
+ * @note The buffer is not owned by the deque, and must outlive it.
+ *
+ * @public @related UDeque
+ */
+#define udeque_with_buffer(T, buffer, size)                                                        \
+    P_ULIB_MACRO_CONCAT(udeque_with_buffer_, T)(buffer, size)
+
+/**
+ * De-initializes a deque previously initialized via udeque or udeque_with_buffer.
+ *
+ * @param T [symbol] Deque type.
+ * @param dq [UDeque(T)*] Deque to de-initialize.
+ *
+ * @public @related UDeque
+ */
+#define udeque_deinit(T, dq) P_ULIB_MACRO_CONCAT(udeque_deinit_, T)(dq)
+
+/**
+ * Ensures that the deque can hold at least the specified number of elements.
+ *
+ * @param T [symbol] Deque type.
+ * @param dq [UDeque(T)*] Deque instance.
+ * @param size [ulib_uint] Number of elements.
+ * @return [ulib_ret] ULIB_OK on success, ULIB_ERR_MEM if memory could not be allocated,
+ *                    or ULIB_ERR if the deque has a fixed capacity that is too small.
+ *
+ * @public @related UDeque
+ */
+#define udeque_reserve(T, dq, size) P_ULIB_MACRO_CONCAT(udeque_reserve_, T)(dq, size)
+
+/// @name Primitives
+
+/**
+ * Returns the number of elements in the deque.
+ *
+ * @param T [symbol] Deque type.
+ * @param dq [UDeque(T)*] Deque instance.
+ * @return [ulib_uint] Number of elements.
+ *
+ * @public @related UDeque
+ */
+#define udeque_count(T, dq) (((UDeque(T) *)(dq))->_count)
+
+/**
+ * Returns the number of elements the deque can hold without reallocating.
+ *
+ * @param T [symbol] Deque type.
+ * @param dq [UDeque(T)*] Deque instance.
+ * @return [ulib_uint] Capacity of the deque.
+ *
+ * @public @related UDeque
+ */
+#define udeque_size(T, dq) (((UDeque(T) *)(dq))->_size)
+
+/**
+ * Returns the element at the specified index, counting from the front.
+ *
+ * @param T [symbol] Deque type.
+ * @param dq [UDeque(T)*] Deque instance.
+ * @param idx [ulib_uint] Index.
+ * @return [T] Element at the specified index.
+ *
+ * @public @related UDeque
+ */
+#define udeque_get(T, dq, idx) (*P_ULIB_MACRO_CONCAT(udeque_at_, T)(dq, idx))
+
+/**
+ * Replaces the element at the specified index, counting from the front.
+ *
+ * @param T [symbol] Deque type.
+ * @param dq [UDeque(T)*] Deque instance.
+ * @param idx [ulib_uint] Index.
+ * @param item [T] Replacement element.
+ *
+ * @public @related UDeque
+ */
+#define udeque_set(T, dq, idx, item) (*P_ULIB_MACRO_CONCAT(udeque_at_, T)(dq, idx) = (item))
+
+/**
+ * Returns the first element of the deque.
+ *
+ * @param T [symbol] Deque type.
+ * @param dq [UDeque(T)*] Deque instance.
+ * @return [T] First element.
+ *
+ * @warning Calling this on an empty deque results in undefined behavior.
+ *
+ * @public @related UDeque
+ */
+#define udeque_first(T, dq) udeque_get(T, dq, 0)
+
+/**
+ * Returns the last element of the deque.
+ *
+ * @param T [symbol] Deque type.
+ * @param dq [UDeque(T)*] Deque instance.
+ * @return [T] Last element.
+ *
+ * @warning Calling this on an empty deque results in undefined behavior.
+ *
+ * @public @related UDeque
+ */
+#define udeque_last(T, dq) udeque_get(T, dq, udeque_count(T, dq) - 1)
+
+/**
+ * Pushes the specified element to the back of the deque.
+ * Amortized performance: O(1)
+ *
+ * @param T [symbol] Deque type.
+ * @param dq [UDeque(T)*] Deque instance.
+ * @param item [T] Element to push.
+ * @return [ulib_ret] ULIB_OK on success, otherwise an error code.
+ *
+ * @public @related UDeque
+ */
+#define udeque_push_back(T, dq, item) P_ULIB_MACRO_CONCAT(udeque_push_back_, T)(dq, item)
+
+/**
+ * Pushes the specified element to the front of the deque.
+ * Amortized performance: O(1)
+ *
+ * @param T [symbol] Deque type.
+ * @param dq [UDeque(T)*] Deque instance.
+ * @param item [T] Element to push.
+ * @return [ulib_ret] ULIB_OK on success, otherwise an error code.
+ *
+ * @public @related UDeque
+ */
+#define udeque_push_front(T, dq, item) P_ULIB_MACRO_CONCAT(udeque_push_front_, T)(dq, item)
+
+/**
+ * Removes and returns the element at the back of the deque.
+ *
+ * @param T [symbol] Deque type.
+ * @param dq [UDeque(T)*] Deque instance.
+ * @return [T] Removed element.
+ *
+ * @warning Calling this on an empty deque results in undefined behavior.
+ *
+ * @public @related UDeque
+ */
+#define udeque_pop_back(T, dq) P_ULIB_MACRO_CONCAT(udeque_pop_back_, T)(dq)
+
+/**
+ * Removes and returns the element at the front of the deque.
+ *
+ * @param T [symbol] Deque type.
+ * @param dq [UDeque(T)*] Deque instance.
+ * @return [T] Removed element.
+ *
+ * @warning Calling this on an empty deque results in undefined behavior.
+ *
+ * @public @related UDeque
+ */
+#define udeque_pop_front(T, dq) P_ULIB_MACRO_CONCAT(udeque_pop_front_, T)(dq)
+
+/**
+ * Removes all the elements in the deque.
+ *
+ * @param T [symbol] Deque type.
+ * @param dq [UDeque(T)*] Deque instance.
+ *
+ * @public @related UDeque
+ */
+#define udeque_remove_all(T, dq) ((void)(((UDeque(T) *)(dq))->_head = 0, udeque_count(T, dq) = 0))
+
+/// @name Bulk operations
+
+/**
+ * Pushes the elements of an array to the back of the deque.
+ *
+ * @param T [symbol] Deque type.
+ * @param dq [UDeque(T)*] Deque instance.
+ * @param array [T const*] Array.
+ * @param n [ulib_uint] Number of elements.
+ * @return [ulib_ret] ULIB_OK on success, otherwise an error code.
+ *
+ * @public @related UDeque
+ */
+#define udeque_push_back_array(T, dq, array, n)                                                    \
+    P_ULIB_MACRO_CONCAT(udeque_push_back_array_, T)(dq, array, n)
+
+/**
+ * Removes elements from the front of the deque, copying them to an array.
+ *
+ * @param T [symbol] Deque type.
+ * @param dq [UDeque(T)*] Deque instance.
+ * @param array [T*] Array.
+ * @param n [ulib_uint] Maximum number of elements.
+ * @return [ulib_uint] Number of removed elements.
+ *
+ * @public @related UDeque
+ */
+#define udeque_pop_front_array(T, dq, array, n)                                                    \
+    P_ULIB_MACRO_CONCAT(udeque_pop_front_array_, T)(dq, array, n)
+
+/**
+ * Returns the first contiguous run of elements, starting from the front of the deque.
+ *
+ * @param T [symbol] Deque type.
+ * @param dq [UDeque(T)*] Deque instance.
+ * @param[out] n [ulib_uint*] Number of elements in the run.
+ * @return [T*] Pointer to the first element of the run.
+ *
+ * @note Elements of the deque are stored in at most two runs: the one returned by
+ *       this function, followed by the one returned by udeque_back_span.
+ *
+ * @public @related UDeque
+ */
+#define udeque_front_span(T, dq, n) P_ULIB_MACRO_CONCAT(udeque_front_span_, T)(dq, n)
+
+/**
+ * Returns the second contiguous run of elements, ending at the back of the deque.
+ *
+ * @param T [symbol] Deque type.
+ * @param dq [UDeque(T)*] Deque instance.
+ * @param[out] n [ulib_uint*] Number of elements in the run, zero if the elements
+ *                            are stored contiguously.
+ * @return [T*] Pointer to the first element of the run.
+ *
+ * @public @related UDeque
+ */
+#define udeque_back_span(T, dq, n) P_ULIB_MACRO_CONCAT(udeque_back_span_, T)(dq, n)
+
+/**
+ * Returns the contiguous run of free slots following the back of the deque.
+ *
+ * @param T [symbol] Deque type.
+ * @param dq [UDeque(T)*] Deque instance.
+ * @param[out] n [ulib_uint*] Number of free slots in the run.
+ * @return [T*] Pointer to the first free slot.
+ *
+ * @note Slots filled by the caller become part of the deque via udeque_commit_back.
+ *
+ * @public @related UDeque
+ */
+#define udeque_free_span(T, dq, n) P_ULIB_MACRO_CONCAT(udeque_free_span_, T)(dq, n)
+
+/**
+ * Appends the specified number of elements, previously written to the slots returned
+ * by udeque_free_span, to the back of the deque.
+ *
+ * @param T [symbol] Deque type.
+ * @param dq [UDeque(T)*] Deque instance.
+ * @param n [ulib_uint] Number of elements.
+ *
+ * @public @related UDeque
+ */
+#define udeque_commit_back(T, dq, n) P_ULIB_MACRO_CONCAT(udeque_commit_back_, T)(dq, n)
+
+/**
+ * Removes the specified number of elements from the front of the deque.
+ *
+ * @param T [symbol] Deque type.
+ * @param dq [UDeque(T)*] Deque instance.
+ * @param n [ulib_uint] Number of elements.
+ *
+ * @public @related UDeque
+ */
+#define udeque_consume_front(T, dq, n) P_ULIB_MACRO_CONCAT(udeque_consume_front_, T)(dq, n)
+
+ULIB_END_DECLS
+
+#endif // UDEQUE_H
@@ -15,6 +15,7 @@
 #define UHASH_H
 
 #include "ustd.h"
+#include "uthread.h"
 
 /**
  * A type safe, generic hash table.
@@ -55,6 +56,21 @@ typedef enum uhash_ret {
 #define UHASH_MAX_LOAD 0.77
 #endif
 
+/// Number of keys whose buckets are prefetched together by batched operations.
+#ifndef UHASH_BATCH_SIZE
+#define UHASH_BATCH_SIZE 16U
+#endif
+
+/// Number of buckets moved by each insertion into an incremental hash table being resized.
+#ifndef UHASH_MIGRATE_STEP
+#define UHASH_MIGRATE_STEP 16U
+#endif
+
+/// Number of independently locked shards of concurrent hash tables (power of two, max 256).
+#ifndef UHASH_CONCURRENT_SHARDS
+#define UHASH_CONCURRENT_SHARDS 16U
+#endif
+
 // uhash_combine_hash constants.
 #if ULIB_TINY
 
@@ -86,14 +102,27 @@ typedef enum uhash_ret {
 #define p_uhf_set_isboth_false(flag, i) ((flag)[(i) >> 4U] &= ~(3UL << (((i)&0xfU) << 1U)))
 #define p_uhf_set_isdel_true(flag, i) ((flag)[(i) >> 4U] |= 1UL << (((i)&0xfU) << 1U))
 
+// Control bytes manipulation macros (SIMD hash tables).
+#define P_UHASH_GROUP_SIZE 16U
+#define P_UHASH_CTRL_EMPTY 0x80U
+#define P_UHASH_CTRL_DELETED 0xfeU
+#define p_uhc_isfull(ctrl, i) (!((ctrl)[i] & 0x80U))
+#define p_uhc_group(i) ((i) & ~(ulib_uint)(P_UHASH_GROUP_SIZE - 1))
+#define p_uhc_h1(hash) ((ulib_uint)(hash))
+#define p_uhc_h2(hash) ((ulib_byte)((hash) >> (sizeof(ulib_uint) * 8U - 7U)))
+
+// Maximum probe distance (Robin Hood hash tables), stored plus one in 16 bits (0 = empty bucket).
+#define P_UHASH_RH_MAX_DIST UINT16_MAX
+
 /*
  * Computes the maximum number of elements that the table can contain
- * before it needs to be resized in order to keep its load factor under UHASH_MAX_LOAD.
+ * before it needs to be resized in order to keep its load factor under the specified maximum.
  *
  * @param buckets [ulib_uint] Number of buckets.
+ * @param max_load [double] Maximum load factor.
  * @return [ulib_uint] Upper bound.
  */
-#define p_uhash_upper_bound(buckets) ((ulib_uint)((buckets)*UHASH_MAX_LOAD + 0.5))
+#define p_uhash_upper_bound(buckets, max_load) ((ulib_uint)((buckets) * (max_load) + 0.5))
 
 /*
  * Combines two hashes.
@@ -150,6 +179,125 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
 
 #endif
 
+/*
+ * Mixes the bits of a hash value, so that both its high and low bits are usable for probing.
+ *
+ * @param hash Hash value.
+ * @return Mixed hash value.
+ */
+static inline ulib_uint p_uhash_mix(ulib_uint hash) {
+    hash *= P_UHASH_COMBINE_MAGIC;
+    return hash ^ (hash >> (sizeof(ulib_uint) * 4U));
+}
+
+/*
+ * Returns the shard of a concurrent hash table that holds keys with the specified hash.
+ * Shards are selected via the high bits of the hash, which are unrelated to those
+ * used for probing within each shard.
+ *
+ * @param hash Hash value.
+ * @return Shard index.
+ */
+static inline ulib_uint p_uhash_shard(ulib_uint hash) {
+    hash = (ulib_uint)(hash * P_UHASH_COMBINE_MAGIC) >> (sizeof(ulib_uint) * 8U - 8U);
+    return hash & (UHASH_CONCURRENT_SHARDS - 1U);
+}
+
+/*
+ * Group matching primitives for SIMD hash tables. They return a bitmask with at least one bit
+ * set for each control byte of the group that satisfies the condition, and the indices
+ * of the matching buckets can be extracted via p_uhash_group_next.
+ */
+#if defined(P_ULIB_SIMD_SSE2)
+
+#include <emmintrin.h>
+
+#define P_UHASH_GROUP_SHIFT 0U
+
+static inline uint64_t p_uhash_group_match(ulib_byte const *group, ulib_byte ctrl) {
+    __m128i g = _mm_loadu_si128((__m128i const *)group);
+    return (uint64_t)(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8((char)ctrl)));
+}
+
+static inline uint64_t p_uhash_group_match_free(ulib_byte const *group) {
+    return (uint64_t)(unsigned)_mm_movemask_epi8(_mm_loadu_si128((__m128i const *)group));
+}
+
+#elif defined(P_ULIB_SIMD_NEON)
+
+#include <arm_neon.h>
+
+#define P_UHASH_GROUP_SHIFT 2U
+
+static inline uint64_t p_uhash_group_neon_mask(uint8x16_t match) {
+    uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(match), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) & 0x8888888888888888ULL;
+}
+
+static inline uint64_t p_uhash_group_match(ulib_byte const *group, ulib_byte ctrl) {
+    return p_uhash_group_neon_mask(vceqq_u8(vld1q_u8(group), vdupq_n_u8(ctrl)));
+}
+
+static inline uint64_t p_uhash_group_match_free(ulib_byte const *group) {
+    return p_uhash_group_neon_mask(vtstq_u8(vld1q_u8(group), vdupq_n_u8(0x80U)));
+}
+
+#else
+
+#define P_UHASH_GROUP_SHIFT 0U
+
+static inline uint64_t p_uhash_group_match(ulib_byte const *group, ulib_byte ctrl) {
+    uint64_t mask = 0;
+    for (unsigned i = 0; i < P_UHASH_GROUP_SIZE; ++i) mask |= (uint64_t)(group[i] == ctrl) << i;
+    return mask;
+}
+
+static inline uint64_t p_uhash_group_match_free(ulib_byte const *group) {
+    uint64_t mask = 0;
+    for (unsigned i = 0; i < P_UHASH_GROUP_SIZE; ++i) mask |= (uint64_t)(group[i] >> 7U) << i;
+    return mask;
+}
+
+#endif
+
+#define p_uhash_group_match_empty(group) p_uhash_group_match(group, P_UHASH_CTRL_EMPTY)
+
+/*
+ * Returns the index of the lowest match in the bitmask, and removes it from the bitmask.
+ *
+ * @param mask Bitmask returned by one of the group matching primitives.
+ * @return Index of the matching bucket, relative to the start of the group.
+ */
+static inline ulib_uint p_uhash_group_next(uint64_t *mask) {
+#if defined(__GNUC__)
+    unsigned i = (unsigned)__builtin_ctzll(*mask);
+#else
+    unsigned i = 0;
+    while (!((*mask >> i) & 1U)) ++i;
+#endif
+    *mask &= *mask - 1;
+    return (ulib_uint)(i >> P_UHASH_GROUP_SHIFT);
+}
+
+/*
+ * Finds the first free bucket in the probe sequence of the specified hash.
+ *
+ * @param ctrl Control bytes.
+ * @param size Number of buckets.
+ * @param hash Mixed hash value.
+ * @return Index of the free bucket.
+ */
+static inline ulib_uint p_uhash_simd_find_free(ulib_byte const *ctrl, ulib_uint size,
+                                               ulib_uint hash) {
+    ulib_uint const mask = size / P_UHASH_GROUP_SIZE - 1;
+    ulib_uint g = p_uhc_h1(hash) & mask, step = 0;
+    uint64_t m;
+    while (!(m = p_uhash_group_match_free(ctrl + g * P_UHASH_GROUP_SIZE))) {
+        g = (g + (++step)) & mask;
+    }
+    return g * P_UHASH_GROUP_SIZE + p_uhash_group_next(&m);
+}
+
 #define P_UHASH_DEF_TYPE_HEAD(T, uh_key, uh_val)                                                   \
     typedef struct UHash_##T {                                                                     \
         /** @cond */                                                                               \
@@ -198,8 +346,137 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
     P_UHASH_DEF_TYPE_HEAD(T, uh_key, uh_val)                                                       \
     ulib_uint (*_hfunc)(uh_key key);                                                               \
     bool (*_efunc)(uh_key lhs, uh_key rhs);                                                        \
+    /** @cond */                                                                                   \
+    ulib_float _min_load;                                                                          \
+    ulib_float _max_deleted;                                                                       \
+    /** @endcond */                                                                                \
+    P_UHASH_DEF_TYPE_FOOT(T, uh_key, uh_val)
+
+/*
+ * Defines a new hash table type that stores the hash of each key.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [type] Hash table key type.
+ * @param uh_val [type] Hash table value type.
+ */
+#define P_UHASH_DEF_TYPE_CACHED_HASH(T, uh_key, uh_val)                                            \
+    P_UHASH_DEF_TYPE_HEAD(T, uh_key, uh_val)                                                       \
+    /** @cond */                                                                                   \
+    ulib_uint *_hashes;                                                                            \
+    /** @endcond */                                                                                \
+    P_UHASH_DEF_TYPE_FOOT(T, uh_key, uh_val)
+
+/*
+ * Defines a new hash table type that is resized incrementally.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [type] Hash table key type.
+ * @param uh_val [type] Hash table value type.
+ */
+#define P_UHASH_DEF_TYPE_INCREMENTAL(T, uh_key, uh_val)                                            \
+    P_UHASH_DEF_TYPE_HEAD(T, uh_key, uh_val)                                                       \
+    /** @cond */                                                                                   \
+    ulib_uint _old_size;                                                                           \
+    ulib_uint _migrated;                                                                           \
+    uint32_t *_old_flags;                                                                          \
+    uh_key *_old_keys;                                                                             \
+    uh_val *_old_vals;                                                                             \
+    /** @endcond */                                                                                \
+    P_UHASH_DEF_TYPE_FOOT(T, uh_key, uh_val)
+
+/*
+ * Defines a new hash table type that stores one control byte per bucket,
+ * probed in groups via SIMD instructions.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [type] Hash table key type.
+ * @param uh_val [type] Hash table value type.
+ */
+#define P_UHASH_DEF_TYPE_SIMD(T, uh_key, uh_val)                                                   \
+    typedef struct UHash_##T {                                                                     \
+        /** @cond */                                                                               \
+        ulib_uint _size;                                                                           \
+        ulib_uint _occupied;                                                                       \
+        ulib_uint _count;                                                                          \
+        ulib_byte *_ctrl;                                                                          \
+        uh_key *_keys;                                                                             \
+        uh_val *_vals;                                                                             \
+        /** @endcond */                                                                            \
+    P_UHASH_DEF_TYPE_FOOT(T, uh_key, uh_val)
+
+/*
+ * Defines a new hash table type that stores the probe distance of each bucket,
+ * managed via Robin Hood hashing.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [type] Hash table key type.
+ * @param uh_val [type] Hash table value type.
+ */
+#define P_UHASH_DEF_TYPE_ROBIN_HOOD(T, uh_key, uh_val)                                             \
+    typedef struct UHash_##T {                                                                     \
+        /** @cond */                                                                               \
+        ulib_uint _size;                                                                           \
+        ulib_uint _occupied;                                                                       \
+        ulib_uint _count;                                                                          \
+        uint16_t *_dist;                                                                           \
+        uh_key *_keys;                                                                             \
+        uh_val *_vals;                                                                             \
+        /** @endcond */                                                                            \
+    P_UHASH_DEF_TYPE_FOOT(T, uh_key, uh_val)
+
+/*
+ * Defines a new hash table type that stores each key next to its value.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [type] Hash table key type.
+ * @param uh_val [type] Hash table value type.
+ */
+#define P_UHASH_DEF_TYPE_INTERLEAVED(T, uh_key, uh_val)                                            \
+    /** @cond */                                                                                   \
+    typedef struct P_UHashSlot_##T {                                                               \
+        uh_key key;                                                                                \
+        uh_val val;                                                                                \
+    } P_UHashSlot_##T;                                                                             \
+    /** @endcond */                                                                                \
+                                                                                                   \
+    typedef struct UHash_##T {                                                                     \
+        /** @cond */                                                                               \
+        ulib_uint _size;                                                                           \
+        ulib_uint _occupied;                                                                       \
+        ulib_uint _count;                                                                          \
+        uint32_t *_flags;                                                                          \
+        P_UHashSlot_##T *_slots;                                                                   \
+        /** @endcond */                                                                            \
     P_UHASH_DEF_TYPE_FOOT(T, uh_key, uh_val)
 
+/*
+ * Defines a new concurrent hash table type, made of independently locked shards.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [type] Hash table key type.
+ * @param uh_val [type] Hash table value type.
+ */
+#define P_UHASH_DEF_TYPE_CONCURRENT(T, uh_key, uh_val)                                             \
+    P_UHASH_DEF_TYPE(p_shard_##T, uh_key, uh_val)                                                  \
+                                                                                                   \
+    /** @cond */                                                                                   \
+    typedef struct P_UHashShard_##T {                                                              \
+        URWLock lock;                                                                              \
+        UHash_p_shard_##T h;                                                                       \
+    } P_UHashShard_##T;                                                                            \
+    /** @endcond */                                                                                \
+                                                                                                   \
+    typedef struct UHash_##T {                                                                     \
+        /** @cond */                                                                               \
+        P_UHashShard_##T _shards[UHASH_CONCURRENT_SHARDS];                                         \
+        /** @endcond */                                                                            \
+    } UHash_##T;                                                                                   \
+                                                                                                   \
+    /** @cond */                                                                                   \
+    typedef uh_key uhash_##T##_key;                                                                \
+    typedef uh_val uhash_##T##_val;                                                                \
+    /** @endcond */
+
 /*
  * Generates function declarations for the specified hash table type.
  *
@@ -218,15 +495,24 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
     SCOPE uhash_ret uhash_resize_##T(UHash_##T *h, ulib_uint new_size);                            \
     SCOPE uhash_ret uhash_put_##T(UHash_##T *h, uh_key key, ulib_uint *idx);                       \
     SCOPE void uhash_delete_##T(UHash_##T *h, ulib_uint x);                                        \
+    SCOPE void uhash_get_batch_##T(UHash_##T const *h, uh_key const *keys, ulib_uint n,            \
+                                   ulib_uint *idx);                                                \
     SCOPE UHash_##T uhmap_##T(void);                                                               \
     SCOPE uh_val uhmap_get_##T(UHash_##T const *h, uh_key key, uh_val if_missing);                 \
     SCOPE uhash_ret uhmap_set_##T(UHash_##T *h, uh_key key, uh_val value, uh_val *existing);       \
     SCOPE uhash_ret uhmap_add_##T(UHash_##T *h, uh_key key, uh_val value, uh_val *existing);       \
+    SCOPE uhash_ret uhmap_set_batch_##T(UHash_##T *h, uh_key const *keys, uh_val const *vals,      \
+                                        ulib_uint n, uhash_ret *rets);                             \
     SCOPE bool uhmap_replace_##T(UHash_##T *h, uh_key key, uh_val value, uh_val *replaced);        \
     SCOPE bool uhmap_remove_##T(UHash_##T *h, uh_key key, uh_key *r_key, uh_val *r_val);           \
     SCOPE UHash_##T uhset_##T(void);                                                               \
     SCOPE uhash_ret uhset_insert_##T(UHash_##T *h, uh_key key, uh_key *existing);                  \
     SCOPE uhash_ret uhset_insert_all_##T(UHash_##T *h, uh_key const *items, ulib_uint n);          \
+    SCOPE uhash_ret uhset_insert_batch_##T(UHash_##T *h, uh_key const *keys, ulib_uint n,          \
+                                           uhash_ret *rets);                                       \
+    SCOPE uhash_ret uhset_from_array_##T(UHash_##T *h, uh_key const *items, ulib_uint n);          \
+    SCOPE uhash_ret uhmap_from_arrays_##T(UHash_##T *h, uh_key const *keys, uh_val const *vals,    \
+                                          ulib_uint n);                                            \
     SCOPE bool uhset_replace_##T(UHash_##T *h, uh_key key, uh_key *replaced);                      \
     SCOPE bool uhset_remove_##T(UHash_##T *h, uh_key key, uh_key *removed);                        \
     SCOPE bool uhset_is_superset_##T(UHash_##T const *h1, UHash_##T const *h2);                    \
@@ -252,21 +538,43 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
                                  bool (*equal_func)(uh_key lhs, uh_key rhs));                      \
     SCOPE UHash_##T uhset_pi_##T(ulib_uint (*hash_func)(uh_key key),                               \
                                  bool (*equal_func)(uh_key lhs, uh_key rhs));                      \
+    SCOPE void uhash_set_compaction_##T(UHash_##T *h, ulib_float min_load,                         \
+                                        ulib_float max_deleted);                                   \
     /** @endcond */
 
 /*
- * Generates inline function definitions for the specified hash table type.
+ * Generates function declarations for the specified concurrent hash table type.
+ *
+ * @param T [symbol] Hash table name.
+ * @param SCOPE [scope] Scope of the declarations.
+ * @param uh_key [type] Hash table key type.
+ * @param uh_val [type] Hash table value type.
+ */
+#define P_UHASH_DECL_CONCURRENT(T, SCOPE, uh_key, uh_val)                                          \
+    /** @cond */                                                                                   \
+    SCOPE UHash_##T uhmap_##T(void);                                                               \
+    SCOPE UHash_##T uhset_##T(void);                                                               \
+    SCOPE void uhash_deinit_##T(UHash_##T *h);                                                     \
+    SCOPE void uhash_clear_##T(UHash_##T *h);                                                      \
+    SCOPE ulib_uint uhash_count_##T(UHash_##T const *h);                                           \
+    SCOPE bool uhash_contains_##T(UHash_##T const *h, uh_key key);                                 \
+    SCOPE uh_val uhmap_get_##T(UHash_##T const *h, uh_key key, uh_val if_missing);                 \
+    SCOPE uhash_ret uhmap_set_##T(UHash_##T *h, uh_key key, uh_val value, uh_val *existing);       \
+    SCOPE uhash_ret uhmap_add_##T(UHash_##T *h, uh_key key, uh_val value, uh_val *existing);       \
+    SCOPE bool uhmap_replace_##T(UHash_##T *h, uh_key key, uh_val value, uh_val *replaced);        \
+    SCOPE bool uhmap_remove_##T(UHash_##T *h, uh_key key, uh_key *r_key, uh_val *r_val);           \
+    SCOPE uhash_ret uhset_insert_##T(UHash_##T *h, uh_key key, uh_key *existing);                  \
+    SCOPE bool uhset_remove_##T(UHash_##T *h, uh_key key, uh_key *removed);                        \
+    /** @endcond */
+
+/*
+ * Generates inline function definitions shared by all hash table types.
  *
  * @param T [symbol] Hash table name.
  * @param SCOPE [scope] Scope of the definitions.
  */
-#define P_UHASH_DEF_INLINE(T, SCOPE)                                                               \
+#define P_UHASH_DEF_INLINE_COMMON(T, SCOPE)                                                        \
     /** @cond */                                                                                   \
-    SCOPE static inline bool uhash_is_map_##T(UHash_##T const *h) {                                \
-        /* _occupied = 1 and _size = 0 is a marker for empty tables that are maps. */              \
-        return h->_vals || h->_occupied > h->_size;                                                \
-    }                                                                                              \
-                                                                                                   \
     SCOPE static inline UHash_##T uhash_move_##T(UHash_##T *h) {                                   \
         UHash_##T temp = *h, zero = { 0 };                                                         \
         *h = zero;                                                                                 \
@@ -274,7 +582,7 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
     }                                                                                              \
                                                                                                    \
     SCOPE static inline ulib_uint uhash_next_##T(UHash_##T const *h, ulib_uint i) {                \
-        for (; i < h->_size && !uhash_exists(T, h, i); ++i) {}                                     \
+        for (ulib_uint size = uhash_size_##T(h); i < size && !uhash_exists(T, h, i); ++i) {}       \
         return i;                                                                                  \
     }                                                                                              \
                                                                                                    \
@@ -282,112 +590,297 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
         return h1->_count == h2->_count && uhset_is_superset_##T(h1, h2);                          \
     }                                                                                              \
                                                                                                    \
+    SCOPE static inline ulib_uint uhash_count_##T(UHash_##T const *h) {                            \
+        return h->_count;                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline bool uhash_contains_##T(UHash_##T const *h, uhash_##T##_key key) {         \
+        return uhash_get_##T(h, key) != UHASH_INDEX_MISSING;                                       \
+    }                                                                                              \
+                                                                                                   \
     SCOPE static inline ulib_uint p_uhash_occupied_##T(UHash_##T const *h) {                       \
         return h->_occupied > h->_size ? 0 : h->_occupied;                                         \
     }                                                                                              \
     /** @endcond */
 
 /*
- * Generates init function definitions for the specified hash table type.
+ * Generates inline function definitions for the specified hash table type.
  *
  * @param T [symbol] Hash table name.
  * @param SCOPE [scope] Scope of the definitions.
+ * @param uh_key [type] Hash table key type.
+ * @param uh_val [type] Hash table value type.
  */
-#define P_UHASH_IMPL_INIT(T, SCOPE)                                                                \
+#define P_UHASH_DEF_INLINE(T, SCOPE, uh_key, uh_val)                                               \
+    /** @cond */                                                                                   \
+    SCOPE static inline bool uhash_is_map_##T(UHash_##T const *h) {                                \
+        /* _occupied = 1 and _size = 0 is a marker for empty tables that are maps. */              \
+        return h->_vals || h->_occupied > h->_size;                                                \
+    }                                                                                              \
                                                                                                    \
-    SCOPE UHash_##T uhmap_##T(void) {                                                              \
-        UHash_##T h = uhset_##T();                                                                 \
-        h._occupied = 1;                                                                           \
-        return h;                                                                                  \
+    SCOPE static inline bool uhash_exists_##T(UHash_##T const *h, ulib_uint i) {                   \
+        return !p_uhf_iseither(h->_flags, i);                                                      \
     }                                                                                              \
                                                                                                    \
-    SCOPE UHash_##T uhset_##T(void) {                                                              \
-        UHash_##T h = { 0 };                                                                       \
-        return h;                                                                                  \
-    }
+    SCOPE static inline ulib_uint uhash_size_##T(UHash_##T const *h) {                             \
+        return h->_size;                                                                           \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline uh_key *p_uhash_key_ptr_##T(UHash_##T const *h, ulib_uint i) {             \
+        return h->_keys + i;                                                                       \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline uh_val *p_uhash_val_ptr_##T(UHash_##T const *h, ulib_uint i) {             \
+        return h->_vals + i;                                                                       \
+    }                                                                                              \
+    /** @endcond */                                                                                \
+    P_UHASH_DEF_INLINE_COMMON(T, SCOPE)
 
 /*
- * Generates init function definitions for the specified hash table type
- * with per-instance hash and equality functions.
+ * Generates inline function definitions for the specified SIMD hash table type.
  *
  * @param T [symbol] Hash table name.
  * @param SCOPE [scope] Scope of the definitions.
  * @param uh_key [type] Hash table key type.
- * @param default_hfunc [(uh_key) -> ulib_uint] Default hash function (can be NULL).
- * @param default_efunc [(uh_key, uh_key) -> bool] Default equality function (can be NULL).
+ * @param uh_val [type] Hash table value type.
  */
-#define P_UHASH_IMPL_INIT_PI(T, SCOPE, uh_key, default_hfunc, default_efunc)                       \
+#define P_UHASH_DEF_INLINE_SIMD(T, SCOPE, uh_key, uh_val)                                          \
+    /** @cond */                                                                                   \
+    SCOPE static inline bool uhash_is_map_##T(UHash_##T const *h) {                                \
+        /* _occupied = 1 and _size = 0 is a marker for empty tables that are maps. */              \
+        return h->_vals || h->_occupied > h->_size;                                                \
+    }                                                                                              \
                                                                                                    \
-    SCOPE UHash_##T uhmap_##T(void) {                                                              \
-        UHash_##T h = uhset_##T();                                                                 \
-        h._occupied = 1;                                                                           \
-        return h;                                                                                  \
+    SCOPE static inline bool uhash_exists_##T(UHash_##T const *h, ulib_uint i) {                   \
+        return p_uhc_isfull(h->_ctrl, i);                                                          \
     }                                                                                              \
                                                                                                    \
-    SCOPE UHash_##T uhmap_pi_##T(ulib_uint (*hash_func)(uh_key key),                               \
-                                 bool (*equal_func)(uh_key lhs, uh_key rhs)) {                     \
-        UHash_##T h = uhmap_##T();                                                                 \
-        h._hfunc = hash_func;                                                                      \
-        h._efunc = equal_func;                                                                     \
-        return h;                                                                                  \
+    SCOPE static inline ulib_uint uhash_size_##T(UHash_##T const *h) {                             \
+        return h->_size;                                                                           \
     }                                                                                              \
                                                                                                    \
-    SCOPE UHash_##T uhset_##T(void) {                                                              \
-        UHash_##T h = { 0 };                                                                       \
-        h._hfunc = default_hfunc;                                                                  \
-        h._efunc = default_efunc;                                                                  \
-        return h;                                                                                  \
+    SCOPE static inline uh_key *p_uhash_key_ptr_##T(UHash_##T const *h, ulib_uint i) {             \
+        return h->_keys + i;                                                                       \
     }                                                                                              \
                                                                                                    \
-    SCOPE UHash_##T uhset_pi_##T(ulib_uint (*hash_func)(uh_key key),                               \
-                                 bool (*equal_func)(uh_key lhs, uh_key rhs)) {                     \
-        UHash_##T h = uhset_##T();                                                                 \
-        h._hfunc = hash_func;                                                                      \
-        h._efunc = equal_func;                                                                     \
-        return h;                                                                                  \
-    }
+    SCOPE static inline uh_val *p_uhash_val_ptr_##T(UHash_##T const *h, ulib_uint i) {             \
+        return h->_vals + i;                                                                       \
+    }                                                                                              \
+    /** @endcond */                                                                                \
+    P_UHASH_DEF_INLINE_COMMON(T, SCOPE)
 
 /*
- * Generates common function definitions for the specified hash table type.
+ * Generates inline function definitions for the specified incremental hash table type.
  *
  * @param T [symbol] Hash table name.
  * @param SCOPE [scope] Scope of the definitions.
  * @param uh_key [type] Hash table key type.
  * @param uh_val [type] Hash table value type.
- * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
- * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
+ *
+ * @note Buckets of the table being migrated follow those of the new table.
  */
-#define P_UHASH_IMPL_COMMON(T, SCOPE, uh_key, uh_val, hash_func, equal_func)                       \
+#define P_UHASH_DEF_INLINE_INCREMENTAL(T, SCOPE, uh_key, uh_val)                                   \
+    /** @cond */                                                                                   \
+    SCOPE static inline bool uhash_is_map_##T(UHash_##T const *h) {                                \
+        /* _occupied = 1 and _size = 0 is a marker for empty tables that are maps. */              \
+        return h->_vals || h->_occupied > h->_size;                                                \
+    }                                                                                              \
                                                                                                    \
-    SCOPE void uhash_deinit_##T(UHash_##T *h) {                                                    \
-        ulib_free((void *)h->_keys);                                                               \
-        ulib_free((void *)h->_vals);                                                               \
-        ulib_free(h->_flags);                                                                      \
-        h->_keys = NULL;                                                                           \
-        h->_vals = NULL;                                                                           \
-        h->_flags = NULL;                                                                          \
-        h->_size = h->_occupied = h->_count = 0;                                                   \
+    SCOPE static inline bool uhash_exists_##T(UHash_##T const *h, ulib_uint i) {                   \
+        if (i < h->_size) return !p_uhf_iseither(h->_flags, i);                                    \
+        return !p_uhf_iseither(h->_old_flags, i - h->_size);                                       \
     }                                                                                              \
                                                                                                    \
-    SCOPE uhash_ret uhash_copy_##T(UHash_##T const *src, UHash_##T *dest) {                        \
-        uhash_ret ret = uhash_copy_as_set_##T(src, dest);                                          \
+    SCOPE static inline ulib_uint uhash_size_##T(UHash_##T const *h) {                             \
+        return h->_size + h->_old_size;                                                            \
+    }                                                                                              \
                                                                                                    \
-        if (ret == UHASH_OK && uhash_is_map_##T(src)) {                                            \
-            if (!src->_size) {                                                                     \
-                *dest = uhmap(T);                                                                  \
-                return UHASH_OK;                                                                   \
-            }                                                                                      \
+    SCOPE static inline uh_key *p_uhash_key_ptr_##T(UHash_##T const *h, ulib_uint i) {             \
+        return i < h->_size ? h->_keys + i : h->_old_keys + (i - h->_size);                        \
+    }                                                                                              \
                                                                                                    \
-            uh_val *new_vals = (uh_val *)ulib_realloc(dest->_vals, src->_size * sizeof(uh_val));   \
-            if (new_vals) {                                                                        \
-                memcpy(new_vals, src->_vals, src->_size * sizeof(uh_val));                         \
-                dest->_vals = new_vals;                                                            \
-            } else {                                                                               \
-                ret = UHASH_ERR;                                                                   \
-            }                                                                                      \
-        }                                                                                          \
+    SCOPE static inline uh_val *p_uhash_val_ptr_##T(UHash_##T const *h, ulib_uint i) {             \
+        return i < h->_size ? h->_vals + i : h->_old_vals + (i - h->_size);                        \
+    }                                                                                              \
+    /** @endcond */                                                                                \
+    P_UHASH_DEF_INLINE_COMMON(T, SCOPE)
+
+/*
+ * Generates inline function definitions for the specified Robin Hood hash table type.
+ *
+ * @param T [symbol] Hash table name.
+ * @param SCOPE [scope] Scope of the definitions.
+ * @param uh_key [type] Hash table key type.
+ * @param uh_val [type] Hash table value type.
+ */
+#define P_UHASH_DEF_INLINE_ROBIN_HOOD(T, SCOPE, uh_key, uh_val)                                    \
+    /** @cond */                                                                                   \
+    SCOPE static inline bool uhash_is_map_##T(UHash_##T const *h) {                                \
+        /* _occupied = 1 and _size = 0 is a marker for empty tables that are maps. */              \
+        return h->_vals || h->_occupied > h->_size;                                                \
+    }                                                                                              \
                                                                                                    \
-        return ret;                                                                                \
+    SCOPE static inline bool uhash_exists_##T(UHash_##T const *h, ulib_uint i) {                   \
+        return h->_dist[i];                                                                        \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline ulib_uint uhash_size_##T(UHash_##T const *h) {                             \
+        return h->_size;                                                                           \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline uh_key *p_uhash_key_ptr_##T(UHash_##T const *h, ulib_uint i) {             \
+        return h->_keys + i;                                                                       \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline uh_val *p_uhash_val_ptr_##T(UHash_##T const *h, ulib_uint i) {             \
+        return h->_vals + i;                                                                       \
+    }                                                                                              \
+    /** @endcond */                                                                                \
+    P_UHASH_DEF_INLINE_COMMON(T, SCOPE)
+
+/*
+ * Generates inline function definitions for the specified interleaved hash table type.
+ *
+ * @param T [symbol] Hash table name.
+ * @param SCOPE [scope] Scope of the definitions.
+ * @param uh_key [type] Hash table key type.
+ * @param uh_val [type] Hash table value type.
+ */
+#define P_UHASH_DEF_INLINE_INTERLEAVED(T, SCOPE, uh_key, uh_val)                                   \
+    /** @cond */                                                                                   \
+    SCOPE static inline bool uhash_is_map_##T(ulib_unused UHash_##T const *h) {                    \
+        /* Slots always have room for a value. */                                                  \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline bool uhash_exists_##T(UHash_##T const *h, ulib_uint i) {                   \
+        return !p_uhf_iseither(h->_flags, i);                                                      \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline ulib_uint uhash_size_##T(UHash_##T const *h) {                             \
+        return h->_size;                                                                           \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline uh_key *p_uhash_key_ptr_##T(UHash_##T const *h, ulib_uint i) {             \
+        return &h->_slots[i].key;                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline uh_val *p_uhash_val_ptr_##T(UHash_##T const *h, ulib_uint i) {             \
+        return &h->_slots[i].val;                                                                  \
+    }                                                                                              \
+    /** @endcond */                                                                                \
+    P_UHASH_DEF_INLINE_COMMON(T, SCOPE)
+
+/*
+ * Generates the load factor functions for the specified hash table type.
+ *
+ * @param T [symbol] Hash table name.
+ * @param max_load [double] Maximum load factor.
+ */
+#define P_UHASH_IMPL_LOAD(T, max_load)                                                             \
+                                                                                                   \
+    static inline double p_uhash_max_load_##T(void) {                                              \
+        return (double)(max_load);                                                                 \
+    }                                                                                              \
+                                                                                                   \
+    static inline ulib_uint p_uhash_upper_bound_##T(ulib_uint buckets) {                           \
+        return p_uhash_upper_bound(buckets, max_load);                                             \
+    }
+
+/*
+ * Generates init function definitions for the specified hash table type.
+ *
+ * @param T [symbol] Hash table name.
+ * @param SCOPE [scope] Scope of the definitions.
+ */
+#define P_UHASH_IMPL_INIT(T, SCOPE)                                                                \
+                                                                                                   \
+    SCOPE UHash_##T uhmap_##T(void) {                                                              \
+        UHash_##T h = uhset_##T();                                                                 \
+        h._occupied = 1;                                                                           \
+        return h;                                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE UHash_##T uhset_##T(void) {                                                              \
+        UHash_##T h = { 0 };                                                                       \
+        return h;                                                                                  \
+    }
+
+/*
+ * Generates init function definitions for the specified hash table type
+ * with per-instance hash and equality functions.
+ *
+ * @param T [symbol] Hash table name.
+ * @param SCOPE [scope] Scope of the definitions.
+ * @param uh_key [type] Hash table key type.
+ * @param default_hfunc [(uh_key) -> ulib_uint] Default hash function (can be NULL).
+ * @param default_efunc [(uh_key, uh_key) -> bool] Default equality function (can be NULL).
+ */
+#define P_UHASH_IMPL_INIT_PI(T, SCOPE, uh_key, default_hfunc, default_efunc)                       \
+                                                                                                   \
+    SCOPE UHash_##T uhmap_##T(void) {                                                              \
+        UHash_##T h = uhset_##T();                                                                 \
+        h._occupied = 1;                                                                           \
+        return h;                                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE UHash_##T uhmap_pi_##T(ulib_uint (*hash_func)(uh_key key),                               \
+                                 bool (*equal_func)(uh_key lhs, uh_key rhs)) {                     \
+        UHash_##T h = uhmap_##T();                                                                 \
+        h._hfunc = hash_func;                                                                      \
+        h._efunc = equal_func;                                                                     \
+        return h;                                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE UHash_##T uhset_##T(void) {                                                              \
+        UHash_##T h = { 0 };                                                                       \
+        h._hfunc = default_hfunc;                                                                  \
+        h._efunc = default_efunc;                                                                  \
+        return h;                                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE UHash_##T uhset_pi_##T(ulib_uint (*hash_func)(uh_key key),                               \
+                                 bool (*equal_func)(uh_key lhs, uh_key rhs)) {                     \
+        UHash_##T h = uhset_##T();                                                                 \
+        h._hfunc = hash_func;                                                                      \
+        h._efunc = equal_func;                                                                     \
+        return h;                                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE void uhash_set_compaction_##T(UHash_##T *h, ulib_float min_load,                         \
+                                        ulib_float max_deleted) {                                  \
+        h->_min_load = min_load;                                                                   \
+        h->_max_deleted = max_deleted;                                                             \
+    }
+
+/*
+ * Generates the core function definitions for the specified hash table type,
+ * which depend on its bucket layout.
+ *
+ * @param T [symbol] Hash table name.
+ * @param SCOPE [scope] Scope of the definitions.
+ * @param uh_key [type] Hash table key type.
+ * @param uh_val [type] Hash table value type.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
+ */
+#define P_UHASH_IMPL_CORE(T, SCOPE, uh_key, uh_val, hash_func, equal_func)                         \
+                                                                                                   \
+    static inline void p_uhash_prefetch_##T(UHash_##T const *h, ulib_uint hash) {                  \
+        if (!h->_size) return;                                                                     \
+        ulib_uint const i = hash & (h->_size - 1);                                                 \
+        p_ulib_prefetch(h->_flags + (i >> 4U));                                                    \
+        p_ulib_prefetch(h->_keys + i);                                                             \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE void uhash_deinit_##T(UHash_##T *h) {                                                    \
+        ulib_free((void *)h->_keys);                                                               \
+        ulib_free((void *)h->_vals);                                                               \
+        ulib_free(h->_flags);                                                                      \
+        h->_keys = NULL;                                                                           \
+        h->_vals = NULL;                                                                           \
+        h->_flags = NULL;                                                                          \
+        h->_size = h->_occupied = h->_count = 0;                                                   \
     }                                                                                              \
                                                                                                    \
     SCOPE uhash_ret uhash_copy_as_set_##T(UHash_##T const *src, UHash_##T *dest) {                 \
@@ -424,11 +917,12 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
         h->_count = h->_occupied = 0;                                                              \
     }                                                                                              \
                                                                                                    \
-    SCOPE ulib_uint uhash_get_##T(UHash_##T const *h, uh_key key) {                                \
+    static inline ulib_uint p_uhash_get_hashed_##T(UHash_##T const *h, uh_key key,                 \
+                                                   ulib_uint hash) {                               \
         if (!h->_size) return UHASH_INDEX_MISSING;                                                 \
                                                                                                    \
         ulib_uint mask = h->_size - 1;                                                             \
-        ulib_uint i = (ulib_uint)(hash_func(key)) & mask;                                          \
+        ulib_uint i = hash & mask;                                                                 \
         ulib_uint step = 0;                                                                        \
         ulib_uint const last = i;                                                                  \
                                                                                                    \
@@ -448,7 +942,7 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
         ulib_uint_next_power_2(new_size);                                                          \
         if (new_size < 4) new_size = 4;                                                            \
                                                                                                    \
-        if (h->_count >= p_uhash_upper_bound(new_size)) {                                          \
+        if (h->_count >= p_uhash_upper_bound_##T(new_size)) {                                      \
             /* Requested size is too small. */                                                     \
             return UHASH_OK;                                                                       \
         }                                                                                          \
@@ -539,10 +1033,11 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
     }                                                                                              \
     /* NOLINTEND(clang-analyzer-core.uninitialized.Assign) */                                      \
                                                                                                    \
-    SCOPE uhash_ret uhash_put_##T(UHash_##T *h, uh_key key, ulib_uint *idx) {                      \
+    static inline uhash_ret p_uhash_put_hashed_##T(UHash_##T *h, uh_key key, ulib_uint hash,       \
+                                                   ulib_uint *idx) {                               \
         p_ulib_analyzer_assert(h->_flags);                                                         \
         ulib_uint x;                                                                               \
-        if (p_uhash_occupied_##T(h) >= p_uhash_upper_bound(h->_size)) {                            \
+        if (p_uhash_occupied_##T(h) >= p_uhash_upper_bound_##T(h->_size)) {                        \
             /* Update the hash table. */                                                           \
             if (h->_size > (h->_count << 1U)) {                                                    \
                 if (uhash_resize_##T(h, h->_size - 1)) {                                           \
@@ -556,10 +1051,9 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
                 return UHASH_ERR;                                                                  \
             }                                                                                      \
         }                                                                                          \
-        /* TODO: implement automatic shrinking; resize() already supports shrinking. */            \
         {                                                                                          \
             ulib_uint const mask = h->_size - 1;                                                   \
-            ulib_uint i = (ulib_uint)(hash_func(key)) & mask;                                      \
+            ulib_uint i = hash & mask;                                                             \
             ulib_uint step = 0;                                                                    \
             ulib_uint site = h->_size;                                                             \
             x = site;                                                                              \
@@ -610,206 +1104,1980 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
         return ret;                                                                                \
     }                                                                                              \
                                                                                                    \
-    SCOPE void uhash_delete_##T(UHash_##T *h, ulib_uint x) {                                       \
+    static inline void p_uhash_delete_##T(UHash_##T *h, ulib_uint x) {                             \
         if (!p_uhf_iseither(h->_flags, x)) {                                                       \
             p_uhf_set_isdel_true(h->_flags, x);                                                    \
             h->_count--;                                                                           \
         }                                                                                          \
-    }                                                                                              \
+    }
+
+/*
+ * Generates the core function definitions for the specified SIMD hash table type.
+ *
+ * @param T [symbol] Hash table name.
+ * @param SCOPE [scope] Scope of the definitions.
+ * @param uh_key [type] Hash table key type.
+ * @param uh_val [type] Hash table value type.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
+ */
+#define P_UHASH_IMPL_SIMD_CORE(T, SCOPE, uh_key, uh_val, hash_func, equal_func)                    \
                                                                                                    \
-    SCOPE uh_val uhmap_get_##T(UHash_##T const *h, uh_key key, uh_val if_missing) {                \
-        p_ulib_analyzer_assert(h->_vals);                                                          \
-        ulib_uint k = uhash_get_##T(h, key);                                                       \
-        return k == UHASH_INDEX_MISSING ? if_missing : h->_vals[k];                                \
+    static inline void p_uhash_prefetch_##T(UHash_##T const *h, ulib_uint hash) {                  \
+        if (!h->_size) return;                                                                     \
+        ulib_uint const mask = h->_size / P_UHASH_GROUP_SIZE - 1;                                  \
+        ulib_uint const i = (p_uhc_h1(p_uhash_mix(hash)) & mask) * P_UHASH_GROUP_SIZE;             \
+        p_ulib_prefetch(h->_ctrl + i);                                                             \
+        p_ulib_prefetch(h->_keys + i);                                                             \
     }                                                                                              \
                                                                                                    \
-    SCOPE uhash_ret uhmap_set_##T(UHash_##T *h, uh_key key, uh_val value, uh_val *existing) {      \
-        p_ulib_analyzer_assert(h->_vals);                                                          \
-                                                                                                   \
-        ulib_uint k;                                                                               \
-        uhash_ret ret = uhash_put_##T(h, key, &k);                                                 \
+    SCOPE void uhash_deinit_##T(UHash_##T *h) {                                                    \
+        ulib_free((void *)h->_keys);                                                               \
+        ulib_free((void *)h->_vals);                                                               \
+        ulib_free(h->_ctrl);                                                                       \
+        h->_keys = NULL;                                                                           \
+        h->_vals = NULL;                                                                           \
+        h->_ctrl = NULL;                                                                           \
+        h->_size = h->_occupied = h->_count = 0;                                                   \
+    }                                                                                              \
                                                                                                    \
-        if (ret != UHASH_ERR) {                                                                    \
-            if (ret == UHASH_PRESENT && existing) *existing = h->_vals[k];                         \
-            h->_vals[k] = value;                                                                   \
+    SCOPE uhash_ret uhash_copy_as_set_##T(UHash_##T const *src, UHash_##T *dest) {                 \
+        if (!src->_size) {                                                                         \
+            uhash_deinit(T, dest);                                                                 \
+            *dest = uhset(T);                                                                      \
+            return UHASH_OK;                                                                       \
         }                                                                                          \
                                                                                                    \
-        return ret;                                                                                \
-    }                                                                                              \
-                                                                                                   \
-    SCOPE uhash_ret uhmap_add_##T(UHash_##T *h, uh_key key, uh_val value, uh_val *existing) {      \
-        p_ulib_analyzer_assert(h->_vals);                                                          \
+        ulib_byte *new_ctrl = (ulib_byte *)ulib_realloc(dest->_ctrl, src->_size);                  \
+        if (!new_ctrl) return UHASH_ERR;                                                           \
+        dest->_ctrl = new_ctrl;                                                                    \
                                                                                                    \
-        ulib_uint k;                                                                               \
-        uhash_ret ret = uhash_put_##T(h, key, &k);                                                 \
+        uh_key *new_keys = (uh_key *)ulib_realloc(dest->_keys, src->_size * sizeof(uh_key));       \
+        if (!new_keys) return UHASH_ERR;                                                           \
+        dest->_keys = new_keys;                                                                    \
                                                                                                    \
-        if (ret == UHASH_INSERTED) {                                                               \
-            h->_vals[k] = value;                                                                   \
-        } else if (ret == UHASH_PRESENT && existing) {                                             \
-            *existing = h->_vals[k];                                                               \
-        }                                                                                          \
+        memcpy(new_ctrl, src->_ctrl, src->_size);                                                  \
+        memcpy(new_keys, src->_keys, src->_size * sizeof(uh_key));                                 \
+        dest->_size = src->_size;                                                                  \
+        dest->_occupied = src->_occupied;                                                          \
+        dest->_count = src->_count;                                                                \
                                                                                                    \
-        return ret;                                                                                \
+        return UHASH_OK;                                                                           \
     }                                                                                              \
                                                                                                    \
-    SCOPE bool uhmap_replace_##T(UHash_##T *h, uh_key key, uh_val value, uh_val *replaced) {       \
-        p_ulib_analyzer_assert(h->_vals);                                                          \
-        ulib_uint k = uhash_get_##T(h, key);                                                       \
-        if (k == UHASH_INDEX_MISSING) return false;                                                \
-        if (replaced) *replaced = h->_vals[k];                                                     \
-        h->_vals[k] = value;                                                                       \
-        return true;                                                                               \
+    SCOPE void uhash_clear_##T(UHash_##T *h) {                                                     \
+        if (!p_uhash_occupied_##T(h)) return;                                                      \
+        memset(h->_ctrl, P_UHASH_CTRL_EMPTY, h->_size);                                            \
+        h->_count = h->_occupied = 0;                                                              \
     }                                                                                              \
                                                                                                    \
-    SCOPE bool uhmap_remove_##T(UHash_##T *h, uh_key key, uh_key *r_key, uh_val *r_val) {          \
-        ulib_uint k = uhash_get_##T(h, key);                                                       \
-        if (k == UHASH_INDEX_MISSING) return false;                                                \
-        if (r_key) *r_key = h->_keys[k];                                                           \
-        if (r_val) *r_val = h->_vals[k];                                                           \
-        uhash_delete_##T(h, k);                                                                    \
-        return true;                                                                               \
-    }                                                                                              \
+    static inline ulib_uint p_uhash_get_hashed_##T(UHash_##T const *h, uh_key key,                 \
+                                                   ulib_uint hash) {                               \
+        if (!h->_size) return UHASH_INDEX_MISSING;                                                 \
                                                                                                    \
-    SCOPE uhash_ret uhset_insert_##T(UHash_##T *h, uh_key key, uh_key *existing) {                 \
-        ulib_uint k;                                                                               \
-        uhash_ret ret = uhash_put_##T(h, key, &k);                                                 \
-        if (ret == UHASH_PRESENT && existing) *existing = h->_keys[k];                             \
-        return ret;                                                                                \
+        hash = p_uhash_mix(hash);                                                                  \
+        ulib_uint const mask = h->_size / P_UHASH_GROUP_SIZE - 1;                                  \
+        ulib_byte const h2 = p_uhc_h2(hash);                                                       \
+        ulib_uint g = p_uhc_h1(hash) & mask, step = 0;                                             \
+                                                                                                   \
+        while (true) {                                                                             \
+            ulib_byte const *group = h->_ctrl + g * P_UHASH_GROUP_SIZE;                            \
+            uint64_t m = p_uhash_group_match(group, h2);                                           \
+                                                                                                   \
+            while (m) {                                                                            \
+                ulib_uint i = g * P_UHASH_GROUP_SIZE + p_uhash_group_next(&m);                     \
+                if (equal_func(h->_keys[i], key)) return i;                                        \
+            }                                                                                      \
+                                                                                                   \
+            /* All groups are visited after (mask + 1) triangular probing steps. */                \
+            if (p_uhash_group_match_empty(group) || step == mask) return UHASH_INDEX_MISSING;      \
+            g = (g + (++step)) & mask;                                                             \
+        }                                                                                          \
     }                                                                                              \
                                                                                                    \
-    SCOPE uhash_ret uhset_insert_all_##T(UHash_##T *h, uh_key const *items, ulib_uint n) {         \
-        if (uhash_resize_##T(h, n)) return UHASH_ERR;                                              \
-        uhash_ret ret = UHASH_PRESENT;                                                             \
+    SCOPE uhash_ret uhash_resize_##T(UHash_##T *h, ulib_uint new_size) {                           \
+        ulib_uint_next_power_2(new_size);                                                          \
+        if (new_size < P_UHASH_GROUP_SIZE) new_size = P_UHASH_GROUP_SIZE;                          \
                                                                                                    \
-        for (ulib_uint i = 0; i < n; ++i) {                                                        \
-            uhash_ret l_ret = uhset_insert_##T(h, items[i], NULL);                                 \
-            if (l_ret == UHASH_ERR) return UHASH_ERR;                                              \
-            if (l_ret == UHASH_INSERTED) ret = UHASH_INSERTED;                                     \
+        if (h->_count >= p_uhash_upper_bound_##T(new_size)) {                                      \
+            /* Requested size is too small. */                                                     \
+            return UHASH_OK;                                                                       \
         }                                                                                          \
                                                                                                    \
-        return ret;                                                                                \
-    }                                                                                              \
+        ulib_byte *new_ctrl = (ulib_byte *)ulib_malloc(new_size);                                  \
+        uh_key *new_keys = (uh_key *)ulib_malloc(new_size * sizeof(uh_key));                       \
+        uh_val *new_vals = NULL;                                                                   \
                                                                                                    \
-    SCOPE bool uhset_replace_##T(UHash_##T *h, uh_key key, uh_key *replaced) {                     \
-        ulib_uint k = uhash_get_##T(h, key);                                                       \
-        if (k == UHASH_INDEX_MISSING) return false;                                                \
-        if (replaced) *replaced = h->_keys[k];                                                     \
-        h->_keys[k] = key;                                                                         \
-        return true;                                                                               \
-    }                                                                                              \
+        if (uhash_is_map_##T(h)) new_vals = (uh_val *)ulib_malloc(new_size * sizeof(uh_val));      \
                                                                                                    \
-    SCOPE bool uhset_remove_##T(UHash_##T *h, uh_key key, uh_key *removed) {                       \
-        ulib_uint k = uhash_get_##T(h, key);                                                       \
-        if (k == UHASH_INDEX_MISSING) return false;                                                \
-        if (removed) *removed = h->_keys[k];                                                       \
-        uhash_delete_##T(h, k);                                                                    \
-        return true;                                                                               \
-    }                                                                                              \
+        if (!(new_ctrl && new_keys && (new_vals || !uhash_is_map_##T(h)))) {                       \
+            ulib_free(new_ctrl);                                                                   \
+            ulib_free((void *)new_keys);                                                           \
+            ulib_free((void *)new_vals);                                                           \
+            return UHASH_ERR;                                                                      \
+        }                                                                                          \
                                                                                                    \
-    SCOPE bool uhset_is_superset_##T(UHash_##T const *h1, UHash_##T const *h2) {                   \
-        for (ulib_uint i = 0; i != h2->_size; ++i) {                                               \
-            if (uhash_exists(T, h2, i) &&                                                          \
-                uhash_get_##T(h1, h2->_keys[i]) == UHASH_INDEX_MISSING) {                          \
-                return false;                                                                      \
-            }                                                                                      \
+        /* Rehash into the new buckets, which also clears "deleted" control bytes. */              \
+        memset(new_ctrl, P_UHASH_CTRL_EMPTY, new_size);                                            \
+                                                                                                   \
+        for (ulib_uint j = 0; j != h->_size; ++j) {                                                \
+            if (!p_uhc_isfull(h->_ctrl, j)) continue;                                              \
+            ulib_uint const hash = p_uhash_mix((ulib_uint)(hash_func(h->_keys[j])));               \
+            ulib_uint const i = p_uhash_simd_find_free(new_ctrl, new_size, hash);                  \
+            new_ctrl[i] = p_uhc_h2(hash);                                                          \
+            new_keys[i] = h->_keys[j];                                                             \
+            if (new_vals) new_vals[i] = h->_vals[j];                                               \
         }                                                                                          \
-        return true;                                                                               \
+                                                                                                   \
+        ulib_free(h->_ctrl);                                                                       \
+        ulib_free((void *)h->_keys);                                                               \
+        ulib_free((void *)h->_vals);                                                               \
+        h->_ctrl = new_ctrl;                                                                       \
+        h->_keys = new_keys;                                                                       \
+        h->_vals = new_vals;                                                                       \
+        h->_size = new_size;                                                                       \
+        h->_occupied = h->_count;                                                                  \
+                                                                                                   \
+        return UHASH_OK;                                                                           \
     }                                                                                              \
                                                                                                    \
-    SCOPE uhash_ret uhset_union_##T(UHash_##T *h1, UHash_##T const *h2) {                          \
-        for (ulib_uint i = 0; i != h2->_size; ++i) {                                               \
-            if (uhash_exists(T, h2, i) && uhset_insert_##T(h1, h2->_keys[i], NULL) == UHASH_ERR) { \
+    static inline uhash_ret p_uhash_put_hashed_##T(UHash_##T *h, uh_key key, ulib_uint hash,       \
+                                                   ulib_uint *idx) {                               \
+        if (p_uhash_occupied_##T(h) >= p_uhash_upper_bound_##T(h->_size)) {                        \
+            /* Clear "deleted" elements if there are enough of them, otherwise expand. */          \
+            ulib_uint new_size = h->_size > (h->_count << 1U) ? h->_size - 1 : h->_size + 1;       \
+            if (uhash_resize_##T(h, new_size)) {                                                   \
+                if (idx) *idx = UHASH_INDEX_MISSING;                                               \
                 return UHASH_ERR;                                                                  \
             }                                                                                      \
         }                                                                                          \
-        return UHASH_OK;                                                                           \
-    }                                                                                              \
                                                                                                    \
-    SCOPE void uhset_intersect_##T(UHash_##T *h1, UHash_##T const *h2) {                           \
-        for (ulib_uint i = 0; i != h1->_size; ++i) {                                               \
-            if (uhash_exists(T, h1, i) &&                                                          \
-                uhash_get_##T(h2, h1->_keys[i]) == UHASH_INDEX_MISSING) {                          \
-                uhash_delete_##T(h1, i);                                                           \
+        hash = p_uhash_mix(hash);                                                                  \
+        ulib_uint const mask = h->_size / P_UHASH_GROUP_SIZE - 1;                                  \
+        ulib_byte const h2 = p_uhc_h2(hash);                                                       \
+        ulib_uint g = p_uhc_h1(hash) & mask, step = 0, site = h->_size;                            \
+                                                                                                   \
+        while (true) {                                                                             \
+            ulib_byte const *group = h->_ctrl + g * P_UHASH_GROUP_SIZE;                            \
+            uint64_t m = p_uhash_group_match(group, h2);                                           \
+                                                                                                   \
+            while (m) {                                                                            \
+                ulib_uint i = g * P_UHASH_GROUP_SIZE + p_uhash_group_next(&m);                     \
+                if (equal_func(h->_keys[i], key)) {                                                \
+                    if (idx) *idx = i;                                                             \
+                    return UHASH_PRESENT;                                                          \
+                }                                                                                  \
+            }                                                                                      \
+                                                                                                   \
+            if (site == h->_size && (m = p_uhash_group_match_free(group))) {                       \
+                /* Remember the first free bucket in the probe sequence. */                        \
+                site = g * P_UHASH_GROUP_SIZE + p_uhash_group_next(&m);                            \
             }                                                                                      \
+                                                                                                   \
+            if (p_uhash_group_match_empty(group) || step == mask) break;                           \
+            g = (g + (++step)) & mask;                                                             \
         }                                                                                          \
+                                                                                                   \
+        if (h->_ctrl[site] == P_UHASH_CTRL_EMPTY) h->_occupied++;                                  \
+        h->_ctrl[site] = h2;                                                                       \
+        h->_keys[site] = key;                                                                      \
+        h->_count++;                                                                               \
+                                                                                                   \
+        if (idx) *idx = site;                                                                      \
+        return UHASH_INSERTED;                                                                     \
     }                                                                                              \
                                                                                                    \
-    SCOPE ulib_uint uhset_hash_##T(UHash_##T const *h) {                                           \
-        ulib_uint hash = 0;                                                                        \
-        for (ulib_uint i = 0; i != h->_size; ++i) {                                                \
-            if (uhash_exists(T, h, i)) hash ^= hash_func(h->_keys[i]);                             \
+    static inline void p_uhash_delete_##T(UHash_##T *h, ulib_uint x) {                             \
+        if (!p_uhc_isfull(h->_ctrl, x)) return;                                                    \
+                                                                                                   \
+        if (p_uhash_group_match_empty(h->_ctrl + p_uhc_group(x))) {                                \
+            /* No probe sequence goes past a group that has empty buckets. */                      \
+            h->_ctrl[x] = P_UHASH_CTRL_EMPTY;                                                      \
+            h->_occupied--;                                                                        \
+        } else {                                                                                   \
+            h->_ctrl[x] = P_UHASH_CTRL_DELETED;                                                    \
         }                                                                                          \
-        return hash;                                                                               \
+                                                                                                   \
+        h->_count--;                                                                               \
+    }
+
+/*
+ * Generates the core function definitions for the specified hash table type
+ * that stores the hash of each key.
+ *
+ * @param T [symbol] Hash table name.
+ * @param SCOPE [scope] Scope of the definitions.
+ * @param uh_key [type] Hash table key type.
+ * @param uh_val [type] Hash table value type.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
+ */
+#define P_UHASH_IMPL_CACHED_HASH_CORE(T, SCOPE, uh_key, uh_val, hash_func, equal_func)             \
+                                                                                                   \
+    static inline void p_uhash_prefetch_##T(UHash_##T const *h, ulib_uint hash) {                  \
+        if (!h->_size) return;                                                                     \
+        ulib_uint const i = hash & (h->_size - 1);                                                 \
+        p_ulib_prefetch(h->_flags + (i >> 4U));                                                    \
+        p_ulib_prefetch(h->_hashes + i);                                                           \
     }                                                                                              \
                                                                                                    \
-    SCOPE uh_key uhset_get_any_##T(UHash_##T const *h, uh_key if_empty) {                          \
-        ulib_uint i = uhash_next_##T(h, 0);                                                        \
-        return i == h->_size ? if_empty : h->_keys[i];                                             \
+    SCOPE void uhash_deinit_##T(UHash_##T *h) {                                                    \
+        ulib_free((void *)h->_keys);                                                               \
+        ulib_free((void *)h->_vals);                                                               \
+        ulib_free(h->_hashes);                                                                     \
+        ulib_free(h->_flags);                                                                      \
+        h->_keys = NULL;                                                                           \
+        h->_vals = NULL;                                                                           \
+        h->_hashes = NULL;                                                                         \
+        h->_flags = NULL;                                                                          \
+        h->_size = h->_occupied = h->_count = 0;                                                   \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhash_copy_as_set_##T(UHash_##T const *src, UHash_##T *dest) {                 \
+        if (!src->_size) {                                                                         \
+            uhash_deinit(T, dest);                                                                 \
+            *dest = uhset(T);                                                                      \
+            return UHASH_OK;                                                                       \
+        }                                                                                          \
+                                                                                                   \
+        ulib_uint n_flags = p_uhf_size(src->_size);                                                \
+        uint32_t *new_flags = (uint32_t *)ulib_realloc(dest->_flags, n_flags * sizeof(uint32_t));  \
+        if (!new_flags) return UHASH_ERR;                                                          \
+        dest->_flags = new_flags;                                                                  \
+                                                                                                   \
+        uh_key *new_keys = (uh_key *)ulib_realloc(dest->_keys, src->_size * sizeof(uh_key));       \
+        if (!new_keys) return UHASH_ERR;                                                           \
+        dest->_keys = new_keys;                                                                    \
+                                                                                                   \
+        ulib_uint *new_hashes = (ulib_uint *)ulib_realloc(dest->_hashes,                           \
+                                                          src->_size * sizeof(ulib_uint));         \
+        if (!new_hashes) return UHASH_ERR;                                                         \
+        dest->_hashes = new_hashes;                                                                \
+                                                                                                   \
+        memcpy(new_flags, src->_flags, n_flags * sizeof(uint32_t));                                \
+        memcpy(new_keys, src->_keys, src->_size * sizeof(uh_key));                                 \
+        memcpy(new_hashes, src->_hashes, src->_size * sizeof(ulib_uint));                          \
+        dest->_size = src->_size;                                                                  \
+        dest->_occupied = src->_occupied;                                                          \
+        dest->_count = src->_count;                                                                \
+                                                                                                   \
+        return UHASH_OK;                                                                           \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE void uhash_clear_##T(UHash_##T *h) {                                                     \
+        if (!p_uhash_occupied_##T(h)) return;                                                      \
+        memset(h->_flags, 0xaa, p_uhf_size(h->_size) * sizeof(uint32_t));                          \
+        h->_count = h->_occupied = 0;                                                              \
+    }                                                                                              \
+                                                                                                   \
+    static inline ulib_uint p_uhash_get_hashed_##T(UHash_##T const *h, uh_key key,                 \
+                                                   ulib_uint hash) {                               \
+        if (!h->_size) return UHASH_INDEX_MISSING;                                                 \
+                                                                                                   \
+        ulib_uint mask = h->_size - 1;                                                             \
+        ulib_uint i = hash & mask;                                                                 \
+        ulib_uint step = 0;                                                                        \
+        ulib_uint const last = i;                                                                  \
+                                                                                                   \
+        while (!p_uhf_isempty(h->_flags, i) &&                                                     \
+               (p_uhf_isdel(h->_flags, i) || h->_hashes[i] != hash ||                              \
+                !equal_func(h->_keys[i], key))) {                                                  \
+            i = (i + (++step)) & mask;                                                             \
+            if (i == last) return UHASH_INDEX_MISSING;                                             \
+        }                                                                                          \
+                                                                                                   \
+        return p_uhf_iseither(h->_flags, i) ? UHASH_INDEX_MISSING : i;                             \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhash_resize_##T(UHash_##T *h, ulib_uint new_size) {                           \
+        ulib_uint_next_power_2(new_size);                                                          \
+        if (new_size < 4) new_size = 4;                                                            \
+                                                                                                   \
+        if (h->_count >= p_uhash_upper_bound_##T(new_size)) {                                      \
+            /* Requested size is too small. */                                                     \
+            return UHASH_OK;                                                                       \
+        }                                                                                          \
+                                                                                                   \
+        /* Stored hashes make rehashing cheap, so move the keys to new buckets. */                 \
+        uint32_t *new_flags = (uint32_t *)ulib_malloc(p_uhf_size(new_size) * sizeof(uint32_t));    \
+        uh_key *new_keys = (uh_key *)ulib_malloc(new_size * sizeof(uh_key));                       \
+        ulib_uint *new_hashes = (ulib_uint *)ulib_malloc(new_size * sizeof(ulib_uint));            \
+        uh_val *new_vals = NULL;                                                                   \
+                                                                                                   \
+        if (uhash_is_map_##T(h)) new_vals = (uh_val *)ulib_malloc(new_size * sizeof(uh_val));      \
+                                                                                                   \
+        if (!(new_flags && new_keys && new_hashes && (new_vals || !uhash_is_map_##T(h)))) {        \
+            ulib_free(new_flags);                                                                  \
+            ulib_free((void *)new_keys);                                                           \
+            ulib_free(new_hashes);                                                                 \
+            ulib_free((void *)new_vals);                                                           \
+            return UHASH_ERR;                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        memset(new_flags, 0xaa, p_uhf_size(new_size) * sizeof(uint32_t));                          \
+        ulib_uint const new_mask = new_size - 1;                                                   \
+                                                                                                   \
+        for (ulib_uint j = 0; j != h->_size; ++j) {                                                \
+            if (p_uhf_iseither(h->_flags, j)) continue;                                            \
+                                                                                                   \
+            ulib_uint const hash = h->_hashes[j];                                                  \
+            ulib_uint i = hash & new_mask;                                                         \
+            ulib_uint step = 0;                                                                    \
+                                                                                                   \
+            while (!p_uhf_isempty(new_flags, i)) i = (i + (++step)) & new_mask;                    \
+            p_uhf_set_isboth_false(new_flags, i);                                                  \
+            new_keys[i] = h->_keys[j];                                                             \
+            new_hashes[i] = hash;                                                                  \
+            if (new_vals) new_vals[i] = h->_vals[j];                                               \
+        }                                                                                          \
+                                                                                                   \
+        ulib_free(h->_flags);                                                                      \
+        ulib_free((void *)h->_keys);                                                               \
+        ulib_free(h->_hashes);                                                                     \
+        ulib_free((void *)h->_vals);                                                               \
+        h->_flags = new_flags;                                                                     \
+        h->_keys = new_keys;                                                                       \
+        h->_hashes = new_hashes;                                                                   \
+        h->_vals = new_vals;                                                                       \
+        h->_size = new_size;                                                                       \
+        h->_occupied = h->_count;                                                                  \
+                                                                                                   \
+        return UHASH_OK;                                                                           \
+    }                                                                                              \
+                                                                                                   \
+    static inline uhash_ret p_uhash_put_hashed_##T(UHash_##T *h, uh_key key, ulib_uint hash,       \
+                                                   ulib_uint *idx) {                               \
+        if (p_uhash_occupied_##T(h) >= p_uhash_upper_bound_##T(h->_size)) {                        \
+            /* Clear "deleted" elements if there are enough of them, otherwise expand. */          \
+            ulib_uint new_size = h->_size > (h->_count << 1U) ? h->_size - 1 : h->_size + 1;       \
+            if (uhash_resize_##T(h, new_size)) {                                                   \
+                if (idx) *idx = UHASH_INDEX_MISSING;                                               \
+                return UHASH_ERR;                                                                  \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        ulib_uint const mask = h->_size - 1;                                                       \
+        ulib_uint i = hash & mask;                                                                 \
+        ulib_uint step = 0;                                                                        \
+        ulib_uint site = h->_size;                                                                 \
+        ulib_uint x = site;                                                                        \
+                                                                                                   \
+        if (p_uhf_isempty(h->_flags, i)) {                                                         \
+            /* Speed up. */                                                                        \
+            x = i;                                                                                 \
+        } else {                                                                                   \
+            ulib_uint const last = i;                                                              \
+                                                                                                   \
+            while (!p_uhf_isempty(h->_flags, i) &&                                                 \
+                   (p_uhf_isdel(h->_flags, i) || h->_hashes[i] != hash ||                          \
+                    !equal_func(h->_keys[i], key))) {                                              \
+                if (p_uhf_isdel(h->_flags, i)) site = i;                                           \
+                i = (i + (++step)) & mask;                                                         \
+                if (i == last) {                                                                   \
+                    x = site;                                                                      \
+                    break;                                                                         \
+                }                                                                                  \
+            }                                                                                      \
+                                                                                                   \
+            if (x == h->_size) {                                                                   \
+                x = (p_uhf_isempty(h->_flags, i) && site != h->_size) ? site : i;                  \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        uhash_ret ret;                                                                             \
+                                                                                                   \
+        if (p_uhf_iseither(h->_flags, x)) {                                                        \
+            /* Not present at all, or deleted. */                                                  \
+            if (p_uhf_isempty(h->_flags, x)) h->_occupied++;                                       \
+            h->_keys[x] = key;                                                                     \
+            h->_hashes[x] = hash;                                                                  \
+            p_uhf_set_isboth_false(h->_flags, x);                                                  \
+            h->_count++;                                                                           \
+            ret = UHASH_INSERTED;                                                                  \
+        } else {                                                                                   \
+            /* Don't touch h->_keys[x] if present and not deleted. */                              \
+            ret = UHASH_PRESENT;                                                                   \
+        }                                                                                          \
+                                                                                                   \
+        if (idx) *idx = x;                                                                         \
+        return ret;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    static inline void p_uhash_delete_##T(UHash_##T *h, ulib_uint x) {                             \
+        if (!p_uhf_iseither(h->_flags, x)) {                                                       \
+            p_uhf_set_isdel_true(h->_flags, x);                                                    \
+            h->_count--;                                                                           \
+        }                                                                                          \
     }
 
-/// @name Type definitions
+/*
+ * Generates the core function definitions for the specified Robin Hood hash table type.
+ *
+ * @param T [symbol] Hash table name.
+ * @param SCOPE [scope] Scope of the definitions.
+ * @param uh_key [type] Hash table key type.
+ * @param uh_val [type] Hash table value type.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
+ *
+ * @note Buckets are probed linearly, and each one stores the distance from the home bucket
+ *       of its key, plus one. Insertions keep distances sorted within each run of buckets
+ *       by shifting the tail of the run forward, and deletions shift it backward.
+ */
+#define P_UHASH_IMPL_ROBIN_HOOD_CORE(T, SCOPE, uh_key, uh_val, hash_func, equal_func)              \
+                                                                                                   \
+    static inline void p_uhash_prefetch_##T(UHash_##T const *h, ulib_uint hash) {                  \
+        if (!h->_size) return;                                                                     \
+        ulib_uint const i = p_uhash_mix(hash) & (h->_size - 1);                                    \
+        p_ulib_prefetch(h->_dist + i);                                                             \
+        p_ulib_prefetch(h->_keys + i);                                                             \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE void uhash_deinit_##T(UHash_##T *h) {                                                    \
+        ulib_free((void *)h->_keys);                                                               \
+        ulib_free((void *)h->_vals);                                                               \
+        ulib_free(h->_dist);                                                                       \
+        h->_keys = NULL;                                                                           \
+        h->_vals = NULL;                                                                           \
+        h->_dist = NULL;                                                                           \
+        h->_size = h->_occupied = h->_count = 0;                                                   \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhash_copy_as_set_##T(UHash_##T const *src, UHash_##T *dest) {                 \
+        if (!src->_size) {                                                                         \
+            uhash_deinit(T, dest);                                                                 \
+            *dest = uhset(T);                                                                      \
+            return UHASH_OK;                                                                       \
+        }                                                                                          \
+                                                                                                   \
+        uint16_t *new_dist = (uint16_t *)ulib_realloc(dest->_dist, src->_size * sizeof(uint16_t)); \
+        if (!new_dist) return UHASH_ERR;                                                           \
+        dest->_dist = new_dist;                                                                    \
+                                                                                                   \
+        uh_key *new_keys = (uh_key *)ulib_realloc(dest->_keys, src->_size * sizeof(uh_key));       \
+        if (!new_keys) return UHASH_ERR;                                                           \
+        dest->_keys = new_keys;                                                                    \
+                                                                                                   \
+        memcpy(new_dist, src->_dist, src->_size * sizeof(uint16_t));                               \
+        memcpy(new_keys, src->_keys, src->_size * sizeof(uh_key));                                 \
+        dest->_size = src->_size;                                                                  \
+        dest->_occupied = src->_occupied;                                                          \
+        dest->_count = src->_count;                                                                \
+                                                                                                   \
+        return UHASH_OK;                                                                           \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE void uhash_clear_##T(UHash_##T *h) {                                                     \
+        if (!p_uhash_occupied_##T(h)) return;                                                      \
+        memset(h->_dist, 0, h->_size * sizeof(uint16_t));                                          \
+        h->_count = h->_occupied = 0;                                                              \
+    }                                                                                              \
+                                                                                                   \
+    static inline ulib_uint p_uhash_get_hashed_##T(UHash_##T const *h, uh_key key,                 \
+                                                   ulib_uint hash) {                               \
+        if (!h->_size) return UHASH_INDEX_MISSING;                                                 \
+                                                                                                   \
+        ulib_uint const mask = h->_size - 1;                                                       \
+        ulib_uint i = p_uhash_mix(hash) & mask;                                                    \
+                                                                                                   \
+        /* The key cannot be past the first bucket closer to its home than it would be. */         \
+        for (ulib_uint d = 1; h->_dist[i] >= d; ++d, i = (i + 1) & mask) {                         \
+            if (h->_dist[i] == d && equal_func(h->_keys[i], key)) return i;                        \
+        }                                                                                          \
+                                                                                                   \
+        return UHASH_INDEX_MISSING;                                                                \
+    }                                                                                              \
+                                                                                                   \
+    /* Moves the run of buckets starting at i one bucket forward, returns false on overflow. */    \
+    static inline bool p_uhash_shift_##T(uint16_t *dist, uh_key *keys, uh_val *vals,               \
+                                         ulib_uint mask, ulib_uint i) {                            \
+        ulib_uint j = i;                                                                           \
+                                                                                                   \
+        for (; dist[j]; j = (j + 1) & mask) {                                                      \
+            if (dist[j] >= P_UHASH_RH_MAX_DIST - 1) return false;                                  \
+        }                                                                                          \
+                                                                                                   \
+        for (ulib_uint k; j != i; j = k) {                                                         \
+            k = (j - 1) & mask;                                                                    \
+            keys[j] = keys[k];                                                                     \
+            if (vals) vals[j] = vals[k];                                                           \
+            dist[j] = (uint16_t)(dist[k] + 1);                                                     \
+        }                                                                                          \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhash_resize_##T(UHash_##T *h, ulib_uint new_size) {                           \
+        ulib_uint_next_power_2(new_size);                                                          \
+        if (new_size < 4) new_size = 4;                                                            \
+                                                                                                   \
+        if (h->_count >= p_uhash_upper_bound_##T(new_size)) {                                      \
+            /* Requested size is too small. */                                                     \
+            return UHASH_OK;                                                                       \
+        }                                                                                          \
+                                                                                                   \
+        bool const is_map = uhash_is_map_##T(h);                                                   \
+        uint16_t *new_dist = (uint16_t *)ulib_calloc(new_size, sizeof(uint16_t));                  \
+        uh_key *new_keys = (uh_key *)ulib_malloc(new_size * sizeof(uh_key));                       \
+        uh_val *new_vals = is_map ? (uh_val *)ulib_malloc(new_size * sizeof(uh_val)) : NULL;       \
+                                                                                                   \
+        if (!(new_dist && new_keys && (new_vals || !is_map))) goto err;                            \
+                                                                                                   \
+        for (ulib_uint j = 0, mask = new_size - 1; j != h->_size; ++j) {                           \
+            if (!h->_dist[j]) continue;                                                            \
+                                                                                                   \
+            ulib_uint i = p_uhash_mix((ulib_uint)(hash_func(h->_keys[j]))) & mask;                 \
+            ulib_uint d = 1;                                                                       \
+            for (; new_dist[i] >= d; ++d, i = (i + 1) & mask) {}                                   \
+                                                                                                   \
+            /* Probe distances overflow only if the hash function is degenerate. */                \
+            if (d >= P_UHASH_RH_MAX_DIST ||                                                        \
+                !p_uhash_shift_##T(new_dist, new_keys, new_vals, mask, i)) {                       \
+                goto err;                                                                          \
+            }                                                                                      \
+                                                                                                   \
+            new_dist[i] = (uint16_t)d;                                                             \
+            new_keys[i] = h->_keys[j];                                                             \
+            if (is_map) new_vals[i] = h->_vals[j];                                                 \
+        }                                                                                          \
+                                                                                                   \
+        ulib_free(h->_dist);                                                                       \
+        ulib_free((void *)h->_keys);                                                               \
+        ulib_free((void *)h->_vals);                                                               \
+        h->_dist = new_dist;                                                                       \
+        h->_keys = new_keys;                                                                       \
+        h->_vals = new_vals;                                                                       \
+        h->_size = new_size;                                                                       \
+        h->_occupied = h->_count;                                                                  \
+        return UHASH_OK;                                                                           \
+                                                                                                   \
+    err:                                                                                           \
+        ulib_free(new_dist);                                                                       \
+        ulib_free((void *)new_keys);                                                               \
+        ulib_free((void *)new_vals);                                                               \
+        return UHASH_ERR;                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static inline uhash_ret p_uhash_put_hashed_##T(UHash_##T *h, uh_key key, ulib_uint hash,       \
+                                                   ulib_uint *idx) {                               \
+        if (h->_count >= p_uhash_upper_bound_##T(h->_size)) {                                      \
+            if (uhash_resize_##T(h, h->_size + 1)) goto err;                                       \
+        }                                                                                          \
+                                                                                                   \
+        hash = p_uhash_mix(hash);                                                                  \
+                                                                                                   \
+        for (;;) {                                                                                 \
+            ulib_uint const mask = h->_size - 1;                                                   \
+            ulib_uint i = hash & mask;                                                             \
+            ulib_uint d = 1;                                                                       \
+                                                                                                   \
+            for (; h->_dist[i] >= d; ++d, i = (i + 1) & mask) {                                    \
+                if (h->_dist[i] == d && equal_func(h->_keys[i], key)) {                            \
+                    if (idx) *idx = i;                                                             \
+                    return UHASH_PRESENT;                                                          \
+                }                                                                                  \
+            }                                                                                      \
+                                                                                                   \
+            if (d < P_UHASH_RH_MAX_DIST &&                                                         \
+                p_uhash_shift_##T(h->_dist, h->_keys, h->_vals, mask, i)) {                        \
+                h->_dist[i] = (uint16_t)d;                                                         \
+                h->_keys[i] = key;                                                                 \
+                h->_occupied = ++h->_count;                                                        \
+                if (idx) *idx = i;                                                                 \
+                return UHASH_INSERTED;                                                             \
+            }                                                                                      \
+                                                                                                   \
+            /* Probe distances would overflow: grow the table, unless it is already sparse. */     \
+            if (h->_count < h->_size / 4 || uhash_resize_##T(h, h->_size + 1)) goto err;           \
+        }                                                                                          \
+                                                                                                   \
+    err:                                                                                           \
+        if (idx) *idx = UHASH_INDEX_MISSING;                                                       \
+        return UHASH_ERR;                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static inline void p_uhash_delete_##T(UHash_##T *h, ulib_uint x) {                             \
+        if (!h->_dist[x]) return;                                                                  \
+                                                                                                   \
+        /* Backward-shift the following buckets that are not in their home bucket. */              \
+        ulib_uint const mask = h->_size - 1;                                                       \
+        ulib_uint i = x, j = (x + 1) & mask;                                                       \
+                                                                                                   \
+        for (; h->_dist[j] > 1; i = j, j = (j + 1) & mask) {                                       \
+            h->_keys[i] = h->_keys[j];                                                             \
+            if (h->_vals) h->_vals[i] = h->_vals[j];                                               \
+            h->_dist[i] = (uint16_t)(h->_dist[j] - 1);                                             \
+        }                                                                                          \
+                                                                                                   \
+        h->_dist[i] = 0;                                                                           \
+        h->_occupied = --h->_count;                                                                \
+    }
+
+/*
+ * Generates the core function definitions for the specified interleaved hash table type.
+ *
+ * @param T [symbol] Hash table name.
+ * @param SCOPE [scope] Scope of the definitions.
+ * @param uh_key [type] Hash table key type.
+ * @param uh_val [type] Hash table value type.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
+ */
+#define P_UHASH_IMPL_INTERLEAVED_CORE(T, SCOPE, uh_key, uh_val, hash_func, equal_func)             \
+                                                                                                   \
+    static inline void p_uhash_prefetch_##T(UHash_##T const *h, ulib_uint hash) {                  \
+        if (!h->_size) return;                                                                     \
+        ulib_uint const i = hash & (h->_size - 1);                                                 \
+        p_ulib_prefetch(h->_flags + (i >> 4U));                                                    \
+        p_ulib_prefetch(h->_slots + i);                                                            \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE void uhash_deinit_##T(UHash_##T *h) {                                                    \
+        ulib_free((void *)h->_slots);                                                              \
+        ulib_free(h->_flags);                                                                      \
+        h->_slots = NULL;                                                                          \
+        h->_flags = NULL;                                                                          \
+        h->_size = h->_occupied = h->_count = 0;                                                   \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhash_copy_##T(UHash_##T const *src, UHash_##T *dest) {                        \
+        if (!src->_size) {                                                                         \
+            uhash_deinit(T, dest);                                                                 \
+            *dest = uhmap(T);                                                                      \
+            return UHASH_OK;                                                                       \
+        }                                                                                          \
+                                                                                                   \
+        ulib_uint n_flags = p_uhf_size(src->_size);                                                \
+        uint32_t *new_flags = (uint32_t *)ulib_realloc(dest->_flags, n_flags * sizeof(uint32_t));  \
+        if (!new_flags) return UHASH_ERR;                                                          \
+        dest->_flags = new_flags;                                                                  \
+                                                                                                   \
+        size_t const slots_size = src->_size * sizeof(P_UHashSlot_##T);                            \
+        P_UHashSlot_##T *new_slots = (P_UHashSlot_##T *)ulib_realloc(dest->_slots, slots_size);    \
+        if (!new_slots) return UHASH_ERR;                                                          \
+        dest->_slots = new_slots;                                                                  \
+                                                                                                   \
+        memcpy(new_flags, src->_flags, n_flags * sizeof(uint32_t));                                \
+        memcpy(new_slots, src->_slots, slots_size);                                                \
+        dest->_size = src->_size;                                                                  \
+        dest->_occupied = src->_occupied;                                                          \
+        dest->_count = src->_count;                                                                \
+                                                                                                   \
+        return UHASH_OK;                                                                           \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhash_copy_as_set_##T(UHash_##T const *src, UHash_##T *dest) {                 \
+        return uhash_copy_##T(src, dest);                                                          \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE void uhash_clear_##T(UHash_##T *h) {                                                     \
+        if (!p_uhash_occupied_##T(h)) return;                                                      \
+        memset(h->_flags, 0xaa, p_uhf_size(h->_size) * sizeof(uint32_t));                          \
+        h->_count = h->_occupied = 0;                                                              \
+    }                                                                                              \
+                                                                                                   \
+    static inline ulib_uint p_uhash_get_hashed_##T(UHash_##T const *h, uh_key key,                 \
+                                                   ulib_uint hash) {                               \
+        if (!h->_size) return UHASH_INDEX_MISSING;                                                 \
+                                                                                                   \
+        ulib_uint mask = h->_size - 1;                                                             \
+        ulib_uint i = hash & mask;                                                                 \
+        ulib_uint step = 0;                                                                        \
+        ulib_uint const last = i;                                                                  \
+                                                                                                   \
+        while (!p_uhf_isempty(h->_flags, i) &&                                                     \
+               (p_uhf_isdel(h->_flags, i) || !equal_func(h->_slots[i].key, key))) {                \
+            i = (i + (++step)) & mask;                                                             \
+            if (i == last) return UHASH_INDEX_MISSING;                                             \
+        }                                                                                          \
+                                                                                                   \
+        return p_uhf_iseither(h->_flags, i) ? UHASH_INDEX_MISSING : i;                             \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhash_resize_##T(UHash_##T *h, ulib_uint new_size) {                           \
+        ulib_uint_next_power_2(new_size);                                                          \
+        if (new_size < 4) new_size = 4;                                                            \
+                                                                                                   \
+        if (h->_count >= p_uhash_upper_bound_##T(new_size)) {                                      \
+            /* Requested size is too small. */                                                     \
+            return UHASH_OK;                                                                       \
+        }                                                                                          \
+                                                                                                   \
+        uint32_t *new_flags = (uint32_t *)ulib_malloc(p_uhf_size(new_size) * sizeof(uint32_t));    \
+        P_UHashSlot_##T *new_slots =                                                               \
+            (P_UHashSlot_##T *)ulib_malloc(new_size * sizeof(P_UHashSlot_##T));                    \
+                                                                                                   \
+        if (!(new_flags && new_slots)) {                                                           \
+            ulib_free(new_flags);                                                                  \
+            ulib_free((void *)new_slots);                                                          \
+            return UHASH_ERR;                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        memset(new_flags, 0xaa, p_uhf_size(new_size) * sizeof(uint32_t));                          \
+        ulib_uint const new_mask = new_size - 1;                                                   \
+                                                                                                   \
+        for (ulib_uint j = 0; j != h->_size; ++j) {                                                \
+            if (p_uhf_iseither(h->_flags, j)) continue;                                            \
+                                                                                                   \
+            ulib_uint i = (ulib_uint)(hash_func(h->_slots[j].key)) & new_mask;                     \
+            ulib_uint step = 0;                                                                    \
+                                                                                                   \
+            while (!p_uhf_isempty(new_flags, i)) i = (i + (++step)) & new_mask;                    \
+            p_uhf_set_isboth_false(new_flags, i);                                                  \
+            new_slots[i] = h->_slots[j];                                                           \
+        }                                                                                          \
+                                                                                                   \
+        ulib_free(h->_flags);                                                                      \
+        ulib_free((void *)h->_slots);                                                              \
+        h->_flags = new_flags;                                                                     \
+        h->_slots = new_slots;                                                                     \
+        h->_size = new_size;                                                                       \
+        h->_occupied = h->_count;                                                                  \
+                                                                                                   \
+        return UHASH_OK;                                                                           \
+    }                                                                                              \
+                                                                                                   \
+    static inline uhash_ret p_uhash_put_hashed_##T(UHash_##T *h, uh_key key, ulib_uint hash,       \
+                                                   ulib_uint *idx) {                               \
+        if (p_uhash_occupied_##T(h) >= p_uhash_upper_bound_##T(h->_size)) {                        \
+            /* Clear "deleted" elements if there are enough of them, otherwise expand. */          \
+            ulib_uint new_size = h->_size > (h->_count << 1U) ? h->_size - 1 : h->_size + 1;       \
+            if (uhash_resize_##T(h, new_size)) {                                                   \
+                if (idx) *idx = UHASH_INDEX_MISSING;                                               \
+                return UHASH_ERR;                                                                  \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        ulib_uint const mask = h->_size - 1;                                                       \
+        ulib_uint i = hash & mask;                                                                 \
+        ulib_uint step = 0;                                                                        \
+        ulib_uint site = h->_size;                                                                 \
+        ulib_uint x = site;                                                                        \
+                                                                                                   \
+        if (p_uhf_isempty(h->_flags, i)) {                                                         \
+            /* Speed up. */                                                                        \
+            x = i;                                                                                 \
+        } else {                                                                                   \
+            ulib_uint const last = i;                                                              \
+                                                                                                   \
+            while (!p_uhf_isempty(h->_flags, i) &&                                                 \
+                   (p_uhf_isdel(h->_flags, i) || !equal_func(h->_slots[i].key, key))) {            \
+                if (p_uhf_isdel(h->_flags, i)) site = i;                                           \
+                i = (i + (++step)) & mask;                                                         \
+                if (i == last) {                                                                   \
+                    x = site;                                                                      \
+                    break;                                                                         \
+                }                                                                                  \
+            }                                                                                      \
+                                                                                                   \
+            if (x == h->_size) {                                                                   \
+                x = (p_uhf_isempty(h->_flags, i) && site != h->_size) ? site : i;                  \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        uhash_ret ret;                                                                             \
+                                                                                                   \
+        if (p_uhf_iseither(h->_flags, x)) {                                                        \
+            /* Not present at all, or deleted. */                                                  \
+            if (p_uhf_isempty(h->_flags, x)) h->_occupied++;                                       \
+            h->_slots[x].key = key;                                                                \
+            p_uhf_set_isboth_false(h->_flags, x);                                                  \
+            h->_count++;                                                                           \
+            ret = UHASH_INSERTED;                                                                  \
+        } else {                                                                                   \
+            /* Don't touch the key if present and not deleted. */                                  \
+            ret = UHASH_PRESENT;                                                                   \
+        }                                                                                          \
+                                                                                                   \
+        if (idx) *idx = x;                                                                         \
+        return ret;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    static inline void p_uhash_delete_##T(UHash_##T *h, ulib_uint x) {                             \
+        if (!p_uhf_iseither(h->_flags, x)) {                                                       \
+            p_uhf_set_isdel_true(h->_flags, x);                                                    \
+            h->_count--;                                                                           \
+        }                                                                                          \
+    }
+
+/*
+ * Generates the core function definitions for the specified incremental hash table type.
+ *
+ * @param T [symbol] Hash table name.
+ * @param SCOPE [scope] Scope of the definitions.
+ * @param uh_key [type] Hash table key type.
+ * @param uh_val [type] Hash table value type.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
+ */
+#define P_UHASH_IMPL_INCREMENTAL_CORE(T, SCOPE, uh_key, uh_val, hash_func, equal_func)             \
+                                                                                                   \
+    static inline void p_uhash_prefetch_##T(UHash_##T const *h, ulib_uint hash) {                  \
+        if (!h->_size) return;                                                                     \
+        ulib_uint const i = hash & (h->_size - 1);                                                 \
+        p_ulib_prefetch(h->_flags + (i >> 4U));                                                    \
+        p_ulib_prefetch(h->_keys + i);                                                             \
+    }                                                                                              \
+                                                                                                   \
+    static inline void p_uhash_free_old_##T(UHash_##T *h) {                                        \
+        ulib_free(h->_old_flags);                                                                  \
+        ulib_free((void *)h->_old_keys);                                                           \
+        ulib_free((void *)h->_old_vals);                                                           \
+        h->_old_flags = NULL;                                                                      \
+        h->_old_keys = NULL;                                                                       \
+        h->_old_vals = NULL;                                                                       \
+        h->_old_size = h->_migrated = 0;                                                           \
+    }                                                                                              \
+                                                                                                   \
+    static inline ulib_uint p_uhash_find_##T(uint32_t const *flags, uh_key const *keys,            \
+                                             ulib_uint size, uh_key key, ulib_uint hash) {         \
+        ulib_uint mask = size - 1;                                                                 \
+        ulib_uint i = hash & mask;                                                                 \
+        ulib_uint step = 0;                                                                        \
+        ulib_uint const last = i;                                                                  \
+                                                                                                   \
+        while (!p_uhf_isempty(flags, i) &&                                                         \
+               (p_uhf_isdel(flags, i) || !equal_func(keys[i], key))) {                             \
+            i = (i + (++step)) & mask;                                                             \
+            if (i == last) return UHASH_INDEX_MISSING;                                             \
+        }                                                                                          \
+                                                                                                   \
+        return p_uhf_iseither(flags, i) ? UHASH_INDEX_MISSING : i;                                 \
+    }                                                                                              \
+                                                                                                   \
+    /* Moves up to n buckets from the table being migrated to the new one. */                      \
+    static inline void p_uhash_migrate_##T(UHash_##T *h, ulib_uint n) {                            \
+        ulib_uint const mask = h->_size - 1;                                                       \
+        ulib_uint const end = h->_old_size - h->_migrated > n ? h->_migrated + n : h->_old_size;   \
+                                                                                                   \
+        for (; h->_migrated != end; ++h->_migrated) {                                              \
+            ulib_uint const j = h->_migrated;                                                      \
+            if (p_uhf_iseither(h->_old_flags, j)) continue;                                        \
+                                                                                                   \
+            /* The key cannot be in the new table, so any free bucket will do. */                  \
+            uh_key key = h->_old_keys[j];                                                          \
+            ulib_uint i = (ulib_uint)(hash_func(key)) & mask;                                      \
+            ulib_uint step = 0;                                                                    \
+                                                                                                   \
+            while (!p_uhf_iseither(h->_flags, i)) i = (i + (++step)) & mask;                       \
+            if (p_uhf_isempty(h->_flags, i)) h->_occupied++;                                       \
+            p_uhf_set_isboth_false(h->_flags, i);                                                  \
+            h->_keys[i] = key;                                                                     \
+            if (h->_old_vals) h->_vals[i] = h->_old_vals[j];                                       \
+            p_uhf_set_isdel_true(h->_old_flags, j);                                                \
+        }                                                                                          \
+                                                                                                   \
+        if (h->_migrated == h->_old_size) p_uhash_free_old_##T(h);                                 \
+    }                                                                                              \
+                                                                                                   \
+    /* Allocates the new table, and starts migrating the current one to it. */                     \
+    static inline uhash_ret p_uhash_start_migration_##T(UHash_##T *h, ulib_uint new_size) {        \
+        uint32_t *new_flags = (uint32_t *)ulib_malloc(p_uhf_size(new_size) * sizeof(uint32_t));    \
+        uh_key *new_keys = (uh_key *)ulib_malloc(new_size * sizeof(uh_key));                       \
+        uh_val *new_vals = NULL;                                                                   \
+                                                                                                   \
+        if (uhash_is_map_##T(h)) new_vals = (uh_val *)ulib_malloc(new_size * sizeof(uh_val));      \
+                                                                                                   \
+        if (!(new_flags && new_keys && (new_vals || !uhash_is_map_##T(h)))) {                      \
+            ulib_free(new_flags);                                                                  \
+            ulib_free((void *)new_keys);                                                           \
+            ulib_free((void *)new_vals);                                                           \
+            return UHASH_ERR;                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        memset(new_flags, 0xaa, p_uhf_size(new_size) * sizeof(uint32_t));                          \
+                                                                                                   \
+        if (h->_size) {                                                                            \
+            h->_old_flags = h->_flags;                                                             \
+            h->_old_keys = h->_keys;                                                               \
+            h->_old_vals = h->_vals;                                                               \
+            h->_old_size = h->_size;                                                               \
+            h->_migrated = 0;                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        h->_flags = new_flags;                                                                     \
+        h->_keys = new_keys;                                                                       \
+        h->_vals = new_vals;                                                                       \
+        h->_size = new_size;                                                                       \
+        h->_occupied = 0;                                                                          \
+                                                                                                   \
+        /* Small tables are migrated at once. */                                                   \
+        if (h->_old_size <= UHASH_MIGRATE_STEP << 2U) p_uhash_migrate_##T(h, h->_old_size);        \
+        return UHASH_OK;                                                                           \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE void uhash_deinit_##T(UHash_##T *h) {                                                    \
+        p_uhash_free_old_##T(h);                                                                   \
+        ulib_free((void *)h->_keys);                                                               \
+        ulib_free((void *)h->_vals);                                                               \
+        ulib_free(h->_flags);                                                                      \
+        h->_keys = NULL;                                                                           \
+        h->_vals = NULL;                                                                           \
+        h->_flags = NULL;                                                                          \
+        h->_size = h->_occupied = h->_count = 0;                                                   \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhash_copy_as_set_##T(UHash_##T const *src, UHash_##T *dest) {                 \
+        uhash_deinit(T, dest);                                                                     \
+        *dest = uhset(T);                                                                          \
+        if (!src->_size) return UHASH_OK;                                                          \
+                                                                                                   \
+        ulib_uint n_flags = p_uhf_size(src->_size);                                                \
+        dest->_flags = (uint32_t *)ulib_malloc(n_flags * sizeof(uint32_t));                        \
+        dest->_keys = (uh_key *)ulib_malloc(src->_size * sizeof(uh_key));                          \
+        if (!(dest->_flags && dest->_keys)) goto err;                                              \
+        memcpy(dest->_flags, src->_flags, n_flags * sizeof(uint32_t));                             \
+        memcpy(dest->_keys, src->_keys, src->_size * sizeof(uh_key));                              \
+                                                                                                   \
+        if (src->_old_size) {                                                                      \
+            n_flags = p_uhf_size(src->_old_size);                                                  \
+            dest->_old_flags = (uint32_t *)ulib_malloc(n_flags * sizeof(uint32_t));                \
+            dest->_old_keys = (uh_key *)ulib_malloc(src->_old_size * sizeof(uh_key));              \
+            if (!(dest->_old_flags && dest->_old_keys)) goto err;                                  \
+            memcpy(dest->_old_flags, src->_old_flags, n_flags * sizeof(uint32_t));                 \
+            memcpy(dest->_old_keys, src->_old_keys, src->_old_size * sizeof(uh_key));              \
+        }                                                                                          \
+                                                                                                   \
+        dest->_size = src->_size;                                                                  \
+        dest->_occupied = src->_occupied;                                                          \
+        dest->_count = src->_count;                                                                \
+        dest->_old_size = src->_old_size;                                                          \
+        dest->_migrated = src->_migrated;                                                          \
+        return UHASH_OK;                                                                           \
+                                                                                                   \
+    err:                                                                                           \
+        uhash_deinit(T, dest);                                                                     \
+        return UHASH_ERR;                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhash_copy_##T(UHash_##T const *src, UHash_##T *dest) {                        \
+        if (uhash_copy_as_set_##T(src, dest)) return UHASH_ERR;                                    \
+        if (!uhash_is_map_##T(src)) return UHASH_OK;                                               \
+                                                                                                   \
+        if (!src->_size) {                                                                         \
+            *dest = uhmap(T);                                                                      \
+            return UHASH_OK;                                                                       \
+        }                                                                                          \
+                                                                                                   \
+        dest->_vals = (uh_val *)ulib_malloc(src->_size * sizeof(uh_val));                          \
+        if (!dest->_vals) goto err;                                                                \
+        memcpy(dest->_vals, src->_vals, src->_size * sizeof(uh_val));                              \
+                                                                                                   \
+        if (src->_old_size) {                                                                      \
+            dest->_old_vals = (uh_val *)ulib_malloc(src->_old_size * sizeof(uh_val));              \
+            if (!dest->_old_vals) goto err;                                                        \
+            memcpy(dest->_old_vals, src->_old_vals, src->_old_size * sizeof(uh_val));              \
+        }                                                                                          \
+                                                                                                   \
+        return UHASH_OK;                                                                           \
+                                                                                                   \
+    err:                                                                                           \
+        uhash_deinit(T, dest);                                                                     \
+        return UHASH_ERR;                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE void uhash_clear_##T(UHash_##T *h) {                                                     \
+        p_uhash_free_old_##T(h);                                                                   \
+        if (!h->_size) return;                                                                     \
+        memset(h->_flags, 0xaa, p_uhf_size(h->_size) * sizeof(uint32_t));                          \
+        h->_count = h->_occupied = 0;                                                              \
+    }                                                                                              \
+                                                                                                   \
+    static inline ulib_uint p_uhash_get_hashed_##T(UHash_##T const *h, uh_key key,                 \
+                                                   ulib_uint hash) {                               \
+        if (!h->_size) return UHASH_INDEX_MISSING;                                                 \
+        ulib_uint i = p_uhash_find_##T(h->_flags, h->_keys, h->_size, key, hash);                  \
+        if (i != UHASH_INDEX_MISSING || !h->_old_size) return i;                                   \
+        i = p_uhash_find_##T(h->_old_flags, h->_old_keys, h->_old_size, key, hash);                \
+        return i == UHASH_INDEX_MISSING ? i : h->_size + i;                                        \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhash_resize_##T(UHash_##T *h, ulib_uint new_size) {                           \
+        ulib_uint_next_power_2(new_size);                                                          \
+        if (new_size < 4) new_size = 4;                                                            \
+                                                                                                   \
+        if (h->_count >= p_uhash_upper_bound_##T(new_size)) {                                      \
+            /* Requested size is too small. */                                                     \
+            return UHASH_OK;                                                                       \
+        }                                                                                          \
+                                                                                                   \
+        /* Explicit resizes are not incremental. */                                                \
+        if (h->_old_size) p_uhash_migrate_##T(h, h->_old_size);                                    \
+        if (p_uhash_start_migration_##T(h, new_size)) return UHASH_ERR;                            \
+        if (h->_old_size) p_uhash_migrate_##T(h, h->_old_size);                                    \
+        return UHASH_OK;                                                                           \
+    }                                                                                              \
+                                                                                                   \
+    static inline uhash_ret p_uhash_put_hashed_##T(UHash_##T *h, uh_key key, ulib_uint hash,       \
+                                                   ulib_uint *idx) {                               \
+        if (h->_old_size) p_uhash_migrate_##T(h, UHASH_MIGRATE_STEP);                              \
+                                                                                                   \
+        if (p_uhash_occupied_##T(h) >= p_uhash_upper_bound_##T(h->_size)) {                        \
+            /* Should not happen, as migrations end long before the new table fills up. */         \
+            if (h->_old_size) p_uhash_migrate_##T(h, h->_old_size);                                \
+                                                                                                   \
+            /* Clear "deleted" elements if there are enough of them, otherwise expand. */          \
+            ulib_uint new_size = h->_size > (h->_count << 1U) ? h->_size : h->_size << 1U;         \
+            if (new_size < 4) new_size = 4;                                                        \
+                                                                                                   \
+            if (p_uhash_start_migration_##T(h, new_size)) {                                        \
+                if (idx) *idx = UHASH_INDEX_MISSING;                                               \
+                return UHASH_ERR;                                                                  \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        ulib_uint x;                                                                               \
+                                                                                                   \
+        if (h->_old_size &&                                                                        \
+            (x = p_uhash_find_##T(h->_old_flags, h->_old_keys, h->_old_size, key, hash)) !=        \
+                UHASH_INDEX_MISSING) {                                                             \
+            /* Present in the table being migrated. */                                             \
+            if (idx) *idx = h->_size + x;                                                          \
+            return UHASH_PRESENT;                                                                  \
+        }                                                                                          \
+                                                                                                   \
+        {                                                                                          \
+            ulib_uint const mask = h->_size - 1;                                                   \
+            ulib_uint i = hash & mask;                                                             \
+            ulib_uint step = 0;                                                                    \
+            ulib_uint site = h->_size;                                                             \
+            x = site;                                                                              \
+                                                                                                   \
+            if (p_uhf_isempty(h->_flags, i)) {                                                     \
+                /* Speed up. */                                                                    \
+                x = i;                                                                             \
+            } else {                                                                               \
+                ulib_uint const last = i;                                                          \
+                                                                                                   \
+                while (!p_uhf_isempty(h->_flags, i) &&                                             \
+                       (p_uhf_isdel(h->_flags, i) || !equal_func(h->_keys[i], key))) {             \
+                    if (p_uhf_isdel(h->_flags, i)) site = i;                                       \
+                    i = (i + (++step)) & mask;                                                     \
+                    if (i == last) {                                                               \
+                        x = site;                                                                  \
+                        break;                                                                     \
+                    }                                                                              \
+                }                                                                                  \
+                                                                                                   \
+                if (x == h->_size) {                                                               \
+                    x = (p_uhf_isempty(h->_flags, i) && site != h->_size) ? site : i;              \
+                }                                                                                  \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        uhash_ret ret;                                                                             \
+                                                                                                   \
+        if (p_uhf_iseither(h->_flags, x)) {                                                        \
+            /* Not present at all, or deleted. */                                                  \
+            if (p_uhf_isempty(h->_flags, x)) h->_occupied++;                                       \
+            h->_keys[x] = key;                                                                     \
+            p_uhf_set_isboth_false(h->_flags, x);                                                  \
+            h->_count++;                                                                           \
+            ret = UHASH_INSERTED;                                                                  \
+        } else {                                                                                   \
+            /* Don't touch h->_keys[x] if present and not deleted. */                              \
+            ret = UHASH_PRESENT;                                                                   \
+        }                                                                                          \
+                                                                                                   \
+        if (idx) *idx = x;                                                                         \
+        return ret;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    static inline void p_uhash_delete_##T(UHash_##T *h, ulib_uint x) {                             \
+        uint32_t *flags = h->_flags;                                                               \
+                                                                                                   \
+        if (x >= h->_size) {                                                                       \
+            flags = h->_old_flags;                                                                 \
+            x -= h->_size;                                                                         \
+        }                                                                                          \
+                                                                                                   \
+        if (!p_uhf_iseither(flags, x)) {                                                           \
+            p_uhf_set_isdel_true(flags, x);                                                        \
+            h->_count--;                                                                           \
+        }                                                                                          \
+    }
+
+/*
+ * Generates the copy function definition for the specified hash table type,
+ * whose keys and values are stored in contiguous arrays.
+ *
+ * @param T [symbol] Hash table name.
+ * @param SCOPE [scope] Scope of the definitions.
+ * @param uh_val [type] Hash table value type.
+ */
+#define P_UHASH_IMPL_COPY(T, SCOPE, uh_val)                                                        \
+                                                                                                   \
+    SCOPE uhash_ret uhash_copy_##T(UHash_##T const *src, UHash_##T *dest) {                        \
+        uhash_ret ret = uhash_copy_as_set_##T(src, dest);                                          \
+                                                                                                   \
+        if (ret == UHASH_OK && uhash_is_map_##T(src)) {                                            \
+            if (!src->_size) {                                                                     \
+                *dest = uhmap(T);                                                                  \
+                return UHASH_OK;                                                                   \
+            }                                                                                      \
+                                                                                                   \
+            uh_val *new_vals = (uh_val *)ulib_realloc(dest->_vals, src->_size * sizeof(uh_val));   \
+            if (new_vals) {                                                                        \
+                memcpy(new_vals, src->_vals, src->_size * sizeof(uh_val));                         \
+                dest->_vals = new_vals;                                                            \
+            } else {                                                                               \
+                ret = UHASH_ERR;                                                                   \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        return ret;                                                                                \
+    }                                                                                              \
+
+/*
+ * Generates the function definitions for the specified hash table type
+ * that are built on top of the core functions.
+ *
+ * @param T [symbol] Hash table name.
+ * @param SCOPE [scope] Scope of the definitions.
+ * @param uh_key [type] Hash table key type.
+ * @param uh_val [type] Hash table value type.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
+ * @param min_load [ulib_float] Load factor below which the table shrinks on deletion (0 = never).
+ * @param max_deleted [ulib_float] Ratio of deleted buckets above which the table is rehashed
+ *                    on deletion (0 = never).
+ */
+#define P_UHASH_IMPL_API(T, SCOPE, uh_key, uh_val, hash_func, equal_func, min_load, max_deleted)   \
+                                                                                                   \
+    /* Shrinks the table or clears its "deleted" buckets, as required by the compaction policy. */ \
+    static inline void p_uhash_compact_##T(UHash_##T *h) {                                         \
+        ulib_uint const size = h->_size;                                                           \
+                                                                                                   \
+        if ((min_load) > 0 && h->_count < (ulib_uint)(size * (min_load))) {                        \
+            /* Shrink halfway between the minimum and maximum load factors, to avoid thrashing. */ \
+            double const target_load = ((min_load) + p_uhash_max_load_##T()) / 2;                  \
+            ulib_uint new_size = (ulib_uint)(h->_count / target_load) + 1;                         \
+            ulib_uint_next_power_2(new_size);                                                      \
+            if (new_size < size && !uhash_resize_##T(h, new_size)) return;                         \
+        }                                                                                          \
+                                                                                                   \
+        if ((max_deleted) > 0 &&                                                                   \
+            p_uhash_occupied_##T(h) > h->_count + (ulib_uint)(size * (max_deleted))) {             \
+            uhash_resize_##T(h, size);                                                             \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE ulib_uint uhash_get_##T(UHash_##T const *h, uh_key key) {                                \
+        if (!h->_size) return UHASH_INDEX_MISSING;                                                 \
+        return p_uhash_get_hashed_##T(h, key, (ulib_uint)(hash_func(key)));                        \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhash_put_##T(UHash_##T *h, uh_key key, ulib_uint *idx) {                      \
+        return p_uhash_put_hashed_##T(h, key, (ulib_uint)(hash_func(key)), idx);                   \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE void uhash_delete_##T(UHash_##T *h, ulib_uint x) {                                       \
+        p_uhash_delete_##T(h, x);                                                                  \
+        p_uhash_compact_##T(h);                                                                    \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE void uhash_get_batch_##T(UHash_##T const *h, uh_key const *keys, ulib_uint n,            \
+                                   ulib_uint *idx) {                                               \
+        ulib_uint hashes[UHASH_BATCH_SIZE];                                                        \
+                                                                                                   \
+        for (ulib_uint i = 0; i < n; i += UHASH_BATCH_SIZE) {                                      \
+            ulib_uint const count = ulib_min(n - i, (ulib_uint)UHASH_BATCH_SIZE);                  \
+                                                                                                   \
+            /* Hash the whole batch and prefetch all buckets, so that cache misses overlap. */     \
+            for (ulib_uint j = 0; j < count; ++j) {                                                \
+                hashes[j] = (ulib_uint)(hash_func(keys[i + j]));                                   \
+                p_uhash_prefetch_##T(h, hashes[j]);                                                \
+            }                                                                                      \
+                                                                                                   \
+            for (ulib_uint j = 0; j < count; ++j) {                                                \
+                idx[i + j] = p_uhash_get_hashed_##T(h, keys[i + j], hashes[j]);                    \
+            }                                                                                      \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static inline uhash_ret p_uhash_put_batch_##T(UHash_##T *h, uh_key const *keys,                \
+                                                  uh_val const *vals, ulib_uint n,                 \
+                                                  uhash_ret *rets) {                               \
+        ulib_uint hashes[UHASH_BATCH_SIZE];                                                        \
+        uhash_ret ret = UHASH_PRESENT;                                                             \
+                                                                                                   \
+        for (ulib_uint i = 0; i < n; i += UHASH_BATCH_SIZE) {                                      \
+            ulib_uint const count = ulib_min(n - i, (ulib_uint)UHASH_BATCH_SIZE);                  \
+                                                                                                   \
+            for (ulib_uint j = 0; j < count; ++j) {                                                \
+                hashes[j] = (ulib_uint)(hash_func(keys[i + j]));                                   \
+                p_uhash_prefetch_##T(h, hashes[j]);                                                \
+            }                                                                                      \
+                                                                                                   \
+            for (ulib_uint j = 0; j < count; ++j) {                                                \
+                ulib_uint k;                                                                       \
+                uhash_ret l_ret = p_uhash_put_hashed_##T(h, keys[i + j], hashes[j], &k);           \
+                if (l_ret == UHASH_ERR) return UHASH_ERR;                                          \
+                if (l_ret == UHASH_INSERTED) ret = UHASH_INSERTED;                                 \
+                if (vals) uhash_value(T, h, k) = vals[i + j];                                      \
+                if (rets) rets[i + j] = l_ret;                                                     \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        return ret;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhset_insert_batch_##T(UHash_##T *h, uh_key const *keys, ulib_uint n,          \
+                                           uhash_ret *rets) {                                      \
+        return p_uhash_put_batch_##T(h, keys, NULL, n, rets);                                      \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhmap_set_batch_##T(UHash_##T *h, uh_key const *keys, uh_val const *vals,      \
+                                        ulib_uint n, uhash_ret *rets) {                            \
+        p_ulib_analyzer_assert(p_uhash_val_ptr_##T(h, 0));                                         \
+        return p_uhash_put_batch_##T(h, keys, vals, n, rets);                                      \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uh_val uhmap_get_##T(UHash_##T const *h, uh_key key, uh_val if_missing) {                \
+        p_ulib_analyzer_assert(p_uhash_val_ptr_##T(h, 0));                                         \
+        ulib_uint k = uhash_get_##T(h, key);                                                       \
+        return k == UHASH_INDEX_MISSING ? if_missing : uhash_value(T, h, k);                       \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhmap_set_##T(UHash_##T *h, uh_key key, uh_val value, uh_val *existing) {      \
+        p_ulib_analyzer_assert(p_uhash_val_ptr_##T(h, 0));                                         \
+                                                                                                   \
+        ulib_uint k;                                                                               \
+        uhash_ret ret = uhash_put_##T(h, key, &k);                                                 \
+                                                                                                   \
+        if (ret != UHASH_ERR) {                                                                    \
+            if (ret == UHASH_PRESENT && existing) *existing = uhash_value(T, h, k);                \
+            uhash_value(T, h, k) = value;                                                          \
+        }                                                                                          \
+                                                                                                   \
+        return ret;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhmap_add_##T(UHash_##T *h, uh_key key, uh_val value, uh_val *existing) {      \
+        p_ulib_analyzer_assert(p_uhash_val_ptr_##T(h, 0));                                         \
+                                                                                                   \
+        ulib_uint k;                                                                               \
+        uhash_ret ret = uhash_put_##T(h, key, &k);                                                 \
+                                                                                                   \
+        if (ret == UHASH_INSERTED) {                                                               \
+            uhash_value(T, h, k) = value;                                                          \
+        } else if (ret == UHASH_PRESENT && existing) {                                             \
+            *existing = uhash_value(T, h, k);                                                      \
+        }                                                                                          \
+                                                                                                   \
+        return ret;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE bool uhmap_replace_##T(UHash_##T *h, uh_key key, uh_val value, uh_val *replaced) {       \
+        p_ulib_analyzer_assert(p_uhash_val_ptr_##T(h, 0));                                         \
+        ulib_uint k = uhash_get_##T(h, key);                                                       \
+        if (k == UHASH_INDEX_MISSING) return false;                                                \
+        if (replaced) *replaced = uhash_value(T, h, k);                                            \
+        uhash_value(T, h, k) = value;                                                              \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE bool uhmap_remove_##T(UHash_##T *h, uh_key key, uh_key *r_key, uh_val *r_val) {          \
+        ulib_uint k = uhash_get_##T(h, key);                                                       \
+        if (k == UHASH_INDEX_MISSING) return false;                                                \
+        if (r_key) *r_key = uhash_key(T, h, k);                                                    \
+        if (r_val) *r_val = uhash_value(T, h, k);                                                  \
+        uhash_delete_##T(h, k);                                                                    \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhset_insert_##T(UHash_##T *h, uh_key key, uh_key *existing) {                 \
+        ulib_uint k;                                                                               \
+        uhash_ret ret = uhash_put_##T(h, key, &k);                                                 \
+        if (ret == UHASH_PRESENT && existing) *existing = uhash_key(T, h, k);                      \
+        return ret;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    static inline uhash_ret p_uhash_reserve_##T(UHash_##T *h, ulib_uint n) {                       \
+        if (p_uhash_occupied_##T(h) + n >= p_uhash_upper_bound_##T(h->_size) &&                    \
+            uhash_resize_##T(h, (ulib_uint)((h->_count + n) / p_uhash_max_load_##T()) + 1)) {      \
+            return UHASH_ERR;                                                                      \
+        }                                                                                          \
+        return UHASH_OK;                                                                           \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhset_insert_all_##T(UHash_##T *h, uh_key const *items, ulib_uint n) {         \
+        if (p_uhash_reserve_##T(h, n)) return UHASH_ERR;                                           \
+        return uhset_insert_batch_##T(h, items, n, NULL);                                          \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhset_from_array_##T(UHash_##T *h, uh_key const *items, ulib_uint n) {         \
+        uhash_clear_##T(h);                                                                        \
+        return uhset_insert_all_##T(h, items, n) == UHASH_ERR ? UHASH_ERR : UHASH_OK;              \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhmap_from_arrays_##T(UHash_##T *h, uh_key const *keys, uh_val const *vals,    \
+                                          ulib_uint n) {                                           \
+        p_ulib_analyzer_assert(p_uhash_val_ptr_##T(h, 0));                                         \
+        uhash_clear_##T(h);                                                                        \
+        if (p_uhash_reserve_##T(h, n)) return UHASH_ERR;                                           \
+        return p_uhash_put_batch_##T(h, keys, vals, n, NULL) == UHASH_ERR ? UHASH_ERR : UHASH_OK;  \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE bool uhset_replace_##T(UHash_##T *h, uh_key key, uh_key *replaced) {                     \
+        ulib_uint k = uhash_get_##T(h, key);                                                       \
+        if (k == UHASH_INDEX_MISSING) return false;                                                \
+        if (replaced) *replaced = uhash_key(T, h, k);                                              \
+        uhash_key(T, h, k) = key;                                                                  \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE bool uhset_remove_##T(UHash_##T *h, uh_key key, uh_key *removed) {                       \
+        ulib_uint k = uhash_get_##T(h, key);                                                       \
+        if (k == UHASH_INDEX_MISSING) return false;                                                \
+        if (removed) *removed = uhash_key(T, h, k);                                                \
+        uhash_delete_##T(h, k);                                                                    \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE bool uhset_is_superset_##T(UHash_##T const *h1, UHash_##T const *h2) {                   \
+        for (ulib_uint i = 0; i != uhash_size(T, h2); ++i) {                                       \
+            if (uhash_exists(T, h2, i) &&                                                          \
+                uhash_get_##T(h1, uhash_key(T, h2, i)) == UHASH_INDEX_MISSING) {                   \
+                return false;                                                                      \
+            }                                                                                      \
+        }                                                                                          \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhset_union_##T(UHash_##T *h1, UHash_##T const *h2) {                          \
+        for (ulib_uint i = 0; i != uhash_size(T, h2); ++i) {                                       \
+            if (uhash_exists(T, h2, i) &&                                                          \
+                uhset_insert_##T(h1, uhash_key(T, h2, i), NULL) == UHASH_ERR) {                    \
+                return UHASH_ERR;                                                                  \
+            }                                                                                      \
+        }                                                                                          \
+        return UHASH_OK;                                                                           \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE void uhset_intersect_##T(UHash_##T *h1, UHash_##T const *h2) {                           \
+        for (ulib_uint i = 0; i != uhash_size(T, h1);) {                                           \
+            if (uhash_exists(T, h1, i) &&                                                          \
+                uhash_get_##T(h2, uhash_key(T, h1, i)) == UHASH_INDEX_MISSING) {                   \
+                /* Deletion may move another key into the bucket, which is then tested next. */    \
+                p_uhash_delete_##T(h1, i);                                                         \
+            } else {                                                                               \
+                ++i;                                                                               \
+            }                                                                                      \
+        }                                                                                          \
+        p_uhash_compact_##T(h1);                                                                   \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE ulib_uint uhset_hash_##T(UHash_##T const *h) {                                           \
+        ulib_uint hash = 0;                                                                        \
+        for (ulib_uint i = 0; i != uhash_size(T, h); ++i) {                                        \
+            if (uhash_exists(T, h, i)) hash ^= hash_func(uhash_key(T, h, i));                      \
+        }                                                                                          \
+        return hash;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uh_key uhset_get_any_##T(UHash_##T const *h, uh_key if_empty) {                          \
+        ulib_uint i = uhash_next_##T(h, 0);                                                        \
+        return i == uhash_size(T, h) ? if_empty : uhash_key(T, h, i);                              \
+    }
+
+/*
+ * Generates common function definitions for the specified hash table type.
+ *
+ * @param T [symbol] Hash table name.
+ * @param SCOPE [scope] Scope of the definitions.
+ * @param uh_key [type] Hash table key type.
+ * @param uh_val [type] Hash table value type.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
+ * @param min_load [ulib_float] Load factor below which the table shrinks on deletion (0 = never).
+ * @param max_deleted [ulib_float] Ratio of deleted buckets above which the table is rehashed
+ *                    on deletion (0 = never).
+ */
+#define P_UHASH_IMPL_COMMON(T, SCOPE, uh_key, uh_val, hash_func, equal_func, min_load,             \
+                            max_deleted)                                                           \
+    P_UHASH_IMPL_CORE(T, SCOPE, uh_key, uh_val, hash_func, equal_func)                             \
+    P_UHASH_IMPL_COPY(T, SCOPE, uh_val)                                                            \
+    P_UHASH_IMPL_API(T, SCOPE, uh_key, uh_val, hash_func, equal_func, min_load, max_deleted)
+
+/*
+ * Generates function definitions for the specified concurrent hash table type.
+ *
+ * @param T [symbol] Hash table name.
+ * @param SCOPE [scope] Scope of the definitions.
+ * @param uh_key [type] Hash table key type.
+ * @param uh_val [type] Hash table value type.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function.
+ */
+#define P_UHASH_IMPL_CONCURRENT(T, SCOPE, uh_key, uh_val, hash_func, equal_func)                   \
+    P_UHASH_DECL(p_shard_##T, static inline ulib_unused, uh_key, uh_val)                           \
+    P_UHASH_DEF_INLINE(p_shard_##T, ulib_unused, uh_key, uh_val)                                   \
+    P_UHASH_IMPL_LOAD(p_shard_##T, UHASH_MAX_LOAD)                                                 \
+    P_UHASH_IMPL_INIT(p_shard_##T, static inline ulib_unused)                                      \
+    P_UHASH_IMPL_COMMON(p_shard_##T, static inline ulib_unused, uh_key, uh_val, hash_func,         \
+                        equal_func, 0, 0)                                                          \
+                                                                                                   \
+    static inline P_UHashShard_##T *p_uhash_shard_##T(UHash_##T const *h, ulib_uint hash) {        \
+        return (P_UHashShard_##T *)(h->_shards + p_uhash_shard(hash));                             \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE UHash_##T uhmap_##T(void) {                                                              \
+        UHash_##T h;                                                                               \
+        URWLock const lock = URWLOCK_INIT;                                                         \
+        for (ulib_uint i = 0; i < UHASH_CONCURRENT_SHARDS; ++i) {                                  \
+            h._shards[i].lock = lock;                                                              \
+            h._shards[i].h = uhmap_p_shard_##T();                                                  \
+        }                                                                                          \
+        return h;                                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE UHash_##T uhset_##T(void) {                                                              \
+        UHash_##T h;                                                                               \
+        URWLock const lock = URWLOCK_INIT;                                                         \
+        for (ulib_uint i = 0; i < UHASH_CONCURRENT_SHARDS; ++i) {                                  \
+            h._shards[i].lock = lock;                                                              \
+            h._shards[i].h = uhset_p_shard_##T();                                                  \
+        }                                                                                          \
+        return h;                                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE void uhash_deinit_##T(UHash_##T *h) {                                                    \
+        for (ulib_uint i = 0; i < UHASH_CONCURRENT_SHARDS; ++i) {                                  \
+            uhash_deinit_p_shard_##T(&h->_shards[i].h);                                            \
+            urwlock_deinit(&h->_shards[i].lock);                                                   \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE void uhash_clear_##T(UHash_##T *h) {                                                     \
+        for (ulib_uint i = 0; i < UHASH_CONCURRENT_SHARDS; ++i) {                                  \
+            urwlock_write_lock(&h->_shards[i].lock);                                               \
+            uhash_clear_p_shard_##T(&h->_shards[i].h);                                             \
+            urwlock_write_unlock(&h->_shards[i].lock);                                             \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE ulib_uint uhash_count_##T(UHash_##T const *h) {                                          \
+        ulib_uint count = 0;                                                                       \
+        for (ulib_uint i = 0; i < UHASH_CONCURRENT_SHARDS; ++i) {                                  \
+            P_UHashShard_##T *s = (P_UHashShard_##T *)(h->_shards + i);                            \
+            urwlock_read_lock(&s->lock);                                                           \
+            count += s->h._count;                                                                  \
+            urwlock_read_unlock(&s->lock);                                                         \
+        }                                                                                          \
+        return count;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE bool uhash_contains_##T(UHash_##T const *h, uh_key key) {                                \
+        ulib_uint const hash = (ulib_uint)(hash_func(key));                                        \
+        P_UHashShard_##T *s = p_uhash_shard_##T(h, hash);                                          \
+        urwlock_read_lock(&s->lock);                                                               \
+        bool const ret = p_uhash_get_hashed_p_shard_##T(&s->h, key, hash) != UHASH_INDEX_MISSING;  \
+        urwlock_read_unlock(&s->lock);                                                             \
+        return ret;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uh_val uhmap_get_##T(UHash_##T const *h, uh_key key, uh_val if_missing) {                \
+        ulib_uint const hash = (ulib_uint)(hash_func(key));                                        \
+        P_UHashShard_##T *s = p_uhash_shard_##T(h, hash);                                          \
+        urwlock_read_lock(&s->lock);                                                               \
+        ulib_uint const i = p_uhash_get_hashed_p_shard_##T(&s->h, key, hash);                      \
+        uh_val const ret = i == UHASH_INDEX_MISSING ? if_missing : s->h._vals[i];                  \
+        urwlock_read_unlock(&s->lock);                                                             \
+        return ret;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhmap_set_##T(UHash_##T *h, uh_key key, uh_val value, uh_val *existing) {      \
+        ulib_uint const hash = (ulib_uint)(hash_func(key));                                        \
+        P_UHashShard_##T *s = p_uhash_shard_##T(h, hash);                                          \
+        ulib_uint k;                                                                               \
+        urwlock_write_lock(&s->lock);                                                              \
+        uhash_ret const ret = p_uhash_put_hashed_p_shard_##T(&s->h, key, hash, &k);                \
+        if (ret != UHASH_ERR) {                                                                    \
+            if (ret == UHASH_PRESENT && existing) *existing = s->h._vals[k];                       \
+            s->h._vals[k] = value;                                                                 \
+        }                                                                                          \
+        urwlock_write_unlock(&s->lock);                                                            \
+        return ret;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhmap_add_##T(UHash_##T *h, uh_key key, uh_val value, uh_val *existing) {      \
+        ulib_uint const hash = (ulib_uint)(hash_func(key));                                        \
+        P_UHashShard_##T *s = p_uhash_shard_##T(h, hash);                                          \
+        ulib_uint k;                                                                               \
+        urwlock_write_lock(&s->lock);                                                              \
+        uhash_ret const ret = p_uhash_put_hashed_p_shard_##T(&s->h, key, hash, &k);                \
+        if (ret == UHASH_INSERTED) {                                                               \
+            s->h._vals[k] = value;                                                                 \
+        } else if (ret == UHASH_PRESENT && existing) {                                             \
+            *existing = s->h._vals[k];                                                             \
+        }                                                                                          \
+        urwlock_write_unlock(&s->lock);                                                            \
+        return ret;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE bool uhmap_replace_##T(UHash_##T *h, uh_key key, uh_val value, uh_val *replaced) {       \
+        ulib_uint const hash = (ulib_uint)(hash_func(key));                                        \
+        P_UHashShard_##T *s = p_uhash_shard_##T(h, hash);                                          \
+        urwlock_write_lock(&s->lock);                                                              \
+        ulib_uint const k = p_uhash_get_hashed_p_shard_##T(&s->h, key, hash);                      \
+        bool const ret = k != UHASH_INDEX_MISSING;                                                 \
+        if (ret) {                                                                                 \
+            if (replaced) *replaced = s->h._vals[k];                                               \
+            s->h._vals[k] = value;                                                                 \
+        }                                                                                          \
+        urwlock_write_unlock(&s->lock);                                                            \
+        return ret;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE bool uhmap_remove_##T(UHash_##T *h, uh_key key, uh_key *r_key, uh_val *r_val) {          \
+        ulib_uint const hash = (ulib_uint)(hash_func(key));                                        \
+        P_UHashShard_##T *s = p_uhash_shard_##T(h, hash);                                          \
+        urwlock_write_lock(&s->lock);                                                              \
+        ulib_uint const k = p_uhash_get_hashed_p_shard_##T(&s->h, key, hash);                      \
+        bool const ret = k != UHASH_INDEX_MISSING;                                                 \
+        if (ret) {                                                                                 \
+            if (r_key) *r_key = s->h._keys[k];                                                     \
+            if (r_val) *r_val = s->h._vals[k];                                                     \
+            uhash_delete_p_shard_##T(&s->h, k);                                                    \
+        }                                                                                          \
+        urwlock_write_unlock(&s->lock);                                                            \
+        return ret;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uhash_ret uhset_insert_##T(UHash_##T *h, uh_key key, uh_key *existing) {                 \
+        ulib_uint const hash = (ulib_uint)(hash_func(key));                                        \
+        P_UHashShard_##T *s = p_uhash_shard_##T(h, hash);                                          \
+        ulib_uint k;                                                                               \
+        urwlock_write_lock(&s->lock);                                                              \
+        uhash_ret const ret = p_uhash_put_hashed_p_shard_##T(&s->h, key, hash, &k);                \
+        if (ret == UHASH_PRESENT && existing) *existing = s->h._keys[k];                           \
+        urwlock_write_unlock(&s->lock);                                                            \
+        return ret;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE bool uhset_remove_##T(UHash_##T *h, uh_key key, uh_key *removed) {                       \
+        return uhmap_remove_##T(h, key, removed, NULL);                                            \
+    }
+
+/// @name Type definitions
+
+/**
+ * Declares a new hash table type.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ *
+ * @public @related UHash
+ */
+#define UHASH_DECL(T, uh_key, uh_val)                                                              \
+    P_UHASH_DEF_TYPE(T, uh_key, uh_val)                                                            \
+    P_UHASH_DECL(T, ulib_unused, uh_key, uh_val)                                                   \
+    P_UHASH_DEF_INLINE(T, ulib_unused, uh_key, uh_val)
+
+/**
+ * Declares a new hash table type, prepending a specifier to the generated declarations.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ * @param SPEC [specifier] Specifier.
+ *
+ * @public @related UHash
+ */
+#define UHASH_DECL_SPEC(T, uh_key, uh_val, SPEC)                                                   \
+    P_UHASH_DEF_TYPE(T, uh_key, uh_val)                                                            \
+    P_UHASH_DECL(T, SPEC ulib_unused, uh_key, uh_val)                                              \
+    P_UHASH_DEF_INLINE(T, ulib_unused, uh_key, uh_val)
+
+/**
+ * Declares a new hash table type with per-instance hash and equality functions.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ *
+ * @public @related UHash
+ */
+#define UHASH_DECL_PI(T, uh_key, uh_val)                                                           \
+    P_UHASH_DEF_TYPE_PI(T, uh_key, uh_val)                                                         \
+    P_UHASH_DECL_PI(T, ulib_unused, uh_key, uh_val)                                                \
+    P_UHASH_DEF_INLINE(T, ulib_unused, uh_key, uh_val)
+
+/**
+ * Declares a new hash table type with per-instance hash and equality functions,
+ * prepending a specifier to the generated declarations.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ * @param SPEC [specifier] Specifier.
+ *
+ * @public @related UHash
+ */
+#define UHASH_DECL_PI_SPEC(T, uh_key, uh_val, SPEC)                                                \
+    P_UHASH_DEF_TYPE_PI(T, uh_key, uh_val)                                                         \
+    P_UHASH_DECL_PI(T, SPEC ulib_unused, uh_key, uh_val)                                           \
+    P_UHASH_DEF_INLINE(T, ulib_unused, uh_key, uh_val)
+
+/**
+ * Declares a new hash table type whose buckets are probed in groups via SIMD instructions.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ *
+ * @note SIMD hash tables store one control byte per bucket, holding either its state
+ *       or 7 bits of the hash of its key, and match a whole group of buckets at once,
+ *       which makes lookups of missing keys and keys with expensive equality functions faster.
+ *       If SIMD instructions are not available, group matching falls back to scalar code.
+ *
+ * @public @related UHash
+ */
+#define UHASH_DECL_SIMD(T, uh_key, uh_val)                                                         \
+    P_UHASH_DEF_TYPE_SIMD(T, uh_key, uh_val)                                                       \
+    P_UHASH_DECL(T, ulib_unused, uh_key, uh_val)                                                   \
+    P_UHASH_DEF_INLINE_SIMD(T, ulib_unused, uh_key, uh_val)
+
+/**
+ * Declares a new hash table type whose buckets are probed in groups via SIMD instructions,
+ * prepending a specifier to the generated declarations.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ * @param SPEC [specifier] Specifier.
+ *
+ * @public @related UHash
+ */
+#define UHASH_DECL_SIMD_SPEC(T, uh_key, uh_val, SPEC)                                              \
+    P_UHASH_DEF_TYPE_SIMD(T, uh_key, uh_val)                                                       \
+    P_UHASH_DECL(T, SPEC ulib_unused, uh_key, uh_val)                                              \
+    P_UHASH_DEF_INLINE_SIMD(T, ulib_unused, uh_key, uh_val)
+
+/**
+ * Declares a new hash table type that stores the hash of each key.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ *
+ * @note Stored hashes are reused when the table is resized, and compared before calling
+ *       the equality function while probing. They are worth their memory overhead
+ *       for keys whose hash or equality functions are expensive, such as long strings.
+ *
+ * @public @related UHash
+ */
+#define UHASH_DECL_CACHED_HASH(T, uh_key, uh_val)                                                  \
+    P_UHASH_DEF_TYPE_CACHED_HASH(T, uh_key, uh_val)                                                \
+    P_UHASH_DECL(T, ulib_unused, uh_key, uh_val)                                                   \
+    P_UHASH_DEF_INLINE(T, ulib_unused, uh_key, uh_val)
+
+/**
+ * Declares a new hash table type that stores the hash of each key,
+ * prepending a specifier to the generated declarations.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ * @param SPEC [specifier] Specifier.
+ *
+ * @public @related UHash
+ */
+#define UHASH_DECL_CACHED_HASH_SPEC(T, uh_key, uh_val, SPEC)                                       \
+    P_UHASH_DEF_TYPE_CACHED_HASH(T, uh_key, uh_val)                                                \
+    P_UHASH_DECL(T, SPEC ulib_unused, uh_key, uh_val)                                              \
+    P_UHASH_DEF_INLINE(T, ulib_unused, uh_key, uh_val)
+
+/**
+ * Declares a new hash table type that is resized incrementally.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ *
+ * @note When an incremental hash table needs to grow, its buckets are moved to the new table
+ *       UHASH_MIGRATE_STEP at a time on each insertion, which bounds the latency of uhash_put.
+ *       Lookups and iteration remain valid during the migration, with the buckets of the old
+ *       table following those of the new one. As usual, insertions invalidate bucket indices.
+ *       Explicit calls to uhash_resize are not incremental.
+ *
+ * @public @related UHash
+ */
+#define UHASH_DECL_INCREMENTAL(T, uh_key, uh_val)                                                  \
+    P_UHASH_DEF_TYPE_INCREMENTAL(T, uh_key, uh_val)                                                \
+    P_UHASH_DECL(T, ulib_unused, uh_key, uh_val)                                                   \
+    P_UHASH_DEF_INLINE_INCREMENTAL(T, ulib_unused, uh_key, uh_val)
+
+/**
+ * Declares a new hash table type that is resized incrementally,
+ * prepending a specifier to the generated declarations.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ * @param SPEC [specifier] Specifier.
+ *
+ * @public @related UHash
+ */
+#define UHASH_DECL_INCREMENTAL_SPEC(T, uh_key, uh_val, SPEC)                                       \
+    P_UHASH_DEF_TYPE_INCREMENTAL(T, uh_key, uh_val)                                                \
+    P_UHASH_DECL(T, SPEC ulib_unused, uh_key, uh_val)                                              \
+    P_UHASH_DEF_INLINE_INCREMENTAL(T, ulib_unused, uh_key, uh_val)
+
+/**
+ * Declares a new hash table type that uses Robin Hood hashing.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ *
+ * @note Robin Hood hash tables probe linearly, and on insertion let keys that are far from
+ *       their home bucket take the place of keys that are closer to theirs. This bounds the
+ *       variance of probe lengths, so that they stay short even at high load factors,
+ *       and lets lookups of missing keys stop early. Deletions shift the following keys
+ *       backward instead of leaving tombstones, so deleting the key at some index may move
+ *       another key into that index: when deleting while iterating, only move to the next
+ *       bucket if the current one is empty after the deletion.
+ *       Hashes are mixed before probing, and insertions return UHASH_ERR if a probe distance
+ *       would exceed 65535, which only happens with degenerate hash functions.
+ *
+ * @public @related UHash
+ */
+#define UHASH_DECL_ROBIN_HOOD(T, uh_key, uh_val)                                                   \
+    P_UHASH_DEF_TYPE_ROBIN_HOOD(T, uh_key, uh_val)                                                 \
+    P_UHASH_DECL(T, ulib_unused, uh_key, uh_val)                                                   \
+    P_UHASH_DEF_INLINE_ROBIN_HOOD(T, ulib_unused, uh_key, uh_val)
+
+/**
+ * Declares a new hash table type that uses Robin Hood hashing,
+ * prepending a specifier to the generated declarations.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ * @param SPEC [specifier] Specifier.
+ *
+ * @public @related UHash
+ */
+#define UHASH_DECL_ROBIN_HOOD_SPEC(T, uh_key, uh_val, SPEC)                                        \
+    P_UHASH_DEF_TYPE_ROBIN_HOOD(T, uh_key, uh_val)                                                 \
+    P_UHASH_DECL(T, SPEC ulib_unused, uh_key, uh_val)                                              \
+    P_UHASH_DEF_INLINE_ROBIN_HOOD(T, ulib_unused, uh_key, uh_val)
+
+/**
+ * Declares a new hash table type that stores each key next to its value.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ *
+ * @note Interleaved hash tables store keys and values in a single array of slots, so that
+ *       a successful lookup touches one cache line for the slot, instead of one for the key
+ *       and one for the value. They are best suited for maps whose keys and values are small,
+ *       and which are frequently queried for keys they contain. Tables that are mostly probed
+ *       for missing keys, or whose values are large, favor the default layout, since probing
+ *       then walks over keys only. Slots always have room for a value, so interleaved tables
+ *       are always maps.
+ *
+ * @public @related UHash
+ */
+#define UHASH_DECL_INTERLEAVED(T, uh_key, uh_val)                                                  \
+    P_UHASH_DEF_TYPE_INTERLEAVED(T, uh_key, uh_val)                                                \
+    P_UHASH_DECL(T, ulib_unused, uh_key, uh_val)                                                   \
+    P_UHASH_DEF_INLINE_INTERLEAVED(T, ulib_unused, uh_key, uh_val)
+
+/**
+ * Declares a new hash table type that stores each key next to its value,
+ * prepending a specifier to the generated declarations.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ * @param SPEC [specifier] Specifier.
+ *
+ * @public @related UHash
+ */
+#define UHASH_DECL_INTERLEAVED_SPEC(T, uh_key, uh_val, SPEC)                                       \
+    P_UHASH_DEF_TYPE_INTERLEAVED(T, uh_key, uh_val)                                                \
+    P_UHASH_DECL(T, SPEC ulib_unused, uh_key, uh_val)                                              \
+    P_UHASH_DEF_INLINE_INTERLEAVED(T, ulib_unused, uh_key, uh_val)
+
+/**
+ * Declares a new concurrent hash table type, which can be accessed by multiple threads.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ *
+ * @note Concurrent hash tables are made of UHASH_CONCURRENT_SHARDS independent shards,
+ *       each guarded by its own read-write lock, so that operations on keys that belong
+ *       to different shards do not contend with each other. Since bucket indices are
+ *       meaningless across threads, they only support the key-based API: uhmap_get, uhmap_set,
+ *       uhmap_add, uhmap_replace, uhmap_remove, uhmap_pop, uhset_insert, uhset_remove, uhset_pop,
+ *       uhash_contains, uhash_count, uhash_clear and uhash_deinit. Instances must not be copied
+ *       once in use.
+ *
+ * @public @related UHash
+ */
+#define UHASH_DECL_CONCURRENT(T, uh_key, uh_val)                                                   \
+    P_UHASH_DEF_TYPE_CONCURRENT(T, uh_key, uh_val)                                                 \
+    P_UHASH_DECL_CONCURRENT(T, ulib_unused, uh_key, uh_val)
+
+/**
+ * Declares a new concurrent hash table type, prepending a specifier to the generated declarations.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ * @param SPEC [specifier] Specifier.
+ *
+ * @public @related UHash
+ */
+#define UHASH_DECL_CONCURRENT_SPEC(T, uh_key, uh_val, SPEC)                                        \
+    P_UHASH_DEF_TYPE_CONCURRENT(T, uh_key, uh_val)                                                 \
+    P_UHASH_DECL_CONCURRENT(T, SPEC ulib_unused, uh_key, uh_val)
+
+/**
+ * Implements a previously declared hash table type.
+ *
+ * @param T [symbol] Hash table name.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
+ *
+ * @public @related UHash
+ */
+#define UHASH_IMPL(T, hash_func, equal_func)                                                       \
+    P_UHASH_IMPL_LOAD(T, UHASH_MAX_LOAD)                                                           \
+    P_UHASH_IMPL_INIT(T, ulib_unused)                                                              \
+    P_UHASH_IMPL_COMMON(T, ulib_unused, uhash_##T##_key, uhash_##T##_val, hash_func, equal_func,   \
+                        0, 0)
+
+/**
+ * Implements a previously declared hash table type with per-instance hash and equality functions.
+ *
+ * @param T [symbol] Hash table name.
+ * @param default_hfunc [(uh_key) -> ulib_uint] Default hash function (can be NULL).
+ * @param default_efunc [(uh_key, uh_key) -> bool] Default equality function (can be NULL).
+ *
+ * @public @related UHash
+ */
+#define UHASH_IMPL_PI(T, default_hfunc, default_efunc)                                             \
+    P_UHASH_IMPL_LOAD(T, UHASH_MAX_LOAD)                                                           \
+    P_UHASH_IMPL_INIT_PI(T, ulib_unused, uhash_##T##_key, default_hfunc, default_efunc)            \
+    P_UHASH_IMPL_COMMON(T, ulib_unused, uhash_##T##_key, uhash_##T##_val, h->_hfunc, h->_efunc,    \
+                        h->_min_load, h->_max_deleted)
+
+/**
+ * Implements a previously declared hash table type with the specified maximum load factor.
+ *
+ * @param T [symbol] Hash table name.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
+ * @param max_load [double] Maximum load factor, in the (0, 1) range.
+ *
+ * @note Higher load factors save memory at the cost of longer probe sequences.
+ *
+ * @public @related UHash
+ */
+#define UHASH_IMPL_LOAD(T, hash_func, equal_func, max_load)                                        \
+    P_UHASH_IMPL_LOAD(T, max_load)                                                                 \
+    P_UHASH_IMPL_INIT(T, ulib_unused)                                                              \
+    P_UHASH_IMPL_COMMON(T, ulib_unused, uhash_##T##_key, uhash_##T##_val, hash_func, equal_func,   \
+                        0, 0)
+
+/**
+ * Implements a previously declared hash table type that compacts itself on deletion.
+ *
+ * @param T [symbol] Hash table name.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
+ * @param min_load [ulib_float] Load factor below which the table shrinks (0 = never).
+ * @param max_deleted [ulib_float] Ratio of deleted buckets above which the table is rehashed
+ *                    (0 = never).
+ *
+ * @note Compaction happens in uhash_delete, uhmap_remove and uhset_remove, which then invalidate
+ *       bucket indices. min_load should be well below UHASH_MAX_LOAD / 2 to avoid thrashing.
+ *
+ * @public @related UHash
+ */
+#define UHASH_IMPL_COMPACT(T, hash_func, equal_func, min_load, max_deleted)                        \
+    P_UHASH_IMPL_LOAD(T, UHASH_MAX_LOAD)                                                           \
+    P_UHASH_IMPL_INIT(T, ulib_unused)                                                              \
+    P_UHASH_IMPL_COMMON(T, ulib_unused, uhash_##T##_key, uhash_##T##_val, hash_func, equal_func,   \
+                        min_load, max_deleted)
 
 /**
- * Declares a new hash table type.
+ * Implements a previously declared SIMD hash table type.
  *
  * @param T [symbol] Hash table name.
- * @param uh_key [symbol] Type of the keys.
- * @param uh_val [symbol] Type of the values.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
  *
  * @public @related UHash
  */
-#define UHASH_DECL(T, uh_key, uh_val)                                                              \
-    P_UHASH_DEF_TYPE(T, uh_key, uh_val)                                                            \
-    P_UHASH_DECL(T, ulib_unused, uh_key, uh_val)                                                   \
-    P_UHASH_DEF_INLINE(T, ulib_unused)
+#define UHASH_IMPL_SIMD(T, hash_func, equal_func)                                                  \
+    P_UHASH_IMPL_LOAD(T, UHASH_MAX_LOAD)                                                           \
+    P_UHASH_IMPL_INIT(T, ulib_unused)                                                              \
+    P_UHASH_IMPL_SIMD_CORE(T, ulib_unused, uhash_##T##_key, uhash_##T##_val, hash_func,            \
+                           equal_func)                                                             \
+    P_UHASH_IMPL_COPY(T, ulib_unused, uhash_##T##_val)                                             \
+    P_UHASH_IMPL_API(T, ulib_unused, uhash_##T##_key, uhash_##T##_val, hash_func, equal_func, 0, 0)
 
 /**
- * Declares a new hash table type, prepending a specifier to the generated declarations.
+ * Implements a previously declared hash table type that stores the hash of each key.
  *
  * @param T [symbol] Hash table name.
- * @param uh_key [symbol] Type of the keys.
- * @param uh_val [symbol] Type of the values.
- * @param SPEC [specifier] Specifier.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
  *
  * @public @related UHash
  */
-#define UHASH_DECL_SPEC(T, uh_key, uh_val, SPEC)                                                   \
-    P_UHASH_DEF_TYPE(T, uh_key, uh_val)                                                            \
-    P_UHASH_DECL(T, SPEC ulib_unused, uh_key, uh_val)                                              \
-    P_UHASH_DEF_INLINE(T, ulib_unused)
+#define UHASH_IMPL_CACHED_HASH(T, hash_func, equal_func)                                           \
+    P_UHASH_IMPL_LOAD(T, UHASH_MAX_LOAD)                                                           \
+    P_UHASH_IMPL_INIT(T, ulib_unused)                                                              \
+    P_UHASH_IMPL_CACHED_HASH_CORE(T, ulib_unused, uhash_##T##_key, uhash_##T##_val, hash_func,     \
+                                  equal_func)                                                      \
+    P_UHASH_IMPL_COPY(T, ulib_unused, uhash_##T##_val)                                             \
+    P_UHASH_IMPL_API(T, ulib_unused, uhash_##T##_key, uhash_##T##_val, hash_func, equal_func, 0, 0)
 
 /**
- * Declares a new hash table type with per-instance hash and equality functions.
+ * Implements a previously declared hash table type that is resized incrementally.
  *
  * @param T [symbol] Hash table name.
- * @param uh_key [symbol] Type of the keys.
- * @param uh_val [symbol] Type of the values.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
  *
  * @public @related UHash
  */
-#define UHASH_DECL_PI(T, uh_key, uh_val)                                                           \
-    P_UHASH_DEF_TYPE_PI(T, uh_key, uh_val)                                                         \
-    P_UHASH_DECL_PI(T, ulib_unused, uh_key, uh_val)                                                \
-    P_UHASH_DEF_INLINE(T, ulib_unused)
+#define UHASH_IMPL_INCREMENTAL(T, hash_func, equal_func)                                           \
+    P_UHASH_IMPL_LOAD(T, UHASH_MAX_LOAD)                                                           \
+    P_UHASH_IMPL_INIT(T, ulib_unused)                                                              \
+    P_UHASH_IMPL_INCREMENTAL_CORE(T, ulib_unused, uhash_##T##_key, uhash_##T##_val, hash_func,     \
+                                  equal_func)                                                      \
+    P_UHASH_IMPL_API(T, ulib_unused, uhash_##T##_key, uhash_##T##_val, hash_func, equal_func, 0, 0)
 
 /**
- * Declares a new hash table type with per-instance hash and equality functions,
- * prepending a specifier to the generated declarations.
+ * Implements a previously declared hash table type that uses Robin Hood hashing.
  *
  * @param T [symbol] Hash table name.
- * @param uh_key [symbol] Type of the keys.
- * @param uh_val [symbol] Type of the values.
- * @param SPEC [specifier] Specifier.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
+ * @param max_load [double] Maximum load factor, in the (0, 1) range (e.g. UHASH_MAX_LOAD).
  *
  * @public @related UHash
  */
-#define UHASH_DECL_PI_SPEC(T, uh_key, uh_val, SPEC)                                                \
-    P_UHASH_DEF_TYPE_PI(T, uh_key, uh_val)                                                         \
-    P_UHASH_DECL_PI(T, SPEC ulib_unused, uh_key, uh_val)                                           \
-    P_UHASH_DEF_INLINE(T, ulib_unused)
+#define UHASH_IMPL_ROBIN_HOOD(T, hash_func, equal_func, max_load)                                  \
+    P_UHASH_IMPL_LOAD(T, max_load)                                                                 \
+    P_UHASH_IMPL_INIT(T, ulib_unused)                                                              \
+    P_UHASH_IMPL_ROBIN_HOOD_CORE(T, ulib_unused, uhash_##T##_key, uhash_##T##_val, hash_func,      \
+                                 equal_func)                                                       \
+    P_UHASH_IMPL_COPY(T, ulib_unused, uhash_##T##_val)                                             \
+    P_UHASH_IMPL_API(T, ulib_unused, uhash_##T##_key, uhash_##T##_val, hash_func, equal_func, 0, 0)
 
 /**
- * Implements a previously declared hash table type.
+ * Implements a previously declared hash table type that stores each key next to its value.
  *
  * @param T [symbol] Hash table name.
  * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
@@ -817,22 +3085,25 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
  *
  * @public @related UHash
  */
-#define UHASH_IMPL(T, hash_func, equal_func)                                                       \
+#define UHASH_IMPL_INTERLEAVED(T, hash_func, equal_func)                                           \
+    P_UHASH_IMPL_LOAD(T, UHASH_MAX_LOAD)                                                           \
     P_UHASH_IMPL_INIT(T, ulib_unused)                                                              \
-    P_UHASH_IMPL_COMMON(T, ulib_unused, uhash_##T##_key, uhash_##T##_val, hash_func, equal_func)
+    P_UHASH_IMPL_INTERLEAVED_CORE(T, ulib_unused, uhash_##T##_key, uhash_##T##_val, hash_func,     \
+                                  equal_func)                                                      \
+    P_UHASH_IMPL_API(T, ulib_unused, uhash_##T##_key, uhash_##T##_val, hash_func, equal_func, 0, 0)
 
 /**
- * Implements a previously declared hash table type with per-instance hash and equality functions.
+ * Implements a previously declared concurrent hash table type.
  *
  * @param T [symbol] Hash table name.
- * @param default_hfunc [(uh_key) -> ulib_uint] Default hash function (can be NULL).
- * @param default_efunc [(uh_key, uh_key) -> bool] Default equality function (can be NULL).
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
  *
  * @public @related UHash
  */
-#define UHASH_IMPL_PI(T, default_hfunc, default_efunc)                                             \
-    P_UHASH_IMPL_INIT_PI(T, ulib_unused, uhash_##T##_key, default_hfunc, default_efunc)            \
-    P_UHASH_IMPL_COMMON(T, ulib_unused, uhash_##T##_key, uhash_##T##_val, h->_hfunc, h->_efunc)
+#define UHASH_IMPL_CONCURRENT(T, hash_func, equal_func)                                            \
+    P_UHASH_IMPL_CONCURRENT(T, ulib_unused, uhash_##T##_key, uhash_##T##_val, hash_func,           \
+                            equal_func)
 
 /**
  * Defines a new static hash table type.
@@ -848,9 +3119,10 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
 #define UHASH_INIT(T, uh_key, uh_val, hash_func, equal_func)                                       \
     P_UHASH_DEF_TYPE(T, uh_key, uh_val)                                                            \
     P_UHASH_DECL(T, static inline ulib_unused, uh_key, uh_val)                                     \
-    P_UHASH_DEF_INLINE(T, ulib_unused)                                                             \
+    P_UHASH_DEF_INLINE(T, ulib_unused, uh_key, uh_val)                                             \
+    P_UHASH_IMPL_LOAD(T, UHASH_MAX_LOAD)                                                           \
     P_UHASH_IMPL_INIT(T, static inline ulib_unused)                                                \
-    P_UHASH_IMPL_COMMON(T, static inline ulib_unused, uh_key, uh_val, hash_func, equal_func)
+    P_UHASH_IMPL_COMMON(T, static inline ulib_unused, uh_key, uh_val, hash_func, equal_func, 0, 0)
 
 /**
  * Defines a new static hash table type with per-instance hash and equality functions.
@@ -866,9 +3138,178 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
 #define UHASH_INIT_PI(T, uh_key, uh_val, default_hfunc, default_efunc)                             \
     P_UHASH_DEF_TYPE_PI(T, uh_key, uh_val)                                                         \
     P_UHASH_DECL_PI(T, static inline ulib_unused, uh_key, uh_val)                                  \
-    P_UHASH_DEF_INLINE(T, ulib_unused)                                                             \
+    P_UHASH_DEF_INLINE(T, ulib_unused, uh_key, uh_val)                                             \
+    P_UHASH_IMPL_LOAD(T, UHASH_MAX_LOAD)                                                           \
     P_UHASH_IMPL_INIT_PI(T, static inline ulib_unused, uh_key, default_hfunc, default_efunc)       \
-    P_UHASH_IMPL_COMMON(T, static inline ulib_unused, uh_key, uh_val, h->_hfunc, h->_efunc)
+    P_UHASH_IMPL_COMMON(T, static inline ulib_unused, uh_key, uh_val, h->_hfunc, h->_efunc,        \
+                        h->_min_load, h->_max_deleted)
+
+/**
+ * Defines a new static hash table type with the specified maximum load factor.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
+ * @param max_load [double] Maximum load factor, in the (0, 1) range.
+ *
+ * @public @related UHash
+ */
+#define UHASH_INIT_LOAD(T, uh_key, uh_val, hash_func, equal_func, max_load)                        \
+    P_UHASH_DEF_TYPE(T, uh_key, uh_val)                                                            \
+    P_UHASH_DECL(T, static inline ulib_unused, uh_key, uh_val)                                     \
+    P_UHASH_DEF_INLINE(T, ulib_unused, uh_key, uh_val)                                             \
+    P_UHASH_IMPL_LOAD(T, max_load)                                                                 \
+    P_UHASH_IMPL_INIT(T, static inline ulib_unused)                                                \
+    P_UHASH_IMPL_COMMON(T, static inline ulib_unused, uh_key, uh_val, hash_func, equal_func, 0, 0)
+
+/**
+ * Defines a new static hash table type that compacts itself on deletion.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
+ * @param min_load [ulib_float] Load factor below which the table shrinks (0 = never).
+ * @param max_deleted [ulib_float] Ratio of deleted buckets above which the table is rehashed
+ *                    (0 = never).
+ *
+ * @public @related UHash
+ */
+#define UHASH_INIT_COMPACT(T, uh_key, uh_val, hash_func, equal_func, min_load, max_deleted)        \
+    P_UHASH_DEF_TYPE(T, uh_key, uh_val)                                                            \
+    P_UHASH_DECL(T, static inline ulib_unused, uh_key, uh_val)                                     \
+    P_UHASH_DEF_INLINE(T, ulib_unused, uh_key, uh_val)                                             \
+    P_UHASH_IMPL_LOAD(T, UHASH_MAX_LOAD)                                                           \
+    P_UHASH_IMPL_INIT(T, static inline ulib_unused)                                                \
+    P_UHASH_IMPL_COMMON(T, static inline ulib_unused, uh_key, uh_val, hash_func, equal_func,       \
+                        min_load, max_deleted)
+
+/**
+ * Defines a new static hash table type whose buckets are probed in groups via SIMD instructions.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
+ *
+ * @public @related UHash
+ */
+#define UHASH_INIT_SIMD(T, uh_key, uh_val, hash_func, equal_func)                                  \
+    P_UHASH_DEF_TYPE_SIMD(T, uh_key, uh_val)                                                       \
+    P_UHASH_DECL(T, static inline ulib_unused, uh_key, uh_val)                                     \
+    P_UHASH_DEF_INLINE_SIMD(T, ulib_unused, uh_key, uh_val)                                        \
+    P_UHASH_IMPL_LOAD(T, UHASH_MAX_LOAD)                                                           \
+    P_UHASH_IMPL_INIT(T, static inline ulib_unused)                                                \
+    P_UHASH_IMPL_SIMD_CORE(T, static inline ulib_unused, uh_key, uh_val, hash_func, equal_func)    \
+    P_UHASH_IMPL_COPY(T, static inline ulib_unused, uh_val)                                        \
+    P_UHASH_IMPL_API(T, static inline ulib_unused, uh_key, uh_val, hash_func, equal_func, 0, 0)
+
+/**
+ * Defines a new static hash table type that stores the hash of each key.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
+ *
+ * @public @related UHash
+ */
+#define UHASH_INIT_CACHED_HASH(T, uh_key, uh_val, hash_func, equal_func)                           \
+    P_UHASH_DEF_TYPE_CACHED_HASH(T, uh_key, uh_val)                                                \
+    P_UHASH_DECL(T, static inline ulib_unused, uh_key, uh_val)                                     \
+    P_UHASH_DEF_INLINE(T, ulib_unused, uh_key, uh_val)                                             \
+    P_UHASH_IMPL_LOAD(T, UHASH_MAX_LOAD)                                                           \
+    P_UHASH_IMPL_INIT(T, static inline ulib_unused)                                                \
+    P_UHASH_IMPL_CACHED_HASH_CORE(T, static inline ulib_unused, uh_key, uh_val, hash_func,         \
+                                  equal_func)                                                      \
+    P_UHASH_IMPL_COPY(T, static inline ulib_unused, uh_val)                                        \
+    P_UHASH_IMPL_API(T, static inline ulib_unused, uh_key, uh_val, hash_func, equal_func, 0, 0)
+
+/**
+ * Defines a new static hash table type that is resized incrementally.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
+ *
+ * @public @related UHash
+ */
+#define UHASH_INIT_INCREMENTAL(T, uh_key, uh_val, hash_func, equal_func)                           \
+    P_UHASH_DEF_TYPE_INCREMENTAL(T, uh_key, uh_val)                                                \
+    P_UHASH_DECL(T, static inline ulib_unused, uh_key, uh_val)                                     \
+    P_UHASH_DEF_INLINE_INCREMENTAL(T, ulib_unused, uh_key, uh_val)                                 \
+    P_UHASH_IMPL_LOAD(T, UHASH_MAX_LOAD)                                                           \
+    P_UHASH_IMPL_INIT(T, static inline ulib_unused)                                                \
+    P_UHASH_IMPL_INCREMENTAL_CORE(T, static inline ulib_unused, uh_key, uh_val, hash_func,         \
+                                  equal_func)                                                      \
+    P_UHASH_IMPL_API(T, static inline ulib_unused, uh_key, uh_val, hash_func, equal_func, 0, 0)
+
+/**
+ * Defines a new static hash table type that uses Robin Hood hashing.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
+ * @param max_load [double] Maximum load factor, in the (0, 1) range (e.g. UHASH_MAX_LOAD).
+ *
+ * @public @related UHash
+ */
+#define UHASH_INIT_ROBIN_HOOD(T, uh_key, uh_val, hash_func, equal_func, max_load)                  \
+    P_UHASH_DEF_TYPE_ROBIN_HOOD(T, uh_key, uh_val)                                                 \
+    P_UHASH_DECL(T, static inline ulib_unused, uh_key, uh_val)                                     \
+    P_UHASH_DEF_INLINE_ROBIN_HOOD(T, ulib_unused, uh_key, uh_val)                                  \
+    P_UHASH_IMPL_LOAD(T, max_load)                                                                 \
+    P_UHASH_IMPL_INIT(T, static inline ulib_unused)                                                \
+    P_UHASH_IMPL_ROBIN_HOOD_CORE(T, static inline ulib_unused, uh_key, uh_val, hash_func,          \
+                                 equal_func)                                                       \
+    P_UHASH_IMPL_COPY(T, static inline ulib_unused, uh_val)                                        \
+    P_UHASH_IMPL_API(T, static inline ulib_unused, uh_key, uh_val, hash_func, equal_func, 0, 0)
+
+/**
+ * Defines a new static hash table type that stores each key next to its value.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
+ *
+ * @public @related UHash
+ */
+#define UHASH_INIT_INTERLEAVED(T, uh_key, uh_val, hash_func, equal_func)                           \
+    P_UHASH_DEF_TYPE_INTERLEAVED(T, uh_key, uh_val)                                                \
+    P_UHASH_DECL(T, static inline ulib_unused, uh_key, uh_val)                                     \
+    P_UHASH_DEF_INLINE_INTERLEAVED(T, ulib_unused, uh_key, uh_val)                                 \
+    P_UHASH_IMPL_LOAD(T, UHASH_MAX_LOAD)                                                           \
+    P_UHASH_IMPL_INIT(T, static inline ulib_unused)                                                \
+    P_UHASH_IMPL_INTERLEAVED_CORE(T, static inline ulib_unused, uh_key, uh_val, hash_func,         \
+                                  equal_func)                                                      \
+    P_UHASH_IMPL_API(T, static inline ulib_unused, uh_key, uh_val, hash_func, equal_func, 0, 0)
+
+/**
+ * Defines a new static concurrent hash table type.
+ *
+ * @param T [symbol] Hash table name.
+ * @param uh_key [symbol] Type of the keys.
+ * @param uh_val [symbol] Type of the values.
+ * @param hash_func [(uh_key) -> ulib_uint] Hash function or expression.
+ * @param equal_func [(uh_key, uh_key) -> bool] Equality function or expression.
+ *
+ * @public @related UHash
+ */
+#define UHASH_INIT_CONCURRENT(T, uh_key, uh_val, hash_func, equal_func)                            \
+    P_UHASH_DEF_TYPE_CONCURRENT(T, uh_key, uh_val)                                                 \
+    P_UHASH_DECL_CONCURRENT(T, static inline ulib_unused, uh_key, uh_val)                          \
+    P_UHASH_IMPL_CONCURRENT(T, static inline ulib_unused, uh_key, uh_val, hash_func, equal_func)
 
 /// @name Hash and equality functions
 
@@ -934,15 +3375,85 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
  */
 #define uhash_int64_hash(key) p_uhash_int64_hash(key)
 
+ULIB_BEGIN_DECLS
+
+/**
+ * Sets the seed of the byte hash function, used by uhash_str_hash and ustring_hash.
+ *
+ * @param seed Seed.
+ *
+ * @note The default seed is zero, which makes hashes reproducible across runs. Seeding with
+ *       a random value at startup protects hash tables from inputs crafted to collide.
+ *       Since it changes all hash values, it must happen before any hash table is populated.
+ *
+ * @public @related UHash
+ */
+ULIB_PUBLIC
+void uhash_set_seed(uint64_t seed);
+
+/**
+ * Returns the seed of the byte hash function.
+ *
+ * @return Seed.
+ *
+ * @public @related UHash
+ */
+ULIB_PUBLIC
+uint64_t uhash_get_seed(void);
+
+/**
+ * Hash function for arbitrary byte sequences.
+ *
+ * @param data Bytes to hash.
+ * @param len Number of bytes.
+ * @return The hash value.
+ *
+ * @note The function processes all the bytes, and is seeded via uhash_set_seed.
+ *
+ * @public @related UHash
+ */
+ULIB_PUBLIC
+ulib_uint uhash_bytes_hash(void const *data, size_t len);
+
+/**
+ * Hash function for arbitrary byte sequences, with an explicit seed.
+ *
+ * @param data Bytes to hash.
+ * @param len Number of bytes.
+ * @param seed Seed.
+ * @return The hash value.
+ *
+ * @public @related UHash
+ */
+ULIB_PUBLIC
+ulib_uint uhash_bytes_hash_seeded(void const *data, size_t len, uint64_t seed);
+
+ULIB_END_DECLS
+
 /**
  * Hash function for strings.
  *
  * @param key [char const *] Pointer to a NULL-terminated string.
  * @return [ulib_uint] The hash value.
  *
+ * @note Strings hash to the same value as UStrings with the same contents.
+ *
+ * @public @related UHash
+ */
+#define uhash_str_hash(key) uhash_bytes_hash(key, strlen(key))
+
+/**
+ * X31 hash function for strings.
+ *
+ * @param key [char const *] Pointer to a NULL-terminated string.
+ * @return [ulib_uint] The hash value.
+ *
+ * @note Faster than uhash_str_hash for very short strings, but of lower quality
+ *       and not seedable.
+ *
  * @public @related UHash
  */
-#define uhash_str_hash(key) p_uhash_x31_str_hash(key)
+#define uhash_x31_str_hash(key) p_uhash_x31_str_hash(key)
 
 /**
  * Hash function for pointers.
@@ -1086,6 +3597,22 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
  */
 #define uhash_get(T, h, k) uhash_get_##T(h, k)
 
+/**
+ * Retrieves the indices of the buckets associated with the specified keys.
+ *
+ * @param T [symbol] Hash table name.
+ * @param h [UHash(T)*] Hash table instance.
+ * @param k [uhash_T_key const*] Keys whose indices should be retrieved.
+ * @param n [ulib_uint] Number of keys.
+ * @param[out] idx [ulib_uint*] Indices of the keys, or UHASH_INDEX_MISSING if they are absent.
+ *
+ * @note Keys are hashed in batches of UHASH_BATCH_SIZE, and their buckets are prefetched
+ *       before being probed, so that cache misses overlap.
+ *
+ * @public @related UHash
+ */
+#define uhash_get_batch(T, h, k, n, idx) uhash_get_batch_##T(h, k, n, idx)
+
 /**
  * Deletes the bucket at the specified index.
  *
@@ -1107,7 +3634,7 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
  *
  * @public @related UHash
  */
-#define uhash_contains(T, h, k) (uhash_get_##T(h, k) != UHASH_INDEX_MISSING)
+#define uhash_contains(T, h, k) uhash_contains_##T(h, k)
 
 /**
  * Tests whether a bucket contains data.
@@ -1119,7 +3646,7 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
  *
  * @public @related UHash
  */
-#define uhash_exists(T, h, x) (!p_uhf_iseither(((UHash(T) *)(h))->_flags, (x)))
+#define uhash_exists(T, h, x) uhash_exists_##T(h, x)
 
 /**
  * Retrieves the key at the specified index.
@@ -1131,7 +3658,7 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
  *
  * @public @related UHash
  */
-#define uhash_key(T, h, x) (((UHash(T) *)(h))->_keys[x])
+#define uhash_key(T, h, x) (*p_uhash_key_ptr_##T(h, x))
 
 /**
  * Retrieves the value at the specified index.
@@ -1145,7 +3672,7 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
  *
  * @public @related UHash
  */
-#define uhash_value(T, h, x) (((UHash(T) *)(h))->_vals[x])
+#define uhash_value(T, h, x) (*p_uhash_val_ptr_##T(h, x))
 
 /**
  * Returns the maximum number of elements that can be held by the hash table.
@@ -1156,7 +3683,7 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
  *
  * @public @related UHash
  */
-#define uhash_size(T, h) (((UHash(T) *)(h))->_size)
+#define uhash_size(T, h) uhash_size_##T(h)
 
 /**
  * Returns the number of elements in the hash table.
@@ -1167,7 +3694,7 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
  *
  * @public @related UHash
  */
-#define uhash_count(T, h) (((UHash(T) *)(h))->_count)
+#define uhash_count(T, h) uhash_count_##T(h)
 
 /**
  * Resets the specified hash table without deallocating it.
@@ -1230,6 +3757,42 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
  */
 #define uhmap_set(T, h, k, v, e) uhmap_set_##T(h, k, v, e)
 
+/**
+ * Adds multiple key:value pairs to the map.
+ *
+ * @param T [symbol] Hash table name.
+ * @param h [UHash(T)*] Hash table instance.
+ * @param k [uhash_T_key const*] The keys.
+ * @param v [uhash_T_val const*] The values.
+ * @param n [ulib_uint] Number of key:value pairs.
+ * @param[out] r [uhash_ret*] Return code of each insertion (can be NULL).
+ * @return [uhash_ret] UHASH_INSERTED if at least one key was missing from the map,
+ *                     UHASH_PRESENT if all keys were present, UHASH_ERR on error.
+ *
+ * @note Keys are hashed in batches of UHASH_BATCH_SIZE, and their buckets are prefetched
+ *       before being probed, so that cache misses overlap.
+ *
+ * @public @related UHash
+ */
+#define uhmap_set_batch(T, h, k, v, n, r) uhmap_set_batch_##T(h, k, v, n, r)
+
+/**
+ * Replaces the contents of the map with key:value pairs from two arrays.
+ *
+ * @param T [symbol] Hash table name.
+ * @param h [UHash(T)*] Hash table instance.
+ * @param k [uhash_T_key const*] The keys.
+ * @param v [uhash_T_val const*] The values.
+ * @param n [ulib_uint] Number of key:value pairs.
+ * @return [uhash_ret] UHASH_OK on success, UHASH_ERR on error.
+ *
+ * @note The map is resized once to fit all pairs, so that no further growth happens
+ *       while inserting them. Duplicate keys are allowed, in which case the last value wins.
+ *
+ * @public @related UHash
+ */
+#define uhmap_from_arrays(T, h, k, v, n) uhmap_from_arrays_##T(h, k, v, n)
+
 /**
  * Adds a key:value pair to the map, only if the key is missing.
  *
@@ -1308,6 +3871,23 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
  */
 #define uhset_pi(T, hash_func, equal_func) uhset_pi_##T(hash_func, equal_func)
 
+/**
+ * Sets the compaction policy of a hash table with per-instance hash and equality functions.
+ *
+ * @param T [symbol] Hash table name.
+ * @param h [UHash(T)*] Hash table instance.
+ * @param min_load [ulib_float] Load factor below which the table shrinks (0 = never).
+ * @param max_deleted [ulib_float] Ratio of deleted buckets above which the table is rehashed
+ *                    (0 = never).
+ *
+ * @note Compaction happens in uhash_delete, uhmap_remove and uhset_remove, which then invalidate
+ *       bucket indices.
+ *
+ * @public @related UHash
+ */
+#define uhash_set_compaction(T, h, min_load, max_deleted)                                          \
+    uhash_set_compaction_##T(h, min_load, max_deleted)
+
 /**
  * Inserts an element in the set.
  *
@@ -1349,6 +3929,41 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
  */
 #define uhset_insert_all(T, h, a, n) uhset_insert_all_##T(h, a, n)
 
+/**
+ * Inserts multiple elements in the set.
+ *
+ * @param T [symbol] Hash table name.
+ * @param h [UHash(T)*] Hash table instance.
+ * @param k [uhash_T_key const*] Elements to insert.
+ * @param n [ulib_uint] Number of elements.
+ * @param[out] r [uhash_ret*] Return code of each insertion (can be NULL).
+ * @return [uhash_ret] UHASH_INSERTED if at least one element was missing from the set,
+ *                     UHASH_PRESENT if all elements were present, UHASH_ERR on error.
+ *
+ * @note Keys are hashed in batches of UHASH_BATCH_SIZE, and their buckets are prefetched
+ *       before being probed, so that cache misses overlap. Unlike uhset_insert_all,
+ *       this function does not reserve space for the elements in advance.
+ *
+ * @public @related UHash
+ */
+#define uhset_insert_batch(T, h, k, n, r) uhset_insert_batch_##T(h, k, n, r)
+
+/**
+ * Replaces the contents of the set with elements from an array.
+ *
+ * @param T [symbol] Hash table name.
+ * @param h [UHash(T)*] Hash table instance.
+ * @param a [uhash_T_key const*] Array of elements.
+ * @param n [ulib_uint] Size of the array.
+ * @return [uhash_ret] UHASH_OK on success, UHASH_ERR on error.
+ *
+ * @note The set is resized once to fit all elements, so that no further growth happens
+ *       while inserting them. Duplicate elements are allowed, and are only stored once.
+ *
+ * @public @related UHash
+ */
+#define uhset_from_array(T, h, a, n) uhset_from_array_##T(h, a, n)
+
 /**
  * Replaces an element in the set, only if it exists.
  *
@@ -1485,9 +4100,10 @@ static inline ulib_uint p_uhash_int64_hash(uint64_t key) {
 #define uhash_foreach(T, ht, enum_name)                                                            \
     for (UHash_Loop_##T p_h_##enum_name = { (ht), NULL, NULL, 0 },                                 \
          enum_name = { p_h_##enum_name.h, NULL, NULL, uhash_next(T, p_h_##enum_name.h, 0) };       \
-         enum_name.i != enum_name.h->_size &&                                                      \
-         (enum_name.key = enum_name.h->_keys + enum_name.i) &&                                     \
-         (!uhash_is_map(T, enum_name.h) || (enum_name.val = enum_name.h->_vals + enum_name.i));    \
+         enum_name.i != uhash_size(T, enum_name.h) &&                                              \
+         (enum_name.key = p_uhash_key_ptr_##T(enum_name.h, enum_name.i)) &&                        \
+         (!uhash_is_map(T, enum_name.h) ||                                                         \
+          (enum_name.val = p_uhash_val_ptr_##T(enum_name.h, enum_name.i)));                        \
          enum_name.i = uhash_next(T, enum_name.h, enum_name.i + 1))
 
 #endif // UHASH_H
@@ -13,22 +13,34 @@
 #define ULIB_H
 
 #include "ualloc.h"
+#include "uarena.h"
 #include "ubase.h"
+#include "ubench.h"
 #include "ubit.h"
+#include "ubitset.h"
+#include "ubtree.h"
+#include "uchecksum.h"
 #include "ucompat.h"
+#include "udeque.h"
 #include "uhash.h"
 #include "uhash_builtin.h"
 #include "ulib_ret.h"
 #include "umacros.h"
 #include "umeta.h"
+#include "uprof.h"
 #include "urand.h"
+#include "userial.h"
 #include "ustd.h"
 #include "ustrbuf.h"
 #include "ustream.h"
 #include "ustring.h"
 #include "ustring_raw.h"
+#include "ustrmatch.h"
+#include "ustrpool.h"
 #include "utest.h"
+#include "uthread.h"
 #include "utime.h"
+#include "utrace.h"
 #include "uvec.h"
 #include "uvec_builtin.h"
 #include "uversion.h"
@@ -0,0 +1,168 @@
+/**
+ * Sampling allocation profiler.
+ *
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UPROF_H
+#define UPROF_H
+
+#include "ustd.h"
+#include "ustream.h"
+
+ULIB_BEGIN_DECLS
+
+/**
+ * Maximum number of allocation sites tracked by the profiler.
+ *
+ * @note Can be overridden at compile time.
+ */
+#ifndef UPROF_MAX_SITES
+#define UPROF_MAX_SITES 1024
+#endif
+
+/**
+ * Default average number of bytes between samples.
+ *
+ * @note Can be overridden at compile time.
+ */
+#ifndef UPROF_SAMPLE_INTERVAL
+#define UPROF_SAMPLE_INTERVAL 524288
+#endif
+
+/// Allocation site, as recorded by the profiler.
+typedef struct UProfSite {
+
+    /// Source file.
+    char const *file;
+
+    /// Function.
+    char const *fn;
+
+    /// Line.
+    int line;
+
+    /// Number of sampled allocations.
+    size_t samples;
+
+    /// Estimated number of allocated bytes.
+    size_t bytes;
+
+    /// Estimated number of bytes that have not been deallocated yet.
+    size_t live_bytes;
+
+} UProfSite;
+
+/// Allocation profiler statistics.
+typedef struct UProfStats {
+
+    /// Number of sampled allocations.
+    size_t samples;
+
+    /// Estimated number of allocated bytes.
+    size_t bytes;
+
+    /// Estimated number of bytes that have not been deallocated yet.
+    size_t live_bytes;
+
+    /// Estimated peak of live bytes.
+    size_t peak_bytes;
+
+    /// Number of tracked allocation sites.
+    size_t sites;
+
+    /// Number of samples that could not be attributed to a site, as the site table was full.
+    size_t dropped;
+
+} UProfStats;
+
+/**
+ * Sampling allocation profiler.
+ *
+ * If the library is built with the `ULIB_PROFILE` option, every allocation made via
+ * `ulib_malloc`, `ulib_calloc` and `ulib_realloc` is accounted for by the profiler.
+ * Allocations are sampled about once every @ref UPROF_SAMPLE_INTERVAL bytes, and each
+ * sample is attributed to its call site with a weight equal to the sampling interval,
+ * so that the reported byte counts are unbiased estimates.
+ *
+ * Unsampled allocations only update a thread-local counter. Sampled allocations are
+ * recorded in a preallocated table of @ref UPROF_MAX_SITES sites, so that sampling
+ * never allocates memory and the profiler can be enabled under real load.
+ * Only retrieving and reporting sites allocates temporary buffers, bypassing the profiler.
+ *
+ * @note Allocations carry a small header, and must be deallocated via `ulib_free`.
+ * @note If the library is built without the `ULIB_PROFILE` option, the profiler
+ *       does not record anything.
+ *
+ * @defgroup prof Allocation profiler
+ * @{
+ */
+
+/**
+ * Sets the average number of bytes between samples.
+ *
+ * @param bytes Number of bytes, or zero to stop sampling.
+ *
+ * @note The calling thread uses the new interval immediately, other threads
+ *       after their next sample.
+ */
+ULIB_PUBLIC
+void uprof_set_sample_interval(size_t bytes);
+
+/**
+ * Returns the average number of bytes between samples.
+ *
+ * @return Number of bytes.
+ */
+ULIB_PUBLIC
+size_t uprof_sample_interval(void);
+
+/**
+ * Returns the profiler statistics.
+ *
+ * @return Statistics.
+ */
+ULIB_PUBLIC
+UProfStats uprof_stats(void);
+
+/**
+ * Retrieves the allocation sites with the most allocated bytes.
+ *
+ * @param[out] sites Sites, sorted by decreasing number of allocated bytes.
+ * @param count Maximum number of sites to retrieve.
+ * @return Number of retrieved sites.
+ *
+ * @note Sites are sorted in a temporary buffer, which is not accounted for by the profiler.
+ */
+ULIB_PUBLIC
+ulib_uint uprof_sites(UProfSite *sites, ulib_uint count);
+
+/**
+ * Discards all recorded samples and statistics.
+ *
+ * @note Deallocating memory sampled before the reset does not affect the statistics.
+ */
+ULIB_PUBLIC
+void uprof_reset(void);
+
+/**
+ * Writes a human-readable report of the profiler statistics into the stream.
+ *
+ * @param stream Output stream.
+ * @param count Maximum number of allocation sites to report.
+ * @param[out] written Number of bytes written.
+ * @return Return code.
+ */
+ULIB_PUBLIC
+ustream_ret uprof_report(UOStream *stream, ulib_uint count, size_t *written);
+
+/// @}
+
+ULIB_END_DECLS
+
+#endif // UPROF_H
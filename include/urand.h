@@ -19,12 +19,125 @@ ULIB_BEGIN_DECLS
 /**
  * Random number and string generators.
  *
+ * Numbers are generated by xoshiro256** generators, whose state is explicit and
+ * can be passed around via @ref URandGen. Functions without an explicit
+ * generator use a default generator that is private to the calling thread,
+ * so that they do not contend on shared state.
+ *
  * @defgroup rand Random number and string generators.
  * @{
  */
 
+/// Pseudorandom number generator.
+typedef struct URandGen {
+    /// @cond
+    uint64_t _state[4];
+    /// @endcond
+} URandGen;
+
 /**
- * Sets the seed of the random number generator.
+ * Initializes a new random number generator.
+ *
+ * @param seed Seed.
+ * @return Initialized generator.
+ *
+ * @public @memberof URandGen
+ */
+ULIB_PUBLIC
+URandGen urand_gen(uint64_t seed);
+
+/**
+ * Returns the default random number generator of the calling thread.
+ *
+ * @return Default generator.
+ *
+ * @note Default generators are seeded deterministically on first use,
+ *       with a different seed for each thread.
+ *
+ * @public @memberof URandGen
+ */
+ULIB_PUBLIC
+URandGen *urand_default_gen(void);
+
+/**
+ * Returns 64 random bits.
+ *
+ * @param gen Generator.
+ * @return Random bits.
+ *
+ * @public @memberof URandGen
+ */
+ULIB_INLINE
+uint64_t urand_gen_next(URandGen *gen) {
+    uint64_t *s = gen->_state;
+    uint64_t const x = s[1] * 5;
+    uint64_t const ret = ((x << 7) | (x >> 57)) * 9;
+    uint64_t const t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 45) | (s[3] >> 19);
+    return ret;
+}
+
+/**
+ * Returns a random integer in the specified range.
+ *
+ * @param gen Generator.
+ * @param start Start of the range.
+ * @param len Length of the range.
+ * @return Random integer.
+ *
+ * @note Integers are uniformly distributed, without the bias of modulo reduction.
+ *
+ * @public @memberof URandGen
+ */
+ULIB_PUBLIC
+ulib_int urand_gen_range(URandGen *gen, ulib_int start, ulib_uint len);
+
+/**
+ * Fills the buffer with random bytes.
+ *
+ * @param gen Generator.
+ * @param buf Buffer.
+ * @param size Size of the buffer.
+ *
+ * @public @memberof URandGen
+ */
+ULIB_PUBLIC
+void urand_gen_fill(URandGen *gen, void *buf, size_t size);
+
+/**
+ * Populates the buffer with a random string.
+ *
+ * @param gen Generator.
+ * @param len Length of the random string.
+ * @param buf Buffer to populate.
+ * @param charset Character set, or NULL (or an empty set) for the default
+ *                alphanumeric character set.
+ *
+ * @public @memberof URandGen
+ */
+ULIB_PUBLIC
+void urand_gen_str(URandGen *gen, ulib_uint len, char *buf, UString const *charset);
+
+/**
+ * Advances the generator by 2^128 steps.
+ *
+ * Generators obtained by repeatedly jumping from the same generator produce
+ * non-overlapping sequences, and can be handed out to parallel workers.
+ *
+ * @param gen Generator.
+ *
+ * @public @memberof URandGen
+ */
+ULIB_PUBLIC
+void urand_gen_jump(URandGen *gen);
+
+/**
+ * Sets the seed of the default random number generator of the calling thread.
  *
  * @param seed Seed.
  */
@@ -40,7 +153,7 @@ ULIB_PUBLIC
 UString const *urand_default_charset(void);
 
 /**
- * Returns a random integer.
+ * Returns a random non-negative integer.
  *
  * @return Random integer.
  */
@@ -57,11 +170,21 @@ ulib_int urand(void);
 ULIB_PUBLIC
 ulib_int urand_range(ulib_int start, ulib_uint len);
 
+/**
+ * Fills the buffer with random bytes.
+ *
+ * @param buf Buffer.
+ * @param size Size of the buffer.
+ */
+ULIB_PUBLIC
+void urand_fill(void *buf, size_t size);
+
 /**
  * Returns a random string.
  *
  * @param len Length of the string.
- * @param charset Character set, or NULL for the default alphanumeric character set.
+ * @param charset Character set, or NULL (or an empty set) for the default
+ *                alphanumeric character set.
  * @return Random string.
  */
 ULIB_PUBLIC
@@ -72,7 +195,8 @@ UString urand_string(ulib_uint len, UString const *charset);
  *
  * @param len Length of the random string.
  * @param buf Buffer to populate.
- * @param charset Character set, or NULL for the default alphanumeric character set.
+ * @param charset Character set, or NULL (or an empty set) for the default
+ *                alphanumeric character set.
  */
 ULIB_PUBLIC
 void urand_str(ulib_uint len, char *buf, UString const *charset);
@@ -0,0 +1,308 @@
+/**
+ * Binary serialization of vectors and hash tables.
+ *
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef USERIAL_H
+#define USERIAL_H
+
+#include "uhash.h"
+#include "ustd.h"
+#include "ustream.h"
+#include "uvec.h"
+
+ULIB_BEGIN_DECLS
+
+/**
+ * Binary serialization of vectors and hash tables.
+ *
+ * Serialized collections start with a header recording the size of their elements,
+ * the width of `ulib_uint` and the byte order of the machine that wrote them, followed by
+ * the raw storage of the collection. Reading a collection therefore amounts to a few bulk copies,
+ * which is especially fast if the input stream is memory-mapped (`uistream_from_path_mapped`).
+ *
+ * @note Serialization is only supported for plain data types, whose values do not reference
+ *       other memory. Data can only be read on machines with the same `ulib_uint` width and
+ *       byte order as the one that wrote it, otherwise reading fails with `USTREAM_ERR`.
+ *
+ * @defgroup serial Binary serialization
+ * @{
+ */
+
+/// @cond
+typedef struct P_USerialInfo {
+    unsigned kind;
+    size_t key_size;
+    size_t val_size;
+    uint64_t count;
+    uint64_t size;
+    uint64_t occupied;
+} P_USerialInfo;
+
+#define P_USERIAL_VEC 1U
+#define P_USERIAL_HASH 2U
+
+ULIB_PUBLIC
+ustream_ret p_userial_write_header(UOStream *stream, P_USerialInfo const *info);
+
+ULIB_PUBLIC
+ustream_ret p_userial_read_header(UIStream *stream, P_USerialInfo *info);
+
+ULIB_PUBLIC
+ustream_ret p_userial_read(UIStream *stream, void *buf, size_t size);
+
+#define P_UVEC_DECL_SERIAL(T, SCOPE)                                                               \
+    SCOPE ustream_ret uvec_write_##T(UVec_##T const *vec, UOStream *stream);                       \
+    SCOPE ustream_ret uvec_read_##T(UVec_##T *vec, UIStream *stream);
+
+#define P_UHASH_DECL_SERIAL(T, SCOPE)                                                              \
+    SCOPE ustream_ret uhash_write_##T(UHash_##T const *h, UOStream *stream);                       \
+    SCOPE ustream_ret uhash_read_##T(UHash_##T *h, UIStream *stream);
+/// @endcond
+
+/**
+ * Declares the serialization functions of a previously declared vector type.
+ *
+ * @param T [symbol] Vector type.
+ *
+ * @public @related UVec
+ */
+#define UVEC_DECL_SERIAL(T) P_UVEC_DECL_SERIAL(T, ulib_unused)
+
+/**
+ * Declares the serialization functions of a previously declared vector type,
+ * prepending a specifier to the generated declarations.
+ *
+ * @param T [symbol] Vector type.
+ * @param SPEC [specifier] Specifier.
+ *
+ * @public @related UVec
+ */
+#define UVEC_DECL_SERIAL_SPEC(T, SPEC) P_UVEC_DECL_SERIAL(T, SPEC ulib_unused)
+
+/**
+ * Implements the serialization functions of a previously declared vector type.
+ *
+ * @param T [symbol] Vector type.
+ *
+ * @public @related UVec
+ */
+#define UVEC_IMPL_SERIAL(T)                                                                        \
+    ulib_unused ustream_ret uvec_write_##T(UVec_##T const *vec, UOStream *stream) {                \
+        P_USerialInfo info = { P_USERIAL_VEC, sizeof(T), 0, vec->_count, 0, 0 };                   \
+        ustream_ret ret = p_userial_write_header(stream, &info);                                   \
+        if (ret) return ret;                                                                       \
+        return uostream_write(stream, uvec_data(T, vec), vec->_count * sizeof(T), NULL);           \
+    }                                                                                              \
+                                                                                                   \
+    ulib_unused ustream_ret uvec_read_##T(UVec_##T *vec, UIStream *stream) {                       \
+        P_USerialInfo info;                                                                        \
+        ustream_ret ret = p_userial_read_header(stream, &info);                                    \
+        if (ret) return ret;                                                                       \
+                                                                                                   \
+        if (info.kind != P_USERIAL_VEC || info.key_size != sizeof(T) ||                            \
+            info.count > ULIB_UINT_MAX) {                                                          \
+            return USTREAM_ERR;                                                                    \
+        }                                                                                          \
+                                                                                                   \
+        ulib_uint const count = (ulib_uint)info.count;                                             \
+        if (uvec_reserve_##T(vec, count)) return USTREAM_ERR_MEM;                                  \
+        ret = p_userial_read(stream, uvec_data(T, vec), count * sizeof(T));                        \
+        vec->_count = ret ? 0 : count;                                                             \
+        return ret;                                                                                \
+    }
+
+/**
+ * Declares the serialization functions of a previously declared hash table type.
+ *
+ * @param T [symbol] Hash table name.
+ *
+ * @note Only hash table types that store their keys and values in separate arrays
+ *       along with bucket flags are supported, that is those declared via
+ *       @ref UHASH_DECL and @ref UHASH_DECL_PI, and implemented via @ref UHASH_IMPL,
+ *       @ref UHASH_IMPL_PI, @ref UHASH_IMPL_LOAD or @ref UHASH_IMPL_COMPACT.
+ *
+ * @public @related UHash
+ */
+#define UHASH_DECL_SERIAL(T) P_UHASH_DECL_SERIAL(T, ulib_unused)
+
+/**
+ * Declares the serialization functions of a previously declared hash table type,
+ * prepending a specifier to the generated declarations.
+ *
+ * @param T [symbol] Hash table name.
+ * @param SPEC [specifier] Specifier.
+ *
+ * @public @related UHash
+ */
+#define UHASH_DECL_SERIAL_SPEC(T, SPEC) P_UHASH_DECL_SERIAL(T, SPEC ulib_unused)
+
+/**
+ * Implements the serialization functions of a previously declared hash table type.
+ *
+ * @param T [symbol] Hash table name.
+ *
+ * @note Hash tables are serialized along with their bucket layout, so that reading them
+ *       does not require rehashing. This requires the hash function to return the same values
+ *       when reading and writing the table: if it is seeded (e.g. via `uhash_set_seed`),
+ *       the same seed must be used.
+ *
+ * @public @related UHash
+ */
+#define UHASH_IMPL_SERIAL(T)                                                                       \
+    ulib_unused ustream_ret uhash_write_##T(UHash_##T const *h, UOStream *stream) {                \
+        bool const is_map = uhash_is_map_##T(h);                                                   \
+        P_USerialInfo info = { P_USERIAL_HASH, sizeof(uhash_##T##_key), 0,                         \
+                               h->_count,      h->_size,                h->_occupied };            \
+        if (is_map) info.val_size = sizeof(uhash_##T##_val);                                       \
+        ustream_ret ret = p_userial_write_header(stream, &info);                                   \
+        if (ret || !h->_size) return ret;                                                          \
+                                                                                                   \
+        UStreamIOVec iov[3];                                                                       \
+        iov[0].data = h->_flags;                                                                   \
+        iov[0].size = p_uhf_size(h->_size) * sizeof(*h->_flags);                                   \
+        iov[1].data = h->_keys;                                                                    \
+        iov[1].size = h->_size * sizeof(*h->_keys);                                                \
+        iov[2].data = h->_vals;                                                                    \
+        iov[2].size = is_map ? h->_size * sizeof(*h->_vals) : 0;                                   \
+        return uostream_writev(stream, iov, 3, NULL);                                              \
+    }                                                                                              \
+                                                                                                   \
+    ulib_unused ustream_ret uhash_read_##T(UHash_##T *h, UIStream *stream) {                       \
+        P_USerialInfo info;                                                                        \
+        ustream_ret ret = p_userial_read_header(stream, &info);                                    \
+        if (ret) return ret;                                                                       \
+                                                                                                   \
+        if (info.kind != P_USERIAL_HASH || info.key_size != sizeof(uhash_##T##_key) ||             \
+            (info.val_size && info.val_size != sizeof(uhash_##T##_val)) ||                         \
+            info.size > ULIB_UINT_MAX || info.count > info.size ||                                 \
+            (info.size & (info.size - 1)) || info.occupied > info.size + 1) {                      \
+            return USTREAM_ERR;                                                                    \
+        }                                                                                          \
+                                                                                                   \
+        ulib_uint const size = (ulib_uint)info.size;                                               \
+        uint32_t *flags = NULL;                                                                    \
+        uhash_##T##_key *keys = NULL;                                                              \
+        uhash_##T##_val *vals = NULL;                                                              \
+                                                                                                   \
+        if (size) {                                                                                \
+            size_t const flags_size = p_uhf_size(size) * sizeof(*flags);                           \
+            flags = (uint32_t *)ulib_malloc(flags_size);                                           \
+            keys = (uhash_##T##_key *)ulib_malloc(size * sizeof(*keys));                           \
+            if (info.val_size) vals = (uhash_##T##_val *)ulib_malloc(size * sizeof(*vals));        \
+                                                                                                   \
+            if (!(flags && keys && (vals || !info.val_size))) {                                    \
+                ret = USTREAM_ERR_MEM;                                                             \
+            } else if (!(ret = p_userial_read(stream, flags, flags_size)) &&                       \
+                       !(ret = p_userial_read(stream, keys, size * sizeof(*keys))) && vals) {      \
+                ret = p_userial_read(stream, vals, size * sizeof(*vals));                          \
+            }                                                                                      \
+                                                                                                   \
+            if (ret) {                                                                             \
+                ulib_free(flags);                                                                  \
+                ulib_free((void *)keys);                                                           \
+                ulib_free((void *)vals);                                                           \
+                return ret;                                                                        \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        ulib_free(h->_flags);                                                                      \
+        ulib_free((void *)h->_keys);                                                               \
+        ulib_free((void *)h->_vals);                                                               \
+        h->_flags = flags;                                                                         \
+        h->_keys = keys;                                                                           \
+        h->_vals = vals;                                                                           \
+        h->_size = size;                                                                           \
+        h->_count = (ulib_uint)info.count;                                                         \
+        h->_occupied = (ulib_uint)info.occupied;                                                   \
+        return USTREAM_OK;                                                                         \
+    }
+
+/**
+ * Declares and implements the serialization functions of a previously declared vector type.
+ *
+ * @param T [symbol] Vector type.
+ *
+ * @public @related UVec
+ */
+#define UVEC_INIT_SERIAL(T)                                                                        \
+    UVEC_DECL_SERIAL(T)                                                                            \
+    UVEC_IMPL_SERIAL(T)
+
+/**
+ * Declares and implements the serialization functions of a previously declared hash table type.
+ *
+ * @param T [symbol] Hash table name.
+ *
+ * @public @related UHash
+ */
+#define UHASH_INIT_SERIAL(T)                                                                       \
+    UHASH_DECL_SERIAL(T)                                                                           \
+    UHASH_IMPL_SERIAL(T)
+
+/**
+ * Writes the specified vector into the stream.
+ *
+ * @param T [symbol] Vector type.
+ * @param vec [UVec(T) const *] Vector.
+ * @param stream [UOStream *] Output stream.
+ * @return [ustream_ret] Return code.
+ *
+ * @public @related UVec
+ */
+#define uvec_write(T, vec, stream) P_ULIB_MACRO_CONCAT(uvec_write_, T)(vec, stream)
+
+/**
+ * Reads a vector from the stream, replacing the contents of the specified vector.
+ *
+ * @param T [symbol] Vector type.
+ * @param vec [UVec(T) *] Vector, which must have been initialized beforehand.
+ * @param stream [UIStream *] Input stream.
+ * @return [ustream_ret] Return code.
+ *
+ * @note The elements are read directly into the storage of the vector.
+ *       If reading the elements fails, the vector is left empty.
+ *
+ * @public @related UVec
+ */
+#define uvec_read(T, vec, stream) P_ULIB_MACRO_CONCAT(uvec_read_, T)(vec, stream)
+
+/**
+ * Writes the specified hash table into the stream.
+ *
+ * @param T [symbol] Hash table name.
+ * @param h [UHash(T) const *] Hash table.
+ * @param stream [UOStream *] Output stream.
+ * @return [ustream_ret] Return code.
+ *
+ * @public @related UHash
+ */
+#define uhash_write(T, h, stream) uhash_write_##T(h, stream)
+
+/**
+ * Reads a hash table from the stream, replacing the contents of the specified hash table.
+ *
+ * @param T [symbol] Hash table name.
+ * @param h [UHash(T) *] Hash table, which must have been initialized beforehand.
+ * @param stream [UIStream *] Input stream.
+ * @return [ustream_ret] Return code.
+ *
+ * @note The hash table becomes a map if the serialized table was a map,
+ *       and a set otherwise. Per-instance hash and equality functions are preserved.
+ *       If reading fails, the hash table is left untouched.
+ *
+ * @public @related UHash
+ */
+#define uhash_read(T, h, stream) uhash_read_##T(h, stream)
+
+/** @} */
+
+ULIB_END_DECLS
+
+#endif // USERIAL_H
@@ -99,6 +99,75 @@ uvec_ret ustrbuf_append_format(UStrBuf *buf, char const *format, ...);
 ULIB_PUBLIC
 uvec_ret ustrbuf_append_format_list(UStrBuf *buf, char const *format, va_list args);
 
+/**
+ * Appends the decimal representation of the specified unsigned integer to the string buffer.
+ *
+ * @param buf String buffer.
+ * @param value Value to append.
+ * @return UVEC_OK on success, otherwise UVEC_ERR.
+ *
+ * @public @memberof UStrBuf
+ */
+ULIB_PUBLIC
+uvec_ret ustrbuf_append_uint(UStrBuf *buf, ulib_uint value);
+
+/**
+ * Appends the decimal representation of the specified integer to the string buffer.
+ *
+ * @param buf String buffer.
+ * @param value Value to append.
+ * @return UVEC_OK on success, otherwise UVEC_ERR.
+ *
+ * @public @memberof UStrBuf
+ */
+ULIB_PUBLIC
+uvec_ret ustrbuf_append_int(UStrBuf *buf, ulib_int value);
+
+/**
+ * Appends the hexadecimal representation of the specified unsigned integer to the string buffer.
+ *
+ * @param buf String buffer.
+ * @param value Value to append.
+ * @param upper If true, digits above 9 are uppercase.
+ * @return UVEC_OK on success, otherwise UVEC_ERR.
+ *
+ * @note No prefix or leading zeros are added.
+ *
+ * @public @memberof UStrBuf
+ */
+ULIB_PUBLIC
+uvec_ret ustrbuf_append_hex(UStrBuf *buf, ulib_uint value, bool upper);
+
+/**
+ * Appends the shortest representation of the specified float that parses back
+ * to the same value.
+ *
+ * @param buf String buffer.
+ * @param value Value to append.
+ * @return UVEC_OK on success, otherwise UVEC_ERR.
+ *
+ * @note The value is formatted as if by the "%g" conversion specifier.
+ *
+ * @public @memberof UStrBuf
+ */
+ULIB_PUBLIC
+uvec_ret ustrbuf_append_float(UStrBuf *buf, ulib_float value);
+
+/**
+ * Appends the specified string to the string buffer, escaping it as a JSON string literal.
+ *
+ * @param buf String buffer.
+ * @param string String to append.
+ * @return UVEC_OK on success, otherwise UVEC_ERR.
+ *
+ * @note Quotes, backslashes and control characters are escaped, while other characters
+ *       are copied verbatim. Surrounding quotes are not added.
+ *
+ * @public @memberof UStrBuf
+ */
+ULIB_PUBLIC
+uvec_ret ustrbuf_append_escaped(UStrBuf *buf, UString string);
+
 /**
  * Converts the string buffer into a UString and deinitializes the buffer.
  *
@@ -91,6 +91,29 @@ typedef struct UIStream {
      */
     ustream_ret (*free)(void *ctx);
 
+    /**
+     * Pointer to a function that exposes the buffered bytes of the stream without copying them,
+     * fetching more if none are buffered.
+     *
+     * @param ctx Stream context.
+     * @param[out] buf Buffered bytes.
+     * @param[out] available Number of buffered bytes, zero if the stream has been exhausted.
+     * @return Return code.
+     *
+     * @note Can be NULL if the stream does not buffer its contents, in which case `consume`
+     *       must also be NULL.
+     */
+    ustream_ret (*peek)(void *ctx, void const **buf, size_t *available);
+
+    /**
+     * Pointer to a function that marks `count` bytes exposed by `peek` as read.
+     *
+     * @param ctx Stream context.
+     * @param count Number of bytes, not greater than those exposed by the last `peek` call.
+     * @return Return code.
+     */
+    ustream_ret (*consume)(void *ctx, size_t count);
+
 } UIStream;
 
 /**
@@ -107,7 +130,7 @@ typedef struct UIStream {
 ULIB_INLINE
 UIStream uistream(void *ctx, ustream_ret (*read_func)(void *, void *, size_t, size_t *),
                   ustream_ret (*reset_func)(void *), ustream_ret (*free_func)(void *)) {
-    UIStream s = { USTREAM_OK, 0, ctx, read_func, reset_func, free_func };
+    UIStream s = { USTREAM_OK, 0, ctx, read_func, reset_func, free_func, NULL, NULL };
     return s;
 }
 
@@ -147,6 +170,69 @@ ustream_ret uistream_reset(UIStream *stream);
 ULIB_PUBLIC
 ustream_ret uistream_read(UIStream *stream, void *buf, size_t count, size_t *read);
 
+/**
+ * Exposes the next bytes of the stream without copying them, and without marking them as read.
+ *
+ * @param stream Input stream.
+ * @param[out] buf Next bytes.
+ * @param[out] available Number of exposed bytes, zero if the stream has been exhausted.
+ * @return Return code.
+ *
+ * @note If the stream does not support peeking, it is transparently wrapped
+ *       in a buffered stream (see `uistream_buffered`) the first time this function is called.
+ *
+ * @public @memberof UIStream
+ */
+ULIB_PUBLIC
+ustream_ret uistream_peek(UIStream *stream, void const **buf, size_t *available);
+
+/**
+ * Marks the specified number of bytes exposed by `uistream_peek` as read.
+ *
+ * @param stream Input stream.
+ * @param count Number of bytes, not greater than those exposed by the last `uistream_peek` call.
+ * @return Return code.
+ *
+ * @public @memberof UIStream
+ */
+ULIB_PUBLIC
+ustream_ret uistream_consume(UIStream *stream, size_t count);
+
+/**
+ * Reads the next record delimited by the specified character.
+ *
+ * @param stream Input stream.
+ * @param delim Delimiter.
+ * @param buf Buffer holding records that span multiple stream chunks.
+ * @param[out] record Record, without its delimiter, or `ustring_null` at the end of the stream.
+ * @return Return code.
+ *
+ * @note The record is wrapped via `ustring_wrap`, so it is not null-terminated unless short.
+ *       Records that are contiguous in the stream's own buffer are returned without copying
+ *       them, and remain valid until the next operation on the stream. Otherwise, they are
+ *       copied into `buf`, and remain valid until the buffer is modified.
+ * @note If the stream does not support peeking, it is buffered on demand (see `uistream_peek`).
+ *
+ * @public @memberof UIStream
+ */
+ULIB_PUBLIC
+ustream_ret uistream_read_until(UIStream *stream, char delim, UStrBuf *buf, UString *record);
+
+/**
+ * Reads the next line, terminated by either `\n` or `\r\n`.
+ *
+ * @param stream Input stream.
+ * @param buf Buffer holding lines that span multiple stream chunks.
+ * @param[out] line Line, without its terminator, or `ustring_null` at the end of the stream.
+ * @return Return code.
+ *
+ * @note See `uistream_read_until` for the lifetime of the returned line.
+ *
+ * @public @memberof UIStream
+ */
+ULIB_PUBLIC
+ustream_ret uistream_read_line(UIStream *stream, UStrBuf *buf, UString *line);
+
 /**
  * Returns a stream that reads from the standard input.
  *
@@ -169,6 +255,24 @@ UIStream *uistream_std(void);
 ULIB_PUBLIC
 ustream_ret uistream_from_path(UIStream *stream, char const *path);
 
+/**
+ * Initializes a stream that reads from the file at the specified path,
+ * mapping it into memory rather than copying its contents.
+ *
+ * @param stream Input stream.
+ * @param path Path to the file to read from.
+ * @return Return code.
+ *
+ * @note The mapped contents can be accessed directly via `uistream_data`. On platforms
+ *       that do not support memory mapping, or if the file cannot be mapped,
+ *       this is equivalent to `uistream_from_path`.
+ * @warning The file must not be truncated while the stream is in use.
+ *
+ * @public @memberof UIStream
+ */
+ULIB_PUBLIC
+ustream_ret uistream_from_path_mapped(UIStream *stream, char const *path);
+
 /**
  * Initializes a stream that reads from the specified file.
  *
@@ -230,6 +334,51 @@ ustream_ret uistream_from_string(UIStream *stream, char const *string);
 ULIB_PUBLIC
 ustream_ret uistream_from_ustring(UIStream *stream, UString const *string);
 
+/**
+ * Returns the contents of a memory-backed stream, allowing direct access without copies.
+ *
+ * @param stream Input stream.
+ * @param[out] size Size of the contents.
+ * @return Contents of the stream, or NULL if the stream is not backed by memory.
+ *
+ * @note Streams initialized via `uistream_from_buf`, `uistream_from_strbuf`,
+ *       `uistream_from_string`, `uistream_from_ustring` and `uistream_from_path_mapped`
+ *       (if the file could be mapped) are backed by memory. The returned contents
+ *       do not depend on how much of the stream has been read.
+ *
+ * @public @memberof UIStream
+ */
+ULIB_PUBLIC
+void const *uistream_data(UIStream const *stream, size_t *size);
+
+/**
+ * Initializes a stream that reads from the specified stream through a buffer,
+ * so that small reads are served from data that has already been fetched.
+ *
+ * @param stream Input stream.
+ * @param src Stream to read from.
+ * @param cap Buffer size, or zero to use `BUFSIZ`.
+ * @return Return code.
+ *
+ * @note Reads that are at least as large as the buffer bypass it.
+ *       Calling `uistream_deinit` also deinitializes the source stream.
+ *
+ * @public @memberof UIStream
+ */
+ULIB_PUBLIC
+ustream_ret uistream_buffered(UIStream *stream, UIStream *src, size_t cap);
+
+/// A buffer to be written as part of a vectored write.
+typedef struct UStreamIOVec {
+
+    /// Buffer to read from.
+    void const *data;
+
+    /// Number of bytes to write.
+    size_t size;
+
+} UStreamIOVec;
+
 /// Models an output stream.
 typedef struct UOStream {
 
@@ -287,6 +436,44 @@ typedef struct UOStream {
      */
     ustream_ret (*free)(void *ctx);
 
+    /**
+     * Pointer to a function that writes the specified buffers into the stream, in order.
+     *
+     * @param ctx Stream context.
+     * @param iov Buffers to write.
+     * @param count Number of buffers.
+     * @param[out] written Number of bytes written.
+     * @return Return code.
+     *
+     * @note Can be NULL, in which case the stream will fallback to `write`.
+     */
+    ustream_ret (*writev)(void *ctx, UStreamIOVec const *iov, size_t count, size_t *written);
+
+    /**
+     * Pointer to a function that exposes writable space in the stream,
+     * so that data can be produced directly into it.
+     *
+     * @param ctx Stream context.
+     * @param size Minimum number of bytes.
+     * @param[out] buf Writable space.
+     * @param[out] available Number of bytes that can be written, at least `size`.
+     * @return Return code.
+     *
+     * @note Can be NULL, in which case formatted strings are written through `write`.
+     *       Must be provided along with `commit`.
+     */
+    ustream_ret (*reserve)(void *ctx, size_t size, void **buf, size_t *available);
+
+    /**
+     * Pointer to a function that marks bytes produced into the space exposed by `reserve`
+     * as written.
+     *
+     * @param ctx Stream context.
+     * @param count Number of bytes, at most the available space.
+     * @return Return code.
+     */
+    ustream_ret (*commit)(void *ctx, size_t count);
+
 } UOStream;
 
 /**
@@ -305,7 +492,8 @@ ULIB_INLINE
 UOStream uostream(void *ctx, ustream_ret (*write_func)(void *, void const *, size_t, size_t *),
                   ustream_ret (*writef_func)(void *, size_t *, char const *, va_list),
                   ustream_ret (*flush_func)(void *), ustream_ret (*free_func)(void *)) {
-    UOStream s = { USTREAM_OK, 0, ctx, write_func, writef_func, flush_func, free_func };
+    UOStream s = { USTREAM_OK, 0, ctx, write_func, writef_func, flush_func, free_func, NULL,
+                   NULL, NULL };
     return s;
 }
 
@@ -358,6 +546,56 @@ ustream_ret uostream_flush(UOStream *stream);
 ULIB_PUBLIC
 ustream_ret uostream_write(UOStream *stream, void const *buf, size_t count, size_t *written);
 
+/**
+ * Writes the specified buffers into the stream, in order.
+ *
+ * @param stream Output stream.
+ * @param iov Buffers to write.
+ * @param count Number of buffers.
+ * @param[out] written Number of bytes written.
+ * @return Return code.
+ *
+ * @note This avoids concatenating the buffers beforehand, e.g. in order to write
+ *       a header and a body as a single operation.
+ *
+ * @public @memberof UOStream
+ */
+ULIB_PUBLIC
+ustream_ret uostream_writev(UOStream *stream, UStreamIOVec const *iov, size_t count,
+                            size_t *written);
+
+/**
+ * Exposes writable space in the stream, so that data can be produced directly into it.
+ *
+ * @param stream Output stream.
+ * @param size Minimum number of bytes.
+ * @param[out] buf Writable space.
+ * @param[out] available Number of bytes that can be written, at least `size`.
+ * @return Return code.
+ *
+ * @note The space is only valid until the next operation on the stream, and data produced
+ *       into it is not written until `uostream_commit` is called.
+ * @note Returns @ref USTREAM_ERR if the stream does not support reserving space
+ *       (`reserve` is NULL), and @ref USTREAM_ERR_BOUNDS if it cannot reserve
+ *       the requested amount, in both cases without altering the state of the stream.
+ *
+ * @public @memberof UOStream
+ */
+ULIB_PUBLIC
+ustream_ret uostream_reserve(UOStream *stream, size_t size, void **buf, size_t *available);
+
+/**
+ * Marks bytes produced into the space exposed by `uostream_reserve` as written.
+ *
+ * @param stream Output stream.
+ * @param count Number of bytes, at most the available space.
+ * @return Return code.
+ *
+ * @public @memberof UOStream
+ */
+ULIB_PUBLIC
+ustream_ret uostream_commit(UOStream *stream, size_t count);
+
 /**
  * Writes a formatted string into the stream.
  *
@@ -538,6 +776,8 @@ ustream_ret uostream_to_strbuf(UOStream *stream, UStrBuf *buf);
  *         substream if that is important for your use case.
  *       - The reported written bytes are the maximum bytes written by any of the underlying
  *         substreams.
+ *       - Formatted strings are formatted only once, and the resulting bytes
+ *         are written to each substream.
  *       - Calling `uostream_deinit` deinitializes all substreams.
  *
  * @public @memberof UOStream
@@ -560,6 +800,224 @@ ustream_ret uostream_to_multi(UOStream *stream);
 ULIB_PUBLIC
 ustream_ret uostream_add_substream(UOStream *stream, UOStream const *other);
 
+/**
+ * Initializes a stream that writes to the specified stream through a buffer,
+ * coalescing small writes.
+ *
+ * @param stream Output stream.
+ * @param dst Stream to write to.
+ * @param cap Buffer size, or zero to use `BUFSIZ`.
+ * @return Return code.
+ *
+ * @note Buffered data is written to the destination stream when the buffer is full,
+ *       and when calling `uostream_flush` or `uostream_deinit`. Writes that are
+ *       at least as large as the buffer bypass it. Calling `uostream_deinit`
+ *       also deinitializes the destination stream.
+ *
+ * @public @memberof UOStream
+ */
+ULIB_PUBLIC
+ustream_ret uostream_buffered(UOStream *stream, UOStream *dst, size_t cap);
+
+/// Behavior of asynchronous output streams when their buffer is full.
+typedef enum uostream_async_policy {
+
+    /// Writers wait until the background thread makes room in the buffer.
+    USTREAM_ASYNC_BLOCK = 0,
+
+    /// Writes that do not fit in the buffer are discarded and counted.
+    USTREAM_ASYNC_DROP
+
+} uostream_async_policy;
+
+/**
+ * Initializes a stream that writes to the specified stream on a background thread.
+ *
+ * Writes are appended to one of two buffers, formatting directly into it in the case of
+ * `uostream_writef`, while a dedicated thread writes the other buffer to the destination stream.
+ * Callers therefore only wait for the destination stream if the buffer fills up
+ * and the policy is @ref USTREAM_ASYNC_BLOCK.
+ *
+ * @param stream Output stream.
+ * @param dst Stream to write to.
+ * @param buf_size Size of each buffer, or zero to use `BUFSIZ`.
+ * @param policy Behavior when the buffer is full.
+ * @return Return code.
+ *
+ * @note Each write that fits in the buffer reaches the destination stream as a whole.
+ *       Under @ref USTREAM_ASYNC_DROP, writes larger than the available space are discarded
+ *       entirely, while under @ref USTREAM_ASYNC_BLOCK writes larger than the buffer
+ *       are split over multiple buffers.
+ * @note Calling `uostream_flush` waits until all the buffered data has been written,
+ *       then flushes the destination stream. Calling `uostream_deinit` drains the buffers,
+ *       stops the background thread and deinitializes the destination stream.
+ * @note Errors reported by the destination stream are returned by the subsequent calls.
+ * @note The buffers are shared by copies of the stream object, which can be written to
+ *       from different threads. The `state` and `written_bytes` members are not synchronized,
+ *       so each thread should write through its own copy. Only one copy must be deinitialized,
+ *       after all the other threads are done writing.
+ * @note If threads are disabled (`ULIB_NO_THREADS` is defined), this is equivalent
+ *       to `uostream_buffered`, and data is written synchronously.
+ *
+ * @public @memberof UOStream
+ */
+ULIB_PUBLIC
+ustream_ret
+uostream_to_async(UOStream *stream, UOStream *dst, size_t buf_size, uostream_async_policy policy);
+
+/**
+ * Returns the number of writes that have been discarded by an asynchronous stream
+ * because its buffer was full.
+ *
+ * @param stream Output stream.
+ * @return Number of discarded writes, or zero if the stream is not asynchronous.
+ *
+ * @public @memberof UOStream
+ */
+ULIB_PUBLIC
+size_t uostream_async_dropped(UOStream *stream);
+
+#if !defined(ULIB_NO_COMPRESSION)
+
+/**
+ * Initializes a stream that compresses the data it writes to the specified stream.
+ *
+ * Data is buffered in blocks of the specified size, each of which is compressed independently
+ * in the LZ4 block format and written with a small header. Blocks that do not compress
+ * are stored as is.
+ *
+ * @param stream Output stream.
+ * @param dst Stream to write to.
+ * @param block_size Block size, or zero to use 64 KiB. Capped to 64 MiB.
+ * @return Return code.
+ *
+ * @note Calling `uostream_flush` compresses and writes the partial block, if any,
+ *       then flushes the destination stream. Calling `uostream_deinit` also writes
+ *       the end of the compressed data and deinitializes the destination stream.
+ * @note Not available if compression is disabled (`ULIB_NO_COMPRESSION` is defined).
+ *
+ * @public @memberof UOStream
+ */
+ULIB_PUBLIC
+ustream_ret uostream_compress(UOStream *stream, UOStream *dst, size_t block_size);
+
+/**
+ * Initializes a stream that decompresses data written by an @ref uostream_compress stream,
+ * reading it from the specified stream.
+ *
+ * @param stream Input stream.
+ * @param src Stream to read from.
+ * @return Return code.
+ *
+ * @note The stream supports peeking, exposing the decompressed block. If the source stream
+ *       supports peeking, blocks are decompressed straight from its memory.
+ *       Resetting the stream resets the source stream.
+ *       Calling `uistream_deinit` also deinitializes the source stream.
+ * @note Not available if compression is disabled (`ULIB_NO_COMPRESSION` is defined).
+ *
+ * @public @memberof UIStream
+ */
+ULIB_PUBLIC
+ustream_ret uistream_decompress(UIStream *stream, UIStream *src);
+
+#endif
+
+/// Number of buckets of the histograms of stream statistics.
+#define USTREAM_STATS_BUCKETS 32
+
+/**
+ * Statistics about the calls made to a stream.
+ *
+ * Histogram bucket zero counts zero values, while bucket `i > 0` counts values in
+ * the `[2^(i - 1), 2^i)` range. The last bucket also counts larger values.
+ *
+ * @note Statistics are updated without synchronization. A snapshot can be taken
+ *       by copying the object from the thread that uses the stream.
+ */
+typedef struct UStreamStats {
+
+    /// Number of calls to the stream callbacks, including flushes and resets.
+    uint64_t calls;
+
+    /// Number of bytes read or written.
+    uint64_t bytes;
+
+    /// Time spent inside the callbacks.
+    utime_ns time;
+
+    /// Longest time spent inside a single callback.
+    utime_ns max_time;
+
+    /// Number of failed calls, indexed by return code.
+    uint64_t errors[USTREAM_ERR + 1];
+
+    /// Histogram of the number of bytes transferred by each read or write.
+    uint64_t size_hist[USTREAM_STATS_BUCKETS];
+
+    /// Histogram of the time spent inside each callback, in nanoseconds.
+    uint64_t time_hist[USTREAM_STATS_BUCKETS];
+
+} UStreamStats;
+
+/**
+ * Initializes a stream that reads from the specified stream, collecting statistics
+ * about its calls.
+ *
+ * @param stream Input stream.
+ * @param src Stream to read from.
+ * @param stats Statistics to update, which must have been zero initialized.
+ * @return Return code.
+ *
+ * @note Peeking is forwarded to the source stream, and consumed bytes count as read.
+ *       Calling `uistream_deinit` also deinitializes the source stream.
+ *
+ * @public @memberof UIStream
+ */
+ULIB_PUBLIC
+ustream_ret uistream_stats(UIStream *stream, UIStream *src, UStreamStats *stats);
+
+/**
+ * Initializes a stream that writes to the specified stream, collecting statistics
+ * about its calls.
+ *
+ * @param stream Output stream.
+ * @param dst Stream to write to.
+ * @param stats Statistics to update, which must have been zero initialized.
+ * @return Return code.
+ *
+ * @note Unlike `written_bytes`, statistics are not reset by `uostream_flush`.
+ *       Calling `uostream_deinit` also deinitializes the destination stream.
+ *
+ * @public @memberof UOStream
+ */
+ULIB_PUBLIC
+ustream_ret uostream_stats(UOStream *stream, UOStream *dst, UStreamStats *stats);
+
+/**
+ * Estimates the specified percentile of the time spent inside the callbacks of a stream.
+ *
+ * @param stats Statistics.
+ * @param percentile Percentile, between 0 and 100.
+ * @return Upper bound of the histogram bucket the percentile falls in.
+ *
+ * @public @memberof UStreamStats
+ */
+ULIB_PUBLIC
+utime_ns ustream_stats_time_percentile(UStreamStats const *stats, double percentile);
+
+/**
+ * Writes a human-readable report of the specified statistics into the stream.
+ *
+ * @param stream Output stream.
+ * @param stats Statistics.
+ * @param[out] written Number of bytes written.
+ * @return Return code.
+ *
+ * @public @memberof UOStream
+ */
+ULIB_PUBLIC
+ustream_ret uostream_write_stats(UOStream *stream, UStreamStats const *stats, size_t *written);
+
 ULIB_END_DECLS
 
 #endif // USTREAM_H
@@ -17,15 +17,39 @@
 
 ULIB_BEGIN_DECLS
 
+/**
+ * Minimum size of the buffer of small strings, which are stored inline, in bytes
+ * (including the null terminator).
+ *
+ * By default, small strings use the space that large strings need for their buffer pointer.
+ * Defining this macro (e.g. via the `ULIB_STRING_SMALL_SIZE` CMake option) enlarges UString
+ * so that longer strings can be stored without allocating, at the cost of larger copies.
+ *
+ * @note This must be defined consistently for the library and its clients.
+ *
+ * @def ULIB_STRING_SMALL_SIZE
+ */
+
 /// @cond
 struct p_ustring_sizing {
     ulib_uint s;
     char const *d;
 };
+
+#if defined(ULIB_STRING_SMALL_SIZE)
+// Rounded up so that the inline buffer also covers the trailing padding of UString.
+#define P_USTRING_SMALL_SIZE                                                                       \
+    (ulib_max(sizeof(struct p_ustring_sizing),                                                     \
+              (sizeof(ulib_uint) + (ULIB_STRING_SMALL_SIZE) + sizeof(char *) - 1) /                \
+                  sizeof(char *) * sizeof(char *)) -                                               \
+     sizeof(ulib_uint))
+#else
 #define P_USTRING_SMALL_SIZE (sizeof(struct p_ustring_sizing) - sizeof(ulib_uint))
+#endif
 #define p_ustring_size_is_small(s) ((s) <= P_USTRING_SMALL_SIZE)
 #define p_ustring_length_is_small(l) ((l) < P_USTRING_SMALL_SIZE)
 #define p_ustring_is_small(string) p_ustring_size_is_small((string)._size)
+#define P_USTRING_SHARED_FLAG ((ulib_uint)(ULIB_UINT_MAX ^ (ULIB_UINT_MAX >> 1)))
 /// @endcond
 
 /**
@@ -49,6 +73,16 @@ typedef struct UString {
     /// @endcond
 } UString;
 
+/**
+ * Maximum length of a string, excluding the null terminator.
+ *
+ * @note The top bit of the string size marks shared strings (see ustring_copy_shared),
+ *       so string constructors return ustring_null for longer strings.
+ *
+ * @public @related UString
+ */
+#define USTRING_MAX_LENGTH ((ulib_uint)(P_USTRING_SHARED_FLAG - 2U))
+
 /**
  * String with a NULL buffer.
  *
@@ -75,7 +109,7 @@ extern UString const ustring_empty;
  */
 ULIB_INLINE
 ulib_uint ustring_size(UString string) {
-    return string._size;
+    return string._size & ~P_USTRING_SHARED_FLAG;
 }
 
 /**
@@ -88,7 +122,8 @@ ulib_uint ustring_size(UString string) {
  */
 ULIB_INLINE
 ulib_uint ustring_length(UString string) {
-    return string._size ? (string)._size - 1 : 0;
+    ulib_uint const size = ustring_size(string);
+    return size ? size - 1 : 0;
 }
 
 /**
@@ -140,7 +175,10 @@ UString ustring_copy(char const *buf, size_t length);
  * @param length Length of the string (excluding the null terminator).
  * @return New string.
  *
- * @note The buffer must be null-terminated.
+ * @note The buffer only needs to be null-terminated if the data of the string is used
+ *       as a C string. Functions taking a UString only read its first `length` characters,
+ *       including the `ustring_to_*` conversions, so they support views into larger buffers.
+ *       Short strings are copied into the UString itself, and are always null-terminated.
  * @note If the buffer has been dynamically allocated, you are responsible for its deallocation.
  * @note You must not call `ustring_deinit` on a string initialized with this function.
  *
@@ -242,11 +280,61 @@ UString ustring_wrap_buf(char const *buf) {
  * @param string String to duplicate.
  * @return Duplicated string.
  *
+ * @note Shared strings are not copied: their reference count is incremented instead.
+ *
  * @public @memberof UString
  */
 ULIB_PUBLIC
 UString ustring_dup(UString string);
 
+/**
+ * Initializes a new shared string by copying the specified buffer.
+ *
+ * Large shared strings are backed by an immutable, reference-counted buffer,
+ * so that ustring_dup does not copy them, and ustring_deinit only releases
+ * the buffer once all the duplicates have been deinitialized.
+ *
+ * @param buf String buffer.
+ * @param length Length of the string (excluding the null terminator).
+ * @return New string.
+ *
+ * @note Small strings are stored inline, and are never shared.
+ * @note Reference counts are updated atomically, unless threads are disabled
+ *       (`ULIB_NO_THREADS` is defined).
+ * @note You must not modify the buffer of a shared string.
+ *
+ * @public @memberof UString
+ */
+ULIB_PUBLIC
+UString ustring_copy_shared(char const *buf, size_t length);
+
+/**
+ * Turns the specified string into a shared string, as described in ustring_copy_shared.
+ *
+ * @param string String, which must not be a wrapped string.
+ * @return Return code.
+ *
+ * @note The buffer of the string is reallocated rather than copied, and the string
+ *       is left unchanged on failure.
+ *
+ * @public @memberof UString
+ */
+ULIB_PUBLIC
+ulib_ret ustring_make_shared(UString *string);
+
+/**
+ * Checks whether the string is backed by a shared, reference-counted buffer.
+ *
+ * @param string String.
+ * @return True if the string is shared, false otherwise.
+ *
+ * @public @memberof UString
+ */
+ULIB_INLINE
+bool ustring_is_shared(UString string) {
+    return string._size & P_USTRING_SHARED_FLAG;
+}
+
 /**
  * Initializes a new string with the specified format.
  *
@@ -296,6 +384,24 @@ UString ustring_concat(UString const *strings, ulib_uint count);
 ULIB_PUBLIC
 UString ustring_join(UString const *strings, ulib_uint count, UString sep);
 
+/**
+ * Joins the specified strings with a separator, adding a prefix and a suffix.
+ *
+ * @param strings Strings to join.
+ * @param count Number of strings.
+ * @param sep Separator.
+ * @param prefix Prefix.
+ * @param suffix Suffix.
+ * @return Strings joined with the specified separator, between prefix and suffix.
+ *
+ * @note The length of the result is computed upfront, so that it is allocated only once.
+ *
+ * @public @memberof UString
+ */
+ULIB_PUBLIC
+UString ustring_join_affixed(UString const *strings, ulib_uint count, UString sep, UString prefix,
+                             UString suffix);
+
 /**
  * Returns a new string obtained by repeating the specified string.
  *
@@ -334,6 +440,34 @@ bool ustring_is_lower(UString string) {
     return ulib_str_is_lower(ustring_data(string), ustring_length(string));
 }
 
+/**
+ * Checks whether the string is valid UTF-8.
+ *
+ * @param string String.
+ * @return True if the string is valid UTF-8, false otherwise.
+ *
+ * @public @memberof UString
+ */
+ULIB_INLINE
+bool ustring_is_valid_utf8(UString string) {
+    return ulib_str_is_valid_utf8(ustring_data(string), ustring_length(string));
+}
+
+/**
+ * Returns the number of code points in the UTF-8 string.
+ *
+ * @param string String.
+ * @return Number of code points.
+ *
+ * @note The string is assumed to be valid UTF-8, see ulib_str_utf8_length.
+ *
+ * @public @memberof UString
+ */
+ULIB_INLINE
+ulib_uint ustring_utf8_length(UString string) {
+    return (ulib_uint)ulib_str_utf8_length(ustring_data(string), ustring_length(string));
+}
+
 /**
  * Converts the given string to uppercase.
  *
@@ -444,6 +578,21 @@ bool ustring_ends_with(UString string, UString suffix);
 ULIB_PUBLIC
 bool ustring_equals(UString lhs, UString rhs);
 
+/**
+ * Checks whether two strings are equal, ignoring the case of ASCII letters.
+ *
+ * @param lhs First string.
+ * @param rhs Second string.
+ * @return True if the two strings are equal, false otherwise.
+ *
+ * @note Together with ustring_hash_ci, this function can be used to declare
+ *       case-insensitive hash tables.
+ *
+ * @public @memberof UString
+ */
+ULIB_PUBLIC
+bool ustring_equals_ci(UString lhs, UString rhs);
+
 /**
  * Checks whether lhs precedes rhs in lexicographic order.
  *
@@ -474,11 +623,26 @@ int ustring_compare(UString lhs, UString rhs);
  * @param string String.
  * @return Hash.
  *
+ * @note The hash covers the whole string, and is seeded via uhash_set_seed.
+ *
  * @public @memberof UString
  */
 ULIB_PUBLIC
 ulib_uint ustring_hash(UString string);
 
+/**
+ * Returns the hash of the specified string, ignoring the case of ASCII letters.
+ *
+ * @param string String.
+ * @return Hash.
+ *
+ * @note Strings that are equal according to ustring_equals_ci have the same hash.
+ *
+ * @public @memberof UString
+ */
+ULIB_PUBLIC
+ulib_uint ustring_hash_ci(UString string);
+
 /**
  * Converts the string into an integer.
  *
@@ -487,6 +651,9 @@ ulib_uint ustring_hash(UString string);
  * @param base Numeric base.
  * @return Return code.
  *
+ * @note Decimal conversions are performed via ulib_str_parse_int, and fail
+ *       if the value is out of range.
+ *
  * @public @memberof UString
  */
 ULIB_PUBLIC
@@ -500,6 +667,9 @@ ulib_ret ustring_to_int(UString string, ulib_int *out, unsigned base);
  * @param base Numeric base.
  * @return Return code.
  *
+ * @note Decimal conversions are performed via ulib_str_parse_uint, and fail
+ *       if the value is out of range.
+ *
  * @public @memberof UString
  */
 ULIB_PUBLIC
@@ -512,6 +682,8 @@ ulib_ret ustring_to_uint(UString string, ulib_uint *out, unsigned base);
  * @param[out] out Converted value.
  * @return Return code.
  *
+ * @note The conversion is performed via ulib_str_parse_float.
+ *
  * @public @memberof UString
  */
 ULIB_PUBLIC
@@ -568,6 +740,91 @@ bool ustring_is_empty(UString string) {
     return ustring_size(string) <= 1;
 }
 
+/**
+ * Iterator over the tokens of a string, delimited by a separator.
+ *
+ * Tokens are returned as views into the split string, so that splitting
+ * does not allocate. The split string must outlive the iterator and its tokens.
+ *
+ * @note Tokens are wrapped via `ustring_wrap`, so they are not null-terminated unless short,
+ *       and you must not call `ustring_deinit` on them.
+ */
+typedef struct UStrSplit {
+    /// @cond
+    UString _string;
+    UString _sep;
+    ulib_uint _pos;
+    ulib_byte _set[32];
+    ulib_byte _mode;
+    bool _done;
+    /// @endcond
+} UStrSplit;
+
+/**
+ * Splits the string around the occurrences of the specified character.
+ *
+ * @param string String to split.
+ * @param sep Separator.
+ * @return Split iterator.
+ *
+ * @note As in most languages, N separators produce N + 1 tokens, and adjacent separators
+ *       produce empty tokens. An empty string produces a single empty token.
+ *
+ * @public @memberof UStrSplit
+ */
+ULIB_PUBLIC
+UStrSplit ustring_split(UString string, char sep);
+
+/**
+ * Splits the string around the occurrences of any of the specified characters.
+ *
+ * @param string String to split.
+ * @param chars Separator characters.
+ * @return Split iterator.
+ *
+ * @public @memberof UStrSplit
+ */
+ULIB_PUBLIC
+UStrSplit ustring_split_any(UString string, UString chars);
+
+/**
+ * Splits the string around the occurrences of the specified separator string.
+ *
+ * @param string String to split.
+ * @param sep Separator string.
+ * @return Split iterator.
+ *
+ * @note If the separator is empty, the whole string is returned as a single token.
+ *
+ * @public @memberof UStrSplit
+ */
+ULIB_PUBLIC
+UStrSplit ustring_split_string(UString string, UString sep);
+
+/**
+ * Returns the next token.
+ *
+ * @param split Split iterator.
+ * @param[out] token Next token.
+ * @return True if a token was returned, false if all the tokens have been returned.
+ *
+ * @public @memberof UStrSplit
+ */
+ULIB_PUBLIC
+bool ustrsplit_next(UStrSplit *split, UString *token);
+
+/**
+ * Iterates over the tokens of a split iterator, executing the specified code block for each.
+ *
+ * @param split [UStrSplit] Split iterator.
+ * @param token [symbol] Name of the variable holding the current token.
+ *
+ * @public @related UStrSplit
+ */
+#define ustrsplit_foreach(split, token)                                                            \
+    for (UStrSplit p_##token = (split); !p_##token._done; p_##token._done = true)                  \
+        for (UString token; ustrsplit_next(&p_##token, &token);)
+
 ULIB_END_DECLS
 
 #endif // USTRING_H
@@ -151,10 +151,8 @@ bool ulib_str_is_lower(char const *string, size_t length) {
  *
  * @note dst and src can be equal.
  */
-ULIB_INLINE
-void ulib_str_to_upper(char *dst, char const *src, size_t length) {
-    while (length--) dst[length] = ulib_char_to_upper(src[length]);
-}
+ULIB_PUBLIC
+void ulib_str_to_upper(char *dst, char const *src, size_t length);
 
 /**
  * Converts the given string to lowercase.
@@ -167,10 +165,50 @@ void ulib_str_to_upper(char *dst, char const *src, size_t length) {
  *
  * @note dst and src can be equal.
  */
-ULIB_INLINE
-void ulib_str_to_lower(char *dst, char const *src, size_t length) {
-    while (length--) dst[length] = ulib_char_to_lower(src[length]);
-}
+ULIB_PUBLIC
+void ulib_str_to_lower(char *dst, char const *src, size_t length);
+
+/**
+ * Checks whether the given strings are equal, ignoring the case of ASCII letters.
+ *
+ * @param lhs First string.
+ * @param rhs Second string.
+ * @param length Length of the strings.
+ * @return True if the strings are equal, false otherwise.
+ *
+ * @public @related UString
+ */
+ULIB_PUBLIC
+bool ulib_str_equals_ci(char const *lhs, char const *rhs, size_t length);
+
+/**
+ * Checks whether the given string is valid UTF-8.
+ *
+ * @param string String.
+ * @param length String length.
+ * @return True if the string is valid UTF-8, false otherwise.
+ *
+ * @note Overlong encodings, surrogates and code points above U+10FFFF are rejected.
+ *
+ * @public @related UString
+ */
+ULIB_PUBLIC
+bool ulib_str_is_valid_utf8(char const *string, size_t length);
+
+/**
+ * Returns the number of code points in the given UTF-8 string.
+ *
+ * @param string String.
+ * @param length String length.
+ * @return Number of code points.
+ *
+ * @note The string is assumed to be valid UTF-8: for invalid strings,
+ *       the result is the number of bytes that are not continuation bytes.
+ *
+ * @public @related UString
+ */
+ULIB_PUBLIC
+size_t ulib_str_utf8_length(char const *string, size_t length);
 
 /**
  * Converts the given string into an integer.
@@ -246,6 +284,59 @@ ulib_float ulib_str_to_float(char const *src, char **end) {
     return ret;
 }
 
+/**
+ * Parses a decimal integer from the first characters of the given buffer.
+ *
+ * @param src Source buffer.
+ * @param length Length of the buffer.
+ * @param[out] out Parsed value.
+ * @return Number of parsed characters, or zero if the buffer does not begin with an integer
+ *         or the integer is out of range.
+ *
+ * @note Unlike ulib_str_to_int, this function does not need the buffer to be null-terminated,
+ *       does not depend on the current locale, and does not skip leading whitespace.
+ *
+ * @public @related UString
+ */
+ULIB_PUBLIC
+size_t ulib_str_parse_int(char const *src, size_t length, ulib_int *out);
+
+/**
+ * Parses a decimal unsigned integer from the first characters of the given buffer.
+ *
+ * @param src Source buffer.
+ * @param length Length of the buffer.
+ * @param[out] out Parsed value.
+ * @return Number of parsed characters, or zero if the buffer does not begin with an unsigned
+ *         integer or the integer is out of range.
+ *
+ * @note Unlike ulib_str_to_uint, this function does not need the buffer to be null-terminated,
+ *       does not depend on the current locale, and does not skip leading whitespace.
+ *
+ * @public @related UString
+ */
+ULIB_PUBLIC
+size_t ulib_str_parse_uint(char const *src, size_t length, ulib_uint *out);
+
+/**
+ * Parses a decimal float from the first characters of the given buffer.
+ *
+ * @param src Source buffer.
+ * @param length Length of the buffer.
+ * @param[out] out Parsed value.
+ * @return Number of parsed characters, or zero if the buffer does not begin with a float.
+ *
+ * @note Unlike ulib_str_to_float, this function does not need the buffer to be null-terminated,
+ *       does not skip leading whitespace, and does not parse hexadecimal floats. Values whose
+ *       significand and exponent are exactly representable are converted without calling
+ *       into the C library; the remaining ones, as well as "inf" and "nan", fall back to
+ *       ulib_str_to_float.
+ *
+ * @public @related UString
+ */
+ULIB_PUBLIC
+size_t ulib_str_parse_float(char const *src, size_t length, ulib_float *out);
+
 ULIB_END_DECLS
 
 #endif // USTRING_RAW_H
@@ -0,0 +1,173 @@
+/**
+ * Multi-pattern string matching.
+ *
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef USTRMATCH_H
+#define USTRMATCH_H
+
+#include "ulib_ret.h"
+#include "ustream.h"
+#include "ustring.h"
+#include "uvec_builtin.h"
+
+ULIB_BEGIN_DECLS
+
+/**
+ * Maximum number of distinct first bytes of the needles for which
+ * a vectorized prefilter is used to skip over non-matching input.
+ *
+ * @note Can be overridden at compile time.
+ */
+#ifndef USTRMATCHER_PREFILTER_MAX
+#define USTRMATCHER_PREFILTER_MAX 6
+#endif
+
+/// An occurrence of a needle.
+typedef struct UStrMatch {
+
+    /// Index of the needle in the vector the matcher was built from.
+    ulib_uint needle;
+
+    /// Index of the first character of the occurrence.
+    size_t index;
+
+} UStrMatch;
+
+/// @cond
+UVEC_DECL_SPEC(UStrMatch, ULIB_PUBLIC)
+/// @endcond
+
+/**
+ * Compiled multi-pattern matcher, finding the occurrences of several needles
+ * in a single pass over the input (Aho-Corasick).
+ *
+ * @note Empty needles never match. If a needle occurs more than once,
+ *       its occurrences are reported with the index of its first instance.
+ */
+typedef struct UStrMatcher {
+    /// @cond
+    UVec(ulib_uint) _delta;
+    UVec(ulib_uint) _out;
+    UVec(ulib_uint) _link;
+    UVec(ulib_uint) _lengths;
+    ulib_uint _classes;
+    ulib_byte _class[256];
+    ulib_byte _first[USTRMATCHER_PREFILTER_MAX];
+    ulib_byte _first_count;
+    /// @endcond
+} UStrMatcher;
+
+/**
+ * Compiles a matcher for the specified needles.
+ *
+ * @param matcher Matcher.
+ * @param needles Needles.
+ * @return Return code.
+ *
+ * @note The matcher does not reference the needles, which can be released after this call.
+ *
+ * @public @memberof UStrMatcher
+ */
+ULIB_PUBLIC
+ulib_ret ustrmatcher_init(UStrMatcher *matcher, UVec(UString) const *needles);
+
+/**
+ * Deinitializes a matcher.
+ *
+ * @param matcher Matcher.
+ *
+ * @public @memberof UStrMatcher
+ */
+ULIB_PUBLIC
+void ustrmatcher_deinit(UStrMatcher *matcher);
+
+/**
+ * Returns the number of needles of the matcher.
+ *
+ * @param matcher Matcher.
+ * @return Number of needles.
+ *
+ * @public @memberof UStrMatcher
+ */
+ULIB_INLINE
+ulib_uint ustrmatcher_count(UStrMatcher const *matcher) {
+    return uvec_count(ulib_uint, &matcher->_lengths);
+}
+
+/**
+ * Finds the first occurrence of any needle in the specified string.
+ *
+ * @param matcher Matcher.
+ * @param string String.
+ * @param[out] match First occurrence.
+ * @return True if a needle occurs in the string, false otherwise.
+ *
+ * @note The first occurrence is the one that ends first. If several needles end at the same
+ *       index, the longest is returned.
+ *
+ * @public @memberof UStrMatcher
+ */
+ULIB_PUBLIC
+bool ustrmatcher_find(UStrMatcher const *matcher, UString string, UStrMatch *match);
+
+/**
+ * Finds all the occurrences of the needles in the specified string,
+ * appending them to the specified vector.
+ *
+ * @param matcher Matcher.
+ * @param string String.
+ * @param matches Vector of occurrences.
+ * @return Return code.
+ *
+ * @note Occurrences are sorted by their end index, and occurrences ending
+ *       at the same index are sorted from the longest to the shortest.
+ *
+ * @public @memberof UStrMatcher
+ */
+ULIB_PUBLIC
+ulib_ret ustrmatcher_find_all(UStrMatcher const *matcher, UString string,
+                              UVec(UStrMatch) *matches);
+
+/**
+ * Finds the first occurrence of any needle in the specified stream,
+ * stopping as soon as it has been read.
+ *
+ * @param matcher Matcher.
+ * @param stream Input stream.
+ * @param[out] match First occurrence, indexed from the current position of the stream.
+ * @param[out] found True if a needle occurs in the stream, false otherwise.
+ * @return Return code.
+ *
+ * @note If the stream supports peeking, it is left positioned right after the occurrence.
+ *
+ * @public @memberof UStrMatcher
+ */
+ULIB_PUBLIC
+ustream_ret ustrmatcher_find_stream(UStrMatcher const *matcher, UIStream *stream,
+                                    UStrMatch *match, bool *found);
+
+/**
+ * Finds all the occurrences of the needles in the specified stream,
+ * appending them to the specified vector.
+ *
+ * @param matcher Matcher.
+ * @param stream Input stream.
+ * @param matches Vector of occurrences, indexed from the current position of the stream.
+ * @return Return code.
+ *
+ * @public @memberof UStrMatcher
+ */
+ULIB_PUBLIC
+ustream_ret ustrmatcher_find_all_stream(UStrMatcher const *matcher, UIStream *stream,
+                                        UVec(UStrMatch) *matches);
+
+ULIB_END_DECLS
+
+#endif // USTRMATCH_H
@@ -0,0 +1,136 @@
+/**
+ * A string interning pool.
+ *
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef USTRPOOL_H
+#define USTRPOOL_H
+
+#include "uhash.h"
+#include "ulib_ret.h"
+#include "ustring.h"
+#include "uvec_builtin.h"
+
+ULIB_BEGIN_DECLS
+
+/**
+ * Size of the storage chunks allocated by a string pool, in bytes.
+ * Strings larger than a quarter of this size get a dedicated chunk.
+ *
+ * @note Can be overridden at compile time.
+ */
+#ifndef USTRPOOL_CHUNK_SIZE
+#define USTRPOOL_CHUNK_SIZE 65536
+#endif
+
+/// @cond
+typedef UString p_ustrpool_str;
+UHASH_DECL_SPEC(p_ustrpool, UString, ulib_uint, ULIB_PUBLIC)
+UVEC_DECL_SPEC(p_ustrpool_str, ULIB_PUBLIC)
+/// @endcond
+
+/**
+ * A string interning pool.
+ *
+ * Stores a single copy of each distinct string, packing the characters of large strings
+ * into contiguous chunks. Each interned string is identified by a small integer id,
+ * so that interned strings can be compared by id rather than by content.
+ *
+ * @note Strings returned by the pool do not own their buffers, and remain valid
+ *       until the pool is deinitialized. You must not call `ustring_deinit` on them.
+ */
+typedef struct UStringPool {
+    /// @cond
+    UHash(p_ustrpool) _ids;
+    UVec(p_ustrpool_str) _strings;
+    UVec(ulib_ptr) _chunks;
+    char *_cur;
+    size_t _left;
+    /// @endcond
+} UStringPool;
+
+/**
+ * Initializes a new string pool.
+ *
+ * @return Initialized string pool.
+ *
+ * @public @memberof UStringPool
+ */
+ULIB_PUBLIC
+UStringPool ustrpool(void);
+
+/**
+ * Deinitializes a string pool, releasing all the interned strings at once.
+ *
+ * @param pool String pool.
+ *
+ * @public @memberof UStringPool
+ */
+ULIB_PUBLIC
+void ustrpool_deinit(UStringPool *pool);
+
+/**
+ * Interns the specified string.
+ *
+ * @param pool String pool.
+ * @param string String to intern.
+ * @param[out] id Id of the interned string.
+ * @return Return code.
+ *
+ * @note If the string is already in the pool, its existing id is returned.
+ *
+ * @public @memberof UStringPool
+ */
+ULIB_PUBLIC
+ulib_ret ustrpool_intern(UStringPool *pool, UString string, ulib_uint *id);
+
+/**
+ * Returns the id of the specified string.
+ *
+ * @param pool String pool.
+ * @param string String.
+ * @return Id of the string, or the number of strings in the pool if it has not been interned.
+ *
+ * @public @memberof UStringPool
+ */
+ULIB_PUBLIC
+ulib_uint ustrpool_find(UStringPool const *pool, UString string);
+
+/**
+ * Returns the number of strings in the pool.
+ *
+ * @param pool String pool.
+ * @return Number of strings.
+ *
+ * @public @memberof UStringPool
+ */
+ULIB_INLINE
+ulib_uint ustrpool_count(UStringPool const *pool) {
+    return uvec_count(p_ustrpool_str, &pool->_strings);
+}
+
+/**
+ * Returns the interned string with the specified id.
+ *
+ * @param pool String pool.
+ * @param id Id of the string.
+ * @return Interned string.
+ *
+ * @warning Passing an invalid id results in undefined behavior.
+ *
+ * @public @memberof UStringPool
+ */
+ULIB_INLINE
+UString ustrpool_get(UStringPool const *pool, ulib_uint id) {
+    return uvec_get(p_ustrpool_str, &pool->_strings, id);
+}
+
+ULIB_END_DECLS
+
+#endif // USTRPOOL_H
@@ -14,6 +14,7 @@
 
 #include "umacros.h"
 #include "ustd.h"
+#include "utime.h"
 
 ULIB_BEGIN_DECLS
 
@@ -24,44 +25,60 @@ ULIB_BEGIN_DECLS
  * @{
  */
 
+/**
+ * Test runner configuration.
+ */
+typedef struct UTestConfig {
+
+    /// Number of threads running the tests of each batch (1 by default).
+    unsigned jobs;
+
+    /// Maximum duration of each test, or zero for no timeout (60 seconds by default).
+    utime_ns timeout;
+
+} UTestConfig;
+
 /**
  * Defines the main test function.
  *
  * @param CODE Code to execute, generally a sequence of utest_run statements.
+ *
+ * @note The test executable accepts the following command line options:
+ *       - `-j N`, `--jobs N`: run the tests of each batch on `N` threads.
+ *       - `--timeout S`: abort the tests if a test runs for more than `S` seconds (0 to disable).
  */
 #define utest_main(CODE)                                                                           \
-    int main(void) {                                                                               \
+    int main(int argc, char **argv) {                                                              \
         setbuf(stdout, NULL);                                                                      \
-        if (!utest_leak_start()) return EXIT_FAILURE;                                              \
+        if (!utest_start(argc, argv)) return EXIT_FAILURE;                                         \
         int exit_code = EXIT_SUCCESS;                                                              \
         { CODE }                                                                                   \
-        if (!utest_leak_end()) exit_code = EXIT_FAILURE;                                           \
+        if (!utest_end()) exit_code = EXIT_FAILURE;                                                \
         return exit_code;                                                                          \
     }
 
 /**
  * Runs a test batch.
  *
+ * Tests are run on the number of threads specified by @ref UTestConfig.jobs,
+ * and the duration of each test is printed once the batch completes.
+ *
  * @param NAME Name of the test batch (must be a string literal).
  * @param ... Comma separated list of [void] -> bool test functions.
+ *
+ * @note Tests failing in parallel may print their failure reasons in any order.
  */
-#define utest_run(NAME, ...)                                                                       \
-    do {                                                                                           \
-        int run_exit_code = EXIT_SUCCESS;                                                          \
-        printf("Starting \"" NAME "\" tests.\n");                                                  \
-                                                                                                   \
-        bool (*tests_to_run[])(void) = { __VA_ARGS__ };                                            \
-        for (size_t test_i = 0; test_i < ulib_array_count(tests_to_run); ++test_i) {               \
-            if (!tests_to_run[test_i]()) run_exit_code = EXIT_FAILURE;                             \
-        }                                                                                          \
-                                                                                                   \
-        if (run_exit_code == EXIT_SUCCESS) {                                                       \
-            printf("All \"" NAME "\" tests passed.\n");                                            \
-        } else {                                                                                   \
-            exit_code = EXIT_FAILURE;                                                              \
-            printf("Some \"" NAME "\" tests failed.\n");                                           \
-        }                                                                                          \
-    } while (0)
+#define utest_run(NAME, ...) p_utest_run_batch(NAME, true, __VA_ARGS__)
+
+/**
+ * Runs a test batch on the calling thread, one test at a time.
+ *
+ * @param NAME Name of the test batch (must be a string literal).
+ * @param ... Comma separated list of [void] -> bool test functions.
+ *
+ * @note Use this for batches whose tests share global state.
+ */
+#define utest_run_serial(NAME, ...) p_utest_run_batch(NAME, false, __VA_ARGS__)
 
 /**
  * Assert that the specified expression must be true.
@@ -211,6 +228,36 @@ ULIB_BEGIN_DECLS
         }                                                                                          \
     } while (0)
 
+/**
+ * Returns the test runner configuration.
+ *
+ * @return Test runner configuration.
+ */
+ULIB_PUBLIC
+UTestConfig *utest_config(void);
+
+/**
+ * Parses the command line options and starts detection of memory leaks.
+ *
+ * @param argc Number of command line arguments.
+ * @param argv Command line arguments.
+ * @return True if the tests can start, false otherwise.
+ *
+ * @note Called by @ref utest_main.
+ */
+ULIB_PUBLIC
+bool utest_start(int argc, char **argv);
+
+/**
+ * Ends detection of memory leaks.
+ *
+ * @return True if no leaks were detected, false otherwise.
+ *
+ * @note Called by @ref utest_main.
+ */
+ULIB_PUBLIC
+bool utest_end(void);
+
 /**
  * Start detection of memory leaks.
  *
@@ -231,6 +278,22 @@ bool utest_leak_end(void);
 
 // Private API
 
+#define p_utest_stringify(...) #__VA_ARGS__
+#define p_utest_names(...) p_utest_stringify(__VA_ARGS__)
+
+#define p_utest_run_batch(NAME, PARALLEL, ...)                                                     \
+    do {                                                                                           \
+        bool (*tests_to_run[])(void) = { __VA_ARGS__ };                                            \
+        if (!p_utest_run(NAME, p_utest_names(__VA_ARGS__), tests_to_run,                           \
+                         (unsigned)ulib_array_count(tests_to_run), PARALLEL)) {                    \
+            exit_code = EXIT_FAILURE;                                                              \
+        }                                                                                          \
+    } while (0)
+
+ULIB_PUBLIC
+bool p_utest_run(char const *name, char const *names, bool (**tests)(void), unsigned count,
+                 bool parallel);
+
 ULIB_PUBLIC
 void *p_utest_leak_malloc_impl(size_t size, char const *file, char const *fn, int line);
 
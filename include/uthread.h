@@ -0,0 +1,301 @@
+/**
+ * Threading primitives.
+ *
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UTHREAD_H
+#define UTHREAD_H
+
+#include "ulib_ret.h"
+#include "ustd.h"
+
+#if !defined(ULIB_NO_THREADS)
+    #if defined(_WIN32)
+        #define P_ULIB_THREADS_WIN32 1
+    #else
+        #define P_ULIB_THREADS_PTHREAD 1
+    #endif
+#endif
+
+/// @cond
+// Storage for the pthread types, which are not exposed so that clients do not need
+// POSIX headers and feature macros. Sizes are checked when building the library.
+#if defined(P_ULIB_THREADS_PTHREAD)
+    #if defined(__APPLE__)
+        #define P_URWLOCK_SIZE 200
+        #define P_UMUTEX_SIZE 64
+        #define P_UCOND_SIZE 48
+        #define P_URWLOCK_SIG_INIT 0x2DA8B3B4L
+    #else
+        #define P_URWLOCK_SIZE 64
+        #define P_UMUTEX_SIZE 48
+        #define P_UCOND_SIZE 48
+        #define P_URWLOCK_SIG_INIT 0L
+    #endif
+    #define P_UTHREAD_STORAGE(size)                                                                \
+        union {                                                                                    \
+            long _words[((size) + sizeof(long) - 1) / sizeof(long)];                               \
+            long long _align_ll;                                                                   \
+            double _align_d;                                                                       \
+        }
+#endif
+/// @endcond
+
+ULIB_BEGIN_DECLS
+
+/**
+ * Threading primitives.
+ *
+ * @defgroup thread Threading primitives
+ * @{
+ */
+
+/**
+ * Read-write lock.
+ *
+ * @note If threads are disabled (`ULIB_NO_THREADS` is defined), locking operations are no-ops.
+ */
+typedef struct URWLock {
+    /** @cond */
+#if defined(P_ULIB_THREADS_PTHREAD)
+    P_UTHREAD_STORAGE(P_URWLOCK_SIZE) _lock;
+#elif defined(P_ULIB_THREADS_WIN32)
+    void *_lock; // Layout-compatible with SRWLOCK.
+#else
+    char _lock;
+#endif
+    /** @endcond */
+} URWLock;
+
+/**
+ * Mutual exclusion lock.
+ *
+ * @note If threads are disabled (`ULIB_NO_THREADS` is defined), locking operations are no-ops.
+ */
+typedef struct UMutex {
+    /** @cond */
+#if defined(P_ULIB_THREADS_PTHREAD)
+    P_UTHREAD_STORAGE(P_UMUTEX_SIZE) _lock;
+#elif defined(P_ULIB_THREADS_WIN32)
+    void *_lock; // Layout-compatible with SRWLOCK.
+#else
+    char _lock;
+#endif
+    /** @endcond */
+} UMutex;
+
+/**
+ * Condition variable.
+ *
+ * @note If threads are disabled (`ULIB_NO_THREADS` is defined), all operations are no-ops.
+ */
+typedef struct UCond {
+    /** @cond */
+#if defined(P_ULIB_THREADS_PTHREAD)
+    P_UTHREAD_STORAGE(P_UCOND_SIZE) _cond;
+#elif defined(P_ULIB_THREADS_WIN32)
+    void *_cond; // Layout-compatible with CONDITION_VARIABLE.
+#else
+    char _cond;
+#endif
+    /** @endcond */
+} UCond;
+
+/**
+ * Thread handle.
+ */
+typedef struct UThread {
+    /** @cond */
+    void *_thread;
+    /** @endcond */
+} UThread;
+
+/**
+ * Static initializer for read-write locks.
+ *
+ * @note Locks initialized this way do not need to be initialized via @ref urwlock_init.
+ *
+ * @def URWLOCK_INIT
+ */
+#if defined(P_ULIB_THREADS_PTHREAD)
+    #define URWLOCK_INIT { { { P_URWLOCK_SIG_INIT } } }
+#else
+    #define URWLOCK_INIT { 0 }
+#endif
+
+/**
+ * Initializes a read-write lock.
+ *
+ * @param lock Lock.
+ * @return Return code.
+ */
+ULIB_PUBLIC
+ulib_ret urwlock_init(URWLock *lock);
+
+/**
+ * Deinitializes a read-write lock.
+ *
+ * @param lock Lock.
+ */
+ULIB_PUBLIC
+void urwlock_deinit(URWLock *lock);
+
+/**
+ * Acquires the lock for reading.
+ *
+ * @param lock Lock.
+ */
+ULIB_PUBLIC
+void urwlock_read_lock(URWLock *lock);
+
+/**
+ * Releases a lock acquired for reading.
+ *
+ * @param lock Lock.
+ */
+ULIB_PUBLIC
+void urwlock_read_unlock(URWLock *lock);
+
+/**
+ * Acquires the lock for writing.
+ *
+ * @param lock Lock.
+ */
+ULIB_PUBLIC
+void urwlock_write_lock(URWLock *lock);
+
+/**
+ * Releases a lock acquired for writing.
+ *
+ * @param lock Lock.
+ */
+ULIB_PUBLIC
+void urwlock_write_unlock(URWLock *lock);
+
+/**
+ * Initializes a mutex.
+ *
+ * @param mutex Mutex.
+ * @return Return code.
+ */
+ULIB_PUBLIC
+ulib_ret umutex_init(UMutex *mutex);
+
+/**
+ * Deinitializes a mutex.
+ *
+ * @param mutex Mutex.
+ */
+ULIB_PUBLIC
+void umutex_deinit(UMutex *mutex);
+
+/**
+ * Acquires a mutex.
+ *
+ * @param mutex Mutex.
+ */
+ULIB_PUBLIC
+void umutex_lock(UMutex *mutex);
+
+/**
+ * Releases a mutex.
+ *
+ * @param mutex Mutex.
+ */
+ULIB_PUBLIC
+void umutex_unlock(UMutex *mutex);
+
+/**
+ * Initializes a condition variable.
+ *
+ * @param cond Condition variable.
+ * @return Return code.
+ */
+ULIB_PUBLIC
+ulib_ret ucond_init(UCond *cond);
+
+/**
+ * Deinitializes a condition variable.
+ *
+ * @param cond Condition variable.
+ */
+ULIB_PUBLIC
+void ucond_deinit(UCond *cond);
+
+/**
+ * Atomically releases the mutex and waits for the condition variable to be signaled,
+ * reacquiring the mutex before returning.
+ *
+ * @param cond Condition variable.
+ * @param mutex Mutex, which must be held by the calling thread.
+ *
+ * @note Spurious wakeups are possible, so the waited-for condition must be checked in a loop.
+ */
+ULIB_PUBLIC
+void ucond_wait(UCond *cond, UMutex *mutex);
+
+/**
+ * Wakes up one of the threads waiting on the condition variable.
+ *
+ * @param cond Condition variable.
+ */
+ULIB_PUBLIC
+void ucond_signal(UCond *cond);
+
+/**
+ * Wakes up all the threads waiting on the condition variable.
+ *
+ * @param cond Condition variable.
+ */
+ULIB_PUBLIC
+void ucond_broadcast(UCond *cond);
+
+/**
+ * Starts a new thread.
+ *
+ * @param thread [out] Thread handle.
+ * @param func Function to run on the new thread.
+ * @param ctx Argument passed to the function.
+ * @return Return code.
+ *
+ * @note If threads are disabled (`ULIB_NO_THREADS` is defined), the function
+ *       is run synchronously on the calling thread.
+ */
+ULIB_PUBLIC
+ulib_ret uthread_start(UThread *thread, void (*func)(void *ctx), void *ctx);
+
+/**
+ * Waits for a thread to terminate.
+ *
+ * @param thread Thread handle.
+ * @return Return code.
+ */
+ULIB_PUBLIC
+ulib_ret uthread_join(UThread *thread);
+
+/**
+ * Runs a function on multiple contexts in parallel, and waits for all of them to complete.
+ *
+ * @param func Function to run.
+ * @param ctx Array of contexts, each passed to a separate invocation of the function.
+ * @param size Size of each context.
+ * @param count Number of contexts.
+ *
+ * @note The first context is processed on the calling thread, and every other context
+ *       on its own thread. If a thread cannot be started, its context is processed
+ *       on the calling thread.
+ */
+ULIB_PUBLIC
+void uthread_run_parallel(void (*func)(void *ctx), void *ctx, size_t size, unsigned count);
+
+/** @} */
+
+ULIB_END_DECLS
+
+#endif // UTHREAD_H
@@ -61,6 +61,14 @@ typedef enum utime_unit {
 
 } utime_unit;
 
+/**
+ * Size of the buffers passed to @ref utime_format.
+ *
+ * @note Sufficient for the full range of years, and for fractional seconds
+ *       up to nanosecond precision.
+ */
+#define UTIME_FORMAT_SIZE 40
+
 /// @}
 
 /// Date and time.
@@ -184,16 +192,111 @@ UString utime_to_string(UTime const *time);
  *       - 1990-02-14T13:30:00Z
  *       - 1990 02 14 14.30.00+1:00
  *
+ * @note Dates in the format accepted by @ref utime_parse are parsed via its faster code path,
+ *       in which case fractional seconds are allowed and ignored.
+ *
  * @public @memberof UTime
  */
 ULIB_PUBLIC
 bool utime_from_string(UTime *time, UString const *string);
 
+/**
+ * Formats the specified date in the Y/MM/DD-hh:mm:ss format used by @ref utime_to_string.
+ *
+ * @param time Date.
+ * @param[out] buf Buffer of at least @ref UTIME_FORMAT_SIZE characters.
+ * @return Length of the formatted date.
+ *
+ * @note The formatted date is not null-terminated.
+ *
+ * @public @memberof UTime
+ */
+ULIB_PUBLIC
+ulib_uint utime_format(UTime const *time, char *buf);
+
+/**
+ * Parses a date in the fixed YYYY_MM_DD_hh_mm_ss format, where each component is separated
+ * by a single non-digit character, followed by optional fractional seconds and timezone.
+ *
+ * @param[out] time Date.
+ * @param[out] nanos Fractional seconds in nanoseconds, can be NULL.
+ * @param str String.
+ * @param length Length of the string.
+ * @return Number of parsed characters, or zero if the string does not start with a valid date.
+ *
+ * @note Fractional seconds are separated by '.' or ',', and digits past nanosecond precision
+ *       are ignored. The timezone specifier is either 'Z' or in the +hh:mm format, in which case
+ *       the date is normalized to UTC. Examples:
+ *       - 1990-02-14T13:30:00Z
+ *       - 1990/02/14 14:30:00.250+01:00
+ *
+ * @public @memberof UTime
+ */
+ULIB_PUBLIC
+ulib_uint utime_parse(UTime *time, unsigned *nanos, char const *str, ulib_uint length);
+
 /**
  * @addtogroup time
  * @{
  */
 
+/**
+ * Cache of formatted dates, for the frequent formatting of increasing timestamps, e.g. in logs.
+ *
+ * Only the seconds and fractional seconds are formatted as long as timestamps fall
+ * within the same minute, reusing the formatted date, hour and minute.
+ *
+ * @note Caches are not thread-safe; use a separate cache for each thread.
+ */
+typedef struct UTimeCache {
+    /// @cond
+    utime_stamp _minute;
+    ulib_uint _length;
+    char _buf[UTIME_FORMAT_SIZE];
+    /// @endcond
+} UTimeCache;
+
+/**
+ * Initializes a new date cache.
+ *
+ * @return Date cache.
+ */
+ULIB_INLINE
+UTimeCache utime_cache(void) {
+    UTimeCache cache;
+    cache._minute = 0;
+    cache._length = 0;
+    return cache;
+}
+
+/**
+ * Formats the specified timestamp via the cache.
+ *
+ * @param cache Date cache.
+ * @param ts Timestamp since January 1 1970, 00:00:00.
+ * @param unit Unit of the timestamp, which also determines the number of fractional digits:
+ *             @ref UTIME_SECONDS, @ref UTIME_MILLISECONDS, @ref UTIME_MICROSECONDS
+ *             or @ref UTIME_NANOSECONDS. Other units are treated as seconds.
+ * @param[out] length Length of the formatted date.
+ * @return Formatted date, in the Y/MM/DD-hh:mm:ss[.fff] format. It is null-terminated,
+ *         and valid until the next call that uses the cache.
+ */
+ULIB_PUBLIC
+char const *utime_cache_format(UTimeCache *cache, utime_stamp ts, utime_unit unit,
+                               ulib_uint *length);
+
+/**
+ * Formats the current date and time via the cache.
+ *
+ * @param cache Date cache.
+ * @param unit Precision: @ref UTIME_SECONDS, @ref UTIME_MILLISECONDS,
+ *             @ref UTIME_MICROSECONDS or @ref UTIME_NANOSECONDS.
+ * @param[out] length Length of the formatted date.
+ * @return Formatted date. It is null-terminated, and valid until the next call that uses the cache.
+ */
+ULIB_PUBLIC
+char const *utime_cache_now(UTimeCache *cache, utime_unit unit, ulib_uint *length);
+
 /**
  * Checks whether the specified year is a leap year.
  *
@@ -226,6 +329,22 @@ unsigned utime_days_in_month(long long year, unsigned month) {
 ULIB_PUBLIC
 utime_stamp utime_get_timestamp(void);
 
+/**
+ * Retrieves a timestamp expressed as milliseconds since January 1 1970, 00:00:00.
+ *
+ * @return Timestamp in milliseconds since January 1 1970, 00:00:00.
+ */
+ULIB_PUBLIC
+utime_stamp utime_get_timestamp_ms(void);
+
+/**
+ * Retrieves a timestamp expressed as microseconds since January 1 1970, 00:00:00.
+ *
+ * @return Timestamp in microseconds since January 1 1970, 00:00:00.
+ */
+ULIB_PUBLIC
+utime_stamp utime_get_timestamp_us(void);
+
 /**
  * Retrieves a timestamp in nanoseconds.
  *
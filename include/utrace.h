@@ -0,0 +1,211 @@
+/**
+ * Lightweight tracing.
+ *
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UTRACE_H
+#define UTRACE_H
+
+#include "ustd.h"
+#include "ustream.h"
+#include "utime.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    #include <x86intrin.h>
+    #define P_UTRACE_TICKS_RDTSC
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+    #define P_UTRACE_TICKS_RDTSC
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+    #define P_UTRACE_TICKS_CNTVCT
+#endif
+
+ULIB_BEGIN_DECLS
+
+/**
+ * Lightweight tracing.
+ *
+ * Spans are timed via the processor cycle counter (`rdtsc` on x86, `cntvct_el0` on AArch64),
+ * falling back to @ref utime_get_ns on other platforms. Ticks are converted into nanoseconds
+ * by calibrating the counter against @ref utime_get_ns.
+ *
+ * Completed spans are recorded into per-thread ring buffers of @ref UTRACE_BUFFER_SIZE events,
+ * so that recording is lock-free and does not allocate memory, except for the first span
+ * recorded by each thread. Once a buffer is full, the oldest events are overwritten.
+ *
+ * @note The cycle counter is assumed to be invariant and synchronized across cores,
+ *       which holds for modern x86 and AArch64 processors.
+ *
+ * @defgroup trace Tracing
+ * @{
+ */
+
+/**
+ * Number of events retained by each thread. Must be a power of two.
+ *
+ * @note Can be overridden at compile time.
+ */
+#ifndef UTRACE_BUFFER_SIZE
+#define UTRACE_BUFFER_SIZE 4096
+#endif
+
+/// Value of the tick counter.
+typedef uint64_t utrace_tick;
+
+/// Trace span.
+typedef struct UTraceSpan {
+
+    /// Name of the span.
+    char const *name;
+
+    /// Start of the span.
+    utrace_tick start;
+
+} UTraceSpan;
+
+/**
+ * Returns the current value of the tick counter.
+ *
+ * @return Tick counter.
+ */
+ULIB_INLINE
+utrace_tick utrace_ticks(void) {
+#if defined(P_UTRACE_TICKS_RDTSC)
+    return (utrace_tick)__rdtsc();
+#elif defined(P_UTRACE_TICKS_CNTVCT)
+    utrace_tick ticks;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return (utrace_tick)utime_get_ns();
+#endif
+}
+
+/**
+ * Calibrates the tick counter against @ref utime_get_ns.
+ *
+ * @note Calibration takes a few milliseconds, and happens automatically the first time ticks
+ *       are converted into nanoseconds. Call this function at startup to avoid the delay.
+ */
+ULIB_PUBLIC
+void utrace_calibrate(void);
+
+/**
+ * Returns the number of nanoseconds per tick.
+ *
+ * @return Nanoseconds per tick.
+ */
+ULIB_PUBLIC
+double utrace_ns_per_tick(void);
+
+/**
+ * Converts ticks into nanoseconds.
+ *
+ * @param ticks Ticks.
+ * @return Nanoseconds.
+ */
+ULIB_PUBLIC
+utime_ns utrace_ticks_to_ns(utrace_tick ticks);
+
+/**
+ * Enables or disables recording. Recording is enabled by default.
+ *
+ * @param enabled True to enable recording, false to disable it.
+ */
+ULIB_PUBLIC
+void utrace_set_enabled(bool enabled);
+
+/**
+ * Checks whether recording is enabled.
+ *
+ * @return True if recording is enabled, false otherwise.
+ */
+ULIB_PUBLIC
+bool utrace_enabled(void);
+
+/**
+ * Records a completed span.
+ *
+ * @param name Name of the span. Must outlive the trace, e.g. a string literal.
+ * @param start Start of the span.
+ * @param end End of the span.
+ */
+ULIB_PUBLIC
+void utrace_record(char const *name, utrace_tick start, utrace_tick end);
+
+/**
+ * Begins a span.
+ *
+ * @param name Name of the span. Must outlive the trace, e.g. a string literal.
+ * @return Span.
+ */
+ULIB_INLINE
+UTraceSpan utrace_span_begin(char const *name) {
+    UTraceSpan span = { name, utrace_ticks() };
+    return span;
+}
+
+/**
+ * Ends and records a span.
+ *
+ * @param span Span.
+ */
+ULIB_INLINE
+void utrace_span_end(UTraceSpan const *span) {
+    utrace_record(span->name, span->start, utrace_ticks());
+}
+
+/**
+ * Traces the block following the macro.
+ *
+ * @param NAME [char const *] Name of the span. Must outlive the trace, e.g. a string literal.
+ *
+ * @warning Leaving the block via `break`, `goto` or `return` does not record the span.
+ */
+#define utrace_scope(NAME)                                                                         \
+    for (UTraceSpan p_utrace_span = utrace_span_begin(NAME); p_utrace_span.name;                   \
+         utrace_span_end(&p_utrace_span), p_utrace_span.name = NULL)
+
+/**
+ * Returns the number of events retained by all threads.
+ *
+ * @return Number of events.
+ */
+ULIB_PUBLIC
+ulib_uint utrace_count(void);
+
+/**
+ * Writes the retained events into the stream, in the Chrome trace event format,
+ * which can be loaded by `chrome://tracing` or Perfetto.
+ *
+ * @param stream Output stream.
+ * @param[out] written Number of bytes written.
+ * @return Return code.
+ *
+ * @note Threads can keep recording while exporting: only the events recorded before the export
+ *       of their thread starts are exported, and those overwritten in the meantime are skipped.
+ */
+ULIB_PUBLIC
+ustream_ret utrace_export_chrome(UOStream *stream, size_t *written);
+
+/**
+ * Discards all retained events.
+ *
+ * @note Buffers are kept, so that threads can keep recording spans without reallocating them,
+ *       and thread identifiers are preserved. Threads can keep recording while resetting,
+ *       in which case events recorded concurrently may or may not be discarded.
+ */
+ULIB_PUBLIC
+void utrace_reset(void);
+
+/// @}
+
+ULIB_END_DECLS
+
+#endif // UTRACE_H
@@ -16,6 +16,12 @@
 
 ULIB_BEGIN_DECLS
 
+/// @cond
+// Declared in uthread.h, which vectors do not otherwise depend on.
+ULIB_PUBLIC
+void uthread_run_parallel(void (*func)(void *ctx), void *ctx, size_t size, unsigned count);
+/// @endcond
+
 /**
  * A type safe, generic vector.
  * @struct UVec
@@ -43,8 +49,42 @@ typedef enum uvec_ret {
 #define UVEC_CACHE_LINE_SIZE 64
 #endif
 
-// Quicksort stack size.
-#define P_UVEC_SORT_STACK_SIZE 64
+/// Number of children of each node of heaps built by heap operations.
+#ifndef UVEC_HEAP_ARITY
+#define UVEC_HEAP_ARITY 2
+#endif
+
+/// Number of searches interleaved by batched search operations.
+#ifndef UVEC_SEARCH_BATCH_SIZE
+#define UVEC_SEARCH_BATCH_SIZE 8
+#endif
+
+/// Minimum number of elements processed by each thread in parallel operations.
+#ifndef UVEC_PARALLEL_MIN_CHUNK
+#define UVEC_PARALLEL_MIN_CHUNK 4096
+#endif
+
+/// Maximum number of threads used by parallel operations.
+#ifndef UVEC_PARALLEL_MAX_THREADS
+#define UVEC_PARALLEL_MAX_THREADS 64
+#endif
+
+// Ranges shorter than this are sorted via insertion sort.
+#define P_UVEC_SORT_INSERTION_THRESH 16
+
+// Set operations switch to galloping if one vector is this many times larger than the other.
+#define P_UVEC_GALLOP_RATIO 32
+
+/*
+ * Returns the number of chunks a parallel operation should split its input into.
+ *
+ * @param n [ulib_uint] Number of elements.
+ * @param threads [unsigned] Maximum number of threads.
+ * @return [ulib_uint] Number of chunks.
+ */
+#define p_uvec_parallel_chunks(n, threads)                                                         \
+    ulib_min(ulib_min((ulib_uint)(threads), (ulib_uint)UVEC_PARALLEL_MAX_THREADS),                 \
+             (ulib_uint)((n) / UVEC_PARALLEL_MIN_CHUNK))
 
 /*
  * Identity macro.
@@ -86,7 +126,7 @@ typedef enum uvec_ret {
  * @param T [symbol] Vector type.
  * @return Number of elements that can be stored inline.
  */
-#define p_uvec_inline_size(T) ((ulib_uint)(sizeof(void *) / sizeof(T)))
+#define p_uvec_inline_size(T) P_ULIB_MACRO_CONCAT(p_uvec_inline_size_, T)()
 
 /*
  * Returns the inline storage of the specified vector.
@@ -97,6 +137,66 @@ typedef enum uvec_ret {
  */
 #define p_uvec_inline_data(T, v) ((T *)&(v)->_data)
 
+/**
+ * Growth policy that expands the storage to the next power of two.
+ * This is the default growth policy.
+ *
+ * @param size [ulib_uint] Current storage size.
+ * @return [ulib_uint] New storage size.
+ */
+ULIB_INLINE ulib_uint uvec_growth_pow2(ulib_uint size) {
+    ulib_uint new_size = size;
+    ulib_uint_next_power_2(new_size);
+    return new_size == size ? size * 2 : new_size;
+}
+
+/**
+ * Growth policy that expands the storage by a factor of 1.5.
+ * It reduces the memory wasted by large vectors, at the cost of more frequent reallocations.
+ *
+ * @param size [ulib_uint] Current storage size.
+ * @return [ulib_uint] New storage size.
+ */
+ULIB_INLINE ulib_uint uvec_growth_1_5(ulib_uint size) {
+    return size + size / 2 + 1;
+}
+
+/*
+ * Defines the types and functions shared by all vector struct variants.
+ *
+ * @param T [symbol] Vector type.
+ * @param inline_size [ulib_uint] Number of elements that can be stored inline.
+ */
+#define P_UVEC_DEF_TYPE_COMMON(T, inline_size)                                                     \
+    /** @cond */                                                                                   \
+    typedef struct UVec_Loop_##T {                                                                 \
+        UVec(T) const *v;                                                                          \
+        T *item;                                                                                   \
+        ulib_uint i;                                                                               \
+    } UVec_Loop_##T;                                                                               \
+                                                                                                   \
+    static inline ulib_uint p_uvec_inline_size_##T(void) {                                         \
+        return (ulib_uint)(inline_size);                                                           \
+    }                                                                                              \
+    /** @endcond */
+
+/*
+ * Defines allocation functions that use the default allocator.
+ *
+ * @param T [symbol] Vector type.
+ */
+#define P_UVEC_DEF_ALLOC_DEFAULT(T)                                                                \
+    /** @cond */                                                                                   \
+    static inline void *p_uvec_alloc_##T(ulib_unused UVec_##T const *vec, void *ptr,               \
+                                         ulib_unused ulib_uint old_size, ulib_uint size) {         \
+        return ptr ? ulib_realloc(ptr, size * sizeof(T)) : ulib_malloc(size * sizeof(T));          \
+    }                                                                                              \
+                                                                                                   \
+    static inline void p_uvec_free_##T(ulib_unused UVec_##T const *vec, void *ptr) {               \
+        ulib_free(ptr);                                                                            \
+    }                                                                                              \
+    /** @endcond */
+
 /*
  * Defines a new vector struct.
  *
@@ -111,14 +211,71 @@ typedef enum uvec_ret {
         /** @endcond */                                                                            \
     } UVec_##T;                                                                                    \
                                                                                                    \
+    P_UVEC_DEF_TYPE_COMMON(T, sizeof(void *) / sizeof(T))                                          \
+    P_UVEC_DEF_ALLOC_DEFAULT(T)
+
+/*
+ * Defines a new vector struct with a per-instance allocator.
+ *
+ * @param T [symbol] Vector type.
+ */
+#define P_UVEC_DEF_TYPE_ALLOC(T)                                                                   \
+    typedef struct UVec_##T {                                                                      \
+        /** @cond */                                                                               \
+        ulib_uint _size;                                                                           \
+        ulib_uint _count;                                                                          \
+        T *_data;                                                                                  \
+        UAllocator const *_alloc;                                                                  \
+        /** @endcond */                                                                            \
+    } UVec_##T;                                                                                    \
+                                                                                                   \
+    P_UVEC_DEF_TYPE_COMMON(T, sizeof(void *) / sizeof(T))                                          \
+                                                                                                   \
     /** @cond */                                                                                   \
-    typedef struct UVec_Loop_##T {                                                                 \
-        UVec(T) const *v;                                                                          \
-        T *item;                                                                                   \
-        ulib_uint i;                                                                               \
-    } UVec_Loop_##T;                                                                               \
+    static inline void *p_uvec_alloc_##T(UVec_##T const *vec, void *ptr, ulib_uint old_size,       \
+                                         ulib_uint size) {                                         \
+        if (!vec->_alloc) {                                                                        \
+            return ptr ? ulib_realloc(ptr, size * sizeof(T)) : ulib_malloc(size * sizeof(T));      \
+        }                                                                                          \
+        return vec->_alloc->alloc(vec->_alloc->ctx, ptr, old_size * sizeof(T), size * sizeof(T));  \
+    }                                                                                              \
+                                                                                                   \
+    static inline void p_uvec_free_##T(UVec_##T const *vec, void *ptr) {                           \
+        if (vec->_alloc) {                                                                         \
+            vec->_alloc->dealloc(vec->_alloc->ctx, ptr, vec->_size * sizeof(T));                   \
+        } else {                                                                                   \
+            ulib_free(ptr);                                                                        \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static inline UVec_##T uvec_with_allocator_##T(UAllocator const *alloc) {                      \
+        UVec_##T vec = { 0 };                                                                      \
+        vec._alloc = alloc;                                                                        \
+        return vec;                                                                                \
+    }                                                                                              \
     /** @endcond */
 
+/*
+ * Defines a new vector struct with inline storage for at least N elements.
+ *
+ * @param T [symbol] Vector type.
+ * @param N [ulib_uint] Inline capacity.
+ */
+#define P_UVEC_DEF_TYPE_SBO(T, N)                                                                  \
+    typedef struct UVec_##T {                                                                      \
+        /** @cond */                                                                               \
+        ulib_uint _size;                                                                           \
+        ulib_uint _count;                                                                          \
+        union {                                                                                    \
+            T *_data;                                                                              \
+            T _inline[N];                                                                          \
+        };                                                                                         \
+        /** @endcond */                                                                            \
+    } UVec_##T;                                                                                    \
+                                                                                                   \
+    P_UVEC_DEF_TYPE_COMMON(T, (N) > sizeof(void *) / sizeof(T) ? (N) : sizeof(void *) / sizeof(T)) \
+    P_UVEC_DEF_ALLOC_DEFAULT(T)
+
 /*
  * Generates function declarations for the specified vector type.
  *
@@ -138,7 +295,14 @@ typedef enum uvec_ret {
     SCOPE T uvec_remove_at_##T(UVec_##T *vec, ulib_uint idx);                                      \
     SCOPE uvec_ret uvec_insert_at_##T(UVec_##T *vec, ulib_uint idx, T item);                       \
     SCOPE void uvec_remove_all_##T(UVec_##T *vec);                                                 \
+    SCOPE uvec_ret uvec_insert_range_at_##T(UVec_##T *vec, ulib_uint idx, T const *array,          \
+                                            ulib_uint n);                                          \
+    SCOPE ulib_uint uvec_remove_if_##T(UVec_##T *vec, bool (*pred)(T item, void *ctx), void *ctx); \
+    SCOPE ulib_uint uvec_retain_##T(UVec_##T *vec, bool (*pred)(T item, void *ctx), void *ctx);    \
     SCOPE void uvec_reverse_##T(UVec_##T *vec);                                                    \
+    SCOPE void uvec_foreach_parallel_##T(UVec_##T *vec, unsigned threads,                          \
+                                         void (*func)(T *items, ulib_uint n, void *ctx),           \
+                                         void *ctx);                                               \
     /** @endcond */
 
 /*
@@ -178,19 +342,22 @@ typedef enum uvec_ret {
                                                                                                    \
     SCOPE static inline void uvec_deinit_##T(UVec_##T *vec) {                                      \
         if (p_uvec_allocated(vec)) {                                                               \
-            ulib_free(vec->_data);                                                                 \
+            p_uvec_free_##T(vec, vec->_data);                                                      \
             vec->_data = NULL;                                                                     \
         }                                                                                          \
         vec->_count = vec->_size = 0;                                                              \
     }                                                                                              \
                                                                                                    \
     SCOPE static inline UVec_##T uvec_move_##T(UVec_##T *vec) {                                    \
-        UVec_##T temp = *vec, zero = { 0 };                                                        \
-        *vec = zero;                                                                               \
+        /* Per-instance state, such as the allocator, stays with the source. */                    \
+        UVec_##T temp = *vec;                                                                      \
+        vec->_size = vec->_count = 0;                                                              \
+        vec->_data = NULL;                                                                         \
         return temp;                                                                               \
     }                                                                                              \
                                                                                                    \
     SCOPE static inline uvec_ret uvec_expand_##T(UVec_##T *vec, ulib_uint size) {                  \
+        if (size > ULIB_UINT_MAX - vec->_count) return UVEC_ERR;                                   \
         return uvec_reserve_##T(vec, vec->_count + size);                                          \
     }                                                                                              \
                                                                                                    \
@@ -214,6 +381,7 @@ typedef enum uvec_ret {
     SCOPE ulib_uint uvec_index_of_##T(UVec_##T const *vec, T item);                                \
     SCOPE ulib_uint uvec_index_of_reverse_##T(UVec_##T const *vec, T item);                        \
     SCOPE bool uvec_remove_##T(UVec_##T *vec, T item);                                             \
+    SCOPE ulib_uint uvec_unique_sorted_##T(UVec_##T *vec);                                         \
     SCOPE bool uvec_equals_##T(UVec_##T const *vec, UVec_##T const *other);                        \
     SCOPE uvec_ret uvec_push_unique_##T(UVec_##T *vec, T item);                                    \
     /** @endcond */
@@ -242,11 +410,29 @@ typedef enum uvec_ret {
     SCOPE ulib_uint uvec_index_of_min_##T(UVec_##T const *vec);                                    \
     SCOPE ulib_uint uvec_index_of_max_##T(UVec_##T const *vec);                                    \
     SCOPE void uvec_sort_range_##T(UVec_##T *vec, ulib_uint start, ulib_uint len);                 \
+    SCOPE void uvec_sort_parallel_##T(UVec_##T *vec, unsigned threads);                            \
+    SCOPE void uvec_nth_element_##T(UVec_##T *vec, ulib_uint nth);                                 \
+    SCOPE void uvec_partial_sort_##T(UVec_##T *vec, ulib_uint k);                                  \
+    SCOPE void uvec_heapify_##T(UVec_##T *vec);                                                    \
+    SCOPE uvec_ret uvec_heap_push_##T(UVec_##T *vec, T item);                                      \
+    SCOPE T uvec_heap_pop_##T(UVec_##T *vec);                                                      \
+    SCOPE T uvec_heap_replace_top_##T(UVec_##T *vec, T item);                                      \
     SCOPE ulib_uint uvec_insertion_index_sorted_##T(UVec_##T const *vec, T item);                  \
     SCOPE ulib_uint uvec_index_of_sorted_##T(UVec_##T const *vec, T item);                         \
     SCOPE uvec_ret uvec_insert_sorted_##T(UVec_##T *vec, T item, ulib_uint *idx);                  \
     SCOPE uvec_ret uvec_insert_sorted_unique_##T(UVec_##T *vec, T item, ulib_uint *idx);           \
     SCOPE bool uvec_remove_sorted_##T(UVec_##T *vec, T item);                                      \
+    SCOPE void uvec_index_of_sorted_batch_##T(UVec_##T const *vec, T const *items, ulib_uint n,    \
+                                              ulib_uint *indices);                                 \
+    SCOPE uvec_ret uvec_to_eytzinger_##T(UVec_##T const *vec, UVec_##T *dest);                     \
+    SCOPE ulib_uint uvec_index_of_eytzinger_##T(UVec_##T const *vec, T item);                      \
+    SCOPE uvec_ret uvec_sorted_union_##T(UVec_##T const *vec, UVec_##T const *other,               \
+                                         UVec_##T *dest);                                          \
+    SCOPE uvec_ret uvec_sorted_intersect_##T(UVec_##T const *vec, UVec_##T const *other,           \
+                                             UVec_##T *dest);                                      \
+    SCOPE uvec_ret uvec_sorted_difference_##T(UVec_##T const *vec, UVec_##T const *other,          \
+                                              UVec_##T *dest);                                     \
+    SCOPE bool uvec_sorted_is_subset_##T(UVec_##T const *vec, UVec_##T const *other);              \
     /** @endcond */
 
 /*
@@ -263,24 +449,68 @@ typedef enum uvec_ret {
                                                                                                    \
     SCOPE static inline bool uvec_contains_sorted_##T(UVec_##T const *vec, T item) {               \
         return uvec_index_of_sorted_##T(vec, item) < vec->_count;                                  \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE static inline bool uvec_contains_eytzinger_##T(UVec_##T const *vec, T item) {            \
+        return uvec_index_of_eytzinger_##T(vec, item) < vec->_count;                               \
     }                                                                                              \
     /** @endcond */
 
 /*
- * Generates function definitions for the specified vector type.
+ * Generates a function returning the index of the first element of a sorted array
+ * that is not less than the specified item, or the number of elements if there is none.
+ *
+ * @param NAME [symbol] Function name.
+ * @param T [type] Element type.
+ * @param compare_func [(T, T) -> bool] Comparison function.
+ *
+ * @note Binary search narrows the range down to a cache line, which is then scanned linearly.
+ */
+#define P_UVEC_DEF_LOWER_BOUND(NAME, T, compare_func)                                              \
+    static inline ulib_uint NAME(T const *array, ulib_uint count, T item) {                        \
+        ulib_uint const linear_search_thresh = UVEC_CACHE_LINE_SIZE / sizeof(T);                   \
+        ulib_uint r = count, l = 0;                                                                \
+                                                                                                   \
+        while (r - l > linear_search_thresh) {                                                     \
+            ulib_uint m = l + (r - l) / 2;                                                         \
+            if (compare_func(array[m], item)) {                                                    \
+                l = m + 1;                                                                         \
+            } else {                                                                               \
+                r = m;                                                                             \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        for (; l < r && compare_func(array[l], item); ++l) {}                                      \
+        return l;                                                                                  \
+    }
+
+/*
+ * Generates the growth policy of the specified vector type.
+ *
+ * @param T [symbol] Vector type.
+ * @param growth_func [(ulib_uint) -> ulib_uint] Growth policy.
+ */
+#define P_UVEC_IMPL_GROWTH(T, growth_func)                                                         \
+    static inline ulib_uint p_uvec_grow_##T(ulib_uint size) {                                      \
+        return growth_func(size);                                                                  \
+    }
+
+/*
+ * Generates function definitions for the specified vector type,
+ * except for its growth policy.
  *
  * @param T [symbol] Vector type.
  * @param SCOPE [scope] Scope of the definitions.
  */
-#define P_UVEC_IMPL(T, SCOPE)                                                                      \
+#define P_UVEC_IMPL_BASE(T, SCOPE)                                                                 \
                                                                                                    \
     static inline uvec_ret uvec_resize_##T(UVec_##T *vec, ulib_uint size) {                        \
         T *data;                                                                                   \
                                                                                                    \
         if (p_uvec_allocated(vec)) {                                                               \
-            data = (T *)ulib_realloc(vec->_data, size * sizeof(T));                                \
+            data = (T *)p_uvec_alloc_##T(vec, vec->_data, vec->_size, size);                       \
         } else {                                                                                   \
-            data = (T *)ulib_malloc(size * sizeof(T));                                             \
+            data = (T *)p_uvec_alloc_##T(vec, NULL, 0, size);                                      \
         }                                                                                          \
                                                                                                    \
         if (!data) return UVEC_ERR;                                                                \
@@ -301,9 +531,7 @@ typedef enum uvec_ret {
         if (old_size == 0) {                                                                       \
             size = 1;                                                                              \
         } else {                                                                                   \
-            size = old_size;                                                                       \
-            ulib_uint_next_power_2(size);                                                          \
-            if (size == old_size) size *= 2;                                                       \
+            size = p_uvec_grow_##T(old_size);                                                      \
         }                                                                                          \
                                                                                                    \
         return uvec_resize_##T(vec, size);                                                         \
@@ -317,6 +545,7 @@ typedef enum uvec_ret {
                                       ulib_uint n) {                                               \
         if (!(n && array)) return UVEC_OK;                                                         \
         if (start > uvec_size_##T(vec)) return UVEC_NO;                                            \
+        if (n > ULIB_UINT_MAX - start) return UVEC_ERR;                                            \
                                                                                                    \
         ulib_uint const old_c = vec->_count, new_c = start + n;                                    \
                                                                                                    \
@@ -351,14 +580,14 @@ typedef enum uvec_ret {
             return UVEC_OK;                                                                        \
         }                                                                                          \
                                                                                                    \
-        if (vec->_count * sizeof(T) <= sizeof(T *)) {                                              \
+        if (vec->_count <= p_uvec_inline_size(T)) {                                                \
             if (p_uvec_inline(vec)) return UVEC_OK;                                                \
             T *old_data = vec->_data;                                                              \
             memcpy((T *)(&vec->_data), old_data, vec->_count * sizeof(T));                         \
-            ulib_free(old_data);                                                                   \
+            p_uvec_free_##T(vec, old_data);                                                        \
             vec->_size = 0;                                                                        \
         } else if (vec->_count < vec->_size) {                                                     \
-            T *data = (T *)ulib_realloc(vec->_data, vec->_count * sizeof(T));                      \
+            T *data = (T *)p_uvec_alloc_##T(vec, vec->_data, vec->_size, vec->_count);             \
             if (!data) return UVEC_ERR;                                                            \
                                                                                                    \
             vec->_size = vec->_count;                                                              \
@@ -410,6 +639,49 @@ typedef enum uvec_ret {
         vec->_count = 0;                                                                           \
     }                                                                                              \
                                                                                                    \
+    SCOPE uvec_ret uvec_insert_range_at_##T(UVec_##T *vec, ulib_uint idx, T const *array,          \
+                                            ulib_uint n) {                                         \
+        if (!n) return UVEC_OK;                                                                    \
+        if (uvec_reserve_##T(vec, vec->_count + n)) return UVEC_ERR;                               \
+        T *data = uvec_data(T, vec);                                                               \
+                                                                                                   \
+        if (idx < vec->_count) {                                                                   \
+            size_t block_size = (vec->_count - idx) * sizeof(T);                                   \
+            memmove(&(data[idx + n]), &(data[idx]), block_size);                                   \
+        }                                                                                          \
+                                                                                                   \
+        memcpy(&(data[idx]), array, n * sizeof(T));                                                \
+        vec->_count += n;                                                                          \
+                                                                                                   \
+        return UVEC_OK;                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    static inline ulib_uint p_uvec_filter_##T(UVec_##T *vec, bool (*pred)(T item, void *ctx),      \
+                                              void *ctx, bool keep) {                              \
+        T *data = uvec_data(T, vec);                                                               \
+        ulib_uint const count = vec->_count;                                                       \
+        ulib_uint i = 0;                                                                           \
+                                                                                                   \
+        while (i < count && pred(data[i], ctx) == keep) ++i;                                       \
+                                                                                                   \
+        for (ulib_uint j = i + 1; j < count; ++j) {                                                \
+            if (pred(data[j], ctx) == keep) data[i++] = data[j];                                   \
+        }                                                                                          \
+                                                                                                   \
+        vec->_count = i;                                                                           \
+        return count - vec->_count;                                                                \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE ulib_uint uvec_remove_if_##T(UVec_##T *vec, bool (*pred)(T item, void *ctx),             \
+                                       void *ctx) {                                                \
+        return p_uvec_filter_##T(vec, pred, ctx, false);                                           \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE ulib_uint uvec_retain_##T(UVec_##T *vec, bool (*pred)(T item, void *ctx),                \
+                                    void *ctx) {                                                   \
+        return p_uvec_filter_##T(vec, pred, ctx, true);                                            \
+    }                                                                                              \
+                                                                                                   \
     SCOPE void uvec_reverse_##T(UVec_##T *vec) {                                                   \
         T *data = uvec_data(T, vec);                                                               \
         for (ulib_uint i = 0; i < vec->_count / 2; ++i) {                                          \
@@ -418,17 +690,64 @@ typedef enum uvec_ret {
             data[i] = data[swap_idx];                                                              \
             data[swap_idx] = temp;                                                                 \
         }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    typedef struct P_UVecForeachTask_##T {                                                         \
+        T *items;                                                                                  \
+        ulib_uint n;                                                                               \
+        void (*func)(T *items, ulib_uint n, void *ctx);                                            \
+        void *ctx;                                                                                 \
+    } P_UVecForeachTask_##T;                                                                       \
+                                                                                                   \
+    static void p_uvec_foreach_task_##T(void *ctx) {                                               \
+        P_UVecForeachTask_##T *task = (P_UVecForeachTask_##T *)ctx;                                \
+        task->func(task->items, task->n, task->ctx);                                               \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE void uvec_foreach_parallel_##T(UVec_##T *vec, unsigned threads,                          \
+                                         void (*func)(T *items, ulib_uint n, void *ctx),           \
+                                         void *ctx) {                                              \
+        T *data = uvec_data(T, vec);                                                               \
+        ulib_uint const n = vec->_count;                                                           \
+        ulib_uint const chunks = p_uvec_parallel_chunks(n, threads);                               \
+                                                                                                   \
+        if (chunks < 2) {                                                                          \
+            if (n) func(data, n, ctx);                                                             \
+            return;                                                                                \
+        }                                                                                          \
+                                                                                                   \
+        P_UVecForeachTask_##T tasks[UVEC_PARALLEL_MAX_THREADS];                                    \
+        ulib_uint const chunk = n / chunks;                                                        \
+                                                                                                   \
+        for (ulib_uint i = 0; i < chunks; ++i) {                                                   \
+            tasks[i].items = data + i * chunk;                                                     \
+            tasks[i].n = i == chunks - 1 ? n - i * chunk : chunk;                                  \
+            tasks[i].func = func;                                                                  \
+            tasks[i].ctx = ctx;                                                                    \
+        }                                                                                          \
+                                                                                                   \
+        uthread_run_parallel(p_uvec_foreach_task_##T, tasks, sizeof(*tasks), (unsigned)chunks);    \
     }
 
 /*
- * Generates function definitions for the specified equatable vector type.
+ * Generates function definitions for the specified vector type.
+ *
+ * @param T [symbol] Vector type.
+ * @param SCOPE [scope] Scope of the definitions.
+ */
+#define P_UVEC_IMPL(T, SCOPE)                                                                      \
+    P_UVEC_IMPL_GROWTH(T, uvec_growth_pow2)                                                        \
+    P_UVEC_IMPL_BASE(T, SCOPE)
+
+/*
+ * Generates the definitions of the linear search functions for the specified equatable
+ * vector type.
  *
  * @param T [symbol] Vector type.
  * @param SCOPE [scope] Scope of the definitions.
  * @param equal_func [(T, T) -> bool] Equality function.
- * @param equal_func_is_identity [bool] If true, generated code assumes equal_func is ==.
  */
-#define P_UVEC_IMPL_EQUATABLE(T, SCOPE, equal_func, equal_func_is_identity)                        \
+#define P_UVEC_IMPL_SEARCH(T, SCOPE, equal_func)                                                   \
                                                                                                    \
     SCOPE ulib_uint uvec_index_of_##T(UVec_##T const *vec, T item) {                               \
         T *data = uvec_data(T, vec);                                                               \
@@ -444,7 +763,18 @@ typedef enum uvec_ret {
             if (equal_func(data[i], item)) return i;                                               \
         }                                                                                          \
         return vec->_count;                                                                        \
-    }                                                                                              \
+    }
+
+/*
+ * Generates function definitions for the specified equatable vector type,
+ * except for the linear search functions.
+ *
+ * @param T [symbol] Vector type.
+ * @param SCOPE [scope] Scope of the definitions.
+ * @param equal_func [(T, T) -> bool] Equality function.
+ * @param equal_func_is_identity [bool] If true, generated code assumes equal_func is ==.
+ */
+#define P_UVEC_IMPL_EQUATABLE_COMMON(T, SCOPE, equal_func, equal_func_is_identity)                 \
                                                                                                    \
     SCOPE bool uvec_remove_##T(UVec_##T *vec, T item) {                                            \
         ulib_uint idx = uvec_index_of_##T(vec, item);                                              \
@@ -457,6 +787,21 @@ typedef enum uvec_ret {
         return false;                                                                              \
     }                                                                                              \
                                                                                                    \
+    SCOPE ulib_uint uvec_unique_sorted_##T(UVec_##T *vec) {                                        \
+        ulib_uint const count = vec->_count;                                                       \
+        if (count < 2) return 0;                                                                   \
+                                                                                                   \
+        T *data = uvec_data(T, vec);                                                               \
+        ulib_uint i = 0;                                                                           \
+                                                                                                   \
+        for (ulib_uint j = 1; j < count; ++j) {                                                    \
+            if (!equal_func(data[i], data[j])) data[++i] = data[j];                                \
+        }                                                                                          \
+                                                                                                   \
+        vec->_count = i + 1;                                                                       \
+        return count - vec->_count;                                                                \
+    }                                                                                              \
+                                                                                                   \
     SCOPE bool uvec_equals_##T(UVec_##T const *vec, UVec_##T const *other) {                       \
         if (vec == other) return true;                                                             \
         if (vec->_count != other->_count) return false;                                            \
@@ -481,14 +826,26 @@ typedef enum uvec_ret {
     }
 
 /*
- * Generates function definitions for the specified comparable vector type.
+ * Generates function definitions for the specified equatable vector type.
+ *
+ * @param T [symbol] Vector type.
+ * @param SCOPE [scope] Scope of the definitions.
+ * @param equal_func [(T, T) -> bool] Equality function.
+ * @param equal_func_is_identity [bool] If true, generated code assumes equal_func is ==.
+ */
+#define P_UVEC_IMPL_EQUATABLE(T, SCOPE, equal_func, equal_func_is_identity)                        \
+    P_UVEC_IMPL_SEARCH(T, SCOPE, equal_func)                                                       \
+    P_UVEC_IMPL_EQUATABLE_COMMON(T, SCOPE, equal_func, equal_func_is_identity)
+
+/*
+ * Generates the definitions of the minimum and maximum search functions
+ * for the specified comparable vector type.
  *
  * @param T [symbol] Vector type.
  * @param SCOPE Scope of the definitions.
- * @param equal_func Equality function: (T, T) -> bool
  * @param compare_func Comparison function: (T, T) -> bool
  */
-#define P_UVEC_IMPL_COMPARABLE(T, SCOPE, equal_func, compare_func)                                 \
+#define P_UVEC_IMPL_MIN_MAX(T, SCOPE, compare_func)                                                \
                                                                                                    \
     SCOPE ulib_uint uvec_index_of_min_##T(UVec_##T const *vec) {                                   \
         ulib_uint min_idx = 0;                                                                     \
@@ -510,55 +867,358 @@ typedef enum uvec_ret {
         }                                                                                          \
                                                                                                    \
         return max_idx;                                                                            \
+    }
+
+/*
+ * Generates function definitions for the specified comparable vector type,
+ * except for the minimum and maximum search functions.
+ *
+ * @param T [symbol] Vector type.
+ * @param SCOPE Scope of the definitions.
+ * @param equal_func Equality function: (T, T) -> bool
+ * @param compare_func Comparison function: (T, T) -> bool
+ */
+#define P_UVEC_IMPL_COMPARABLE_COMMON(T, SCOPE, equal_func, compare_func)                          \
+                                                                                                   \
+    static inline void p_uvec_swap_##T(T *a, T *b) {                                               \
+        T temp = *a;                                                                               \
+        *a = *b;                                                                                   \
+        *b = temp;                                                                                 \
     }                                                                                              \
                                                                                                    \
-    SCOPE void uvec_sort_range_##T(UVec_##T *vec, ulib_uint start, ulib_uint len) {                \
-        T *array = uvec_data(T, vec) + start;                                                      \
-        start = 0;                                                                                 \
-        ulib_uint pos = 0, seed = 31, stack[P_UVEC_SORT_STACK_SIZE];                               \
+    static inline void p_uvec_insertion_sort_##T(T *array, ulib_uint len) {                        \
+        for (ulib_uint i = 1; i < len; ++i) {                                                      \
+            T item = array[i];                                                                     \
+            ulib_uint j = i;                                                                       \
+            for (; j > 0 && compare_func(item, array[j - 1]); --j) array[j] = array[j - 1];        \
+            array[j] = item;                                                                       \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static inline void p_uvec_sift_down_##T(T *array, ulib_uint i, ulib_uint len) {                \
+        T item = array[i];                                                                         \
+                                                                                                   \
+        for (ulib_uint child; (child = 2 * i + 1) < len; i = child) {                              \
+            if (child + 1 < len && compare_func(array[child], array[child + 1])) ++child;          \
+            if (!compare_func(item, array[child])) break;                                          \
+            array[i] = array[child];                                                               \
+        }                                                                                          \
+                                                                                                   \
+        array[i] = item;                                                                           \
+    }                                                                                              \
+                                                                                                   \
+    static inline void p_uvec_heap_sort_##T(T *array, ulib_uint len) {                             \
+        for (ulib_uint i = len / 2; i-- != 0;) p_uvec_sift_down_##T(array, i, len);                \
+        for (ulib_uint i = len; i-- > 1;) {                                                        \
+            p_uvec_swap_##T(array, array + i);                                                     \
+            p_uvec_sift_down_##T(array, 0, i);                                                     \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static inline void p_uvec_sort3_##T(T *a, T *b, T *c) {                                        \
+        if (compare_func(*b, *a)) p_uvec_swap_##T(a, b);                                           \
+        if (compare_func(*c, *b)) {                                                                \
+            p_uvec_swap_##T(b, c);                                                                 \
+            if (compare_func(*b, *a)) p_uvec_swap_##T(a, b);                                       \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    /*                                                                                             \
+     * Partitions the array around the median of three samples, returning the final position       \
+     * of the pivot. The array must contain at least three elements.                               \
+     */                                                                                            \
+    static inline ulib_uint p_uvec_partition_##T(T *array, ulib_uint len) {                        \
+        /*                                                                                         \
+         * Median of three, moved to the first position. The other two samples                     \
+         * act as sentinels, so the partitioning loops need no bounds checks.                      \
+         */                                                                                        \
+        ulib_uint const mid = len / 2;                                                             \
+        p_uvec_sort3_##T(array + 1, array + mid, array + len - 1);                                 \
+        p_uvec_swap_##T(array, array + mid);                                                       \
+                                                                                                   \
+        T pivot = array[0];                                                                        \
+        ulib_uint i = 0, j = len;                                                                  \
                                                                                                    \
         while (true) {                                                                             \
-            for (; start + 1 < len; ++len) {                                                       \
-                if (pos == P_UVEC_SORT_STACK_SIZE) len = stack[pos = 0];                           \
-                                                                                                   \
-                T pivot = array[start + seed % (len - start)];                                     \
-                seed = seed * 69069 + 1;                                                           \
-                stack[pos++] = len;                                                                \
-                                                                                                   \
-                for (ulib_uint right = start - 1;;) {                                              \
-                    p_ulib_analyzer_assert(false);                                                 \
-                    for (++right; compare_func(array[right], pivot); ++right) {}                   \
-                    for (--len; compare_func(pivot, array[len]); --len) {}                         \
-                    if (right >= len) break;                                                       \
-                                                                                                   \
-                    T temp = array[right];                                                         \
-                    array[right] = array[len];                                                     \
-                    array[len] = temp;                                                             \
+            p_ulib_analyzer_assert(false);                                                         \
+            while (compare_func(array[++i], pivot)) {}                                             \
+            while (compare_func(pivot, array[--j])) {}                                             \
+            if (i >= j) break;                                                                     \
+            p_uvec_swap_##T(array + i, array + j);                                                 \
+        }                                                                                          \
+                                                                                                   \
+        p_uvec_swap_##T(array, array + j);                                                         \
+        return j;                                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    static void p_uvec_introsort_##T(T *array, ulib_uint len, unsigned depth) {                    \
+        while (len > P_UVEC_SORT_INSERTION_THRESH) {                                               \
+            if (!depth--) {                                                                        \
+                p_uvec_heap_sort_##T(array, len);                                                  \
+                return;                                                                            \
+            }                                                                                      \
+                                                                                                   \
+            ulib_uint const j = p_uvec_partition_##T(array, len);                                  \
+                                                                                                   \
+            /* Recurse on the smaller partition, iterate on the larger one. */                     \
+            if (j < len - j - 1) {                                                                 \
+                p_uvec_introsort_##T(array, j, depth);                                             \
+                array += j + 1;                                                                    \
+                len -= j + 1;                                                                      \
+            } else {                                                                               \
+                p_uvec_introsort_##T(array + j + 1, len - j - 1, depth);                           \
+                len = j;                                                                           \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        p_uvec_insertion_sort_##T(array, len);                                                     \
+    }                                                                                              \
+                                                                                                   \
+    static void p_uvec_sort_##T(T *array, ulib_uint len) {                                         \
+        if (len < 2) return;                                                                       \
+                                                                                                   \
+        /* Already sorted and reverse sorted ranges are handled in linear time. */                 \
+        ulib_uint i = 1;                                                                           \
+        for (; i < len && !compare_func(array[i], array[i - 1]); ++i) {}                           \
+        if (i == len) return;                                                                      \
+                                                                                                   \
+        if (i == 1) {                                                                              \
+            for (; i < len && compare_func(array[i], array[i - 1]); ++i) {}                        \
+            if (i == len) {                                                                        \
+                for (ulib_uint l = 0, r = len - 1; l < r; ++l, --r) {                              \
+                    p_uvec_swap_##T(array + l, array + r);                                         \
                 }                                                                                  \
+                return;                                                                            \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        unsigned depth = 0;                                                                        \
+        for (ulib_uint n = len; n > 1; n >>= 1) depth += 2;                                        \
+        p_uvec_introsort_##T(array, len, depth);                                                   \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE void uvec_sort_range_##T(UVec_##T *vec, ulib_uint start, ulib_uint len) {                \
+        p_uvec_sort_##T(uvec_data(T, vec) + start, len);                                           \
+    }                                                                                              \
+                                                                                                   \
+    static void p_uvec_select_##T(T *array, ulib_uint len, ulib_uint nth) {                        \
+        unsigned depth = 0;                                                                        \
+        for (ulib_uint n = len; n > 1; n >>= 1) depth += 2;                                        \
+                                                                                                   \
+        while (len > P_UVEC_SORT_INSERTION_THRESH) {                                               \
+            if (!depth--) {                                                                        \
+                p_uvec_heap_sort_##T(array, len);                                                  \
+                return;                                                                            \
             }                                                                                      \
                                                                                                    \
-            if (pos == 0) break;                                                                   \
-            start = len;                                                                           \
-            len = stack[--pos];                                                                    \
+            ulib_uint const j = p_uvec_partition_##T(array, len);                                  \
+            if (j == nth) return;                                                                  \
+                                                                                                   \
+            if (nth < j) {                                                                         \
+                len = j;                                                                           \
+            } else {                                                                               \
+                array += j + 1;                                                                    \
+                len -= j + 1;                                                                      \
+                nth -= j + 1;                                                                      \
+            }                                                                                      \
         }                                                                                          \
+                                                                                                   \
+        p_uvec_insertion_sort_##T(array, len);                                                     \
     }                                                                                              \
                                                                                                    \
-    SCOPE ulib_uint uvec_insertion_index_sorted_##T(UVec_##T const *vec, T item) {                 \
-        T const *array = uvec_data(T, vec);                                                        \
-        ulib_uint const linear_search_thresh = UVEC_CACHE_LINE_SIZE / sizeof(T);                   \
-        ulib_uint r = vec->_count, l = 0;                                                          \
+    SCOPE void uvec_nth_element_##T(UVec_##T *vec, ulib_uint nth) {                                \
+        if (nth < vec->_count) p_uvec_select_##T(uvec_data(T, vec), vec->_count, nth);             \
+    }                                                                                              \
                                                                                                    \
-        while (r - l > linear_search_thresh) {                                                     \
-            ulib_uint m = l + (r - l) / 2;                                                         \
-            if (compare_func(array[m], item)) {                                                    \
-                l = m + 1;                                                                         \
+    SCOPE void uvec_partial_sort_##T(UVec_##T *vec, ulib_uint k) {                                 \
+        T *array = uvec_data(T, vec);                                                              \
+        if (k < vec->_count) p_uvec_select_##T(array, vec->_count, k);                             \
+        p_uvec_sort_##T(array, k < vec->_count ? k : vec->_count);                                 \
+    }                                                                                              \
+                                                                                                   \
+    static inline void p_uvec_heap_sift_up_##T(T *array, ulib_uint i) {                            \
+        T item = array[i];                                                                         \
+                                                                                                   \
+        while (i) {                                                                                \
+            ulib_uint const parent = (i - 1) / UVEC_HEAP_ARITY;                                    \
+            if (!compare_func(array[parent], item)) break;                                         \
+            array[i] = array[parent];                                                              \
+            i = parent;                                                                            \
+        }                                                                                          \
+                                                                                                   \
+        array[i] = item;                                                                           \
+    }                                                                                              \
+                                                                                                   \
+    static inline void p_uvec_heap_sift_down_##T(T *array, ulib_uint i, ulib_uint len) {           \
+        if (len < 2) return;                                                                       \
+        T item = array[i];                                                                         \
+                                                                                                   \
+        while (i <= (len - 2) / UVEC_HEAP_ARITY) {                                                 \
+            ulib_uint const first = i * UVEC_HEAP_ARITY + 1;                                       \
+            ulib_uint const last = len - first > UVEC_HEAP_ARITY ? first + UVEC_HEAP_ARITY : len;  \
+            ulib_uint child = first;                                                               \
+                                                                                                   \
+            for (ulib_uint c = first + 1; c < last; ++c) {                                         \
+                if (compare_func(array[child], array[c])) child = c;                               \
+            }                                                                                      \
+                                                                                                   \
+            if (!compare_func(item, array[child])) break;                                          \
+            array[i] = array[child];                                                               \
+            i = child;                                                                             \
+        }                                                                                          \
+                                                                                                   \
+        array[i] = item;                                                                           \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE void uvec_heapify_##T(UVec_##T *vec) {                                                   \
+        T *array = uvec_data(T, vec);                                                              \
+        ulib_uint const len = vec->_count;                                                         \
+        if (len < 2) return;                                                                       \
+        for (ulib_uint i = (len - 2) / UVEC_HEAP_ARITY + 1; i-- != 0;) {                           \
+            p_uvec_heap_sift_down_##T(array, i, len);                                              \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uvec_ret uvec_heap_push_##T(UVec_##T *vec, T item) {                                     \
+        if (uvec_push_##T(vec, item)) return UVEC_ERR;                                             \
+        p_uvec_heap_sift_up_##T(uvec_data(T, vec), vec->_count - 1);                               \
+        return UVEC_OK;                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE T uvec_heap_pop_##T(UVec_##T *vec) {                                                     \
+        T *array = uvec_data(T, vec);                                                              \
+        T top = array[0];                                                                          \
+        array[0] = array[--vec->_count];                                                           \
+        p_uvec_heap_sift_down_##T(array, 0, vec->_count);                                          \
+        return top;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE T uvec_heap_replace_top_##T(UVec_##T *vec, T item) {                                     \
+        T *array = uvec_data(T, vec);                                                              \
+        T top = array[0];                                                                          \
+        array[0] = item;                                                                           \
+        p_uvec_heap_sift_down_##T(array, 0, vec->_count);                                          \
+        return top;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    /*                                                                                             \
+     * Sorts a range if out is NULL, otherwise merges the sorted ranges a and b into out.          \
+     */                                                                                            \
+    typedef struct P_UVecSortTask_##T {                                                            \
+        T *a, *b, *out;                                                                            \
+        ulib_uint a_len, b_len;                                                                    \
+    } P_UVecSortTask_##T;                                                                          \
+                                                                                                   \
+    static void p_uvec_sort_task_##T(void *ctx) {                                                  \
+        P_UVecSortTask_##T *task = (P_UVecSortTask_##T *)ctx;                                      \
+        T *a = task->a, *b = task->b, *out = task->out;                                            \
+                                                                                                   \
+        if (!out) {                                                                                \
+            p_uvec_sort_##T(a, task->a_len);                                                       \
+            return;                                                                                \
+        }                                                                                          \
+                                                                                                   \
+        T *a_end = a + task->a_len, *b_end = b + task->b_len;                                      \
+        while (a < a_end && b < b_end) *out++ = compare_func(*b, *a) ? *b++ : *a++;                \
+        while (a < a_end) *out++ = *a++;                                                           \
+        while (b < b_end) *out++ = *b++;                                                           \
+    }                                                                                              \
+                                                                                                   \
+    /*                                                                                             \
+     * Returns how many elements of a precede the first d elements of the merge of a and b.        \
+     */                                                                                            \
+    static ulib_uint p_uvec_co_rank_##T(ulib_uint d, T const *a, ulib_uint a_len, T const *b,      \
+                                        ulib_uint b_len) {                                         \
+        ulib_uint lo = d > b_len ? d - b_len : 0, hi = d < a_len ? d : a_len;                      \
+                                                                                                   \
+        while (lo < hi) {                                                                          \
+            ulib_uint const i = lo + (hi - lo) / 2;                                                \
+            if (compare_func(b[d - i - 1], a[i])) {                                                \
+                hi = i;                                                                            \
             } else {                                                                               \
-                r = m;                                                                             \
+                lo = i + 1;                                                                        \
             }                                                                                      \
         }                                                                                          \
                                                                                                    \
-        for (; l < r && compare_func(array[l], item); ++l) {}                                      \
-        return l;                                                                                  \
+        return lo;                                                                                 \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE void uvec_sort_parallel_##T(UVec_##T *vec, unsigned threads) {                           \
+        T *array = uvec_data(T, vec);                                                              \
+        ulib_uint const n = vec->_count;                                                           \
+        ulib_uint const chunks = p_uvec_parallel_chunks(n, threads);                               \
+        T *tmp = chunks < 2 ? NULL : (T *)ulib_malloc(n * sizeof(*tmp));                           \
+                                                                                                   \
+        if (!tmp) {                                                                                \
+            p_uvec_sort_##T(array, n);                                                             \
+            return;                                                                                \
+        }                                                                                          \
+                                                                                                   \
+        P_UVecSortTask_##T tasks[UVEC_PARALLEL_MAX_THREADS];                                       \
+        ulib_uint runs[UVEC_PARALLEL_MAX_THREADS + 1];                                             \
+        ulib_uint const chunk = n / chunks;                                                        \
+                                                                                                   \
+        /* Sort each chunk on its own thread. */                                                   \
+        for (ulib_uint i = 0; i < chunks; ++i) {                                                   \
+            runs[i] = i * chunk;                                                                   \
+            tasks[i].a = array + runs[i];                                                          \
+            tasks[i].a_len = i == chunks - 1 ? n - runs[i] : chunk;                                \
+            tasks[i].b = tasks[i].out = NULL;                                                      \
+            tasks[i].b_len = 0;                                                                    \
+        }                                                                                          \
+                                                                                                   \
+        runs[chunks] = n;                                                                          \
+        uthread_run_parallel(p_uvec_sort_task_##T, tasks, sizeof(*tasks), (unsigned)chunks);       \
+                                                                                                   \
+        /*                                                                                         \
+         * Merge pairs of sorted runs until only one is left. Each merge is split                  \
+         * into independent parts, so that all threads are busy in every round.                    \
+         */                                                                                        \
+        T *src = array, *dst = tmp;                                                                \
+                                                                                                   \
+        for (ulib_uint r = chunks; r > 1; r = (r + 1) / 2) {                                       \
+            ulib_uint const parts = chunks / ((r + 1) / 2);                                        \
+            unsigned t = 0;                                                                        \
+                                                                                                   \
+            for (ulib_uint p = 0; p < r; p += 2) {                                                 \
+                T *a = src + runs[p], *b = src + runs[p + 1 < r ? p + 1 : r];                      \
+                T *out = dst + runs[p];                                                            \
+                ulib_uint const a_len = (ulib_uint)(b - a);                                        \
+                ulib_uint const b_len = p + 1 < r ? runs[p + 2] - runs[p + 1] : 0;                 \
+                ulib_uint const len = a_len + b_len;                                               \
+                ulib_uint const p_parts = b_len ? parts : 1;                                       \
+                                                                                                   \
+                for (ulib_uint q = 1, prev_i = 0, prev_d = 0; q <= p_parts; ++q) {                 \
+                    ulib_uint const d = q == p_parts ? len : len / p_parts * q;                    \
+                    ulib_uint const i = p_uvec_co_rank_##T(d, a, a_len, b, b_len);                 \
+                    tasks[t].a = a + prev_i;                                                       \
+                    tasks[t].a_len = i - prev_i;                                                   \
+                    tasks[t].b = b + (prev_d - prev_i);                                            \
+                    tasks[t].b_len = (d - i) - (prev_d - prev_i);                                  \
+                    tasks[t++].out = out + prev_d;                                                 \
+                    prev_i = i;                                                                    \
+                    prev_d = d;                                                                    \
+                }                                                                                  \
+                                                                                                   \
+                runs[p / 2] = runs[p];                                                             \
+            }                                                                                      \
+                                                                                                   \
+            runs[(r + 1) / 2] = n;                                                                 \
+            uthread_run_parallel(p_uvec_sort_task_##T, tasks, sizeof(*tasks), t);                  \
+                                                                                                   \
+            T *temp = src;                                                                         \
+            src = dst;                                                                             \
+            dst = temp;                                                                            \
+        }                                                                                          \
+                                                                                                   \
+        if (src != array) memcpy(array, src, n * sizeof(*array));                                  \
+        ulib_free(tmp);                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    P_UVEC_DEF_LOWER_BOUND(p_uvec_lower_bound_##T, T, compare_func)                                \
+                                                                                                   \
+    SCOPE ulib_uint uvec_insertion_index_sorted_##T(UVec_##T const *vec, T item) {                 \
+        return p_uvec_lower_bound_##T(uvec_data(T, vec), vec->_count, item);                       \
     }                                                                                              \
                                                                                                    \
     SCOPE ulib_uint uvec_index_of_sorted_##T(UVec_##T const *vec, T item) {                        \
@@ -593,35 +1253,414 @@ typedef enum uvec_ret {
         }                                                                                          \
                                                                                                    \
         return false;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE void uvec_index_of_sorted_batch_##T(UVec_##T const *vec, T const *items, ulib_uint n,    \
+                                              ulib_uint *indices) {                                \
+        T const *array = uvec_data(T, vec);                                                        \
+        ulib_uint const count = vec->_count;                                                       \
+        ulib_uint lo[UVEC_SEARCH_BATCH_SIZE];                                                      \
+                                                                                                   \
+        for (ulib_uint b = 0; b < n; b += UVEC_SEARCH_BATCH_SIZE) {                                \
+            ulib_uint const bn = n - b < UVEC_SEARCH_BATCH_SIZE ? n - b : UVEC_SEARCH_BATCH_SIZE;  \
+            T const *batch = items + b;                                                            \
+            ulib_uint len = count;                                                                 \
+                                                                                                   \
+            for (ulib_uint j = 0; j < bn; ++j) lo[j] = 0;                                          \
+                                                                                                   \
+            /* All the searches in a batch probe the same levels of the implicit tree, */          \
+            /* so their memory accesses overlap instead of being serialized. */                    \
+            while (len > 1) {                                                                      \
+                ulib_uint const half = len / 2;                                                    \
+                for (ulib_uint j = 0; j < bn; ++j) {                                               \
+                    lo[j] += compare_func(array[lo[j] + half - 1], batch[j]) ? half : 0;           \
+                }                                                                                  \
+                len -= half;                                                                       \
+                for (ulib_uint j = 0; j < bn; ++j) {                                               \
+                    p_ulib_prefetch(&array[lo[j] + len / 2 - (len > 1)]);                          \
+                }                                                                                  \
+            }                                                                                      \
+                                                                                                   \
+            for (ulib_uint j = 0; j < bn; ++j) {                                                   \
+                ulib_uint i = lo[j];                                                               \
+                if (len) i += compare_func(array[i], batch[j]);                                    \
+                indices[b + j] = i < count && equal_func(array[i], batch[j]) ? i : count;          \
+            }                                                                                      \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static ulib_uint p_uvec_eytzinger_fill_##T(T const *src, T *dst, ulib_uint n, ulib_uint i,     \
+                                               ulib_uint k) {                                      \
+        if (k > n) return i;                                                                       \
+        i = p_uvec_eytzinger_fill_##T(src, dst, n, i, 2 * k);                                      \
+        dst[k - 1] = src[i++];                                                                     \
+        return p_uvec_eytzinger_fill_##T(src, dst, n, i, 2 * k + 1);                               \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uvec_ret uvec_to_eytzinger_##T(UVec_##T const *vec, UVec_##T *dest) {                    \
+        ulib_uint const n = vec->_count;                                                           \
+        if (uvec_reserve_##T(dest, n)) return UVEC_ERR;                                            \
+        p_uvec_eytzinger_fill_##T(uvec_data(T, vec), uvec_data(T, dest), n, 0, 1);                 \
+        dest->_count = n;                                                                          \
+        return UVEC_OK;                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE ulib_uint uvec_index_of_eytzinger_##T(UVec_##T const *vec, T item) {                     \
+        T const *array = uvec_data(T, vec);                                                        \
+        ulib_uint const n = vec->_count;                                                           \
+        ulib_uint const line = UVEC_CACHE_LINE_SIZE / sizeof(T);                                   \
+        ulib_uint k = 1;                                                                           \
+                                                                                                   \
+        /* Branchless descent: node k has children 2k and 2k + 1 (1-based). */                     \
+        while (k <= n) {                                                                           \
+            ulib_uint const ahead = k * line;                                                      \
+            p_ulib_prefetch(&array[ahead && ahead <= n ? ahead - 1 : 0]);                          \
+            k = 2 * k + compare_func(array[k - 1], item);                                          \
+        }                                                                                          \
+                                                                                                   \
+        /* Drop the trailing right turns to get the lower bound. */                                \
+        while (k & 1) k >>= 1;                                                                     \
+        k >>= 1;                                                                                   \
+                                                                                                   \
+        return k && equal_func(array[k - 1], item) ? k - 1 : n;                                    \
+    }                                                                                              \
+                                                                                                   \
+    static inline ulib_uint p_uvec_gallop_##T(T const *array, ulib_uint lo, ulib_uint n, T item) { \
+        ulib_uint hi = lo, step = 1;                                                               \
+                                                                                                   \
+        while (hi < n && compare_func(array[hi], item)) {                                          \
+            lo = hi + 1;                                                                           \
+            hi = n - hi > step ? hi + step : n;                                                    \
+            step <<= 1;                                                                            \
+        }                                                                                          \
+                                                                                                   \
+        while (lo < hi) {                                                                          \
+            ulib_uint const m = lo + (hi - lo) / 2;                                                \
+            if (compare_func(array[m], item)) {                                                    \
+                lo = m + 1;                                                                        \
+            } else {                                                                               \
+                hi = m;                                                                            \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        return lo;                                                                                 \
+    }                                                                                              \
+                                                                                                   \
+    static inline bool p_uvec_skewed_##T(ulib_uint small, ulib_uint large) {                       \
+        return large / P_UVEC_GALLOP_RATIO > small;                                                \
+    }                                                                                              \
+                                                                                                   \
+    static ulib_uint p_uvec_sorted_intersect_merge_##T(T const *a, ulib_uint na, T const *b,       \
+                                                       ulib_uint nb, T *out) {                     \
+        ulib_uint i = 0, j = 0, k = 0;                                                             \
+                                                                                                   \
+        while (i < na && j < nb) {                                                                 \
+            if (compare_func(a[i], b[j])) {                                                        \
+                ++i;                                                                               \
+            } else if (compare_func(b[j], a[i])) {                                                 \
+                ++j;                                                                               \
+            } else {                                                                               \
+                out[k++] = a[i++];                                                                 \
+                ++j;                                                                               \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        return k;                                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    static uvec_ret p_uvec_sorted_intersect_##T(UVec_##T const *vec, UVec_##T const *other,        \
+                                                UVec_##T *dest,                                    \
+                                                ulib_uint (*merge)(T const *, ulib_uint,           \
+                                                                   T const *, ulib_uint, T *)) {   \
+        if (vec->_count > other->_count) {                                                         \
+            UVec_##T const *temp = vec;                                                            \
+            vec = other;                                                                           \
+            other = temp;                                                                          \
+        }                                                                                          \
+                                                                                                   \
+        ulib_uint const na = vec->_count, nb = other->_count;                                      \
+        if (uvec_reserve_##T(dest, na)) return UVEC_ERR;                                           \
+                                                                                                   \
+        T const *a = uvec_data(T, vec), *b = uvec_data(T, other);                                  \
+        T *out = uvec_data(T, dest);                                                               \
+        ulib_uint k = 0;                                                                           \
+                                                                                                   \
+        if (p_uvec_skewed_##T(na, nb)) {                                                           \
+            for (ulib_uint i = 0, j = 0; i < na && j < nb; ++i) {                                  \
+                j = p_uvec_gallop_##T(b, j, nb, a[i]);                                             \
+                if (j < nb && equal_func(a[i], b[j])) out[k++] = b[j++];                           \
+            }                                                                                      \
+        } else {                                                                                   \
+            k = merge(a, na, b, nb, out);                                                          \
+        }                                                                                          \
+                                                                                                   \
+        dest->_count = k;                                                                          \
+        return UVEC_OK;                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uvec_ret uvec_sorted_union_##T(UVec_##T const *vec, UVec_##T const *other,               \
+                                         UVec_##T *dest) {                                         \
+        if (vec->_count < other->_count) {                                                         \
+            UVec_##T const *temp = vec;                                                            \
+            vec = other;                                                                           \
+            other = temp;                                                                          \
+        }                                                                                          \
+                                                                                                   \
+        ulib_uint const na = vec->_count, nb = other->_count;                                      \
+        if (na + nb < na || uvec_reserve_##T(dest, na + nb)) return UVEC_ERR;                      \
+                                                                                                   \
+        T const *a = uvec_data(T, vec), *b = uvec_data(T, other);                                  \
+        T *out = uvec_data(T, dest);                                                               \
+        ulib_uint i = 0, j = 0, k = 0;                                                             \
+                                                                                                   \
+        if (p_uvec_skewed_##T(nb, na)) {                                                           \
+            /* Copy the runs of the larger vector between elements of the smaller one. */          \
+            for (; j < nb; ++j) {                                                                  \
+                ulib_uint const next = p_uvec_gallop_##T(a, i, na, b[j]);                          \
+                memcpy(out + k, a + i, (next - i) * sizeof(T));                                    \
+                k += next - i;                                                                     \
+                i = next;                                                                          \
+                if (i < na && equal_func(a[i], b[j])) ++i;                                         \
+                out[k++] = b[j];                                                                   \
+            }                                                                                      \
+        } else {                                                                                   \
+            while (i < na && j < nb) {                                                             \
+                if (compare_func(a[i], b[j])) {                                                    \
+                    out[k++] = a[i++];                                                             \
+                } else if (compare_func(b[j], a[i])) {                                             \
+                    out[k++] = b[j++];                                                             \
+                } else {                                                                           \
+                    out[k++] = a[i++];                                                             \
+                    ++j;                                                                           \
+                }                                                                                  \
+            }                                                                                      \
+            memcpy(out + k, b + j, (nb - j) * sizeof(T));                                          \
+            k += nb - j;                                                                           \
+        }                                                                                          \
+                                                                                                   \
+        memcpy(out + k, a + i, (na - i) * sizeof(T));                                              \
+        dest->_count = k + na - i;                                                                 \
+        return UVEC_OK;                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE uvec_ret uvec_sorted_difference_##T(UVec_##T const *vec, UVec_##T const *other,          \
+                                              UVec_##T *dest) {                                    \
+        ulib_uint const na = vec->_count, nb = other->_count;                                      \
+        if (uvec_reserve_##T(dest, na)) return UVEC_ERR;                                           \
+                                                                                                   \
+        T const *a = uvec_data(T, vec), *b = uvec_data(T, other);                                  \
+        T *out = uvec_data(T, dest);                                                               \
+        ulib_uint i = 0, j = 0, k = 0;                                                             \
+                                                                                                   \
+        if (p_uvec_skewed_##T(na, nb)) {                                                           \
+            for (; i < na; ++i) {                                                                  \
+                j = p_uvec_gallop_##T(b, j, nb, a[i]);                                             \
+                if (j == nb || !equal_func(a[i], b[j])) out[k++] = a[i];                           \
+            }                                                                                      \
+        } else if (p_uvec_skewed_##T(nb, na)) {                                                    \
+            for (; j < nb; ++j) {                                                                  \
+                ulib_uint const next = p_uvec_gallop_##T(a, i, na, b[j]);                          \
+                memcpy(out + k, a + i, (next - i) * sizeof(T));                                    \
+                k += next - i;                                                                     \
+                i = next;                                                                          \
+                if (i < na && equal_func(a[i], b[j])) ++i;                                         \
+            }                                                                                      \
+        } else {                                                                                   \
+            while (i < na && j < nb) {                                                             \
+                if (compare_func(a[i], b[j])) {                                                    \
+                    out[k++] = a[i++];                                                             \
+                } else if (compare_func(b[j], a[i])) {                                             \
+                    ++j;                                                                           \
+                } else {                                                                           \
+                    ++i;                                                                           \
+                    ++j;                                                                           \
+                }                                                                                  \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        memcpy(out + k, a + i, (na - i) * sizeof(T));                                              \
+        dest->_count = k + na - i;                                                                 \
+        return UVEC_OK;                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    SCOPE bool uvec_sorted_is_subset_##T(UVec_##T const *vec, UVec_##T const *other) {             \
+        ulib_uint const na = vec->_count, nb = other->_count;                                      \
+        if (na > nb) return false;                                                                 \
+                                                                                                   \
+        T const *a = uvec_data(T, vec), *b = uvec_data(T, other);                                  \
+        ulib_uint i = 0, j = 0;                                                                    \
+                                                                                                   \
+        if (p_uvec_skewed_##T(na, nb)) {                                                           \
+            for (; i < na; ++i, ++j) {                                                             \
+                j = p_uvec_gallop_##T(b, j, nb, a[i]);                                             \
+                if (j == nb || !equal_func(a[i], b[j])) return false;                              \
+            }                                                                                      \
+            return true;                                                                           \
+        }                                                                                          \
+                                                                                                   \
+        while (i < na) {                                                                           \
+            if (na - i > nb - j) return false;                                                     \
+            if (compare_func(b[j], a[i])) {                                                        \
+                ++j;                                                                               \
+            } else if (compare_func(a[i], b[j])) {                                                 \
+                return false;                                                                      \
+            } else {                                                                               \
+                ++i;                                                                               \
+                ++j;                                                                               \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        return true;                                                                               \
     }
 
+/*
+ * Generates the sorted intersection function for the specified comparable vector type.
+ *
+ * @param T [symbol] Vector type.
+ * @param SCOPE [scope] Scope of the definitions.
+ */
+#define P_UVEC_IMPL_SORTED_INTERSECT(T, SCOPE)                                                     \
+    SCOPE uvec_ret uvec_sorted_intersect_##T(UVec_##T const *vec, UVec_##T const *other,           \
+                                             UVec_##T *dest) {                                     \
+        return p_uvec_sorted_intersect_##T(vec, other, dest, p_uvec_sorted_intersect_merge_##T);   \
+    }
+
+/*
+ * Generates function definitions for the specified comparable vector type.
+ *
+ * @param T [symbol] Vector type.
+ * @param SCOPE Scope of the definitions.
+ * @param equal_func Equality function: (T, T) -> bool
+ * @param compare_func Comparison function: (T, T) -> bool
+ */
+#define P_UVEC_IMPL_COMPARABLE(T, SCOPE, equal_func, compare_func)                                 \
+    P_UVEC_IMPL_MIN_MAX(T, SCOPE, compare_func)                                                    \
+    P_UVEC_IMPL_COMPARABLE_COMMON(T, SCOPE, equal_func, compare_func)                              \
+    P_UVEC_IMPL_SORTED_INTERSECT(T, SCOPE)
+
 /// @name Type definitions
 
 /**
- * Declares a new vector type.
+ * Declares a new vector type.
+ *
+ * @param T [symbol] Vector type.
+ *
+ * @public @related UVec
+ */
+#define UVEC_DECL(T)                                                                               \
+    P_UVEC_DEF_TYPE(T)                                                                             \
+    P_UVEC_DECL(T, ulib_unused)                                                                    \
+    P_UVEC_DEF_INLINE(T, ulib_unused)
+
+/**
+ * Declares a new vector type, prepending a specifier to the generated declarations.
+ *
+ * @param T [symbol] Vector type.
+ * @param SPEC [specifier] Specifier.
+ *
+ * @public @related UVec
+ */
+#define UVEC_DECL_SPEC(T, SPEC)                                                                    \
+    P_UVEC_DEF_TYPE(T)                                                                             \
+    P_UVEC_DECL(T, SPEC ulib_unused)                                                               \
+    P_UVEC_DEF_INLINE(T, ulib_unused)
+
+/**
+ * Declares a new vector type with a per-instance allocator.
+ *
+ * @param T [symbol] Vector type.
+ *
+ * @note Instances created via uvec(T) use the default allocator,
+ *       while those created via uvec_with_allocator(T) use the specified one.
+ *
+ * @public @related UVec
+ */
+#define UVEC_DECL_ALLOC(T)                                                                         \
+    P_UVEC_DEF_TYPE_ALLOC(T)                                                                       \
+    P_UVEC_DECL(T, ulib_unused)                                                                    \
+    P_UVEC_DEF_INLINE(T, ulib_unused)
+
+/**
+ * Declares a new vector type with a per-instance allocator,
+ * prepending a specifier to the generated declarations.
+ *
+ * @param T [symbol] Vector type.
+ * @param SPEC [specifier] Specifier.
+ *
+ * @public @related UVec
+ */
+#define UVEC_DECL_ALLOC_SPEC(T, SPEC)                                                              \
+    P_UVEC_DEF_TYPE_ALLOC(T)                                                                       \
+    P_UVEC_DECL(T, SPEC ulib_unused)                                                               \
+    P_UVEC_DEF_INLINE(T, ulib_unused)
+
+/**
+ * Declares a new vector type with inline storage for at least N elements.
  *
  * @param T [symbol] Vector type.
+ * @param N [ulib_uint] Inline capacity.
+ *
+ * @note Vectors store their elements inline, without allocating, as long as their
+ *       count does not exceed N. Use the regular UVEC_IMPL* macros to implement the type.
  *
  * @public @related UVec
  */
-#define UVEC_DECL(T)                                                                               \
-    P_UVEC_DEF_TYPE(T)                                                                             \
+#define UVEC_DECL_SBO(T, N)                                                                        \
+    P_UVEC_DEF_TYPE_SBO(T, N)                                                                      \
     P_UVEC_DECL(T, ulib_unused)                                                                    \
     P_UVEC_DEF_INLINE(T, ulib_unused)
 
 /**
- * Declares a new vector type, prepending a specifier to the generated declarations.
+ * Declares a new vector type with inline storage for at least N elements,
+ * prepending a specifier to the generated declarations.
  *
  * @param T [symbol] Vector type.
+ * @param N [ulib_uint] Inline capacity.
  * @param SPEC [specifier] Specifier.
  *
  * @public @related UVec
  */
-#define UVEC_DECL_SPEC(T, SPEC)                                                                    \
-    P_UVEC_DEF_TYPE(T)                                                                             \
+#define UVEC_DECL_SBO_SPEC(T, N, SPEC)                                                             \
+    P_UVEC_DEF_TYPE_SBO(T, N)                                                                      \
     P_UVEC_DECL(T, SPEC ulib_unused)                                                               \
     P_UVEC_DEF_INLINE(T, ulib_unused)
 
+/**
+ * Declares a new comparable vector type with inline storage for at least N elements.
+ *
+ * @param T [symbol] Vector type.
+ * @param N [ulib_uint] Inline capacity.
+ *
+ * @public @related UVec
+ */
+#define UVEC_DECL_SBO_COMPARABLE(T, N)                                                             \
+    P_UVEC_DEF_TYPE_SBO(T, N)                                                                      \
+    P_UVEC_DECL(T, ulib_unused)                                                                    \
+    P_UVEC_DECL_EQUATABLE(T, ulib_unused)                                                          \
+    P_UVEC_DECL_COMPARABLE(T, ulib_unused)                                                         \
+    P_UVEC_DEF_INLINE(T, ulib_unused)                                                              \
+    P_UVEC_DEF_INLINE_EQUATABLE(T, ulib_unused)                                                    \
+    P_UVEC_DEF_INLINE_COMPARABLE(T, ulib_unused)
+
+/**
+ * Declares a new comparable vector type with inline storage for at least N elements,
+ * prepending a specifier to the generated declarations.
+ *
+ * @param T [symbol] Vector type.
+ * @param N [ulib_uint] Inline capacity.
+ * @param SPEC [specifier] Specifier.
+ *
+ * @public @related UVec
+ */
+#define UVEC_DECL_SBO_COMPARABLE_SPEC(T, N, SPEC)                                                  \
+    P_UVEC_DEF_TYPE_SBO(T, N)                                                                      \
+    P_UVEC_DECL(T, SPEC ulib_unused)                                                               \
+    P_UVEC_DECL_EQUATABLE(T, SPEC ulib_unused)                                                     \
+    P_UVEC_DECL_COMPARABLE(T, SPEC ulib_unused)                                                    \
+    P_UVEC_DEF_INLINE(T, ulib_unused)                                                              \
+    P_UVEC_DEF_INLINE_EQUATABLE(T, ulib_unused)                                                    \
+    P_UVEC_DEF_INLINE_COMPARABLE(T, ulib_unused)
+
 /**
  * Declares a new equatable vector type.
  *
@@ -693,6 +1732,19 @@ typedef enum uvec_ret {
  */
 #define UVEC_IMPL(T) P_UVEC_IMPL(T, ulib_unused)
 
+/**
+ * Implements a previously declared vector type with a per-instance allocator.
+ *
+ * @param T [symbol] Vector type.
+ * @param growth_func [(ulib_uint) -> ulib_uint] Growth policy, e.g. uvec_growth_pow2
+ *                    or uvec_growth_1_5.
+ *
+ * @public @related UVec
+ */
+#define UVEC_IMPL_ALLOC(T, growth_func)                                                            \
+    P_UVEC_IMPL_GROWTH(T, growth_func)                                                             \
+    P_UVEC_IMPL_BASE(T, ulib_unused)
+
 /**
  * Implements a previously declared equatable vector type.
  * Elements of an equatable vector can be checked for equality via equal_func.
@@ -748,6 +1800,36 @@ typedef enum uvec_ret {
     P_UVEC_DEF_INLINE(T, ulib_unused)                                                              \
     P_UVEC_IMPL(T, static inline ulib_unused)
 
+/**
+ * Defines a new static vector type with a per-instance allocator.
+ *
+ * @param T [symbol] Vector type.
+ * @param growth_func [(ulib_uint) -> ulib_uint] Growth policy, e.g. uvec_growth_pow2
+ *                    or uvec_growth_1_5.
+ *
+ * @public @related UVec
+ */
+#define UVEC_INIT_ALLOC(T, growth_func)                                                            \
+    P_UVEC_DEF_TYPE_ALLOC(T)                                                                       \
+    P_UVEC_DECL(T, static inline ulib_unused)                                                      \
+    P_UVEC_DEF_INLINE(T, ulib_unused)                                                              \
+    P_UVEC_IMPL_GROWTH(T, growth_func)                                                             \
+    P_UVEC_IMPL_BASE(T, static inline ulib_unused)
+
+/**
+ * Defines a new static vector type with inline storage for at least N elements.
+ *
+ * @param T [symbol] Vector type.
+ * @param N [ulib_uint] Inline capacity.
+ *
+ * @public @related UVec
+ */
+#define UVEC_INIT_SBO(T, N)                                                                        \
+    P_UVEC_DEF_TYPE_SBO(T, N)                                                                      \
+    P_UVEC_DECL(T, static inline ulib_unused)                                                      \
+    P_UVEC_DEF_INLINE(T, ulib_unused)                                                              \
+    P_UVEC_IMPL(T, static inline ulib_unused)
+
 /**
  * Defines a new static equatable vector type.
  *
@@ -838,6 +1920,19 @@ typedef enum uvec_ret {
  */
 #define uvec(T) P_ULIB_MACRO_CONCAT(uvec_, T)()
 
+/**
+ * Initializes a new vector that uses the specified allocator.
+ *
+ * @param T [symbol] Vector type, declared via UVEC_DECL_ALLOC or UVEC_INIT_ALLOC.
+ * @param alloc [UAllocator const*] Allocator, or NULL to use the default allocator.
+ * @return [UVec(T)] Initialized vector instance.
+ *
+ * @note The allocator must outlive the vector.
+ *
+ * @public @related UVec
+ */
+#define uvec_with_allocator(T, alloc) P_ULIB_MACRO_CONCAT(uvec_with_allocator_, T)(alloc)
+
 /**
  * De-initializes a vector previously initialized via uvec(T).
  *
@@ -855,6 +1950,8 @@ typedef enum uvec_ret {
  * @param vec [UVec(T)*] Vector whose storage should be returned.
  * @return [UVec(T)] Vector storage.
  *
+ * @note The source vector is left empty, and keeps its allocator (see uvec_with_allocator).
+ *
  * @public @related UVec
  */
 #define uvec_move(T, vec) P_ULIB_MACRO_CONCAT(uvec_move_, T)(vec)
@@ -1072,6 +2169,55 @@ typedef enum uvec_ret {
  */
 #define uvec_remove_all(T, vec) P_ULIB_MACRO_CONCAT(uvec_remove_all_, T)(vec)
 
+/**
+ * Inserts the elements of an array at the specified index.
+ *
+ * @param T [symbol] Vector type.
+ * @param vec [UVec(T)*] Vector instance.
+ * @param idx [ulib_uint] Index at which the elements should be inserted.
+ * @param array [T*] Array to insert.
+ * @param n [ulib_uint] Number of elements to insert.
+ * @return [uvec_ret] UVEC_OK on success, otherwise UVEC_ERR.
+ *
+ * @note The array must not point to the storage of the vector.
+ * @note Elements following the insertion point are moved only once.
+ *
+ * @public @related UVec
+ */
+#define uvec_insert_range_at(T, vec, idx, array, n)                                                \
+    P_ULIB_MACRO_CONCAT(uvec_insert_range_at_, T)(vec, idx, array, n)
+
+/**
+ * Removes the elements that satisfy the specified predicate, preserving the order
+ * of the remaining elements.
+ *
+ * @param T [symbol] Vector type.
+ * @param vec [UVec(T)*] Vector instance.
+ * @param pred [(T, void *) -> bool] Predicate.
+ * @param ctx [void*] Context passed to the predicate.
+ * @return [ulib_uint] Number of removed elements.
+ *
+ * @note The vector is compacted in a single pass.
+ *
+ * @public @related UVec
+ */
+#define uvec_remove_if(T, vec, pred, ctx) P_ULIB_MACRO_CONCAT(uvec_remove_if_, T)(vec, pred, ctx)
+
+/**
+ * Retains only the elements that satisfy the specified predicate, preserving their order.
+ *
+ * @param T [symbol] Vector type.
+ * @param vec [UVec(T)*] Vector instance.
+ * @param pred [(T, void *) -> bool] Predicate.
+ * @param ctx [void*] Context passed to the predicate.
+ * @return [ulib_uint] Number of removed elements.
+ *
+ * @note The vector is compacted in a single pass.
+ *
+ * @public @related UVec
+ */
+#define uvec_retain(T, vec, pred, ctx) P_ULIB_MACRO_CONCAT(uvec_retain_, T)(vec, pred, ctx)
+
 /**
  * Appends a vector to another.
  *
@@ -1206,6 +2352,24 @@ typedef enum uvec_ret {
 
 // clang-format on
 
+/**
+ * Processes the vector in contiguous chunks, using multiple threads.
+ *
+ * @param T [symbol] Vector type.
+ * @param vec [UVec(T)*] Vector instance.
+ * @param threads [unsigned] Maximum number of threads.
+ * @param func [void (*)(T *items, ulib_uint n, void *ctx)] Function called for each chunk.
+ * @param ctx [void*] Context passed to the function.
+ *
+ * @note Every chunk holds at least UVEC_PARALLEL_MIN_CHUNK elements, except if the vector
+ *       is processed as a single chunk. Chunks are processed concurrently, so the function
+ *       must synchronize access to any shared state.
+ *
+ * @public @related UVec
+ */
+#define uvec_foreach_parallel(T, vec, threads, func, ctx)                                          \
+    P_ULIB_MACRO_CONCAT(uvec_foreach_parallel_, T)(vec, threads, func, ctx)
+
 /// @name Equatable
 
 /**
@@ -1259,6 +2423,19 @@ typedef enum uvec_ret {
  */
 #define uvec_remove(T, vec, item) P_ULIB_MACRO_CONCAT(uvec_remove_, T)(vec, item)
 
+/**
+ * Removes consecutive duplicate elements, keeping the first element of each run.
+ *
+ * @param T [symbol] Vector type.
+ * @param vec [UVec(T)*] Vector instance.
+ * @return [ulib_uint] Number of removed elements.
+ *
+ * @note If the vector is sorted, it contains no duplicates after this call.
+ *
+ * @public @related UVec
+ */
+#define uvec_unique_sorted(T, vec) P_ULIB_MACRO_CONCAT(uvec_unique_sorted_, T)(vec)
+
 /**
  * Checks whether the two vectors are equal.
  * Two vectors are considered equal if they contain the same elements in the same order.
@@ -1320,6 +2497,26 @@ typedef enum uvec_ret {
  */
 #define uvec_sort(T, vec) P_ULIB_MACRO_CONCAT(uvec_sort_, T)(vec)
 
+/**
+ * Sorts the vector using multiple threads.
+ * Average performance: O(n log n)
+ *
+ * @param T [symbol] Vector type.
+ * @param vec [UVec(T)*] Vector instance.
+ * @param threads [unsigned] Maximum number of threads.
+ *
+ * @note The vector is split into sorted runs, one per thread, which are then merged.
+ *       Every thread processes at least UVEC_PARALLEL_MIN_CHUNK elements, and the sort
+ *       falls back to uvec_sort if no more than one thread would be used, or if
+ *       the temporary buffer needed for merging cannot be allocated.
+ *       If threads are disabled (`ULIB_NO_THREADS` is defined), all work is done
+ *       on the calling thread.
+ *
+ * @public @related UVec
+ */
+#define uvec_sort_parallel(T, vec, threads)                                                        \
+    P_ULIB_MACRO_CONCAT(uvec_sort_parallel_, T)(vec, threads)
+
 /**
  * Sorts the elements in the specified range.
  * Average performance: O(n log n)
@@ -1334,6 +2531,90 @@ typedef enum uvec_ret {
 #define uvec_sort_range(T, vec, start, len)                                                        \
     P_ULIB_MACRO_CONCAT(uvec_sort_range_, T)(vec, start, len)
 
+/**
+ * Partially sorts the vector, so that the element at the specified index is the one that
+ * would be there if the vector was sorted, and the elements preceding it are not greater
+ * than those following it.
+ * Average performance: O(n)
+ *
+ * @param T [symbol] Vector type.
+ * @param vec [UVec(T)*] Vector instance.
+ * @param nth [ulib_uint] Index of the element.
+ *
+ * @public @related UVec
+ */
+#define uvec_nth_element(T, vec, nth) P_ULIB_MACRO_CONCAT(uvec_nth_element_, T)(vec, nth)
+
+/**
+ * Partially sorts the vector, so that its first k elements are its k smallest elements,
+ * in sorted order.
+ * Average performance: O(n + k log k)
+ *
+ * @param T [symbol] Vector type.
+ * @param vec [UVec(T)*] Vector instance.
+ * @param k [ulib_uint] Number of elements to sort.
+ *
+ * @note The order of the remaining elements is unspecified.
+ *
+ * @public @related UVec
+ */
+#define uvec_partial_sort(T, vec, k) P_ULIB_MACRO_CONCAT(uvec_partial_sort_, T)(vec, k)
+
+/**
+ * Rearranges the elements of the vector into a max-heap.
+ * Performance: O(n)
+ *
+ * @param T [symbol] Vector type.
+ * @param vec [UVec(T)*] Vector instance.
+ *
+ * @note Heaps are UVEC_HEAP_ARITY-ary, and their largest element is the first one.
+ *
+ * @public @related UVec
+ */
+#define uvec_heapify(T, vec) P_ULIB_MACRO_CONCAT(uvec_heapify_, T)(vec)
+
+/**
+ * Pushes the specified element to a max-heap.
+ * Performance: O(log n)
+ *
+ * @param T [symbol] Vector type.
+ * @param vec [UVec(T)*] Vector instance, which must be a heap.
+ * @param item [T] Element to push.
+ * @return [uvec_ret] UVEC_OK on success, otherwise UVEC_ERR.
+ *
+ * @public @related UVec
+ */
+#define uvec_heap_push(T, vec, item) P_ULIB_MACRO_CONCAT(uvec_heap_push_, T)(vec, item)
+
+/**
+ * Removes and returns the largest element of a max-heap.
+ * Performance: O(log n)
+ *
+ * @param T [symbol] Vector type.
+ * @param vec [UVec(T)*] Vector instance, which must be a non-empty heap.
+ * @return [T] Largest element.
+ *
+ * @public @related UVec
+ */
+#define uvec_heap_pop(T, vec) P_ULIB_MACRO_CONCAT(uvec_heap_pop_, T)(vec)
+
+/**
+ * Replaces the largest element of a max-heap, returning it.
+ * Performance: O(log n)
+ *
+ * @param T [symbol] Vector type.
+ * @param vec [UVec(T)*] Vector instance, which must be a non-empty heap.
+ * @param item [T] Replacement element.
+ * @return [T] Replaced element.
+ *
+ * @note This is faster than popping and then pushing, and is the building block
+ *       of bounded top-k queries.
+ *
+ * @public @related UVec
+ */
+#define uvec_heap_replace_top(T, vec, item)                                                        \
+    P_ULIB_MACRO_CONCAT(uvec_heap_replace_top_, T)(vec, item)
+
 /**
  * Finds the insertion index for the specified item in a sorted vector.
  * Average performance: O(log n)
@@ -1417,6 +2698,141 @@ typedef enum uvec_ret {
  */
 #define uvec_remove_sorted(T, vec, item) P_ULIB_MACRO_CONCAT(uvec_remove_sorted_, T)(vec, item)
 
+/**
+ * Returns the indices of the specified elements in a sorted vector.
+ * Average performance: O(n log m)
+ *
+ * @param T [symbol] Vector type.
+ * @param vec [UVec(T)*] Vector instance.
+ * @param items [T const*] Elements to search.
+ * @param n [ulib_uint] Number of elements to search.
+ * @param[out] indices [ulib_uint*] Index of each element, or an invalid index if not found.
+ *
+ * @note Searches are interleaved in batches of UVEC_SEARCH_BATCH_SIZE elements,
+ *       so that their cache misses overlap.
+ *
+ * @public @related UVec
+ */
+#define uvec_index_of_sorted_batch(T, vec, items, n, indices)                                      \
+    P_ULIB_MACRO_CONCAT(uvec_index_of_sorted_batch_, T)(vec, items, n, indices)
+
+/**
+ * Builds a read-optimized search index from a sorted vector, by storing its elements
+ * in Eytzinger (breadth-first) order.
+ *
+ * @param T [symbol] Vector type.
+ * @param vec [UVec(T)*] Sorted vector.
+ * @param dest [UVec(T)*] Destination vector.
+ * @return [uvec_ret] UVEC_OK on success, otherwise UVEC_ERR.
+ *
+ * @note The index must be queried via uvec_index_of_eytzinger and uvec_contains_eytzinger,
+ *       and must be rebuilt if the source vector changes.
+ *
+ * @public @related UVec
+ */
+#define uvec_to_eytzinger(T, vec, dest) P_ULIB_MACRO_CONCAT(uvec_to_eytzinger_, T)(vec, dest)
+
+/**
+ * Returns the index of the specified element in a vector in Eytzinger order.
+ * Average performance: O(log n)
+ *
+ * @param T [symbol] Vector type.
+ * @param vec [UVec(T)*] Vector built via uvec_to_eytzinger.
+ * @param item [T] Element to search.
+ * @return [ulib_uint] Index of the found element, or an invalid index.
+ *
+ * @note If the vector contains multiple occurrences of the item,
+ *       the returned index is that of the first one in sorted order.
+ *
+ * @public @related UVec
+ */
+#define uvec_index_of_eytzinger(T, vec, item)                                                      \
+    P_ULIB_MACRO_CONCAT(uvec_index_of_eytzinger_, T)(vec, item)
+
+/**
+ * Checks whether a vector in Eytzinger order contains the specified element.
+ * Average performance: O(log n)
+ *
+ * @param T [symbol] Vector type.
+ * @param vec [UVec(T)*] Vector built via uvec_to_eytzinger.
+ * @param item [T] Element to search.
+ * @return [bool] True if the vector contains the specified element, false otherwise.
+ *
+ * @public @related UVec
+ */
+#define uvec_contains_eytzinger(T, vec, item)                                                      \
+    P_ULIB_MACRO_CONCAT(uvec_contains_eytzinger_, T)(vec, item)
+
+/**
+ * Computes the union of two sorted vectors.
+ *
+ * @param T [symbol] Vector type.
+ * @param vec [UVec(T)*] First vector.
+ * @param other [UVec(T)*] Second vector.
+ * @param dest [UVec(T)*] Destination vector, whose contents are replaced.
+ * @return [uvec_ret] UVEC_OK on success, otherwise UVEC_ERR.
+ *
+ * @note Vectors must be sorted and contain no duplicates, and the destination vector
+ *       must be distinct from the others.
+ * @note If one vector is much larger than the other, its elements are located via
+ *       galloping (exponential) search and copied in bulk.
+ *
+ * @public @related UVec
+ */
+#define uvec_sorted_union(T, vec, other, dest)                                                     \
+    P_ULIB_MACRO_CONCAT(uvec_sorted_union_, T)(vec, other, dest)
+
+/**
+ * Computes the intersection of two sorted vectors.
+ *
+ * @param T [symbol] Vector type.
+ * @param vec [UVec(T)*] First vector.
+ * @param other [UVec(T)*] Second vector.
+ * @param dest [UVec(T)*] Destination vector, whose contents are replaced.
+ * @return [uvec_ret] UVEC_OK on success, otherwise UVEC_ERR.
+ *
+ * @note Vectors must be sorted and contain no duplicates, and the destination vector
+ *       must be distinct from the others.
+ * @note If one vector is much larger than the other, its elements are located via
+ *       galloping (exponential) search. Builtin vectors are otherwise intersected via SIMD.
+ *
+ * @public @related UVec
+ */
+#define uvec_sorted_intersect(T, vec, other, dest)                                                 \
+    P_ULIB_MACRO_CONCAT(uvec_sorted_intersect_, T)(vec, other, dest)
+
+/**
+ * Computes the difference between two sorted vectors.
+ *
+ * @param T [symbol] Vector type.
+ * @param vec [UVec(T)*] First vector.
+ * @param other [UVec(T)*] Vector whose elements should be excluded.
+ * @param dest [UVec(T)*] Destination vector, whose contents are replaced.
+ * @return [uvec_ret] UVEC_OK on success, otherwise UVEC_ERR.
+ *
+ * @note Vectors must be sorted and contain no duplicates, and the destination vector
+ *       must be distinct from the others.
+ *
+ * @public @related UVec
+ */
+#define uvec_sorted_difference(T, vec, other, dest)                                                \
+    P_ULIB_MACRO_CONCAT(uvec_sorted_difference_, T)(vec, other, dest)
+
+/**
+ * Checks whether a sorted vector is a subset of another.
+ *
+ * @param T [symbol] Vector type.
+ * @param vec [UVec(T)*] Vector instance.
+ * @param other [UVec(T)*] Other vector.
+ * @return [bool] True if all the elements of vec are contained in other, false otherwise.
+ *
+ * @note Vectors must be sorted and contain no duplicates.
+ *
+ * @public @related UVec
+ */
+#define uvec_sorted_is_subset(T, vec, other)                                                       \
+    P_ULIB_MACRO_CONCAT(uvec_sorted_is_subset_, T)(vec, other)
+
 ULIB_END_DECLS
 
 #endif // UVEC_H
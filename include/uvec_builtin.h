@@ -25,6 +25,78 @@ UVEC_DECL_COMPARABLE_SPEC(ulib_float, ULIB_PUBLIC)
 UVEC_DECL_COMPARABLE_SPEC(ulib_ptr, ULIB_PUBLIC)
 UVEC_DECL_COMPARABLE_SPEC(UString, ULIB_PUBLIC)
 
+/// @cond
+ULIB_PUBLIC void uvec_radix_sort_ulib_byte(UVec(ulib_byte) *vec);
+ULIB_PUBLIC void uvec_radix_sort_ulib_int(UVec(ulib_int) *vec);
+ULIB_PUBLIC void uvec_radix_sort_ulib_uint(UVec(ulib_uint) *vec);
+ULIB_PUBLIC ulib_ret uvec_append_parsed_ulib_int(UVec(ulib_int) *vec, UString string, char sep);
+ULIB_PUBLIC ulib_ret uvec_append_parsed_ulib_uint(UVec(ulib_uint) *vec, UString string, char sep);
+ULIB_PUBLIC ulib_ret uvec_append_parsed_ulib_float(UVec(ulib_float) *vec, UString string, char sep);
+/// @endcond
+
+/**
+ * Sorts the vector via LSD radix sort.
+ * Performance: O(n)
+ *
+ * @param T [symbol] Vector type, one of ulib_byte, ulib_int or ulib_uint.
+ * @param vec [UVec(T)*] Vector instance.
+ *
+ * @note Short vectors are sorted via uvec_sort, as is any vector if the temporary buffer
+ *       needed by radix sort cannot be allocated.
+ *
+ * @public @related UVec
+ */
+#define uvec_radix_sort(T, vec) P_ULIB_MACRO_CONCAT(uvec_radix_sort_, T)(vec)
+
+/**
+ * Parses the numbers in a delimited string, appending them to the vector.
+ *
+ * @param T [symbol] Vector type, one of ulib_int, ulib_uint or ulib_float.
+ * @param vec [UVec(T)*] Vector instance.
+ * @param string [UString] Numbers, separated by `sep`.
+ * @param sep [char] Separator.
+ * @return [ulib_ret] ULIB_OK on success, ULIB_ERR if the string is malformed,
+ *         ULIB_ERR_MEM if memory could not be allocated.
+ *
+ * @note Numbers are parsed via ulib_str_parse_int, ulib_str_parse_uint and ulib_str_parse_float,
+ *       and may be surrounded by spaces, tabs and line breaks. A trailing separator is allowed,
+ *       and an empty string yields no numbers.
+ * @note On failure, the vector is left unchanged.
+ *
+ * @public @related UVec
+ */
+#define uvec_append_parsed(T, vec, string, sep)                                                    \
+    P_ULIB_MACRO_CONCAT(uvec_append_parsed_, T)(vec, string, sep)
+
+/**
+ * Joins the strings in the vector with a separator, adding a prefix and a suffix.
+ *
+ * @param vec [UVec(UString) const *] Vector of strings.
+ * @param sep [UString] Separator.
+ * @param prefix [UString] Prefix.
+ * @param suffix [UString] Suffix.
+ * @return [UString] Strings joined with the specified separator, between prefix and suffix.
+ *
+ * @public @related UVec
+ */
+#define uvec_join_ustring(vec, sep, prefix, suffix)                                                \
+    ustring_join_affixed(uvec_data(UString, vec), uvec_count(UString, vec), sep, prefix, suffix)
+
+/**
+ * Appends the tokens returned by a split iterator to the vector.
+ *
+ * @param vec Vector of strings.
+ * @param split Split iterator.
+ * @return ULIB_OK on success, otherwise ULIB_ERR_MEM.
+ *
+ * @note Tokens are views into the split string, as described in UStrSplit.
+ * @note On failure, the vector is left unchanged.
+ *
+ * @public @related UVec
+ */
+ULIB_PUBLIC
+ulib_ret uvec_append_split(UVec(UString) *vec, UStrSplit split);
+
 ULIB_END_DECLS
 
 #endif // UVEC_BUILTIN_H
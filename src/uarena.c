@@ -0,0 +1,264 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "uarena.h"
+
+// Arena storage is allocated from the heap even within allocation scopes.
+#if defined(ULIB_ALLOC_SCOPES)
+#define p_uarena_heap_malloc P_UARENA_HEAP_MALLOC
+#define p_uarena_heap_realloc P_UARENA_HEAP_REALLOC
+#define p_uarena_heap_free P_UARENA_HEAP_FREE
+#else
+#define p_uarena_heap_malloc ulib_malloc
+#define p_uarena_heap_realloc ulib_realloc
+#define p_uarena_heap_free ulib_free
+#endif
+
+#define P_UARENA_ALIGN _Alignof(max_align_t)
+#define p_uarena_align(size) (((size) + P_UARENA_ALIGN - 1) & ~(size_t)(P_UARENA_ALIGN - 1))
+
+// Returns the size of the block holding an allocation, or zero if it would overflow.
+static inline size_t p_uarena_block_size(size_t size) {
+    if (!size) return P_UARENA_ALIGN;
+    return size > SIZE_MAX - P_UARENA_ALIGN ? 0 : p_uarena_align(size);
+}
+
+struct P_UArenaChunk {
+    P_UArenaChunk *next;
+    size_t size;
+    max_align_t data[];
+};
+
+static inline ulib_byte *p_uarena_chunk_data(P_UArenaChunk *chunk) {
+    return (ulib_byte *)chunk->data;
+}
+
+static inline bool p_uarena_chunk_owns(P_UArenaChunk *chunk, void const *ptr) {
+    ulib_byte const *data = p_uarena_chunk_data(chunk);
+    return (ulib_byte const *)ptr >= data && (ulib_byte const *)ptr < data + chunk->size;
+}
+
+UArena uarena(size_t chunk_size) {
+    if (!chunk_size) chunk_size = UARENA_CHUNK_SIZE;
+    return (UArena){ ._chunk_size = p_uarena_align(chunk_size) };
+}
+
+void uarena_deinit(UArena *arena) {
+    for (P_UArenaChunk *chunk = arena->_head, *next; chunk; chunk = next) {
+        next = chunk->next;
+        p_uarena_heap_free(chunk);
+    }
+    *arena = uarena(arena->_chunk_size);
+}
+
+// Moves to the first retained chunk that fits the allocation, or adds a new one.
+static P_UArenaChunk *p_uarena_next_chunk(UArena *arena, size_t size) {
+    P_UArenaChunk **link = arena->_chunk ? &arena->_chunk->next : &arena->_head;
+
+    for (P_UArenaChunk *chunk = *link; chunk; chunk = chunk->next) {
+        if (chunk->size >= size) {
+            arena->_chunk = chunk;
+            arena->_used = 0;
+            return chunk;
+        }
+    }
+
+    size_t const chunk_size = size > arena->_chunk_size ? size : arena->_chunk_size;
+    if (chunk_size > SIZE_MAX - sizeof(P_UArenaChunk)) return NULL;
+    P_UArenaChunk *chunk = p_uarena_heap_malloc(sizeof(*chunk) + chunk_size);
+    if (!chunk) return NULL;
+
+    *chunk = (P_UArenaChunk){ .next = *link, .size = chunk_size };
+    *link = chunk;
+    arena->_chunk = chunk;
+    arena->_used = 0;
+    return chunk;
+}
+
+void *uarena_alloc(UArena *arena, size_t size) {
+    if (!(size = p_uarena_block_size(size))) return NULL;
+    P_UArenaChunk *chunk = arena->_chunk;
+
+    if (!chunk || chunk->size - arena->_used < size) {
+        if (!(chunk = p_uarena_next_chunk(arena, size))) return NULL;
+    }
+
+    void *ptr = p_uarena_chunk_data(chunk) + arena->_used;
+    arena->_used += size;
+    return ptr;
+}
+
+// Checks whether the specified memory is the most recent allocation.
+static inline bool p_uarena_is_last(UArena const *arena, void const *ptr, size_t size) {
+    size = p_uarena_block_size(size);
+    return size && arena->_chunk && arena->_used >= size &&
+           p_uarena_chunk_data(arena->_chunk) + arena->_used - size == ptr;
+}
+
+void *uarena_realloc(UArena *arena, void *ptr, size_t old_size, size_t size) {
+    if (!ptr) return uarena_alloc(arena, size);
+
+    if (p_uarena_is_last(arena, ptr, old_size)) {
+        size_t const start = arena->_used - p_uarena_block_size(old_size);
+        size_t const new_size = p_uarena_block_size(size);
+
+        if (new_size && arena->_chunk->size - start >= new_size) {
+            arena->_used = start + new_size;
+            return ptr;
+        }
+    }
+
+    void *new_ptr = uarena_alloc(arena, size);
+    if (new_ptr) memcpy(new_ptr, ptr, old_size < size ? old_size : size);
+    return new_ptr;
+}
+
+bool uarena_owns(UArena const *arena, void const *ptr) {
+    if (arena->_chunk && p_uarena_chunk_owns(arena->_chunk, ptr)) return true;
+    for (P_UArenaChunk *chunk = arena->_head; chunk; chunk = chunk->next) {
+        if (p_uarena_chunk_owns(chunk, ptr)) return true;
+    }
+    return false;
+}
+
+static void *p_uarena_allocator_alloc(void *ctx, void *ptr, size_t old_size, size_t size) {
+    return uarena_realloc(ctx, ptr, old_size, size);
+}
+
+static void p_uarena_allocator_dealloc(void *ctx, void *ptr, size_t size) {
+    UArena *arena = ctx;
+    if (p_uarena_is_last(arena, ptr, size)) {
+        arena->_used -= p_uarena_block_size(size);
+    }
+}
+
+UAllocator uarena_allocator(UArena *arena) {
+    return (UAllocator){ arena, p_uarena_allocator_alloc, p_uarena_allocator_dealloc };
+}
+
+#if defined(ULIB_ALLOC_SCOPES)
+
+static p_ulib_thread_local UArena *p_uarena_scope = NULL;
+
+// Scoped allocations are prefixed by their size, so that they can be reallocated.
+#define P_UARENA_HEADER_SIZE p_uarena_align(sizeof(size_t))
+
+UArena *uarena_scope_begin(UArena *arena) {
+    UArena *prev = p_uarena_scope;
+    p_uarena_scope = arena;
+    return prev;
+}
+
+void uarena_scope_end(UArena *prev) {
+    p_uarena_scope = prev;
+}
+
+static inline size_t *p_uarena_scope_header(void *ptr) {
+    return (size_t *)(void *)((ulib_byte *)ptr - P_UARENA_HEADER_SIZE);
+}
+
+void *p_uarena_scope_malloc(size_t size) {
+    UArena *arena = p_uarena_scope;
+    if (!arena) return p_uarena_heap_malloc(size);
+
+    if (size > SIZE_MAX - P_UARENA_HEADER_SIZE) return NULL;
+    ulib_byte *block = uarena_alloc(arena, P_UARENA_HEADER_SIZE + size);
+    if (!block) return NULL;
+
+    *(size_t *)(void *)block = size;
+    return block + P_UARENA_HEADER_SIZE;
+}
+
+void *p_uarena_scope_calloc(size_t num, size_t size) {
+    if (size && num > SIZE_MAX / size) return NULL;
+    void *ptr = p_uarena_scope_malloc(num * size);
+    if (ptr) memset(ptr, 0, num * size);
+    return ptr;
+}
+
+void *p_uarena_scope_realloc(void *ptr, size_t size) {
+    if (!ptr) return p_uarena_scope_malloc(size);
+
+    UArena *arena = p_uarena_scope;
+    if (!(arena && uarena_owns(arena, ptr))) return p_uarena_heap_realloc(ptr, size);
+
+    if (size > SIZE_MAX - P_UARENA_HEADER_SIZE) return NULL;
+    size_t *header = p_uarena_scope_header(ptr);
+    ulib_byte *block = uarena_realloc(arena, header, P_UARENA_HEADER_SIZE + *header,
+                                      P_UARENA_HEADER_SIZE + size);
+    if (!block) return NULL;
+
+    *(size_t *)(void *)block = size;
+    return block + P_UARENA_HEADER_SIZE;
+}
+
+void p_uarena_scope_free(void *ptr) {
+    if (!ptr) return;
+
+    UArena *arena = p_uarena_scope;
+    if (!(arena && uarena_owns(arena, ptr))) {
+        p_uarena_heap_free(ptr);
+        return;
+    }
+
+    size_t *header = p_uarena_scope_header(ptr);
+    p_uarena_allocator_dealloc(arena, header, P_UARENA_HEADER_SIZE + *header);
+}
+
+#endif
+
+// Free objects are linked through their first bytes.
+typedef struct P_UPoolObject {
+    struct P_UPoolObject *next;
+} P_UPoolObject;
+
+UPool upool(size_t size, size_t count) {
+    if (size < sizeof(P_UPoolObject)) size = sizeof(P_UPoolObject);
+    size = p_uarena_align(size);
+    if (!count) count = UARENA_CHUNK_SIZE / size ? UARENA_CHUNK_SIZE / size : 1;
+    return (UPool){ ._size = size, ._count = count };
+}
+
+void upool_deinit(UPool *pool) {
+    for (P_UArenaChunk *chunk = pool->_chunks, *next; chunk; chunk = next) {
+        next = chunk->next;
+        p_uarena_heap_free(chunk);
+    }
+    pool->_chunks = pool->_free = NULL;
+}
+
+void *upool_alloc(UPool *pool) {
+    if (!pool->_free) {
+        size_t const size = pool->_size * pool->_count;
+        P_UArenaChunk *chunk = p_uarena_heap_malloc(sizeof(*chunk) + size);
+        if (!chunk) return NULL;
+
+        *chunk = (P_UArenaChunk){ .next = pool->_chunks, .size = size };
+        pool->_chunks = chunk;
+
+        // Thread the new objects into the free list, in address order.
+        ulib_byte *data = p_uarena_chunk_data(chunk);
+        for (size_t i = pool->_count; i-- > 0;) {
+            P_UPoolObject *obj = (P_UPoolObject *)(void *)(data + i * pool->_size);
+            obj->next = pool->_free;
+            pool->_free = obj;
+        }
+    }
+
+    P_UPoolObject *obj = pool->_free;
+    pool->_free = obj->next;
+    return obj;
+}
+
+void upool_free(UPool *pool, void *ptr) {
+    if (!ptr) return;
+    P_UPoolObject *obj = ptr;
+    obj->next = pool->_free;
+    pool->_free = obj;
+}
@@ -0,0 +1,261 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "ubench.h"
+#include "ujson.h"
+
+#define P_UBENCH_SAMPLES 31U
+#define P_UBENCH_SAMPLE_TIME 2000000ULL
+#define P_UBENCH_WARMUP_TIME 20000000ULL
+#define P_UBENCH_MAX_ITERATIONS (SIZE_MAX / 16)
+
+static UBenchConfig p_ubench_config = {
+    .format = UBENCH_FORMAT_TEXT,
+    .samples = P_UBENCH_SAMPLES,
+    .sample_time = P_UBENCH_SAMPLE_TIME,
+    .warmup_time = P_UBENCH_WARMUP_TIME,
+};
+
+static char const *p_ubench_group_name = "";
+static bool p_ubench_group_printed = false;
+static unsigned p_ubench_reported = 0;
+
+// Time spent paused during the current sample, and start of the current pause.
+static utime_ns p_ubench_paused = 0;
+static utime_ns p_ubench_pause_start = 0;
+
+static void const *volatile p_ubench_sink = NULL;
+
+void p_ubench_escape(void const *ptr) {
+    p_ubench_sink = ptr;
+}
+
+static UOStream *p_ubench_stream(void) {
+    return p_ubench_config.stream ? p_ubench_config.stream : uostream_std();
+}
+
+UBenchConfig *ubench_config(void) {
+    return &p_ubench_config;
+}
+
+bool ubench_start(int argc, char **argv) {
+    for (int i = 1; i < argc; ++i) {
+        char const *arg = argv[i];
+
+        if (strcmp(arg, "--csv") == 0) {
+            p_ubench_config.format = UBENCH_FORMAT_CSV;
+        } else if (strcmp(arg, "--json") == 0) {
+            p_ubench_config.format = UBENCH_FORMAT_JSON;
+        } else if (strcmp(arg, "--quick") == 0) {
+            p_ubench_config.samples = 5;
+            p_ubench_config.sample_time /= 10;
+            p_ubench_config.warmup_time /= 10;
+        } else if (arg[0] == '-') {
+            fprintf(stderr, "Unknown option: %s\n", arg);
+            return false;
+        } else {
+            p_ubench_config.filter = arg;
+        }
+    }
+
+    UOStream *stream = p_ubench_stream();
+    p_ubench_reported = 0;
+
+    if (p_ubench_config.format == UBENCH_FORMAT_CSV) {
+        uostream_write_literal(stream,
+                               "group,name,size,iterations,samples,"
+                               "min_ns,median_ns,p99_ns,mean_ns,stddev_ns\n",
+                               NULL);
+    } else if (p_ubench_config.format == UBENCH_FORMAT_JSON) {
+        uostream_write_literal(stream, "[", NULL);
+    }
+
+    return true;
+}
+
+void ubench_end(void) {
+    if (p_ubench_config.format == UBENCH_FORMAT_JSON) {
+        if (p_ubench_reported) uostream_write_literal(p_ubench_stream(), "\n", NULL);
+        uostream_write_literal(p_ubench_stream(), "]\n", NULL);
+    }
+    uostream_flush(p_ubench_stream());
+}
+
+void p_ubench_group(char const *name) {
+    p_ubench_group_name = name;
+    p_ubench_group_printed = false;
+}
+
+void ubench_pause(void) {
+    p_ubench_pause_start = utime_get_ns();
+}
+
+void ubench_resume(void) {
+    p_ubench_paused += utime_get_ns() - p_ubench_pause_start;
+}
+
+// Runs the benchmark, returning the elapsed time net of pauses.
+static utime_ns p_ubench_sample(ubench_fn fn, void *ctx, size_t iterations) {
+    p_ubench_paused = 0;
+    utime_ns const start = utime_get_ns();
+    fn(ctx, iterations);
+    utime_ns const elapsed = utime_get_ns() - start;
+    return elapsed > p_ubench_paused ? elapsed - p_ubench_paused : 0;
+}
+
+// Warms up the benchmark, and returns the number of iterations that fill a sample.
+static size_t p_ubench_calibrate(ubench_fn fn, void *ctx) {
+    UBenchConfig const *cfg = &p_ubench_config;
+    utime_ns const start = utime_get_ns();
+    size_t iterations = 1;
+
+    for (;;) {
+        utime_ns const elapsed = p_ubench_sample(fn, ctx, iterations);
+
+        if (elapsed < cfg->sample_time / 2 && iterations < P_UBENCH_MAX_ITERATIONS) {
+            // Grow geometrically, guessing from the elapsed time once it is measurable.
+            size_t const guess = elapsed ? (size_t)((double)iterations * 0.6 *
+                                                    (double)cfg->sample_time / (double)elapsed)
+                                         : iterations * 10;
+            iterations = guess > iterations * 2 ? guess : iterations * 2;
+            if (iterations > P_UBENCH_MAX_ITERATIONS) iterations = P_UBENCH_MAX_ITERATIONS;
+            continue;
+        }
+
+        if (utime_get_ns() - start < cfg->warmup_time) continue;
+        if (!elapsed) return iterations;
+
+        double const scaled = (double)iterations * (double)cfg->sample_time / (double)elapsed;
+        if (scaled < 1.0) return 1;
+        return scaled > (double)P_UBENCH_MAX_ITERATIONS ? P_UBENCH_MAX_ITERATIONS : (size_t)scaled;
+    }
+}
+
+// Square root by Newton's method, as the library does not link against libm.
+static double p_ubench_sqrt(double x) {
+    if (x <= 0) return 0;
+    double r = x > 1 ? x : 1;
+    for (unsigned i = 0; i < 64; ++i) {
+        double const next = (r + x / r) / 2;
+        if (next >= r) break;
+        r = next;
+    }
+    return r;
+}
+
+static int p_ubench_double_cmp(void const *lhs, void const *rhs) {
+    double const l = *(double const *)lhs, r = *(double const *)rhs;
+    return l < r ? -1 : (l > r ? 1 : 0);
+}
+
+// Nearest-rank percentile of sorted values.
+static double p_ubench_percentile(double const *values, unsigned count, double percentile) {
+    double const rank = percentile / 100.0 * count;
+    unsigned idx = (unsigned)rank;
+    if ((double)idx < rank) idx++;
+    return values[idx ? idx - 1 : 0];
+}
+
+UBenchResult ubench_measure(ubench_fn fn, void *ctx) {
+    static double samples[UBENCH_MAX_SAMPLES];
+    unsigned count = p_ubench_config.samples;
+    if (count > UBENCH_MAX_SAMPLES) count = UBENCH_MAX_SAMPLES;
+    if (!count) count = 1;
+
+    UBenchResult result = { .iterations = p_ubench_calibrate(fn, ctx), .samples = count };
+    double sum = 0;
+
+    for (unsigned i = 0; i < count; ++i) {
+        samples[i] = (double)p_ubench_sample(fn, ctx, result.iterations) /
+                     (double)result.iterations;
+        sum += samples[i];
+    }
+
+    qsort(samples, count, sizeof(*samples), p_ubench_double_cmp);
+    result.mean = sum / count;
+    result.min = samples[0];
+    result.median = p_ubench_percentile(samples, count, 50.0);
+    result.p99 = p_ubench_percentile(samples, count, 99.0);
+
+    double var = 0;
+    for (unsigned i = 0; i < count; ++i) {
+        double const d = samples[i] - result.mean;
+        var += d * d;
+    }
+    result.stddev = count > 1 ? p_ubench_sqrt(var / (count - 1)) : 0;
+
+    return result;
+}
+
+static void p_ubench_write_time(UOStream *stream, double ns) {
+    if (ns < 1000.0) {
+        uostream_writef(stream, NULL, "%.2f ns", ns);
+    } else {
+        utime_ns const t = (utime_ns)(ns + 0.5);
+        uostream_write_time_interval(stream, t, utime_interval_unit_auto(t), 2, NULL);
+    }
+}
+
+static void p_ubench_report(char const *name, ulib_uint size, UBenchResult const *r) {
+    UOStream *stream = p_ubench_stream();
+    char const *group = p_ubench_group_name;
+    unsigned long long const iterations = r->iterations;
+
+    switch (p_ubench_config.format) {
+        case UBENCH_FORMAT_CSV:
+            uostream_writef(stream, NULL,
+                            "%s,%s,%" ULIB_UINT_FMT ",%llu,%u,%.3f,%.3f,%.3f,%.3f,%.3f\n", group,
+                            name, size, iterations, r->samples, r->min, r->median, r->p99, r->mean,
+                            r->stddev);
+            break;
+        case UBENCH_FORMAT_JSON:
+            uostream_writef(stream, NULL, "%s\n  {\"group\": \"", p_ubench_reported ? "," : "");
+            p_ujson_write_escaped(stream, group);
+            uostream_write_literal(stream, "\", \"name\": \"", NULL);
+            p_ujson_write_escaped(stream, name);
+            uostream_writef(stream, NULL,
+                            "\", \"size\": %" ULIB_UINT_FMT ", \"iterations\": %llu, "
+                            "\"samples\": %u, \"min_ns\": %.3f, \"median_ns\": %.3f, "
+                            "\"p99_ns\": %.3f, \"mean_ns\": %.3f, \"stddev_ns\": %.3f}",
+                            size, iterations, r->samples, r->min, r->median, r->p99, r->mean,
+                            r->stddev);
+            break;
+        default:
+            if (!p_ubench_group_printed) {
+                uostream_writef(stream, NULL, "%s\"%s\" benchmarks (time per iteration)\n",
+                                p_ubench_reported ? "\n" : "", group);
+                p_ubench_group_printed = true;
+            }
+            uostream_writef(stream, NULL, "%-24s %10" ULIB_UINT_FMT "  median ", name, size);
+            p_ubench_write_time(stream, r->median);
+            uostream_write_literal(stream, ", p99 ", NULL);
+            p_ubench_write_time(stream, r->p99);
+            uostream_write_literal(stream, ", stddev ", NULL);
+            p_ubench_write_time(stream, r->stddev);
+            uostream_writef(stream, NULL, " (%u x %llu)\n", r->samples, iterations);
+            break;
+    }
+
+    p_ubench_reported++;
+}
+
+static bool p_ubench_matches(char const *name) {
+    char const *filter = p_ubench_config.filter;
+    if (!filter) return true;
+
+    char full_name[256];
+    snprintf(full_name, sizeof(full_name), "%s/%s", p_ubench_group_name, name);
+    return strstr(full_name, filter) != NULL;
+}
+
+void ubench_case(char const *name, ulib_uint size, ubench_fn fn, void *ctx) {
+    if (!p_ubench_matches(name)) return;
+    UBenchResult const result = ubench_measure(fn, ctx);
+    p_ubench_report(name, size, &result);
+}
@@ -0,0 +1,316 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "ubitset.h"
+#include "ubit.h"
+#include "usimd.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#pragma intrinsic(_BitScanForward64)
+#endif
+
+#define P_UBITSET_WORD_BITS 64U
+#define P_UBITSET_ALL UINT64_MAX
+
+// Number of words needed to store the specified number of bits.
+static inline ulib_uint p_ubitset_words(ulib_uint bits) {
+    return bits / P_UBITSET_WORD_BITS + (bits % P_UBITSET_WORD_BITS != 0);
+}
+
+// Mask of the bits of a word starting from the specified one.
+static inline uint64_t p_ubitset_mask_from(ulib_uint bit) {
+    return P_UBITSET_ALL << (bit % P_UBITSET_WORD_BITS);
+}
+
+// Mask of the bits of a word preceding the specified one, or of the whole word if it is zero.
+static inline uint64_t p_ubitset_mask_to(ulib_uint bit) {
+    unsigned const shift = bit % P_UBITSET_WORD_BITS;
+    return shift ? P_UBITSET_ALL >> (P_UBITSET_WORD_BITS - shift) : P_UBITSET_ALL;
+}
+
+static inline unsigned p_ubitset_ctz(uint64_t word) {
+#if defined(__GNUC__)
+    return (unsigned)__builtin_ctzll(word);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long idx;
+    _BitScanForward64(&idx, word);
+    return (unsigned)idx;
+#else
+    return (unsigned)ubit_count_set(64, (word & (0 - word)) - 1);
+#endif
+}
+
+// Applies the specified operation to two words at a time, if SIMD instructions are available.
+#if defined(P_USIMD)
+#define p_ubitset_simd_loop(a, b, n, i, op)                                                        \
+    for (; (i) + 2 <= (n); (i) += 2) {                                                             \
+        p_usimd_store((a) + (i), op(p_usimd_load((a) + (i)), p_usimd_load((b) + (i))));            \
+    }
+#else
+#define p_ubitset_simd_loop(a, b, n, i, op)
+#endif
+
+// Returns the number of set bits in the specified words.
+static ulib_uint p_ubitset_count_words(uint64_t const *words, ulib_uint n) {
+    ulib_uint count = 0, i = 0;
+
+#if defined(P_ULIB_SIMD_SSE2) && !defined(__POPCNT__)
+    // Bit-parallel count of each byte, summed into 64-bit lanes.
+    __m128i const m1 = _mm_set1_epi8(0x55), m2 = _mm_set1_epi8(0x33), m4 = _mm_set1_epi8(0x0f);
+    __m128i acc = _mm_setzero_si128();
+
+    for (; i + 2 <= n; i += 2) {
+        __m128i v = _mm_loadu_si128((__m128i const *)(words + i));
+        v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi64(v, 1), m1));
+        v = _mm_add_epi8(_mm_and_si128(v, m2), _mm_and_si128(_mm_srli_epi64(v, 2), m2));
+        v = _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi64(v, 4)), m4);
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(v, _mm_setzero_si128()));
+    }
+
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, acc);
+    count = (ulib_uint)(lanes[0] + lanes[1]);
+#elif defined(P_ULIB_SIMD_NEON)
+    uint64x2_t acc = vdupq_n_u64(0);
+
+    for (; i + 2 <= n; i += 2) {
+        uint8x16_t const v = vcntq_u8(vld1q_u8((uint8_t const *)(words + i)));
+        acc = vaddq_u64(acc, vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(v))));
+    }
+
+    uint64_t lanes[2];
+    vst1q_u64(lanes, acc);
+    count = (ulib_uint)(lanes[0] + lanes[1]);
+#endif
+
+    for (; i < n; ++i) count += (ulib_uint)ubit_count_set(64, words[i]);
+    return count;
+}
+
+void ubitset_deinit(UBitSet *set) {
+    ulib_free(set->_words);
+    *set = ubitset();
+}
+
+ulib_ret ubitset_reserve(UBitSet *set, ulib_uint size) {
+    ulib_uint const words = p_ubitset_words(size);
+    if (words <= set->_capacity) return ULIB_OK;
+
+    ulib_uint capacity = set->_capacity > words / 2 ? set->_capacity * 2 : words;
+    if (capacity < set->_capacity) capacity = words;
+
+    uint64_t *new_words = ulib_realloc(set->_words, capacity * sizeof(*new_words));
+    if (!new_words) return ULIB_ERR_MEM;
+
+    // Bits past the size are always unset.
+    memset(new_words + set->_capacity, 0, (capacity - set->_capacity) * sizeof(*new_words));
+    set->_words = new_words;
+    set->_capacity = capacity;
+    return ULIB_OK;
+}
+
+ulib_ret ubitset_resize(UBitSet *set, ulib_uint size) {
+    if (size < set->_size) {
+        ubitset_unset_range(set, size, set->_size - size);
+    } else if (ubitset_reserve(set, size)) {
+        return ULIB_ERR_MEM;
+    }
+    set->_size = size;
+    return ULIB_OK;
+}
+
+ulib_ret ubitset_copy(UBitSet const *src, UBitSet *dest) {
+    ubitset_clear(dest);
+    if (ubitset_resize(dest, src->_size)) return ULIB_ERR_MEM;
+    ulib_uint const words = p_ubitset_words(src->_size);
+    if (words) memcpy(dest->_words, src->_words, words * sizeof(*src->_words));
+    return ULIB_OK;
+}
+
+ulib_ret ubitset_set(UBitSet *set, ulib_uint bit) {
+    if (bit >= set->_size) {
+        if (bit == ULIB_UINT_MAX || ubitset_resize(set, bit + 1)) return ULIB_ERR_MEM;
+    }
+    set->_words[bit / P_UBITSET_WORD_BITS] |= (uint64_t)1 << (bit % P_UBITSET_WORD_BITS);
+    return ULIB_OK;
+}
+
+// Sets or unsets the bits in the [start, end) range, which must not be empty.
+static void p_ubitset_fill(uint64_t *words, ulib_uint start, ulib_uint end, bool value) {
+    ulib_uint const first = start / P_UBITSET_WORD_BITS, last = (end - 1) / P_UBITSET_WORD_BITS;
+    uint64_t const first_mask = p_ubitset_mask_from(start), last_mask = p_ubitset_mask_to(end);
+
+    if (first == last) {
+        uint64_t const mask = first_mask & last_mask;
+        words[first] = value ? words[first] | mask : words[first] & ~mask;
+        return;
+    }
+
+    words[first] = value ? words[first] | first_mask : words[first] & ~first_mask;
+    memset(words + first + 1, value ? 0xFF : 0, (last - first - 1) * sizeof(*words));
+    words[last] = value ? words[last] | last_mask : words[last] & ~last_mask;
+}
+
+ulib_ret ubitset_set_range(UBitSet *set, ulib_uint start, ulib_uint len) {
+    if (!len) return ULIB_OK;
+    if (len > ULIB_UINT_MAX - start) return ULIB_ERR_MEM;
+
+    ulib_uint const end = start + len;
+    if (end > set->_size && ubitset_resize(set, end)) return ULIB_ERR_MEM;
+    p_ubitset_fill(set->_words, start, end, true);
+    return ULIB_OK;
+}
+
+void ubitset_unset_range(UBitSet *set, ulib_uint start, ulib_uint len) {
+    if (start >= set->_size) return;
+    ulib_uint const end = len > set->_size - start ? set->_size : start + len;
+    if (start < end) p_ubitset_fill(set->_words, start, end, false);
+}
+
+void ubitset_clear(UBitSet *set) {
+    if (set->_size) memset(set->_words, 0, p_ubitset_words(set->_size) * sizeof(*set->_words));
+}
+
+ulib_uint ubitset_count_set(UBitSet const *set) {
+    return p_ubitset_count_words(set->_words, p_ubitset_words(set->_size));
+}
+
+ulib_uint ubitset_count_set_range(UBitSet const *set, ulib_uint start, ulib_uint len) {
+    if (start >= set->_size || !len) return 0;
+
+    ulib_uint const end = len > set->_size - start ? set->_size : start + len;
+    ulib_uint const first = start / P_UBITSET_WORD_BITS, last = (end - 1) / P_UBITSET_WORD_BITS;
+    uint64_t const first_mask = p_ubitset_mask_from(start), last_mask = p_ubitset_mask_to(end);
+    uint64_t const *words = set->_words;
+
+    if (first == last) return (ulib_uint)ubit_count_set(64, words[first] & first_mask & last_mask);
+
+    ulib_uint count = (ulib_uint)ubit_count_set(64, words[first] & first_mask);
+    count += p_ubitset_count_words(words + first + 1, last - first - 1);
+    return count + (ulib_uint)ubit_count_set(64, words[last] & last_mask);
+}
+
+ulib_uint ubitset_next_set(UBitSet const *set, ulib_uint start) {
+    if (start >= set->_size) return set->_size;
+
+    ulib_uint i = start / P_UBITSET_WORD_BITS;
+    ulib_uint const n = p_ubitset_words(set->_size);
+    uint64_t word = set->_words[i] & p_ubitset_mask_from(start);
+
+    while (!word) {
+        if (++i == n) return set->_size;
+        word = set->_words[i];
+    }
+
+    return i * P_UBITSET_WORD_BITS + p_ubitset_ctz(word);
+}
+
+ulib_uint ubitset_next_unset(UBitSet const *set, ulib_uint start) {
+    if (start >= set->_size) return set->_size;
+
+    ulib_uint i = start / P_UBITSET_WORD_BITS;
+    ulib_uint const n = p_ubitset_words(set->_size);
+    uint64_t word = ~set->_words[i] & p_ubitset_mask_from(start);
+
+    while (!word) {
+        if (++i == n) return set->_size;
+        word = ~set->_words[i];
+    }
+
+    ulib_uint const bit = i * P_UBITSET_WORD_BITS + p_ubitset_ctz(word);
+    return bit < set->_size ? bit : set->_size;
+}
+
+void ubitset_and(UBitSet *set, UBitSet const *other) {
+    ulib_uint const n = p_ubitset_words(set->_size), m = p_ubitset_words(other->_size);
+    ulib_uint const common = n < m ? n : m;
+    uint64_t *a = set->_words;
+    uint64_t const *b = other->_words;
+    ulib_uint i = 0;
+
+    p_ubitset_simd_loop(a, b, common, i, p_usimd_and);
+    for (; i < common; ++i) a[i] &= b[i];
+    if (n > common) memset(a + common, 0, (n - common) * sizeof(*a));
+}
+
+void ubitset_and_not(UBitSet *set, UBitSet const *other) {
+    ulib_uint const n = p_ubitset_words(set->_size), m = p_ubitset_words(other->_size);
+    ulib_uint const common = n < m ? n : m;
+    uint64_t *a = set->_words;
+    uint64_t const *b = other->_words;
+    ulib_uint i = 0;
+
+    p_ubitset_simd_loop(a, b, common, i, p_usimd_and_not);
+    for (; i < common; ++i) a[i] &= ~b[i];
+}
+
+ulib_ret ubitset_or(UBitSet *set, UBitSet const *other) {
+    if (other->_size > set->_size && ubitset_resize(set, other->_size)) return ULIB_ERR_MEM;
+
+    ulib_uint const m = p_ubitset_words(other->_size);
+    uint64_t *a = set->_words;
+    uint64_t const *b = other->_words;
+    ulib_uint i = 0;
+
+    p_ubitset_simd_loop(a, b, m, i, p_usimd_or);
+    for (; i < m; ++i) a[i] |= b[i];
+    return ULIB_OK;
+}
+
+ulib_ret ubitset_xor(UBitSet *set, UBitSet const *other) {
+    if (other->_size > set->_size && ubitset_resize(set, other->_size)) return ULIB_ERR_MEM;
+
+    ulib_uint const m = p_ubitset_words(other->_size);
+    uint64_t *a = set->_words;
+    uint64_t const *b = other->_words;
+    ulib_uint i = 0;
+
+    p_ubitset_simd_loop(a, b, m, i, p_usimd_xor);
+    for (; i < m; ++i) a[i] ^= b[i];
+    return ULIB_OK;
+}
+
+// Checks whether the words in the [start, end) range are all zero.
+static bool p_ubitset_words_empty(uint64_t const *words, ulib_uint start, ulib_uint end) {
+    for (ulib_uint i = start; i < end; ++i) {
+        if (words[i]) return false;
+    }
+    return true;
+}
+
+bool ubitset_equals(UBitSet const *a, UBitSet const *b) {
+    ulib_uint const n = p_ubitset_words(a->_size), m = p_ubitset_words(b->_size);
+    ulib_uint const common = n < m ? n : m;
+
+    if (common && memcmp(a->_words, b->_words, common * sizeof(*a->_words)) != 0) return false;
+    return n > m ? p_ubitset_words_empty(a->_words, m, n) : p_ubitset_words_empty(b->_words, n, m);
+}
+
+bool ubitset_is_subset(UBitSet const *set, UBitSet const *other) {
+    ulib_uint const n = p_ubitset_words(set->_size), m = p_ubitset_words(other->_size);
+    ulib_uint const common = n < m ? n : m;
+
+    for (ulib_uint i = 0; i < common; ++i) {
+        if (set->_words[i] & ~other->_words[i]) return false;
+    }
+
+    return p_ubitset_words_empty(set->_words, common, n);
+}
+
+bool ubitset_intersects(UBitSet const *a, UBitSet const *b) {
+    ulib_uint const n = p_ubitset_words(a->_size), m = p_ubitset_words(b->_size);
+    ulib_uint const common = n < m ? n : m;
+
+    for (ulib_uint i = 0; i < common; ++i) {
+        if (a->_words[i] & b->_words[i]) return true;
+    }
+
+    return false;
+}
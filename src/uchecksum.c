@@ -0,0 +1,364 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "uchecksum.h"
+
+// clang-format off
+#if !defined(ULIB_NO_SIMD) && (defined(__x86_64__) || defined(__i386__)) &&                        \
+    (defined(__GNUC__) || defined(__clang__))
+    #include <nmmintrin.h>
+    #define P_UCRC32C_SSE42 1
+#elif !defined(ULIB_NO_SIMD) && defined(__ARM_FEATURE_CRC32)
+    #include <arm_acle.h>
+    #define P_UCRC32C_ARM 1
+#endif
+// clang-format on
+
+// CRC-32C lookup table (reflected polynomial 0x82f63b78).
+static uint32_t const p_ucrc32c_table[256] = {
+    0x00000000U, 0xf26b8303U, 0xe13b70f7U, 0x1350f3f4U, 0xc79a971fU, 0x35f1141cU,
+    0x26a1e7e8U, 0xd4ca64ebU, 0x8ad958cfU, 0x78b2dbccU, 0x6be22838U, 0x9989ab3bU,
+    0x4d43cfd0U, 0xbf284cd3U, 0xac78bf27U, 0x5e133c24U, 0x105ec76fU, 0xe235446cU,
+    0xf165b798U, 0x030e349bU, 0xd7c45070U, 0x25afd373U, 0x36ff2087U, 0xc494a384U,
+    0x9a879fa0U, 0x68ec1ca3U, 0x7bbcef57U, 0x89d76c54U, 0x5d1d08bfU, 0xaf768bbcU,
+    0xbc267848U, 0x4e4dfb4bU, 0x20bd8edeU, 0xd2d60dddU, 0xc186fe29U, 0x33ed7d2aU,
+    0xe72719c1U, 0x154c9ac2U, 0x061c6936U, 0xf477ea35U, 0xaa64d611U, 0x580f5512U,
+    0x4b5fa6e6U, 0xb93425e5U, 0x6dfe410eU, 0x9f95c20dU, 0x8cc531f9U, 0x7eaeb2faU,
+    0x30e349b1U, 0xc288cab2U, 0xd1d83946U, 0x23b3ba45U, 0xf779deaeU, 0x05125dadU,
+    0x1642ae59U, 0xe4292d5aU, 0xba3a117eU, 0x4851927dU, 0x5b016189U, 0xa96ae28aU,
+    0x7da08661U, 0x8fcb0562U, 0x9c9bf696U, 0x6ef07595U, 0x417b1dbcU, 0xb3109ebfU,
+    0xa0406d4bU, 0x522bee48U, 0x86e18aa3U, 0x748a09a0U, 0x67dafa54U, 0x95b17957U,
+    0xcba24573U, 0x39c9c670U, 0x2a993584U, 0xd8f2b687U, 0x0c38d26cU, 0xfe53516fU,
+    0xed03a29bU, 0x1f682198U, 0x5125dad3U, 0xa34e59d0U, 0xb01eaa24U, 0x42752927U,
+    0x96bf4dccU, 0x64d4cecfU, 0x77843d3bU, 0x85efbe38U, 0xdbfc821cU, 0x2997011fU,
+    0x3ac7f2ebU, 0xc8ac71e8U, 0x1c661503U, 0xee0d9600U, 0xfd5d65f4U, 0x0f36e6f7U,
+    0x61c69362U, 0x93ad1061U, 0x80fde395U, 0x72966096U, 0xa65c047dU, 0x5437877eU,
+    0x4767748aU, 0xb50cf789U, 0xeb1fcbadU, 0x197448aeU, 0x0a24bb5aU, 0xf84f3859U,
+    0x2c855cb2U, 0xdeeedfb1U, 0xcdbe2c45U, 0x3fd5af46U, 0x7198540dU, 0x83f3d70eU,
+    0x90a324faU, 0x62c8a7f9U, 0xb602c312U, 0x44694011U, 0x5739b3e5U, 0xa55230e6U,
+    0xfb410cc2U, 0x092a8fc1U, 0x1a7a7c35U, 0xe811ff36U, 0x3cdb9bddU, 0xceb018deU,
+    0xdde0eb2aU, 0x2f8b6829U, 0x82f63b78U, 0x709db87bU, 0x63cd4b8fU, 0x91a6c88cU,
+    0x456cac67U, 0xb7072f64U, 0xa457dc90U, 0x563c5f93U, 0x082f63b7U, 0xfa44e0b4U,
+    0xe9141340U, 0x1b7f9043U, 0xcfb5f4a8U, 0x3dde77abU, 0x2e8e845fU, 0xdce5075cU,
+    0x92a8fc17U, 0x60c37f14U, 0x73938ce0U, 0x81f80fe3U, 0x55326b08U, 0xa759e80bU,
+    0xb4091bffU, 0x466298fcU, 0x1871a4d8U, 0xea1a27dbU, 0xf94ad42fU, 0x0b21572cU,
+    0xdfeb33c7U, 0x2d80b0c4U, 0x3ed04330U, 0xccbbc033U, 0xa24bb5a6U, 0x502036a5U,
+    0x4370c551U, 0xb11b4652U, 0x65d122b9U, 0x97baa1baU, 0x84ea524eU, 0x7681d14dU,
+    0x2892ed69U, 0xdaf96e6aU, 0xc9a99d9eU, 0x3bc21e9dU, 0xef087a76U, 0x1d63f975U,
+    0x0e330a81U, 0xfc588982U, 0xb21572c9U, 0x407ef1caU, 0x532e023eU, 0xa145813dU,
+    0x758fe5d6U, 0x87e466d5U, 0x94b49521U, 0x66df1622U, 0x38cc2a06U, 0xcaa7a905U,
+    0xd9f75af1U, 0x2b9cd9f2U, 0xff56bd19U, 0x0d3d3e1aU, 0x1e6dcdeeU, 0xec064eedU,
+    0xc38d26c4U, 0x31e6a5c7U, 0x22b65633U, 0xd0ddd530U, 0x0417b1dbU, 0xf67c32d8U,
+    0xe52cc12cU, 0x1747422fU, 0x49547e0bU, 0xbb3ffd08U, 0xa86f0efcU, 0x5a048dffU,
+    0x8ecee914U, 0x7ca56a17U, 0x6ff599e3U, 0x9d9e1ae0U, 0xd3d3e1abU, 0x21b862a8U,
+    0x32e8915cU, 0xc083125fU, 0x144976b4U, 0xe622f5b7U, 0xf5720643U, 0x07198540U,
+    0x590ab964U, 0xab613a67U, 0xb831c993U, 0x4a5a4a90U, 0x9e902e7bU, 0x6cfbad78U,
+    0x7fab5e8cU, 0x8dc0dd8fU, 0xe330a81aU, 0x115b2b19U, 0x020bd8edU, 0xf0605beeU,
+    0x24aa3f05U, 0xd6c1bc06U, 0xc5914ff2U, 0x37faccf1U, 0x69e9f0d5U, 0x9b8273d6U,
+    0x88d28022U, 0x7ab90321U, 0xae7367caU, 0x5c18e4c9U, 0x4f48173dU, 0xbd23943eU,
+    0xf36e6f75U, 0x0105ec76U, 0x12551f82U, 0xe03e9c81U, 0x34f4f86aU, 0xc69f7b69U,
+    0xd5cf889dU, 0x27a40b9eU, 0x79b737baU, 0x8bdcb4b9U, 0x988c474dU, 0x6ae7c44eU,
+    0xbe2da0a5U, 0x4c4623a6U, 0x5f16d052U, 0xad7d5351U,
+};
+
+static uint32_t p_ucrc32c_sw(uint32_t crc, ulib_byte const *p, size_t size) {
+    for (; size; --size) crc = p_ucrc32c_table[(crc ^ *p++) & 0xffU] ^ (crc >> 8U);
+    return crc;
+}
+
+#if defined(P_UCRC32C_SSE42)
+
+__attribute__((target("sse4.2"))) static uint32_t
+p_ucrc32c_hw(uint32_t crc, ulib_byte const *p, size_t size) {
+    for (; size && ((uintptr_t)p & 7U); --size) crc = _mm_crc32_u8(crc, *p++);
+#if defined(__x86_64__)
+    uint64_t crc64 = crc;
+    for (; size >= 8; size -= 8, p += 8) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = (uint32_t)crc64;
+#endif
+    for (; size >= 4; size -= 4, p += 4) {
+        uint32_t word;
+        memcpy(&word, p, sizeof(word));
+        crc = _mm_crc32_u32(crc, word);
+    }
+    for (; size; --size) crc = _mm_crc32_u8(crc, *p++);
+    return crc;
+}
+
+#define p_ucrc32c_hw_available() __builtin_cpu_supports("sse4.2")
+
+#elif defined(P_UCRC32C_ARM)
+
+static uint32_t p_ucrc32c_hw(uint32_t crc, ulib_byte const *p, size_t size) {
+    for (; size && ((uintptr_t)p & 7U); --size) crc = __crc32cb(crc, *p++);
+    for (; size >= 8; size -= 8, p += 8) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+        crc = __crc32cd(crc, word);
+    }
+    for (; size; --size) crc = __crc32cb(crc, *p++);
+    return crc;
+}
+
+#define p_ucrc32c_hw_available() 1
+
+#endif
+
+uint32_t ucrc32c(uint32_t crc, void const *data, size_t size) {
+    crc = ~crc;
+#if defined(P_UCRC32C_SSE42) || defined(P_UCRC32C_ARM)
+    if (p_ucrc32c_hw_available()) return ~p_ucrc32c_hw(crc, data, size);
+#endif
+    return ~p_ucrc32c_sw(crc, data, size);
+}
+
+#define P_UXXH64_P1 0x9e3779b185ebca87ULL
+#define P_UXXH64_P2 0xc2b2ae3d27d4eb4fULL
+#define P_UXXH64_P3 0x165667b19e3779f9ULL
+#define P_UXXH64_P4 0x85ebca77c2b2ae63ULL
+#define P_UXXH64_P5 0x27d4eb2f165667c5ULL
+
+static inline uint64_t p_uxxh64_rotl(uint64_t x, unsigned r) {
+    return (x << r) | (x >> (64U - r));
+}
+
+static inline uint64_t p_uxxh64_read64(ulib_byte const *p) {
+    uint64_t v = 0;
+    for (unsigned i = 8; i--;) v = (v << 8U) | p[i];
+    return v;
+}
+
+static inline uint64_t p_uxxh64_read32(ulib_byte const *p) {
+    return (uint64_t)p[0] | (uint64_t)p[1] << 8U | (uint64_t)p[2] << 16U | (uint64_t)p[3] << 24U;
+}
+
+static inline uint64_t p_uxxh64_round(uint64_t acc, uint64_t input) {
+    acc += input * P_UXXH64_P2;
+    return p_uxxh64_rotl(acc, 31) * P_UXXH64_P1;
+}
+
+static inline uint64_t p_uxxh64_merge(uint64_t acc, uint64_t val) {
+    acc ^= p_uxxh64_round(0, val);
+    return acc * P_UXXH64_P1 + P_UXXH64_P4;
+}
+
+static void p_uxxh64_init(uint64_t *v, uint64_t seed) {
+    v[0] = seed + P_UXXH64_P1 + P_UXXH64_P2;
+    v[1] = seed + P_UXXH64_P2;
+    v[2] = seed;
+    v[3] = seed - P_UXXH64_P1;
+}
+
+// Processes as many 32 byte stripes as possible, returning the number of processed bytes.
+static size_t p_uxxh64_stripes(uint64_t *v, ulib_byte const *p, size_t size) {
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        v[0] = p_uxxh64_round(v[0], p_uxxh64_read64(p + i));
+        v[1] = p_uxxh64_round(v[1], p_uxxh64_read64(p + i + 8));
+        v[2] = p_uxxh64_round(v[2], p_uxxh64_read64(p + i + 16));
+        v[3] = p_uxxh64_round(v[3], p_uxxh64_read64(p + i + 24));
+    }
+    return i;
+}
+
+static uint64_t
+p_uxxh64_digest(uint64_t const *v, ulib_byte const *tail, uint64_t length, uint64_t seed) {
+    uint64_t h;
+
+    if (length >= 32) {
+        h = p_uxxh64_rotl(v[0], 1) + p_uxxh64_rotl(v[1], 7) + p_uxxh64_rotl(v[2], 12) +
+            p_uxxh64_rotl(v[3], 18);
+        for (unsigned i = 0; i < 4; ++i) h = p_uxxh64_merge(h, v[i]);
+    } else {
+        h = seed + P_UXXH64_P5;
+    }
+
+    h += length;
+    size_t size = (size_t)(length & 31U);
+
+    for (; size >= 8; size -= 8, tail += 8) {
+        h ^= p_uxxh64_round(0, p_uxxh64_read64(tail));
+        h = p_uxxh64_rotl(h, 27) * P_UXXH64_P1 + P_UXXH64_P4;
+    }
+
+    if (size >= 4) {
+        h ^= p_uxxh64_read32(tail) * P_UXXH64_P1;
+        h = p_uxxh64_rotl(h, 23) * P_UXXH64_P2 + P_UXXH64_P3;
+        size -= 4;
+        tail += 4;
+    }
+
+    for (; size; --size) {
+        h ^= *tail++ * P_UXXH64_P5;
+        h = p_uxxh64_rotl(h, 11) * P_UXXH64_P1;
+    }
+
+    h ^= h >> 33U;
+    h *= P_UXXH64_P2;
+    h ^= h >> 29U;
+    h *= P_UXXH64_P3;
+    h ^= h >> 32U;
+    return h;
+}
+
+uint64_t uxxh64(void const *data, size_t size, uint64_t seed) {
+    uint64_t v[4];
+    p_uxxh64_init(v, seed);
+    size_t done = p_uxxh64_stripes(v, data, size);
+    return p_uxxh64_digest(v, (ulib_byte const *)data + done, size, seed);
+}
+
+UChecksum uchecksum(uchecksum_type type) {
+    UChecksum checksum = { .type = type };
+    if (type == UCHECKSUM_XXH64) p_uxxh64_init(checksum._state, 0);
+    return checksum;
+}
+
+void uchecksum_update(UChecksum *checksum, void const *data, size_t size) {
+    if (checksum->type == UCHECKSUM_CRC32C) {
+        checksum->_state[0] = ucrc32c((uint32_t)checksum->_state[0], data, size);
+        checksum->_length += size;
+        return;
+    }
+
+    ulib_byte const *p = data;
+    size_t pending = (size_t)(checksum->_length & 31U);
+    checksum->_length += size;
+
+    if (pending) {
+        size_t n = ulib_min(size, 32 - pending);
+        memcpy(checksum->_buf + pending, p, n);
+        if (pending + n < 32) return;
+        p_uxxh64_stripes(checksum->_state, checksum->_buf, 32);
+        p += n;
+        size -= n;
+    }
+
+    size_t done = p_uxxh64_stripes(checksum->_state, p, size);
+    memcpy(checksum->_buf, p + done, size - done);
+}
+
+uint64_t uchecksum_value(UChecksum const *checksum) {
+    if (checksum->type == UCHECKSUM_CRC32C) return checksum->_state[0];
+    return p_uxxh64_digest(checksum->_state, checksum->_buf, checksum->_length, 0);
+}
+
+typedef struct UStreamChecksum {
+    void *stream;
+    UChecksum *checksum;
+    ulib_byte const *peeked;
+} UStreamChecksum;
+
+static ustream_ret ustream_checksum_read(void *ctx, void *buf, size_t count, size_t *read) {
+    UStreamChecksum *cs = ctx;
+    ustream_ret ret = uistream_read(cs->stream, buf, count, read);
+    uchecksum_update(cs->checksum, buf, *read);
+    return ret;
+}
+
+static ustream_ret ustream_checksum_peek(void *ctx, void const **buf, size_t *available) {
+    UStreamChecksum *cs = ctx;
+    ustream_ret ret = uistream_peek(cs->stream, buf, available);
+    cs->peeked = *buf;
+    return ret;
+}
+
+static ustream_ret ustream_checksum_consume(void *ctx, size_t count) {
+    UStreamChecksum *cs = ctx;
+    uchecksum_update(cs->checksum, cs->peeked, count);
+    cs->peeked += count;
+    return uistream_consume(cs->stream, count);
+}
+
+static ustream_ret ustream_checksum_reset(void *ctx) {
+    UStreamChecksum *cs = ctx;
+    *cs->checksum = uchecksum(cs->checksum->type);
+    return uistream_reset(cs->stream);
+}
+
+static ustream_ret ustream_checksum_ifree(void *ctx) {
+    UStreamChecksum *cs = ctx;
+    ustream_ret ret = uistream_deinit(cs->stream);
+    ulib_free(cs);
+    return ret;
+}
+
+static ustream_ret
+ustream_checksum_write(void *ctx, void const *buf, size_t count, size_t *written) {
+    UStreamChecksum *cs = ctx;
+    ustream_ret ret = uostream_write(cs->stream, buf, count, written);
+    uchecksum_update(cs->checksum, buf, *written);
+    return ret;
+}
+
+static ustream_ret
+ustream_checksum_writev(void *ctx, UStreamIOVec const *iov, size_t count, size_t *written) {
+    UStreamChecksum *cs = ctx;
+    ustream_ret ret = uostream_writev(cs->stream, iov, count, written);
+
+    for (size_t i = 0, left = *written; left; ++i) {
+        size_t n = ulib_min(left, iov[i].size);
+        uchecksum_update(cs->checksum, iov[i].data, n);
+        left -= n;
+    }
+
+    return ret;
+}
+
+static ustream_ret ustream_checksum_flush(void *ctx) {
+    return uostream_flush(((UStreamChecksum *)ctx)->stream);
+}
+
+static ustream_ret ustream_checksum_ofree(void *ctx) {
+    UStreamChecksum *cs = ctx;
+    ustream_ret ret = uostream_deinit(cs->stream);
+    ulib_free(cs);
+    return ret;
+}
+
+static UStreamChecksum *ustream_checksum_alloc(void *stream, UChecksum *checksum) {
+    UStreamChecksum *cs = ulib_alloc(cs);
+    if (cs) *cs = (UStreamChecksum){ .stream = stream, .checksum = checksum };
+    return cs;
+}
+
+ustream_ret uistream_checksum(UIStream *stream, UIStream *src, UChecksum *checksum) {
+    UStreamChecksum *cs = ustream_checksum_alloc(src, checksum);
+    *stream = (UIStream){ .state = cs ? USTREAM_OK : USTREAM_ERR_MEM };
+
+    if (!stream->state) {
+        stream->ctx = cs;
+        stream->read = ustream_checksum_read;
+        stream->reset = ustream_checksum_reset;
+        stream->free = ustream_checksum_ifree;
+        stream->peek = ustream_checksum_peek;
+        stream->consume = ustream_checksum_consume;
+    }
+
+    return stream->state;
+}
+
+ustream_ret uostream_checksum(UOStream *stream, UOStream *dst, UChecksum *checksum) {
+    UStreamChecksum *cs = ustream_checksum_alloc(dst, checksum);
+    *stream = (UOStream){ .state = cs ? USTREAM_OK : USTREAM_ERR_MEM };
+
+    if (!stream->state) {
+        stream->ctx = cs;
+        stream->write = ustream_checksum_write;
+        stream->flush = ustream_checksum_flush;
+        stream->free = ustream_checksum_ofree;
+        stream->writev = ustream_checksum_writev;
+    }
+
+    return stream->state;
+}
@@ -0,0 +1,140 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @note The byte hash function is wyhash (final version 4) by Wang Yi,
+ *       released into the public domain: https://github.com/wangyi-fudan/wyhash
+ *
+ * @file
+ */
+
+#include "uhash.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#pragma intrinsic(_umul128)
+#endif
+
+#if (defined __clang__ && __clang_major__ >= 3) || (defined __GNUC__ && __GNUC__ >= 3)
+#define p_likely(x) __builtin_expect(!!(x), 1)
+#define p_unlikely(x) __builtin_expect(!!(x), 0)
+#else
+#define p_likely(x) (x)
+#define p_unlikely(x) (x)
+#endif
+
+static uint64_t const p_wyp[4] = { 0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL,
+                                   0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL };
+
+// Seed passed to uhash_set_seed, and its premixed form (initially, that of a zero seed).
+static uint64_t p_uhash_seed = 0;
+static uint64_t p_uhash_mixed_seed = 0xca813bf4c7abf0a9ULL;
+
+static inline void p_wymum(uint64_t *a, uint64_t *b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = *a;
+    r *= *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64U);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    *a = _umul128(*a, *b, b);
+#else
+    uint64_t const ha = *a >> 32U, hb = *b >> 32U, la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t const rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t const t = rl + (rm0 << 32U);
+    uint64_t c = t < rl;
+    uint64_t const lo = t + (rm1 << 32U);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32U) + (rm1 >> 32U) + c;
+#endif
+}
+
+static inline uint64_t p_wymix(uint64_t a, uint64_t b) {
+    p_wymum(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t p_wyr8(uint8_t const *p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t p_wyr4(uint8_t const *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint64_t p_wyr3(uint8_t const *p, size_t k) {
+    return (((uint64_t)p[0]) << 16U) | (((uint64_t)p[k >> 1U]) << 8U) | p[k - 1];
+}
+
+static inline uint64_t p_wyhash(void const *key, size_t len, uint64_t seed) {
+    uint8_t const *p = (uint8_t const *)key;
+    uint64_t a, b;
+
+    if (p_likely(len <= 16)) {
+        if (p_likely(len >= 4)) {
+            a = (p_wyr4(p) << 32U) | p_wyr4(p + ((len >> 3U) << 2U));
+            b = (p_wyr4(p + len - 4) << 32U) | p_wyr4(p + len - 4 - ((len >> 3U) << 2U));
+        } else if (p_likely(len > 0)) {
+            a = p_wyr3(p, len);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+
+        if (p_unlikely(i > 48)) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = p_wymix(p_wyr8(p) ^ p_wyp[1], p_wyr8(p + 8) ^ seed);
+                see1 = p_wymix(p_wyr8(p + 16) ^ p_wyp[2], p_wyr8(p + 24) ^ see1);
+                see2 = p_wymix(p_wyr8(p + 32) ^ p_wyp[3], p_wyr8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (p_likely(i > 48));
+            seed ^= see1 ^ see2;
+        }
+
+        while (p_unlikely(i > 16)) {
+            seed = p_wymix(p_wyr8(p) ^ p_wyp[1], p_wyr8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+
+        a = p_wyr8(p + i - 16);
+        b = p_wyr8(p + i - 8);
+    }
+
+    a ^= p_wyp[1];
+    b ^= seed;
+    p_wymum(&a, &b);
+    return p_wymix(a ^ p_wyp[0] ^ len, b ^ p_wyp[1]);
+}
+
+static inline uint64_t p_uhash_mix_seed(uint64_t seed) {
+    return seed ^ p_wymix(seed ^ p_wyp[0], p_wyp[1]);
+}
+
+void uhash_set_seed(uint64_t seed) {
+    p_uhash_seed = seed;
+    p_uhash_mixed_seed = p_uhash_mix_seed(seed);
+}
+
+uint64_t uhash_get_seed(void) {
+    return p_uhash_seed;
+}
+
+ulib_uint uhash_bytes_hash(void const *data, size_t len) {
+    return (ulib_uint)p_wyhash(data, len, p_uhash_mixed_seed);
+}
+
+ulib_uint uhash_bytes_hash_seeded(void const *data, size_t len, uint64_t seed) {
+    return (ulib_uint)p_wyhash(data, len, p_uhash_mix_seed(seed));
+}
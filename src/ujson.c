@@ -0,0 +1,24 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "ujson.h"
+
+void p_ujson_write_escaped(UOStream *stream, char const *str) {
+    char const *start = str;
+
+    for (; *str; ++str) {
+        unsigned char const c = (unsigned char)*str;
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        uostream_write(stream, start, (size_t)(str - start), NULL);
+        uostream_writef(stream, NULL, "\\u%04x", (unsigned)c);
+        start = str + 1;
+    }
+
+    uostream_write(stream, start, (size_t)(str - start), NULL);
+}
@@ -0,0 +1,23 @@
+/**
+ * JSON helpers shared by the library sources.
+ *
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UJSON_H
+#define UJSON_H
+
+#include "ustream.h"
+
+/*
+ * Writes the contents of a JSON string, without the surrounding quotes.
+ * Control characters, quotes and backslashes are written as \u escapes.
+ */
+void p_ujson_write_escaped(UOStream *stream, char const *str);
+
+#endif // UJSON_H
@@ -0,0 +1,150 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "ulz4.h"
+
+#if !defined(ULIB_NO_COMPRESSION)
+
+#define P_ULZ4_MIN_MATCH 4U
+#define P_ULZ4_MF_LIMIT 12U
+#define P_ULZ4_LAST_LITERALS 5U
+#define P_ULZ4_MAX_OFFSET 65535U
+
+static inline uint32_t p_ulz4_read32(ulib_byte const *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t p_ulz4_hash(uint32_t seq) {
+    return (seq * 2654435761U) >> (32U - P_ULZ4_HASH_BITS);
+}
+
+static inline ulib_byte *p_ulz4_write_length(ulib_byte *op, size_t length) {
+    for (; length >= 255; length -= 255) *op++ = 255;
+    *op++ = (ulib_byte)length;
+    return op;
+}
+
+static inline ulib_byte *p_ulz4_write_literals(ulib_byte *op, ulib_byte *token,
+                                               ulib_byte const *literals, size_t length) {
+    *token = (ulib_byte)((length < 15 ? length : 15) << 4U);
+    if (length >= 15) op = p_ulz4_write_length(op, length - 15);
+    memcpy(op, literals, length);
+    return op + length;
+}
+
+size_t p_ulz4_compress(void const *src, size_t size, void *dst, uint32_t *table) {
+    ulib_byte const *const base = src, *const end = base + size;
+    ulib_byte const *ip = base, *anchor = base;
+    ulib_byte *op = dst;
+
+    if (size > P_ULZ4_MF_LIMIT) {
+        // Matches must start at least 12 bytes before the end, and end at least 5 bytes before it.
+        ulib_byte const *const match_limit = end - P_ULZ4_MF_LIMIT;
+        ulib_byte const *const match_end = end - P_ULZ4_LAST_LITERALS;
+        memset(table, 0, P_ULZ4_TABLE_SIZE * sizeof(*table));
+
+        while (ip < match_limit) {
+            uint32_t const seq = p_ulz4_read32(ip);
+            uint32_t const h = p_ulz4_hash(seq);
+            ulib_byte const *ref = base + table[h];
+            table[h] = (uint32_t)(ip - base);
+
+            if (ref >= ip || (size_t)(ip - ref) > P_ULZ4_MAX_OFFSET || p_ulz4_read32(ref) != seq) {
+                ++ip;
+                continue;
+            }
+
+            while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+                --ip;
+                --ref;
+            }
+
+            ulib_byte const *mp = ip + P_ULZ4_MIN_MATCH, *mr = ref + P_ULZ4_MIN_MATCH;
+            while (mp < match_end && *mp == *mr) {
+                ++mp;
+                ++mr;
+            }
+
+            ulib_byte *token = op++;
+            op = p_ulz4_write_literals(op, token, anchor, (size_t)(ip - anchor));
+
+            size_t const offset = (size_t)(ip - ref);
+            *op++ = (ulib_byte)(offset & 0xffU);
+            *op++ = (ulib_byte)(offset >> 8U);
+
+            size_t const length = (size_t)(mp - ip) - P_ULZ4_MIN_MATCH;
+            *token |= (ulib_byte)(length < 15 ? length : 15);
+            if (length >= 15) op = p_ulz4_write_length(op, length - 15);
+
+            anchor = ip = mp;
+            if (ip < match_limit) {
+                table[p_ulz4_hash(p_ulz4_read32(ip - 2))] = (uint32_t)(ip - 2 - base);
+            }
+        }
+    }
+
+    ulib_byte *token = op++;
+    op = p_ulz4_write_literals(op, token, anchor, (size_t)(end - anchor));
+    return (size_t)(op - (ulib_byte *)dst);
+}
+
+static inline bool p_ulz4_read_length(ulib_byte const **ip, ulib_byte const *end, size_t *length) {
+    ulib_byte b;
+    do {
+        if (*ip >= end) return false;
+        b = *(*ip)++;
+        *length += b;
+    } while (b == 255);
+    return true;
+}
+
+bool p_ulz4_decompress(void const *src, size_t size, void *dst, size_t cap, size_t *out_size) {
+    ulib_byte const *ip = src, *const iend = ip + size;
+    ulib_byte *const obase = dst, *op = obase, *const oend = obase + cap;
+
+    while (ip < iend) {
+        unsigned const token = *ip++;
+
+        size_t length = token >> 4U;
+        if (length == 15 && !p_ulz4_read_length(&ip, iend, &length)) return false;
+        if (length > (size_t)(iend - ip) || length > (size_t)(oend - op)) return false;
+        memcpy(op, ip, length);
+        op += length;
+        ip += length;
+
+        // The last sequence only has literals.
+        if (ip == iend) break;
+        if (iend - ip < 2) return false;
+
+        size_t const offset = (size_t)ip[0] | (size_t)ip[1] << 8U;
+        ip += 2;
+        if (!offset || offset > (size_t)(op - obase)) return false;
+
+        length = token & 15U;
+        if (length == 15 && !p_ulz4_read_length(&ip, iend, &length)) return false;
+        length += P_ULZ4_MIN_MATCH;
+        if (length > (size_t)(oend - op)) return false;
+
+        ulib_byte const *match = op - offset;
+        if (offset >= length) {
+            memcpy(op, match, length);
+            op += length;
+        } else {
+            // Overlapping matches repeat the last offset bytes.
+            for (size_t i = 0; i < length; ++i) *op++ = match[i];
+        }
+    }
+
+    *out_size = (size_t)(op - obase);
+    return true;
+}
+
+#endif
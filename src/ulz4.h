@@ -0,0 +1,39 @@
+/**
+ * LZ4 block codec shared by the library sources.
+ *
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef ULZ4_H
+#define ULZ4_H
+
+#include "ustd.h"
+
+/// Number of bits of the hash table used by the compressor.
+#define P_ULZ4_HASH_BITS 12U
+
+/// Size of the hash table used by the compressor, in entries.
+#define P_ULZ4_TABLE_SIZE (1U << P_ULZ4_HASH_BITS)
+
+/// Maximum compressed size of a block of the specified size.
+#define p_ulz4_bound(size) ((size) + (size) / 255U + 16U)
+
+/*
+ * Compresses a block in the LZ4 block format, returning the size of the compressed data.
+ * The destination buffer must be at least p_ulz4_bound(size) bytes large, and the hash table
+ * must have P_ULZ4_TABLE_SIZE entries. Its contents need not be initialized.
+ */
+size_t p_ulz4_compress(void const *src, size_t size, void *dst, uint32_t *table);
+
+/*
+ * Decompresses a block in the LZ4 block format, returning false if the data is malformed
+ * or does not fit in the destination buffer.
+ */
+bool p_ulz4_decompress(void const *src, size_t size, void *dst, size_t cap, size_t *out_size);
+
+#endif // ULZ4_H
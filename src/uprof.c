@@ -0,0 +1,307 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "uprof.h"
+#include "uhash.h"
+#include "uthread.h"
+
+#if defined(ULIB_PROFILE)
+
+// Allocations are prefixed by a header, preserving the alignment of the heap.
+typedef struct P_UProfHeader {
+    uint32_t site;
+    uint32_t generation;
+    size_t weight;
+} P_UProfHeader;
+
+#define P_UPROF_ALIGN _Alignof(max_align_t)
+#define P_UPROF_HEADER_SIZE                                                                        \
+    ((sizeof(P_UProfHeader) + P_UPROF_ALIGN - 1) & ~(size_t)(P_UPROF_ALIGN - 1))
+
+#define P_UPROF_SITE_NONE 0U
+#define P_UPROF_SITE_DROPPED UINT32_MAX
+
+// Site table, with open addressing. Slot indexes are stored in headers offset by one.
+static UProfSite p_uprof_sites[UPROF_MAX_SITES];
+static UProfStats p_uprof_totals = { 0 };
+static size_t p_uprof_interval = UPROF_SAMPLE_INTERVAL;
+static uint32_t p_uprof_generation = 0;
+static URWLock p_uprof_lock = URWLOCK_INIT;
+
+// Bytes left before the next sample, and state of the interval randomization.
+static p_ulib_thread_local size_t p_uprof_countdown = 0;
+static p_ulib_thread_local uint64_t p_uprof_rng = 0;
+
+static inline void *p_uprof_data(P_UProfHeader *header) {
+    return (ulib_byte *)header + P_UPROF_HEADER_SIZE;
+}
+
+static inline P_UProfHeader *p_uprof_header(void *ptr) {
+    return (P_UProfHeader *)(void *)((ulib_byte *)ptr - P_UPROF_HEADER_SIZE);
+}
+
+// Intervals are uniformly distributed in [interval / 2, interval * 3 / 2), so that
+// sampling does not alias with periodic allocation patterns.
+static size_t p_uprof_next_interval(size_t interval) {
+    if (!interval) return SIZE_MAX;
+    if (!p_uprof_rng) p_uprof_rng = (uint64_t)(uintptr_t)&p_uprof_rng | 1;
+
+    p_uprof_rng ^= p_uprof_rng << 13;
+    p_uprof_rng ^= p_uprof_rng >> 7;
+    p_uprof_rng ^= p_uprof_rng << 17;
+
+    size_t const next = interval / 2 + (size_t)(p_uprof_rng % interval);
+    return next ? next : 1;
+}
+
+static uint32_t p_uprof_site(char const *file, char const *fn, int line) {
+    ulib_uint const hash = uhash_x31_str_hash(fn) * 31 + (ulib_uint)line;
+    size_t const start = hash % UPROF_MAX_SITES;
+    size_t i = start;
+
+    do {
+        UProfSite *site = p_uprof_sites + i;
+
+        if (!site->file) {
+            *site = (UProfSite){ .file = file, .fn = fn, .line = line };
+            p_uprof_totals.sites++;
+            return (uint32_t)(i + 1);
+        }
+
+        if (site->line == line && strcmp(site->fn, fn) == 0 && strcmp(site->file, file) == 0) {
+            return (uint32_t)(i + 1);
+        }
+
+        i = (i + 1) % UPROF_MAX_SITES;
+    } while (i != start);
+
+    return P_UPROF_SITE_DROPPED;
+}
+
+// Records the allocation in the header if it must be sampled.
+static void p_uprof_sample_slow(P_UProfHeader *header, size_t size, char const *file,
+                                char const *fn, int line) {
+    urwlock_write_lock(&p_uprof_lock);
+
+    size_t const interval = p_uprof_interval;
+
+    if (!p_uprof_rng || !interval) {
+        // First allocation of the thread, or sampling is disabled.
+        p_uprof_countdown = p_uprof_next_interval(interval);
+        if (size < p_uprof_countdown) {
+            p_uprof_countdown -= size;
+            urwlock_write_unlock(&p_uprof_lock);
+            return;
+        }
+    }
+
+    // Every interval crossed by the allocation counts as a sample.
+    size_t const crossed = 1 + (size - p_uprof_countdown) / interval;
+    size_t const weight = crossed * interval;
+    p_uprof_countdown = p_uprof_next_interval(interval);
+
+    uint32_t const site = p_uprof_site(file, fn, line);
+
+    if (site == P_UPROF_SITE_DROPPED) {
+        p_uprof_totals.dropped++;
+    } else {
+        UProfSite *s = p_uprof_sites + site - 1;
+        s->samples++;
+        s->bytes += weight;
+        s->live_bytes += weight;
+    }
+
+    p_uprof_totals.samples++;
+    p_uprof_totals.bytes += weight;
+    p_uprof_totals.live_bytes += weight;
+
+    if (p_uprof_totals.live_bytes > p_uprof_totals.peak_bytes) {
+        p_uprof_totals.peak_bytes = p_uprof_totals.live_bytes;
+    }
+
+    header->site = site;
+    header->generation = p_uprof_generation;
+    header->weight = weight;
+    urwlock_write_unlock(&p_uprof_lock);
+}
+
+static inline void
+p_uprof_sample(P_UProfHeader *header, size_t size, char const *file, char const *fn, int line) {
+    header->site = P_UPROF_SITE_NONE;
+
+    if (size < p_uprof_countdown) {
+        p_uprof_countdown -= size;
+    } else {
+        p_uprof_sample_slow(header, size, file, fn, line);
+    }
+}
+
+static void p_uprof_release(P_UProfHeader const *header) {
+    if (header->site == P_UPROF_SITE_NONE) return;
+
+    urwlock_write_lock(&p_uprof_lock);
+
+    if (header->generation == p_uprof_generation) {
+        if (header->site != P_UPROF_SITE_DROPPED) {
+            p_uprof_sites[header->site - 1].live_bytes -= header->weight;
+        }
+        p_uprof_totals.live_bytes -= header->weight;
+    }
+
+    urwlock_write_unlock(&p_uprof_lock);
+}
+
+void *p_uprof_malloc_impl(size_t size, char const *file, char const *fn, int line) {
+    if (size > SIZE_MAX - P_UPROF_HEADER_SIZE) return NULL;
+    P_UProfHeader *header = P_UPROF_HEAP_MALLOC(P_UPROF_HEADER_SIZE + size);
+    if (!header) return NULL;
+    p_uprof_sample(header, size, file, fn, line);
+    return p_uprof_data(header);
+}
+
+void *p_uprof_calloc_impl(size_t num, size_t size, char const *file, char const *fn, int line) {
+    if (size && num > (SIZE_MAX - P_UPROF_HEADER_SIZE) / size) return NULL;
+    P_UProfHeader *header = P_UPROF_HEAP_CALLOC(1, P_UPROF_HEADER_SIZE + num * size);
+    if (!header) return NULL;
+    p_uprof_sample(header, num * size, file, fn, line);
+    return p_uprof_data(header);
+}
+
+void *p_uprof_realloc_impl(void *ptr, size_t size, char const *file, char const *fn, int line) {
+    if (!ptr) return p_uprof_malloc_impl(size, file, fn, line);
+    if (size > SIZE_MAX - P_UPROF_HEADER_SIZE) return NULL;
+
+    P_UProfHeader const old_header = *p_uprof_header(ptr);
+    P_UProfHeader *header = P_UPROF_HEAP_REALLOC(p_uprof_header(ptr), P_UPROF_HEADER_SIZE + size);
+    if (!header) return NULL;
+
+    // Reallocations are accounted for as a deallocation followed by an allocation.
+    p_uprof_release(&old_header);
+    p_uprof_sample(header, size, file, fn, line);
+    return p_uprof_data(header);
+}
+
+void p_uprof_free_impl(void *ptr) {
+    if (!ptr) return;
+    P_UProfHeader *header = p_uprof_header(ptr);
+    p_uprof_release(header);
+    P_UPROF_HEAP_FREE(header);
+}
+
+void uprof_set_sample_interval(size_t bytes) {
+    urwlock_write_lock(&p_uprof_lock);
+    p_uprof_interval = bytes;
+    p_uprof_countdown = p_uprof_next_interval(bytes);
+    urwlock_write_unlock(&p_uprof_lock);
+}
+
+size_t uprof_sample_interval(void) {
+    urwlock_read_lock(&p_uprof_lock);
+    size_t const interval = p_uprof_interval;
+    urwlock_read_unlock(&p_uprof_lock);
+    return interval;
+}
+
+UProfStats uprof_stats(void) {
+    urwlock_read_lock(&p_uprof_lock);
+    UProfStats const stats = p_uprof_totals;
+    urwlock_read_unlock(&p_uprof_lock);
+    return stats;
+}
+
+static int p_uprof_site_cmp(void const *lhs, void const *rhs) {
+    size_t const l = ((UProfSite const *)lhs)->bytes, r = ((UProfSite const *)rhs)->bytes;
+    return l < r ? 1 : (l > r ? -1 : 0);
+}
+
+ulib_uint uprof_sites(UProfSite *sites, ulib_uint count) {
+    UProfSite *all = P_UPROF_HEAP_MALLOC(sizeof(p_uprof_sites));
+    if (!all) return 0;
+
+    size_t n = 0;
+    urwlock_read_lock(&p_uprof_lock);
+    for (size_t i = 0; i < UPROF_MAX_SITES; ++i) {
+        if (p_uprof_sites[i].file) all[n++] = p_uprof_sites[i];
+    }
+    urwlock_read_unlock(&p_uprof_lock);
+
+    qsort(all, n, sizeof(*all), p_uprof_site_cmp);
+    if (n > count) n = count;
+    memcpy(sites, all, n * sizeof(*all));
+    P_UPROF_HEAP_FREE(all);
+    return (ulib_uint)n;
+}
+
+void uprof_reset(void) {
+    urwlock_write_lock(&p_uprof_lock);
+    memset(p_uprof_sites, 0, sizeof(p_uprof_sites));
+    p_uprof_totals = (UProfStats){ 0 };
+    p_uprof_generation++;
+    urwlock_write_unlock(&p_uprof_lock);
+}
+
+static void p_uprof_report_sites(UOStream *stream, ulib_uint count) {
+    if (count > UPROF_MAX_SITES) count = UPROF_MAX_SITES;
+    if (!count) return;
+
+    UProfSite *sites = P_UPROF_HEAP_MALLOC(count * sizeof(*sites));
+    if (!sites) return;
+    count = uprof_sites(sites, count);
+
+    for (ulib_uint i = 0; i < count; ++i) {
+        UProfSite const *site = sites + i;
+        uostream_writef(stream, NULL, "%llu bytes (%llu live) in %llu samples: %s, %s, line %d\n",
+                        (unsigned long long)site->bytes, (unsigned long long)site->live_bytes,
+                        (unsigned long long)site->samples, site->file, site->fn, site->line);
+    }
+
+    P_UPROF_HEAP_FREE(sites);
+}
+
+#else
+
+void uprof_set_sample_interval(ulib_unused size_t bytes) {}
+
+size_t uprof_sample_interval(void) {
+    return 0;
+}
+
+UProfStats uprof_stats(void) {
+    return (UProfStats){ 0 };
+}
+
+ulib_uint uprof_sites(ulib_unused UProfSite *sites, ulib_unused ulib_uint count) {
+    return 0;
+}
+
+void uprof_reset(void) {}
+
+static void p_uprof_report_sites(ulib_unused UOStream *stream, ulib_unused ulib_uint count) {}
+
+#endif // ULIB_PROFILE
+
+ustream_ret uprof_report(UOStream *stream, ulib_uint count, size_t *written) {
+    size_t const start = stream->written_bytes;
+    UProfStats const stats = uprof_stats();
+
+    uostream_writef(stream, NULL,
+                    "samples: %llu, bytes: %llu, live: %llu, peak: %llu, interval: %llu\n",
+                    (unsigned long long)stats.samples, (unsigned long long)stats.bytes,
+                    (unsigned long long)stats.live_bytes, (unsigned long long)stats.peak_bytes,
+                    (unsigned long long)uprof_sample_interval());
+
+    if (stats.dropped) {
+        uostream_writef(stream, NULL, "dropped: %llu\n", (unsigned long long)stats.dropped);
+    }
+
+    p_uprof_report_sites(stream, count);
+
+    if (written) *written = stream->written_bytes - start;
+    return stream->state;
+}
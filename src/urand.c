@@ -8,50 +8,127 @@
  */
 
 #include "urand.h"
+#include "uthread.h"
 
-#ifndef ULIB_RAND
-#define ULIB_RAND rand
-#endif
-
-#ifndef ULIB_SRAND
-#define ULIB_SRAND srand
-#endif
+#define P_URAND_DEFAULT_SEED 0x853c49e6748fea9bULL
 
 char const default_charset_buf[] = "0123456789abcdefghijklmnopqrstuvwxyz";
-UString const default_charset = { ._l = { sizeof(default_charset_buf), default_charset_buf } };
+
+// Default generator of the calling thread. Threads are seeded in order of first use.
+static p_ulib_thread_local URandGen p_urand_default;
+static p_ulib_thread_local bool p_urand_default_seeded = false;
+static uint64_t p_urand_threads = 0;
+static URWLock p_urand_lock = URWLOCK_INIT;
 
 UString const *urand_default_charset(void) {
+    // Built lazily, as whether the charset fits inline depends on the small string capacity.
+    // The lock guards against concurrent first calls.
+    static UString default_charset;
+    urwlock_write_lock(&p_urand_lock);
+    if (!ustring_length(default_charset)) {
+        default_charset = ustring_wrap(default_charset_buf, sizeof(default_charset_buf) - 1);
+    }
+    urwlock_write_unlock(&p_urand_lock);
     return &default_charset;
 }
 
-void urand_set_seed(ulib_uint seed) {
-    ULIB_SRAND((unsigned)seed);
+static inline uint64_t p_urand_splitmix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27U)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31U);
 }
 
-ulib_int urand(void) {
-    return (ulib_int)ULIB_RAND();
+// Returns the high 64 bits of the 128-bit product of a and b, and stores the low ones in lo.
+static inline uint64_t p_urand_mul128(uint64_t a, uint64_t b, uint64_t *lo) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t const r = (__uint128_t)a * b;
+    *lo = (uint64_t)r;
+    return (uint64_t)(r >> 64U);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    uint64_t hi;
+    *lo = _umul128(a, b, &hi);
+    return hi;
+#else
+    uint64_t const ha = a >> 32U, hb = b >> 32U, la = (uint32_t)a, lb = (uint32_t)b;
+    uint64_t const rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t const t = rl + (rm0 << 32U);
+    uint64_t c = t < rl;
+    *lo = t + (rm1 << 32U);
+    c += *lo < t;
+    return rh + (rm0 >> 32U) + (rm1 >> 32U) + c;
+#endif
 }
 
-ulib_int urand_range(ulib_int start, ulib_uint len) {
+// Lemire's multiply-shift reduction, rejecting the few products that would bias the result.
+static uint64_t p_urand_bounded(URandGen *gen, uint64_t len) {
+    if (len <= UINT32_MAX) {
+        uint32_t const n = (uint32_t)len;
+        uint64_t m = (urand_gen_next(gen) >> 32U) * n;
+
+        if ((uint32_t)m < n) {
+            uint32_t const threshold = -n % n;
+            while ((uint32_t)m < threshold) m = (urand_gen_next(gen) >> 32U) * n;
+        }
+
+        return m >> 32U;
+    }
+
+    uint64_t lo, hi = p_urand_mul128(urand_gen_next(gen), len, &lo);
+
+    if (lo < len) {
+        uint64_t const threshold = -len % len;
+        while (lo < threshold) hi = p_urand_mul128(urand_gen_next(gen), len, &lo);
+    }
+
+    return hi;
+}
+
+URandGen urand_gen(uint64_t seed) {
+    URandGen gen;
+    for (unsigned i = 0; i < ulib_array_count(gen._state); ++i) {
+        gen._state[i] = p_urand_splitmix64(&seed);
+    }
+    return gen;
+}
+
+URandGen *urand_default_gen(void) {
+    if (!p_urand_default_seeded) {
+        urwlock_write_lock(&p_urand_lock);
+        uint64_t const thread = p_urand_threads++;
+        urwlock_write_unlock(&p_urand_lock);
+        p_urand_default = urand_gen(P_URAND_DEFAULT_SEED + thread);
+        p_urand_default_seeded = true;
+    }
+    return &p_urand_default;
+}
+
+ulib_int urand_gen_range(URandGen *gen, ulib_int start, ulib_uint len) {
     if (!len) return start;
-    return start + (ulib_int)(urand() % len);
+    return (ulib_int)((ulib_uint)start + (ulib_uint)p_urand_bounded(gen, len));
 }
 
-UString urand_string(ulib_uint len, UString const *charset) {
-    UString ret;
-    char *buf = ustring(&ret, len);
-    if (ustring_is_empty(ret)) return ret;
-    urand_str(len, buf, charset);
-    return ret;
+void urand_gen_fill(URandGen *gen, void *buf, size_t size) {
+    ulib_byte *cur = buf;
+
+    for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t), cur += sizeof(uint64_t)) {
+        uint64_t const bits = urand_gen_next(gen);
+        memcpy(cur, &bits, sizeof(bits));
+    }
+
+    if (size) {
+        uint64_t const bits = urand_gen_next(gen);
+        memcpy(cur, &bits, size);
+    }
 }
 
-void urand_str(ulib_uint len, char *buf, UString const *charset) {
+void urand_gen_str(URandGen *gen, ulib_uint len, char *buf, UString const *charset) {
     if (!len) return;
 
     char const *chars;
     ulib_uint char_len;
 
-    if (charset) {
+    if (charset && !ustring_is_empty(*charset)) {
         chars = ustring_data(*charset);
         char_len = ustring_length(*charset);
     } else {
@@ -59,5 +136,68 @@ void urand_str(ulib_uint len, char *buf, UString const *charset) {
         char_len = sizeof(default_charset_buf) - 1;
     }
 
-    while (len--) buf[len] = chars[urand_range(0, char_len)];
+    if (char_len > 256) {
+        for (ulib_uint i = 0; i < len; ++i) buf[i] = chars[p_urand_bounded(gen, char_len)];
+        return;
+    }
+
+    // Small charsets are indexed by four independent 16-bit lanes of each draw.
+    // Each lane is reduced as in p_urand_bounded, and the rare biased ones are skipped.
+    uint32_t const n = (uint32_t)char_len;
+    uint32_t const threshold = (0x10000U - n) % n;
+
+    for (ulib_uint i = 0; i < len;) {
+        uint64_t bits = urand_gen_next(gen);
+        for (unsigned lane = 0; lane < 4 && i < len; ++lane, bits >>= 16U) {
+            uint32_t const m = (uint32_t)(bits & 0xFFFFU) * n;
+            if ((m & 0xFFFFU) >= threshold) buf[i++] = chars[m >> 16U];
+        }
+    }
+}
+
+void urand_gen_jump(URandGen *gen) {
+    static uint64_t const jump[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                     0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+    uint64_t s[4] = { 0 };
+
+    for (unsigned i = 0; i < ulib_array_count(jump); ++i) {
+        for (unsigned b = 0; b < 64; ++b) {
+            if (jump[i] & (1ULL << b)) {
+                for (unsigned j = 0; j < 4; ++j) s[j] ^= gen->_state[j];
+            }
+            urand_gen_next(gen);
+        }
+    }
+
+    memcpy(gen->_state, s, sizeof(s));
+}
+
+void urand_set_seed(ulib_uint seed) {
+    p_urand_default = urand_gen(seed);
+    p_urand_default_seeded = true;
+}
+
+ulib_int urand(void) {
+    // The top bits are the strongest, and the sign bit is cleared.
+    return (ulib_int)(urand_gen_next(urand_default_gen()) >> (65U - sizeof(ulib_int) * 8U));
+}
+
+ulib_int urand_range(ulib_int start, ulib_uint len) {
+    return urand_gen_range(urand_default_gen(), start, len);
+}
+
+void urand_fill(void *buf, size_t size) {
+    urand_gen_fill(urand_default_gen(), buf, size);
+}
+
+UString urand_string(ulib_uint len, UString const *charset) {
+    UString ret;
+    char *buf = ustring(&ret, len);
+    if (ustring_is_empty(ret)) return ret;
+    urand_str(len, buf, charset);
+    return ret;
+}
+
+void urand_str(ulib_uint len, char *buf, UString const *charset) {
+    urand_gen_str(urand_default_gen(), len, buf, charset);
 }
@@ -0,0 +1,89 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "userial.h"
+
+#define P_USERIAL_VERSION 1U
+#define P_USERIAL_HEADER_SIZE 44U
+
+// Stored in native byte order, so that readers can detect a byte order mismatch.
+static uint32_t const p_userial_byte_order = 0x01020304U;
+static char const p_userial_magic[4] = { 'U', 'L', 'S', 'R' };
+
+static char *p_userial_put(char *buf, void const *data, size_t size) {
+    memcpy(buf, data, size);
+    return buf + size;
+}
+
+static char const *p_userial_get(char const *buf, void *data, size_t size) {
+    memcpy(data, buf, size);
+    return buf + size;
+}
+
+ustream_ret p_userial_write_header(UOStream *stream, P_USerialInfo const *info) {
+    char header[P_USERIAL_HEADER_SIZE];
+    unsigned char const fields[4] = { P_USERIAL_VERSION, (unsigned char)info->kind,
+                                      (unsigned char)sizeof(ulib_uint), 0 };
+    uint32_t const key_size = (uint32_t)info->key_size, val_size = (uint32_t)info->val_size;
+
+    char *cur = p_userial_put(header, p_userial_magic, sizeof(p_userial_magic));
+    cur = p_userial_put(cur, fields, sizeof(fields));
+    cur = p_userial_put(cur, &p_userial_byte_order, sizeof(p_userial_byte_order));
+    cur = p_userial_put(cur, &key_size, sizeof(key_size));
+    cur = p_userial_put(cur, &val_size, sizeof(val_size));
+    cur = p_userial_put(cur, &info->count, sizeof(info->count));
+    cur = p_userial_put(cur, &info->size, sizeof(info->size));
+    p_userial_put(cur, &info->occupied, sizeof(info->occupied));
+
+    return uostream_write(stream, header, sizeof(header), NULL);
+}
+
+ustream_ret p_userial_read_header(UIStream *stream, P_USerialInfo *info) {
+    char header[P_USERIAL_HEADER_SIZE];
+    ustream_ret ret = p_userial_read(stream, header, sizeof(header));
+    if (ret) return ret;
+
+    char magic[sizeof(p_userial_magic)];
+    unsigned char fields[4];
+    uint32_t byte_order, key_size, val_size;
+
+    char const *cur = p_userial_get(header, magic, sizeof(magic));
+    cur = p_userial_get(cur, fields, sizeof(fields));
+    cur = p_userial_get(cur, &byte_order, sizeof(byte_order));
+    cur = p_userial_get(cur, &key_size, sizeof(key_size));
+    cur = p_userial_get(cur, &val_size, sizeof(val_size));
+    cur = p_userial_get(cur, &info->count, sizeof(info->count));
+    cur = p_userial_get(cur, &info->size, sizeof(info->size));
+    p_userial_get(cur, &info->occupied, sizeof(info->occupied));
+
+    if (memcmp(magic, p_userial_magic, sizeof(magic)) != 0 || fields[0] != P_USERIAL_VERSION ||
+        fields[2] != sizeof(ulib_uint) || byte_order != p_userial_byte_order) {
+        return USTREAM_ERR;
+    }
+
+    info->kind = fields[1];
+    info->key_size = key_size;
+    info->val_size = val_size;
+    return USTREAM_OK;
+}
+
+ustream_ret p_userial_read(UIStream *stream, void *buf, size_t size) {
+    char *cur = buf;
+
+    while (size) {
+        size_t read;
+        ustream_ret ret = uistream_read(stream, cur, size, &read);
+        if (ret) return ret;
+        if (!read) return USTREAM_ERR_BOUNDS;
+        cur += read;
+        size -= read;
+    }
+
+    return USTREAM_OK;
+}
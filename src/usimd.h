@@ -0,0 +1,194 @@
+/**
+ * SIMD primitives shared by the library sources.
+ *
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef USIMD_H
+#define USIMD_H
+
+#include "ustd.h"
+
+/*
+ * SIMD primitives, operating on 16 byte vectors. Comparisons set all bits of matching lanes,
+ * and p_usimd_mask returns a bitmask with 1 << P_USIMD_SHIFT bits per byte,
+ * of which at least the highest is set for bytes belonging to matching lanes.
+ */
+#if defined(P_ULIB_SIMD_SSE2)
+
+#include <emmintrin.h>
+
+#define P_USIMD 1
+#define P_USIMD_SHIFT 0U
+
+typedef __m128i p_usimd;
+
+#define p_usimd_load(p) _mm_loadu_si128((__m128i const *)(p))
+#define p_usimd_store(p, v) _mm_storeu_si128((__m128i *)(p), v)
+#define p_usimd_mask(v) ((uint64_t)(unsigned)_mm_movemask_epi8(v))
+#define p_usimd_or(a, b) _mm_or_si128(a, b)
+#define p_usimd_and(a, b) _mm_and_si128(a, b)
+#define p_usimd_xor(a, b) _mm_xor_si128(a, b)
+#define p_usimd_and_not(a, b) _mm_andnot_si128(b, a)
+#define p_usimd_sub_8(a, b) _mm_sub_epi8(a, b)
+#define p_usimd_le_u8(a, b) _mm_cmpeq_epi8(_mm_min_epu8(a, b), a)
+
+#define p_usimd_splat_8(x) _mm_set1_epi8((char)(x))
+#define p_usimd_splat_16(x) _mm_set1_epi16((short)(x))
+#define p_usimd_splat_32(x) _mm_set1_epi32((int)(x))
+#define p_usimd_splat_64(x) _mm_set1_epi64x((long long)(x))
+#define p_usimd_splat_f32(x) _mm_castps_si128(_mm_set1_ps(x))
+#define p_usimd_splat_f64(x) _mm_castpd_si128(_mm_set1_pd(x))
+
+#define p_usimd_eq_8(a, b) _mm_cmpeq_epi8(a, b)
+#define p_usimd_eq_16(a, b) _mm_cmpeq_epi16(a, b)
+#define p_usimd_eq_32(a, b) _mm_cmpeq_epi32(a, b)
+#define p_usimd_eq_f32(a, b)                                                                       \
+    _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b)))
+#define p_usimd_eq_f64(a, b)                                                                       \
+    _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b)))
+
+// SSE2 has no 64-bit comparisons: lanes match if both of their 32-bit halves do.
+static inline __m128i p_usimd_eq_64(__m128i a, __m128i b) {
+    __m128i eq = _mm_cmpeq_epi32(a, b);
+    return _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+#elif defined(P_ULIB_SIMD_NEON)
+
+#include <arm_neon.h>
+
+#define P_USIMD 1
+#define P_USIMD_SHIFT 2U
+
+typedef uint8x16_t p_usimd;
+
+#define p_usimd_load(p) vld1q_u8((uint8_t const *)(p))
+#define p_usimd_store(p, v) vst1q_u8((uint8_t *)(p), v)
+#define p_usimd_or(a, b) vorrq_u8(a, b)
+#define p_usimd_and(a, b) vandq_u8(a, b)
+#define p_usimd_xor(a, b) veorq_u8(a, b)
+#define p_usimd_and_not(a, b) vbicq_u8(a, b)
+#define p_usimd_sub_8(a, b) vsubq_u8(a, b)
+#define p_usimd_le_u8(a, b) vcleq_u8(a, b)
+
+static inline uint64_t p_usimd_mask(uint8x16_t v) {
+    uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(v), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) & 0x8888888888888888ULL;
+}
+
+#define p_usimd_splat_8(x) vdupq_n_u8((uint8_t)(x))
+#define p_usimd_splat_16(x) vreinterpretq_u8_u16(vdupq_n_u16((uint16_t)(x)))
+#define p_usimd_splat_32(x) vreinterpretq_u8_u32(vdupq_n_u32((uint32_t)(x)))
+#define p_usimd_splat_64(x) vreinterpretq_u8_u64(vdupq_n_u64((uint64_t)(x)))
+#define p_usimd_splat_f32(x) vreinterpretq_u8_f32(vdupq_n_f32(x))
+
+#define p_usimd_eq_8(a, b) vceqq_u8(a, b)
+#define p_usimd_eq_16(a, b)                                                                        \
+    vreinterpretq_u8_u16(vceqq_u16(vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b)))
+#define p_usimd_eq_32(a, b)                                                                        \
+    vreinterpretq_u8_u32(vceqq_u32(vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b)))
+#define p_usimd_eq_f32(a, b)                                                                       \
+    vreinterpretq_u8_u32(vceqq_f32(vreinterpretq_f32_u8(a), vreinterpretq_f32_u8(b)))
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+
+#define p_usimd_splat_f64(x) vreinterpretq_u8_f64(vdupq_n_f64(x))
+#define p_usimd_eq_64(a, b)                                                                        \
+    vreinterpretq_u8_u64(vceqq_u64(vreinterpretq_u64_u8(a), vreinterpretq_u64_u8(b)))
+#define p_usimd_eq_f64(a, b)                                                                       \
+    vreinterpretq_u8_u64(vceqq_f64(vreinterpretq_f64_u8(a), vreinterpretq_f64_u8(b)))
+
+#else
+
+// 32-bit NEON has no 64-bit comparisons: lanes match if both of their 32-bit halves do.
+static inline uint8x16_t p_usimd_eq_64(uint8x16_t a, uint8x16_t b) {
+    uint32x4_t eq = vceqq_u32(vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b));
+    return vreinterpretq_u8_u32(vandq_u32(eq, vrev64q_u32(eq)));
+}
+
+// 32-bit NEON has no double precision support: lanes are compared individually.
+static inline uint8x16_t p_usimd_splat_f64(double x) {
+    double const lanes[] = { x, x };
+    return vld1q_u8((uint8_t const *)lanes);
+}
+
+static inline uint8x16_t p_usimd_eq_f64(uint8x16_t a, uint8x16_t b) {
+    double x[2], y[2];
+    vst1q_u8((uint8_t *)x, a);
+    vst1q_u8((uint8_t *)y, b);
+    uint64_t const eq[] = { x[0] == y[0] ? UINT64_MAX : 0, x[1] == y[1] ? UINT64_MAX : 0 };
+    return vld1q_u8((uint8_t const *)eq);
+}
+
+#endif
+
+#endif
+
+#if defined(P_USIMD)
+
+static inline unsigned p_usimd_first(uint64_t mask) {
+#if defined(__GNUC__)
+    unsigned i = (unsigned)__builtin_ctzll(mask);
+#else
+    unsigned i = 0;
+    while (!((mask >> i) & 1U)) ++i;
+#endif
+    return i >> P_USIMD_SHIFT;
+}
+
+static inline unsigned p_usimd_last(uint64_t mask) {
+#if defined(__GNUC__)
+    unsigned i = 63U - (unsigned)__builtin_clzll(mask);
+#else
+    unsigned i = 63U;
+    while (!((mask >> i) & 1U)) --i;
+#endif
+    return i >> P_USIMD_SHIFT;
+}
+
+// Clears the bits of the specified mask corresponding to the byte at the specified index.
+static inline uint64_t p_usimd_clear(uint64_t mask, unsigned i) {
+    return mask & ~((((uint64_t)1 << (1U << P_USIMD_SHIFT)) - 1) << (i << P_USIMD_SHIFT));
+}
+
+// Returns the number of bytes belonging to matching lanes.
+static inline unsigned p_usimd_count(uint64_t mask) {
+#if P_USIMD_SHIFT
+    mask &= 0x1111111111111111ULL << ((1U << P_USIMD_SHIFT) - 1);
+#endif
+#if defined(__GNUC__)
+    return (unsigned)__builtin_popcountll(mask);
+#else
+    unsigned count = 0;
+    for (; mask; mask &= mask - 1) ++count;
+    return count;
+#endif
+}
+
+// Returns a mask of the bytes that are not ASCII characters.
+static inline uint64_t p_usimd_non_ascii(p_usimd v) {
+    return p_usimd_mask(p_usimd_le_u8(p_usimd_splat_8(0x80), v));
+}
+
+// Flips the case of the bytes in the range [first, first + 25], i.e. of ASCII letters.
+static inline p_usimd p_usimd_flip_case(p_usimd v, char first) {
+    p_usimd const in_range = p_usimd_le_u8(p_usimd_sub_8(v, p_usimd_splat_8(first)),
+                                           p_usimd_splat_8(25));
+    return p_usimd_xor(v, p_usimd_and(in_range, p_usimd_splat_8(0x20)));
+}
+
+// Converts ASCII uppercase letters to lowercase.
+#define p_usimd_to_lower(v) p_usimd_flip_case(v, 'A')
+
+// Converts ASCII lowercase letters to uppercase.
+#define p_usimd_to_upper(v) p_usimd_flip_case(v, 'a')
+
+#endif
+
+#endif // USIMD_H
@@ -8,8 +8,13 @@
  */
 
 #include "ustrbuf.h"
+#include <float.h>
+#include <math.h>
 #include <stdarg.h>
 
+// Minimum spare capacity before formatting a string.
+#define P_USTRBUF_FORMAT_MIN_SPARE 64
+
 uvec_ret ustrbuf_append_format(UStrBuf *buf, char const *format, ...) {
     va_list args;
     va_start(args, format);
@@ -19,16 +24,184 @@ uvec_ret ustrbuf_append_format(UStrBuf *buf, char const *format, ...) {
 }
 
 uvec_ret ustrbuf_append_format_list(UStrBuf *buf, char const *format, va_list args) {
-    size_t length = ulib_str_flength_list(format, args);
-    size_t size = length + 1;
-    uvec_ret ret = uvec_expand(char, buf, (ulib_uint)size);
+    // Try formatting into the spare capacity first, so that the format string
+    // only needs to be processed twice when the buffer must grow. Room for short
+    // strings is made upfront, so that they are always formatted once.
+    if (ustrbuf_size(buf) - buf->_count < P_USTRBUF_FORMAT_MIN_SPARE &&
+        uvec_expand(char, buf, P_USTRBUF_FORMAT_MIN_SPARE)) {
+        return UVEC_ERR;
+    }
+
+    size_t const spare = ustrbuf_size(buf) - buf->_count;
+    va_list copy;
+    va_copy(copy, args);
+    int res = vsnprintf(spare ? ustrbuf_data(buf) + buf->_count : NULL, spare, format, copy);
+    va_end(copy);
 
-    if (ret == UVEC_OK) {
-        vsnprintf(ustrbuf_data(buf) + buf->_count, size, format, args);
-        buf->_count += (ulib_uint)length;
+    if (res < 0) return UVEC_ERR;
+    size_t length = (size_t)res;
+
+    if (length >= spare) {
+        if (length >= (size_t)(ULIB_UINT_MAX - buf->_count)) return UVEC_ERR;
+        if (uvec_expand(char, buf, (ulib_uint)(length + 1))) return UVEC_ERR;
+        vsnprintf(ustrbuf_data(buf) + buf->_count, length + 1, format, args);
     }
 
-    return ret;
+    buf->_count += (ulib_uint)length;
+    return UVEC_OK;
+}
+
+static char const ustrbuf_digit_pairs[] = "00010203040506070809"
+                                          "10111213141516171819"
+                                          "20212223242526272829"
+                                          "30313233343536373839"
+                                          "40414243444546474849"
+                                          "50515253545556575859"
+                                          "60616263646566676869"
+                                          "70717273747576777879"
+                                          "80818283848586878889"
+                                          "90919293949596979899";
+
+static inline ulib_uint ustrbuf_uint_digits(ulib_uint value) {
+    ulib_uint digits = 1;
+    for (; value >= 100; value /= 100) digits += 2;
+    return value >= 10 ? digits + 1 : digits;
+}
+
+// Writes the digits of the specified value backwards, starting from 'end'.
+static inline void ustrbuf_write_uint(char *end, ulib_uint value) {
+    for (; value >= 100; value /= 100) {
+        char const *pair = ustrbuf_digit_pairs + (value % 100) * 2;
+        *--end = pair[1];
+        *--end = pair[0];
+    }
+
+    if (value >= 10) {
+        char const *pair = ustrbuf_digit_pairs + value * 2;
+        *--end = pair[1];
+        *--end = pair[0];
+    } else {
+        *--end = (char)('0' + value);
+    }
+}
+
+static inline uvec_ret ustrbuf_append_digits(UStrBuf *buf, ulib_uint value, bool negative) {
+    ulib_uint const length = ustrbuf_uint_digits(value) + negative;
+    if (uvec_expand(char, buf, length)) return UVEC_ERR;
+    char *dst = ustrbuf_data(buf) + buf->_count;
+    if (negative) *dst = '-';
+    ustrbuf_write_uint(dst + length, value);
+    buf->_count += length;
+    return UVEC_OK;
+}
+
+uvec_ret ustrbuf_append_uint(UStrBuf *buf, ulib_uint value) {
+    return ustrbuf_append_digits(buf, value, false);
+}
+
+uvec_ret ustrbuf_append_int(UStrBuf *buf, ulib_int value) {
+    if (value >= 0) return ustrbuf_append_digits(buf, (ulib_uint)value, false);
+    return ustrbuf_append_digits(buf, (ulib_uint)0 - (ulib_uint)value, true);
+}
+
+uvec_ret ustrbuf_append_hex(UStrBuf *buf, ulib_uint value, bool upper) {
+    char const *hex = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    ulib_uint length = 1;
+    for (ulib_uint v = value >> 4; v; v >>= 4) ++length;
+
+    if (uvec_expand(char, buf, length)) return UVEC_ERR;
+    char *dst = ustrbuf_data(buf) + buf->_count + length;
+    do {
+        *--dst = hex[value & 0xF];
+        value >>= 4;
+    } while (value);
+
+    buf->_count += length;
+    return UVEC_OK;
+}
+
+#if defined ULIB_TINY
+#define USTRBUF_FLOAT_DIG FLT_DIG
+#define USTRBUF_FLOAT_MAX_DIG 9
+#else
+#define USTRBUF_FLOAT_DIG DBL_DIG
+#define USTRBUF_FLOAT_MAX_DIG 17
+#endif
+
+// Large enough for "-d.<max digits - 1>e-ddd" and the null terminator.
+#define USTRBUF_FLOAT_MAX_LENGTH (USTRBUF_FLOAT_MAX_DIG + 9)
+
+uvec_ret ustrbuf_append_float(UStrBuf *buf, ulib_float value) {
+    if (uvec_expand(char, buf, USTRBUF_FLOAT_MAX_LENGTH)) return UVEC_ERR;
+    char *dst = ustrbuf_data(buf) + buf->_count;
+    int length = 0;
+
+    // Values with at most FLT_DIG/DBL_DIG significant digits are printed exactly at
+    // that precision, so the first precision that round-trips yields the shortest output.
+    for (int prec = USTRBUF_FLOAT_DIG; prec <= USTRBUF_FLOAT_MAX_DIG; ++prec) {
+        length = snprintf(dst, USTRBUF_FLOAT_MAX_LENGTH, "%.*g", prec, (double)value);
+        if (!isfinite(value) || ulib_str_to_float(dst, NULL) == value) break;
+    }
+
+    if (length < 0) return UVEC_ERR;
+    buf->_count += (ulib_uint)length;
+    return UVEC_OK;
+}
+
+static inline ulib_uint ustrbuf_escaped_length(unsigned char c) {
+    switch (c) {
+        case '"':
+        case '\\':
+        case '\b':
+        case '\f':
+        case '\n':
+        case '\r':
+        case '\t': return 2;
+        default: return c < 0x20 ? 6 : 1;
+    }
+}
+
+uvec_ret ustrbuf_append_escaped(UStrBuf *buf, UString string) {
+    unsigned char const *src = (unsigned char const *)ustring_data(string);
+    ulib_uint const src_length = ustring_length(string);
+    ulib_uint length = 0;
+
+    for (ulib_uint i = 0; i < src_length; ++i) length += ustrbuf_escaped_length(src[i]);
+    if (length == src_length) return ustrbuf_append_ustring(buf, string);
+    if (uvec_expand(char, buf, length)) return UVEC_ERR;
+
+    char *dst = ustrbuf_data(buf) + buf->_count;
+
+    for (ulib_uint i = 0; i < src_length; ++i) {
+        unsigned char const c = src[i];
+        char esc = 0;
+
+        switch (c) {
+            case '"': esc = '"'; break;
+            case '\\': esc = '\\'; break;
+            case '\b': esc = 'b'; break;
+            case '\f': esc = 'f'; break;
+            case '\n': esc = 'n'; break;
+            case '\r': esc = 'r'; break;
+            case '\t': esc = 't'; break;
+            default: break;
+        }
+
+        if (esc) {
+            *dst++ = '\\';
+            *dst++ = esc;
+        } else if (c < 0x20) {
+            memcpy(dst, "\\u00", 4);
+            dst[4] = "0123456789abcdef"[c >> 4];
+            dst[5] = "0123456789abcdef"[c & 0xF];
+            dst += 6;
+        } else {
+            *dst++ = (char)c;
+        }
+    }
+
+    buf->_count += length;
+    return UVEC_OK;
 }
 
 static inline UString ustrbuf_to_ustring_copy(UStrBuf *buf, ulib_uint length) {
@@ -49,7 +222,7 @@ static inline UString ustrbuf_to_ustring_reuse(UStrBuf *buf, ulib_uint length) {
     }
 
     nbuf[length] = '\0';
-    return ustring_wrap(nbuf, length);
+    return ustring_assign(nbuf, length);
 }
 
 UString ustrbuf_to_ustring(UStrBuf *buf) {
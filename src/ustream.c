@@ -8,16 +8,55 @@
  */
 
 #include "ustream.h"
+#include "ulz4.h"
 #include "ustring.h"
+#include "uthread.h"
 #include "uversion.h"
+#include <errno.h>
 #include <stdarg.h>
 
+// clang-format off
+#if defined(_WIN32)
+    #include <windows.h>
+    #define P_USTREAM_MMAP_WIN32 1
+#elif defined(__unix__) || defined(__APPLE__)
+    #include <unistd.h>
+    #include <sys/uio.h>
+    #define P_USTREAM_WRITEV_POSIX 1
+    #if defined(_POSIX_MAPPED_FILES) && _POSIX_MAPPED_FILES > 0
+        #include <fcntl.h>
+        #include <sys/mman.h>
+        #include <sys/stat.h>
+        #define P_USTREAM_MMAP_POSIX 1
+    #endif
+#endif
+// clang-format on
+
 typedef struct UStreamBuf {
     size_t size;
     char *orig;
     char *cur;
 } UStreamBuf;
 
+typedef struct UStreamMapped {
+    UStreamBuf buf;
+#if defined(P_USTREAM_MMAP_WIN32)
+    HANDLE file;
+    HANDLE mapping;
+#endif
+} UStreamMapped;
+
+typedef struct UStreamBuffered {
+    void *stream;
+    // Refills the buffer of input streams, and writes out the buffer of output streams.
+    ustream_ret (*codec)(struct UStreamBuffered *buf);
+    void *codec_state;
+    size_t size;
+    size_t start;
+    size_t end;
+    char data[];
+} UStreamBuffered;
+
 static ustream_ret ustream_file_read(void *file, void *buf, size_t count, size_t *read) {
     *read = fread(buf, 1, count, file);
     return count != *read && ferror((FILE *)file) ? USTREAM_ERR_IO : USTREAM_OK;
@@ -44,6 +83,56 @@ ustream_file_writef(void *file, size_t *written, char const *format, va_list arg
     return ret;
 }
 
+#if defined(P_USTREAM_WRITEV_POSIX)
+
+#ifndef IOV_MAX
+#define IOV_MAX 16
+#endif
+
+static ustream_ret
+ustream_file_writev(void *file, UStreamIOVec const *iov, size_t count, size_t *written) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) total += iov[i].size;
+    *written = 0;
+
+    // Small writes are coalesced by the stdio buffer anyway.
+    if (total < BUFSIZ) {
+        for (size_t i = 0; i < count; ++i) {
+            size_t lwritten = fwrite(iov[i].data, 1, iov[i].size, file);
+            *written += lwritten;
+            if (lwritten != iov[i].size) return USTREAM_ERR_IO;
+        }
+        return USTREAM_OK;
+    }
+
+    if (fflush(file)) return USTREAM_ERR_IO;
+    int const fd = fileno(file);
+    struct iovec vec[IOV_MAX];
+    size_t offset = 0;
+
+    while (count) {
+        int n = 0;
+        for (; n < IOV_MAX && (size_t)n < count; ++n) {
+            vec[n].iov_base = (char *)iov[n].data + (n ? 0 : offset);
+            vec[n].iov_len = iov[n].size - (n ? 0 : offset);
+        }
+
+        ssize_t ret = writev(fd, vec, n);
+        if (ret < 0 && errno == EINTR) continue;
+        if (ret <= 0) return USTREAM_ERR_IO;
+        *written += (size_t)ret;
+
+        // Skip the buffers that have been entirely written, and resume from partial ones.
+        size_t left = (size_t)ret + offset;
+        for (; count && left >= iov->size; --count, ++iov) left -= iov->size;
+        offset = left;
+    }
+
+    return USTREAM_OK;
+}
+
+#endif
+
 static ustream_ret ustream_file_reset(void *file) {
     rewind(file);
     return USTREAM_OK;
@@ -60,9 +149,29 @@ static ustream_ret ustream_file_close(void *file) {
 static ustream_ret ustream_buf_read(void *ctx, void *buf, size_t count, size_t *read) {
     UStreamBuf *ibuf = ctx;
     *read = count < ibuf->size ? count : ibuf->size;
-    memcpy(buf, ibuf->cur, *read);
-    ibuf->cur += *read;
-    ibuf->size -= *read;
+
+    // Empty buffers, such as mapped empty files, may have a NULL pointer.
+    if (*read) {
+        memcpy(buf, ibuf->cur, *read);
+        ibuf->cur += *read;
+        ibuf->size -= *read;
+    }
+
+    return USTREAM_OK;
+}
+
+static ustream_ret ustream_buf_peek(void *ctx, void const **buf, size_t *available) {
+    UStreamBuf *ibuf = ctx;
+    *buf = ibuf->cur;
+    *available = ibuf->size;
+    return USTREAM_OK;
+}
+
+static ustream_ret ustream_buf_consume(void *ctx, size_t count) {
+    UStreamBuf *ibuf = ctx;
+    if (!count) return USTREAM_OK;
+    ibuf->cur += count;
+    ibuf->size -= count;
     return USTREAM_OK;
 }
 
@@ -108,6 +217,20 @@ ustream_buf_writef(void *ctx, size_t *written, char const *format, va_list args)
     return ret;
 }
 
+static ustream_ret ustream_buf_reserve(void *ctx, size_t size, void **buf, size_t *available) {
+    UStreamBuf *ibuf = ctx;
+    *buf = ibuf->cur;
+    *available = ibuf->size;
+    return size > ibuf->size ? USTREAM_ERR_BOUNDS : USTREAM_OK;
+}
+
+static ustream_ret ustream_buf_commit(void *ctx, size_t count) {
+    UStreamBuf *ibuf = ctx;
+    ibuf->cur += count;
+    ibuf->size -= count;
+    return USTREAM_OK;
+}
+
 static ustream_ret ustream_buf_reset(void *ctx) {
     UStreamBuf *ibuf = ctx;
     ibuf->size += ibuf->cur - ibuf->orig;
@@ -120,6 +243,85 @@ static ustream_ret ustream_buf_free(void *buf) {
     return USTREAM_OK;
 }
 
+#if defined(P_USTREAM_MMAP_POSIX)
+
+static bool ustream_map_file(UStreamMapped *mbuf, char const *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    bool mapped = fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && (uintmax_t)st.st_size <= SIZE_MAX;
+    size_t const size = mapped ? (size_t)st.st_size : 0;
+    void *addr = NULL;
+
+    // Empty files cannot be mapped, but they are trivially backed by memory.
+    if (mapped && size) {
+        addr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            mapped = false;
+        } else {
+#if defined(POSIX_MADV_SEQUENTIAL)
+            posix_madvise(addr, size, POSIX_MADV_SEQUENTIAL);
+#endif
+        }
+    }
+
+    close(fd);
+    if (mapped) mbuf->buf = (UStreamBuf){ size, addr, addr };
+    return mapped;
+}
+
+static ustream_ret ustream_mapped_free(void *ctx) {
+    UStreamMapped *mbuf = ctx;
+    size_t const size = (size_t)(mbuf->buf.cur - mbuf->buf.orig) + mbuf->buf.size;
+    ustream_ret ret = mbuf->buf.orig && munmap(mbuf->buf.orig, size) ? USTREAM_ERR_IO : USTREAM_OK;
+    ulib_free(mbuf);
+    return ret;
+}
+
+#elif defined(P_USTREAM_MMAP_WIN32)
+
+static bool ustream_map_file(UStreamMapped *mbuf, char const *path) {
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER file_size;
+    HANDLE mapping = NULL;
+    void *addr = NULL;
+
+    if (!GetFileSizeEx(file, &file_size) || (uint64_t)file_size.QuadPart > SIZE_MAX) goto err;
+    size_t const size = (size_t)file_size.QuadPart;
+
+    // Empty files cannot be mapped, but they are trivially backed by memory.
+    if (size) {
+        if (!(mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL))) goto err;
+        if (!(addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0))) goto err;
+    }
+
+    mbuf->buf = (UStreamBuf){ size, addr, addr };
+    mbuf->file = file;
+    mbuf->mapping = mapping;
+    return true;
+
+err:
+    if (mapping) CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+}
+
+static ustream_ret ustream_mapped_free(void *ctx) {
+    UStreamMapped *mbuf = ctx;
+    ustream_ret ret = USTREAM_OK;
+    if (mbuf->buf.orig && !UnmapViewOfFile(mbuf->buf.orig)) ret = USTREAM_ERR_IO;
+    if (mbuf->mapping) CloseHandle(mbuf->mapping);
+    CloseHandle(mbuf->file);
+    ulib_free(mbuf);
+    return ret;
+}
+
+#endif
+
 static ustream_ret ustream_strbuf_write(void *ctx, void const *buf, size_t count, size_t *written) {
     ulib_uint start_count = uvec_count(char, ctx);
     uvec_ret ret = ustrbuf_append_string(ctx, buf, (ulib_uint)count);
@@ -135,6 +337,21 @@ ustream_strbuf_writef(void *ctx, size_t *written, char const *format, va_list ar
     return ret == UVEC_OK ? USTREAM_OK : USTREAM_ERR_MEM;
 }
 
+static ustream_ret
+ustream_strbuf_reserve(void *ctx, size_t size, void **buf, size_t *available) {
+    UStrBuf *sbuf = ctx;
+    if (size >= (size_t)(ULIB_UINT_MAX - sbuf->_count)) return USTREAM_ERR_MEM;
+    if (uvec_expand(char, sbuf, (ulib_uint)size)) return USTREAM_ERR_MEM;
+    *buf = ustrbuf_data(sbuf) + sbuf->_count;
+    *available = ustrbuf_size(sbuf) - sbuf->_count;
+    return USTREAM_OK;
+}
+
+static ustream_ret ustream_strbuf_commit(void *ctx, size_t count) {
+    ((UStrBuf *)ctx)->_count += (ulib_uint)count;
+    return USTREAM_OK;
+}
+
 static ustream_ret ustream_strbuf_free(void *ctx) {
     ustrbuf_deinit(ctx);
     ulib_free(ctx);
@@ -147,6 +364,31 @@ static ustream_ret ustream_null_write(ulib_unused void *ctx, ulib_unused void co
     return USTREAM_OK;
 }
 
+// Size of the stack buffer used to format strings for streams that cannot be formatted into.
+#define P_USTREAM_FORMAT_STACK_SIZE 256U
+
+/*
+ * Formats into the buffer pointed to by 'buf', whose size is 'size', replacing it with
+ * a heap-allocated buffer if the string does not fit. The caller must release it.
+ */
+static ustream_ret
+ustream_format(char **buf, size_t size, size_t *length, char const *format, va_list args) {
+    va_list copy;
+    va_copy(copy, args);
+    int len = vsnprintf(*buf, size, format, copy);
+    va_end(copy);
+
+    if (len < 0) return USTREAM_ERR_IO;
+    *length = (size_t)len;
+
+    if ((size_t)len >= size) {
+        if (!(*buf = ulib_malloc((size_t)len + 1))) return USTREAM_ERR_MEM;
+        vsnprintf(*buf, (size_t)len + 1, format, args);
+    }
+
+    return USTREAM_OK;
+}
+
 static ustream_ret ustream_multi_write(void *ctx, void const *buf, size_t count, size_t *written) {
     ustream_ret ret = USTREAM_OK;
     *written = 0;
@@ -163,15 +405,33 @@ static ustream_ret ustream_multi_write(void *ctx, void const *buf, size_t count,
 
 static ustream_ret
 ustream_multi_writef(void *ctx, size_t *written, char const *format, va_list args) {
+    if (uvec_count(ulib_ptr, ctx) == 1) {
+        return uostream_writef_list(uvec_first(ulib_ptr, ctx), written, format, args);
+    }
+
+    // Format once, then write the resulting bytes to all the substreams.
+    char stack_buf[P_USTREAM_FORMAT_STACK_SIZE], *buf = stack_buf;
+    size_t len;
+    ustream_ret ret = ustream_format(&buf, sizeof(stack_buf), &len, format, args);
+
+    if (ret) {
+        *written = 0;
+        return ret;
+    }
+
+    ret = ustream_multi_write(ctx, buf, len, written);
+    if (buf != stack_buf) ulib_free(buf);
+    return ret;
+}
+
+static ustream_ret
+ustream_multi_writev(void *ctx, UStreamIOVec const *iov, size_t count, size_t *written) {
     ustream_ret ret = USTREAM_OK;
     *written = 0;
 
     uvec_foreach (ulib_ptr, ctx, stream) {
         size_t lwritten;
-        va_list cargs;
-        va_copy(cargs, args);
-        ustream_ret lret = uostream_writef_list(*stream.item, &lwritten, format, cargs);
-        va_end(cargs);
+        ustream_ret lret = uostream_writev(*stream.item, iov, count, &lwritten);
         if (*written < lwritten) *written = lwritten;
         if (!ret) ret = lret;
     }
@@ -204,6 +464,764 @@ static ustream_ret ustream_multi_free(void *ctx) {
     return ret;
 }
 
+static UStreamBuffered *ustream_buffered_alloc(void *stream, size_t cap) {
+    if (!cap) cap = BUFSIZ;
+    UStreamBuffered *buf = ulib_malloc(sizeof(*buf) + cap);
+    if (buf) *buf = (UStreamBuffered){ .stream = stream, .size = cap };
+    return buf;
+}
+
+// Discards the buffered data and refills the buffer from the source stream.
+static ustream_ret ustream_buffered_fill(UStreamBuffered *ibuf) {
+    ibuf->start = ibuf->end = 0;
+    if (ibuf->codec) return ibuf->codec(ibuf);
+    return uistream_read(ibuf->stream, ibuf->data, ibuf->size, &ibuf->end);
+}
+
+static ustream_ret ustream_buffered_read(void *ctx, void *buf, size_t count, size_t *read) {
+    UStreamBuffered *ibuf = ctx;
+    ustream_ret ret = USTREAM_OK;
+    *read = 0;
+
+    while (count) {
+        if (ibuf->start == ibuf->end) {
+            if (ret) break;
+
+            if (count >= ibuf->size && !ibuf->codec) {
+                size_t available;
+                ret = uistream_read(ibuf->stream, buf, count, &available);
+                *read += available;
+                break;
+            }
+
+            ret = ustream_buffered_fill(ibuf);
+            if (ibuf->start == ibuf->end) break;
+        }
+
+        size_t available = ibuf->end - ibuf->start;
+        if (available > count) available = count;
+        memcpy(buf, ibuf->data + ibuf->start, available);
+        buf = (char *)buf + available;
+        ibuf->start += available;
+        *read += available;
+        count -= available;
+    }
+
+    return ret;
+}
+
+static ustream_ret ustream_buffered_peek(void *ctx, void const **buf, size_t *available) {
+    UStreamBuffered *ibuf = ctx;
+    ustream_ret ret = USTREAM_OK;
+    if (ibuf->start == ibuf->end) ret = ustream_buffered_fill(ibuf);
+    *buf = ibuf->data + ibuf->start;
+    *available = ibuf->end - ibuf->start;
+    return ret;
+}
+
+static ustream_ret ustream_buffered_consume(void *ctx, size_t count) {
+    ((UStreamBuffered *)ctx)->start += count;
+    return USTREAM_OK;
+}
+
+static ustream_ret ustream_buffered_reset(void *ctx) {
+    UStreamBuffered *ibuf = ctx;
+    ibuf->start = ibuf->end = 0;
+    return uistream_reset(ibuf->stream);
+}
+
+static ustream_ret ustream_buffered_ifree(void *ctx) {
+    UStreamBuffered *ibuf = ctx;
+    ustream_ret ret = uistream_deinit(ibuf->stream);
+    ulib_free(ibuf->codec_state);
+    ulib_free(ibuf);
+    return ret;
+}
+
+// Also releases the source stream, which is owned by the buffered stream.
+static ustream_ret ustream_buffered_ifree_owned(void *ctx) {
+    void *src = ((UStreamBuffered *)ctx)->stream;
+    ustream_ret ret = ustream_buffered_ifree(ctx);
+    ulib_free(src);
+    return ret;
+}
+
+// Writes the buffered data to the destination stream, keeping any data it did not accept.
+static ustream_ret ustream_buffered_drain(UStreamBuffered *obuf) {
+    if (!obuf->end) return USTREAM_OK;
+    if (obuf->codec) return obuf->codec(obuf);
+    size_t written;
+    ustream_ret ret = uostream_write(obuf->stream, obuf->data, obuf->end, &written);
+    obuf->end -= written;
+    if (obuf->end) memmove(obuf->data, obuf->data + written, obuf->end);
+    return ret;
+}
+
+// Writes data larger than the buffer by filling and draining it, as required by codecs.
+static ustream_ret
+ustream_buffered_write_blocks(UStreamBuffered *obuf, void const *buf, size_t count,
+                              size_t *written) {
+    ustream_ret ret = USTREAM_OK;
+
+    while (count) {
+        size_t chunk = obuf->size - obuf->end;
+        if (chunk > count) chunk = count;
+        memcpy(obuf->data + obuf->end, buf, chunk);
+        obuf->end += chunk;
+        *written += chunk;
+        buf = (char const *)buf + chunk;
+        count -= chunk;
+        if (obuf->end == obuf->size && (ret = ustream_buffered_drain(obuf))) break;
+    }
+
+    return ret;
+}
+
+static ustream_ret
+ustream_buffered_write(void *ctx, void const *buf, size_t count, size_t *written) {
+    UStreamBuffered *obuf = ctx;
+    ustream_ret ret = USTREAM_OK;
+    *written = 0;
+
+    if (count > obuf->size - obuf->end) {
+        if ((ret = ustream_buffered_drain(obuf))) return ret;
+        if (count >= obuf->size) {
+            if (obuf->codec) return ustream_buffered_write_blocks(obuf, buf, count, written);
+            return uostream_write(obuf->stream, buf, count, written);
+        }
+    }
+
+    memcpy(obuf->data + obuf->end, buf, count);
+    obuf->end += count;
+    *written = count;
+    return ret;
+}
+
+static ustream_ret
+ustream_buffered_writef(void *ctx, size_t *written, char const *format, va_list args) {
+    UStreamBuffered *obuf = ctx;
+    ustream_ret ret = USTREAM_OK;
+    *written = 0;
+
+    va_list copy;
+    va_copy(copy, args);
+    int len = vsnprintf(obuf->data + obuf->end, obuf->size - obuf->end, format, copy);
+    va_end(copy);
+
+    if (len < 0) return USTREAM_ERR_IO;
+
+    if ((size_t)len >= obuf->size - obuf->end) {
+        if ((ret = ustream_buffered_drain(obuf))) return ret;
+        if ((size_t)len >= obuf->size) {
+            if (!obuf->codec) return uostream_writef_list(obuf->stream, written, format, args);
+            char *str = ulib_malloc((size_t)len + 1);
+            if (!str) return USTREAM_ERR_MEM;
+            vsnprintf(str, (size_t)len + 1, format, args);
+            ret = ustream_buffered_write_blocks(obuf, str, (size_t)len, written);
+            ulib_free(str);
+            return ret;
+        }
+        vsnprintf(obuf->data, obuf->size, format, args);
+    }
+
+    obuf->end += (size_t)len;
+    *written = (size_t)len;
+    return ret;
+}
+
+static ustream_ret
+ustream_buffered_writev(void *ctx, UStreamIOVec const *iov, size_t count, size_t *written) {
+    UStreamBuffered *obuf = ctx;
+    ustream_ret ret = USTREAM_OK;
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) total += iov[i].size;
+    *written = 0;
+
+    if (total > obuf->size - obuf->end) {
+        if ((ret = ustream_buffered_drain(obuf))) return ret;
+        if (total >= obuf->size) {
+            if (!obuf->codec) return uostream_writev(obuf->stream, iov, count, written);
+            for (size_t i = 0; i < count && !ret; ++i) {
+                ret = ustream_buffered_write_blocks(obuf, iov[i].data, iov[i].size, written);
+            }
+            return ret;
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        memcpy(obuf->data + obuf->end, iov[i].data, iov[i].size);
+        obuf->end += iov[i].size;
+    }
+
+    *written = total;
+    return ret;
+}
+
+static ustream_ret
+ustream_buffered_reserve(void *ctx, size_t size, void **buf, size_t *available) {
+    UStreamBuffered *obuf = ctx;
+    ustream_ret ret;
+    if (size > obuf->size - obuf->end && (ret = ustream_buffered_drain(obuf))) return ret;
+    *buf = obuf->data + obuf->end;
+    *available = obuf->size - obuf->end;
+    return size > *available ? USTREAM_ERR_BOUNDS : USTREAM_OK;
+}
+
+static ustream_ret ustream_buffered_commit(void *ctx, size_t count) {
+    ((UStreamBuffered *)ctx)->end += count;
+    return USTREAM_OK;
+}
+
+static ustream_ret ustream_buffered_flush(void *ctx) {
+    UStreamBuffered *obuf = ctx;
+    ustream_ret ret = ustream_buffered_drain(obuf);
+    ustream_ret flush_ret = uostream_flush(obuf->stream);
+    return ret ? ret : flush_ret;
+}
+
+static ustream_ret ustream_buffered_ofree(void *ctx) {
+    UStreamBuffered *obuf = ctx;
+    ustream_ret ret = ustream_buffered_flush(obuf);
+    ustream_ret free_ret = uostream_deinit(obuf->stream);
+    ulib_free(obuf->codec_state);
+    ulib_free(obuf);
+    return ret ? ret : free_ret;
+}
+
+typedef struct UStreamStatsCtx {
+    void *stream;
+    UStreamStats *stats;
+} UStreamStatsCtx;
+
+static unsigned ustream_stats_bucket(uint64_t val) {
+    unsigned bucket = 0;
+    for (; val && bucket < USTREAM_STATS_BUCKETS - 1; val >>= 1U) ++bucket;
+    return bucket;
+}
+
+static void ustream_stats_record(UStreamStats *stats, utime_ns start, ustream_ret ret) {
+    utime_ns elapsed = utime_get_ns() - start;
+    stats->calls++;
+    stats->time += elapsed;
+    if (elapsed > stats->max_time) stats->max_time = elapsed;
+    stats->time_hist[ustream_stats_bucket(elapsed)]++;
+    if (ret) stats->errors[ret]++;
+}
+
+static void ustream_stats_record_size(UStreamStats *stats, utime_ns start, ustream_ret ret,
+                                      size_t size) {
+    ustream_stats_record(stats, start, ret);
+    stats->bytes += size;
+    stats->size_hist[ustream_stats_bucket(size)]++;
+}
+
+static ustream_ret ustream_stats_read(void *ctx, void *buf, size_t count, size_t *read) {
+    UStreamStatsCtx *sc = ctx;
+    utime_ns start = utime_get_ns();
+    ustream_ret ret = uistream_read(sc->stream, buf, count, read);
+    ustream_stats_record_size(sc->stats, start, ret, *read);
+    return ret;
+}
+
+static ustream_ret ustream_stats_peek(void *ctx, void const **buf, size_t *available) {
+    UStreamStatsCtx *sc = ctx;
+    utime_ns start = utime_get_ns();
+    ustream_ret ret = uistream_peek(sc->stream, buf, available);
+    ustream_stats_record(sc->stats, start, ret);
+    return ret;
+}
+
+static ustream_ret ustream_stats_consume(void *ctx, size_t count) {
+    UStreamStatsCtx *sc = ctx;
+    utime_ns start = utime_get_ns();
+    ustream_ret ret = uistream_consume(sc->stream, count);
+    ustream_stats_record_size(sc->stats, start, ret, ret ? 0 : count);
+    return ret;
+}
+
+static ustream_ret ustream_stats_reset(void *ctx) {
+    UStreamStatsCtx *sc = ctx;
+    utime_ns start = utime_get_ns();
+    ustream_ret ret = uistream_reset(sc->stream);
+    ustream_stats_record(sc->stats, start, ret);
+    return ret;
+}
+
+static ustream_ret ustream_stats_ifree(void *ctx) {
+    UStreamStatsCtx *sc = ctx;
+    ustream_ret ret = uistream_deinit(sc->stream);
+    ulib_free(sc);
+    return ret;
+}
+
+static ustream_ret ustream_stats_write(void *ctx, void const *buf, size_t count, size_t *written) {
+    UStreamStatsCtx *sc = ctx;
+    utime_ns start = utime_get_ns();
+    ustream_ret ret = uostream_write(sc->stream, buf, count, written);
+    ustream_stats_record_size(sc->stats, start, ret, *written);
+    return ret;
+}
+
+static ustream_ret
+ustream_stats_writef(void *ctx, size_t *written, char const *format, va_list args) {
+    UStreamStatsCtx *sc = ctx;
+    utime_ns start = utime_get_ns();
+    ustream_ret ret = uostream_writef_list(sc->stream, written, format, args);
+    ustream_stats_record_size(sc->stats, start, ret, *written);
+    return ret;
+}
+
+static ustream_ret
+ustream_stats_writev(void *ctx, UStreamIOVec const *iov, size_t count, size_t *written) {
+    UStreamStatsCtx *sc = ctx;
+    utime_ns start = utime_get_ns();
+    ustream_ret ret = uostream_writev(sc->stream, iov, count, written);
+    ustream_stats_record_size(sc->stats, start, ret, *written);
+    return ret;
+}
+
+static ustream_ret ustream_stats_flush(void *ctx) {
+    UStreamStatsCtx *sc = ctx;
+    utime_ns start = utime_get_ns();
+    ustream_ret ret = uostream_flush(sc->stream);
+    ustream_stats_record(sc->stats, start, ret);
+    return ret;
+}
+
+static ustream_ret ustream_stats_ofree(void *ctx) {
+    UStreamStatsCtx *sc = ctx;
+    ustream_ret ret = uostream_deinit(sc->stream);
+    ulib_free(sc);
+    return ret;
+}
+
+#if !defined(ULIB_NO_COMPRESSION)
+
+#define P_USTREAM_LZ4_HEADER_SIZE 8U
+#define P_USTREAM_LZ4_BLOCK_HEADER_SIZE 8U
+#define P_USTREAM_LZ4_DEFAULT_BLOCK 65536U
+#define P_USTREAM_LZ4_MAX_BLOCK (1U << 26U)
+#define P_USTREAM_LZ4_STORED 0x80000000U
+
+static char const p_ustream_lz4_magic[4] = { 'U', 'L', 'Z', '4' };
+
+typedef struct UStreamLz4 {
+    // Whether the frame header has been written.
+    bool started;
+    // Whether the end of the frame has been reached.
+    bool finished;
+    // Hash table of the compressor, trailing the scratch buffer.
+    uint32_t *table;
+    // Compressed data of non-peekable sources, or compressor output.
+    ulib_byte scratch[];
+} UStreamLz4;
+
+static UStreamLz4 *ustream_lz4_alloc(size_t block_size, bool compress) {
+    size_t scratch = (p_ulz4_bound(block_size) + 3U) & ~(size_t)3U;
+    size_t size = sizeof(UStreamLz4) + scratch;
+    if (compress) size += P_ULZ4_TABLE_SIZE * sizeof(uint32_t);
+    UStreamLz4 *lz = ulib_malloc(size);
+    if (!lz) return NULL;
+    *lz = (UStreamLz4){ .table = compress ? (uint32_t *)(void *)(lz->scratch + scratch) : NULL };
+    return lz;
+}
+
+static void ustream_lz4_put32(ulib_byte *buf, uint32_t val) {
+    for (unsigned i = 0; i < 4; ++i) buf[i] = (ulib_byte)(val >> (8U * i));
+}
+
+static uint32_t ustream_lz4_get32(ulib_byte const *buf) {
+    return (uint32_t)buf[0] | (uint32_t)buf[1] << 8U | (uint32_t)buf[2] << 16U |
+           (uint32_t)buf[3] << 24U;
+}
+
+static ustream_ret ustream_read_exact(UIStream *stream, void *buf, size_t size) {
+    while (size) {
+        size_t read;
+        ustream_ret ret = uistream_read(stream, buf, size, &read);
+        if (ret) return ret;
+        if (!read) return USTREAM_ERR_BOUNDS;
+        buf = (char *)buf + read;
+        size -= read;
+    }
+    return USTREAM_OK;
+}
+
+static ustream_ret ustream_lz4_read_header(UIStream *src, size_t *block_size) {
+    ulib_byte header[P_USTREAM_LZ4_HEADER_SIZE];
+    ustream_ret ret = ustream_read_exact(src, header, sizeof(header));
+    if (ret) return ret;
+    *block_size = ustream_lz4_get32(header + sizeof(p_ustream_lz4_magic));
+    if (memcmp(header, p_ustream_lz4_magic, sizeof(p_ustream_lz4_magic)) != 0 || !*block_size ||
+        *block_size > P_USTREAM_LZ4_MAX_BLOCK) {
+        return USTREAM_ERR;
+    }
+    return USTREAM_OK;
+}
+
+// Decompresses the next block of the source stream into the buffer.
+static ustream_ret ustream_lz4_fill(UStreamBuffered *ibuf) {
+    UStreamLz4 *lz = ibuf->codec_state;
+    if (lz->finished) return USTREAM_OK;
+
+    UIStream *src = ibuf->stream;
+    ulib_byte header[P_USTREAM_LZ4_BLOCK_HEADER_SIZE];
+    ustream_ret ret = ustream_read_exact(src, header, sizeof(header));
+    if (ret) return ret;
+
+    size_t const raw = ustream_lz4_get32(header);
+    uint32_t const payload = ustream_lz4_get32(header + 4);
+    size_t const size = payload & ~P_USTREAM_LZ4_STORED;
+
+    if (!raw) {
+        lz->finished = true;
+        return USTREAM_OK;
+    }
+
+    if (raw > ibuf->size || size > p_ulz4_bound(ibuf->size)) return USTREAM_ERR;
+
+    if (payload & P_USTREAM_LZ4_STORED) {
+        if (size != raw) return USTREAM_ERR;
+        if ((ret = ustream_read_exact(src, ibuf->data, raw))) return ret;
+        ibuf->end = raw;
+        return USTREAM_OK;
+    }
+
+    void const *data = NULL;
+    size_t available = 0, out_size;
+
+    // Decompress straight from the memory of peekable sources if the whole block is available.
+    if (src->peek && !(ret = uistream_peek(src, &data, &available)) && available >= size) {
+        if (!p_ulz4_decompress(data, size, ibuf->data, ibuf->size, &out_size)) return USTREAM_ERR;
+        if ((ret = uistream_consume(src, size))) return ret;
+    } else {
+        if (ret || (ret = ustream_read_exact(src, lz->scratch, size))) return ret;
+        if (!p_ulz4_decompress(lz->scratch, size, ibuf->data, ibuf->size, &out_size)) {
+            return USTREAM_ERR;
+        }
+    }
+
+    if (out_size != raw) return USTREAM_ERR;
+    ibuf->end = raw;
+    return USTREAM_OK;
+}
+
+static ustream_ret ustream_lz4_reset(void *ctx) {
+    UStreamBuffered *ibuf = ctx;
+    ibuf->start = ibuf->end = 0;
+    ((UStreamLz4 *)ibuf->codec_state)->finished = false;
+
+    ustream_ret ret = uistream_reset(ibuf->stream);
+    if (ret) return ret;
+
+    size_t block_size;
+    if ((ret = ustream_lz4_read_header(ibuf->stream, &block_size))) return ret;
+    return block_size == ibuf->size ? USTREAM_OK : USTREAM_ERR;
+}
+
+// Compresses the buffer and writes it to the destination stream as a block.
+static ustream_ret ustream_lz4_drain(UStreamBuffered *obuf) {
+    UStreamLz4 *lz = obuf->codec_state;
+    ulib_byte header[P_USTREAM_LZ4_HEADER_SIZE + P_USTREAM_LZ4_BLOCK_HEADER_SIZE];
+    UStreamIOVec iov[2] = { { header, P_USTREAM_LZ4_BLOCK_HEADER_SIZE } };
+    ulib_byte *cur = header;
+
+    if (!lz->started) {
+        memcpy(cur, p_ustream_lz4_magic, sizeof(p_ustream_lz4_magic));
+        ustream_lz4_put32(cur + sizeof(p_ustream_lz4_magic), (uint32_t)obuf->size);
+        cur += P_USTREAM_LZ4_HEADER_SIZE;
+        iov[0].size += P_USTREAM_LZ4_HEADER_SIZE;
+    }
+
+    uint32_t payload;
+
+    if (obuf->end) {
+        size_t size = p_ulz4_compress(obuf->data, obuf->end, lz->scratch, lz->table);
+        if (size < obuf->end) {
+            iov[1] = (UStreamIOVec){ lz->scratch, size };
+            payload = (uint32_t)size;
+        } else {
+            iov[1] = (UStreamIOVec){ obuf->data, obuf->end };
+            payload = (uint32_t)obuf->end | P_USTREAM_LZ4_STORED;
+        }
+    } else {
+        // An empty block marks the end of the frame.
+        payload = 0;
+    }
+
+    ustream_lz4_put32(cur, (uint32_t)obuf->end);
+    ustream_lz4_put32(cur + 4, payload);
+
+    size_t written;
+    ustream_ret ret = uostream_writev(obuf->stream, iov, obuf->end ? 2 : 1, &written);
+    if (!ret) {
+        lz->started = true;
+        obuf->end = 0;
+    }
+    return ret;
+}
+
+static ustream_ret ustream_lz4_ofree(void *ctx) {
+    UStreamBuffered *obuf = ctx;
+    // Writes the last block, followed by the end of frame marker.
+    ustream_ret ret = ustream_buffered_drain(obuf);
+    if (!ret) ret = ustream_lz4_drain(obuf);
+    ustream_ret free_ret = ustream_buffered_ofree(obuf);
+    return ret ? ret : free_ret;
+}
+
+#endif
+
+#if !defined(ULIB_NO_THREADS)
+
+typedef struct UStreamAsync {
+    UOStream *stream;
+    UMutex lock;
+    UCond ready;
+    UCond done;
+    UThread thread;
+    char *front;
+    char *back;
+    size_t size;
+    size_t cap;
+    size_t dropped;
+    unsigned long long flush_requested;
+    unsigned long long flush_done;
+    uostream_async_policy policy;
+    ustream_ret state;
+    bool stop;
+    char data[];
+} UStreamAsync;
+
+static void ustream_async_main(void *ctx) {
+    UStreamAsync *abuf = ctx;
+    umutex_lock(&abuf->lock);
+
+    while (true) {
+        if (abuf->size) {
+            // Swap the buffers, so that writers can proceed while the back one is written.
+            char *buf = abuf->front;
+            size_t size = abuf->size;
+            abuf->front = abuf->back;
+            abuf->back = buf;
+            abuf->size = 0;
+            ucond_broadcast(&abuf->done);
+            umutex_unlock(&abuf->lock);
+
+            ustream_ret ret = uostream_write(abuf->stream, buf, size, NULL);
+
+            umutex_lock(&abuf->lock);
+            if (ret && !abuf->state) abuf->state = ret;
+        } else if (abuf->flush_done != abuf->flush_requested) {
+            // All the data written before the flush requests has already been drained.
+            unsigned long long requested = abuf->flush_requested;
+            umutex_unlock(&abuf->lock);
+
+            ustream_ret ret = uostream_flush(abuf->stream);
+
+            umutex_lock(&abuf->lock);
+            if (ret && !abuf->state) abuf->state = ret;
+            abuf->flush_done = requested;
+            ucond_broadcast(&abuf->done);
+        } else if (abuf->stop) {
+            break;
+        } else {
+            ucond_wait(&abuf->ready, &abuf->lock);
+        }
+    }
+
+    umutex_unlock(&abuf->lock);
+}
+
+static ustream_ret
+ustream_async_write(void *ctx, void const *buf, size_t count, size_t *written) {
+    UStreamAsync *abuf = ctx;
+    char const *bytes = buf;
+    size_t const chunk = ulib_min(count, abuf->cap);
+    *written = 0;
+
+    umutex_lock(&abuf->lock);
+
+    if (abuf->policy == USTREAM_ASYNC_DROP && count > abuf->cap - abuf->size) {
+        if (!abuf->state) abuf->dropped++;
+        count = 0;
+    }
+
+    while (count && !abuf->state) {
+        if (abuf->cap - abuf->size < chunk) {
+            ucond_wait(&abuf->done, &abuf->lock);
+            continue;
+        }
+
+        size_t n = ulib_min(count, abuf->cap - abuf->size);
+        memcpy(abuf->front + abuf->size, bytes, n);
+        abuf->size += n;
+        bytes += n;
+        count -= n;
+        *written += n;
+        ucond_signal(&abuf->ready);
+    }
+
+    ustream_ret ret = abuf->state;
+    umutex_unlock(&abuf->lock);
+    return ret;
+}
+
+static ustream_ret
+ustream_async_writev(void *ctx, UStreamIOVec const *iov, size_t count, size_t *written) {
+    UStreamAsync *abuf = ctx;
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) total += iov[i].size;
+    *written = 0;
+
+    // Buffers that do not fit as a whole are written one at a time.
+    if (total > abuf->cap) {
+        ustream_ret ret = USTREAM_OK;
+        for (size_t i = 0; i < count && !ret; ++i) {
+            size_t lwritten;
+            ret = ustream_async_write(abuf, iov[i].data, iov[i].size, &lwritten);
+            *written += lwritten;
+        }
+        return ret;
+    }
+
+    umutex_lock(&abuf->lock);
+
+    while (!abuf->state) {
+        if (total <= abuf->cap - abuf->size) {
+            for (size_t i = 0; i < count; ++i) {
+                memcpy(abuf->front + abuf->size, iov[i].data, iov[i].size);
+                abuf->size += iov[i].size;
+            }
+            *written = total;
+            ucond_signal(&abuf->ready);
+            break;
+        }
+
+        if (abuf->policy == USTREAM_ASYNC_DROP) {
+            abuf->dropped++;
+            break;
+        }
+
+        ucond_wait(&abuf->done, &abuf->lock);
+    }
+
+    ustream_ret ret = abuf->state;
+    umutex_unlock(&abuf->lock);
+    return ret;
+}
+
+static ustream_ret
+ustream_async_writef(void *ctx, size_t *written, char const *format, va_list args) {
+    UStreamAsync *abuf = ctx;
+    ustream_ret ret = USTREAM_OK;
+    bool split = false;
+    int len = 0;
+    *written = 0;
+
+    umutex_lock(&abuf->lock);
+
+    while (!(ret = abuf->state)) {
+        // Buffers have room for a terminator past their capacity.
+        size_t available = abuf->cap - abuf->size;
+        va_list copy;
+        va_copy(copy, args);
+        len = vsnprintf(abuf->front + abuf->size, available + 1, format, copy);
+        va_end(copy);
+
+        if (len < 0) {
+            ret = USTREAM_ERR_IO;
+            break;
+        }
+
+        if ((size_t)len <= available) {
+            abuf->size += (size_t)len;
+            *written = (size_t)len;
+            ucond_signal(&abuf->ready);
+            break;
+        }
+
+        if (abuf->policy == USTREAM_ASYNC_DROP) {
+            abuf->dropped++;
+            break;
+        }
+
+        if ((split = (size_t)len > abuf->cap)) break;
+        ucond_wait(&abuf->done, &abuf->lock);
+    }
+
+    umutex_unlock(&abuf->lock);
+    if (!split) return ret;
+
+    // The formatted string is larger than the buffer: format it separately and split it.
+    char *buf = ulib_malloc((size_t)len + 1);
+    if (!buf) return USTREAM_ERR_MEM;
+    vsnprintf(buf, (size_t)len + 1, format, args);
+    ret = ustream_async_write(abuf, buf, (size_t)len, written);
+    ulib_free(buf);
+    return ret;
+}
+
+static ustream_ret ustream_async_flush(void *ctx) {
+    UStreamAsync *abuf = ctx;
+    umutex_lock(&abuf->lock);
+
+    unsigned long long requested = ++abuf->flush_requested;
+    ucond_signal(&abuf->ready);
+    while (abuf->flush_done < requested) ucond_wait(&abuf->done, &abuf->lock);
+
+    ustream_ret ret = abuf->state;
+    umutex_unlock(&abuf->lock);
+    return ret;
+}
+
+static ustream_ret ustream_async_free(void *ctx) {
+    UStreamAsync *abuf = ctx;
+    ustream_ret ret = ustream_async_flush(abuf);
+
+    umutex_lock(&abuf->lock);
+    abuf->stop = true;
+    ucond_signal(&abuf->ready);
+    umutex_unlock(&abuf->lock);
+    uthread_join(&abuf->thread);
+
+    ustream_ret free_ret = uostream_deinit(abuf->stream);
+    ucond_deinit(&abuf->done);
+    ucond_deinit(&abuf->ready);
+    umutex_deinit(&abuf->lock);
+    ulib_free(abuf);
+    return ret ? ret : free_ret;
+}
+
+static UStreamAsync *
+ustream_async_alloc(UOStream *stream, size_t cap, uostream_async_policy policy) {
+    if (!cap) cap = BUFSIZ;
+    UStreamAsync *abuf = ulib_malloc(sizeof(*abuf) + 2 * (cap + 1));
+    if (!abuf) return NULL;
+
+    *abuf = (UStreamAsync){ .stream = stream, .cap = cap, .policy = policy };
+    abuf->front = abuf->data;
+    abuf->back = abuf->data + cap + 1;
+
+    if (umutex_init(&abuf->lock)) goto err_mutex;
+    if (ucond_init(&abuf->ready)) goto err_ready;
+    if (ucond_init(&abuf->done)) goto err_done;
+    if (uthread_start(&abuf->thread, ustream_async_main, abuf)) goto err_thread;
+    return abuf;
+
+err_thread:
+    ucond_deinit(&abuf->done);
+err_done:
+    ucond_deinit(&abuf->ready);
+err_ready:
+    umutex_deinit(&abuf->lock);
+err_mutex:
+    ulib_free(abuf);
+    return NULL;
+}
+
+#endif
+
 ustream_ret uistream_deinit(UIStream *stream) {
     return stream->state = stream->free ? stream->free(stream->ctx) : USTREAM_OK;
 }
@@ -225,6 +1243,73 @@ ustream_ret uistream_read(UIStream *stream, void *buf, size_t count, size_t *rea
     return stream->state;
 }
 
+ustream_ret uistream_peek(UIStream *stream, void const **buf, size_t *available) {
+    *available = 0;
+    if (stream->state) return stream->state;
+
+    if (!stream->peek) {
+        // Move the stream onto the heap, and turn this instance into a buffered wrapper.
+        UIStream *src = ulib_alloc(src);
+        if (!src) return stream->state = USTREAM_ERR_MEM;
+        *src = *stream;
+
+        if (uistream_buffered(stream, src, 0)) {
+            *stream = *src;
+            ulib_free(src);
+            return stream->state = USTREAM_ERR_MEM;
+        }
+
+        stream->read_bytes = src->read_bytes;
+        stream->free = ustream_buffered_ifree_owned;
+    }
+
+    return stream->state = stream->peek(stream->ctx, buf, available);
+}
+
+ustream_ret uistream_consume(UIStream *stream, size_t count) {
+    if (stream->state) return stream->state;
+    stream->read_bytes += count;
+    return stream->state = stream->consume(stream->ctx, count);
+}
+
+ustream_ret uistream_read_until(UIStream *stream, char delim, UStrBuf *buf, UString *record) {
+    uvec_remove_all(char, buf);
+    *record = ustring_null;
+
+    void const *data;
+    size_t available;
+    ustream_ret ret;
+    bool partial = false;
+
+    while (!(ret = uistream_peek(stream, &data, &available)) && available) {
+        char const *end = memchr(data, delim, available);
+        size_t const len = end ? (size_t)(end - (char const *)data) : available;
+
+        if (end && !partial) {
+            *record = ustring_wrap(data, len);
+            return uistream_consume(stream, len + 1);
+        }
+
+        if (ustrbuf_append_string(buf, data, (ulib_uint)len)) {
+            return stream->state = USTREAM_ERR_MEM;
+        }
+
+        partial = true;
+        if ((ret = uistream_consume(stream, end ? len + 1 : len)) || end) break;
+    }
+
+    if (partial) *record = ustring_wrap(ustrbuf_data(buf), ustrbuf_length(buf));
+    return ret;
+}
+
+ustream_ret uistream_read_line(UIStream *stream, UStrBuf *buf, UString *line) {
+    ustream_ret ret = uistream_read_until(stream, '\n', buf, line);
+    ulib_uint const len = ustring_length(*line);
+    char const *data = ustring_data(*line);
+    if (len && data[len - 1] == '\r') *line = ustring_wrap(data, len - 1);
+    return ret;
+}
+
 UIStream *uistream_std(void) {
     static UIStream std_in = { 0 };
     if (!std_in.ctx) uistream_from_file(&std_in, stdin);
@@ -238,6 +1323,29 @@ ustream_ret uistream_from_path(UIStream *stream, char const *path) {
     return ret;
 }
 
+ustream_ret uistream_from_path_mapped(UIStream *stream, char const *path) {
+#if defined(P_USTREAM_MMAP_POSIX) || defined(P_USTREAM_MMAP_WIN32)
+    UStreamMapped *mbuf = ulib_alloc(mbuf);
+    if (!mbuf) return (*stream = (UIStream){ .state = USTREAM_ERR_MEM }).state;
+
+    if (ustream_map_file(mbuf, path)) {
+        *stream = (UIStream){
+            .state = USTREAM_OK,
+            .ctx = mbuf,
+            .read = ustream_buf_read,
+            .reset = ustream_buf_reset,
+            .free = ustream_mapped_free,
+            .peek = ustream_buf_peek,
+            .consume = ustream_buf_consume,
+        };
+        return stream->state;
+    }
+
+    ulib_free(mbuf);
+#endif
+    return uistream_from_path(stream, path);
+}
+
 ustream_ret uistream_from_file(UIStream *stream, FILE *file) {
     ustream_ret state = file ? USTREAM_OK : USTREAM_ERR_IO;
     *stream = (UIStream){ .state = state };
@@ -260,6 +1368,8 @@ ustream_ret uistream_from_buf(UIStream *stream, void const *buf, size_t size) {
         stream->read = ustream_buf_read;
         stream->reset = ustream_buf_reset;
         stream->free = ustream_buf_free;
+        stream->peek = ustream_buf_peek;
+        stream->consume = ustream_buf_consume;
     }
     return state;
 }
@@ -276,6 +1386,59 @@ ustream_ret uistream_from_ustring(UIStream *stream, UString const *string) {
     return uistream_from_buf(stream, ustring_data(*string), ustring_length(*string));
 }
 
+void const *uistream_data(UIStream const *stream, size_t *size) {
+    if (stream->read != ustream_buf_read) return NULL;
+    UStreamBuf const *buf = stream->ctx;
+    if (size) *size = (size_t)(buf->cur - buf->orig) + buf->size;
+    return buf->orig;
+}
+
+ustream_ret uistream_buffered(UIStream *stream, UIStream *src, size_t cap) {
+    UStreamBuffered *buf = ustream_buffered_alloc(src, cap);
+    *stream = (UIStream){ .state = buf ? USTREAM_OK : USTREAM_ERR_MEM };
+
+    if (!stream->state) {
+        stream->ctx = buf;
+        stream->read = ustream_buffered_read;
+        stream->reset = ustream_buffered_reset;
+        stream->free = ustream_buffered_ifree;
+        stream->peek = ustream_buffered_peek;
+        stream->consume = ustream_buffered_consume;
+    }
+
+    return stream->state;
+}
+
+#if !defined(ULIB_NO_COMPRESSION)
+
+ustream_ret uistream_decompress(UIStream *stream, UIStream *src) {
+    size_t block_size;
+    ustream_ret ret = ustream_lz4_read_header(src, &block_size);
+    *stream = (UIStream){ .state = ret };
+    if (ret) return ret;
+
+    UStreamBuffered *buf = ustream_buffered_alloc(src, block_size);
+    UStreamLz4 *lz = ustream_lz4_alloc(block_size, false);
+
+    if (!(buf && lz)) {
+        ulib_free(buf);
+        ulib_free(lz);
+        return stream->state = USTREAM_ERR_MEM;
+    }
+
+    buf->codec = ustream_lz4_fill;
+    buf->codec_state = lz;
+    stream->ctx = buf;
+    stream->read = ustream_buffered_read;
+    stream->reset = ustream_lz4_reset;
+    stream->free = ustream_buffered_ifree;
+    stream->peek = ustream_buffered_peek;
+    stream->consume = ustream_buffered_consume;
+    return USTREAM_OK;
+}
+
+#endif
+
 ustream_ret uostream_deinit(UOStream *stream) {
     return stream->state = stream->free ? stream->free(stream->ctx) : USTREAM_OK;
 }
@@ -297,6 +1460,43 @@ ustream_ret uostream_write(UOStream *stream, void const *buf, size_t count, size
     return stream->state;
 }
 
+ustream_ret uostream_writev(UOStream *stream, UStreamIOVec const *iov, size_t count,
+                            size_t *written) {
+    size_t written_bytes = 0;
+
+    if (!stream->state) {
+        if (stream->writev) {
+            stream->state = stream->writev(stream->ctx, iov, count, &written_bytes);
+        } else {
+            for (size_t i = 0; i < count && !stream->state; ++i) {
+                size_t lwritten = 0;
+                stream->state = stream->write(stream->ctx, iov[i].data, iov[i].size, &lwritten);
+                written_bytes += lwritten;
+            }
+        }
+        stream->written_bytes += written_bytes;
+    }
+
+    if (written) *written = written_bytes;
+    return stream->state;
+}
+
+ustream_ret uostream_reserve(UOStream *stream, size_t size, void **buf, size_t *available) {
+    if (stream->state) return stream->state;
+    if (!stream->reserve) return USTREAM_ERR;
+    ustream_ret ret = stream->reserve(stream->ctx, size, buf, available);
+    if (ret != USTREAM_ERR_BOUNDS) stream->state = ret;
+    return ret;
+}
+
+ustream_ret uostream_commit(UOStream *stream, size_t count) {
+    if (!stream->state) {
+        stream->state = stream->commit(stream->ctx, count);
+        if (!stream->state) stream->written_bytes += count;
+    }
+    return stream->state;
+}
+
 ustream_ret uostream_writef(UOStream *stream, size_t *written, char const *format, ...) {
     va_list args;
     va_start(args, format);
@@ -307,20 +1507,43 @@ ustream_ret uostream_writef(UOStream *stream, size_t *written, char const *forma
 
 static ustream_ret
 uostream_writef_list_fallback(UOStream *stream, size_t *written, char const *format, va_list args) {
-    size_t len = ulib_str_flength_list(format, args);
-    size_t size = len + 1;
-    char *buf = ulib_malloc(size);
+    char stack_buf[P_USTREAM_FORMAT_STACK_SIZE], *buf = stack_buf;
+    size_t len;
+    ustream_ret ret = ustream_format(&buf, sizeof(stack_buf), &len, format, args);
+    if (ret) return ret;
+    ret = stream->write(stream->ctx, buf, len, written);
+    if (buf != stack_buf) ulib_free(buf);
+    return ret;
+}
 
-    if (buf) {
-        vsnprintf(buf, size, format, args);
-        stream->state = uostream_write(stream, buf, len, written);
-        ulib_free(buf);
-    } else {
-        *written = 0;
-        stream->state = USTREAM_ERR_MEM;
+// Formats straight into the space reserved in the stream, retrying once if it is too small.
+static ustream_ret
+uostream_writef_list_reserve(UOStream *stream, size_t *written, char const *format, va_list args) {
+    void *buf;
+    size_t available;
+    ustream_ret ret = stream->reserve(stream->ctx, 0, &buf, &available);
+    if (ret) return ret;
+
+    va_list copy;
+    va_copy(copy, args);
+    int len = vsnprintf(available ? buf : NULL, available, format, copy);
+    va_end(copy);
+
+    if (len < 0) return USTREAM_ERR_IO;
+
+    // The null terminator must fit as well.
+    if ((size_t)len >= available) {
+        ret = stream->reserve(stream->ctx, (size_t)len + 1, &buf, &available);
+        if (ret == USTREAM_ERR_BOUNDS) {
+            return uostream_writef_list_fallback(stream, written, format, args);
+        }
+        if (ret) return ret;
+        vsnprintf(buf, available, format, args);
     }
 
-    return stream->state;
+    if ((ret = stream->commit(stream->ctx, (size_t)len))) return ret;
+    *written = (size_t)len;
+    return USTREAM_OK;
 }
 
 ustream_ret
@@ -330,6 +1553,8 @@ uostream_writef_list(UOStream *stream, size_t *written, char const *format, va_l
     if (!stream->state) {
         if (stream->writef) {
             stream->state = stream->writef(stream->ctx, &written_bytes, format, args);
+        } else if (stream->reserve) {
+            stream->state = uostream_writef_list_reserve(stream, &written_bytes, format, args);
         } else {
             stream->state = uostream_writef_list_fallback(stream, &written_bytes, format, args);
         }
@@ -344,9 +1569,24 @@ ustream_ret uostream_write_string(UOStream *stream, UString const *string, size_
     return uostream_write(stream, ustring_data(*string), ustring_length(*string), written);
 }
 
+// Writes the digits of the specified value, zero-padded to the specified width.
+static char *ustream_put_uint(char *dst, unsigned long long value, unsigned width) {
+    char digits[20];
+    unsigned count = 0;
+
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+
+    for (; count < width; ++count) digits[count] = '0';
+    while (count) *dst++ = digits[--count];
+    return dst;
+}
+
 ustream_ret uostream_write_time(UOStream *stream, UTime const *time, size_t *written) {
-    return uostream_writef(stream, written, "%lld/%02u/%02u-%02u:%02u:%02u", time->year,
-                           time->month, time->day, time->hour, time->minute, time->second);
+    char buf[UTIME_FORMAT_SIZE];
+    return uostream_write(stream, buf, utime_format(time, buf), written);
 }
 
 ustream_ret uostream_write_time_interval(UOStream *stream, utime_ns interval, utime_unit unit,
@@ -359,8 +1599,13 @@ ustream_ret uostream_write_time_interval(UOStream *stream, utime_ns interval, ut
 }
 
 ustream_ret uostream_write_version(UOStream *stream, UVersion const *version, size_t *written) {
-    return uostream_writef(stream, written, "%u.%u.%u", version->major, version->minor,
-                           version->patch);
+    char buf[40], *cur = buf;
+    cur = ustream_put_uint(cur, version->major, 1);
+    *cur++ = '.';
+    cur = ustream_put_uint(cur, version->minor, 1);
+    *cur++ = '.';
+    cur = ustream_put_uint(cur, version->patch, 1);
+    return uostream_write(stream, buf, (size_t)(cur - buf), written);
 }
 
 UOStream *uostream_std(void) {
@@ -396,6 +1641,9 @@ ustream_ret uostream_to_file(UOStream *stream, FILE *file) {
         stream->write = ustream_file_write;
         stream->writef = ustream_file_writef;
         stream->flush = ustream_file_flush;
+#if defined(P_USTREAM_WRITEV_POSIX)
+        stream->writev = ustream_file_writev;
+#endif
     }
 
     return stream->state;
@@ -412,6 +1660,8 @@ ustream_ret uostream_to_buf(UOStream *stream, void *buf, size_t size) {
         stream->write = ustream_buf_write;
         stream->writef = ustream_buf_writef;
         stream->free = ustream_buf_free;
+        stream->reserve = ustream_buf_reserve;
+        stream->commit = ustream_buf_commit;
     }
 
     return stream->state;
@@ -433,6 +1683,8 @@ ustream_ret uostream_to_strbuf(UOStream *stream, UStrBuf *buf) {
         stream->ctx = buf;
         stream->write = ustream_strbuf_write;
         stream->writef = ustream_strbuf_writef;
+        stream->reserve = ustream_strbuf_reserve;
+        stream->commit = ustream_strbuf_commit;
     }
 
     return stream->state;
@@ -450,6 +1702,7 @@ ustream_ret uostream_to_multi(UOStream *stream) {
             .writef = ustream_multi_writef,
             .flush = ustream_multi_flush,
             .free = ustream_multi_free,
+            .writev = ustream_multi_writev,
         };
     } else {
         *stream = (UOStream){ .state = USTREAM_ERR_MEM };
@@ -462,3 +1715,181 @@ ustream_ret uostream_add_substream(UOStream *stream, UOStream const *other) {
     if (uvec_push(ulib_ptr, stream->ctx, (void *)other)) stream->state = USTREAM_ERR_MEM;
     return stream->state;
 }
+
+ustream_ret uostream_buffered(UOStream *stream, UOStream *dst, size_t cap) {
+    UStreamBuffered *buf = ustream_buffered_alloc(dst, cap);
+    *stream = (UOStream){ .state = buf ? USTREAM_OK : USTREAM_ERR_MEM };
+
+    if (!stream->state) {
+        stream->ctx = buf;
+        stream->write = ustream_buffered_write;
+        stream->writef = ustream_buffered_writef;
+        stream->flush = ustream_buffered_flush;
+        stream->free = ustream_buffered_ofree;
+        stream->writev = ustream_buffered_writev;
+        stream->reserve = ustream_buffered_reserve;
+        stream->commit = ustream_buffered_commit;
+    }
+
+    return stream->state;
+}
+
+ustream_ret
+uostream_to_async(UOStream *stream, UOStream *dst, size_t buf_size, uostream_async_policy policy) {
+#if defined(ULIB_NO_THREADS)
+    (void)policy;
+    return uostream_buffered(stream, dst, buf_size);
+#else
+    UStreamAsync *abuf = ustream_async_alloc(dst, buf_size, policy);
+    *stream = (UOStream){ .state = abuf ? USTREAM_OK : USTREAM_ERR_MEM };
+
+    if (!stream->state) {
+        stream->ctx = abuf;
+        stream->write = ustream_async_write;
+        stream->writef = ustream_async_writef;
+        stream->flush = ustream_async_flush;
+        stream->free = ustream_async_free;
+        stream->writev = ustream_async_writev;
+    }
+
+    return stream->state;
+#endif
+}
+
+size_t uostream_async_dropped(UOStream *stream) {
+#if defined(ULIB_NO_THREADS)
+    (void)stream;
+    return 0;
+#else
+    if (stream->write != ustream_async_write) return 0;
+    UStreamAsync *abuf = stream->ctx;
+    umutex_lock(&abuf->lock);
+    size_t dropped = abuf->dropped;
+    umutex_unlock(&abuf->lock);
+    return dropped;
+#endif
+}
+
+#if !defined(ULIB_NO_COMPRESSION)
+
+ustream_ret uostream_compress(UOStream *stream, UOStream *dst, size_t block_size) {
+    if (!block_size) block_size = P_USTREAM_LZ4_DEFAULT_BLOCK;
+    if (block_size > P_USTREAM_LZ4_MAX_BLOCK) block_size = P_USTREAM_LZ4_MAX_BLOCK;
+
+    UStreamBuffered *buf = ustream_buffered_alloc(dst, block_size);
+    UStreamLz4 *lz = ustream_lz4_alloc(block_size, true);
+    *stream = (UOStream){ .state = buf && lz ? USTREAM_OK : USTREAM_ERR_MEM };
+
+    if (stream->state) {
+        ulib_free(buf);
+        ulib_free(lz);
+        return stream->state;
+    }
+
+    buf->codec = ustream_lz4_drain;
+    buf->codec_state = lz;
+    stream->ctx = buf;
+    stream->write = ustream_buffered_write;
+    stream->writef = ustream_buffered_writef;
+    stream->flush = ustream_buffered_flush;
+    stream->free = ustream_lz4_ofree;
+    stream->writev = ustream_buffered_writev;
+    stream->reserve = ustream_buffered_reserve;
+    stream->commit = ustream_buffered_commit;
+    return USTREAM_OK;
+}
+
+#endif
+
+ustream_ret uistream_stats(UIStream *stream, UIStream *src, UStreamStats *stats) {
+    UStreamStatsCtx *sc = ulib_alloc(sc);
+    *stream = (UIStream){ .state = sc ? USTREAM_OK : USTREAM_ERR_MEM };
+
+    if (!stream->state) {
+        *sc = (UStreamStatsCtx){ .stream = src, .stats = stats };
+        stream->ctx = sc;
+        stream->read = ustream_stats_read;
+        stream->reset = ustream_stats_reset;
+        stream->free = ustream_stats_ifree;
+        stream->peek = ustream_stats_peek;
+        stream->consume = ustream_stats_consume;
+    }
+
+    return stream->state;
+}
+
+ustream_ret uostream_stats(UOStream *stream, UOStream *dst, UStreamStats *stats) {
+    UStreamStatsCtx *sc = ulib_alloc(sc);
+    *stream = (UOStream){ .state = sc ? USTREAM_OK : USTREAM_ERR_MEM };
+
+    if (!stream->state) {
+        *sc = (UStreamStatsCtx){ .stream = dst, .stats = stats };
+        stream->ctx = sc;
+        stream->write = ustream_stats_write;
+        stream->writef = ustream_stats_writef;
+        stream->flush = ustream_stats_flush;
+        stream->free = ustream_stats_ofree;
+        stream->writev = ustream_stats_writev;
+    }
+
+    return stream->state;
+}
+
+utime_ns ustream_stats_time_percentile(UStreamStats const *stats, double percentile) {
+    uint64_t total = 0;
+    for (unsigned i = 0; i < USTREAM_STATS_BUCKETS; ++i) total += stats->time_hist[i];
+    if (!total) return 0;
+
+    double const target = percentile / 100.0 * (double)total;
+    uint64_t count = 0;
+
+    for (unsigned i = 0; i < USTREAM_STATS_BUCKETS - 1; ++i) {
+        count += stats->time_hist[i];
+        if ((double)count < target || !count) continue;
+        utime_ns bound = i ? (1ULL << i) - 1 : 0;
+        return bound < stats->max_time ? bound : stats->max_time;
+    }
+
+    return stats->max_time;
+}
+
+static ustream_ret uostream_write_stats_time(UOStream *stream, utime_ns time, size_t *written) {
+    return uostream_write_time_interval(stream, time, utime_interval_unit_auto(time), 2, written);
+}
+
+static void uostream_write_stats_hist(UOStream *stream, char const *name, uint64_t const *hist) {
+    uostream_writef(stream, NULL, "%s:\n", name);
+
+    for (unsigned i = 0; i < USTREAM_STATS_BUCKETS; ++i) {
+        if (!hist[i]) continue;
+        unsigned long long lo = i ? 1ULL << (i - 1) : 0, hi = i ? (1ULL << i) - 1 : 0;
+        char const *more = i == USTREAM_STATS_BUCKETS - 1 ? "+" : "";
+        uostream_writef(stream, NULL, "  %llu-%llu%s: %llu\n", lo, hi, more,
+                        (unsigned long long)hist[i]);
+    }
+}
+
+ustream_ret uostream_write_stats(UOStream *stream, UStreamStats const *stats, size_t *written) {
+    static char const *const errors[] = { "ok", "bounds", "mem", "io", "err" };
+    size_t const start = stream->written_bytes;
+    unsigned long long const calls = stats->calls, bytes = stats->bytes;
+
+    uostream_writef(stream, NULL, "calls: %llu, bytes: %llu, time: ", calls, bytes);
+    uostream_write_stats_time(stream, stats->time, NULL);
+    uostream_write_literal(stream, " (max ", NULL);
+    uostream_write_stats_time(stream, stats->max_time, NULL);
+    uostream_write_literal(stream, ", p99 ", NULL);
+    uostream_write_stats_time(stream, ustream_stats_time_percentile(stats, 99.0), NULL);
+    uostream_write_literal(stream, ")\nerrors:", NULL);
+
+    for (unsigned i = USTREAM_OK + 1; i < ulib_array_count(errors); ++i) {
+        uostream_writef(stream, NULL, " %s %llu", errors[i], (unsigned long long)stats->errors[i]);
+    }
+
+    uostream_write_literal(stream, "\n", NULL);
+    uostream_write_stats_hist(stream, "sizes (bytes)", stats->size_hist);
+    uostream_write_stats_hist(stream, "times (ns)", stats->time_hist);
+
+    if (written) *written = stream->written_bytes - start;
+    return stream->state;
+}
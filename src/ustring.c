@@ -8,10 +8,15 @@
  */
 
 #include "ustring.h"
+#include "uhash.h"
 #include "umacros.h"
 #include "ustrbuf.h"
+#include "usimd.h"
 #include <stdarg.h>
 
+// Needles at least this long are searched via the Boyer-Moore-Horspool algorithm.
+#define P_USTRING_HORSPOOL_THRESH 32
+
 UString const ustring_null = { ._s = { ._size = 0 } };
 UString const ustring_empty = { ._s = { ._size = 1 } };
 
@@ -29,7 +34,7 @@ UString ustring_assign(char const *buf, size_t length) {
     bool should_free = true;
     UString ret = ustring_null;
 
-    if (!buf) goto end;
+    if (!buf || length > USTRING_MAX_LENGTH) goto end;
 
     if (p_ustring_length_is_small(length)) {
         ret = ustring_small(buf, length);
@@ -45,13 +50,13 @@ end:
 }
 
 UString ustring_copy(char const *buf, size_t length) {
-    if (!buf) return ustring_null;
+    if (!buf || length > USTRING_MAX_LENGTH) return ustring_null;
     if (p_ustring_length_is_small(length)) return ustring_small(buf, length);
     return ustring_large(ulib_str_dup(buf, length), length);
 }
 
 UString ustring_wrap(char const *buf, size_t length) {
-    if (!buf) return ustring_null;
+    if (!buf || length > USTRING_MAX_LENGTH) return ustring_null;
     if (p_ustring_length_is_small(length)) return ustring_small(buf, length);
     return ustring_large(buf, length);
 }
@@ -63,7 +68,7 @@ char *ustring(UString *string, size_t length) {
         *string = (UString){ ._s = { ._size = (ulib_uint)length + 1 } };
         buf = string->_s._data;
     } else {
-        buf = ulib_malloc(length + 1);
+        buf = length > USTRING_MAX_LENGTH ? NULL : ulib_malloc(length + 1);
         if (buf) {
             *string = (UString){ ._l = { ._size = (ulib_uint)length + 1, ._data = buf } };
         } else {
@@ -75,8 +80,68 @@ char *ustring(UString *string, size_t length) {
     return buf;
 }
 
+// Reference count stored right before the characters of shared strings.
+typedef long p_ustring_refcount;
+#define P_USTRING_SHARED_HEADER sizeof(p_ustring_refcount)
+
+#if defined(ULIB_NO_THREADS)
+#define p_ustring_ref_inc(c) (++(*(c)))
+#define p_ustring_ref_dec(c) (--(*(c)))
+#elif defined(__GNUC__)
+#define p_ustring_ref_inc(c) __atomic_add_fetch(c, 1, __ATOMIC_RELAXED)
+#define p_ustring_ref_dec(c) __atomic_sub_fetch(c, 1, __ATOMIC_ACQ_REL)
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define p_ustring_ref_inc(c) _InterlockedIncrement(c)
+#define p_ustring_ref_dec(c) _InterlockedDecrement(c)
+#else
+#error "Shared strings require atomic operations, define ULIB_NO_THREADS to disable them."
+#endif
+
+static inline p_ustring_refcount *p_ustring_refcount_ptr(UString string) {
+    return (p_ustring_refcount *)(void *)(string._l._data - P_USTRING_SHARED_HEADER);
+}
+
+UString ustring_copy_shared(char const *buf, size_t length) {
+    if (!buf || length > USTRING_MAX_LENGTH) return ustring_null;
+    if (p_ustring_length_is_small(length)) return ustring_small(buf, length);
+
+    char *nbuf = ulib_malloc(P_USTRING_SHARED_HEADER + length + 1);
+    if (!nbuf) return ustring_null;
+
+    *(p_ustring_refcount *)(void *)nbuf = 1;
+    nbuf += P_USTRING_SHARED_HEADER;
+    memcpy(nbuf, buf, length);
+    nbuf[length] = '\0';
+
+    UString ret = ustring_large(nbuf, length);
+    ret._size |= P_USTRING_SHARED_FLAG;
+    return ret;
+}
+
+ulib_ret ustring_make_shared(UString *string) {
+    if (p_ustring_is_small(*string) || ustring_is_shared(*string)) return ULIB_OK;
+
+    ulib_uint const size = string->_size;
+    char *buf = ulib_realloc((void *)string->_l._data, P_USTRING_SHARED_HEADER + size);
+    if (!buf) return ULIB_ERR_MEM;
+
+    memmove(buf + P_USTRING_SHARED_HEADER, buf, size);
+    *(p_ustring_refcount *)(void *)buf = 1;
+    string->_l._data = buf + P_USTRING_SHARED_HEADER;
+    string->_size |= P_USTRING_SHARED_FLAG;
+    return ULIB_OK;
+}
+
 void ustring_deinit(UString *string) {
-    if (!p_ustring_is_small(*string)) ulib_free((void *)(string)->_l._data);
+    if (p_ustring_is_small(*string)) return;
+
+    if (!ustring_is_shared(*string)) {
+        ulib_free((void *)(string)->_l._data);
+    } else if (string->_l._data) {
+        p_ustring_refcount *count = p_ustring_refcount_ptr(*string);
+        if (p_ustring_ref_dec(count) == 0) ulib_free(count);
+    }
 }
 
 char *ustring_deinit_return_data(UString *string) {
@@ -85,6 +150,10 @@ char *ustring_deinit_return_data(UString *string) {
     if (p_ustring_is_small(*string)) {
         ret = ulib_malloc(string->_size);
         if (ret) memcpy(ret, string->_s._data, string->_size);
+    } else if (ustring_is_shared(*string)) {
+        ret = ulib_str_dup(ustring_data(*string), ustring_length(*string));
+        ustring_deinit(string);
+        string->_l._data = NULL;
     } else {
         ret = (char *)string->_l._data;
         string->_l._data = NULL;
@@ -94,6 +163,10 @@ char *ustring_deinit_return_data(UString *string) {
 }
 
 UString ustring_dup(UString string) {
+    if (ustring_is_shared(string)) {
+        p_ustring_ref_inc(p_ustring_refcount_ptr(string));
+        return string;
+    }
     return ustring_copy(ustring_data(string), ustring_length(string));
 }
 
@@ -106,32 +179,149 @@ ulib_uint ustring_index_of(UString string, char needle) {
 
 ulib_uint ustring_index_of_last(UString string, char needle) {
     char const *data = ustring_data(string);
-    ulib_uint len = ustring_length(string);
+    ulib_uint len = ustring_length(string), i = len;
+
+#if defined(P_USIMD)
+    p_usimd const n = p_usimd_splat_8(needle);
+    for (; i >= sizeof(p_usimd); i -= sizeof(p_usimd)) {
+        uint64_t mask = p_usimd_mask(p_usimd_eq_8(p_usimd_load(data + i - sizeof(p_usimd)), n));
+        if (mask) return i - (ulib_uint)sizeof(p_usimd) + p_usimd_last(mask);
+    }
+#endif
 
-    for (ulib_uint i = len; i-- != 0;) {
+    while (i-- != 0) {
         if (data[i] == needle) return i;
     }
 
     return len;
 }
 
+static ulib_uint p_ustring_find_horspool(char const *str, ulib_uint len, char const *n,
+                                         ulib_uint n_len) {
+    ulib_uint shift[256];
+    for (unsigned c = 0; c < 256; ++c) shift[c] = n_len;
+    for (ulib_uint j = 0; j < n_len - 1; ++j) shift[(unsigned char)n[j]] = n_len - 1 - j;
+
+    char const last = n[n_len - 1];
+
+    for (ulib_uint i = 0; len - i >= n_len;) {
+        char const c = str[i + n_len - 1];
+        if (c == last && memcmp(str + i, n, n_len - 1) == 0) return i;
+        i += shift[(unsigned char)c];
+    }
+
+    return len;
+}
+
+static ulib_uint p_ustring_find_last_horspool(char const *str, ulib_uint len, char const *n,
+                                              ulib_uint n_len) {
+    ulib_uint shift[256];
+    for (unsigned c = 0; c < 256; ++c) shift[c] = n_len;
+    for (ulib_uint j = n_len - 1; j > 0; --j) shift[(unsigned char)n[j]] = j;
+
+    char const first = n[0];
+
+    for (ulib_uint i = len - n_len;;) {
+        char const c = str[i];
+        if (c == first && memcmp(str + i + 1, n + 1, n_len - 1) == 0) return i;
+        if (i < shift[(unsigned char)c]) break;
+        i -= shift[(unsigned char)c];
+    }
+
+    return len;
+}
+
+/*
+ * Candidate positions are those whose first and last bytes match the needle's,
+ * which are found 16 at a time if SIMD is available.
+ */
+static ulib_uint p_ustring_find_filter(char const *str, ulib_uint len, char const *n,
+                                       ulib_uint n_len) {
+    ulib_uint const last_i = len - n_len;
+    char const first = n[0], last = n[n_len - 1];
+    ulib_uint i = 0;
+
+#if defined(P_USIMD)
+    p_usimd const f = p_usimd_splat_8(first), l = p_usimd_splat_8(last);
+
+    for (; i <= last_i && (size_t)(last_i - i) >= sizeof(p_usimd) - 1; i += sizeof(p_usimd)) {
+        p_usimd const fb = p_usimd_eq_8(p_usimd_load(str + i), f);
+        p_usimd const lb = p_usimd_eq_8(p_usimd_load(str + i + n_len - 1), l);
+
+        for (uint64_t mask = p_usimd_mask(p_usimd_and(fb, lb)); mask;) {
+            unsigned const k = p_usimd_first(mask);
+            if (memcmp(str + i + k + 1, n + 1, n_len - 2) == 0) return i + k;
+            mask = p_usimd_clear(mask, k);
+        }
+    }
+#endif
+
+    for (; i <= last_i; ++i) {
+        if (str[i] == first && str[i + n_len - 1] == last &&
+            memcmp(str + i + 1, n + 1, n_len - 2) == 0) {
+            return i;
+        }
+    }
+
+    return len;
+}
+
+static ulib_uint p_ustring_find_last_filter(char const *str, ulib_uint len, char const *n,
+                                            ulib_uint n_len) {
+    char const first = n[0], last = n[n_len - 1];
+    ulib_uint i = len - n_len + 1;
+
+#if defined(P_USIMD)
+    p_usimd const f = p_usimd_splat_8(first), l = p_usimd_splat_8(last);
+
+    for (; i >= sizeof(p_usimd); i -= sizeof(p_usimd)) {
+        char const *block = str + i - sizeof(p_usimd);
+        p_usimd const fb = p_usimd_eq_8(p_usimd_load(block), f);
+        p_usimd const lb = p_usimd_eq_8(p_usimd_load(block + n_len - 1), l);
+
+        for (uint64_t mask = p_usimd_mask(p_usimd_and(fb, lb)); mask;) {
+            unsigned const k = p_usimd_last(mask);
+            if (memcmp(block + k + 1, n + 1, n_len - 2) == 0) return (ulib_uint)(block - str) + k;
+            mask = p_usimd_clear(mask, k);
+        }
+    }
+#endif
+
+    while (i-- != 0) {
+        if (str[i] == first && str[i + n_len - 1] == last &&
+            memcmp(str + i + 1, n + 1, n_len - 2) == 0) {
+            return i;
+        }
+    }
+
+    return len;
+}
+
 ulib_uint ustring_find(UString string, UString needle) {
     char const *const str_data = ustring_data(string), *const n_data = ustring_data(needle);
     ulib_uint const str_len = ustring_length(string), n_len = ustring_length(needle);
-    ulib_uint const max_i = n_len < str_len ? str_len - n_len : 0;
-    for (ulib_uint i = 0; i < max_i; ++i) {
-        if (memcmp(str_data + i, n_data, n_len) == 0) return i;
+
+    if (!n_len) return 0;
+    if (n_len > str_len) return str_len;
+    if (n_len == 1) return ustring_index_of(string, n_data[0]);
+    if (n_len >= P_USTRING_HORSPOOL_THRESH) {
+        return p_ustring_find_horspool(str_data, str_len, n_data, n_len);
     }
-    return str_len;
+    return p_ustring_find_filter(str_data, str_len, n_data, n_len);
 }
 
 ulib_uint ustring_find_last(UString string, UString needle) {
     char const *const str_data = ustring_data(string), *const n_data = ustring_data(needle);
     ulib_uint const str_len = ustring_length(string), n_len = ustring_length(needle);
-    for (ulib_uint i = n_len < str_len ? str_len - n_len : 0; i-- != 0;) {
-        if (memcmp(str_data + i, n_data, n_len) == 0) return i;
+
+    // Empty needles are found at the last character, as in earlier releases.
+    if (!n_len) return str_len ? str_len - 1 : 0;
+    if (n_len > str_len) return str_len;
+    if (n_len == 1) return ustring_index_of_last(string, n_data[0]);
+    if (n_len >= P_USTRING_HORSPOOL_THRESH) {
+        return p_ustring_find_last_horspool(str_data, str_len, n_data, n_len);
     }
-    return str_len;
+    return p_ustring_find_last_filter(str_data, str_len, n_data, n_len);
 }
 
 bool ustring_starts_with(UString string, UString prefix) {
@@ -151,6 +341,12 @@ bool ustring_equals(UString lhs, UString rhs) {
     return len == ustring_length(rhs) && memcmp(ustring_data(lhs), ustring_data(rhs), len) == 0;
 }
 
+bool ustring_equals_ci(UString lhs, UString rhs) {
+    ulib_uint len = ustring_length(lhs);
+    if (len != ustring_length(rhs)) return false;
+    return ulib_str_equals_ci(ustring_data(lhs), ustring_data(rhs), len);
+}
+
 bool ustring_precedes(UString lhs, UString rhs) {
     return ustring_compare(lhs, rhs) < 0;
 }
@@ -162,55 +358,94 @@ int ustring_compare(UString lhs, UString rhs) {
 }
 
 ulib_uint ustring_hash(UString string) {
-#define ulib_cstring_hash_range(HASH, STR, START, END)                                             \
-    do {                                                                                           \
-        for (ulib_uint i = (START); i < (END); ++i) {                                              \
-            (HASH) = ((HASH) << 5u) - (HASH) + (ulib_uint)(STR)[i];                                \
-        }                                                                                          \
-    } while (0)
+    return uhash_bytes_hash(ustring_data(string), ustring_length(string));
+}
 
-    ulib_uint const length = ustring_length(string);
-    char const *cstr = ustring_data(string);
+// Case-insensitive hashes are computed over lowercased chunks of this size.
+#define P_USTRING_HASH_CI_CHUNK 128
+
+ulib_uint ustring_hash_ci(UString string) {
+    char const *data = ustring_data(string);
+    size_t const len = ustring_length(string);
+    char buf[P_USTRING_HASH_CI_CHUNK];
 
-    ulib_uint const part_size = 32;
-    ulib_uint hash = length;
+    size_t n = ulib_min(len, sizeof(buf));
+    ulib_str_to_lower(buf, data, n);
+    ulib_uint hash = uhash_bytes_hash(buf, n);
 
-    if (length <= 3 * part_size) {
-        ulib_cstring_hash_range(hash, cstr, 0, length);
-    } else {
-        ulib_uint const half_idx = length / 2;
-        ulib_uint const half_part_size = part_size / 2;
-        ulib_cstring_hash_range(hash, cstr, 0, part_size);
-        ulib_cstring_hash_range(hash, cstr, half_idx - half_part_size, half_idx + half_part_size);
-        ulib_cstring_hash_range(hash, cstr, length - part_size, length);
+    for (size_t i = n; i < len; i += n) {
+        n = ulib_min(len - i, sizeof(buf));
+        ulib_str_to_lower(buf, data + i, n);
+        hash = uhash_bytes_hash_seeded(buf, n, hash);
     }
 
     return hash;
 }
 
+// Strings may be views, such as split tokens, which are not null-terminated,
+// so they are copied before being passed to the strto* functions.
+static char *p_ustring_terminated(UString const *string, char *stack_buf, size_t stack_size) {
+    size_t const length = ustring_length(*string);
+    char *buf = length < stack_size ? stack_buf : ulib_malloc(length + 1);
+    if (!buf) return NULL;
+
+    memcpy(buf, ustring_data(*string), length);
+    buf[length] = '\0';
+    return buf;
+}
+
 ulib_ret ustring_to_int(UString string, ulib_int *out, unsigned base) {
-    char *end;
-    char const *start = ustring_data(string);
-    ulib_int r = ulib_str_to_int(start, &end, base);
-    if (end < start + ustring_length(string)) return ULIB_ERR;
+    ulib_uint const length = ustring_length(string);
+    ulib_int r;
+
+    if (base == 10) {
+        if (!length || ulib_str_parse_int(ustring_data(string), length, &r) != length) {
+            return ULIB_ERR;
+        }
+    } else {
+        char stack_buf[64], *end;
+        char *buf = p_ustring_terminated(&string, stack_buf, sizeof(stack_buf));
+        if (!buf) return ULIB_ERR_MEM;
+
+        r = ulib_str_to_int(buf, &end, base);
+        bool const valid = end >= buf + length;
+        if (buf != stack_buf) ulib_free(buf);
+        if (!valid) return ULIB_ERR;
+    }
+
     if (out) *out = r;
     return ULIB_OK;
 }
 
 ulib_ret ustring_to_uint(UString string, ulib_uint *out, unsigned base) {
-    char *end;
-    char const *start = ustring_data(string);
-    ulib_uint r = ulib_str_to_uint(start, &end, base);
-    if (end < start + ustring_length(string)) return ULIB_ERR;
+    ulib_uint const length = ustring_length(string);
+    ulib_uint r;
+
+    if (base == 10) {
+        if (!length || ulib_str_parse_uint(ustring_data(string), length, &r) != length) {
+            return ULIB_ERR;
+        }
+    } else {
+        char stack_buf[64], *end;
+        char *buf = p_ustring_terminated(&string, stack_buf, sizeof(stack_buf));
+        if (!buf) return ULIB_ERR_MEM;
+
+        r = ulib_str_to_uint(buf, &end, base);
+        bool const valid = end >= buf + length;
+        if (buf != stack_buf) ulib_free(buf);
+        if (!valid) return ULIB_ERR;
+    }
+
     if (out) *out = r;
     return ULIB_OK;
 }
 
 ulib_ret ustring_to_float(UString string, ulib_float *out) {
-    char *end;
-    char const *start = ustring_data(string);
-    ulib_float r = ulib_str_to_float(start, &end);
-    if (end < start + ustring_length(string)) return ULIB_ERR;
+    ulib_uint const length = ustring_length(string);
+    ulib_float r;
+    if (!length || ulib_str_parse_float(ustring_data(string), length, &r) != length) {
+        return ULIB_ERR;
+    }
     if (out) *out = r;
     return ULIB_OK;
 }
@@ -234,28 +469,48 @@ UString ustring_with_format_list(char const *format, va_list args) {
     return ustrbuf_to_ustring(&buf);
 }
 
-UString ustring_join(UString const *strings, ulib_uint count, UString sep) {
-    if (count == 0) return ustring_empty;
+static inline char *ustring_append_data(char *buf, UString string) {
+    size_t const len = ustring_length(string);
+    memcpy(buf, ustring_data(string), len);
+    return buf + len;
+}
 
-    UStrBuf buf = ustrbuf();
+UString ustring_join_affixed(UString const *strings, ulib_uint count, UString sep, UString prefix,
+                             UString suffix) {
+    size_t len = (size_t)ustring_length(prefix) + ustring_length(suffix);
+    if (count) len += (size_t)ustring_length(sep) * (count - 1);
+    for (ulib_uint i = 0; i < count; ++i) len += ustring_length(strings[i]);
+    if (len > USTRING_MAX_LENGTH) return ustring_null;
 
-    if (ustrbuf_append_ustring(&buf, strings[0])) {
-        ustrbuf_deinit(&buf);
-        return ustring_null;
-    }
+    UString ret;
+    char *buf = ustring(&ret, len);
+    if (!buf) return ret;
+
+    buf = ustring_append_data(buf, prefix);
 
-    for (ulib_uint i = 1; i < count; ++i) {
-        if (ustrbuf_append_ustring(&buf, sep) || ustrbuf_append_ustring(&buf, strings[i])) {
-            ustrbuf_deinit(&buf);
-            return ustring_null;
+    if (count) {
+        buf = ustring_append_data(buf, strings[0]);
+
+        if (ustring_length(sep)) {
+            for (ulib_uint i = 1; i < count; ++i) {
+                buf = ustring_append_data(buf, sep);
+                buf = ustring_append_data(buf, strings[i]);
+            }
+        } else {
+            for (ulib_uint i = 1; i < count; ++i) buf = ustring_append_data(buf, strings[i]);
         }
     }
 
-    return ustrbuf_to_ustring(&buf);
+    ustring_append_data(buf, suffix);
+    return ret;
+}
+
+UString ustring_join(UString const *strings, ulib_uint count, UString sep) {
+    return ustring_join_affixed(strings, count, sep, ustring_empty, ustring_empty);
 }
 
 UString ustring_concat(UString const *strings, ulib_uint count) {
-    return ustring_join(strings, count, ustring_empty);
+    return ustring_join_affixed(strings, count, ustring_empty, ustring_empty, ustring_empty);
 }
 
 UString ustring_repeating(UString string, ulib_uint times) {
@@ -290,3 +545,72 @@ UString ustring_to_lower(UString string) {
     ulib_str_to_lower(buf, ustring_data(string), len);
     return ret;
 }
+
+enum {
+    P_USTRSPLIT_CHAR,
+    P_USTRSPLIT_SET,
+    P_USTRSPLIT_STRING,
+};
+
+static inline UStrSplit ustrsplit_init(UString string, ulib_byte mode) {
+    // The string is stored by value, as small strings keep their characters inline.
+    return (UStrSplit){ ._string = string, ._mode = mode };
+}
+
+UStrSplit ustring_split(UString string, char sep) {
+    UStrSplit split = ustrsplit_init(string, P_USTRSPLIT_CHAR);
+    split._set[0] = (ulib_byte)sep;
+    return split;
+}
+
+UStrSplit ustring_split_any(UString string, UString chars) {
+    UStrSplit split = ustrsplit_init(string, P_USTRSPLIT_SET);
+    unsigned char const *c = (unsigned char const *)ustring_data(chars);
+
+    for (ulib_uint i = 0, n = ustring_length(chars); i < n; ++i) {
+        split._set[c[i] >> 3] |= (ulib_byte)(1u << (c[i] & 7));
+    }
+
+    return split;
+}
+
+UStrSplit ustring_split_string(UString string, UString sep) {
+    UStrSplit split = ustrsplit_init(string, P_USTRSPLIT_STRING);
+    split._sep = sep;
+    return split;
+}
+
+bool ustrsplit_next(UStrSplit *split, UString *token) {
+    if (split->_done) return false;
+
+    char const *cur = ustring_data(split->_string) + split->_pos;
+    char const *end = ustring_data(split->_string) + ustring_length(split->_string);
+    size_t const len = (size_t)(end - cur);
+    char const *found = NULL;
+    size_t sep_len = 1;
+
+    if (split->_mode == P_USTRSPLIT_CHAR) {
+        found = len ? memchr(cur, (char)split->_set[0], len) : NULL;
+    } else if (split->_mode == P_USTRSPLIT_SET) {
+        for (char const *c = cur; c != end; ++c) {
+            unsigned char const uc = (unsigned char)*c;
+            if (split->_set[uc >> 3] & (1u << (uc & 7))) {
+                found = c;
+                break;
+            }
+        }
+    } else if ((sep_len = ustring_length(split->_sep))) {
+        ulib_uint const i = ustring_find(ustring_wrap(cur, len), split->_sep);
+        if (i < len) found = cur + i;
+    }
+
+    if (found) {
+        *token = ustring_wrap(cur, (size_t)(found - cur));
+        split->_pos += (ulib_uint)(found - cur + sep_len);
+    } else {
+        *token = ustring_wrap(cur, len);
+        split->_done = true;
+    }
+
+    return true;
+}
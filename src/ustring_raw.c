@@ -8,6 +8,7 @@
  */
 
 #include "ustring_raw.h"
+#include "usimd.h"
 
 char *ulib_str_dup(char const *string, size_t length) {
     char *buf = ulib_malloc(length + 1);
@@ -20,6 +21,117 @@ char *ulib_str_dup(char const *string, size_t length) {
     return buf;
 }
 
+void ulib_str_to_upper(char *dst, char const *src, size_t length) {
+    size_t i = 0;
+#if defined(P_USIMD)
+    for (; length - i >= sizeof(p_usimd); i += sizeof(p_usimd)) {
+        p_usimd_store(dst + i, p_usimd_to_upper(p_usimd_load(src + i)));
+    }
+#endif
+    for (; i < length; ++i) dst[i] = ulib_char_to_upper(src[i]);
+}
+
+void ulib_str_to_lower(char *dst, char const *src, size_t length) {
+    size_t i = 0;
+#if defined(P_USIMD)
+    for (; length - i >= sizeof(p_usimd); i += sizeof(p_usimd)) {
+        p_usimd_store(dst + i, p_usimd_to_lower(p_usimd_load(src + i)));
+    }
+#endif
+    for (; i < length; ++i) dst[i] = ulib_char_to_lower(src[i]);
+}
+
+bool ulib_str_equals_ci(char const *lhs, char const *rhs, size_t length) {
+    size_t i = 0;
+#if defined(P_USIMD)
+    for (; length - i >= sizeof(p_usimd); i += sizeof(p_usimd)) {
+        p_usimd const l = p_usimd_to_lower(p_usimd_load(lhs + i));
+        p_usimd const r = p_usimd_to_lower(p_usimd_load(rhs + i));
+        if (p_usimd_count(p_usimd_mask(p_usimd_eq_8(l, r))) != sizeof(p_usimd)) return false;
+    }
+#endif
+    for (; i < length; ++i) {
+        if (ulib_char_to_lower(lhs[i]) != ulib_char_to_lower(rhs[i])) return false;
+    }
+    return true;
+}
+
+static inline bool p_ulib_utf8_cont(unsigned char c) {
+    return (c & 0xC0) == 0x80;
+}
+
+// Returns the length of the UTF-8 sequence beginning with a non-ASCII byte, or 0 if invalid.
+static size_t p_ulib_utf8_seq_length(unsigned char const *s, size_t length) {
+    unsigned char const c = s[0];
+
+    if (c < 0xC2) return 0;
+
+    if (c < 0xE0) return length >= 2 && p_ulib_utf8_cont(s[1]) ? 2 : 0;
+
+    if (c < 0xF0) {
+        if (length < 3 || !p_ulib_utf8_cont(s[1]) || !p_ulib_utf8_cont(s[2])) return 0;
+        // Overlong encodings and surrogates.
+        if ((c == 0xE0 && s[1] < 0xA0) || (c == 0xED && s[1] > 0x9F)) return 0;
+        return 3;
+    }
+
+    if (c < 0xF5) {
+        if (length < 4 || !p_ulib_utf8_cont(s[1]) || !p_ulib_utf8_cont(s[2]) ||
+            !p_ulib_utf8_cont(s[3])) {
+            return 0;
+        }
+        // Overlong encodings and code points above U+10FFFF.
+        if ((c == 0xF0 && s[1] < 0x90) || (c == 0xF4 && s[1] > 0x8F)) return 0;
+        return 4;
+    }
+
+    return 0;
+}
+
+bool ulib_str_is_valid_utf8(char const *string, size_t length) {
+    unsigned char const *s = (unsigned char const *)string;
+    size_t i = 0;
+
+    while (i < length) {
+#if defined(P_USIMD)
+        // Skip ASCII runs a vector at a time, stopping at the first non-ASCII byte.
+        for (; length - i >= sizeof(p_usimd); i += sizeof(p_usimd)) {
+            uint64_t const mask = p_usimd_non_ascii(p_usimd_load(s + i));
+            if (mask) {
+                i += p_usimd_first(mask);
+                break;
+            }
+        }
+        if (i == length) break;
+#endif
+        if (s[i] < 0x80) {
+            ++i;
+            continue;
+        }
+
+        size_t const seq = p_ulib_utf8_seq_length(s + i, length - i);
+        if (!seq) return false;
+        i += seq;
+    }
+
+    return true;
+}
+
+size_t ulib_str_utf8_length(char const *string, size_t length) {
+    size_t count = 0, i = 0;
+
+#if defined(P_USIMD)
+    p_usimd const hi = p_usimd_splat_8(0xC0), cont = p_usimd_splat_8(0x80);
+    for (; length - i >= sizeof(p_usimd); i += sizeof(p_usimd)) {
+        p_usimd const v = p_usimd_and(p_usimd_load(string + i), hi);
+        count += sizeof(p_usimd) - p_usimd_count(p_usimd_mask(p_usimd_eq_8(v, cont)));
+    }
+#endif
+
+    for (; i < length; ++i) count += !p_ulib_utf8_cont((unsigned char)string[i]);
+    return count;
+}
+
 size_t ulib_str_flength(char const *format, ...) {
     va_list args;
     va_start(args, format);
@@ -35,3 +147,171 @@ size_t ulib_str_flength_list(char const *format, va_list argptr) {
     va_end(args);
     return res > 0 ? (size_t)res : 0;
 }
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define P_ULIB_STR_SWAR 1
+#elif defined(_WIN32)
+#define P_ULIB_STR_SWAR 1
+#endif
+
+#if defined(P_ULIB_STR_SWAR)
+
+static inline uint64_t p_ulib_str_load_8(char const *src) {
+    uint64_t block;
+    memcpy(&block, src, sizeof(block));
+    return block;
+}
+
+static inline bool p_ulib_str_is_8_digits(uint64_t block) {
+    uint64_t const hi = 0xF0F0F0F0F0F0F0F0ULL;
+    return ((block & hi) | (((block + 0x0606060606060606ULL) & hi) >> 4)) == 0x3333333333333333ULL;
+}
+
+static inline uint64_t p_ulib_str_parse_8_digits(uint64_t block) {
+    uint64_t const mask = 0x000000FF000000FFULL;
+    uint64_t const mul1 = 100 + (1000000ULL << 32);
+    uint64_t const mul2 = 1 + (10000ULL << 32);
+    block -= 0x3030303030303030ULL;
+    block = (block * 10) + (block >> 8);
+    return (((block & mask) * mul1 + ((block >> 16) & mask) * mul2) >> 32) & 0xFFFFFFFFULL;
+}
+
+#endif
+
+// Accumulates decimal digits into 'value', returning the number of digits consumed.
+// Digits that would overflow 64 bits are consumed, but set 'overflow' instead.
+static size_t p_ulib_str_parse_digits(char const *src, size_t length, uint64_t *value,
+                                      bool *overflow) {
+    uint64_t v = *value;
+    size_t i = 0;
+
+#if defined(P_ULIB_STR_SWAR)
+    // (UINT64_MAX - 99999999) / 10^8: largest value that can absorb 8 more digits.
+    for (; length - i >= 8 && v <= 184467440736ULL; i += 8) {
+        uint64_t const block = p_ulib_str_load_8(src + i);
+        if (!p_ulib_str_is_8_digits(block)) break;
+        v = v * 100000000 + p_ulib_str_parse_8_digits(block);
+    }
+#endif
+
+    for (; i < length && (unsigned char)(src[i] - '0') < 10; ++i) {
+        unsigned const digit = (unsigned)(src[i] - '0');
+        if (v > (UINT64_MAX - digit) / 10) {
+            *overflow = true;
+        } else {
+            v = v * 10 + digit;
+        }
+    }
+
+    *value = v;
+    return i;
+}
+
+size_t ulib_str_parse_uint(char const *src, size_t length, ulib_uint *out) {
+    size_t i = length && src[0] == '+';
+    uint64_t v = 0;
+    bool overflow = false;
+    size_t const digits = p_ulib_str_parse_digits(src + i, length - i, &v, &overflow);
+    if (!digits || overflow || v > ULIB_UINT_MAX) return 0;
+    if (out) *out = (ulib_uint)v;
+    return i + digits;
+}
+
+size_t ulib_str_parse_int(char const *src, size_t length, ulib_int *out) {
+    bool const negative = length && src[0] == '-';
+    size_t i = length && (src[0] == '-' || src[0] == '+');
+    uint64_t v = 0;
+    bool overflow = false;
+    size_t const digits = p_ulib_str_parse_digits(src + i, length - i, &v, &overflow);
+    if (!digits || overflow || v > (uint64_t)ULIB_INT_MAX + negative) return 0;
+    if (out) *out = negative ? (ulib_int)(-(int64_t)(v - 1) - 1) : (ulib_int)v;
+    return i + digits;
+}
+
+#if defined ULIB_TINY
+#define P_ULIB_STR_FLOAT_MAX_MANTISSA (1ULL << 24)
+#define P_ULIB_STR_FLOAT_MAX_EXP 10
+#else
+#define P_ULIB_STR_FLOAT_MAX_MANTISSA (1ULL << 53)
+#define P_ULIB_STR_FLOAT_MAX_EXP 22
+#endif
+
+// Powers of ten that are exactly representable as ulib_float.
+static ulib_float const p_ulib_str_pow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10,
+#if !defined ULIB_TINY
+    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+#endif
+};
+
+// Parses the string via strtod/strtof, copying it so that it is null-terminated.
+static size_t p_ulib_str_parse_float_slow(char const *src, size_t length, ulib_float *out) {
+    char stack_buf[64];
+    char *buf = length < sizeof(stack_buf) ? stack_buf : ulib_malloc(length + 1);
+    if (!buf) return 0;
+
+    memcpy(buf, src, length);
+    buf[length] = '\0';
+
+    char *end;
+    ulib_float const value = ulib_str_to_float(buf, &end);
+    size_t const read = (size_t)(end - buf);
+    if (buf != stack_buf) ulib_free(buf);
+
+    if (read && out) *out = value;
+    return read;
+}
+
+size_t ulib_str_parse_float(char const *src, size_t length, ulib_float *out) {
+    size_t i = 0;
+    bool negative = false;
+
+    if (i < length && (src[i] == '-' || src[i] == '+')) negative = src[i++] == '-';
+
+    uint64_t mantissa = 0;
+    bool overflow = false;
+    size_t digits = p_ulib_str_parse_digits(src + i, length - i, &mantissa, &overflow);
+    i += digits;
+    int64_t exp = 0;
+
+    if (i < length && src[i] == '.') {
+        size_t const frac = p_ulib_str_parse_digits(src + i + 1, length - i - 1, &mantissa,
+                                                    &overflow);
+        if (frac || digits) i += frac + 1;
+        exp -= (int64_t)frac;
+        digits += frac;
+    }
+
+    if (!digits) {
+        // Leave special values such as "inf" and "nan" to the C library.
+        char const c = i < length ? (char)(src[i] | 0x20) : '\0';
+        return c == 'i' || c == 'n' ? p_ulib_str_parse_float_slow(src, length, out) : 0;
+    }
+
+    if (i < length && (src[i] | 0x20) == 'e') {
+        size_t j = i + 1;
+        bool const exp_negative = j < length && src[j] == '-';
+        if (j < length && (src[j] == '-' || src[j] == '+')) ++j;
+
+        uint64_t e = 0;
+        bool e_overflow = false;
+        size_t const e_digits = p_ulib_str_parse_digits(src + j, length - j, &e, &e_overflow);
+
+        if (e_digits) {
+            if (e_overflow || e > INT32_MAX) overflow = true;
+            exp += exp_negative ? -(int64_t)e : (int64_t)e;
+            i = j + e_digits;
+        }
+    }
+
+    // Fast path: exact mantissa and power of ten, with a single correctly rounded operation.
+    if (overflow || mantissa > P_ULIB_STR_FLOAT_MAX_MANTISSA || exp < -P_ULIB_STR_FLOAT_MAX_EXP ||
+        exp > P_ULIB_STR_FLOAT_MAX_EXP) {
+        return p_ulib_str_parse_float_slow(src, i, out) == i ? i : 0;
+    }
+
+    ulib_float value = (ulib_float)mantissa;
+    value = exp < 0 ? value / p_ulib_str_pow10[-exp] : value * p_ulib_str_pow10[exp];
+    if (out) *out = negative ? -value : value;
+    return i;
+}
@@ -0,0 +1,334 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "ustrmatch.h"
+#include "uhash.h"
+#include "usimd.h"
+
+#define P_USTRMATCH_NONE ULIB_UINT_MAX
+#define P_USTRMATCH_BUF_SIZE 4096
+
+// Trie edges, keyed by node * classes + class.
+UHASH_INIT(p_ustrmatch_edges, uint64_t, ulib_uint, uhash_int64_hash, uhash_identical)
+
+UVEC_IMPL(UStrMatch)
+
+static inline uint64_t ustrmatcher_edge(UStrMatcher const *m, ulib_uint node, ulib_uint cls) {
+    return (uint64_t)node * m->_classes + cls;
+}
+
+static ulib_ret ustrmatcher_fill(UVec(ulib_uint) *vec, ulib_uint count, ulib_uint value) {
+    if (uvec_reserve(ulib_uint, vec, count)) return ULIB_ERR_MEM;
+    ulib_uint *data = uvec_data(ulib_uint, vec);
+    for (ulib_uint i = 0; i < count; ++i) data[i] = value;
+    vec->_count = count;
+    return ULIB_OK;
+}
+
+static void ustrmatcher_init_classes(UStrMatcher *m, UVec(UString) const *needles) {
+    bool present[256] = { 0 };
+    ulib_uint distinct = 0;
+
+    uvec_foreach (UString, needles, needle) {
+        unsigned char const *s = (unsigned char const *)ustring_data(*needle.item);
+        for (ulib_uint i = 0, n = ustring_length(*needle.item); i < n; ++i) {
+            if (!present[s[i]]) ++distinct;
+            present[s[i]] = true;
+        }
+    }
+
+    // Bytes that do not occur in any needle share class 0, if any such byte exists.
+    ulib_uint cls = distinct < 256 ? 1 : 0;
+    for (unsigned i = 0; i < 256; ++i) {
+        m->_class[i] = present[i] ? (ulib_byte)cls++ : 0;
+    }
+    m->_classes = cls;
+}
+
+static ulib_ret ustrmatcher_build_trie(UStrMatcher *m, UVec(UString) const *needles,
+                                       UHash(p_ustrmatch_edges) *edges) {
+    if (uvec_push(ulib_uint, &m->_out, P_USTRMATCH_NONE)) return ULIB_ERR_MEM;
+    ulib_uint first_count = 0;
+
+    uvec_foreach (UString, needles, needle) {
+        unsigned char const *s = (unsigned char const *)ustring_data(*needle.item);
+        ulib_uint const len = ustring_length(*needle.item);
+        ulib_uint node = 0;
+
+        if (uvec_push(ulib_uint, &m->_lengths, len)) return ULIB_ERR_MEM;
+        if (!len) continue;
+
+        for (ulib_uint i = 0; i < len; ++i) {
+            uint64_t const key = ustrmatcher_edge(m, node, m->_class[s[i]]);
+            ulib_uint const next = uvec_count(ulib_uint, &m->_out);
+            ulib_uint existing;
+
+            uhash_ret ret = uhash_put(p_ustrmatch_edges, edges, key, &existing);
+            if (ret == UHASH_ERR) return ULIB_ERR_MEM;
+
+            if (ret == UHASH_PRESENT) {
+                node = uhash_value(p_ustrmatch_edges, edges, existing);
+                continue;
+            }
+
+            if (next == P_USTRMATCH_NONE) return ULIB_ERR_MEM;
+            uhash_value(p_ustrmatch_edges, edges, existing) = next;
+            if (uvec_push(ulib_uint, &m->_out, P_USTRMATCH_NONE)) return ULIB_ERR_MEM;
+
+            if (!node) {
+                if (first_count < USTRMATCHER_PREFILTER_MAX) m->_first[first_count] = s[i];
+                ++first_count;
+            }
+
+            node = next;
+        }
+
+        ulib_uint *out = uvec_data(ulib_uint, &m->_out) + node;
+        if (*out == P_USTRMATCH_NONE) *out = needle.i;
+    }
+
+    m->_first_count = first_count <= USTRMATCHER_PREFILTER_MAX ? (ulib_byte)first_count : 0;
+    return ULIB_OK;
+}
+
+static ulib_ret ustrmatcher_build_automaton(UStrMatcher *m,
+                                           UHash(p_ustrmatch_edges) const *edges) {
+    ulib_uint const nodes = uvec_count(ulib_uint, &m->_out), classes = m->_classes;
+    if ((size_t)nodes * classes >= P_USTRMATCH_NONE) return ULIB_ERR_MEM;
+
+    ulib_ret ret = ULIB_ERR_MEM;
+    UVec(ulib_uint) fail = uvec(ulib_uint), queue = uvec(ulib_uint);
+
+    if (ustrmatcher_fill(&m->_delta, nodes * classes, 0) ||
+        ustrmatcher_fill(&m->_link, nodes, 0) || ustrmatcher_fill(&fail, nodes, 0) ||
+        uvec_reserve(ulib_uint, &queue, nodes)) {
+        goto end;
+    }
+
+    ulib_uint *delta = uvec_data(ulib_uint, &m->_delta);
+    ulib_uint *link = uvec_data(ulib_uint, &m->_link);
+    ulib_uint const *out = uvec_data(ulib_uint, &m->_out);
+    ulib_uint *f = uvec_data(ulib_uint, &fail);
+    uvec_push(ulib_uint, &queue, 0);
+
+    // Breadth-first visit, so that the transitions of failure nodes are complete when needed.
+    for (ulib_uint head = 0; head < uvec_count(ulib_uint, &queue); ++head) {
+        ulib_uint const node = uvec_get(ulib_uint, &queue, head);
+        ulib_uint *row = delta + (size_t)node * classes;
+        ulib_uint const *fail_row = delta + (size_t)f[node] * classes;
+
+        for (ulib_uint cls = 0; cls < classes; ++cls) {
+            ulib_uint i = uhash_get(p_ustrmatch_edges, edges, ustrmatcher_edge(m, node, cls));
+
+            if (i == UHASH_INDEX_MISSING) {
+                row[cls] = node ? fail_row[cls] : 0;
+                continue;
+            }
+
+            ulib_uint const child = uhash_value(p_ustrmatch_edges, edges, i);
+            ulib_uint const child_fail = node ? fail_row[cls] : 0;
+            f[child] = child_fail;
+            link[child] = out[child_fail] != P_USTRMATCH_NONE ? child_fail : link[child_fail];
+            row[cls] = child;
+            uvec_push(ulib_uint, &queue, child);
+        }
+    }
+
+    ret = ULIB_OK;
+
+end:
+    uvec_deinit(ulib_uint, &fail);
+    uvec_deinit(ulib_uint, &queue);
+    return ret;
+}
+
+ulib_ret ustrmatcher_init(UStrMatcher *matcher, UVec(UString) const *needles) {
+    *matcher = (UStrMatcher){
+        ._delta = uvec(ulib_uint),
+        ._out = uvec(ulib_uint),
+        ._link = uvec(ulib_uint),
+        ._lengths = uvec(ulib_uint),
+    };
+
+    ustrmatcher_init_classes(matcher, needles);
+    UHash(p_ustrmatch_edges) edges = uhmap(p_ustrmatch_edges);
+    ulib_ret ret = ustrmatcher_build_trie(matcher, needles, &edges);
+    if (!ret) ret = ustrmatcher_build_automaton(matcher, &edges);
+    uhash_deinit(p_ustrmatch_edges, &edges);
+
+    if (ret) ustrmatcher_deinit(matcher);
+    return ret;
+}
+
+void ustrmatcher_deinit(UStrMatcher *matcher) {
+    uvec_deinit(ulib_uint, &matcher->_delta);
+    uvec_deinit(ulib_uint, &matcher->_out);
+    uvec_deinit(ulib_uint, &matcher->_link);
+    uvec_deinit(ulib_uint, &matcher->_lengths);
+}
+
+// Returns the index of the first byte that may start an occurrence, or len if there is none.
+static size_t
+ustrmatcher_skip(UStrMatcher const *m, unsigned char const *s, size_t i, size_t len) {
+#if defined(P_USIMD)
+    if (m->_first_count) {
+        p_usimd first[USTRMATCHER_PREFILTER_MAX];
+        for (unsigned j = 0; j < m->_first_count; ++j) first[j] = p_usimd_splat_8(m->_first[j]);
+
+        for (; len - i >= sizeof(p_usimd); i += sizeof(p_usimd)) {
+            p_usimd const v = p_usimd_load(s + i);
+            p_usimd eq = p_usimd_eq_8(v, first[0]);
+            for (unsigned j = 1; j < m->_first_count; ++j) {
+                eq = p_usimd_or(eq, p_usimd_eq_8(v, first[j]));
+            }
+            uint64_t const mask = p_usimd_mask(eq);
+            if (mask) return i + p_usimd_first(mask);
+        }
+    }
+#endif
+
+    ulib_uint const *root = uvec_data(ulib_uint, &m->_delta);
+    while (i < len && !root[m->_class[s[i]]]) ++i;
+    return i;
+}
+
+/*
+ * Advances the automaton over the specified bytes, stopping after the first byte
+ * at which an occurrence ends. Returns the number of consumed bytes.
+ */
+static size_t
+ustrmatcher_scan(UStrMatcher const *m, ulib_uint *state, unsigned char const *s, size_t len) {
+    ulib_uint const *delta = uvec_data(ulib_uint, &m->_delta);
+    ulib_uint const *out = uvec_data(ulib_uint, &m->_out);
+    ulib_uint const *link = uvec_data(ulib_uint, &m->_link);
+    ulib_uint const classes = m->_classes;
+    ulib_uint node = *state;
+    size_t i = 0;
+
+    while (i < len) {
+        if (!node && (i = ustrmatcher_skip(m, s, i, len)) == len) break;
+        node = delta[(size_t)node * classes + m->_class[s[i++]]];
+        if (out[node] != P_USTRMATCH_NONE || link[node]) break;
+    }
+
+    *state = node;
+    return i;
+}
+
+static inline bool ustrmatcher_is_match(UStrMatcher const *m, ulib_uint node) {
+    return uvec_get(ulib_uint, &m->_out, node) != P_USTRMATCH_NONE ||
+           uvec_get(ulib_uint, &m->_link, node);
+}
+
+static inline UStrMatch ustrmatcher_match(UStrMatcher const *m, ulib_uint node, size_t end) {
+    ulib_uint const needle = uvec_get(ulib_uint, &m->_out, node);
+    return (UStrMatch){ needle, end - uvec_get(ulib_uint, &m->_lengths, needle) };
+}
+
+// Returns the longest occurrence ending at the specified node, which must have one.
+static inline UStrMatch ustrmatcher_longest(UStrMatcher const *m, ulib_uint node, size_t end) {
+    if (uvec_get(ulib_uint, &m->_out, node) == P_USTRMATCH_NONE) {
+        node = uvec_get(ulib_uint, &m->_link, node);
+    }
+    return ustrmatcher_match(m, node, end);
+}
+
+static ulib_ret ustrmatcher_push_all(UStrMatcher const *m, ulib_uint node, size_t end,
+                                     UVec(UStrMatch) *matches) {
+    if (uvec_get(ulib_uint, &m->_out, node) == P_USTRMATCH_NONE) {
+        node = uvec_get(ulib_uint, &m->_link, node);
+    }
+
+    for (; node; node = uvec_get(ulib_uint, &m->_link, node)) {
+        if (uvec_push(UStrMatch, matches, ustrmatcher_match(m, node, end))) return ULIB_ERR_MEM;
+    }
+
+    return ULIB_OK;
+}
+
+bool ustrmatcher_find(UStrMatcher const *matcher, UString string, UStrMatch *match) {
+    unsigned char const *s = (unsigned char const *)ustring_data(string);
+    size_t const len = ustring_length(string);
+    ulib_uint node = 0;
+    size_t const end = ustrmatcher_scan(matcher, &node, s, len);
+    if (!ustrmatcher_is_match(matcher, node)) return false;
+    if (match) *match = ustrmatcher_longest(matcher, node, end);
+    return true;
+}
+
+ulib_ret ustrmatcher_find_all(UStrMatcher const *matcher, UString string,
+                              UVec(UStrMatch) *matches) {
+    unsigned char const *s = (unsigned char const *)ustring_data(string);
+    size_t const len = ustring_length(string);
+    ulib_uint node = 0;
+
+    for (size_t i = 0; i < len;) {
+        i += ustrmatcher_scan(matcher, &node, s + i, len - i);
+        if (ustrmatcher_push_all(matcher, node, i, matches)) return ULIB_ERR_MEM;
+    }
+
+    return ULIB_OK;
+}
+
+// Returns the next chunk of the stream, without copying it if the stream supports peeking.
+static ustream_ret ustrmatcher_next_chunk(UIStream *stream, unsigned char *buf,
+                                          unsigned char const **chunk, size_t *len) {
+    if (stream->peek) return uistream_peek(stream, (void const **)chunk, len);
+    *chunk = buf;
+    return uistream_read(stream, buf, P_USTRMATCH_BUF_SIZE, len);
+}
+
+static inline void ustrmatcher_consume_chunk(UIStream *stream, size_t len) {
+    if (stream->peek) uistream_consume(stream, len);
+}
+
+ustream_ret ustrmatcher_find_stream(UStrMatcher const *matcher, UIStream *stream,
+                                    UStrMatch *match, bool *found) {
+    unsigned char buf[P_USTRMATCH_BUF_SIZE];
+    unsigned char const *chunk;
+    ulib_uint node = 0;
+    size_t offset = 0, len;
+    ustream_ret ret;
+    *found = false;
+
+    while (!(ret = ustrmatcher_next_chunk(stream, buf, &chunk, &len)) && len) {
+        size_t const i = ustrmatcher_scan(matcher, &node, chunk, len);
+        ustrmatcher_consume_chunk(stream, i);
+
+        if (ustrmatcher_is_match(matcher, node)) {
+            if (match) *match = ustrmatcher_longest(matcher, node, offset + i);
+            *found = true;
+            return USTREAM_OK;
+        }
+
+        offset += i;
+    }
+
+    return ret;
+}
+
+ustream_ret ustrmatcher_find_all_stream(UStrMatcher const *matcher, UIStream *stream,
+                                        UVec(UStrMatch) *matches) {
+    unsigned char buf[P_USTRMATCH_BUF_SIZE];
+    unsigned char const *chunk;
+    ulib_uint node = 0;
+    size_t offset = 0, len;
+    ustream_ret ret;
+
+    while (!(ret = ustrmatcher_next_chunk(stream, buf, &chunk, &len)) && len) {
+        for (size_t i = 0; i < len;) {
+            i += ustrmatcher_scan(matcher, &node, chunk + i, len - i);
+            if (ustrmatcher_push_all(matcher, node, offset + i, matches)) return USTREAM_ERR_MEM;
+        }
+        ustrmatcher_consume_chunk(stream, len);
+        offset += len;
+    }
+
+    return ret;
+}
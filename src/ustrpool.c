@@ -0,0 +1,97 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "ustrpool.h"
+
+UHASH_IMPL(p_ustrpool, ustring_hash, ustring_equals)
+UVEC_IMPL(p_ustrpool_str)
+
+UStringPool ustrpool(void) {
+    return (UStringPool){
+        ._ids = uhmap(p_ustrpool),
+        ._strings = uvec(p_ustrpool_str),
+        ._chunks = uvec(ulib_ptr),
+    };
+}
+
+void ustrpool_deinit(UStringPool *pool) {
+    uvec_foreach (ulib_ptr, &pool->_chunks, chunk) {
+        ulib_free(*chunk.item);
+    }
+    uvec_deinit(ulib_ptr, &pool->_chunks);
+    uvec_deinit(p_ustrpool_str, &pool->_strings);
+    uhash_deinit(p_ustrpool, &pool->_ids);
+    pool->_cur = NULL;
+    pool->_left = 0;
+}
+
+static char *ustrpool_alloc(UStringPool *pool, size_t size) {
+    if (size <= pool->_left) {
+        char *buf = pool->_cur;
+        pool->_cur += size;
+        pool->_left -= size;
+        return buf;
+    }
+
+    size_t const chunk_size = size > USTRPOOL_CHUNK_SIZE / 4 ? size : USTRPOOL_CHUNK_SIZE;
+    char *buf = ulib_malloc(chunk_size);
+    if (!buf) return NULL;
+
+    if (uvec_push(ulib_ptr, &pool->_chunks, buf)) {
+        ulib_free(buf);
+        return NULL;
+    }
+
+    // Dedicated chunks do not replace the current one, which may still have room.
+    if (chunk_size != size) {
+        pool->_cur = buf + size;
+        pool->_left = chunk_size - size;
+    }
+
+    return buf;
+}
+
+ulib_ret ustrpool_intern(UStringPool *pool, UString string, ulib_uint *id) {
+    ulib_uint i = uhash_get(p_ustrpool, &pool->_ids, string);
+
+    if (i != UHASH_INDEX_MISSING) {
+        if (id) *id = uhash_value(p_ustrpool, &pool->_ids, i);
+        return ULIB_OK;
+    }
+
+    size_t const length = ustring_length(string);
+    UString stored;
+
+    if (p_ustring_length_is_small(length)) {
+        stored = string;
+    } else {
+        char *buf = ustrpool_alloc(pool, length + 1);
+        if (!buf) return ULIB_ERR_MEM;
+        memcpy(buf, ustring_data(string), length);
+        buf[length] = '\0';
+        stored = ustring_wrap(buf, length);
+    }
+
+    ulib_uint const next = ustrpool_count(pool);
+    if (uvec_push(p_ustrpool_str, &pool->_strings, stored)) return ULIB_ERR_MEM;
+
+    if (uhmap_add(p_ustrpool, &pool->_ids, stored, next, NULL) == UHASH_ERR) {
+        uvec_pop(p_ustrpool_str, &pool->_strings);
+        return ULIB_ERR_MEM;
+    }
+
+    if (id) *id = next;
+    return ULIB_OK;
+}
+
+ulib_uint ustrpool_find(UStringPool const *pool, UString string) {
+    ulib_uint i = uhash_get(p_ustrpool, &pool->_ids, string);
+    if (i == UHASH_INDEX_MISSING) return ustrpool_count(pool);
+    return uhash_value(p_ustrpool, &pool->_ids, i);
+}
@@ -18,12 +18,246 @@
 #define ulib_free free
 
 #include "ulib.h"
+#include <time.h>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#endif
+
+#define P_UTEST_TIMEOUT (utime_ns)60000000000ULL
+#define P_UTEST_WATCH_INTERVAL (utime_ns)5000000ULL
+
+typedef enum P_UTestState {
+    P_UTEST_PENDING,
+    P_UTEST_RUNNING,
+    P_UTEST_PASSED,
+    P_UTEST_FAILED,
+    P_UTEST_TIMED_OUT,
+} P_UTestState;
+
+typedef struct P_UTestCase {
+    char const *name;
+    int name_length;
+    bool (*func)(void);
+    P_UTestState state;
+    utime_ns start;
+    utime_ns duration;
+} P_UTestCase;
+
+typedef struct P_UTestBatch {
+    P_UTestCase *cases;
+    unsigned count;
+    unsigned next;
+    unsigned done;
+    UMutex lock;
+} P_UTestBatch;
+
+static UTestConfig p_utest_config = {
+    .jobs = 1,
+    .timeout = P_UTEST_TIMEOUT,
+};
+
+UTestConfig *utest_config(void) {
+    return &p_utest_config;
+}
+
+static bool p_utest_parse_uint(char const *arg, unsigned long *value) {
+    char *end;
+    *value = strtoul(arg, &end, 10);
+    return *arg && !*end;
+}
+
+bool utest_start(int argc, char **argv) {
+    for (int i = 1; i < argc; ++i) {
+        char const *arg = argv[i];
+        bool const has_value = i + 1 < argc;
+        unsigned long value;
+
+        if (strcmp(arg, "-j") == 0 || strcmp(arg, "--jobs") == 0) {
+            if (!has_value || !p_utest_parse_uint(argv[++i], &value) || !value) {
+                fprintf(stderr, "Invalid number of jobs.\n");
+                return false;
+            }
+            p_utest_config.jobs = (unsigned)value;
+        } else if (strcmp(arg, "--timeout") == 0) {
+            if (!has_value || !p_utest_parse_uint(argv[++i], &value)) {
+                fprintf(stderr, "Invalid timeout.\n");
+                return false;
+            }
+            p_utest_config.timeout = (utime_ns)value * 1000000000ULL;
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", arg);
+            return false;
+        }
+    }
+
+    return utest_leak_start();
+}
+
+bool utest_end(void) {
+    return utest_leak_end();
+}
+
+static void p_utest_sleep(utime_ns ns) {
+#if defined(_WIN32)
+    Sleep((DWORD)(ns / 1000000));
+#else
+    struct timespec ts = { (time_t)(ns / 1000000000), (long)(ns % 1000000000) };
+    nanosleep(&ts, NULL);
+#endif
+}
+
+// Splits the stringified list of test functions into their names.
+static void p_utest_set_names(P_UTestCase *cases, unsigned count, char const *names) {
+    for (unsigned i = 0; i < count; ++i) {
+        while (*names == ' ' || *names == ',') ++names;
+        char const *end = names;
+        while (*end && *end != ',') ++end;
+
+        int length = (int)(end - names);
+        while (length && names[length - 1] == ' ') --length;
+
+        cases[i].name = length ? names : "?";
+        cases[i].name_length = length ? length : 1;
+        names = end;
+    }
+}
+
+static void p_utest_worker(void *ctx) {
+    P_UTestBatch *batch = ctx;
+    utime_ns const timeout = p_utest_config.timeout;
+
+    for (;;) {
+        umutex_lock(&batch->lock);
+
+        if (batch->next == batch->count) {
+            umutex_unlock(&batch->lock);
+            return;
+        }
+
+        P_UTestCase *test = batch->cases + batch->next++;
+        utime_ns const start = utime_get_ns();
+        test->start = start;
+        test->state = P_UTEST_RUNNING;
+        umutex_unlock(&batch->lock);
+
+        bool const passed = test->func();
+        utime_ns const duration = utime_get_ns() - start;
+
+        umutex_lock(&batch->lock);
+        test->duration = duration;
+        if (!passed) {
+            test->state = P_UTEST_FAILED;
+        } else if (timeout && duration > timeout) {
+            // Tests are not interrupted without threads, so the timeout is only checked here.
+            test->state = P_UTEST_TIMED_OUT;
+        } else {
+            test->state = P_UTEST_PASSED;
+        }
+        batch->done++;
+        umutex_unlock(&batch->lock);
+    }
+}
+
+// Waits for the batch to complete, aborting if a test exceeds the timeout.
+static void p_utest_watch(P_UTestBatch *batch, char const *name) {
+    utime_ns const timeout = p_utest_config.timeout;
+
+    for (;;) {
+        P_UTestCase const *expired = NULL;
+        utime_ns const now = utime_get_ns();
+
+        umutex_lock(&batch->lock);
+        bool const done = batch->done == batch->count;
+        for (unsigned i = 0; timeout && !expired && i < batch->count; ++i) {
+            P_UTestCase const *test = batch->cases + i;
+            if (test->state == P_UTEST_RUNNING && now - test->start > timeout) expired = test;
+        }
+        umutex_unlock(&batch->lock);
+
+        if (done) return;
+
+        if (expired) {
+            printf("Test \"%.*s\" of the \"%s\" batch timed out after %.3f s, aborting...\n",
+                   expired->name_length, expired->name, name,
+                   utime_interval_convert(now - expired->start, UTIME_SECONDS));
+            fflush(stdout);
+            _Exit(EXIT_FAILURE);
+        }
+
+        p_utest_sleep(P_UTEST_WATCH_INTERVAL);
+    }
+}
+
+static char const *p_utest_state_string(P_UTestState state) {
+    switch (state) {
+        case P_UTEST_PASSED: return "passed";
+        case P_UTEST_FAILED: return "failed";
+        case P_UTEST_TIMED_OUT: return "timed out";
+        default: return "not run";
+    }
+}
+
+bool p_utest_run(char const *name, char const *names, bool (**tests)(void), unsigned count,
+                 bool parallel) {
+    printf("Starting \"%s\" tests.\n", name);
+
+    P_UTestBatch batch = { .count = count };
+    batch.cases = calloc(count ? count : 1, sizeof(*batch.cases));
+
+    if (!batch.cases || umutex_init(&batch.lock)) {
+        free(batch.cases);
+        printf("Could not allocate the \"%s\" test batch.\n", name);
+        return false;
+    }
+
+    for (unsigned i = 0; i < count; ++i) batch.cases[i].func = tests[i];
+    p_utest_set_names(batch.cases, count, names);
+
+    // Tests run on worker threads, so that the calling thread can enforce the timeout.
+    unsigned jobs = parallel ? p_utest_config.jobs : 1;
+    if (jobs > count) jobs = count;
+    UThread *threads = jobs ? malloc(jobs * sizeof(*threads)) : NULL;
+    unsigned started = 0;
+
+    for (; threads && started < jobs; ++started) {
+        if (uthread_start(threads + started, p_utest_worker, &batch)) break;
+    }
+
+    if (jobs && !started) p_utest_worker(&batch);
+    p_utest_watch(&batch, name);
+
+    for (unsigned i = 0; i < started; ++i) uthread_join(threads + i);
+    free(threads);
+    umutex_deinit(&batch.lock);
+
+    bool passed = true;
+
+    for (unsigned i = 0; i < count; ++i) {
+        P_UTestCase const *test = batch.cases + i;
+        if (test->state != P_UTEST_PASSED) passed = false;
+        printf("  %.*s: %s (%.3f ms)\n", test->name_length, test->name,
+               p_utest_state_string(test->state),
+               utime_interval_convert(test->duration, UTIME_MILLISECONDS));
+    }
+
+    free(batch.cases);
+
+    if (passed) {
+        printf("All \"%s\" tests passed.\n", name);
+    } else {
+        printf("Some \"%s\" tests failed.\n", name);
+    }
+
+    return passed;
+}
 
 #ifdef ULIB_LEAKS
 
 typedef void *AllocPtr;
 UHASH_INIT(AllocTable, AllocPtr, char *, uhash_ptr_hash, uhash_identical)
 static UHash(AllocTable) *alloc_table = NULL;
+static URWLock alloc_lock = URWLOCK_INIT;
 
 #define alloc_table_add(PTR, FILE, FN, LINE)                                                       \
     do {                                                                                           \
@@ -32,7 +266,9 @@ static UHash(AllocTable) *alloc_table = NULL;
             size_t buf_size = (size_t)snprintf(NULL, 0, fmt, FILE, FN, LINE) + 1;                  \
             char *loc = malloc(buf_size);                                                          \
             if (loc) snprintf(loc, buf_size, fmt, FILE, FN, LINE);                                 \
+            urwlock_write_lock(&alloc_lock);                                                       \
             uhmap_set(AllocTable, alloc_table, PTR, loc, NULL);                                    \
+            urwlock_write_unlock(&alloc_lock);                                                     \
         }                                                                                          \
     } while (0)
 
@@ -40,7 +276,10 @@ static UHash(AllocTable) *alloc_table = NULL;
     do {                                                                                           \
         if (alloc_table) {                                                                         \
             char *buf;                                                                             \
-            if (uhmap_pop(AllocTable, alloc_table, PTR, NULL, &buf)) free(buf);                    \
+            urwlock_write_lock(&alloc_lock);                                                       \
+            bool removed = uhmap_pop(AllocTable, alloc_table, PTR, NULL, &buf);                    \
+            urwlock_write_unlock(&alloc_lock);                                                     \
+            if (removed) free(buf);                                                                \
         }                                                                                          \
     } while (0)
 
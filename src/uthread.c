@@ -0,0 +1,300 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "uthread.h"
+
+// Thread contexts are released by the started thread, which does not share
+// the allocation scope of the caller.
+#if defined(ULIB_ALLOC_SCOPES)
+#define p_uthread_ctx_malloc P_UARENA_HEAP_MALLOC
+#define p_uthread_ctx_free P_UARENA_HEAP_FREE
+#else
+#define p_uthread_ctx_malloc ulib_malloc
+#define p_uthread_ctx_free ulib_free
+#endif
+
+#if defined(P_ULIB_THREADS_WIN32)
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#define p_srw(lock) ((PSRWLOCK)(&(lock)->_lock))
+
+ulib_ret urwlock_init(URWLock *lock) {
+    InitializeSRWLock(p_srw(lock));
+    return ULIB_OK;
+}
+
+void urwlock_deinit(ulib_unused URWLock *lock) {}
+
+void urwlock_read_lock(URWLock *lock) {
+    AcquireSRWLockShared(p_srw(lock));
+}
+
+void urwlock_read_unlock(URWLock *lock) {
+    ReleaseSRWLockShared(p_srw(lock));
+}
+
+void urwlock_write_lock(URWLock *lock) {
+    AcquireSRWLockExclusive(p_srw(lock));
+}
+
+void urwlock_write_unlock(URWLock *lock) {
+    ReleaseSRWLockExclusive(p_srw(lock));
+}
+
+#define p_mtx(mutex) ((PSRWLOCK)(&(mutex)->_lock))
+#define p_cv(cond) ((PCONDITION_VARIABLE)(&(cond)->_cond))
+
+ulib_ret umutex_init(UMutex *mutex) {
+    InitializeSRWLock(p_mtx(mutex));
+    return ULIB_OK;
+}
+
+void umutex_deinit(ulib_unused UMutex *mutex) {}
+
+void umutex_lock(UMutex *mutex) {
+    AcquireSRWLockExclusive(p_mtx(mutex));
+}
+
+void umutex_unlock(UMutex *mutex) {
+    ReleaseSRWLockExclusive(p_mtx(mutex));
+}
+
+ulib_ret ucond_init(UCond *cond) {
+    InitializeConditionVariable(p_cv(cond));
+    return ULIB_OK;
+}
+
+void ucond_deinit(ulib_unused UCond *cond) {}
+
+void ucond_wait(UCond *cond, UMutex *mutex) {
+    SleepConditionVariableSRW(p_cv(cond), p_mtx(mutex), INFINITE, 0);
+}
+
+void ucond_signal(UCond *cond) {
+    WakeConditionVariable(p_cv(cond));
+}
+
+void ucond_broadcast(UCond *cond) {
+    WakeAllConditionVariable(p_cv(cond));
+}
+
+typedef struct p_uthread_ctx {
+    void (*func)(void *);
+    void *ctx;
+} p_uthread_ctx;
+
+static DWORD WINAPI p_uthread_main(LPVOID arg) {
+    p_uthread_ctx ctx = *(p_uthread_ctx *)arg;
+    p_uthread_ctx_free(arg);
+    ctx.func(ctx.ctx);
+    return 0;
+}
+
+ulib_ret uthread_start(UThread *thread, void (*func)(void *ctx), void *ctx) {
+    p_uthread_ctx *arg = p_uthread_ctx_malloc(sizeof(*arg));
+    if (!arg) return ULIB_ERR_MEM;
+    arg->func = func;
+    arg->ctx = ctx;
+
+    HANDLE handle = CreateThread(NULL, 0, p_uthread_main, arg, 0, NULL);
+    if (!handle) {
+        p_uthread_ctx_free(arg);
+        return ULIB_ERR;
+    }
+
+    thread->_thread = handle;
+    return ULIB_OK;
+}
+
+ulib_ret uthread_join(UThread *thread) {
+    HANDLE handle = (HANDLE)thread->_thread;
+    ulib_ret ret = WaitForSingleObject(handle, INFINITE) == WAIT_OBJECT_0 ? ULIB_OK : ULIB_ERR;
+    CloseHandle(handle);
+    return ret;
+}
+
+#elif defined(P_ULIB_THREADS_PTHREAD)
+
+#include <pthread.h>
+
+#define p_uthread_fits(T, S) (sizeof(T) <= sizeof(S) && _Alignof(T) <= _Alignof(S))
+_Static_assert(p_uthread_fits(pthread_rwlock_t, URWLock), "URWLock is too small");
+_Static_assert(p_uthread_fits(pthread_mutex_t, UMutex), "UMutex is too small");
+_Static_assert(p_uthread_fits(pthread_cond_t, UCond), "UCond is too small");
+_Static_assert(sizeof(pthread_t) <= sizeof(void *), "UThread is too small");
+
+// URWLOCK_INIT only sets the signature word, which must match PTHREAD_RWLOCK_INITIALIZER.
+#if defined(_PTHREAD_RWLOCK_SIG_init)
+_Static_assert(_PTHREAD_RWLOCK_SIG_init == P_URWLOCK_SIG_INIT, "Invalid URWLOCK_INIT");
+#endif
+
+#define p_rwlock(lock) ((pthread_rwlock_t *)(void *)&(lock)->_lock)
+#define p_mutex(mutex) ((pthread_mutex_t *)(void *)&(mutex)->_lock)
+#define p_cond(cond) ((pthread_cond_t *)(void *)&(cond)->_cond)
+
+ulib_ret urwlock_init(URWLock *lock) {
+    return pthread_rwlock_init(p_rwlock(lock), NULL) ? ULIB_ERR : ULIB_OK;
+}
+
+void urwlock_deinit(URWLock *lock) {
+    pthread_rwlock_destroy(p_rwlock(lock));
+}
+
+void urwlock_read_lock(URWLock *lock) {
+    pthread_rwlock_rdlock(p_rwlock(lock));
+}
+
+void urwlock_read_unlock(URWLock *lock) {
+    pthread_rwlock_unlock(p_rwlock(lock));
+}
+
+void urwlock_write_lock(URWLock *lock) {
+    pthread_rwlock_wrlock(p_rwlock(lock));
+}
+
+void urwlock_write_unlock(URWLock *lock) {
+    pthread_rwlock_unlock(p_rwlock(lock));
+}
+
+ulib_ret umutex_init(UMutex *mutex) {
+    return pthread_mutex_init(p_mutex(mutex), NULL) ? ULIB_ERR : ULIB_OK;
+}
+
+void umutex_deinit(UMutex *mutex) {
+    pthread_mutex_destroy(p_mutex(mutex));
+}
+
+void umutex_lock(UMutex *mutex) {
+    pthread_mutex_lock(p_mutex(mutex));
+}
+
+void umutex_unlock(UMutex *mutex) {
+    pthread_mutex_unlock(p_mutex(mutex));
+}
+
+ulib_ret ucond_init(UCond *cond) {
+    return pthread_cond_init(p_cond(cond), NULL) ? ULIB_ERR : ULIB_OK;
+}
+
+void ucond_deinit(UCond *cond) {
+    pthread_cond_destroy(p_cond(cond));
+}
+
+void ucond_wait(UCond *cond, UMutex *mutex) {
+    pthread_cond_wait(p_cond(cond), p_mutex(mutex));
+}
+
+void ucond_signal(UCond *cond) {
+    pthread_cond_signal(p_cond(cond));
+}
+
+void ucond_broadcast(UCond *cond) {
+    pthread_cond_broadcast(p_cond(cond));
+}
+
+typedef struct p_uthread_ctx {
+    void (*func)(void *);
+    void *ctx;
+} p_uthread_ctx;
+
+static void *p_uthread_main(void *arg) {
+    p_uthread_ctx ctx = *(p_uthread_ctx *)arg;
+    p_uthread_ctx_free(arg);
+    ctx.func(ctx.ctx);
+    return NULL;
+}
+
+ulib_ret uthread_start(UThread *thread, void (*func)(void *ctx), void *ctx) {
+    p_uthread_ctx *arg = p_uthread_ctx_malloc(sizeof(*arg));
+    if (!arg) return ULIB_ERR_MEM;
+    arg->func = func;
+    arg->ctx = ctx;
+
+    pthread_t handle;
+
+    if (pthread_create(&handle, NULL, p_uthread_main, arg)) {
+        p_uthread_ctx_free(arg);
+        return ULIB_ERR;
+    }
+
+    // pthread_t is copied, as it may not be a pointer type.
+    memcpy(&thread->_thread, &handle, sizeof(handle));
+    return ULIB_OK;
+}
+
+ulib_ret uthread_join(UThread *thread) {
+    pthread_t handle;
+    memcpy(&handle, &thread->_thread, sizeof(handle));
+    return pthread_join(handle, NULL) ? ULIB_ERR : ULIB_OK;
+}
+
+#else
+
+ulib_ret urwlock_init(URWLock *lock) {
+    lock->_lock = 0;
+    return ULIB_OK;
+}
+
+void urwlock_deinit(ulib_unused URWLock *lock) {}
+void urwlock_read_lock(ulib_unused URWLock *lock) {}
+void urwlock_read_unlock(ulib_unused URWLock *lock) {}
+void urwlock_write_lock(ulib_unused URWLock *lock) {}
+void urwlock_write_unlock(ulib_unused URWLock *lock) {}
+
+ulib_ret umutex_init(UMutex *mutex) {
+    mutex->_lock = 0;
+    return ULIB_OK;
+}
+
+void umutex_deinit(ulib_unused UMutex *mutex) {}
+void umutex_lock(ulib_unused UMutex *mutex) {}
+void umutex_unlock(ulib_unused UMutex *mutex) {}
+
+ulib_ret ucond_init(UCond *cond) {
+    cond->_cond = 0;
+    return ULIB_OK;
+}
+
+void ucond_deinit(ulib_unused UCond *cond) {}
+void ucond_wait(ulib_unused UCond *cond, ulib_unused UMutex *mutex) {}
+void ucond_signal(ulib_unused UCond *cond) {}
+void ucond_broadcast(ulib_unused UCond *cond) {}
+
+ulib_ret uthread_start(UThread *thread, void (*func)(void *ctx), void *ctx) {
+    thread->_thread = NULL;
+    func(ctx);
+    return ULIB_OK;
+}
+
+ulib_ret uthread_join(ulib_unused UThread *thread) {
+    return ULIB_OK;
+}
+
+#endif
+
+void uthread_run_parallel(void (*func)(void *ctx), void *ctx, size_t size, unsigned count) {
+    if (!count) return;
+
+    char *data = ctx;
+    UThread *threads = count > 1 ? ulib_malloc((count - 1) * sizeof(*threads)) : NULL;
+    unsigned started = 0;
+
+    if (threads) {
+        for (; started < count - 1; ++started) {
+            if (uthread_start(threads + started, func, data + (started + 1) * size)) break;
+        }
+    }
+
+    func(data);
+    for (unsigned i = started + 1; i < count; ++i) func(data + i * size);
+    for (unsigned i = 0; i < started; ++i) uthread_join(threads + i);
+    ulib_free(threads);
+}
@@ -150,49 +150,171 @@ long long utime_diff(UTime const *a, UTime const *b, utime_unit unit) {
     }
 }
 
+static char const p_utime_digit_pairs[] = "00010203040506070809"
+                                          "10111213141516171819"
+                                          "20212223242526272829"
+                                          "30313233343536373839"
+                                          "40414243444546474849"
+                                          "50515253545556575859"
+                                          "60616263646566676869"
+                                          "70717273747576777879"
+                                          "80818283848586878889"
+                                          "90919293949596979899";
+
+static inline char *p_utime_put2(char *dst, unsigned value) {
+    memcpy(dst, p_utime_digit_pairs + value * 2, 2);
+    return dst + 2;
+}
+
+// Writes the specified number of digits, zero-padded. The number of digits must be even.
+static inline char *p_utime_put_even(char *dst, unsigned long long value, unsigned digits) {
+    for (unsigned i = digits; i; i -= 2, value /= 100) {
+        p_utime_put2(dst + i - 2, (unsigned)(value % 100));
+    }
+    return dst + digits;
+}
+
+ulib_uint utime_format(UTime const *time, char *buf) {
+    char *cur = buf;
+    long long const year = time->year;
+
+    if (year >= 1000 && year <= 9999) {
+        cur = p_utime_put_even(cur, (unsigned long long)year, 4);
+    } else {
+        unsigned long long y = (unsigned long long)year;
+        if (year < 0) {
+            *cur++ = '-';
+            y = 0ULL - y;
+        }
+        char digits[20];
+        unsigned count = 0;
+        do {
+            digits[count++] = (char)('0' + y % 10);
+            y /= 10;
+        } while (y);
+        while (count) *cur++ = digits[--count];
+    }
+
+    cur[0] = '/';
+    p_utime_put2(cur + 1, time->month);
+    cur[3] = '/';
+    p_utime_put2(cur + 4, time->day);
+    cur[6] = '-';
+    p_utime_put2(cur + 7, time->hour);
+    cur[9] = ':';
+    p_utime_put2(cur + 10, time->minute);
+    cur[12] = ':';
+    p_utime_put2(cur + 13, time->second);
+
+    return (ulib_uint)(cur + 15 - buf);
+}
+
 UString utime_to_string(UTime const *time) {
-    UOStream stream;
-    UStrBuf buf = ustrbuf();
+    char buf[UTIME_FORMAT_SIZE];
+    return ustring_copy(buf, utime_format(time, buf));
+}
 
-    if (uostream_to_strbuf(&stream, &buf) || uostream_write_time(&stream, time, NULL)) {
-        ustrbuf_deinit(&buf);
-        return ustring_null;
+// Returns the value of the digit, or a value greater than 9 if the character is not a digit.
+static inline unsigned p_utime_digit(char c) {
+    return (unsigned)(unsigned char)c - '0';
+}
+
+// Parses two digits, returning a value greater than 99 on error.
+static inline unsigned p_utime_parse2(char const *str) {
+    unsigned const hi = p_utime_digit(str[0]), lo = p_utime_digit(str[1]);
+    return (hi > 9) | (lo > 9) ? 100 : hi * 10 + lo;
+}
+
+ulib_uint utime_parse(UTime *time, unsigned *nanos, char const *str, ulib_uint length) {
+    // YYYY_MM_DD_hh_mm_ss
+    if (length < 19) return 0;
+
+    unsigned const y_hi = p_utime_parse2(str), y_lo = p_utime_parse2(str + 2);
+    unsigned const m = p_utime_parse2(str + 5), d = p_utime_parse2(str + 8);
+    unsigned const h = p_utime_parse2(str + 11), min = p_utime_parse2(str + 14);
+    unsigned const sec = p_utime_parse2(str + 17);
+    unsigned const seps = p_utime_digit(str[4]) <= 9 || p_utime_digit(str[7]) <= 9 ||
+                          p_utime_digit(str[10]) <= 9 || p_utime_digit(str[13]) <= 9 ||
+                          p_utime_digit(str[16]) <= 9;
+
+    if (seps || y_hi > 99 || y_lo > 99 || h >= HOURS_PER_DAY || min >= MINUTES_PER_HOUR ||
+        sec >= SECONDS_PER_MINUTE || m - 1 >= MONTHS_PER_YEAR) {
+        return 0;
     }
 
-    return ustrbuf_to_ustring(&buf);
+    long long const y = y_hi * 100 + y_lo;
+    if (d - 1 >= utime_days_in_month(y, m)) return 0;
+
+    time->year = y;
+    time->month = m;
+    time->day = d;
+    time->hour = h;
+    time->minute = min;
+    time->second = sec;
+
+    ulib_uint i = 19;
+
+    // Fractional seconds
+    unsigned ns = 0;
+
+    if (i + 1 < length && (str[i] == '.' || str[i] == ',') && p_utime_digit(str[i + 1]) <= 9) {
+        unsigned scale = NANOS_PER_SECOND;
+        for (++i; i < length && p_utime_digit(str[i]) <= 9; ++i) {
+            if (scale > 1) ns += p_utime_digit(str[i]) * (scale /= 10);
+        }
+    }
+
+    if (nanos) *nanos = ns;
+
+    // Timezone
+    if (i < length) {
+        if (str[i] == 'Z' || str[i] == 'z') return i + 1;
+        if ((str[i] != '+' && str[i] != '-') || i + 6 > length) return i;
+
+        unsigned const tzh = p_utime_parse2(str + i + 1), tzm = p_utime_parse2(str + i + 4);
+        if (tzh > 14 || tzm >= MINUTES_PER_HOUR || p_utime_digit(str[i + 3]) <= 9) return i;
+
+        utime_normalize_to_utc(time, str[i] == '-' ? -(int)tzh : (int)tzh, tzm);
+        i += 6;
+    }
+
+    return i;
 }
 
 bool utime_from_string(UTime *time, UString const *string) {
+    ulib_uint const length = ustring_length(*string);
+    if (utime_parse(time, NULL, ustring_data(*string), length) == length) return true;
+
     char *ptr = (char *)ustring_data(*string), *newptr;
     char const *endptr = ptr + ustring_length(*string);
 
     // Parse year
-    long long y = strtoll(ptr, &newptr, 0);
+    long long y = strtoll(ptr, &newptr, 10);
     if (newptr == endptr || newptr == ptr) return false;
 
     // Parse month
     ptr = newptr + 1;
-    unsigned long m = strtoul(ptr, &newptr, 0);
+    unsigned long m = strtoul(ptr, &newptr, 10);
     if (newptr == endptr || newptr == ptr || m > MONTHS_PER_YEAR) return false;
 
     // Parse day
     ptr = newptr + 1;
-    unsigned long d = strtoul(ptr, &newptr, 0);
+    unsigned long d = strtoul(ptr, &newptr, 10);
     if (newptr == endptr || newptr == ptr || d > utime_days_in_month(y, m)) return false;
 
     // Parse hour
     ptr = newptr + 1;
-    unsigned long h = strtoul(ptr, &newptr, 0);
+    unsigned long h = strtoul(ptr, &newptr, 10);
     if (newptr == endptr || newptr == ptr || h >= HOURS_PER_DAY) return false;
 
     // Parse minute
     ptr = newptr + 1;
-    unsigned long min = strtoul(ptr, &newptr, 0);
+    unsigned long min = strtoul(ptr, &newptr, 10);
     if (newptr == endptr || newptr == ptr || min >= MINUTES_PER_HOUR) return false;
 
     // Parse second
     ptr = newptr + 1;
-    unsigned long s = strtoul(ptr, &newptr, 0);
+    unsigned long s = strtoul(ptr, &newptr, 10);
     if (newptr == ptr || s >= SECONDS_PER_MINUTE) return false;
 
     time->year = y;
@@ -208,11 +330,11 @@ bool utime_from_string(UTime *time, UString const *string) {
         // Parse timezone
         if (ptr == endptr - 1) return *ptr == 'Z' || *ptr == 'z';
 
-        long tzh = strtol(ptr, &newptr, 0);
+        long tzh = strtol(ptr, &newptr, 10);
         if (newptr == endptr || newptr == ptr || ulib_abs(tzh) > 14) return false;
 
         ptr = newptr + 1;
-        min = strtoul(ptr, &newptr, 0);
+        min = strtoul(ptr, &newptr, 10);
         if (newptr != endptr || newptr == ptr || min >= MINUTES_PER_HOUR) return false;
 
         utime_normalize_to_utc(time, (int)tzh, min);
@@ -255,6 +377,85 @@ utime_stamp utime_get_timestamp(void) {
     return (utime_stamp)time(NULL);
 }
 
+static void p_utime_get_realtime(utime_stamp *seconds, unsigned *nanos);
+
+utime_stamp utime_get_timestamp_ms(void) {
+    utime_stamp s;
+    unsigned ns;
+    p_utime_get_realtime(&s, &ns);
+    return s * MILLIS_PER_SECOND + ns / (NANOS_PER_SECOND / MILLIS_PER_SECOND);
+}
+
+utime_stamp utime_get_timestamp_us(void) {
+    utime_stamp s;
+    unsigned ns;
+    p_utime_get_realtime(&s, &ns);
+    return s * MICROS_PER_SECOND + ns / (NANOS_PER_SECOND / MICROS_PER_SECOND);
+}
+
+static inline unsigned p_utime_unit_digits(utime_unit unit) {
+    switch (unit) {
+        case UTIME_MILLISECONDS: return 3;
+        case UTIME_MICROSECONDS: return 6;
+        case UTIME_NANOSECONDS: return 9;
+        default: return 0;
+    }
+}
+
+static char const *p_utime_cache_format(UTimeCache *cache, utime_stamp seconds,
+                                        unsigned long long frac, unsigned digits,
+                                        ulib_uint *length) {
+    // Seconds within the minute, floored for timestamps before 1970.
+    long long sec = seconds % SECONDS_PER_MINUTE;
+    if (sec < 0) sec += SECONDS_PER_MINUTE;
+    utime_stamp const minute = seconds - sec;
+
+    if (!cache->_length || cache->_minute != minute) {
+        UTime const time = utime_from_timestamp(minute);
+        cache->_length = utime_format(&time, cache->_buf) - 2;
+        cache->_minute = minute;
+    }
+
+    char *cur = p_utime_put2(cache->_buf + cache->_length, (unsigned)sec);
+
+    if (digits) {
+        *cur++ = '.';
+        // Odd digit counts are formatted as pairs, dropping the last digit.
+        cur = p_utime_put_even(cur, digits & 1U ? frac * 10 : frac, (digits + 1) & ~1U);
+        cur -= digits & 1U;
+    }
+
+    *cur = '\0';
+    if (length) *length = (ulib_uint)(cur - cache->_buf);
+    return cache->_buf;
+}
+
+char const *utime_cache_format(UTimeCache *cache, utime_stamp ts, utime_unit unit,
+                               ulib_uint *length) {
+    unsigned const digits = p_utime_unit_digits(unit);
+    utime_stamp per_second = 1;
+    for (unsigned i = 0; i < digits; ++i) per_second *= 10;
+
+    utime_stamp seconds = ts / per_second, frac = ts % per_second;
+    if (frac < 0) {
+        frac += per_second;
+        seconds--;
+    }
+
+    return p_utime_cache_format(cache, seconds, (unsigned long long)frac, digits, length);
+}
+
+char const *utime_cache_now(UTimeCache *cache, utime_unit unit, ulib_uint *length) {
+    unsigned const digits = p_utime_unit_digits(unit);
+    unsigned divisor = 1;
+    for (unsigned i = digits; i < 9; ++i) divisor *= 10;
+
+    utime_stamp s;
+    unsigned ns;
+    p_utime_get_realtime(&s, &ns);
+    return p_utime_cache_format(cache, s, ns / divisor, digits, length);
+}
+
 // clang-format off
 
 #if defined(_WIN32)
@@ -276,11 +477,26 @@ utime_stamp utime_get_timestamp(void) {
 
         return (utime_ns)temp.QuadPart * NS_PER_S / clocks_per_sec;
     }
+
+    static void p_utime_get_realtime(utime_stamp *seconds, unsigned *nanos) {
+        // FILETIME counts 100 ns intervals since January 1 1601.
+        FILETIME ft;
+        GetSystemTimeAsFileTime(&ft);
+        unsigned long long t = ((unsigned long long)ft.dwHighDateTime << 32U) | ft.dwLowDateTime;
+        t -= 116444736000000000ULL;
+        *seconds = (utime_stamp)(t / 10000000ULL);
+        *nanos = (unsigned)(t % 10000000ULL) * 100;
+    }
 #elif defined(ARDUINO)
     #include <Arduino.h>
     utime_ns utime_get_ns(void) {
         return (utime_ns)micros() * 1000;
     }
+
+    static void p_utime_get_realtime(utime_stamp *seconds, unsigned *nanos) {
+        *seconds = utime_get_timestamp();
+        *nanos = 0;
+    }
 #else
     #if defined(CLOCK_MONOTONIC)
         typedef struct timespec utimespec;
@@ -302,4 +518,20 @@ utime_stamp utime_get_timestamp(void) {
         utime_get_timespec(&ts);
         return (utime_ns)ts.tv_sec * NS_PER_S + (utime_ns)ts.tv_nsec;
     }
+
+    static void p_utime_get_realtime(utime_stamp *seconds, unsigned *nanos) {
+    #if defined(CLOCK_REALTIME) || defined(TIME_UTC)
+        struct timespec ts;
+        #if defined(CLOCK_REALTIME)
+            clock_gettime(CLOCK_REALTIME, &ts);
+        #else
+            timespec_get(&ts, TIME_UTC);
+        #endif
+        *seconds = (utime_stamp)ts.tv_sec;
+        *nanos = (unsigned)ts.tv_nsec;
+    #else
+        *seconds = utime_get_timestamp();
+        *nanos = 0;
+    #endif
+    }
 #endif
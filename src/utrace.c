@@ -0,0 +1,248 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "utrace.h"
+#include "uthread.h"
+#include "ujson.h"
+
+#define P_UTRACE_CALIBRATION_TIME 5000000ULL
+
+// Buffers are never released, so they bypass the leak detector and allocation scopes.
+#if defined(P_UTRACE_HEAP_MALLOC)
+#define p_utrace_heap_malloc P_UTRACE_HEAP_MALLOC
+#else
+#define p_utrace_heap_malloc ulib_malloc
+#endif
+
+#if UTRACE_BUFFER_SIZE & (UTRACE_BUFFER_SIZE - 1)
+#error "UTRACE_BUFFER_SIZE must be a power of two"
+#endif
+
+// Events are shared with exporting threads without blocking the recording ones.
+#if defined(ULIB_NO_THREADS)
+#define p_utrace_load(p) (*(p))
+#define p_utrace_load_acquire(p) (*(p))
+#define p_utrace_store(p, v) (*(p) = (v))
+#define p_utrace_store_release(p, v) (*(p) = (v))
+#define p_utrace_fence_acquire() ((void)0)
+#define p_utrace_fence_release() ((void)0)
+#elif defined(__GNUC__)
+#define p_utrace_load(p) __atomic_load_n(p, __ATOMIC_RELAXED)
+#define p_utrace_load_acquire(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define p_utrace_store(p, v) __atomic_store_n(p, v, __ATOMIC_RELAXED)
+#define p_utrace_store_release(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#define p_utrace_fence_acquire() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define p_utrace_fence_release() __atomic_thread_fence(__ATOMIC_RELEASE)
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+// Aligned accesses are atomic and ordered on x86, so only the compiler must not reorder them.
+#include <intrin.h>
+#define p_utrace_load(p) (*(p))
+#define p_utrace_load_acquire(p) (_ReadWriteBarrier(), *(p))
+#define p_utrace_store(p, v) (*(p) = (v))
+#define p_utrace_store_release(p, v) (_ReadWriteBarrier(), *(p) = (v))
+#define p_utrace_fence_acquire() _ReadWriteBarrier()
+#define p_utrace_fence_release() _ReadWriteBarrier()
+#else
+#error "Tracing requires atomic operations, define ULIB_NO_THREADS to disable them."
+#endif
+
+typedef struct P_UTraceEvent {
+    char const *name;
+    utrace_tick start;
+    utrace_tick end;
+} P_UTraceEvent;
+
+typedef struct P_UTraceBuffer {
+    struct P_UTraceBuffer *next;
+    unsigned tid;
+    // Number of recorded events, only written by the owning thread.
+    uint64_t count;
+    // Number of recorded events at the last reset, guarded by the lock.
+    uint64_t reset;
+    P_UTraceEvent events[UTRACE_BUFFER_SIZE];
+} P_UTraceBuffer;
+
+// Buffers outlive their threads, so that events can be exported once threads have exited,
+// and are never released, so that threads can keep recording across resets.
+static P_UTraceBuffer *p_utrace_buffers = NULL;
+static unsigned p_utrace_threads = 0;
+static bool volatile p_utrace_on = true;
+static double p_utrace_ns_per_tick_val = 0.0;
+static URWLock p_utrace_lock = URWLOCK_INIT;
+
+static p_ulib_thread_local P_UTraceBuffer *p_utrace_buffer = NULL;
+
+void utrace_calibrate(void) {
+#if defined(P_UTRACE_TICKS_RDTSC) || defined(P_UTRACE_TICKS_CNTVCT)
+    utime_ns const start_ns = utime_get_ns();
+    utrace_tick const start = utrace_ticks();
+    utime_ns elapsed;
+    utrace_tick ticks;
+
+    do {
+        elapsed = utime_get_ns() - start_ns;
+        ticks = utrace_ticks() - start;
+    } while (elapsed < P_UTRACE_CALIBRATION_TIME);
+
+    double const ns_per_tick = ticks ? (double)elapsed / (double)ticks : 1.0;
+#else
+    double const ns_per_tick = 1.0;
+#endif
+
+    urwlock_write_lock(&p_utrace_lock);
+    p_utrace_ns_per_tick_val = ns_per_tick;
+    urwlock_write_unlock(&p_utrace_lock);
+}
+
+double utrace_ns_per_tick(void) {
+    urwlock_read_lock(&p_utrace_lock);
+    double ns_per_tick = p_utrace_ns_per_tick_val;
+    urwlock_read_unlock(&p_utrace_lock);
+
+    if (!ns_per_tick) {
+        utrace_calibrate();
+        ns_per_tick = utrace_ns_per_tick();
+    }
+
+    return ns_per_tick;
+}
+
+utime_ns utrace_ticks_to_ns(utrace_tick ticks) {
+    return (utime_ns)((double)ticks * utrace_ns_per_tick() + 0.5);
+}
+
+void utrace_set_enabled(bool enabled) {
+    p_utrace_on = enabled;
+}
+
+bool utrace_enabled(void) {
+    return p_utrace_on;
+}
+
+static P_UTraceBuffer *p_utrace_register(void) {
+    P_UTraceBuffer *buffer = p_utrace_heap_malloc(sizeof(*buffer));
+    if (!buffer) return NULL;
+    buffer->count = buffer->reset = 0;
+
+    urwlock_write_lock(&p_utrace_lock);
+    buffer->tid = ++p_utrace_threads;
+    buffer->next = p_utrace_buffers;
+    p_utrace_buffers = buffer;
+    urwlock_write_unlock(&p_utrace_lock);
+
+    p_utrace_buffer = buffer;
+    return buffer;
+}
+
+void utrace_record(char const *name, utrace_tick start, utrace_tick end) {
+    if (!p_utrace_on) return;
+
+    P_UTraceBuffer *buffer = p_utrace_buffer;
+
+    if (!buffer && !(buffer = p_utrace_register())) return;
+
+    uint64_t const count = buffer->count;
+    P_UTraceEvent *event = buffer->events + (count & (UTRACE_BUFFER_SIZE - 1));
+
+    // Pairs with the acquire fence in p_utrace_event, which detects overwritten events.
+    p_utrace_fence_release();
+    p_utrace_store(&event->name, name);
+    p_utrace_store(&event->start, start);
+    p_utrace_store(&event->end, end);
+    p_utrace_store_release(&buffer->count, count + 1);
+}
+
+// Returns the index of the oldest retained event of the buffer, given the number of events.
+static inline uint64_t p_utrace_first(P_UTraceBuffer const *buffer, uint64_t count) {
+    uint64_t const retained = count - buffer->reset;
+    return retained < UTRACE_BUFFER_SIZE ? buffer->reset : count - UTRACE_BUFFER_SIZE;
+}
+
+// Reads the i-th event of the buffer, returns false if it is being overwritten.
+static bool p_utrace_event(P_UTraceBuffer const *buffer, uint64_t i, P_UTraceEvent *event) {
+    P_UTraceEvent const *e = buffer->events + (i & (UTRACE_BUFFER_SIZE - 1));
+    event->name = p_utrace_load(&e->name);
+    event->start = p_utrace_load(&e->start);
+    event->end = p_utrace_load(&e->end);
+
+    // Event i + UTRACE_BUFFER_SIZE reuses the slot once the count has reached its index.
+    p_utrace_fence_acquire();
+    return p_utrace_load(&buffer->count) - i < UTRACE_BUFFER_SIZE;
+}
+
+ulib_uint utrace_count(void) {
+    ulib_uint count = 0;
+    urwlock_read_lock(&p_utrace_lock);
+
+    for (P_UTraceBuffer *b = p_utrace_buffers; b; b = b->next) {
+        uint64_t const end = p_utrace_load_acquire(&b->count);
+        count += (ulib_uint)(end - p_utrace_first(b, end));
+    }
+
+    urwlock_read_unlock(&p_utrace_lock);
+    return count;
+}
+
+ustream_ret utrace_export_chrome(UOStream *stream, size_t *written) {
+    size_t const start = stream->written_bytes;
+    double const us_per_tick = utrace_ns_per_tick() / 1000.0;
+    bool first = true;
+
+    urwlock_read_lock(&p_utrace_lock);
+
+    // Timestamps are relative to the earliest retained event.
+    utrace_tick origin = UINT64_MAX;
+
+    for (P_UTraceBuffer *b = p_utrace_buffers; b; b = b->next) {
+        uint64_t const end = p_utrace_load_acquire(&b->count);
+        P_UTraceEvent e;
+
+        for (uint64_t i = p_utrace_first(b, end); i < end; ++i) {
+            if (p_utrace_event(b, i, &e) && e.start < origin) origin = e.start;
+        }
+    }
+
+    uostream_write_literal(stream, "{\"traceEvents\":[", NULL);
+
+    for (P_UTraceBuffer *b = p_utrace_buffers; b; b = b->next) {
+        // Events recorded from now on are not exported, so that exporting always terminates.
+        uint64_t const end = p_utrace_load_acquire(&b->count);
+
+        // Events are written from the oldest to the most recent.
+        for (uint64_t i = p_utrace_first(b, end); i < end; ++i) {
+            P_UTraceEvent e;
+            if (!p_utrace_event(b, i, &e)) continue;
+
+            utrace_tick const dur = e.end > e.start ? e.end - e.start : 0;
+            utrace_tick const ts = e.start > origin ? e.start - origin : 0;
+
+            if (!first) uostream_write_literal(stream, ",", NULL);
+            uostream_write_literal(stream, "\n{\"name\":\"", NULL);
+            p_ujson_write_escaped(stream, e.name);
+            uostream_writef(stream, NULL,
+                            "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                            b->tid, (double)ts * us_per_tick, (double)dur * us_per_tick);
+            first = false;
+        }
+    }
+
+    uostream_write_literal(stream, "\n],\"displayTimeUnit\":\"ns\"}\n", NULL);
+    urwlock_read_unlock(&p_utrace_lock);
+
+    if (written) *written = stream->written_bytes - start;
+    return stream->state;
+}
+
+void utrace_reset(void) {
+    urwlock_write_lock(&p_utrace_lock);
+    for (P_UTraceBuffer *b = p_utrace_buffers; b; b = b->next) {
+        b->reset = p_utrace_load_acquire(&b->count);
+    }
+    urwlock_write_unlock(&p_utrace_lock);
+}
@@ -8,11 +8,313 @@
  */
 
 #include "uvec_builtin.h"
+#include "usimd.h"
 
-UVEC_IMPL_IDENTIFIABLE(char)
-UVEC_IMPL_IDENTIFIABLE(ulib_byte)
-UVEC_IMPL_IDENTIFIABLE(ulib_int)
-UVEC_IMPL_IDENTIFIABLE(ulib_uint)
-UVEC_IMPL_IDENTIFIABLE(ulib_float)
+#if defined(P_USIMD)
+
+/*
+ * Generates vectorized linear search functions for the specified identifiable vector type.
+ *
+ * @param T [symbol] Vector type.
+ * @param K [symbol] SIMD primitive kind (8, 16, 32, 64, f32 or f64).
+ */
+#define P_UVEC_IMPL_SEARCH_SIMD(T, K)                                                              \
+                                                                                                   \
+    ulib_uint uvec_index_of_##T(UVec_##T const *vec, T item) {                                     \
+        T const *data = uvec_data(T, vec);                                                         \
+        ulib_uint const n = vec->_count, lanes = sizeof(p_usimd) / sizeof(T);                      \
+        p_usimd const needle = P_ULIB_MACRO_CONCAT(p_usimd_splat_, K)(item);                       \
+        ulib_uint i = 0;                                                                           \
+                                                                                                   \
+        for (; n - i >= lanes; i += lanes) {                                                       \
+            p_usimd const block = p_usimd_load(data + i);                                          \
+            uint64_t mask = p_usimd_mask(P_ULIB_MACRO_CONCAT(p_usimd_eq_, K)(block,                \
+                                                                                     needle));     \
+            if (mask) return i + (ulib_uint)(p_usimd_first(mask) / sizeof(T));                     \
+        }                                                                                          \
+                                                                                                   \
+        for (; i < n; ++i) {                                                                       \
+            if (data[i] == item) return i;                                                         \
+        }                                                                                          \
+                                                                                                   \
+        return n;                                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    ulib_uint uvec_index_of_reverse_##T(UVec_##T const *vec, T item) {                             \
+        T const *data = uvec_data(T, vec);                                                         \
+        ulib_uint const n = vec->_count, lanes = sizeof(p_usimd) / sizeof(T);                      \
+        p_usimd const needle = P_ULIB_MACRO_CONCAT(p_usimd_splat_, K)(item);                       \
+        ulib_uint i = n;                                                                           \
+                                                                                                   \
+        for (; i >= lanes; i -= lanes) {                                                           \
+            p_usimd const block = p_usimd_load(data + i - lanes);                                  \
+            uint64_t mask = p_usimd_mask(P_ULIB_MACRO_CONCAT(p_usimd_eq_, K)(block,                \
+                                                                                     needle));     \
+            if (mask) return i - lanes + (ulib_uint)(p_usimd_last(mask) / sizeof(T));              \
+        }                                                                                          \
+                                                                                                   \
+        while (i-- != 0) {                                                                         \
+            if (data[i] == item) return i;                                                         \
+        }                                                                                          \
+                                                                                                   \
+        return n;                                                                                  \
+    }
+
+/*
+ * Generates a vectorized sorted intersection function for the specified identifiable vector type.
+ * Each block of the first vector is compared against all the elements of a block of the second,
+ * and the block with the smallest last element is then skipped.
+ *
+ * @param T [symbol] Vector type.
+ * @param K [symbol] SIMD primitive kind (8, 16, 32, 64, f32 or f64).
+ */
+#define P_UVEC_IMPL_SORTED_INTERSECT_SIMD(T, K)                                                    \
+                                                                                                   \
+    static ulib_uint p_uvec_sorted_intersect_simd_##T(T const *a, ulib_uint na, T const *b,        \
+                                                      ulib_uint nb, T *out) {                      \
+        ulib_uint const lanes = sizeof(p_usimd) / sizeof(T);                                       \
+        ulib_uint i = 0, j = 0, k = 0;                                                             \
+                                                                                                   \
+        while (na - i >= lanes && nb - j >= lanes) {                                               \
+            p_usimd const block = p_usimd_load(a + i);                                             \
+            p_usimd match = P_ULIB_MACRO_CONCAT(p_usimd_eq_, K)(                                   \
+                block, P_ULIB_MACRO_CONCAT(p_usimd_splat_, K)(b[j]));                              \
+                                                                                                   \
+            for (ulib_uint l = 1; l < lanes; ++l) {                                                \
+                p_usimd const needle = P_ULIB_MACRO_CONCAT(p_usimd_splat_, K)(b[j + l]);           \
+                match = p_usimd_or(match, P_ULIB_MACRO_CONCAT(p_usimd_eq_, K)(block,               \
+                                                                                      needle));    \
+            }                                                                                      \
+                                                                                                   \
+            uint64_t const mask = p_usimd_mask(match);                                             \
+            if (mask) {                                                                            \
+                for (ulib_uint l = 0; l < lanes; ++l) {                                            \
+                    unsigned const bit = (unsigned)((l * sizeof(T) + 1) << P_USIMD_SHIFT) - 1;     \
+                    if ((mask >> bit) & 1U) out[k++] = a[i + l];                                   \
+                }                                                                                  \
+            }                                                                                      \
+                                                                                                   \
+            T const a_last = a[i + lanes - 1], b_last = b[j + lanes - 1];                          \
+            if (!p_uvec_less_than(b_last, a_last)) i += lanes;                                     \
+            if (!p_uvec_less_than(a_last, b_last)) j += lanes;                                     \
+        }                                                                                          \
+                                                                                                   \
+        return k + p_uvec_sorted_intersect_merge_##T(a + i, na - i, b + j, nb - j, out + k);       \
+    }                                                                                              \
+                                                                                                   \
+    uvec_ret uvec_sorted_intersect_##T(UVec_##T const *vec, UVec_##T const *other,                 \
+                                       UVec_##T *dest) {                                           \
+        return p_uvec_sorted_intersect_##T(vec, other, dest, p_uvec_sorted_intersect_simd_##T);    \
+    }
+
+#else
+
+#define P_UVEC_IMPL_SEARCH_SIMD(T, K) P_UVEC_IMPL_SEARCH(T, ulib_unused, p_uvec_identical)
+#define P_UVEC_IMPL_SORTED_INTERSECT_SIMD(T, K) P_UVEC_IMPL_SORTED_INTERSECT(T, ulib_unused)
+
+#endif
+
+/*
+ * Generates minimum and maximum search functions for the specified identifiable vector type.
+ * The extreme value is found via a branch-free reduction, which compilers can vectorize,
+ * and its first occurrence is then located via uvec_index_of.
+ *
+ * @param T [symbol] Vector type.
+ */
+#define P_UVEC_IMPL_MIN_MAX_SIMD(T)                                                                \
+                                                                                                   \
+    ulib_uint uvec_index_of_min_##T(UVec_##T const *vec) {                                         \
+        T const *data = uvec_data(T, vec);                                                         \
+        ulib_uint const n = vec->_count;                                                           \
+        if (!n) return 0;                                                                          \
+                                                                                                   \
+        T min = data[0];                                                                           \
+        for (ulib_uint i = 1; i < n; ++i) min = data[i] < min ? data[i] : min;                     \
+                                                                                                   \
+        ulib_uint const i = uvec_index_of_##T(vec, min);                                           \
+        return i < n ? i : 0;                                                                      \
+    }                                                                                              \
+                                                                                                   \
+    ulib_uint uvec_index_of_max_##T(UVec_##T const *vec) {                                         \
+        T const *data = uvec_data(T, vec);                                                         \
+        ulib_uint const n = vec->_count;                                                           \
+        if (!n) return 0;                                                                          \
+                                                                                                   \
+        T max = data[0];                                                                           \
+        for (ulib_uint i = 1; i < n; ++i) max = max < data[i] ? data[i] : max;                     \
+                                                                                                   \
+        ulib_uint const i = uvec_index_of_##T(vec, max);                                           \
+        return i < n ? i : 0;                                                                      \
+    }
+
+/*
+ * Generates function definitions for the specified identifiable vector type,
+ * with vectorized search functions.
+ *
+ * @param T [symbol] Vector type.
+ * @param K [symbol] SIMD primitive kind (8, 16, 32, 64, f32 or f64).
+ */
+#define P_UVEC_IMPL_IDENTIFIABLE_SIMD(T, K)                                                        \
+    P_UVEC_IMPL(T, ulib_unused)                                                                    \
+    P_UVEC_IMPL_SEARCH_SIMD(T, K)                                                                  \
+    P_UVEC_IMPL_EQUATABLE_COMMON(T, ulib_unused, p_uvec_identical, 1)                              \
+    P_UVEC_IMPL_MIN_MAX_SIMD(T)                                                                    \
+    P_UVEC_IMPL_COMPARABLE_COMMON(T, ulib_unused, p_uvec_identical, p_uvec_less_than)              \
+    P_UVEC_IMPL_SORTED_INTERSECT_SIMD(T, K)
+
+#if defined ULIB_TINY
+#define P_UVEC_SIMD_INT 16
+#define P_UVEC_SIMD_FLOAT f32
+#elif defined ULIB_HUGE
+#define P_UVEC_SIMD_INT 64
+#define P_UVEC_SIMD_FLOAT f64
+#else
+#define P_UVEC_SIMD_INT 32
+#define P_UVEC_SIMD_FLOAT f64
+#endif
+
+P_UVEC_IMPL_IDENTIFIABLE_SIMD(char, 8)
+P_UVEC_IMPL_IDENTIFIABLE_SIMD(ulib_byte, 8)
+P_UVEC_IMPL_IDENTIFIABLE_SIMD(ulib_int, P_UVEC_SIMD_INT)
+P_UVEC_IMPL_IDENTIFIABLE_SIMD(ulib_uint, P_UVEC_SIMD_INT)
+P_UVEC_IMPL_IDENTIFIABLE_SIMD(ulib_float, P_UVEC_SIMD_FLOAT)
 UVEC_IMPL_IDENTIFIABLE(ulib_ptr)
 UVEC_IMPL_COMPARABLE(UString, ustring_equals, ustring_precedes)
+
+// Ranges shorter than this are sorted via comparison sort.
+#define P_UVEC_RADIX_SORT_THRESH 256
+
+void uvec_radix_sort_ulib_byte(UVec(ulib_byte) *vec) {
+    ulib_byte *data = uvec_data(ulib_byte, vec);
+    ulib_uint const n = uvec_count(ulib_byte, vec);
+    ulib_uint counts[256] = { 0 };
+    if (!n) return;
+
+    for (ulib_uint i = 0; i < n; ++i) counts[data[i]]++;
+
+    for (ulib_uint b = 0; b < 256; ++b) {
+        memset(data, (int)b, counts[b]);
+        data += counts[b];
+    }
+}
+
+/*
+ * LSD radix sort with 8-bit digits. All histograms are computed in a single pass,
+ * and passes in which every element has the same digit are skipped.
+ * The sign bit is flipped while extracting digits, so that signed integers can be sorted
+ * as unsigned ones.
+ */
+static bool p_uvec_radix_sort(ulib_uint *data, ulib_uint n, ulib_uint flip) {
+    ulib_uint *tmp = ulib_malloc(n * sizeof(*tmp));
+    if (!tmp) return false;
+
+    ulib_uint counts[sizeof(ulib_uint)][256] = { { 0 } };
+
+    for (ulib_uint i = 0; i < n; ++i) {
+        ulib_uint const key = data[i] ^ flip;
+        for (unsigned p = 0; p < sizeof(ulib_uint); ++p) counts[p][(key >> (p * 8)) & 0xFF]++;
+    }
+
+    ulib_uint *src = data, *dst = tmp;
+
+    for (unsigned p = 0; p < sizeof(ulib_uint); ++p) {
+        ulib_uint *count = counts[p];
+        unsigned const shift = p * 8;
+        if (count[((src[0] ^ flip) >> shift) & 0xFF] == n) continue;
+
+        for (ulib_uint b = 0, sum = 0; b < 256; ++b) {
+            ulib_uint const c = count[b];
+            count[b] = sum;
+            sum += c;
+        }
+
+        for (ulib_uint i = 0; i < n; ++i) dst[count[((src[i] ^ flip) >> shift) & 0xFF]++] = src[i];
+
+        ulib_uint *temp = src;
+        src = dst;
+        dst = temp;
+    }
+
+    if (src != data) memcpy(data, src, n * sizeof(*data));
+    ulib_free(tmp);
+    return true;
+}
+
+void uvec_radix_sort_ulib_uint(UVec(ulib_uint) *vec) {
+    ulib_uint const n = uvec_count(ulib_uint, vec);
+    if (n < P_UVEC_RADIX_SORT_THRESH || !p_uvec_radix_sort(uvec_data(ulib_uint, vec), n, 0)) {
+        uvec_sort(ulib_uint, vec);
+    }
+}
+
+void uvec_radix_sort_ulib_int(UVec(ulib_int) *vec) {
+    ulib_uint const n = uvec_count(ulib_int, vec);
+    ulib_uint const flip = (ulib_uint)1 << (sizeof(ulib_uint) * 8 - 1);
+    if (n < P_UVEC_RADIX_SORT_THRESH ||
+        !p_uvec_radix_sort((ulib_uint *)uvec_data(ulib_int, vec), n, flip)) {
+        uvec_sort(ulib_int, vec);
+    }
+}
+
+static inline bool p_uvec_parse_is_space(char c, char sep) {
+    return c != sep && (c == ' ' || c == '\t' || c == '\r' || c == '\n');
+}
+
+static inline size_t p_uvec_parse_skip_space(char const *src, size_t i, size_t len, char sep) {
+    while (i < len && p_uvec_parse_is_space(src[i], sep)) ++i;
+    return i;
+}
+
+#define P_UVEC_IMPL_APPEND_PARSED(T, parse_func)                                                   \
+    ulib_ret uvec_append_parsed_##T(UVec(T) *vec, UString string, char sep) {                      \
+        char const *src = ustring_data(string);                                                    \
+        size_t const len = ustring_length(string);                                                 \
+        ulib_uint const count = uvec_count(T, vec);                                                \
+        size_t i = p_uvec_parse_skip_space(src, 0, len, sep);                                      \
+        ulib_ret ret = ULIB_OK;                                                                    \
+                                                                                                   \
+        while (i < len) {                                                                          \
+            T value;                                                                               \
+            size_t const read = parse_func(src + i, len - i, &value);                              \
+                                                                                                   \
+            if (!read) {                                                                           \
+                ret = ULIB_ERR;                                                                    \
+                break;                                                                             \
+            }                                                                                      \
+                                                                                                   \
+            if (uvec_push(T, vec, value)) {                                                        \
+                ret = ULIB_ERR_MEM;                                                                \
+                break;                                                                             \
+            }                                                                                      \
+                                                                                                   \
+            i = p_uvec_parse_skip_space(src, i + read, len, sep);                                  \
+            if (i == len) break;                                                                   \
+                                                                                                   \
+            if (src[i] != sep) {                                                                   \
+                ret = ULIB_ERR;                                                                    \
+                break;                                                                             \
+            }                                                                                      \
+                                                                                                   \
+            i = p_uvec_parse_skip_space(src, i + 1, len, sep);                                     \
+        }                                                                                          \
+                                                                                                   \
+        if (ret) vec->_count = count;                                                              \
+        return ret;                                                                                \
+    }
+
+P_UVEC_IMPL_APPEND_PARSED(ulib_int, ulib_str_parse_int)
+P_UVEC_IMPL_APPEND_PARSED(ulib_uint, ulib_str_parse_uint)
+P_UVEC_IMPL_APPEND_PARSED(ulib_float, ulib_str_parse_float)
+
+ulib_ret uvec_append_split(UVec(UString) *vec, UStrSplit split) {
+    ulib_uint const count = uvec_count(UString, vec);
+
+    ustrsplit_foreach (split, token) {
+        if (uvec_push(UString, vec, token)) {
+            vec->_count = count;
+            return ULIB_ERR_MEM;
+        }
+    }
+
+    return ULIB_OK;
+}
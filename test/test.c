@@ -1,20 +1,34 @@
+#include "uarena_tests.h"
+#include "ubench_tests.h"
 #include "ubit_tests.h"
+#include "ubitset_tests.h"
+#include "ubtree_tests.h"
+#include "udeque_tests.h"
 #include "uhash_tests.h"
+#include "uprof_tests.h"
 #include "urand_tests.h"
 #include "ustream_tests.h"
 #include "ustring_tests.h"
 #include "utest.h"
 #include "utime_tests.h"
+#include "utrace_tests.h"
 #include "uvec_tests.h"
 #include "uversion_tests.h"
 
 utest_main({
+    utest_run("uarena", UARENA_TESTS);
+    utest_run_serial("ubench", UBENCH_TESTS);
     utest_run("ubit", UBIT_TESTS);
+    utest_run("ubitset", UBITSET_TESTS);
+    utest_run("ubtree", UBTREE_TESTS);
+    utest_run("udeque", UDEQUE_TESTS);
     utest_run("uhash", UHASH_TESTS);
+    utest_run_serial("uprof", UPROF_TESTS);
     utest_run("urand", URAND_TESTS);
-    utest_run("ustream", USTREAM_TESTS);
+    utest_run_serial("ustream", USTREAM_TESTS);
     utest_run("ustring", USTRING_TESTS);
     utest_run("uvec", UVEC_TESTS);
     utest_run("utime", UTIME_TESTS);
+    utest_run_serial("utrace", UTRACE_TESTS);
     utest_run("uversion", UVERSION_TESTS);
 })
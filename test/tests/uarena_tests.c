@@ -0,0 +1,230 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "uarena_tests.h"
+#include "uarena.h"
+#include "uhash_builtin.h"
+#include "ustrbuf.h"
+#include "ustream.h"
+#include "ustring.h"
+#include "utest.h"
+#include "uthread.h"
+#include "uvec_builtin.h"
+
+typedef int32_t ArenaInt;
+UVEC_INIT_ALLOC(ArenaInt, uvec_growth_pow2)
+
+typedef struct ArenaAlign {
+    char c;
+    max_align_t m;
+} ArenaAlign;
+
+#define uarena_assert_aligned(ptr)                                                                 \
+    utest_assert_uint((uintptr_t)(ptr) % offsetof(ArenaAlign, m), ==, 0)
+
+bool uarena_test_alloc(void) {
+    UArena arena = uarena(256);
+    utest_assert_false(uarena_owns(&arena, &arena));
+
+    char *a = (char *)uarena_alloc(&arena, 3);
+    char *b = (char *)uarena_alloc(&arena, 5);
+    utest_assert_not_null(a);
+    utest_assert_not_null(b);
+    uarena_assert_aligned(a);
+    uarena_assert_aligned(b);
+    utest_assert_ptr(a, !=, b);
+    utest_assert(uarena_owns(&arena, a));
+    utest_assert(uarena_owns(&arena, b));
+    memcpy(a, "ab", 3);
+
+    // The most recent allocation is resized in place.
+    char *c = (char *)uarena_realloc(&arena, b, 5, 64);
+    utest_assert_ptr(c, ==, b);
+
+    // Other allocations are moved.
+    char *d = (char *)uarena_realloc(&arena, a, 3, 16);
+    utest_assert_ptr(d, !=, a);
+    utest_assert_buf(d, ==, "ab", 3);
+
+    UArenaMark mark = uarena_mark(&arena);
+    char *e = (char *)uarena_alloc(&arena, 32);
+    utest_assert_not_null(e);
+    uarena_reset_to(&arena, mark);
+    utest_assert_ptr(uarena_alloc(&arena, 32), ==, e);
+
+    // Large allocations get a dedicated chunk.
+    char *large = (char *)uarena_alloc(&arena, 1024);
+    utest_assert_not_null(large);
+    uarena_assert_aligned(large);
+    memset(large, 0xFF, 1024);
+    utest_assert(uarena_owns(&arena, large));
+
+    // Chunks are retained on reset.
+    uarena_reset(&arena);
+    utest_assert_ptr(uarena_alloc(&arena, 3), ==, a);
+    char *big = (char *)uarena_alloc(&arena, 512);
+    utest_assert_ptr(big, ==, large);
+
+    // Sizes that overflow once aligned, or once the chunk header is added, are rejected.
+    size_t const align = offsetof(ArenaAlign, m);
+    utest_assert_ptr(uarena_alloc(&arena, SIZE_MAX), ==, NULL);
+    utest_assert_ptr(uarena_alloc(&arena, SIZE_MAX - align), ==, NULL);
+    utest_assert_ptr(uarena_realloc(&arena, big, 512, SIZE_MAX), ==, NULL);
+    utest_assert_ptr(uarena_alloc(&arena, 3), !=, NULL);
+
+    uarena_deinit(&arena);
+    utest_assert_false(uarena_owns(&arena, a));
+    return true;
+}
+
+bool uarena_test_allocator(void) {
+    UArena arena = uarena(0);
+    UAllocator const alloc = uarena_allocator(&arena);
+    UVec(ArenaInt) v = uvec_with_allocator(ArenaInt, &alloc);
+
+    for (ArenaInt i = 0; i < 1000; ++i) {
+        utest_assert(uvec_push(ArenaInt, &v, i) == UVEC_OK);
+    }
+
+    utest_assert(uarena_owns(&arena, uvec_data(ArenaInt, &v)));
+    for (ArenaInt i = 0; i < 1000; ++i) {
+        utest_assert(uvec_get(ArenaInt, &v, (ulib_uint)i) == i);
+    }
+
+    uvec_deinit(ArenaInt, &v);
+    uarena_deinit(&arena);
+    return true;
+}
+
+bool uarena_test_scope(void) {
+#if defined(ULIB_ALLOC_SCOPES)
+    UArena arena = uarena(0);
+    UVec(ulib_int) heap_vec = uvec(ulib_int);
+    utest_assert(uvec_reserve(ulib_int, &heap_vec, 64) == UVEC_OK);
+
+    // Assertions are checked after the scope ends, as failing ones return early.
+    UArena *prev = uarena_scope_begin(&arena);
+    UVec(ulib_int) v = uvec(ulib_int);
+    UHash(ulib_int) set = uhset(ulib_int);
+    UString str = ustring_copy("arena-allocated string, long enough to live on the heap", 55);
+    UStrBuf buf = ustrbuf();
+    bool inserted = true;
+
+    for (ulib_int i = 0; i < 100; ++i) {
+        uvec_push(ulib_int, &v, i);
+        uvec_push(ulib_int, &heap_vec, i);
+        inserted = uhset_insert(ulib_int, &set, i) == UHASH_INSERTED && inserted;
+        ustrbuf_append_literal(&buf, "arena");
+    }
+
+    bool const vec_owned = uarena_owns(&arena, uvec_data(ulib_int, &v));
+    bool const set_owned = uarena_owns(&arena, set._keys);
+    bool const str_owned = uarena_owns(&arena, ustring_data(str));
+    bool const buf_owned = uarena_owns(&arena, uvec_data(char, &buf));
+    bool const heap_owned = uarena_owns(&arena, uvec_data(ulib_int, &heap_vec));
+    ulib_uint const vec_count = uvec_count(ulib_int, &v);
+    ulib_uint const set_count = uhash_count(ulib_int, &set);
+    ulib_uint const buf_length = uvec_count(char, &buf);
+
+    uvec_deinit(ulib_int, &v);
+    uhash_deinit(ulib_int, &set);
+    ustring_deinit(&str);
+    ustrbuf_deinit(&buf);
+    uarena_scope_end(prev);
+
+    uvec_deinit(ulib_int, &heap_vec);
+    uarena_deinit(&arena);
+
+    utest_assert(inserted);
+    utest_assert(vec_owned);
+    utest_assert(set_owned);
+    utest_assert(str_owned);
+    utest_assert(buf_owned);
+    utest_assert_uint(vec_count, ==, 100);
+    utest_assert_uint(set_count, ==, 100);
+    utest_assert_uint(buf_length, ==, 500);
+
+    // Heap memory reallocated within the scope stays on the heap.
+    utest_assert_false(heap_owned);
+#endif
+    return true;
+}
+
+#if defined(ULIB_ALLOC_SCOPES)
+static void uarena_thread_func(void *ctx) {
+    // Started threads allocate from the heap.
+    UVec(ulib_int) v = uvec(ulib_int);
+    bool *done = (bool *)ctx;
+    *done = uvec_push(ulib_int, &v, 1) == UVEC_OK;
+    uvec_deinit(ulib_int, &v);
+}
+#endif
+
+bool uarena_test_scope_threads(void) {
+#if defined(ULIB_ALLOC_SCOPES)
+    UArena arena = uarena(0);
+    UStrBuf strbuf = ustrbuf();
+    UOStream dst, stream;
+    UThread thread;
+    bool done = false;
+
+    UArena *prev = uarena_scope_begin(&arena);
+    ulib_ret const ret = uthread_start(&thread, uarena_thread_func, &done);
+    if (ret == ULIB_OK) uthread_join(&thread);
+
+    bool streamed = uostream_to_strbuf(&dst, &strbuf) == USTREAM_OK &&
+                    uostream_to_async(&stream, &dst, 16, USTREAM_ASYNC_BLOCK) == USTREAM_OK;
+    if (streamed) {
+        streamed = uostream_write_literal(&stream, "abc", NULL) == USTREAM_OK;
+        streamed = uostream_deinit(&stream) == USTREAM_OK && streamed;
+    }
+
+    ulib_uint const n = 4 * UVEC_PARALLEL_MIN_CHUNK;
+    UVec(ulib_uint) v = uvec(ulib_uint);
+    for (ulib_uint i = 0; i < n; ++i) uvec_push(ulib_uint, &v, n - i);
+    uvec_sort_parallel(ulib_uint, &v, 4);
+
+    bool sorted = uvec_count(ulib_uint, &v) == n;
+    for (ulib_uint i = 0; sorted && i < n; ++i) sorted = uvec_get(ulib_uint, &v, i) == i + 1;
+
+    uvec_deinit(ulib_uint, &v);
+    uarena_scope_end(prev);
+    uarena_deinit(&arena);
+
+    utest_assert(ret == ULIB_OK);
+    utest_assert(done);
+    utest_assert(streamed);
+    utest_assert_buf(ustrbuf_data(&strbuf), ==, "abc", 3);
+    utest_assert(sorted);
+    ustrbuf_deinit(&strbuf);
+#endif
+    return true;
+}
+
+bool upool_test(void) {
+    UPool pool = upool(24, 4);
+    void *objs[10];
+
+    for (unsigned i = 0; i < ulib_array_count(objs); ++i) {
+        objs[i] = upool_alloc(&pool);
+        utest_assert_not_null(objs[i]);
+        uarena_assert_aligned(objs[i]);
+        memset(objs[i], (int)i, 24);
+        for (unsigned j = 0; j < i; ++j) utest_assert_ptr(objs[i], !=, objs[j]);
+    }
+
+    // Released objects are recycled.
+    upool_free(&pool, objs[3]);
+    upool_free(&pool, objs[7]);
+    utest_assert_ptr(upool_alloc(&pool), ==, objs[7]);
+    utest_assert_ptr(upool_alloc(&pool), ==, objs[3]);
+
+    upool_deinit(&pool);
+    return true;
+}
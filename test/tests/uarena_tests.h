@@ -0,0 +1,25 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UARENA_TESTS_H
+#define UARENA_TESTS_H
+
+#include "ustd.h"
+
+bool uarena_test_alloc(void);
+bool uarena_test_allocator(void);
+bool uarena_test_scope(void);
+bool uarena_test_scope_threads(void);
+bool upool_test(void);
+
+#define UARENA_TESTS                                                                               \
+    uarena_test_alloc, uarena_test_allocator, uarena_test_scope, uarena_test_scope_threads,        \
+        upool_test
+
+#endif // UARENA_TESTS_H
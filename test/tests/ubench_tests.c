@@ -0,0 +1,101 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "ubench_tests.h"
+#include "ubench.h"
+#include "ustrbuf.h"
+#include "utest.h"
+
+static void bench_sum(void *ctx, size_t iterations) {
+    unsigned sum = 0;
+    for (size_t i = 0; i < iterations; ++i) sum += (unsigned)i;
+    ubench_do_not_optimize(&sum);
+    if (ctx) *(size_t *)ctx += iterations;
+}
+
+static void bench_paused(void *ctx, size_t iterations) {
+    ubench_pause();
+    bench_sum(ctx, iterations * 100);
+    ubench_resume();
+    bench_sum(NULL, iterations);
+}
+
+static void bench_run_sum(void) {
+    ubench_case("sum", 10, bench_sum, NULL);
+    ubench_case("other", 20, bench_sum, NULL);
+}
+
+static UBenchConfig bench_config_quick(UOStream *stream, ubench_format format) {
+    UBenchConfig const prev = *ubench_config();
+    ubench_config()->format = format;
+    ubench_config()->stream = stream;
+    ubench_config()->samples = 5;
+    ubench_config()->sample_time = 100000;
+    ubench_config()->warmup_time = 0;
+    return prev;
+}
+
+bool ubench_test_measure(void) {
+    UBenchConfig const prev = bench_config_quick(NULL, UBENCH_FORMAT_TEXT);
+    size_t total = 0;
+    UBenchResult const res = ubench_measure(bench_sum, &total);
+    UBenchResult const paused = ubench_measure(bench_paused, NULL);
+    *ubench_config() = prev;
+
+    utest_assert_uint(res.samples, ==, 5);
+    utest_assert_uint(res.iterations, >, 1);
+    utest_assert_uint(total, >=, res.iterations * res.samples);
+    utest_assert(res.min <= res.median && res.median <= res.p99);
+    utest_assert(res.min <= res.mean && res.mean <= res.p99);
+    utest_assert(res.stddev >= 0);
+
+    // Paused time is not measured.
+    utest_assert(paused.median < res.median * 50);
+    return true;
+}
+
+bool ubench_test_report(void) {
+    UStrBuf buf = ustrbuf();
+    UOStream stream;
+    utest_assert(uostream_to_strbuf(&stream, &buf) == USTREAM_OK);
+
+    UBenchConfig const prev = bench_config_quick(&stream, UBENCH_FORMAT_CSV);
+    char *argv[] = { (char *)"bench", (char *)"--csv", (char *)"test/sum" };
+    bool const started = ubench_start(3, argv);
+    ubench_run("test", bench_run_sum);
+    ubench_end();
+
+    ubench_config()->format = UBENCH_FORMAT_JSON;
+    ubench_config()->filter = NULL;
+    ubench_start(1, argv);
+    ubench_run("test", bench_run_sum);
+    ubench_run("a\"b\\c\n", bench_run_sum);
+    ubench_end();
+    *ubench_config() = prev;
+
+    uostream_write_literal(&stream, "\0", NULL);
+    uostream_deinit(&stream);
+    char const *out = ustrbuf_data(&buf);
+    utest_assert(started);
+
+    char const header[] = "group,name,size,iterations,samples,min_ns,median_ns,p99_ns,mean_ns,"
+                          "stddev_ns\ntest,sum,10,";
+    utest_assert_buf(out, ==, header, sizeof(header) - 1);
+
+    // The filter excludes the second benchmark.
+    utest_assert(strstr(out, "test,other") == NULL);
+    char const json[] = "[\n  {\"group\": \"test\", \"name\": \"sum\", \"size\": 10,";
+    utest_assert_not_null(strstr(out, json));
+    utest_assert_not_null(strstr(out, "},\n  {\"group\": \"test\", \"name\": \"other\""));
+    utest_assert_not_null(strstr(out, "{\"group\": \"a\\u0022b\\u005cc\\u000a\", \"name\""));
+    utest_assert_not_null(strstr(out, "}\n]\n"));
+
+    ustrbuf_deinit(&buf);
+    return true;
+}
@@ -0,0 +1,20 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UBENCH_TESTS_H
+#define UBENCH_TESTS_H
+
+#include "ustd.h"
+
+bool ubench_test_measure(void);
+bool ubench_test_report(void);
+
+#define UBENCH_TESTS ubench_test_measure, ubench_test_report
+
+#endif // UBENCH_TESTS_H
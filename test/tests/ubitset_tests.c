@@ -0,0 +1,220 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "ubitset_tests.h"
+#include "ubitset.h"
+#include "urand.h"
+#include "utest.h"
+
+#define BITSET_BITS 300
+
+// Checks the bitset against a reference array of bits.
+static bool bitset_matches(UBitSet const *set, bool const *bits, ulib_uint size) {
+    utest_assert_uint(ubitset_size(set), ==, size);
+    ulib_uint count = 0;
+
+    for (ulib_uint i = 0; i < size; ++i) {
+        utest_assert(ubitset_is_set(set, i) == bits[i]);
+        count += bits[i];
+    }
+
+    utest_assert_uint(ubitset_count_set(set), ==, count);
+    return true;
+}
+
+static bool bitset_random(UBitSet *set, bool *bits, ulib_uint size, URandGen *gen) {
+    utest_assert(ubitset_resize(set, size) == ULIB_OK);
+    ubitset_clear(set);
+
+    for (ulib_uint i = 0; i < size; ++i) {
+        bits[i] = urand_gen_next(gen) & 1U;
+        if (bits[i]) utest_assert(ubitset_set(set, i) == ULIB_OK);
+    }
+
+    return true;
+}
+
+bool ubitset_test_base(void) {
+    UBitSet set = ubitset();
+    utest_assert_uint(ubitset_size(&set), ==, 0);
+    utest_assert_uint(ubitset_count_set(&set), ==, 0);
+    utest_assert_false(ubitset_is_set(&set, 0));
+    ubitset_unset(&set, 10);
+
+    // Setting bits grows the bitset.
+    utest_assert(ubitset_set(&set, 200) == ULIB_OK);
+    utest_assert_uint(ubitset_size(&set), ==, 201);
+    utest_assert(ubitset_set(&set, 3) == ULIB_OK);
+    utest_assert(ubitset_set(&set, 64) == ULIB_OK);
+    utest_assert_uint(ubitset_size(&set), ==, 201);
+    utest_assert_uint(ubitset_count_set(&set), ==, 3);
+    utest_assert(ubitset_is_set(&set, 3));
+    utest_assert(ubitset_is_set(&set, 64));
+    utest_assert(ubitset_is_set(&set, 200));
+    utest_assert_false(ubitset_is_set(&set, 63));
+    utest_assert_false(ubitset_is_set(&set, 201));
+
+    ubitset_unset(&set, 64);
+    utest_assert_false(ubitset_is_set(&set, 64));
+    utest_assert_uint(ubitset_count_set(&set), ==, 2);
+
+    UBitSet copy = ubitset();
+    utest_assert(ubitset_copy(&set, &copy) == ULIB_OK);
+    utest_assert(ubitset_equals(&set, &copy));
+
+    // Shrinking discards bits, and growing again does not restore them.
+    utest_assert(ubitset_resize(&set, 100) == ULIB_OK);
+    utest_assert_uint(ubitset_count_set(&set), ==, 1);
+    utest_assert(ubitset_resize(&set, 1000) == ULIB_OK);
+    utest_assert_uint(ubitset_size(&set), ==, 1000);
+    utest_assert_uint(ubitset_count_set(&set), ==, 1);
+    utest_assert_false(ubitset_is_set(&set, 200));
+    utest_assert_false(ubitset_equals(&set, &copy));
+
+    ubitset_clear(&set);
+    utest_assert_uint(ubitset_size(&set), ==, 1000);
+    utest_assert_uint(ubitset_count_set(&set), ==, 0);
+
+    ubitset_deinit(&set);
+    ubitset_deinit(&copy);
+    return true;
+}
+
+bool ubitset_test_range(void) {
+    bool bits[BITSET_BITS] = { false };
+    UBitSet set = ubitset();
+
+    struct {
+        ulib_uint start, len;
+        bool set;
+    } const ranges[] = {
+        { 5, 10, true },  { 60, 8, true },    { 100, 150, true }, { 130, 1, false },
+        { 64, 64, true }, { 120, 70, false }, { 255, 45, true },  { 299, 10, false },
+    };
+
+    for (unsigned r = 0; r < ulib_array_count(ranges); ++r) {
+        ulib_uint const start = ranges[r].start, len = ranges[r].len;
+        if (ranges[r].set) {
+            utest_assert(ubitset_set_range(&set, start, len) == ULIB_OK);
+        } else {
+            ubitset_unset_range(&set, start, len);
+        }
+        for (ulib_uint i = start; i < start + len && i < BITSET_BITS; ++i) bits[i] = ranges[r].set;
+    }
+
+    if (!bitset_matches(&set, bits, BITSET_BITS)) return false;
+
+    for (ulib_uint start = 0; start < BITSET_BITS; start += 7) {
+        for (ulib_uint len = 0; len < 140; len += 13) {
+            ulib_uint count = 0;
+            for (ulib_uint i = start; i < start + len && i < BITSET_BITS; ++i) count += bits[i];
+            utest_assert_uint(ubitset_count_set_range(&set, start, len), ==, count);
+        }
+
+        ulib_uint next_set = start, next_unset = start;
+        while (next_set < BITSET_BITS && !bits[next_set]) ++next_set;
+        while (next_unset < BITSET_BITS && bits[next_unset]) ++next_unset;
+        utest_assert_uint(ubitset_next_set(&set, start), ==, next_set);
+        utest_assert_uint(ubitset_next_unset(&set, start), ==, next_unset);
+    }
+
+    utest_assert_uint(ubitset_next_set(&set, BITSET_BITS), ==, BITSET_BITS);
+    utest_assert_uint(ubitset_next_unset(&set, 255), ==, 299);
+    utest_assert(ubitset_set(&set, 299) == ULIB_OK);
+    utest_assert_uint(ubitset_next_unset(&set, 255), ==, BITSET_BITS);
+
+    ubitset_deinit(&set);
+    return true;
+}
+
+bool ubitset_test_ops(void) {
+    static ulib_uint const sizes[][2] = { { 300, 300 }, { 64, 1000 }, { 1000, 64 }, { 0, 130 } };
+    static bool a_bits[1000], b_bits[1000], r_bits[1000];
+    URandGen gen = urand_gen(42);
+    UBitSet a = ubitset(), b = ubitset(), r = ubitset();
+
+    for (unsigned s = 0; s < ulib_array_count(sizes); ++s) {
+        ulib_uint const na = sizes[s][0], nb = sizes[s][1], nmax = na > nb ? na : nb;
+        if (!bitset_random(&a, a_bits, na, &gen)) return false;
+        if (!bitset_random(&b, b_bits, nb, &gen)) return false;
+
+        bool subset = true, intersects = false;
+        for (ulib_uint i = 0; i < nmax; ++i) {
+            bool const x = i < na && a_bits[i], y = i < nb && b_bits[i];
+            if (x && !y) subset = false;
+            if (x && y) intersects = true;
+        }
+
+        utest_assert(ubitset_is_subset(&a, &b) == subset);
+        utest_assert(ubitset_intersects(&a, &b) == intersects);
+        utest_assert(ubitset_equals(&a, &a));
+
+        utest_assert(ubitset_copy(&a, &r) == ULIB_OK);
+        ubitset_and(&r, &b);
+        for (ulib_uint i = 0; i < na; ++i) r_bits[i] = a_bits[i] && i < nb && b_bits[i];
+        if (!bitset_matches(&r, r_bits, na)) return false;
+        utest_assert(ubitset_is_subset(&r, &a));
+        utest_assert(ubitset_is_subset(&r, &b));
+
+        utest_assert(ubitset_copy(&a, &r) == ULIB_OK);
+        ubitset_and_not(&r, &b);
+        for (ulib_uint i = 0; i < na; ++i) r_bits[i] = a_bits[i] && !(i < nb && b_bits[i]);
+        if (!bitset_matches(&r, r_bits, na)) return false;
+        utest_assert_false(ubitset_intersects(&r, &b));
+
+        utest_assert(ubitset_copy(&a, &r) == ULIB_OK);
+        utest_assert(ubitset_or(&r, &b) == ULIB_OK);
+        for (ulib_uint i = 0; i < nmax; ++i) {
+            r_bits[i] = (i < na && a_bits[i]) || (i < nb && b_bits[i]);
+        }
+        if (!bitset_matches(&r, r_bits, nmax)) return false;
+
+        utest_assert(ubitset_copy(&a, &r) == ULIB_OK);
+        utest_assert(ubitset_xor(&r, &b) == ULIB_OK);
+        for (ulib_uint i = 0; i < nmax; ++i) {
+            r_bits[i] = (i < na && a_bits[i]) != (i < nb && b_bits[i]);
+        }
+        if (!bitset_matches(&r, r_bits, nmax)) return false;
+
+        // Xoring twice restores the bitset, whose size may have grown.
+        utest_assert(ubitset_xor(&r, &b) == ULIB_OK);
+        utest_assert(ubitset_equals(&r, &a));
+    }
+
+    ubitset_deinit(&a);
+    ubitset_deinit(&b);
+    ubitset_deinit(&r);
+    return true;
+}
+
+bool ubitset_test_foreach(void) {
+    static ulib_uint const expected[] = { 0, 1, 63, 64, 65, 127, 128, 500, 999 };
+    UBitSet set = ubitset();
+
+    unsigned count = 0;
+    ubitset_foreach (&set, bit) {
+        count++;
+    }
+    utest_assert_uint(count, ==, 0);
+
+    for (unsigned i = 0; i < ulib_array_count(expected); ++i) {
+        utest_assert(ubitset_set(&set, expected[i]) == ULIB_OK);
+    }
+    utest_assert(ubitset_resize(&set, 1500) == ULIB_OK);
+
+    ubitset_foreach (&set, bit) {
+        utest_assert_uint(count, <, ulib_array_count(expected));
+        utest_assert_uint(bit, ==, expected[count]);
+        count++;
+    }
+    utest_assert_uint(count, ==, ulib_array_count(expected));
+
+    ubitset_deinit(&set);
+    return true;
+}
@@ -0,0 +1,22 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UBITSET_TESTS_H
+#define UBITSET_TESTS_H
+
+#include "ustd.h"
+
+bool ubitset_test_base(void);
+bool ubitset_test_range(void);
+bool ubitset_test_ops(void);
+bool ubitset_test_foreach(void);
+
+#define UBITSET_TESTS ubitset_test_base, ubitset_test_range, ubitset_test_ops, ubitset_test_foreach
+
+#endif // UBITSET_TESTS_H
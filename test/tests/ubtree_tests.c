@@ -0,0 +1,270 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "ubtree_tests.h"
+#include "ubtree.h"
+#include "urand.h"
+#include "utest.h"
+#include "uvec_builtin.h"
+
+#define TREE_ELEMENTS 5000
+
+UBTREE_INIT(IntMap, ulib_int, ulib_int, ubtree_identical, ubtree_less_than)
+UBTREE_INIT(IntSet, ulib_int, UBTREE_VAL_IGNORE, ubtree_identical, ubtree_less_than)
+
+// Checks the map against a sorted reference vector of keys, whose values are twice the keys.
+static bool map_matches(UBTree(IntMap) const *map, UVec(ulib_int) const *keys) {
+    utest_assert_uint(ubtree_count(IntMap, map), ==, uvec_count(ulib_int, keys));
+    ulib_uint i = 0;
+
+    ubtree_foreach (IntMap, map, loop) {
+        utest_assert_uint(i, <, uvec_count(ulib_int, keys));
+        utest_assert_int(*loop.key, ==, uvec_get(ulib_int, keys, i));
+        utest_assert_int(*loop.val, ==, 2 * *loop.key);
+        ++i;
+    }
+
+    utest_assert_uint(i, ==, uvec_count(ulib_int, keys));
+
+    UBTreeLoop(IntMap) last = ubtree_last(IntMap, map);
+
+    if (i) {
+        utest_assert_int(*last.key, ==, uvec_last(ulib_int, keys));
+    } else {
+        utest_assert_ptr(last.key, ==, NULL);
+    }
+
+    return true;
+}
+
+bool ubtree_test_base(void) {
+    UBTree(IntMap) map = ubtree(IntMap);
+    utest_assert_uint(ubtree_count(IntMap, &map), ==, 0);
+    utest_assert_ptr(ubtree_first(IntMap, &map).key, ==, NULL);
+    utest_assert_ptr(ubtree_lower_bound(IntMap, &map, 0).key, ==, NULL);
+    utest_assert_false(ubtree_contains(IntMap, &map, 0));
+    utest_assert_false(ubtree_remove(IntMap, &map, 0));
+
+    // Descending insertions fill the tree from the left.
+    for (ulib_int i = TREE_ELEMENTS; i-- > 0;) {
+        utest_assert(ubmap_set(IntMap, &map, i, 2 * i, NULL) == UBTREE_INSERTED);
+    }
+
+    utest_assert_uint(ubtree_count(IntMap, &map), ==, TREE_ELEMENTS);
+
+    for (ulib_int i = 0; i < TREE_ELEMENTS; ++i) {
+        utest_assert(ubtree_contains(IntMap, &map, i));
+        utest_assert_int(ubmap_get(IntMap, &map, i, -1), ==, 2 * i);
+    }
+
+    utest_assert_false(ubtree_contains(IntMap, &map, TREE_ELEMENTS));
+    utest_assert_int(ubmap_get(IntMap, &map, -1, -1), ==, -1);
+
+    ulib_int existing = 0;
+    utest_assert(ubmap_set(IntMap, &map, 10, 42, &existing) == UBTREE_PRESENT);
+    utest_assert_int(existing, ==, 20);
+    utest_assert_int(ubmap_get(IntMap, &map, 10, -1), ==, 42);
+    utest_assert_uint(ubtree_count(IntMap, &map), ==, TREE_ELEMENTS);
+
+    ulib_int key = 0, val = 0;
+    utest_assert(ubtree_pop(IntMap, &map, 10, &key, &val));
+    utest_assert_int(key, ==, 10);
+    utest_assert_int(val, ==, 42);
+    utest_assert_false(ubtree_pop(IntMap, &map, 10, &key, &val));
+
+    for (ulib_int i = 0; i < TREE_ELEMENTS; ++i) {
+        utest_assert(ubtree_remove(IntMap, &map, i) == (i != 10));
+    }
+
+    utest_assert_uint(ubtree_count(IntMap, &map), ==, 0);
+    utest_assert_ptr(ubtree_first(IntMap, &map).key, ==, NULL);
+    ubtree_deinit(IntMap, &map);
+
+    UBTree(IntSet) set = ubtree(IntSet);
+
+    for (ulib_int i = 0; i < TREE_ELEMENTS; ++i) {
+        utest_assert(ubset_insert(IntSet, &set, i % 100) == (i < 100 ? UBTREE_INSERTED :
+                                                                       UBTREE_PRESENT));
+    }
+
+    utest_assert_uint(ubtree_count(IntSet, &set), ==, 100);
+    ubtree_deinit(IntSet, &set);
+
+    // Ascending insertions leave full leaves behind.
+    for (ulib_int i = 0; i < TREE_ELEMENTS; ++i) {
+        utest_assert(ubmap_set(IntMap, &map, i, 2 * i, NULL) == UBTREE_INSERTED);
+    }
+
+    for (P_UBTree_Leaf_IntMap *leaf = map._first; leaf->_next; leaf = leaf->_next) {
+        utest_assert_uint(leaf->_count, ==, p_ubtree_cap(IntMap));
+    }
+
+    ubtree_deinit(IntMap, &map);
+    return true;
+}
+
+bool ubtree_test_random(void) {
+    URandGen gen = urand_gen(42);
+    UBTree(IntMap) map = ubtree(IntMap);
+    UVec(ulib_int) keys = uvec(ulib_int);
+
+    // Mixed insertions and removals exercise splits, merges and rotations at all levels.
+    for (ulib_uint round = 0; round < 4; ++round) {
+        bool const grow = round % 2 == 0;
+
+        for (ulib_uint i = 0; i < 4 * TREE_ELEMENTS; ++i) {
+            ulib_int const key = (ulib_int)(urand_gen_next(&gen) % (2 * TREE_ELEMENTS));
+            bool const insert = (urand_gen_next(&gen) % 4 != 0) == grow;
+
+            if (insert) {
+                bool const present = ubtree_contains(IntMap, &map, key);
+                ubtree_ret const ret = ubmap_set(IntMap, &map, key, 2 * key, NULL);
+                utest_assert(ret == (present ? UBTREE_PRESENT : UBTREE_INSERTED));
+                utest_assert(uvec_insert_sorted_unique(ulib_int, &keys, key, NULL) != UVEC_ERR);
+            } else {
+                bool const present = uvec_remove_sorted(ulib_int, &keys, key);
+                utest_assert(ubtree_remove(IntMap, &map, key) == present);
+            }
+        }
+
+        utest_assert(map_matches(&map, &keys));
+    }
+
+    // Appending past the last key leaves full leaves behind.
+    ulib_int const start = 2 * TREE_ELEMENTS;
+
+    for (ulib_int i = 0; i < TREE_ELEMENTS; ++i) {
+        utest_assert(ubmap_set(IntMap, &map, start + i, 2 * (start + i), NULL) == UBTREE_INSERTED);
+        utest_assert(uvec_push(ulib_int, &keys, start + i) == UVEC_OK);
+    }
+
+    utest_assert(map_matches(&map, &keys));
+
+    while (uvec_count(ulib_int, &keys)) {
+        ulib_uint const idx = (ulib_uint)(urand_gen_next(&gen) % uvec_count(ulib_int, &keys));
+        ulib_int const key = uvec_get(ulib_int, &keys, idx);
+        uvec_remove_at(ulib_int, &keys, idx);
+        utest_assert(ubtree_remove(IntMap, &map, key));
+        if (idx % 64 == 0) utest_assert(map_matches(&map, &keys));
+    }
+
+    utest_assert(map_matches(&map, &keys));
+    ubtree_deinit(IntMap, &map);
+    uvec_deinit(ulib_int, &keys);
+    return true;
+}
+
+bool ubtree_test_range(void) {
+    UBTree(IntMap) map = ubtree(IntMap);
+
+    // Even keys only.
+    for (ulib_int i = 0; i < TREE_ELEMENTS; ++i) {
+        utest_assert(ubmap_set(IntMap, &map, 2 * i, 4 * i, NULL) == UBTREE_INSERTED);
+    }
+
+    for (ulib_int i = -1; i <= 2 * TREE_ELEMENTS; ++i) {
+        ulib_int const expected = i < 0 ? 0 : i + (i % 2);
+        UBTreeLoop(IntMap) lower = ubtree_lower_bound(IntMap, &map, i);
+        UBTreeLoop(IntMap) upper = ubtree_upper_bound(IntMap, &map, i);
+        UBTreeLoop(IntMap) found = ubtree_find(IntMap, &map, i);
+
+        if (expected < 2 * TREE_ELEMENTS) {
+            utest_assert_int(*lower.key, ==, expected);
+        } else {
+            utest_assert_ptr(lower.key, ==, NULL);
+        }
+
+        ulib_int const next = i < 0 ? 0 : i + 2 - (i % 2);
+
+        if (next < 2 * TREE_ELEMENTS) {
+            utest_assert_int(*upper.key, ==, next);
+        } else {
+            utest_assert_ptr(upper.key, ==, NULL);
+        }
+
+        if (i >= 0 && i < 2 * TREE_ELEMENTS && i % 2 == 0) {
+            utest_assert_int(*found.key, ==, i);
+            utest_assert_int(*found.val, ==, 2 * i);
+        } else {
+            utest_assert_ptr(found.key, ==, NULL);
+        }
+    }
+
+    ulib_int const ranges[][2] = {
+        { 0, 2 * TREE_ELEMENTS }, { -5, 10 },   { 101, 999 }, { 500, 500 },
+        { 999, 101 },             { 9990, 20000 }, { 20000, 30000 },
+    };
+
+    for (ulib_uint r = 0; r < ulib_array_count(ranges); ++r) {
+        ulib_int const start = ranges[r][0], end = ranges[r][1];
+        ulib_int expected = start < 0 ? 0 : start + (start % 2);
+        ulib_uint count = 0;
+
+        ubtree_foreach_range (IntMap, &map, start, end, loop) {
+            utest_assert_int(*loop.key, ==, expected);
+            utest_assert_int(*loop.key, <, end);
+            expected += 2;
+            ++count;
+        }
+
+        ulib_int const last = end < 2 * TREE_ELEMENTS ? end : 2 * TREE_ELEMENTS;
+        ulib_int const first = start < 0 ? 0 : start + (start % 2);
+        ulib_uint const expected_count = last > first ? (ulib_uint)(last - first + 1) / 2 : 0;
+        utest_assert_uint(count, ==, expected_count);
+    }
+
+    ubtree_deinit(IntMap, &map);
+    return true;
+}
+
+bool ubtree_test_from_sorted(void) {
+    UBTree(IntMap) map = ubtree(IntMap);
+    UVec(ulib_int) keys = uvec(ulib_int);
+    UVec(ulib_int) vals = uvec(ulib_int);
+
+    // Element counts around node boundaries, including a bulk load replacing existing contents.
+    ulib_uint const counts[] = { 0, 1, 2, 63, 64, 65, 1000, 4097, 7000, 5 };
+
+    for (ulib_uint c = 0; c < ulib_array_count(counts); ++c) {
+        uvec_remove_all(ulib_int, &keys);
+        uvec_remove_all(ulib_int, &vals);
+
+        for (ulib_uint i = 0; i < counts[c]; ++i) {
+            utest_assert(uvec_push(ulib_int, &keys, 2 * (ulib_int)i) == UVEC_OK);
+            utest_assert(uvec_push(ulib_int, &vals, 4 * (ulib_int)i) == UVEC_OK);
+        }
+
+        ubtree_ret ret = ubtree_from_sorted(IntMap, &map, uvec_data(ulib_int, &keys),
+                                            uvec_data(ulib_int, &vals), counts[c]);
+        utest_assert(ret == UBTREE_OK);
+        utest_assert(map_matches(&map, &keys));
+
+        // The tree must remain fully functional after a bulk load.
+        ulib_int const key = (ulib_int)counts[c] | 1;
+        utest_assert(ubmap_set(IntMap, &map, key, 2 * key, NULL) == UBTREE_INSERTED);
+        utest_assert(uvec_insert_sorted_unique(ulib_int, &keys, key, NULL) == UVEC_OK);
+        utest_assert(map_matches(&map, &keys));
+
+        for (ulib_uint i = 0; i < uvec_count(ulib_int, &keys); i += 2) {
+            utest_assert(ubtree_remove(IntMap, &map, uvec_get(ulib_int, &keys, i)));
+        }
+
+        ulib_uint i = 0;
+        ubtree_foreach (IntMap, &map, loop) {
+            utest_assert_int(*loop.key, ==, uvec_get(ulib_int, &keys, 2 * i + 1));
+            ++i;
+        }
+        utest_assert_uint(i, ==, ubtree_count(IntMap, &map));
+    }
+
+    ubtree_deinit(IntMap, &map);
+    uvec_deinit(ulib_int, &keys);
+    uvec_deinit(ulib_int, &vals);
+    return true;
+}
@@ -0,0 +1,23 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UBTREE_TESTS_H
+#define UBTREE_TESTS_H
+
+#include "ustd.h"
+
+bool ubtree_test_base(void);
+bool ubtree_test_random(void);
+bool ubtree_test_range(void);
+bool ubtree_test_from_sorted(void);
+
+#define UBTREE_TESTS                                                                               \
+    ubtree_test_base, ubtree_test_random, ubtree_test_range, ubtree_test_from_sorted
+
+#endif // UBTREE_TESTS_H
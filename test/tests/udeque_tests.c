@@ -0,0 +1,122 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "udeque.h"
+#include "utest.h"
+
+typedef int32_t DqInt;
+UDEQUE_INIT(DqInt)
+
+bool udeque_test_base(void) {
+    UDeque(DqInt) dq = udeque(DqInt);
+    utest_assert_uint(udeque_count(DqInt, &dq), ==, 0);
+
+    for (DqInt i = 0; i < 100; ++i) {
+        utest_assert(udeque_push_back(DqInt, &dq, i) == ULIB_OK);
+        utest_assert(udeque_push_front(DqInt, &dq, -i - 1) == ULIB_OK);
+    }
+
+    utest_assert_uint(udeque_count(DqInt, &dq), ==, 200);
+    utest_assert_uint(udeque_size(DqInt, &dq), ==, 256);
+    utest_assert_int(udeque_first(DqInt, &dq), ==, -100);
+    utest_assert_int(udeque_last(DqInt, &dq), ==, 99);
+
+    for (ulib_uint i = 0; i < 200; ++i) {
+        utest_assert_int(udeque_get(DqInt, &dq, i), ==, (DqInt)i - 100);
+    }
+
+    udeque_set(DqInt, &dq, 100, 42);
+    utest_assert_int(udeque_get(DqInt, &dq, 100), ==, 42);
+
+    // Sliding window: the deque wraps around without growing.
+    for (DqInt i = 0; i < 1000; ++i) {
+        udeque_pop_front(DqInt, &dq);
+        utest_assert(udeque_push_back(DqInt, &dq, i) == ULIB_OK);
+    }
+
+    utest_assert_uint(udeque_size(DqInt, &dq), ==, 256);
+    utest_assert_int(udeque_first(DqInt, &dq), ==, 800);
+    utest_assert_int(udeque_pop_back(DqInt, &dq), ==, 999);
+    utest_assert_int(udeque_pop_front(DqInt, &dq), ==, 800);
+    utest_assert_uint(udeque_count(DqInt, &dq), ==, 198);
+
+    udeque_remove_all(DqInt, &dq);
+    utest_assert_uint(udeque_count(DqInt, &dq), ==, 0);
+
+    udeque_deinit(DqInt, &dq);
+    return true;
+}
+
+bool udeque_test_bulk(void) {
+    UDeque(DqInt) dq = udeque(DqInt);
+    DqInt items[50], out[50];
+    for (DqInt i = 0; i < 50; ++i) items[i] = i;
+
+    // Offset the head so that bulk operations wrap around.
+    utest_assert(udeque_reserve(DqInt, &dq, 64) == ULIB_OK);
+    utest_assert(udeque_push_back_array(DqInt, &dq, items, 40) == ULIB_OK);
+    utest_assert_uint(udeque_pop_front_array(DqInt, &dq, out, 40), ==, 40);
+    utest_assert(udeque_push_back_array(DqInt, &dq, items, 50) == ULIB_OK);
+    utest_assert_uint(udeque_size(DqInt, &dq), ==, 64);
+
+    ulib_uint first, second;
+    DqInt *front = udeque_front_span(DqInt, &dq, &first);
+    DqInt *back = udeque_back_span(DqInt, &dq, &second);
+    utest_assert_uint(first, ==, 24);
+    utest_assert_uint(second, ==, 26);
+    utest_assert_int(front[0], ==, 0);
+    utest_assert_int(back[0], ==, 24);
+
+    ulib_uint free_n;
+    DqInt *slots = udeque_free_span(DqInt, &dq, &free_n);
+    utest_assert_uint(free_n, ==, 14);
+    for (ulib_uint i = 0; i < free_n; ++i) slots[i] = 50 + (DqInt)i;
+    udeque_commit_back(DqInt, &dq, free_n);
+    utest_assert_uint(udeque_count(DqInt, &dq), ==, 64);
+    utest_assert_int(udeque_last(DqInt, &dq), ==, 63);
+
+    // Growing linearizes the elements.
+    utest_assert(udeque_push_back(DqInt, &dq, 64) == ULIB_OK);
+    front = udeque_front_span(DqInt, &dq, &first);
+    udeque_back_span(DqInt, &dq, &second);
+    utest_assert_uint(first, ==, 65);
+    utest_assert_uint(second, ==, 0);
+    for (DqInt i = 0; i < 65; ++i) utest_assert_int(front[i], ==, i);
+
+    udeque_consume_front(DqInt, &dq, 10);
+    utest_assert_uint(udeque_pop_front_array(DqInt, &dq, out, 50), ==, 50);
+    utest_assert_int(out[0], ==, 10);
+    utest_assert_int(out[49], ==, 59);
+    utest_assert_uint(udeque_pop_front_array(DqInt, &dq, out, 50), ==, 5);
+    utest_assert_uint(udeque_count(DqInt, &dq), ==, 0);
+
+    udeque_deinit(DqInt, &dq);
+    return true;
+}
+
+bool udeque_test_fixed(void) {
+    DqInt buffer[10];
+    UDeque(DqInt) dq = udeque_with_buffer(DqInt, buffer, ulib_array_count(buffer));
+    utest_assert_uint(udeque_size(DqInt, &dq), ==, 8);
+
+    for (DqInt i = 0; i < 8; ++i) {
+        utest_assert(udeque_push_front(DqInt, &dq, i) == ULIB_OK);
+    }
+
+    utest_assert(udeque_push_back(DqInt, &dq, 8) == ULIB_ERR);
+    utest_assert(udeque_reserve(DqInt, &dq, 9) == ULIB_ERR);
+    utest_assert_int(udeque_pop_back(DqInt, &dq), ==, 0);
+    utest_assert(udeque_push_back(DqInt, &dq, 8) == ULIB_OK);
+    utest_assert_int(udeque_first(DqInt, &dq), ==, 7);
+    utest_assert_int(udeque_last(DqInt, &dq), ==, 8);
+
+    udeque_deinit(DqInt, &dq);
+    utest_assert_uint(udeque_size(DqInt, &dq), ==, 8);
+    return true;
+}
@@ -0,0 +1,21 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UDEQUE_TESTS_H
+#define UDEQUE_TESTS_H
+
+#include "ustd.h"
+
+bool udeque_test_base(void);
+bool udeque_test_bulk(void);
+bool udeque_test_fixed(void);
+
+#define UDEQUE_TESTS udeque_test_base, udeque_test_bulk, udeque_test_fixed
+
+#endif // UDEQUE_TESTS_H
@@ -8,12 +8,31 @@
  */
 
 #include "uhash.h"
+#include "userial.h"
+#include "ustring.h"
 #include "utest.h"
+#include "uthread.h"
 
 #define MAX_VAL 100
 
+// Valid, but only ever produces 7 distinct hashes.
+static inline ulib_uint weak_hash(uint32_t key) {
+    return key % 7;
+}
+
 UHASH_INIT(IntHash, uint32_t, uint32_t, uhash_int32_hash, uhash_identical)
 UHASH_INIT_PI(IntHashPi, uint32_t, uint32_t, NULL, NULL)
+UHASH_INIT_SIMD(IntHashSimd, uint32_t, uint32_t, uhash_int32_hash, uhash_identical)
+UHASH_INIT_CACHED_HASH(StrHashCached, UString, ulib_uint, ustring_hash, ustring_equals)
+UHASH_INIT_INCREMENTAL(IntHashInc, uint32_t, uint32_t, uhash_int32_hash, uhash_identical)
+UHASH_INIT_COMPACT(IntHashCompact, uint32_t, uint32_t, uhash_int32_hash, uhash_identical, 0.1, 0.2)
+UHASH_INIT_LOAD(IntHashSparse, uint32_t, uint32_t, uhash_int32_hash, uhash_identical, 0.5)
+UHASH_INIT_ROBIN_HOOD(IntHashRh, uint32_t, uint32_t, uhash_int32_hash, uhash_identical, 0.9)
+UHASH_INIT_ROBIN_HOOD(IntHashRhWeak, uint32_t, uint32_t, weak_hash, uhash_identical, 0.9)
+UHASH_INIT_INTERLEAVED(IntHashSlot, uint32_t, uint32_t, uhash_int32_hash, uhash_identical)
+UHASH_INIT_CONCURRENT(IntHashConc, uint32_t, uint32_t, uhash_int32_hash, uhash_identical)
+UHASH_INIT_SERIAL(IntHash)
+UHASH_INIT_SERIAL(IntHashPi)
 
 static ulib_uint int32_hash(uint32_t num) {
     return uhash_int32_hash(num);
@@ -232,3 +251,624 @@ bool uhash_test_per_instance(void) {
     uhash_deinit(IntHashPi, &map);
     return true;
 }
+
+bool uhash_test_simd(void) {
+    UHash(IntHashSimd) map = uhmap(IntHashSimd);
+    uint32_t const max = MAX_VAL * 10;
+
+    for (uint32_t i = 0; i < max; ++i) {
+        utest_assert(uhmap_set(IntHashSimd, &map, i, i, NULL) == UHASH_INSERTED);
+    }
+
+    utest_assert_uint(uhash_count(IntHashSimd, &map), ==, max);
+    utest_assert(uhmap_add(IntHashSimd, &map, 0, 1, NULL) == UHASH_PRESENT);
+    utest_assert(uhash_get(IntHashSimd, &map, max) == UHASH_INDEX_MISSING);
+
+    for (uint32_t i = 0; i < max; ++i) {
+        utest_assert_uint(uhmap_get(IntHashSimd, &map, i, UINT32_MAX), ==, i);
+    }
+
+    for (uint32_t i = 0; i < max; i += 2) {
+        utest_assert(uhmap_remove(IntHashSimd, &map, i));
+    }
+
+    ulib_uint count = 0;
+    uhash_foreach (IntHashSimd, &map, e) {
+        utest_assert_uint(*e.key % 2, ==, 1);
+        utest_assert_uint(*e.val, ==, *e.key);
+        count++;
+    }
+    utest_assert_uint(count, ==, max / 2);
+
+    // Reinsertions should reuse deleted buckets.
+    ulib_uint const size = uhash_size(IntHashSimd, &map);
+    for (uint32_t n = 0; n < 4; ++n) {
+        for (uint32_t i = 0; i < max; i += 2) {
+            utest_assert(uhmap_set(IntHashSimd, &map, i, i, NULL) == UHASH_INSERTED);
+        }
+        for (uint32_t i = 0; i < max; i += 2) {
+            utest_assert(uhmap_remove(IntHashSimd, &map, i));
+        }
+    }
+    utest_assert_uint(uhash_size(IntHashSimd, &map), ==, size);
+
+    UHash(IntHashSimd) set = uhset(IntHashSimd);
+    utest_assert(uhash_copy_as_set(IntHashSimd, &map, &set) == UHASH_OK);
+    utest_assert(uhset_equals(IntHashSimd, &set, &map));
+    utest_assert_false(uhash_is_map(IntHashSimd, &set));
+
+    uhash_clear(IntHashSimd, &map);
+    utest_assert_uint(uhash_count(IntHashSimd, &map), ==, 0);
+    utest_assert(uhash_get(IntHashSimd, &map, 1) == UHASH_INDEX_MISSING);
+    utest_assert(uhset_union(IntHashSimd, &map, &set) == UHASH_OK);
+    utest_assert(uhset_equals(IntHashSimd, &set, &map));
+
+    uhash_deinit(IntHashSimd, &set);
+    uhash_deinit(IntHashSimd, &map);
+    return true;
+}
+
+bool uhash_test_cached_hash(void) {
+    UHash(StrHashCached) map = uhmap(StrHashCached);
+    UString keys[MAX_VAL];
+
+    for (ulib_uint i = 0; i < MAX_VAL; ++i) {
+        keys[i] = ustring_with_format("key_%" ULIB_UINT_FMT, i);
+        utest_assert(uhmap_set(StrHashCached, &map, keys[i], i, NULL) == UHASH_INSERTED);
+    }
+
+    utest_assert_uint(uhash_count(StrHashCached, &map), ==, MAX_VAL);
+    utest_assert(uhmap_add(StrHashCached, &map, keys[0], 1, NULL) == UHASH_PRESENT);
+    utest_assert_false(uhash_contains(StrHashCached, &map, ustring_literal("missing")));
+
+    for (ulib_uint i = 0; i < MAX_VAL; ++i) {
+        utest_assert_uint(uhmap_get(StrHashCached, &map, keys[i], MAX_VAL), ==, i);
+    }
+
+    UHash(StrHashCached) set = uhset(StrHashCached);
+    utest_assert(uhash_copy_as_set(StrHashCached, &map, &set) == UHASH_OK);
+    utest_assert(uhset_equals(StrHashCached, &set, &map));
+
+    for (ulib_uint i = 0; i < MAX_VAL; i += 2) {
+        utest_assert(uhmap_remove(StrHashCached, &map, keys[i]));
+    }
+
+    utest_assert_uint(uhash_count(StrHashCached, &map), ==, MAX_VAL / 2);
+    utest_assert(uhash_resize(StrHashCached, &map, MAX_VAL) == UHASH_OK);
+
+    for (ulib_uint i = 0; i < MAX_VAL; ++i) {
+        ulib_uint val = uhmap_get(StrHashCached, &map, keys[i], MAX_VAL);
+        utest_assert_uint(val, ==, i % 2 ? i : MAX_VAL);
+    }
+
+    uhash_deinit(StrHashCached, &set);
+    uhash_deinit(StrHashCached, &map);
+    for (ulib_uint i = 0; i < MAX_VAL; ++i) ustring_deinit(&keys[i]);
+    return true;
+}
+
+bool uhash_test_incremental(void) {
+    UHash(IntHashInc) map = uhmap(IntHashInc);
+    uint32_t const max = MAX_VAL * 10;
+    bool migrated = false;
+
+    for (uint32_t i = 0; i < max; ++i) {
+        utest_assert(uhmap_set(IntHashInc, &map, i, i, NULL) == UHASH_INSERTED);
+        if (map._old_size) migrated = true;
+
+        // All keys must be reachable while a migration is in progress.
+        for (uint32_t j = 0; j <= i; j += 7) {
+            utest_assert_uint(uhmap_get(IntHashInc, &map, j, UINT32_MAX), ==, j);
+        }
+    }
+
+    utest_assert(migrated);
+    utest_assert_uint(uhash_count(IntHashInc, &map), ==, max);
+    utest_assert(uhmap_add(IntHashInc, &map, 0, 1, NULL) == UHASH_PRESENT);
+    utest_assert(uhash_get(IntHashInc, &map, max) == UHASH_INDEX_MISSING);
+
+    UHash(IntHashInc) copy = uhmap(IntHashInc);
+    utest_assert(uhash_copy(IntHashInc, &map, &copy) == UHASH_OK);
+    utest_assert(uhset_equals(IntHashInc, &copy, &map));
+
+    for (uint32_t i = 0; i < max; i += 2) {
+        utest_assert(uhmap_remove(IntHashInc, &map, i));
+    }
+
+    ulib_uint count = 0;
+    uhash_foreach (IntHashInc, &map, e) {
+        utest_assert_uint(*e.key % 2, ==, 1);
+        utest_assert_uint(*e.val, ==, *e.key);
+        count++;
+    }
+    utest_assert_uint(count, ==, max / 2);
+
+    utest_assert(uhash_resize(IntHashInc, &copy, max * 2) == UHASH_OK);
+    utest_assert_uint(copy._old_size, ==, 0);
+    utest_assert_uint(uhash_count(IntHashInc, &copy), ==, max);
+
+    for (uint32_t i = 0; i < max; ++i) {
+        utest_assert_uint(uhmap_get(IntHashInc, &copy, i, UINT32_MAX), ==, i);
+    }
+
+    uhash_clear(IntHashInc, &map);
+    utest_assert_uint(uhash_count(IntHashInc, &map), ==, 0);
+    utest_assert(uhash_get(IntHashInc, &map, 1) == UHASH_INDEX_MISSING);
+
+    uhash_deinit(IntHashInc, &copy);
+    uhash_deinit(IntHashInc, &map);
+    return true;
+}
+
+bool uhash_test_compaction(void) {
+    UHash(IntHashCompact) set = uhset(IntHashCompact);
+    uint32_t const max = MAX_VAL * 10;
+
+    for (uint32_t i = 0; i < max; ++i) {
+        utest_assert(uhset_insert(IntHashCompact, &set, i) == UHASH_INSERTED);
+    }
+
+    ulib_uint const size = uhash_size(IntHashCompact, &set);
+
+    // Deleted buckets are cleared during deletion.
+    for (uint32_t i = 0; i < max / 2; ++i) {
+        utest_assert(uhset_remove(IntHashCompact, &set, i));
+        utest_assert_uint(set._occupied - set._count, <=, (ulib_uint)(size * 0.2) + 1);
+    }
+
+    // Tables shrink when their load factor is low enough.
+    for (uint32_t i = max / 2; i < max - 10; ++i) {
+        utest_assert(uhset_remove(IntHashCompact, &set, i));
+    }
+
+    utest_assert_uint(uhash_size(IntHashCompact, &set), <, size);
+    utest_assert_uint(uhash_count(IntHashCompact, &set), ==, 10);
+
+    for (uint32_t i = max - 10; i < max; ++i) {
+        utest_assert(uhash_contains(IntHashCompact, &set, i));
+    }
+
+    uhash_deinit(IntHashCompact, &set);
+
+    UHash(IntHashPi) map = uhmap_pi(IntHashPi, int32_hash, int32_eq);
+    uhash_set_compaction(IntHashPi, &map, 0.1, 0);
+
+    for (uint32_t i = 0; i < max; ++i) {
+        utest_assert(uhmap_set(IntHashPi, &map, i, i, NULL) == UHASH_INSERTED);
+    }
+
+    for (uint32_t i = 0; i < max - 10; ++i) {
+        utest_assert(uhmap_remove(IntHashPi, &map, i));
+    }
+
+    utest_assert_uint(uhash_size(IntHashPi, &map), <, size);
+
+    for (uint32_t i = max - 10; i < max; ++i) {
+        utest_assert_uint(uhmap_get(IntHashPi, &map, i, UINT32_MAX), ==, i);
+    }
+
+    uhash_deinit(IntHashPi, &map);
+    return true;
+}
+
+bool uhash_test_batch(void) {
+    UHash(IntHash) map = uhmap(IntHash);
+    uint32_t keys[MAX_VAL], vals[MAX_VAL];
+    uhash_ret rets[MAX_VAL];
+    ulib_uint idx[MAX_VAL];
+
+    for (uint32_t i = 0; i < MAX_VAL; ++i) {
+        keys[i] = i;
+        vals[i] = i * 2;
+    }
+
+    utest_assert(uhmap_set_batch(IntHash, &map, keys, vals, MAX_VAL / 2, rets) == UHASH_INSERTED);
+    utest_assert(uhmap_set_batch(IntHash, &map, keys, vals, MAX_VAL, rets) == UHASH_INSERTED);
+
+    for (uint32_t i = 0; i < MAX_VAL; ++i) {
+        utest_assert(rets[i] == (i < MAX_VAL / 2 ? UHASH_PRESENT : UHASH_INSERTED));
+    }
+
+    utest_assert(uhmap_set_batch(IntHash, &map, keys, vals, MAX_VAL, NULL) == UHASH_PRESENT);
+    utest_assert_uint(uhash_count(IntHash, &map), ==, MAX_VAL);
+
+    keys[MAX_VAL - 1] = MAX_VAL;
+    uhash_get_batch(IntHash, &map, keys, MAX_VAL, idx);
+
+    for (uint32_t i = 0; i < MAX_VAL - 1; ++i) {
+        utest_assert(idx[i] != UHASH_INDEX_MISSING);
+        utest_assert_uint(uhash_value(IntHash, &map, idx[i]), ==, i * 2);
+    }
+
+    utest_assert(idx[MAX_VAL - 1] == UHASH_INDEX_MISSING);
+
+    UHash(IntHashSimd) set = uhset(IntHashSimd);
+    utest_assert(uhset_insert_batch(IntHashSimd, &set, keys, MAX_VAL, rets) == UHASH_INSERTED);
+    utest_assert(uhset_insert_batch(IntHashSimd, &set, keys, MAX_VAL, NULL) == UHASH_PRESENT);
+    utest_assert_uint(uhash_count(IntHashSimd, &set), ==, MAX_VAL);
+
+    uhash_get_batch(IntHashSimd, &set, keys, MAX_VAL, idx);
+
+    for (uint32_t i = 0; i < MAX_VAL; ++i) {
+        utest_assert(rets[i] == UHASH_INSERTED);
+        utest_assert(idx[i] != UHASH_INDEX_MISSING);
+        utest_assert_uint(uhash_key(IntHashSimd, &set, idx[i]), ==, keys[i]);
+    }
+
+    uhash_deinit(IntHashSimd, &set);
+    uhash_deinit(IntHash, &map);
+    return true;
+}
+
+bool uhash_test_from_array(void) {
+    uint32_t keys[MAX_VAL * 2], vals[MAX_VAL * 2];
+
+    // Every key appears twice, the second time with a different value.
+    for (uint32_t i = 0; i < MAX_VAL * 2; ++i) {
+        keys[i] = i % MAX_VAL;
+        vals[i] = i;
+    }
+
+    UHash(IntHash) map = uhmap(IntHash);
+    utest_assert(uhmap_set(IntHash, &map, MAX_VAL, 0, NULL) == UHASH_INSERTED);
+    utest_assert(uhmap_from_arrays(IntHash, &map, keys, vals, MAX_VAL * 2) == UHASH_OK);
+    utest_assert_uint(uhash_count(IntHash, &map), ==, MAX_VAL);
+    utest_assert_false(uhash_contains(IntHash, &map, MAX_VAL));
+
+    for (uint32_t i = 0; i < MAX_VAL; ++i) {
+        utest_assert_uint(uhmap_get(IntHash, &map, i, 0), ==, i + MAX_VAL);
+    }
+
+    UHash(IntHashSimd) set = uhset(IntHashSimd);
+    utest_assert(uhset_from_array(IntHashSimd, &set, keys, MAX_VAL * 2) == UHASH_OK);
+    utest_assert_uint(uhash_count(IntHashSimd, &set), ==, MAX_VAL);
+
+    for (uint32_t i = 0; i < MAX_VAL; ++i) {
+        utest_assert(uhash_contains(IntHashSimd, &set, i));
+    }
+
+    utest_assert(uhset_from_array(IntHashSimd, &set, NULL, 0) == UHASH_OK);
+    utest_assert_uint(uhash_count(IntHashSimd, &set), ==, 0);
+
+    uhash_deinit(IntHashSimd, &set);
+    uhash_deinit(IntHash, &map);
+    return true;
+}
+
+bool uhash_test_load(void) {
+    UHash(IntHash) dense = uhmap(IntHash);
+    UHash(IntHashSparse) sparse = uhmap(IntHashSparse);
+
+    for (uint32_t i = 0; i < 90; ++i) {
+        utest_assert(uhmap_set(IntHash, &dense, i, i, NULL) == UHASH_INSERTED);
+        utest_assert(uhmap_set(IntHashSparse, &sparse, i, i, NULL) == UHASH_INSERTED);
+    }
+
+    // 90 keys fit in 128 buckets at the default load factor, but not at 0.5.
+    utest_assert_uint(uhash_size(IntHash, &dense), ==, 128);
+    utest_assert_uint(uhash_size(IntHashSparse, &sparse), ==, 256);
+
+    for (uint32_t i = 0; i < 90; ++i) {
+        utest_assert_uint(uhmap_get(IntHashSparse, &sparse, i, UINT32_MAX), ==, i);
+    }
+
+    uhash_deinit(IntHashSparse, &sparse);
+    uhash_deinit(IntHash, &dense);
+    return true;
+}
+
+bool uhash_test_robin_hood(void) {
+    UHash(IntHashRh) map = uhmap(IntHashRh);
+    uint32_t const max = MAX_VAL * 9;
+
+    for (uint32_t i = 0; i < max; ++i) {
+        utest_assert(uhmap_set(IntHashRh, &map, i * 7, i, NULL) == UHASH_INSERTED);
+    }
+
+    utest_assert_uint(uhash_count(IntHashRh, &map), ==, max);
+    utest_assert(uhmap_add(IntHashRh, &map, 0, 1, NULL) == UHASH_PRESENT);
+    utest_assert(uhash_get(IntHashRh, &map, 1) == UHASH_INDEX_MISSING);
+    // 900 keys fit in 1024 buckets at a 0.9 load factor.
+    utest_assert_uint(uhash_size(IntHashRh, &map), ==, 1024);
+
+    for (uint32_t i = 0; i < max; ++i) {
+        utest_assert_uint(uhmap_get(IntHashRh, &map, i * 7, UINT32_MAX), ==, i);
+    }
+
+    // Deletions must not leave tombstones behind.
+    for (uint32_t i = 0; i < max; i += 2) {
+        utest_assert(uhmap_remove(IntHashRh, &map, i * 7));
+    }
+
+    ulib_uint count = 0;
+    uhash_foreach (IntHashRh, &map, e) {
+        utest_assert_uint(*e.key % 2, ==, 1);
+        utest_assert_uint(*e.val * 7, ==, *e.key);
+        count++;
+    }
+    utest_assert_uint(count, ==, max / 2);
+
+    for (uint32_t i = 0; i < max; ++i) {
+        utest_assert_uint(uhmap_get(IntHashRh, &map, i * 7, UINT32_MAX), ==,
+                          i % 2 ? i : UINT32_MAX);
+    }
+
+    UHash(IntHashRh) set = uhset(IntHashRh);
+    for (uint32_t i = 0; i < max; i += 4) {
+        utest_assert(uhset_insert(IntHashRh, &set, i * 7 + 7) == UHASH_INSERTED);
+    }
+
+    uhset_intersect(IntHashRh, &map, &set);
+    utest_assert_uint(uhash_count(IntHashRh, &map), ==, max / 4);
+    utest_assert(uhset_equals(IntHashRh, &map, &set));
+
+    UHash(IntHashRh) copy = uhmap(IntHashRh);
+    utest_assert(uhash_copy(IntHashRh, &map, &copy) == UHASH_OK);
+    utest_assert(uhset_equals(IntHashRh, &copy, &map));
+    utest_assert_uint(uhmap_get(IntHashRh, &copy, 7, UINT32_MAX), ==, 1);
+
+    uhash_clear(IntHashRh, &map);
+    utest_assert_uint(uhash_count(IntHashRh, &map), ==, 0);
+    utest_assert(uhash_get(IntHashRh, &map, 7) == UHASH_INDEX_MISSING);
+
+    uhash_deinit(IntHashRh, &copy);
+    uhash_deinit(IntHashRh, &set);
+    uhash_deinit(IntHashRh, &map);
+    return true;
+}
+
+bool uhash_test_robin_hood_clustered(void) {
+    UHash(IntHashRh) map = uhmap(IntHashRh);
+
+    // Keys that only differ in their high bits must not cluster in the low buckets.
+    for (uint32_t i = 0; i < 300; ++i) {
+        utest_assert(uhmap_set(IntHashRh, &map, i << 20U, i, NULL) == UHASH_INSERTED);
+    }
+
+    utest_assert_uint(uhash_size(IntHashRh, &map), ==, 512);
+
+    for (uint32_t i = 0; i < 300; ++i) {
+        utest_assert_uint(uhmap_get(IntHashRh, &map, i << 20U, UINT32_MAX), ==, i);
+    }
+
+    // Weak hash functions lead to long probe sequences, not to unbounded growth.
+    UHash(IntHashRhWeak) weak = uhmap(IntHashRhWeak);
+
+    for (uint32_t i = 0; i < 2000; ++i) {
+        utest_assert(uhmap_set(IntHashRhWeak, &weak, i, i, NULL) == UHASH_INSERTED);
+    }
+
+    utest_assert_uint(uhash_size(IntHashRhWeak, &weak), ==, 4096);
+
+    for (uint32_t i = 0; i < 2000; i += 3) {
+        utest_assert(uhmap_remove(IntHashRhWeak, &weak, i));
+    }
+
+    for (uint32_t i = 0; i < 2000; ++i) {
+        utest_assert_uint(uhmap_get(IntHashRhWeak, &weak, i, UINT32_MAX), ==,
+                          i % 3 ? i : UINT32_MAX);
+    }
+
+    uhash_deinit(IntHashRhWeak, &weak);
+    uhash_deinit(IntHashRh, &map);
+    return true;
+}
+
+bool uhash_test_str_hash(void) {
+    char const *str = "Hash tables hash strings all the way through, not only in samples.";
+    UString a = ustring_copy(str, strlen(str));
+    UString b = ustring_dup(a);
+    utest_assert_uint(ustring_hash(a), ==, ustring_hash(b));
+    utest_assert_uint(ustring_hash(a), ==, uhash_str_hash(str));
+
+    // Strings that only differ outside of the sampled ranges of the x31 hash.
+    char buf_a[256], buf_b[256];
+    memset(buf_a, 'a', sizeof(buf_a));
+    memset(buf_b, 'a', sizeof(buf_b));
+    buf_b[40] = 'b';
+    utest_assert_uint(uhash_bytes_hash(buf_a, sizeof(buf_a)), !=,
+                      uhash_bytes_hash(buf_b, sizeof(buf_b)));
+
+    for (size_t len = 1; len < sizeof(buf_a); ++len) {
+        utest_assert_uint(uhash_bytes_hash(buf_a, len), !=, uhash_bytes_hash(buf_a, len - 1));
+    }
+
+    utest_assert_uint(uhash_bytes_hash_seeded(str, strlen(str), 1), !=,
+                      uhash_bytes_hash_seeded(str, strlen(str), 2));
+
+    ulib_uint const hash = ustring_hash(a);
+    uint64_t const seed = uhash_get_seed();
+    uhash_set_seed(seed + 1);
+    utest_assert_uint(uhash_get_seed(), ==, seed + 1);
+    utest_assert_uint(ustring_hash(a), !=, hash);
+    utest_assert_uint(ustring_hash(a), ==, uhash_bytes_hash_seeded(str, strlen(str), seed + 1));
+    uhash_set_seed(seed);
+    utest_assert_uint(ustring_hash(a), ==, hash);
+
+    ustring_deinit(&a);
+    ustring_deinit(&b);
+    return true;
+}
+
+bool uhash_test_interleaved(void) {
+    UHash(IntHashSlot) map = uhmap(IntHashSlot);
+    uint32_t const max = MAX_VAL * 10;
+
+    for (uint32_t i = 0; i < max; ++i) {
+        utest_assert(uhmap_set(IntHashSlot, &map, i, i * 2, NULL) == UHASH_INSERTED);
+    }
+
+    utest_assert_uint(uhash_count(IntHashSlot, &map), ==, max);
+    utest_assert(uhash_is_map(IntHashSlot, &map));
+    utest_assert(uhash_get(IntHashSlot, &map, max) == UHASH_INDEX_MISSING);
+
+    for (uint32_t i = 0; i < max; ++i) {
+        utest_assert_uint(uhmap_get(IntHashSlot, &map, i, UINT32_MAX), ==, i * 2);
+    }
+
+    for (uint32_t i = 0; i < max; i += 2) {
+        utest_assert(uhmap_remove(IntHashSlot, &map, i));
+    }
+
+    ulib_uint count = 0;
+    uhash_foreach (IntHashSlot, &map, e) {
+        utest_assert_uint(*e.key % 2, ==, 1);
+        utest_assert_uint(*e.val, ==, *e.key * 2);
+        count++;
+    }
+    utest_assert_uint(count, ==, max / 2);
+
+    UHash(IntHashSlot) copy = uhmap(IntHashSlot);
+    utest_assert(uhash_copy(IntHashSlot, &map, &copy) == UHASH_OK);
+    utest_assert(uhset_equals(IntHashSlot, &copy, &map));
+    utest_assert_uint(uhmap_get(IntHashSlot, &copy, 1, UINT32_MAX), ==, 2);
+
+    uhash_clear(IntHashSlot, &map);
+    utest_assert_uint(uhash_count(IntHashSlot, &map), ==, 0);
+    utest_assert(uhset_union(IntHashSlot, &map, &copy) == UHASH_OK);
+    utest_assert(uhset_equals(IntHashSlot, &copy, &map));
+
+    uhash_deinit(IntHashSlot, &copy);
+    uhash_deinit(IntHashSlot, &map);
+    return true;
+}
+
+#define CONC_THREADS 4
+#define CONC_KEYS 1000
+
+typedef struct ConcCtx {
+    UHash(IntHashConc) *map;
+    uint32_t first;
+    bool ok;
+} ConcCtx;
+
+static void conc_worker(void *arg) {
+    ConcCtx *ctx = (ConcCtx *)arg;
+    uint32_t const last = ctx->first + CONC_KEYS;
+
+    for (uint32_t i = ctx->first; i < last; ++i) {
+        if (uhmap_set(IntHashConc, ctx->map, i, i * 2, NULL) != UHASH_INSERTED) ctx->ok = false;
+    }
+
+    for (uint32_t i = ctx->first; i < last; ++i) {
+        if (uhmap_get(IntHashConc, ctx->map, i, UINT32_MAX) != i * 2) ctx->ok = false;
+        if (i % 2 && !uhmap_remove(IntHashConc, ctx->map, i)) ctx->ok = false;
+    }
+}
+
+bool uhash_test_concurrent(void) {
+    UHash(IntHashConc) map = uhmap(IntHashConc);
+    UThread threads[CONC_THREADS];
+    ConcCtx ctx[CONC_THREADS];
+
+    for (uint32_t i = 0; i < CONC_THREADS; ++i) {
+        ctx[i].map = &map;
+        ctx[i].first = i * CONC_KEYS;
+        ctx[i].ok = true;
+        utest_assert(uthread_start(&threads[i], conc_worker, &ctx[i]) == ULIB_OK);
+    }
+
+    for (uint32_t i = 0; i < CONC_THREADS; ++i) {
+        utest_assert(uthread_join(&threads[i]) == ULIB_OK);
+        utest_assert(ctx[i].ok);
+    }
+
+    utest_assert_uint(uhash_count(IntHashConc, &map), ==, CONC_THREADS * CONC_KEYS / 2);
+
+    for (uint32_t i = 0; i < CONC_THREADS * CONC_KEYS; ++i) {
+        utest_assert(uhash_contains(IntHashConc, &map, i) == !(i % 2));
+    }
+
+    uint32_t val;
+    utest_assert(uhmap_add(IntHashConc, &map, 0, 1, &val) == UHASH_PRESENT);
+    utest_assert_uint(val, ==, 0);
+    utest_assert(uhmap_replace(IntHashConc, &map, 0, 1, &val));
+    utest_assert_uint(uhmap_get(IntHashConc, &map, 0, UINT32_MAX), ==, 1);
+    utest_assert_false(uhmap_replace(IntHashConc, &map, 1, 1, NULL));
+
+    // Existing elements are only reported for keys that were already present.
+    val = UINT32_MAX;
+    utest_assert(uhmap_set(IntHashConc, &map, 1, 2, &val) == UHASH_INSERTED);
+    utest_assert_uint(val, ==, UINT32_MAX);
+    utest_assert(uhmap_set(IntHashConc, &map, 1, 3, &val) == UHASH_PRESENT);
+    utest_assert_uint(val, ==, 2);
+
+    uint32_t key = UINT32_MAX;
+    utest_assert(uhset_insert_get_existing(IntHashConc, &map, 3, &key) == UHASH_INSERTED);
+    utest_assert_uint(key, ==, UINT32_MAX);
+    utest_assert(uhset_insert_get_existing(IntHashConc, &map, 3, &key) == UHASH_PRESENT);
+    utest_assert_uint(key, ==, 3);
+
+    uhash_clear(IntHashConc, &map);
+    utest_assert_uint(uhash_count(IntHashConc, &map), ==, 0);
+
+    uhash_deinit(IntHashConc, &map);
+    return true;
+}
+
+bool uhash_test_serial(void) {
+    UHash(IntHash) map = uhmap(IntHash);
+    UHash(IntHash) set = uhset(IntHash);
+
+    for (uint32_t i = 0; i < MAX_VAL; ++i) {
+        utest_assert(uhmap_set(IntHash, &map, i, i * 2, NULL) == UHASH_INSERTED);
+        utest_assert(uhset_insert(IntHash, &set, i * 3) == UHASH_INSERTED);
+    }
+    utest_assert(uhmap_remove(IntHash, &map, 0));
+
+    UStrBuf buf = ustrbuf();
+    UOStream out;
+    utest_assert(uostream_to_strbuf(&out, &buf) == USTREAM_OK);
+    utest_assert(uhash_write(IntHash, &map, &out) == USTREAM_OK);
+    utest_assert(uhash_write(IntHash, &set, &out) == USTREAM_OK);
+    UHash(IntHash) empty = uhmap(IntHash);
+    utest_assert(uhash_write(IntHash, &empty, &out) == USTREAM_OK);
+    uostream_deinit(&out);
+
+    // Tables are read with their bucket layout, including deleted buckets.
+    UIStream in;
+    utest_assert(uistream_from_strbuf(&in, &buf) == USTREAM_OK);
+    UHash(IntHash) rmap = uhset(IntHash);
+    utest_assert(uhset_insert(IntHash, &rmap, 1000) == UHASH_INSERTED);
+    utest_assert(uhash_read(IntHash, &rmap, &in) == USTREAM_OK);
+    utest_assert(uhash_is_map(IntHash, &rmap));
+    utest_assert_uint(uhash_count(IntHash, &rmap), ==, MAX_VAL - 1);
+    utest_assert_uint(uhash_size(IntHash, &rmap), ==, uhash_size(IntHash, &map));
+    utest_assert_false(uhash_contains(IntHash, &rmap, 0));
+    utest_assert_false(uhash_contains(IntHash, &rmap, 1000));
+
+    for (uint32_t i = 1; i < MAX_VAL; ++i) {
+        utest_assert_uint(uhmap_get(IntHash, &rmap, i, UINT32_MAX), ==, i * 2);
+    }
+    utest_assert(uhmap_set(IntHash, &rmap, 0, 0, NULL) == UHASH_INSERTED);
+
+    UHash(IntHashPi) rset = uhset_pi(IntHashPi, int32_hash, int32_eq);
+    utest_assert(uhash_read(IntHashPi, &rset, &in) == USTREAM_OK);
+    utest_assert_false(uhash_is_map(IntHashPi, &rset));
+    utest_assert_uint(uhash_count(IntHashPi, &rset), ==, MAX_VAL);
+    for (uint32_t i = 0; i < MAX_VAL; ++i) {
+        utest_assert(uhash_contains(IntHashPi, &rset, i * 3));
+    }
+
+    utest_assert(uhash_read(IntHash, &empty, &in) == USTREAM_OK);
+    utest_assert(uhash_is_map(IntHash, &empty));
+    utest_assert_uint(uhash_count(IntHash, &empty), ==, 0);
+
+    // Reading past the end of the stream or invalid data fails, leaving the table untouched.
+    utest_assert(uhash_read(IntHash, &rmap, &in) == USTREAM_ERR_BOUNDS);
+    uistream_deinit(&in);
+
+    char invalid[64] = { 0 };
+    utest_assert(uistream_from_buf(&in, invalid, sizeof(invalid)) == USTREAM_OK);
+    utest_assert(uhash_read(IntHash, &rmap, &in) == USTREAM_ERR);
+    uistream_deinit(&in);
+    utest_assert_uint(uhash_count(IntHash, &rmap), ==, MAX_VAL);
+
+    uhash_deinit(IntHash, &empty);
+    uhash_deinit(IntHashPi, &rset);
+    uhash_deinit(IntHash, &rmap);
+    uhash_deinit(IntHash, &set);
+    uhash_deinit(IntHash, &map);
+    ustrbuf_deinit(&buf);
+    return true;
+}
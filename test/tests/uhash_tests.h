@@ -17,8 +17,25 @@ bool uhash_test_base(void);
 bool uhash_test_map(void);
 bool uhash_test_set(void);
 bool uhash_test_per_instance(void);
+bool uhash_test_simd(void);
+bool uhash_test_cached_hash(void);
+bool uhash_test_incremental(void);
+bool uhash_test_compaction(void);
+bool uhash_test_batch(void);
+bool uhash_test_from_array(void);
+bool uhash_test_load(void);
+bool uhash_test_robin_hood(void);
+bool uhash_test_robin_hood_clustered(void);
+bool uhash_test_str_hash(void);
+bool uhash_test_interleaved(void);
+bool uhash_test_concurrent(void);
+bool uhash_test_serial(void);
 
 #define UHASH_TESTS                                                                                \
-    uhash_test_memory, uhash_test_base, uhash_test_map, uhash_test_set, uhash_test_per_instance
+    uhash_test_memory, uhash_test_base, uhash_test_map, uhash_test_set, uhash_test_per_instance,   \
+        uhash_test_simd, uhash_test_cached_hash, uhash_test_incremental, uhash_test_compaction,    \
+        uhash_test_batch, uhash_test_from_array, uhash_test_load, uhash_test_robin_hood,           \
+        uhash_test_robin_hood_clustered, uhash_test_str_hash, uhash_test_interleaved,              \
+        uhash_test_concurrent, uhash_test_serial
 
 #endif // UHASH_TESTS_H
@@ -0,0 +1,117 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "uprof_tests.h"
+#include "uprof.h"
+#include "ustrbuf.h"
+#include "utest.h"
+
+bool uprof_test_sample(void) {
+#if defined(ULIB_PROFILE)
+    size_t const interval = uprof_sample_interval();
+    utest_assert_uint(interval, ==, UPROF_SAMPLE_INTERVAL);
+
+    // Sampling every byte accounts for allocations exactly.
+    uprof_set_sample_interval(1);
+    uprof_reset();
+
+    void *a = ulib_malloc(100);
+    void *b = ulib_calloc(10, 5);
+    utest_assert_not_null(a);
+    utest_assert_not_null(b);
+    b = ulib_realloc(b, 60);
+    utest_assert_not_null(b);
+
+    UProfStats stats = uprof_stats();
+    utest_assert_uint(stats.samples, ==, 3);
+    utest_assert_uint(stats.bytes, ==, 210);
+    utest_assert_uint(stats.live_bytes, ==, 160);
+    utest_assert_uint(stats.peak_bytes, ==, 160);
+    utest_assert_uint(stats.sites, ==, 3);
+    utest_assert_uint(stats.dropped, ==, 0);
+
+    ulib_free(a);
+    stats = uprof_stats();
+    utest_assert_uint(stats.live_bytes, ==, 60);
+    utest_assert_uint(stats.peak_bytes, ==, 160);
+
+    UProfSite sites[4];
+    utest_assert_uint(uprof_sites(sites, 4), ==, 3);
+    utest_assert_uint(uprof_sites(sites, 2), ==, 2);
+    utest_assert_uint(sites[0].bytes, ==, 100);
+    utest_assert_uint(sites[0].live_bytes, ==, 0);
+    utest_assert_uint(sites[0].samples, ==, 1);
+    utest_assert_uint(sites[1].bytes, ==, 60);
+    utest_assert_uint(sites[1].live_bytes, ==, 60);
+    utest_assert(strcmp(sites[0].fn, __func__) == 0);
+    utest_assert(strcmp(sites[0].file, __FILE__) == 0);
+
+    // Deallocating memory sampled before a reset does not affect the statistics.
+    uprof_reset();
+    ulib_free(b);
+    stats = uprof_stats();
+    utest_assert_uint(stats.samples, ==, 0);
+    utest_assert_uint(stats.live_bytes, ==, 0);
+
+    // Sampling can be disabled.
+    uprof_set_sample_interval(0);
+    a = ulib_malloc(1000);
+    ulib_free(a);
+    utest_assert_uint(uprof_stats().samples, ==, 0);
+
+    // Sparse sampling yields an estimate of the allocated bytes.
+    uprof_set_sample_interval(64);
+    void *ptrs[1000];
+    for (unsigned i = 0; i < ulib_array_count(ptrs); ++i) ptrs[i] = ulib_malloc(16);
+    stats = uprof_stats();
+    for (unsigned i = 0; i < ulib_array_count(ptrs); ++i) ulib_free(ptrs[i]);
+
+    utest_assert_uint(stats.samples, <, ulib_array_count(ptrs));
+    utest_assert_uint(stats.bytes, >, 16000 / 2);
+    utest_assert_uint(stats.bytes, <, 16000 * 2);
+    utest_assert_uint(uprof_stats().live_bytes, ==, 0);
+
+    uprof_set_sample_interval(interval);
+    uprof_reset();
+#else
+    utest_assert_uint(uprof_stats().samples, ==, 0);
+#endif
+    return true;
+}
+
+bool uprof_test_report(void) {
+    UStrBuf buf = ustrbuf();
+    UOStream stream;
+    utest_assert(uostream_to_strbuf(&stream, &buf) == USTREAM_OK);
+
+#if defined(ULIB_PROFILE)
+    size_t const interval = uprof_sample_interval();
+    uprof_set_sample_interval(1);
+    uprof_reset();
+    void *ptr = ulib_malloc(1000);
+#endif
+
+    size_t written;
+    utest_assert(uprof_report(&stream, 10, &written) == USTREAM_OK);
+    utest_assert_uint(written, ==, uvec_count(char, &buf));
+    utest_assert(uostream_write_literal(&stream, "\0", NULL) == USTREAM_OK);
+    utest_assert(strncmp(ustrbuf_data(&buf), "samples: ", 9) == 0);
+
+#if defined(ULIB_PROFILE)
+    ulib_free(ptr);
+    uprof_set_sample_interval(interval);
+    uprof_reset();
+    utest_assert_not_null(strstr(ustrbuf_data(&buf), "1000 bytes (1000 live) in 1 samples: "));
+    utest_assert_not_null(strstr(ustrbuf_data(&buf), __func__));
+#endif
+
+    uostream_deinit(&stream);
+    ustrbuf_deinit(&buf);
+    return true;
+}
@@ -0,0 +1,20 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UPROF_TESTS_H
+#define UPROF_TESTS_H
+
+#include "ustd.h"
+
+bool uprof_test_sample(void);
+bool uprof_test_report(void);
+
+#define UPROF_TESTS uprof_test_sample, uprof_test_report
+
+#endif // UPROF_TESTS_H
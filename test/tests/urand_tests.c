@@ -25,6 +25,28 @@ bool urand_int_test(void) {
         utest_assert_int(val, <, 10);
     }
 
+    for (unsigned i = 0; i < 100; ++i) {
+        utest_assert_int(urand(), >=, 0);
+    }
+
+    // Ranges may span the whole ulib_int range.
+    bool negative = false, positive = false;
+
+    for (unsigned i = 0; i < 100; ++i) {
+        val = urand_range(ULIB_INT_MIN, ULIB_UINT_MAX);
+        utest_assert_int(val, <, ULIB_INT_MAX);
+        if (val < 0) negative = true;
+        if (val > 0) positive = true;
+    }
+
+    utest_assert(negative && positive);
+
+    // The seed determines the sequence.
+    urand_set_seed(12345);
+    ulib_int const first = urand();
+    urand_set_seed(12345);
+    utest_assert_int(urand(), ==, first);
+
     return true;
 }
 
@@ -60,3 +82,88 @@ bool urand_string_test(void) {
 
     return true;
 }
+
+bool urand_gen_test(void) {
+    URandGen a = urand_gen(1), b = urand_gen(1), c = urand_gen(2);
+
+    for (unsigned i = 0; i < 100; ++i) {
+        uint64_t const val = urand_gen_next(&a);
+        utest_assert_uint(val, ==, urand_gen_next(&b));
+        utest_assert_uint(val, !=, urand_gen_next(&c));
+    }
+
+    // Jumped generators start a different sequence.
+    b = a;
+    urand_gen_jump(&b);
+    utest_assert_uint(urand_gen_next(&a), !=, urand_gen_next(&b));
+
+    // Ranges are uniformly distributed.
+    ulib_uint counts[6] = { 0 };
+    ulib_uint const draws = 6000;
+
+    for (ulib_uint i = 0; i < draws; ++i) {
+        ulib_int const val = urand_gen_range(&a, -3, 6);
+        utest_assert_int(val, >=, -3);
+        utest_assert_int(val, <, 3);
+        counts[val + 3]++;
+    }
+
+    for (unsigned i = 0; i < ulib_array_count(counts); ++i) {
+        utest_assert_uint(counts[i], >, draws / 6 * 8 / 10);
+        utest_assert_uint(counts[i], <, draws / 6 * 12 / 10);
+    }
+
+    utest_assert_int(urand_gen_range(&a, 5, 0), ==, 5);
+    utest_assert_int(urand_gen_range(&a, 5, 1), ==, 5);
+    utest_assert_int(urand_gen_range(&a, ULIB_INT_MIN, ULIB_UINT_MAX), >=, ULIB_INT_MIN);
+
+    // Strings over large charsets are supported.
+    char charset_buf[300];
+    for (unsigned i = 0; i < sizeof(charset_buf); ++i) charset_buf[i] = (char)('a' + i % 26);
+    UString charset = ustring_wrap(charset_buf, sizeof(charset_buf));
+    char buf[64];
+    urand_gen_str(&a, sizeof(buf), buf, &charset);
+
+    for (unsigned i = 0; i < sizeof(buf); ++i) {
+        utest_assert(buf[i] >= 'a' && buf[i] <= 'z');
+    }
+
+    // Empty charsets fall back to the default one.
+    UString const *def = urand_default_charset();
+    charset = ustring_empty;
+    urand_gen_str(&a, sizeof(buf), buf, &charset);
+
+    for (unsigned i = 0; i < sizeof(buf); ++i) {
+        utest_assert_uint(ustring_index_of(*def, buf[i]), <, ustring_length(*def));
+    }
+
+    return true;
+}
+
+bool urand_fill_test(void) {
+    ulib_byte buf[67] = { 0 }, other[67] = { 0 };
+    URandGen gen = urand_gen(42);
+
+    urand_gen_fill(&gen, buf, sizeof(buf));
+    urand_gen_fill(&gen, other, sizeof(other));
+    utest_assert_buf(buf, !=, other, sizeof(buf));
+
+    // Sizes that are not multiples of eight do not write past the end.
+    ulib_byte small[5] = { 0 };
+    urand_gen_fill(&gen, small, 3);
+    utest_assert_uint(small[3], ==, 0);
+    utest_assert_uint(small[4], ==, 0);
+
+    urand_fill(buf, sizeof(buf));
+    utest_assert_buf(buf, !=, other, sizeof(buf));
+
+    unsigned set_bits = 0;
+    for (unsigned i = 0; i < sizeof(buf); ++i) {
+        for (ulib_byte b = buf[i]; b; b &= (ulib_byte)(b - 1)) set_bits++;
+    }
+
+    // Bits are about evenly split.
+    utest_assert_uint(set_bits, >, sizeof(buf) * 8 * 3 / 8);
+    utest_assert_uint(set_bits, <, sizeof(buf) * 8 * 5 / 8);
+    return true;
+}
@@ -14,7 +14,9 @@
 
 bool urand_int_test(void);
 bool urand_string_test(void);
+bool urand_gen_test(void);
+bool urand_fill_test(void);
 
-#define URAND_TESTS urand_int_test, urand_string_test
+#define URAND_TESTS urand_int_test, urand_string_test, urand_gen_test, urand_fill_test
 
 #endif // URAND_TESTS_H
@@ -8,8 +8,12 @@
  */
 
 #include "ustream_tests.h"
+#include "uchecksum.h"
 #include "ustream.h"
+#include "ustring.h"
 #include "utest.h"
+#include "uthread.h"
+#include "uversion.h"
 
 #define USTREAM_INPUT_FILE "ustream_input.txt"
 #define USTREAM_OUTPUT_FILE "ustream_output.txt"
@@ -106,6 +110,263 @@ bool uistream_buf_test(void) {
     return true;
 }
 
+bool uistream_mapped_test(void) {
+    utest_assert_critical(ustream_generate_data(USTREAM_INPUT_FILE));
+
+    UIStream stream;
+    char buf[test_data_size] = { 0 };
+    size_t read, size;
+
+    utest_assert(uistream_from_path_mapped(&stream, USTREAM_INPUT_FILE) == USTREAM_OK);
+
+#if defined(__unix__) || defined(__APPLE__) || defined(_WIN32)
+    char const *data = (char const *)uistream_data(&stream, &size);
+    utest_assert_not_null(data);
+    utest_assert_uint(size, ==, test_data_length);
+    utest_assert_buf(data, ==, test_data, test_data_length);
+#endif
+
+    for (unsigned i = 0; i < 2; ++i) {
+        utest_assert(uistream_read(&stream, buf, 4, &read) == USTREAM_OK);
+        utest_assert_uint(read, ==, 4);
+        utest_assert(uistream_read(&stream, buf + 4, test_data_length, &read) == USTREAM_OK);
+        utest_assert_uint(read, ==, test_data_length - 4);
+        utest_assert_buf(buf, ==, test_data, test_data_length);
+        utest_assert(uistream_reset(&stream) == USTREAM_OK);
+    }
+
+    utest_assert(uistream_deinit(&stream) == USTREAM_OK);
+
+    // Empty files.
+    FILE *file = fopen(USTREAM_INPUT_FILE, "wb");
+    utest_assert_not_null(file);
+    fclose(file);
+
+    utest_assert(uistream_from_path_mapped(&stream, USTREAM_INPUT_FILE) == USTREAM_OK);
+    utest_assert(uistream_read(&stream, buf, sizeof(buf), &read) == USTREAM_OK);
+    utest_assert_uint(read, ==, 0);
+    utest_assert(uistream_deinit(&stream) == USTREAM_OK);
+
+    utest_assert(uistream_from_path_mapped(&stream, "missing_file.txt") != USTREAM_OK);
+
+    // Only memory-backed streams expose their contents.
+    utest_assert(uistream_from_buf(&stream, test_data, test_data_length) == USTREAM_OK);
+    utest_assert_ptr(uistream_data(&stream, &size), ==, test_data);
+    utest_assert_uint(size, ==, test_data_length);
+    utest_assert(uistream_deinit(&stream) == USTREAM_OK);
+    utest_assert(uistream_data(uistream_std(), NULL) == NULL);
+
+    return true;
+}
+
+typedef struct CountingStream {
+    UIStream in;
+    UOStream out;
+    unsigned calls;
+} CountingStream;
+
+static ustream_ret counting_read(void *ctx, void *buf, size_t count, size_t *read) {
+    CountingStream *cs = (CountingStream *)ctx;
+    cs->calls++;
+    return cs->in.read(cs->in.ctx, buf, count, read);
+}
+
+static ustream_ret counting_write(void *ctx, void const *buf, size_t count, size_t *written) {
+    CountingStream *cs = (CountingStream *)ctx;
+    cs->calls++;
+    return uostream_write(&cs->out, buf, count, written);
+}
+
+static ustream_ret counting_reset(void *ctx) {
+    return uistream_reset(&((CountingStream *)ctx)->in);
+}
+
+static ustream_ret counting_free_in(void *ctx) {
+    return uistream_deinit(&((CountingStream *)ctx)->in);
+}
+
+static ustream_ret counting_free_out(void *ctx) {
+    return uostream_deinit(&((CountingStream *)ctx)->out);
+}
+
+bool uistream_buffered_test(void) {
+    char data[100];
+    for (unsigned i = 0; i < sizeof(data); ++i) data[i] = (char)('a' + i % 26);
+
+    CountingStream cs;
+    cs.calls = 0;
+    utest_assert(uistream_from_buf(&cs.in, data, sizeof(data)) == USTREAM_OK);
+    UIStream src = uistream(&cs, counting_read, counting_reset, counting_free_in);
+
+    UIStream stream;
+    utest_assert(uistream_buffered(&stream, &src, 16) == USTREAM_OK);
+
+    char buf[sizeof(data)];
+    size_t read, total = 0;
+
+    // Small reads are served from the buffer.
+    for (unsigned i = 0; i < 8; ++i, total += read) {
+        utest_assert(uistream_read(&stream, buf + total, 3, &read) == USTREAM_OK);
+        utest_assert_uint(read, ==, 3);
+    }
+    utest_assert_uint(cs.calls, ==, 2);
+
+    // Large reads bypass it.
+    unsigned calls = cs.calls;
+    utest_assert(uistream_read(&stream, buf + total, 40, &read) == USTREAM_OK);
+    utest_assert_uint(read, ==, 40);
+    utest_assert_uint(cs.calls, ==, calls + 1);
+    total += read;
+
+    do {
+        utest_assert(uistream_read(&stream, buf + total, 7, &read) == USTREAM_OK);
+        total += read;
+    } while (read);
+
+    utest_assert_uint(total, ==, sizeof(data));
+    utest_assert_buf(buf, ==, data, sizeof(data));
+
+    utest_assert(uistream_reset(&stream) == USTREAM_OK);
+    utest_assert(uistream_read(&stream, buf, 5, &read) == USTREAM_OK);
+    utest_assert_uint(read, ==, 5);
+    utest_assert_buf(buf, ==, data, 5);
+
+    utest_assert(uistream_deinit(&stream) == USTREAM_OK);
+    return true;
+}
+
+static bool uistream_peek_test_stream(UIStream *stream) {
+    char buf[test_data_size] = { 0 };
+    void const *data;
+    size_t available, read;
+
+    utest_assert(uistream_peek(stream, &data, &available) == USTREAM_OK);
+    utest_assert_uint(available, >=, 3);
+    utest_assert_buf((char const *)data, ==, test_data, 3);
+    utest_assert(uistream_consume(stream, 3) == USTREAM_OK);
+    utest_assert_uint(stream->read_bytes, ==, 3);
+
+    // Reads and peeks can be interleaved.
+    utest_assert(uistream_read(stream, buf, 2, &read) == USTREAM_OK);
+    utest_assert_buf(buf, ==, test_data + 3, 2);
+
+    size_t total = 5;
+    while (uistream_peek(stream, &data, &available) == USTREAM_OK && available) {
+        utest_assert_uint(total + available, <=, test_data_length);
+        utest_assert_buf((char const *)data, ==, test_data + total, available);
+        utest_assert(uistream_consume(stream, available) == USTREAM_OK);
+        total += available;
+    }
+
+    utest_assert(stream->state == USTREAM_OK);
+    utest_assert_uint(total, ==, test_data_length);
+    utest_assert_uint(stream->read_bytes, ==, test_data_length);
+    return true;
+}
+
+bool uistream_peek_test(void) {
+    UIStream stream;
+    utest_assert(uistream_from_buf(&stream, test_data, test_data_length) == USTREAM_OK);
+    utest_assert(uistream_peek_test_stream(&stream));
+    utest_assert(uistream_deinit(&stream) == USTREAM_OK);
+
+    UIStream src;
+    utest_assert(uistream_from_string(&src, test_data) == USTREAM_OK);
+    utest_assert(uistream_buffered(&stream, &src, 4) == USTREAM_OK);
+    utest_assert(uistream_peek_test_stream(&stream));
+    utest_assert(uistream_deinit(&stream) == USTREAM_OK);
+
+    // Streams that do not support peeking are buffered on demand.
+    CountingStream cs;
+    cs.calls = 0;
+    utest_assert(uistream_from_buf(&cs.in, test_data, test_data_length) == USTREAM_OK);
+    stream = uistream(&cs, counting_read, counting_reset, counting_free_in);
+    utest_assert(uistream_peek_test_stream(&stream));
+    utest_assert_uint(cs.calls, ==, 2);
+    utest_assert(uistream_deinit(&stream) == USTREAM_OK);
+
+    return true;
+}
+
+static bool uistream_read_line_test_lines(UIStream *stream, UStrBuf *buf) {
+    static char const *const lines[] = {
+        "first line", "", "a somewhat longer line, spanning more than one small chunk",
+        "crlf", "x", "last line without terminator",
+    };
+    UString line;
+
+    for (unsigned i = 0; i < ulib_array_count(lines); ++i) {
+        utest_assert(uistream_read_line(stream, buf, &line) == USTREAM_OK);
+        utest_assert_false(ustring_is_null(line));
+        utest_assert_uint(ustring_length(line), ==, strlen(lines[i]));
+        utest_assert_buf(ustring_data(line), ==, lines[i], strlen(lines[i]));
+    }
+
+    utest_assert(uistream_read_line(stream, buf, &line) == USTREAM_OK);
+    utest_assert(ustring_is_null(line));
+    return true;
+}
+
+static bool uistream_read_until_test_view(UIStream *stream, UStrBuf *buf, char const *text) {
+    UString record;
+    utest_assert(uistream_read_until(stream, ',', buf, &record) == USTREAM_OK);
+    utest_assert_uint(ustring_length(record), ==, strchr(text, ',') - text);
+
+    // Records that fit in the UString itself are copied into it.
+    if (ustring_length(record) >= sizeof(UString)) {
+        utest_assert_ptr(ustring_data(record), ==, text);
+    } else {
+        utest_assert_buf(ustring_data(record), ==, text, ustring_length(record));
+    }
+
+    return true;
+}
+
+bool uistream_read_line_test(void) {
+    char const text[] = "first line\n\na somewhat longer line, spanning more than one small chunk\n"
+                        "crlf\r\nx\nlast line without terminator";
+    UStrBuf buf = ustrbuf();
+    UIStream stream;
+
+    // Records are returned as views into memory-backed streams.
+    utest_assert(uistream_from_string(&stream, text) == USTREAM_OK);
+    bool const ok = uistream_read_until_test_view(&stream, &buf, text) &&
+                    uistream_reset(&stream) == USTREAM_OK &&
+                    uistream_read_line_test_lines(&stream, &buf);
+    ustream_ret const ret = uistream_deinit(&stream);
+    if (!ok) ustrbuf_deinit(&buf);
+    utest_assert(ok);
+    utest_assert(ret == USTREAM_OK);
+
+    // Records spanning multiple chunks are copied into the buffer.
+    UIStream src;
+    utest_assert(uistream_from_string(&src, text) == USTREAM_OK);
+    utest_assert(uistream_buffered(&stream, &src, 8) == USTREAM_OK);
+    utest_assert(uistream_read_line_test_lines(&stream, &buf));
+    utest_assert(uistream_deinit(&stream) == USTREAM_OK);
+
+    // Streams that do not support peeking are buffered on demand.
+    CountingStream cs;
+    cs.calls = 0;
+    utest_assert(uistream_from_string(&cs.in, text) == USTREAM_OK);
+    stream = uistream(&cs, counting_read, counting_reset, counting_free_in);
+    utest_assert(uistream_read_line_test_lines(&stream, &buf));
+    utest_assert(uistream_deinit(&stream) == USTREAM_OK);
+
+    // Records are not null-terminated, but can be converted.
+    char const numbers[] = "000000000000000000000000001f\n2345";
+    UString record;
+    ulib_int value;
+    utest_assert(uistream_from_string(&stream, numbers) == USTREAM_OK);
+    utest_assert(uistream_read_line(&stream, &buf, &record) == USTREAM_OK);
+    utest_assert(ustring_to_int(record, &value, 16) == ULIB_OK);
+    utest_assert_int(value, ==, 0x1f);
+    utest_assert(uistream_deinit(&stream) == USTREAM_OK);
+
+    ustrbuf_deinit(&buf);
+    return true;
+}
+
 bool uostream_null_test(void) {
     UOStream *stream = uostream_null();
     size_t written;
@@ -240,3 +501,554 @@ bool uostream_multi_test(void) {
 
     return true;
 }
+
+bool uostream_buffered_test(void) {
+    CountingStream cs;
+    cs.calls = 0;
+    UStrBuf strbuf = ustrbuf();
+    utest_assert(uostream_to_strbuf(&cs.out, &strbuf) == USTREAM_OK);
+    UOStream dst = uostream(&cs, counting_write, NULL, NULL, counting_free_out);
+
+    UOStream stream;
+    utest_assert(uostream_buffered(&stream, &dst, 16) == USTREAM_OK);
+
+    // Small writes are coalesced.
+    size_t written;
+    for (unsigned i = 0; i < 5; ++i) {
+        utest_assert(uostream_write(&stream, "abc", 3, &written) == USTREAM_OK);
+        utest_assert_uint(written, ==, 3);
+    }
+    utest_assert_uint(cs.calls, ==, 0);
+    utest_assert_uint(ustrbuf_length(&strbuf), ==, 0);
+
+    utest_assert(uostream_writef(&stream, &written, "%d", 42) == USTREAM_OK);
+    utest_assert_uint(written, ==, 2);
+    utest_assert_uint(cs.calls, ==, 1);
+    utest_assert_uint(ustrbuf_length(&strbuf), ==, 15);
+
+    // Large writes bypass the buffer, after writing any buffered data.
+    char const large[] = "0123456789012345678901234567890123456789";
+    utest_assert(uostream_write_literal(&stream, large, &written) == USTREAM_OK);
+    utest_assert_uint(written, ==, sizeof(large) - 1);
+    utest_assert_uint(cs.calls, ==, 3);
+
+    utest_assert(uostream_writef(&stream, &written, "%s", large) == USTREAM_OK);
+    utest_assert_uint(written, ==, sizeof(large) - 1);
+
+    utest_assert(uostream_write_literal(&stream, "end", NULL) == USTREAM_OK);
+    utest_assert(uostream_flush(&stream) == USTREAM_OK);
+
+    UString expected = ustring_literal("abcabcabcabcabc42"
+                                       "0123456789012345678901234567890123456789"
+                                       "0123456789012345678901234567890123456789"
+                                       "end");
+    utest_assert_uint(ustrbuf_length(&strbuf), ==, ustring_length(expected));
+    utest_assert_buf(ustrbuf_data(&strbuf), ==, ustring_data(expected), ustring_length(expected));
+
+    utest_assert(uostream_write_literal(&stream, "tail", NULL) == USTREAM_OK);
+    utest_assert(uostream_deinit(&stream) == USTREAM_OK);
+    utest_assert_uint(ustrbuf_length(&strbuf), ==, ustring_length(expected) + 4);
+
+    ustrbuf_deinit(&strbuf);
+    return true;
+}
+
+bool uostream_writev_test(void) {
+    size_t const body_size = 3 * BUFSIZ;
+    char *body = (char *)ulib_malloc(body_size);
+    utest_assert_not_null(body);
+    for (size_t i = 0; i < body_size; ++i) body[i] = (char)('a' + i % 26);
+
+    UStreamIOVec iov[3];
+    iov[0].data = "header:";
+    iov[0].size = 7;
+    iov[1].data = body;
+    iov[1].size = body_size;
+    iov[2].data = "\n";
+    iov[2].size = 1;
+    size_t const total = iov[0].size + iov[1].size + iov[2].size;
+
+    // Vectored writes and formatted strings are fanned out to all the substreams.
+    UStrBuf strbuf = ustrbuf();
+    UOStream stream, file, mem;
+    utest_assert(uostream_to_path(&file, USTREAM_OUTPUT_FILE) == USTREAM_OK);
+    utest_assert(uostream_to_strbuf(&mem, &strbuf) == USTREAM_OK);
+    utest_assert(uostream_to_multi(&stream) == USTREAM_OK);
+    utest_assert(uostream_add_substream(&stream, &file) == USTREAM_OK);
+    utest_assert(uostream_add_substream(&stream, &mem) == USTREAM_OK);
+
+    size_t written;
+    utest_assert(uostream_writev(&stream, iov, 3, &written) == USTREAM_OK);
+    utest_assert_uint(written, ==, total);
+    utest_assert(uostream_writev(&stream, iov, 1, &written) == USTREAM_OK);
+    utest_assert_uint(written, ==, iov[0].size);
+    utest_assert(uostream_writef(&stream, &written, "%.*s", 300, body) == USTREAM_OK);
+    utest_assert_uint(written, ==, 300);
+    utest_assert(uostream_deinit(&stream) == USTREAM_OK);
+
+    size_t const expected_size = total + iov[0].size + 300;
+    size_t buf_size;
+    char *buf = ustream_test_get_file_contents(USTREAM_OUTPUT_FILE, &buf_size);
+    utest_assert_not_null(buf);
+    utest_assert_uint(buf_size, ==, expected_size);
+
+    char const *data[] = { buf, ustrbuf_data(&strbuf) };
+    utest_assert_uint(ustrbuf_length(&strbuf), ==, expected_size);
+
+    for (unsigned i = 0; i < 2; ++i) {
+        char const *cur = data[i];
+        utest_assert_buf(cur, ==, "header:", 7);
+        utest_assert_buf(cur + 7, ==, body, body_size);
+        utest_assert_buf(cur + total, ==, "header:", 7);
+        utest_assert_buf(cur + total + 7, ==, body, 300);
+    }
+
+    ulib_free(buf);
+    ustrbuf_deinit(&strbuf);
+
+    // Buffered streams coalesce the buffers if they fit.
+    CountingStream cs;
+    cs.calls = 0;
+    strbuf = ustrbuf();
+    utest_assert(uostream_to_strbuf(&cs.out, &strbuf) == USTREAM_OK);
+    UOStream dst = uostream(&cs, counting_write, NULL, NULL, counting_free_out);
+    utest_assert(uostream_buffered(&stream, &dst, 64) == USTREAM_OK);
+
+    iov[1].size = 10;
+    utest_assert(uostream_writev(&stream, iov, 3, &written) == USTREAM_OK);
+    utest_assert_uint(written, ==, 18);
+    utest_assert_uint(cs.calls, ==, 0);
+    utest_assert(uostream_flush(&stream) == USTREAM_OK);
+    utest_assert_uint(cs.calls, ==, 1);
+
+    // Vectored writes fall back to individual writes if the stream does not support them.
+    utest_assert(uostream_writev(&dst, iov, 3, &written) == USTREAM_OK);
+    utest_assert_uint(written, ==, 18);
+    utest_assert_uint(cs.calls, ==, 4);
+    utest_assert(uostream_deinit(&stream) == USTREAM_OK);
+
+    utest_assert_uint(ustrbuf_length(&strbuf), ==, 36);
+    utest_assert_buf(ustrbuf_data(&strbuf), ==, "header:abcdefghij\nheader:abcdefghij\n", 36);
+
+    ustrbuf_deinit(&strbuf);
+    ulib_free(body);
+    return true;
+}
+
+typedef struct AsyncWriter {
+    UOStream stream;
+    unsigned id;
+} AsyncWriter;
+
+static void async_writer(void *ctx) {
+    AsyncWriter *writer = (AsyncWriter *)ctx;
+    for (unsigned i = 0; i < 100; ++i) {
+        uostream_writef(&writer->stream, NULL, "%u:%03u\n", writer->id, i);
+    }
+}
+
+bool uostream_async_test(void) {
+    UStrBuf strbuf = ustrbuf();
+    UOStream dst, stream;
+    utest_assert(uostream_to_strbuf(&dst, &strbuf) == USTREAM_OK);
+    utest_assert(uostream_to_async(&stream, &dst, 16, USTREAM_ASYNC_BLOCK) == USTREAM_OK);
+
+    // Writes larger than the buffer are split, and flushing waits for all of them.
+    char const large[] = "0123456789012345678901234567890123456789";
+    size_t written;
+    utest_assert(uostream_write_literal(&stream, "abc", &written) == USTREAM_OK);
+    utest_assert_uint(written, ==, 3);
+    utest_assert(uostream_writef(&stream, &written, "%d", 42) == USTREAM_OK);
+    utest_assert_uint(written, ==, 2);
+    utest_assert(uostream_write_literal(&stream, large, &written) == USTREAM_OK);
+    utest_assert_uint(written, ==, sizeof(large) - 1);
+    utest_assert(uostream_writef(&stream, &written, "%s", large) == USTREAM_OK);
+    utest_assert_uint(written, ==, sizeof(large) - 1);
+
+    UStreamIOVec iov[2];
+    iov[0].data = "key=";
+    iov[0].size = 4;
+    iov[1].data = "value";
+    iov[1].size = 5;
+    utest_assert(uostream_writev(&stream, iov, 2, &written) == USTREAM_OK);
+    utest_assert_uint(written, ==, 9);
+    utest_assert(uostream_flush(&stream) == USTREAM_OK);
+
+    UString expected = ustring_literal("abc42"
+                                       "0123456789012345678901234567890123456789"
+                                       "0123456789012345678901234567890123456789"
+                                       "key=value");
+    utest_assert_uint(ustrbuf_length(&strbuf), ==, ustring_length(expected));
+    utest_assert_buf(ustrbuf_data(&strbuf), ==, ustring_data(expected), ustring_length(expected));
+    utest_assert_uint(uostream_async_dropped(&stream), ==, 0);
+
+    // Copies of the stream can be written to concurrently, and each line is written as a whole.
+    AsyncWriter writers[4];
+    for (unsigned i = 0; i < ulib_array_count(writers); ++i) {
+        writers[i].stream = stream;
+        writers[i].id = i;
+    }
+    uthread_run_parallel(async_writer, writers, sizeof(*writers), 4);
+    utest_assert(uostream_deinit(&stream) == USTREAM_OK);
+
+    unsigned lines[4] = { 0 };
+    UString data = ustring_wrap(ustrbuf_data(&strbuf) + ustring_length(expected),
+                                ustrbuf_length(&strbuf) - ustring_length(expected));
+    utest_assert_uint(ustring_length(data), ==, ulib_array_count(lines) * 100 * 6);
+
+    char const *end = ustring_data(data) + ustring_length(data);
+    for (char const *line = ustring_data(data); line < end; line += 6) {
+        unsigned id = (unsigned)(line[0] - '0');
+        utest_assert_uint(id, <, ulib_array_count(lines));
+        utest_assert(line[1] == ':' && line[5] == '\n');
+        unsigned i = (unsigned)((line[2] - '0') * 100 + (line[3] - '0') * 10 + (line[4] - '0'));
+        utest_assert_uint(i, ==, lines[id]++);
+    }
+
+    ustrbuf_deinit(&strbuf);
+
+#if !defined(ULIB_NO_THREADS)
+    // Writes that do not fit in the buffer are dropped and counted.
+    strbuf = ustrbuf();
+    utest_assert(uostream_to_strbuf(&dst, &strbuf) == USTREAM_OK);
+    utest_assert(uostream_to_async(&stream, &dst, 16, USTREAM_ASYNC_DROP) == USTREAM_OK);
+    utest_assert(uostream_write_literal(&stream, large, &written) == USTREAM_OK);
+    utest_assert_uint(written, ==, 0);
+    utest_assert(uostream_writef(&stream, &written, "%s", large) == USTREAM_OK);
+    utest_assert_uint(written, ==, 0);
+    utest_assert(uostream_write_literal(&stream, "abc", &written) == USTREAM_OK);
+    utest_assert_uint(written, ==, 3);
+    utest_assert_uint(uostream_async_dropped(&stream), ==, 2);
+    utest_assert(uostream_deinit(&stream) == USTREAM_OK);
+    utest_assert_buf(ustrbuf_data(&strbuf), ==, "abc", 3);
+    ustrbuf_deinit(&strbuf);
+#endif
+
+    return true;
+}
+
+bool ustream_checksum_test(void) {
+    char const check[] = "123456789";
+    utest_assert_uint(ucrc32c(0, check, 9), ==, 0xE3069283U);
+    utest_assert_uint(ucrc32c(ucrc32c(0, check, 4), check + 4, 5), ==, 0xE3069283U);
+    utest_assert_uint(uxxh64("", 0, 0), ==, 0xEF46DB3751D8E999ULL);
+    utest_assert_uint(uxxh64("a", 1, 0), ==, 0xD24EC4F1A98C6E5BULL);
+    utest_assert_uint(uxxh64("abc", 3, 0), ==, 0x44BC2CF5AD770999ULL);
+
+    char data[1000];
+    for (unsigned i = 0; i < sizeof(data); ++i) data[i] = (char)('a' + (i * 7 + i / 13) % 26);
+
+    // Incremental updates match one-shot checksums, regardless of how the data is split.
+    uchecksum_type const types[] = { UCHECKSUM_CRC32C, UCHECKSUM_XXH64 };
+    uint64_t const expected[] = { ucrc32c(0, data, sizeof(data)), uxxh64(data, sizeof(data), 0) };
+
+    for (unsigned t = 0; t < ulib_array_count(types); ++t) {
+        size_t const steps[] = { 1, 3, 31, 32, 33, 100 };
+        for (unsigned s = 0; s < ulib_array_count(steps); ++s) {
+            UChecksum checksum = uchecksum(types[t]);
+            for (size_t i = 0; i < sizeof(data); i += steps[s]) {
+                size_t size = sizeof(data) - i < steps[s] ? sizeof(data) - i : steps[s];
+                uchecksum_update(&checksum, data + i, size);
+            }
+            utest_assert_uint(uchecksum_value(&checksum), ==, expected[t]);
+        }
+    }
+
+    // Checksumming streams pass the data through.
+    UStrBuf strbuf = ustrbuf();
+    UOStream stream, dst;
+    UChecksum out_checksum = uchecksum(UCHECKSUM_XXH64);
+    utest_assert(uostream_to_strbuf(&dst, &strbuf) == USTREAM_OK);
+    utest_assert(uostream_checksum(&stream, &dst, &out_checksum) == USTREAM_OK);
+    utest_assert(uostream_write(&stream, data, 500, NULL) == USTREAM_OK);
+    utest_assert(uostream_writef(&stream, NULL, "%.*s", 500, data + 500) == USTREAM_OK);
+    utest_assert(uostream_deinit(&stream) == USTREAM_OK);
+    utest_assert_uint(uchecksum_value(&out_checksum), ==, expected[1]);
+    utest_assert_uint(ustrbuf_length(&strbuf), ==, sizeof(data));
+    utest_assert_buf(ustrbuf_data(&strbuf), ==, data, sizeof(data));
+    ustrbuf_deinit(&strbuf);
+
+    UIStream in, src;
+    UChecksum in_checksum = uchecksum(UCHECKSUM_CRC32C);
+    utest_assert(uistream_from_buf(&src, data, sizeof(data)) == USTREAM_OK);
+    utest_assert(uistream_checksum(&in, &src, &in_checksum) == USTREAM_OK);
+
+    char buf[sizeof(data)];
+    size_t read;
+    utest_assert(uistream_read(&in, buf, 100, &read) == USTREAM_OK);
+    utest_assert_uint(read, ==, 100);
+
+    // Peeked data is only checksummed once it is consumed.
+    void const *peeked;
+    size_t available;
+    utest_assert(uistream_peek(&in, &peeked, &available) == USTREAM_OK);
+    utest_assert_uint(available, ==, sizeof(data) - 100);
+    utest_assert(uistream_consume(&in, 400) == USTREAM_OK);
+    utest_assert(uistream_read(&in, buf, sizeof(buf), &read) == USTREAM_OK);
+    utest_assert_uint(read, ==, 500);
+    utest_assert_uint(uchecksum_value(&in_checksum), ==, expected[0]);
+
+    // Resetting the stream resets the checksum.
+    utest_assert(uistream_reset(&in) == USTREAM_OK);
+    utest_assert(uistream_read(&in, buf, sizeof(buf), &read) == USTREAM_OK);
+    utest_assert_uint(uchecksum_value(&in_checksum), ==, expected[0]);
+    utest_assert(uistream_deinit(&in) == USTREAM_OK);
+
+    return true;
+}
+
+bool ustream_compress_test(void) {
+#if !defined(ULIB_NO_COMPRESSION)
+    size_t const size = 50000;
+    char *data = (char *)ulib_malloc(size);
+    char *buf = (char *)ulib_malloc(size + 1);
+    utest_assert_not_null(data);
+    utest_assert_not_null(buf);
+
+    // Compressible text followed by incompressible noise.
+    uint32_t seed = 1;
+    for (size_t i = 0; i < size / 2; ++i) data[i] = "the quick brown fox "[i % 20];
+    for (size_t i = size / 2; i < size; ++i) {
+        seed = seed * 1103515245U + 12345U;
+        data[i] = (char)(seed >> 23U);
+    }
+
+    size_t const block_sizes[] = { 0, 1000, 64 };
+
+    for (unsigned b = 0; b < ulib_array_count(block_sizes); ++b) {
+        UStrBuf strbuf = ustrbuf();
+        UOStream stream, dst;
+        utest_assert(uostream_to_strbuf(&dst, &strbuf) == USTREAM_OK);
+        utest_assert(uostream_compress(&stream, &dst, block_sizes[b]) == USTREAM_OK);
+
+        size_t written;
+        utest_assert(uostream_write(&stream, data, 10, &written) == USTREAM_OK);
+        utest_assert(uostream_flush(&stream) == USTREAM_OK);
+        utest_assert(uostream_writef(&stream, &written, "%.*s", 3000, data + 10) == USTREAM_OK);
+        utest_assert_uint(written, ==, 3000);
+        utest_assert(uostream_write(&stream, data + 3010, size - 3010, &written) == USTREAM_OK);
+        utest_assert_uint(written, ==, size - 3010);
+        utest_assert(uostream_deinit(&stream) == USTREAM_OK);
+
+        if (!block_sizes[b]) utest_assert_uint(ustrbuf_length(&strbuf), <, size * 3 / 4);
+
+        // Decompress from a peekable source, and from one that does not support peeking.
+        for (unsigned peekable = 0; peekable < 2; ++peekable) {
+            CountingStream cs;
+            UIStream in, src;
+            utest_assert(uistream_from_strbuf(&cs.in, &strbuf) == USTREAM_OK);
+
+            if (peekable) {
+                src = cs.in;
+            } else {
+                src = uistream(&cs, counting_read, counting_reset, counting_free_in);
+            }
+
+            utest_assert(uistream_decompress(&in, &src) == USTREAM_OK);
+
+            size_t read, total = 0;
+            utest_assert(uistream_read(&in, buf, 7, &read) == USTREAM_OK);
+            utest_assert_uint(read, ==, 7);
+            total += read;
+
+            void const *peeked;
+            size_t available;
+            utest_assert(uistream_peek(&in, &peeked, &available) == USTREAM_OK);
+            utest_assert_uint(available, >, 0);
+            utest_assert_buf(peeked, ==, data + total, available);
+
+            utest_assert(uistream_read(&in, buf + total, size + 1 - total, &read) == USTREAM_OK);
+            total += read;
+            utest_assert_uint(total, ==, size);
+            utest_assert_buf(buf, ==, data, size);
+
+            utest_assert(uistream_reset(&in) == USTREAM_OK);
+            utest_assert(uistream_read(&in, buf, size + 1, &read) == USTREAM_OK);
+            utest_assert_uint(read, ==, size);
+            utest_assert_buf(buf, ==, data, size);
+            utest_assert(uistream_deinit(&in) == USTREAM_OK);
+        }
+
+        // Corrupted block headers are detected.
+        if (b == 1) {
+            UIStream in, src;
+            ustrbuf_data(&strbuf)[27] ^= 0x55;
+            utest_assert(uistream_from_strbuf(&src, &strbuf) == USTREAM_OK);
+            utest_assert(uistream_decompress(&in, &src) == USTREAM_OK);
+            size_t read;
+            utest_assert(uistream_read(&in, buf, size, &read) != USTREAM_OK);
+            utest_assert(uistream_deinit(&in) == USTREAM_OK);
+        }
+
+        ustrbuf_deinit(&strbuf);
+    }
+
+    // Empty streams round trip.
+    UStrBuf strbuf = ustrbuf();
+    UOStream stream, dst;
+    utest_assert(uostream_to_strbuf(&dst, &strbuf) == USTREAM_OK);
+    utest_assert(uostream_compress(&stream, &dst, 0) == USTREAM_OK);
+    utest_assert(uostream_deinit(&stream) == USTREAM_OK);
+
+    UIStream in, src;
+    size_t read;
+    utest_assert(uistream_from_strbuf(&src, &strbuf) == USTREAM_OK);
+    utest_assert(uistream_decompress(&in, &src) == USTREAM_OK);
+    utest_assert(uistream_read(&in, buf, size, &read) == USTREAM_OK);
+    utest_assert_uint(read, ==, 0);
+    utest_assert(uistream_deinit(&in) == USTREAM_OK);
+    ustrbuf_deinit(&strbuf);
+
+    ulib_free(data);
+    ulib_free(buf);
+#endif
+    return true;
+}
+
+bool ustream_stats_test(void) {
+    UStreamStats stats = { 0 };
+    UStrBuf strbuf = ustrbuf();
+    UOStream stream, dst;
+    utest_assert(uostream_to_strbuf(&dst, &strbuf) == USTREAM_OK);
+    utest_assert(uostream_stats(&stream, &dst, &stats) == USTREAM_OK);
+
+    size_t written;
+    utest_assert(uostream_write(&stream, "abc", 3, &written) == USTREAM_OK);
+    utest_assert(uostream_writef(&stream, &written, "%d", 12345) == USTREAM_OK);
+    utest_assert(uostream_write(&stream, "", 0, &written) == USTREAM_OK);
+    utest_assert(uostream_flush(&stream) == USTREAM_OK);
+    utest_assert(uostream_write(&stream, "defg", 4, &written) == USTREAM_OK);
+    utest_assert(uostream_deinit(&stream) == USTREAM_OK);
+
+    // Statistics survive flushes.
+    utest_assert_uint(stats.calls, ==, 5);
+    utest_assert_uint(stats.bytes, ==, 12);
+    utest_assert_uint(stats.size_hist[0], ==, 1);
+    utest_assert_uint(stats.size_hist[2], ==, 1);
+    utest_assert_uint(stats.size_hist[3], ==, 2);
+    utest_assert_uint(stats.errors[USTREAM_ERR_IO], ==, 0);
+    utest_assert_uint(stats.time, >=, stats.max_time);
+    utest_assert_uint(ustream_stats_time_percentile(&stats, 99.0), <=, stats.max_time);
+    utest_assert_buf(ustrbuf_data(&strbuf), ==, "abc12345defg", 12);
+    ustrbuf_deinit(&strbuf);
+
+    // Errors are counted by return code.
+    char small[4];
+    utest_assert(uostream_to_buf(&dst, small, sizeof(small)) == USTREAM_OK);
+    utest_assert(uostream_stats(&stream, &dst, &stats) == USTREAM_OK);
+    utest_assert(uostream_write(&stream, "hello", 5, &written) == USTREAM_ERR_BOUNDS);
+    utest_assert(uostream_deinit(&stream) == USTREAM_OK);
+    utest_assert_uint(stats.errors[USTREAM_ERR_BOUNDS], ==, 1);
+
+    // Peeked bytes count once consumed.
+    UStreamStats in_stats = { 0 };
+    UIStream in, src;
+    utest_assert(uistream_from_buf(&src, test_data, test_data_size) == USTREAM_OK);
+    utest_assert(uistream_stats(&in, &src, &in_stats) == USTREAM_OK);
+
+    char buf[test_data_size];
+    size_t read;
+    utest_assert(uistream_read(&in, buf, 4, &read) == USTREAM_OK);
+    void const *peeked;
+    size_t available;
+    utest_assert(uistream_peek(&in, &peeked, &available) == USTREAM_OK);
+    utest_assert(uistream_consume(&in, available) == USTREAM_OK);
+    utest_assert(uistream_deinit(&in) == USTREAM_OK);
+    utest_assert_uint(in_stats.calls, ==, 3);
+    utest_assert_uint(in_stats.bytes, ==, test_data_size);
+
+    // Reports can be written to any stream.
+    strbuf = ustrbuf();
+    utest_assert(uostream_to_strbuf(&dst, &strbuf) == USTREAM_OK);
+    utest_assert(uostream_write_stats(&dst, &stats, &written) == USTREAM_OK);
+    utest_assert_uint(written, ==, ustrbuf_length(&strbuf));
+    UString report = ustrbuf_to_ustring(&strbuf);
+    utest_assert(ustring_starts_with(report, ustring_literal("calls: 6, bytes: 16,")));
+    utest_assert(ustring_find(report, ustring_literal("bounds 1")) < ustring_length(report));
+    utest_assert(ustring_find(report, ustring_literal("  4-7: 3\n")) < ustring_length(report));
+    ustring_deinit(&report);
+
+    return true;
+}
+
+bool uostream_reserve_test(void) {
+    char data[8];
+    UOStream stream;
+    utest_assert(uostream_to_buf(&stream, data, sizeof(data)) == USTREAM_OK);
+
+    void *buf;
+    size_t available;
+    utest_assert(uostream_reserve(&stream, 3, &buf, &available) == USTREAM_OK);
+    utest_assert_uint(available, ==, sizeof(data));
+    memcpy(buf, "abc", 3);
+    utest_assert(uostream_commit(&stream, 3) == USTREAM_OK);
+    utest_assert_uint(stream.written_bytes, ==, 3);
+
+    // Failing to reserve space does not alter the state of the stream.
+    utest_assert(uostream_reserve(&stream, 6, &buf, &available) == USTREAM_ERR_BOUNDS);
+    utest_assert(stream.state == USTREAM_OK);
+    utest_assert(uostream_write_literal(&stream, "de", NULL) == USTREAM_OK);
+    utest_assert_buf(data, ==, "abcde", 5);
+    utest_assert(uostream_deinit(&stream) == USTREAM_OK);
+
+    // Formatted strings are written straight into the reserved space.
+    char large[400];
+    memset(large, 'x', sizeof(large) - 1);
+    large[sizeof(large) - 1] = '\0';
+
+    UStrBuf strbuf = ustrbuf();
+    utest_assert(uostream_to_strbuf(&stream, &strbuf) == USTREAM_OK);
+    stream.writef = NULL;
+
+    size_t written;
+    utest_assert(uostream_writef(&stream, &written, "%d-%s", 42, "a") == USTREAM_OK);
+    utest_assert_uint(written, ==, 4);
+    utest_assert(uostream_writef(&stream, &written, "%s", large) == USTREAM_OK);
+    utest_assert_uint(written, ==, sizeof(large) - 1);
+    utest_assert_uint(stream.written_bytes, ==, sizeof(large) + 3);
+    utest_assert_uint(ustrbuf_length(&strbuf), ==, sizeof(large) + 3);
+    utest_assert_buf(ustrbuf_data(&strbuf), ==, "42-a", 4);
+    utest_assert_buf(ustrbuf_data(&strbuf) + 4, ==, large, sizeof(large) - 1);
+
+    // Streams that cannot be formatted into go through a temporary buffer.
+    uvec_remove_all(char, &strbuf);
+    stream.reserve = NULL;
+    stream.written_bytes = 0;
+    utest_assert(uostream_writef(&stream, &written, "%d-%s", 42, "a") == USTREAM_OK);
+    utest_assert(uostream_writef(&stream, &written, "%s", large) == USTREAM_OK);
+    utest_assert_uint(stream.written_bytes, ==, sizeof(large) + 3);
+    utest_assert_uint(ustrbuf_length(&strbuf), ==, sizeof(large) + 3);
+    utest_assert(uostream_deinit(&stream) == USTREAM_OK);
+
+    // Buffered streams reserve space in their buffer, draining it if needed.
+    uvec_remove_all(char, &strbuf);
+    UOStream dst;
+    utest_assert(uostream_to_strbuf(&dst, &strbuf) == USTREAM_OK);
+    utest_assert(uostream_buffered(&stream, &dst, 16) == USTREAM_OK);
+    stream.writef = NULL;
+    utest_assert(uostream_write_literal(&stream, "0123456789", NULL) == USTREAM_OK);
+    utest_assert(uostream_writef(&stream, &written, "%s", "abcdefgh") == USTREAM_OK);
+    utest_assert_uint(ustrbuf_length(&strbuf), ==, 10);
+    utest_assert(uostream_writef(&stream, &written, "%s", large) == USTREAM_OK);
+    utest_assert_uint(written, ==, sizeof(large) - 1);
+    utest_assert(uostream_reserve(&stream, 32, &buf, &available) == USTREAM_ERR_BOUNDS);
+    utest_assert(uostream_deinit(&stream) == USTREAM_OK);
+    utest_assert_uint(ustrbuf_length(&strbuf), ==, sizeof(large) + 17);
+    utest_assert_buf(ustrbuf_data(&strbuf) + 10, ==, "abcdefgh", 8);
+    utest_assert_buf(ustrbuf_data(&strbuf) + 18, ==, large, sizeof(large) - 1);
+
+    // Times and versions are written without format strings.
+    uvec_remove_all(char, &strbuf);
+    utest_assert(uostream_to_strbuf(&stream, &strbuf) == USTREAM_OK);
+    UTime time = utime_from_timestamp(0);
+    utest_assert(uostream_write_time(&stream, &time, &written) == USTREAM_OK);
+    utest_assert_uint(written, ==, 19);
+    UVersion version = { 1, 20, 300 };
+    utest_assert(uostream_write_version(&stream, &version, &written) == USTREAM_OK);
+    utest_assert_uint(written, ==, 8);
+    UString str = ustrbuf_to_ustring(&strbuf);
+    utest_assert_ustring(str, ==, ustring_literal("1970/01/01-00:00:001.20.300"));
+    ustring_deinit(&str);
+
+    return true;
+}
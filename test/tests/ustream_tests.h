@@ -14,13 +14,27 @@
 
 bool uistream_path_test(void);
 bool uistream_buf_test(void);
+bool uistream_mapped_test(void);
+bool uistream_buffered_test(void);
+bool uistream_peek_test(void);
+bool uistream_read_line_test(void);
 bool uostream_null_test(void);
 bool uostream_path_test(void);
 bool uostream_buf_test(void);
 bool uostream_multi_test(void);
+bool uostream_buffered_test(void);
+bool uostream_writev_test(void);
+bool uostream_async_test(void);
+bool ustream_checksum_test(void);
+bool ustream_compress_test(void);
+bool ustream_stats_test(void);
+bool uostream_reserve_test(void);
 
 #define USTREAM_TESTS                                                                              \
-    uistream_path_test, uistream_buf_test, uostream_null_test, uostream_path_test,                 \
-        uostream_buf_test, uostream_multi_test
+    uistream_path_test, uistream_buf_test, uistream_mapped_test, uistream_buffered_test,           \
+        uistream_peek_test, uistream_read_line_test, uostream_null_test, uostream_path_test,       \
+        uostream_buf_test, uostream_multi_test, uostream_buffered_test,                            \
+        uostream_writev_test, uostream_async_test, ustream_checksum_test, ustream_compress_test,   \
+        ustream_stats_test, uostream_reserve_test
 
 #endif // USTREAM_TESTS_H
@@ -8,12 +8,18 @@
  */
 
 #include "ustring_tests.h"
+#include "uhash_builtin.h"
 #include "ustrbuf.h"
+#include "urand.h"
 #include "ustring.h"
+#include "ustrmatch.h"
+#include "ustrpool.h"
 #include "utest.h"
 
 #include <ctype.h>
 
+UHASH_INIT(CiStrHash, UString, ulib_uint, ustring_hash_ci, ustring_equals_ci)
+
 #define MAX_ASCII 127
 
 bool ustring_utils_test(void) {
@@ -116,8 +122,75 @@ bool ustrbuf_test(void) {
     return true;
 }
 
+bool ustrbuf_test_append(void) {
+    UStrBuf buf = ustrbuf();
+    char exp[64];
+
+    ulib_uint const uints[] = { 0, 9, 10, 99, 100, 12345, ULIB_UINT_MAX };
+    for (unsigned i = 0; i < ulib_array_count(uints); ++i) {
+        uvec_remove_all(char, &buf);
+        utest_assert(ustrbuf_append_uint(&buf, uints[i]) == UVEC_OK);
+        snprintf(exp, sizeof(exp), "%" ULIB_UINT_FMT, uints[i]);
+        utest_assert_buf(ustrbuf_data(&buf), ==, exp, strlen(exp));
+        utest_assert_uint(ustrbuf_length(&buf), ==, strlen(exp));
+
+        uvec_remove_all(char, &buf);
+        utest_assert(ustrbuf_append_hex(&buf, uints[i], true) == UVEC_OK);
+        snprintf(exp, sizeof(exp), "%llX", (unsigned long long)uints[i]);
+        utest_assert_buf(ustrbuf_data(&buf), ==, exp, strlen(exp));
+        utest_assert_uint(ustrbuf_length(&buf), ==, strlen(exp));
+    }
+
+    ulib_int const ints[] = { 0, -1, 7, -42, ULIB_INT_MIN, ULIB_INT_MAX };
+    for (unsigned i = 0; i < ulib_array_count(ints); ++i) {
+        uvec_remove_all(char, &buf);
+        utest_assert(ustrbuf_append_int(&buf, ints[i]) == UVEC_OK);
+        snprintf(exp, sizeof(exp), "%" ULIB_INT_FMT, ints[i]);
+        utest_assert_buf(ustrbuf_data(&buf), ==, exp, strlen(exp));
+        utest_assert_uint(ustrbuf_length(&buf), ==, strlen(exp));
+    }
+
+    ulib_float const floats[] = { 0, 0.5, -1.25, (ulib_float)0.1, (ulib_float)1e-7,
+                                  ULIB_FLOAT_MAX, ULIB_FLOAT_MIN, ULIB_FLOAT_EPSILON };
+    for (unsigned i = 0; i < ulib_array_count(floats); ++i) {
+        uvec_remove_all(char, &buf);
+        utest_assert(ustrbuf_append_float(&buf, floats[i]) == UVEC_OK);
+        utest_assert(ustrbuf_append_literal(&buf, "\0") == UVEC_OK);
+        utest_assert(ulib_str_to_float(ustrbuf_data(&buf), NULL) == floats[i]);
+    }
+
+    uvec_remove_all(char, &buf);
+    utest_assert(ustrbuf_append_float(&buf, (ulib_float)0.1) == UVEC_OK);
+    utest_assert_buf(ustrbuf_data(&buf), ==, "0.1", 3);
+    utest_assert_uint(ustrbuf_length(&buf), ==, 3);
+
+    uvec_remove_all(char, &buf);
+    UString str = ustring_literal("a \"quoted\"\\path\n\x01");
+    utest_assert(ustrbuf_append_escaped(&buf, str) == UVEC_OK);
+    char const escaped[] = "a \\\"quoted\\\"\\\\path\\n\\u0001";
+    utest_assert_uint(ustrbuf_length(&buf), ==, sizeof(escaped) - 1);
+    utest_assert_buf(ustrbuf_data(&buf), ==, escaped, sizeof(escaped) - 1);
+
+    // Formatted output that fits the spare capacity, and output that does not.
+    uvec_remove_all(char, &buf);
+    utest_assert(uvec_reserve(char, &buf, 64) == UVEC_OK);
+    utest_assert(ustrbuf_append_format(&buf, "%d-%s", 12, "ab") == UVEC_OK);
+    utest_assert(ustrbuf_append_format(&buf, "%0100d", 0) == UVEC_OK);
+    utest_assert_uint(ustrbuf_length(&buf), ==, 105);
+    utest_assert_buf(ustrbuf_data(&buf), ==, "12-ab000", 8);
+
+    ustrbuf_deinit(&buf);
+    return true;
+}
+
 bool ustring_test_base(void) {
+#if defined(ULIB_STRING_SMALL_SIZE)
+    utest_assert_uint(P_USTRING_SMALL_SIZE, >=, ULIB_STRING_SMALL_SIZE);
+    utest_assert_uint(sizeof(UString), ==, P_USTRING_SMALL_SIZE + sizeof(ulib_uint));
+    utest_assert_uint(sizeof(UString) % sizeof(char *), ==, 0);
+#else
     utest_assert_uint(sizeof(UString), ==, 2 * sizeof(char *));
+#endif
     utest_assert_uint(offsetof(UString, _s._data), ==, sizeof(ulib_uint));
     utest_assert(ustring_is_empty(ustring_empty));
     utest_assert(ustring_data(ustring_empty)[0] == '\0');
@@ -164,6 +237,23 @@ bool ustring_test_base(void) {
     utest_assert_ustring(a, ==, ustring_literal("123 4 567"));
     ustring_deinit(&a);
 
+    a = ustring_join_affixed(strings, ulib_array_count(strings), ustring_literal(", "),
+                             ustring_literal("a reasonably long prefix ["), ustring_literal("]"));
+    utest_assert_ustring(a, ==, ustring_literal("a reasonably long prefix [123, 4, 567]"));
+    ustring_deinit(&a);
+
+    a = ustring_join_affixed(strings, 0, ustring_literal(", "), ustring_literal("["),
+                             ustring_literal("]"));
+    utest_assert_ustring(a, ==, ustring_literal("[]"));
+    ustring_deinit(&a);
+
+    UVec(UString) vec = uvec(UString);
+    utest_assert(uvec_append_array(UString, &vec, strings, ulib_array_count(strings)) == UVEC_OK);
+    a = uvec_join_ustring(&vec, ustring_literal("/"), ustring_literal("/"), ustring_empty);
+    utest_assert_ustring(a, ==, ustring_literal("/123/4/567"));
+    ustring_deinit(&a);
+    uvec_deinit(UString, &vec);
+
     a = ustring_repeating(ustring_literal("123"), 4);
     utest_assert_ustring(a, ==, ustring_literal("123123123123"));
     ustring_deinit(&a);
@@ -224,3 +314,546 @@ bool ustring_test_convert(void) {
 
     return true;
 }
+
+bool ustring_test_parse(void) {
+    ulib_int i_out;
+    ulib_uint u_out;
+    ulib_float f_out;
+    char buf[64];
+
+    utest_assert(ustring_to_int(ustring_empty, &i_out, 10) == ULIB_ERR);
+    utest_assert(ustring_to_int(ustring_literal("-"), &i_out, 10) == ULIB_ERR);
+    utest_assert(ustring_to_uint(ustring_literal("-1"), &u_out, 10) == ULIB_ERR);
+    utest_assert(ustring_to_float(ustring_literal("."), &f_out) == ULIB_ERR);
+    utest_assert(ustring_to_float(ustring_literal("1e"), &f_out) == ULIB_ERR);
+
+    // Unlike strtol and strtod, leading whitespace and hexadecimal floats are rejected.
+    utest_assert(ustring_to_int(ustring_literal(" 1"), &i_out, 10) == ULIB_ERR);
+    utest_assert(ustring_to_uint(ustring_literal("\t1"), &u_out, 10) == ULIB_ERR);
+    utest_assert(ustring_to_float(ustring_literal(" 1.5"), &f_out) == ULIB_ERR);
+    utest_assert(ustring_to_float(ustring_literal("0x1p3"), &f_out) == ULIB_ERR);
+
+    snprintf(buf, sizeof(buf), "%" ULIB_INT_FMT, ULIB_INT_MIN);
+    utest_assert(ustring_to_int(ustring_wrap_buf(buf), &i_out, 10) == ULIB_OK);
+    utest_assert_int(i_out, ==, ULIB_INT_MIN);
+    snprintf(buf, sizeof(buf), "%" ULIB_UINT_FMT, ULIB_UINT_MAX);
+    utest_assert(ustring_to_uint(ustring_wrap_buf(buf), &u_out, 10) == ULIB_OK);
+    utest_assert_uint(u_out, ==, ULIB_UINT_MAX);
+    utest_assert(ustring_to_int(ustring_wrap_buf(buf), &i_out, 10) == ULIB_ERR);
+    utest_assert(ustring_to_uint(ustring_literal("000000000000000000000000042"), &u_out, 10) ==
+                 ULIB_OK);
+    utest_assert_uint(u_out, ==, 42);
+    utest_assert(ustring_to_uint(ustring_literal("99999999999999999999999"), &u_out, 10) ==
+                 ULIB_ERR);
+
+    // Bounded parsing must not read past the specified length.
+    utest_assert_uint(ulib_str_parse_uint("12345678901", 3, &u_out), ==, 3);
+    utest_assert_uint(u_out, ==, 123);
+    utest_assert_uint(ulib_str_parse_float("-2.5e1x", 7, &f_out), ==, 6);
+    utest_assert_float(f_out, ==, -25.0);
+    utest_assert_uint(ulib_str_parse_float("1.5e+", 5, &f_out), ==, 3);
+    utest_assert_uint(ulib_str_parse_float("inf", 3, &f_out), ==, 3);
+    utest_assert(isinf(f_out));
+
+    // Views, such as split tokens, are not read past their length.
+    char const hex[] = "000000000000000000000000001f2345";
+    UString const view = ustring_wrap(hex, sizeof(hex) - 5);
+    utest_assert(ustring_to_int(view, &i_out, 16) == ULIB_OK);
+    utest_assert_int(i_out, ==, 0x1f);
+    utest_assert(ustring_to_uint(view, &u_out, 16) == ULIB_OK);
+    utest_assert_uint(u_out, ==, 0x1f);
+
+    for (unsigned iter = 0; iter < 1000; ++iter) {
+        ulib_int const iv = urand();
+        snprintf(buf, sizeof(buf), "%" ULIB_INT_FMT, iv);
+        utest_assert(ustring_to_int(ustring_wrap_buf(buf), &i_out, 10) == ULIB_OK);
+        utest_assert_int(i_out, ==, iv);
+
+        ulib_float fv = (ulib_float)urand() / (ulib_float)(1 + (ulib_uint)urand() % 1000);
+        fv *= (ulib_float)(iter % 2 ? 1e-3 : 1e7);
+        snprintf(buf, sizeof(buf), iter % 3 ? "%.17g" : "%.6f", (double)fv);
+        utest_assert(ustring_to_float(ustring_wrap_buf(buf), &f_out) == ULIB_OK);
+        utest_assert(f_out == ulib_str_to_float(buf, NULL));
+    }
+
+    UVec(ulib_int) ints = uvec(ulib_int);
+    utest_assert(uvec_append_parsed(ulib_int, &ints, ustring_literal(" 1, -2 ,3,\n"), ',') ==
+                 ULIB_OK);
+    utest_assert_uint(uvec_count(ulib_int, &ints), ==, 3);
+    utest_assert_int(uvec_get(ulib_int, &ints, 1), ==, -2);
+    utest_assert(uvec_append_parsed(ulib_int, &ints, ustring_literal("4,,5"), ',') == ULIB_ERR);
+    utest_assert(uvec_append_parsed(ulib_int, &ints, ustring_literal("4;5"), ',') == ULIB_ERR);
+    utest_assert_uint(uvec_count(ulib_int, &ints), ==, 3);
+    uvec_deinit(ulib_int, &ints);
+
+    UVec(ulib_float) floats = uvec(ulib_float);
+    utest_assert(uvec_append_parsed(ulib_float, &floats, ustring_literal("0.5\n-1e2\n3\n"),
+                                    '\n') == ULIB_OK);
+    utest_assert_uint(uvec_count(ulib_float, &floats), ==, 3);
+    utest_assert_float(uvec_get(ulib_float, &floats, 1), ==, -100.0);
+    uvec_deinit(ulib_float, &floats);
+
+    return true;
+}
+
+static ulib_uint ustring_test_naive_find(char const *str, ulib_uint len, char const *n,
+                                         ulib_uint n_len, bool last) {
+    ulib_uint found = len;
+    for (ulib_uint i = 0; n_len <= len && i <= len - n_len; ++i) {
+        if (memcmp(str + i, n, n_len) == 0) {
+            found = i;
+            if (!last) break;
+        }
+    }
+    return found;
+}
+
+bool ustring_test_find(void) {
+    UString a = ustring_literal("needle");
+    utest_assert_uint(ustring_find(a, ustring_literal("needle")), ==, 0);
+    utest_assert_uint(ustring_find_last(a, ustring_literal("needle")), ==, 0);
+    utest_assert_uint(ustring_find(a, ustring_literal("le")), ==, 4);
+    utest_assert_uint(ustring_find_last(a, ustring_literal("ne")), ==, 0);
+    utest_assert_uint(ustring_find(a, ustring_literal("needles")), >=, ustring_length(a));
+    utest_assert_uint(ustring_find(a, ustring_empty), ==, 0);
+    utest_assert_uint(ustring_find_last(a, ustring_empty), ==, ustring_length(a) - 1);
+    utest_assert_uint(ustring_find_last(ustring_empty, ustring_empty), ==, 0);
+
+    char str[300], needle[60];
+
+    for (unsigned iter = 0; iter < 200; ++iter) {
+        ulib_uint const len = (ulib_uint)((ulib_uint)urand() % sizeof(str));
+        ulib_uint const n_len = (ulib_uint)((ulib_uint)urand() % sizeof(needle));
+        char const alphabet = (char)(2 + (ulib_uint)urand() % 3);
+
+        for (ulib_uint i = 0; i < len; ++i) {
+            str[i] = (char)('a' + (ulib_uint)urand() % alphabet);
+        }
+        for (ulib_uint i = 0; i < n_len; ++i) {
+            needle[i] = (char)('a' + (ulib_uint)urand() % alphabet);
+        }
+
+        // Make sure the needle occurs at least once in most haystacks.
+        if (n_len && n_len <= len && iter % 4) {
+            memcpy(str + (ulib_uint)urand() % (len - n_len + 1), needle, n_len);
+        }
+
+        UString s = ustring_wrap(str, len), n = ustring_wrap(needle, n_len);
+        ulib_uint idx = ustring_find(s, n);
+        ulib_uint exp = ustring_test_naive_find(str, len, needle, n_len, false);
+        utest_assert_uint(idx < len ? idx : len, ==, exp);
+
+        if (n_len) {
+            idx = ustring_find_last(s, n);
+            exp = ustring_test_naive_find(str, len, needle, n_len, true);
+            utest_assert_uint(idx < len ? idx : len, ==, exp);
+        }
+
+        if (len) {
+            char const c = str[(ulib_uint)urand() % len];
+            idx = ustring_index_of_last(s, c);
+            exp = ustring_test_naive_find(str, len, &c, 1, true);
+            utest_assert_uint(idx, ==, exp);
+        }
+
+        utest_assert_uint(ustring_index_of_last(s, 'z'), >=, len);
+    }
+
+    return true;
+}
+
+bool ustring_test_case(void) {
+    char const mixed[] = "Content-Type: Text/HTML; Charset=UTF-8 [\x80\xff@`{~]";
+    char upper[sizeof(mixed)], lower[sizeof(mixed)];
+
+    for (size_t i = 0; i < sizeof(mixed); ++i) {
+        upper[i] = (char)toupper((unsigned char)mixed[i]);
+        lower[i] = (char)tolower((unsigned char)mixed[i]);
+    }
+
+    UString str = ustring_literal(mixed);
+    UString a = ustring_to_upper(str);
+    utest_assert_buf(ustring_data(a), ==, upper, sizeof(mixed) - 1);
+    UString b = ustring_to_lower(str);
+    utest_assert_buf(ustring_data(b), ==, lower, sizeof(mixed) - 1);
+
+    utest_assert(ustring_equals_ci(a, b));
+    utest_assert(ustring_equals_ci(str, a));
+    utest_assert_uint(ustring_hash_ci(a), ==, ustring_hash_ci(b));
+    utest_assert_uint(ustring_hash_ci(b), ==, ustring_hash(b));
+    utest_assert_false(ustring_equals_ci(str, ustring_literal("Content-Type")));
+    utest_assert_false(ustring_equals_ci(ustring_literal("@"), ustring_literal("`")));
+
+    UString long_str = ustring_repeating(str, 10);
+    UString long_upper = ustring_to_upper(long_str);
+    utest_assert(ustring_equals_ci(long_str, long_upper));
+    utest_assert_uint(ustring_hash_ci(long_str), ==, ustring_hash_ci(long_upper));
+
+    UHash(CiStrHash) map = uhmap(CiStrHash);
+    utest_assert(uhmap_set(CiStrHash, &map, ustring_literal("Content-Length"), 1, NULL) ==
+                 UHASH_INSERTED);
+    utest_assert(uhmap_set(CiStrHash, &map, long_str, 2, NULL) == UHASH_INSERTED);
+    utest_assert(uhmap_set(CiStrHash, &map, long_upper, 3, NULL) == UHASH_PRESENT);
+    utest_assert_uint(uhmap_get(CiStrHash, &map, ustring_literal("content-length"), 0), ==, 1);
+    utest_assert_uint(uhmap_get(CiStrHash, &map, long_upper, 0), ==, 3);
+    utest_assert_uint(uhash_count(CiStrHash, &map), ==, 2);
+    uhash_deinit(CiStrHash, &map);
+
+    ustring_deinit(&a);
+    ustring_deinit(&b);
+    ustring_deinit(&long_str);
+    ustring_deinit(&long_upper);
+    return true;
+}
+
+bool ustring_test_utf8(void) {
+    typedef struct {
+        char const *str;
+        size_t cps;
+    } Utf8Case;
+
+    Utf8Case const valid[] = {
+        { "", 0 },
+        { "plain ascii text that is longer than a vector", 45 },
+        { "caf\xc3\xa9 cr\xc3\xa8me br\xc3\xbbl\xc3\xa9" "e", 17 },
+        { "\xe2\x82\xac\xf0\x9f\x98\x80\xed\x9f\xbf\xef\xbf\xbf\xf4\x8f\xbf\xbf", 5 },
+        { "0123456789abcdef\xce\xb1\xce\xb2\xce\xb3" " and some more ascii", 39 },
+    };
+
+    for (unsigned i = 0; i < ulib_array_count(valid); ++i) {
+        UString str = ustring_wrap_buf(valid[i].str);
+        utest_assert(ustring_is_valid_utf8(str));
+        utest_assert_uint(ustring_utf8_length(str), ==, valid[i].cps);
+    }
+
+    char const *invalid[] = {
+        "\x80",                                     // Lone continuation byte.
+        "0123456789abcdef0123456789abcdef\xc3",     // Truncated sequence.
+        "\xc0\xaf",                                 // Overlong encoding.
+        "\xe0\x80\xaf",                             // Overlong encoding.
+        "\xed\xa0\x80",                             // Surrogate.
+        "\xf4\x90\x80\x80",                         // Above U+10FFFF.
+        "\xf5\x80\x80\x80",                         // Invalid lead byte.
+        "valid prefix \xe2\x82 truncated in the middle", // Missing continuation byte.
+    };
+
+    for (unsigned i = 0; i < ulib_array_count(invalid); ++i) {
+        utest_assert_false(ustring_is_valid_utf8(ustring_wrap_buf(invalid[i])));
+    }
+
+    return true;
+}
+
+bool ustring_test_shared(void) {
+    char const str[] = "a shared string, long enough not to be stored inline";
+    UString a = ustring_copy_shared(str, sizeof(str) - 1);
+    utest_assert(ustring_is_shared(a));
+    utest_assert_uint(ustring_length(a), ==, sizeof(str) - 1);
+    utest_assert_string(ustring_data(a), ==, str);
+
+    UString b = ustring_dup(a);
+    utest_assert(ustring_is_shared(b));
+    utest_assert_ptr(ustring_data(b), ==, ustring_data(a));
+    utest_assert_ustring(a, ==, b);
+
+    UString small = ustring_copy_shared("small", 5);
+    utest_assert_false(ustring_is_shared(small));
+    utest_assert_ustring(small, ==, ustring_literal("small"));
+
+    UString c = ustring_copy(str, sizeof(str) - 1);
+    utest_assert_false(ustring_is_shared(c));
+    utest_assert(ustring_make_shared(&c) == ULIB_OK);
+    utest_assert(ustring_is_shared(c));
+    utest_assert_ustring(c, ==, a);
+    utest_assert_uint(ustring_hash(c), ==, ustring_hash(a));
+
+    UHash(UString) set = uhset(UString);
+    utest_assert(uhset_insert(UString, &set, ustring_dup(a)) == UHASH_INSERTED);
+    utest_assert(uhash_contains(UString, &set, c));
+
+    // Releasing the duplicates must not affect the other ones.
+    ustring_deinit(&a);
+    utest_assert_string(ustring_data(b), ==, str);
+    char *data = ustring_deinit_return_data(&b);
+    utest_assert_string(data, ==, str);
+    ulib_free(data);
+
+    uhash_foreach (UString, &set, key) {
+        utest_assert_string(ustring_data(*key.key), ==, str);
+        ustring_deinit(key.key);
+    }
+    uhash_deinit(UString, &set);
+
+    ustring_deinit(&c);
+
+#if defined(ULIB_TINY)
+    // Sizes must not overlap the shared flag, which is within reach of tiny strings.
+    size_t const max_len = USTRING_MAX_LENGTH;
+    char *buf = (char *)ulib_malloc(max_len + 2);
+    utest_assert_not_null(buf);
+    memset(buf, 'a', max_len + 1);
+    buf[max_len + 1] = '\0';
+
+    c = ustring_copy(buf, max_len);
+    utest_assert_false(ustring_is_shared(c));
+    utest_assert_uint(ustring_length(c), ==, max_len);
+    ustring_deinit(&c);
+
+    c = ustring_copy_shared(buf, max_len);
+    utest_assert(ustring_is_shared(c));
+    utest_assert_uint(ustring_length(c), ==, max_len);
+    ustring_deinit(&c);
+
+    utest_assert(ustring_is_null(ustring_copy(buf, max_len + 1)));
+    utest_assert(ustring_is_null(ustring_wrap(buf, max_len + 1)));
+    utest_assert(ustring_is_null(ustring_copy_shared(buf, max_len + 1)));
+    utest_assert(ustring(&c, max_len + 1) == NULL);
+    utest_assert(ustring_is_null(c));
+
+    UStrBuf sbuf = ustrbuf();
+    utest_assert(ustrbuf_append_string(&sbuf, buf, max_len + 1) == UVEC_OK);
+    utest_assert(ustring_is_null(ustrbuf_to_ustring(&sbuf)));
+
+    // ustring_assign takes ownership of the buffer even if it is too long.
+    utest_assert(ustring_is_null(ustring_assign(buf, max_len + 1)));
+#endif
+
+    return true;
+}
+
+bool ustring_test_split(void) {
+    UString tokens[8];
+    ulib_uint n = 0;
+
+    ustrsplit_foreach (ustring_split(ustring_literal("GET /index.html  HTTP/1.1"), ' '), tok) {
+        utest_assert_uint(n, <, ulib_array_count(tokens));
+        tokens[n++] = tok;
+    }
+    utest_assert_uint(n, ==, 4);
+    utest_assert_ustring(tokens[0], ==, ustring_literal("GET"));
+    utest_assert_ustring(tokens[1], ==, ustring_literal("/index.html"));
+    utest_assert(ustring_is_empty(tokens[2]));
+    utest_assert_ustring(tokens[3], ==, ustring_literal("HTTP/1.1"));
+
+    UStrSplit split = ustring_split(ustring_empty, ',');
+    UString tok;
+    utest_assert(ustrsplit_next(&split, &tok));
+    utest_assert(ustring_is_empty(tok));
+    utest_assert_false(ustrsplit_next(&split, &tok));
+
+    // Large tokens are views into the source string.
+    char const str[] = "a first reasonably long token;b;;a second reasonably long token;";
+    UString src = ustring_literal(str);
+    UVec(UString) vec = uvec(UString);
+    utest_assert(uvec_append_split(&vec, ustring_split_any(src, ustring_literal(";,"))) == ULIB_OK);
+    utest_assert_uint(uvec_count(UString, &vec), ==, 5);
+    if (!p_ustring_length_is_small(ustring_length(uvec_get(UString, &vec, 0)))) {
+        utest_assert_ptr(ustring_data(uvec_get(UString, &vec, 0)), ==, str);
+    }
+    utest_assert_ustring(uvec_get(UString, &vec, 1), ==, ustring_literal("b"));
+    utest_assert(ustring_is_empty(uvec_get(UString, &vec, 2)));
+    utest_assert(ustring_is_empty(uvec_get(UString, &vec, 4)));
+
+    uvec_remove_all(UString, &vec);
+    UString sep = ustring_literal(" reasonably long ");
+    utest_assert(uvec_append_split(&vec, ustring_split_string(src, sep)) == ULIB_OK);
+    utest_assert_uint(uvec_count(UString, &vec), ==, 3);
+    utest_assert_ustring(uvec_get(UString, &vec, 0), ==, ustring_literal("a first"));
+    utest_assert_ustring(uvec_get(UString, &vec, 1), ==, ustring_literal("token;b;;a second"));
+    utest_assert_ustring(uvec_get(UString, &vec, 2), ==, ustring_literal("token;"));
+
+    uvec_remove_all(UString, &vec);
+    utest_assert(uvec_append_split(&vec, ustring_split_string(src, ustring_empty)) == ULIB_OK);
+    utest_assert_uint(uvec_count(UString, &vec), ==, 1);
+    utest_assert_ustring(uvec_get(UString, &vec, 0), ==, src);
+
+    uvec_deinit(UString, &vec);
+    return true;
+}
+
+bool ustrpool_test(void) {
+    UStringPool pool = ustrpool();
+    ulib_uint id, other;
+    char buf[96];
+
+    utest_assert(ustrpool_intern(&pool, ustring_literal("abc"), &id) == ULIB_OK);
+    utest_assert(ustrpool_intern(&pool, ustring_literal("abc"), &other) == ULIB_OK);
+    utest_assert_uint(id, ==, other);
+    utest_assert_uint(ustrpool_count(&pool), ==, 1);
+    utest_assert(ustring_equals(ustrpool_get(&pool, id), ustring_literal("abc")));
+    utest_assert_uint(ustrpool_find(&pool, ustring_literal("abd")), ==, ustrpool_count(&pool));
+
+    // Enough large strings to span several chunks.
+    ulib_uint const count = 4000;
+
+    char const prefix[] = "a_reasonably_long_identifier_that_does_not_fit_inline_";
+
+    for (ulib_uint i = 0; i < count; ++i) {
+        int len = snprintf(buf, sizeof(buf), "%s%" ULIB_UINT_FMT, prefix, i);
+        utest_assert(ustrpool_intern(&pool, ustring_wrap(buf, (size_t)len), &id) == ULIB_OK);
+        utest_assert_uint(id, ==, i + 1);
+    }
+
+    if (!p_ustring_length_is_small(sizeof(prefix) - 1)) {
+        utest_assert_uint(uvec_count(ulib_ptr, &pool._chunks), >, 1);
+    }
+
+    // Larger than a quarter of a chunk, so it gets a dedicated one.
+    size_t const huge_len = USTRPOOL_CHUNK_SIZE / 4 + 1;
+    char *huge = (char *)ulib_malloc(huge_len + 1);
+    utest_assert_not_null(huge);
+    memset(huge, 'x', huge_len);
+    huge[huge_len] = '\0';
+    UString huge_str = ustring_wrap(huge, huge_len);
+    utest_assert(ustrpool_intern(&pool, huge_str, &id) == ULIB_OK);
+    ulib_free(huge);
+
+    for (ulib_uint i = 0; i < count; ++i) {
+        int len = snprintf(buf, sizeof(buf), "%s%" ULIB_UINT_FMT, prefix, i);
+        UString str = ustring_wrap(buf, (size_t)len);
+        utest_assert_uint(ustrpool_find(&pool, str), ==, i + 1);
+        utest_assert(ustring_equals(ustrpool_get(&pool, i + 1), str));
+        utest_assert(ustrpool_intern(&pool, str, &other) == ULIB_OK);
+        utest_assert_uint(other, ==, i + 1);
+    }
+
+    UString stored = ustrpool_get(&pool, id);
+    utest_assert_uint(ustring_length(stored), ==, huge_len);
+    utest_assert(ustring_data(stored)[huge_len - 1] == 'x');
+    utest_assert(ustring_data(stored)[huge_len] == '\0');
+    utest_assert_uint(ustrpool_count(&pool), ==, count + 2);
+
+    ustrpool_deinit(&pool);
+    return true;
+}
+
+static bool ustrmatch_test_matches(UStrMatcher const *matcher, UVec(UString) const *needles,
+                                   UString text, UVec(UStrMatch) const *matches) {
+    char const *data = ustring_data(text);
+    size_t const len = ustring_length(text);
+    ulib_uint expected = 0;
+
+    uvec_foreach (UString, needles, needle) {
+        size_t const n = ustring_length(*needle.item);
+        if (!n || uvec_index_of(UString, needles, *needle.item) != needle.i) continue;
+        for (size_t i = 0; i + n <= len; ++i) {
+            if (memcmp(data + i, ustring_data(*needle.item), n) == 0) ++expected;
+        }
+    }
+
+    utest_assert_uint(uvec_count(UStrMatch, matches), ==, expected);
+    size_t last_end = 0;
+
+    uvec_foreach (UStrMatch, matches, m) {
+        UString needle = uvec_get(UString, needles, m.item->needle);
+        size_t const end = m.item->index + ustring_length(needle);
+        utest_assert(end <= len);
+        utest_assert(memcmp(data + m.item->index, ustring_data(needle), end - m.item->index) == 0);
+        utest_assert(end >= last_end);
+        last_end = end;
+    }
+
+    UStrMatch first;
+    utest_assert(ustrmatcher_find(matcher, text, &first) == (expected > 0));
+
+    if (expected) {
+        UStrMatch m = uvec_first(UStrMatch, matches);
+        utest_assert_uint(first.needle, ==, m.needle);
+        utest_assert_uint(first.index, ==, m.index);
+    }
+
+    return true;
+}
+
+bool ustrmatch_test(void) {
+    UString const words[] = {
+        ustring_literal("he"),   ustring_literal("she"), ustring_literal("his"),
+        ustring_literal("hers"), ustring_empty,          ustring_literal("she"),
+    };
+    UVec(UString) needles = uvec(UString);
+    utest_assert(uvec_append_array(UString, &needles, words, ulib_array_count(words)) == UVEC_OK);
+
+    UStrMatcher matcher;
+    utest_assert(ustrmatcher_init(&matcher, &needles) == ULIB_OK);
+    utest_assert_uint(ustrmatcher_count(&matcher), ==, ulib_array_count(words));
+
+    UVec(UStrMatch) matches = uvec(UStrMatch);
+    UString text = ustring_literal("ushers");
+    utest_assert(ustrmatcher_find_all(&matcher, text, &matches) == ULIB_OK);
+    utest_assert_uint(uvec_count(UStrMatch, &matches), ==, 3);
+    utest_assert_uint(uvec_get(UStrMatch, &matches, 0).needle, ==, 1);
+    utest_assert_uint(uvec_get(UStrMatch, &matches, 0).index, ==, 1);
+    utest_assert_uint(uvec_get(UStrMatch, &matches, 1).needle, ==, 0);
+    utest_assert_uint(uvec_get(UStrMatch, &matches, 1).index, ==, 2);
+    utest_assert_uint(uvec_get(UStrMatch, &matches, 2).needle, ==, 3);
+    utest_assert_uint(uvec_get(UStrMatch, &matches, 2).index, ==, 2);
+
+    UStrMatch match;
+    utest_assert(ustrmatcher_find(&matcher, text, &match));
+    utest_assert_uint(match.needle, ==, 1);
+    utest_assert_false(ustrmatcher_find(&matcher, ustring_literal("nothing to see"), &match));
+    utest_assert_false(ustrmatcher_find(&matcher, ustring_empty, &match));
+
+    // Long inputs exercise the prefilter, and many first bytes disable it.
+    UString const more[] = {
+        ustring_literal("error"),   ustring_literal("warning"), ustring_literal("timeout"),
+        ustring_literal("refused"), ustring_literal("denied"),  ustring_literal("fatal"),
+        ustring_literal("panic"),   ustring_literal("abort"),   ustring_literal("oops"),
+        ustring_literal("a"),       ustring_literal("rr"),
+    };
+    UString lines = ustring_literal("connection refused; retrying after timeout\n"
+                                    "fatal error: the shell has aborted, hers or his?\n"
+                                    "permission denied, oops\n");
+
+    for (unsigned i = 0; i <= ulib_array_count(more); ++i) {
+        UVec(UString) extended = uvec(UString);
+        utest_assert(uvec_append(UString, &extended, &needles) == UVEC_OK);
+        utest_assert(uvec_append_array(UString, &extended, more, i) == UVEC_OK);
+
+        UStrMatcher m;
+        utest_assert(ustrmatcher_init(&m, &extended) == ULIB_OK);
+        uvec_remove_all(UStrMatch, &matches);
+        utest_assert(ustrmatcher_find_all(&m, lines, &matches) == ULIB_OK);
+        utest_assert(ustrmatch_test_matches(&m, &extended, lines, &matches));
+        ustrmatcher_deinit(&m);
+        uvec_deinit(UString, &extended);
+    }
+
+    // Streams are scanned in chunks, with occurrences spanning chunk boundaries.
+    size_t const len = 10000;
+    char *buf = (char *)ulib_malloc(len + 1);
+    utest_assert_not_null(buf);
+    for (size_t i = 0; i < len; ++i) buf[i] = "xyzhers"[(i * 7 + i / 5) % 7];
+    buf[len] = '\0';
+
+    UString big = ustring_wrap(buf, len);
+    uvec_remove_all(UStrMatch, &matches);
+    utest_assert(ustrmatcher_find_all(&matcher, big, &matches) == ULIB_OK);
+    utest_assert_uint(uvec_count(UStrMatch, &matches), >, 0);
+    utest_assert(ustrmatch_test_matches(&matcher, &needles, big, &matches));
+
+    UVec(UStrMatch) stream_matches = uvec(UStrMatch);
+    UIStream stream;
+    utest_assert(uistream_from_buf(&stream, buf, len) == USTREAM_OK);
+    utest_assert(ustrmatcher_find_all_stream(&matcher, &stream, &stream_matches) == USTREAM_OK);
+    utest_assert_uint(uvec_count(UStrMatch, &stream_matches), ==, uvec_count(UStrMatch, &matches));
+    uvec_foreach (UStrMatch, &matches, m) {
+        UStrMatch sm = uvec_get(UStrMatch, &stream_matches, m.i);
+        utest_assert_uint(sm.needle, ==, m.item->needle);
+        utest_assert_uint(sm.index, ==, m.item->index);
+    }
+
+    bool found;
+    utest_assert(uistream_reset(&stream) == USTREAM_OK);
+    utest_assert(ustrmatcher_find_stream(&matcher, &stream, &match, &found) == USTREAM_OK);
+    utest_assert(found);
+    utest_assert_uint(match.index, ==, uvec_first(UStrMatch, &matches).index);
+    uistream_deinit(&stream);
+
+    ulib_free(buf);
+    uvec_deinit(UStrMatch, &stream_matches);
+    uvec_deinit(UStrMatch, &matches);
+    ustrmatcher_deinit(&matcher);
+    uvec_deinit(UString, &needles);
+    return true;
+}
@@ -14,9 +14,22 @@
 
 bool ustring_utils_test(void);
 bool ustrbuf_test(void);
+bool ustrbuf_test_append(void);
 bool ustring_test_base(void);
 bool ustring_test_convert(void);
+bool ustring_test_parse(void);
+bool ustring_test_find(void);
+bool ustring_test_split(void);
+bool ustring_test_case(void);
+bool ustring_test_utf8(void);
+bool ustring_test_shared(void);
+bool ustrpool_test(void);
+bool ustrmatch_test(void);
 
-#define USTRING_TESTS ustring_utils_test, ustrbuf_test, ustring_test_base, ustring_test_convert
+#define USTRING_TESTS                                                                              \
+    ustring_utils_test, ustrbuf_test, ustrbuf_test_append, ustring_test_base,                      \
+        ustring_test_convert, ustring_test_parse, ustring_test_find,                               \
+        ustring_test_case, ustring_test_utf8, ustring_test_shared, ustring_test_split,             \
+        ustrpool_test, ustrmatch_test
 
 #endif // USTRING_TESTS_H
@@ -109,3 +109,124 @@ bool utime_test_date(void) {
 
     return true;
 }
+
+bool utime_test_format(void) {
+    struct {
+        UTime time;
+        char const *str;
+    } test_data[] = {
+        { { 1990, 2, 14, 15, 59, 0 }, "1990/02/14-15:59:00" },
+        { { 2023, 12, 31, 23, 59, 59 }, "2023/12/31-23:59:59" },
+        { { 5, 1, 1, 0, 0, 0 }, "5/01/01-00:00:00" },
+        { { -44, 3, 15, 12, 0, 0 }, "-44/03/15-12:00:00" },
+        { { 123456, 7, 8, 9, 10, 11 }, "123456/07/08-09:10:11" },
+    };
+
+    char buf[UTIME_FORMAT_SIZE];
+
+    for (unsigned i = 0; i < ulib_array_count(test_data); ++i) {
+        ulib_uint const len = utime_format(&test_data[i].time, buf);
+        utest_assert_uint(len, ==, strlen(test_data[i].str));
+        utest_assert(memcmp(buf, test_data[i].str, len) == 0);
+    }
+
+    return true;
+}
+
+bool utime_test_parse(void) {
+    UTime time, expected = { 2021, 8, 9, 10, 5, 7 };
+    unsigned nanos;
+
+    char const *str = "2021-08-09T10:05:07";
+    utest_assert_uint(utime_parse(&time, &nanos, str, (ulib_uint)strlen(str)), ==, 19);
+    utest_assert(utime_equals(&time, &expected));
+    utest_assert_uint(nanos, ==, 0);
+
+    str = "2021/08/09 10:05:07.25Z trailing";
+    utest_assert_uint(utime_parse(&time, &nanos, str, (ulib_uint)strlen(str)), ==, 23);
+    utest_assert(utime_equals(&time, &expected));
+    utest_assert_uint(nanos, ==, 250000000);
+
+    str = "2021-08-09 11:35:07,1234567891+01:30";
+    utest_assert_uint(utime_parse(&time, &nanos, str, (ulib_uint)strlen(str)), ==, 36);
+    utest_assert(utime_equals(&time, &expected));
+    utest_assert_uint(nanos, ==, 123456789);
+
+    char const *invalid[] = {
+        "2021-08-09", "2021-13-09 10:05:07", "2021-02-29 10:05:07",
+        "2021-08-09 24:05:07", "2021-08-09 10:60:07", "2021-08-0910:05:07x",
+    };
+
+    for (unsigned i = 0; i < ulib_array_count(invalid); ++i) {
+        utest_assert_uint(utime_parse(&time, NULL, invalid[i], (ulib_uint)strlen(invalid[i])), ==,
+                          0);
+    }
+
+    // Formatted dates are parsed back, whatever their digits.
+    char buf[UTIME_FORMAT_SIZE];
+    for (utime_stamp ts = 0; ts < 400LL * 366 * 86400; ts += 86400 * 7 + 3607) {
+        UTime const date = utime_from_timestamp(ts);
+        ulib_uint const len = utime_format(&date, buf);
+        utest_assert_uint(utime_parse(&time, NULL, buf, len), ==, len);
+        utest_assert(utime_equals(&time, &date));
+    }
+
+    // Parsing falls back to the lenient parser for other formats.
+    UString ustr = ustring_literal("2021-08-09T10:05:07Z");
+    utest_assert(utime_from_string(&time, &ustr));
+    utest_assert(utime_equals(&time, &expected));
+
+    ustr = ustring_literal("2021 8 9 10.5.7");
+    utest_assert(utime_from_string(&time, &ustr));
+    utest_assert(utime_equals(&time, &expected));
+
+    // Leading zeros do not denote octal numbers.
+    ustr = ustring_literal("2021 08 009 010.05.07");
+    utest_assert(utime_from_string(&time, &ustr));
+    utest_assert(utime_equals(&time, &expected));
+
+    return true;
+}
+
+bool utime_test_cache(void) {
+    UTimeCache cache = utime_cache();
+    UTime time = { 2021, 8, 9, 10, 5, 7 };
+    utime_stamp const ts = utime_to_timestamp(&time);
+    ulib_uint len;
+
+    char const *str = utime_cache_format(&cache, ts, UTIME_SECONDS, &len);
+    utest_assert(strcmp(str, "2021/08/09-10:05:07") == 0);
+    utest_assert_uint(len, ==, 19);
+
+    str = utime_cache_format(&cache, (ts + 1) * 1000 + 42, UTIME_MILLISECONDS, &len);
+    utest_assert(strcmp(str, "2021/08/09-10:05:08.042") == 0);
+    utest_assert_uint(len, ==, 23);
+
+    str = utime_cache_format(&cache, (ts + 53) * 1000000 + 123456, UTIME_MICROSECONDS, &len);
+    utest_assert(strcmp(str, "2021/08/09-10:06:00.123456") == 0);
+
+    str = utime_cache_format(&cache, ts * 1000000000LL + 5, UTIME_NANOSECONDS, &len);
+    utest_assert(strcmp(str, "2021/08/09-10:05:07.000000005") == 0);
+    utest_assert_uint(len, ==, 29);
+
+    // Timestamps before 1970.
+    str = utime_cache_format(&cache, -1500, UTIME_MILLISECONDS, NULL);
+    utest_assert(strcmp(str, "1969/12/31-23:59:58.500") == 0);
+
+    // The current time matches the timestamp functions. Whole-second timestamps may come
+    // from a coarser clock, so they are compared with one second of slack.
+    utime_stamp const before = utime_get_timestamp_ms() / 1000;
+    utest_assert_int(utime_get_timestamp() + 1, >=, before);
+    utest_assert_int(utime_get_timestamp_us() / 1000000, >=, before);
+
+    str = utime_cache_now(&cache, UTIME_MILLISECONDS, &len);
+    utest_assert_uint(len, ==, 23);
+
+    UTime now;
+    UString ustr = ustring_wrap(str, len);
+    utest_assert(utime_from_string(&now, &ustr));
+    utest_assert_int(utime_to_timestamp(&now), >=, before);
+    utest_assert_int(utime_to_timestamp(&now), <=, utime_get_timestamp_ms() / 1000);
+
+    return true;
+}
@@ -14,7 +14,11 @@
 
 bool utime_test_ns(void);
 bool utime_test_date(void);
+bool utime_test_format(void);
+bool utime_test_parse(void);
+bool utime_test_cache(void);
 
-#define UTIME_TESTS utime_test_ns, utime_test_date
+#define UTIME_TESTS                                                                                \
+    utime_test_ns, utime_test_date, utime_test_format, utime_test_parse, utime_test_cache
 
 #endif // UTIME_TESTS_H
@@ -0,0 +1,189 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#include "utrace_tests.h"
+#include "uhash_builtin.h"
+#include "ustrbuf.h"
+#include "utest.h"
+#include "uthread.h"
+#include "utrace.h"
+
+#define TRACE_THREADS 4
+#define TRACE_SPANS 100
+
+bool utrace_test_ticks(void) {
+    utrace_calibrate();
+    utest_assert(utrace_ns_per_tick() > 0);
+
+    // Converted ticks roughly match the elapsed time.
+    utime_ns const start_ns = utime_get_ns();
+    utrace_tick const start = utrace_ticks();
+    while (utime_get_ns() - start_ns < 2000000) continue;
+    utrace_tick const ticks = utrace_ticks() - start;
+    utime_ns const elapsed = utime_get_ns() - start_ns;
+
+    utime_ns const ns = utrace_ticks_to_ns(ticks);
+    utest_assert_uint(ns, >=, elapsed / 2);
+    utest_assert_uint(ns, <=, elapsed * 2);
+    return true;
+}
+
+bool utrace_test_span(void) {
+    utrace_reset();
+    utest_assert_uint(utrace_count(), ==, 0);
+
+    UTraceSpan span = utrace_span_begin("span");
+    utrace_span_end(&span);
+    utest_assert_uint(utrace_count(), ==, 1);
+
+    unsigned runs = 0;
+    utrace_scope("scope") {
+        runs++;
+    }
+    utest_assert_uint(runs, ==, 1);
+    utest_assert_uint(utrace_count(), ==, 2);
+
+    utrace_set_enabled(false);
+    utest_assert(!utrace_enabled());
+    utrace_record("disabled", 0, 1);
+    utrace_set_enabled(true);
+    utest_assert(utrace_enabled());
+    utest_assert_uint(utrace_count(), ==, 2);
+
+    // Full buffers retain the most recent events.
+    for (unsigned i = 0; i < UTRACE_BUFFER_SIZE; ++i) utrace_record("ring", i, i + 1);
+    utest_assert_uint(utrace_count(), ==, UTRACE_BUFFER_SIZE);
+
+    utrace_reset();
+    utest_assert_uint(utrace_count(), ==, 0);
+
+    // Threads keep recording into their buffers after a reset.
+    utrace_record("after", 0, 1);
+    utest_assert_uint(utrace_count(), ==, 1);
+
+    utrace_reset();
+    return true;
+}
+
+static void trace_worker(void *ctx) {
+    unsigned *spans = (unsigned *)ctx;
+    for (unsigned i = 0; i < TRACE_SPANS; ++i) {
+        utrace_scope("worker") {
+            (*spans)++;
+        }
+    }
+}
+
+bool utrace_test_threads(void) {
+    utrace_reset();
+    unsigned spans[TRACE_THREADS] = { 0 };
+    uthread_run_parallel(trace_worker, spans, sizeof(*spans), TRACE_THREADS);
+    for (unsigned i = 0; i < TRACE_THREADS; ++i) utest_assert_uint(spans[i], ==, TRACE_SPANS);
+    utest_assert_uint(utrace_count(), ==, TRACE_THREADS * TRACE_SPANS);
+
+#if !defined(ULIB_NO_THREADS)
+    // Each thread records into its own buffer.
+    UStrBuf buf = ustrbuf();
+    UOStream stream;
+    utest_assert(uostream_to_strbuf(&stream, &buf) == USTREAM_OK);
+    utest_assert(utrace_export_chrome(&stream, NULL) == USTREAM_OK);
+    utest_assert(uostream_write_literal(&stream, "\0", NULL) == USTREAM_OK);
+    uostream_deinit(&stream);
+
+    UHash(ulib_uint) tids = uhset(ulib_uint);
+
+    for (char const *tid = ustrbuf_data(&buf); (tid = strstr(tid, "\"tid\":")) != NULL;) {
+        tid += sizeof("\"tid\":") - 1;
+        uhset_insert(ulib_uint, &tids, (ulib_uint)strtoul(tid, NULL, 10));
+    }
+
+    utest_assert_uint(uhash_count(ulib_uint, &tids), ==, TRACE_THREADS);
+    uhash_deinit(ulib_uint, &tids);
+    ustrbuf_deinit(&buf);
+#endif
+
+    utrace_reset();
+    return true;
+}
+
+bool utrace_test_export(void) {
+    utrace_reset();
+    utrace_record("first", 1000, 3000);
+    utrace_record("quote\"d", 2000, 2500);
+
+    UStrBuf buf = ustrbuf();
+    UOStream stream;
+    utest_assert(uostream_to_strbuf(&stream, &buf) == USTREAM_OK);
+
+    size_t written;
+    utest_assert(utrace_export_chrome(&stream, &written) == USTREAM_OK);
+    utest_assert_uint(written, ==, uvec_count(char, &buf));
+    utest_assert(uostream_write_literal(&stream, "\0", NULL) == USTREAM_OK);
+    uostream_deinit(&stream);
+
+    char const *json = ustrbuf_data(&buf);
+    char const prefix[] = "{\"traceEvents\":[\n{\"name\":\"first\",\"ph\":\"X\",";
+    utest_assert(strncmp(json, prefix, sizeof(prefix) - 1) == 0);
+    utest_assert_not_null(strstr(json, ",\"ts\":0.000,"));
+    utest_assert_not_null(strstr(json, "},\n{\"name\":\"quote\\u0022d\","));
+    utest_assert_not_null(strstr(json, "\n],\"displayTimeUnit\":\"ns\"}\n"));
+
+    ustrbuf_deinit(&buf);
+    utrace_reset();
+
+    // Empty traces are valid.
+    buf = ustrbuf();
+    utest_assert(uostream_to_strbuf(&stream, &buf) == USTREAM_OK);
+    utest_assert(utrace_export_chrome(&stream, NULL) == USTREAM_OK);
+    utest_assert(uostream_write_literal(&stream, "\0", NULL) == USTREAM_OK);
+    uostream_deinit(&stream);
+    char const empty[] = "{\"traceEvents\":[\n],\"displayTimeUnit\":\"ns\"}\n";
+    utest_assert(strcmp(ustrbuf_data(&buf), empty) == 0);
+    ustrbuf_deinit(&buf);
+    return true;
+}
+
+#if !defined(ULIB_NO_THREADS)
+static void trace_recorder(void *ctx) {
+    (void)ctx;
+    for (utrace_tick i = 0; i < 16 * UTRACE_BUFFER_SIZE; ++i) utrace_record("busy", i, i + 1);
+}
+#endif
+
+bool utrace_test_concurrent_export(void) {
+#if !defined(ULIB_NO_THREADS)
+    utrace_reset();
+    UThread thread;
+    utest_assert(uthread_start(&thread, trace_recorder, NULL) == ULIB_OK);
+
+    // Exporting and resetting terminate even if a thread keeps recording.
+    for (unsigned i = 0; i < 8; ++i) {
+        UStrBuf buf = ustrbuf();
+        UOStream stream;
+        utest_assert(uostream_to_strbuf(&stream, &buf) == USTREAM_OK);
+        ustream_ret const ret = utrace_export_chrome(&stream, NULL);
+        uostream_write_literal(&stream, "\0", NULL);
+        uostream_deinit(&stream);
+
+        ulib_uint events = 0;
+        for (char const *e = ustrbuf_data(&buf); (e = strstr(e, "\"busy\"")) != NULL; ++e) ++events;
+        bool const terminated = strstr(ustrbuf_data(&buf), "\n],\"displayTimeUnit\"") != NULL;
+        ustrbuf_deinit(&buf);
+        utrace_reset();
+
+        utest_assert(ret == USTREAM_OK);
+        utest_assert(terminated);
+        utest_assert_uint(events, <=, UTRACE_BUFFER_SIZE + 1);
+    }
+
+    utest_assert(uthread_join(&thread) == ULIB_OK);
+    utrace_reset();
+#endif
+    return true;
+}
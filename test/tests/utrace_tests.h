@@ -0,0 +1,25 @@
+/**
+ * @author Ivano Bilenchi
+ *
+ * @copyright Copyright (c) 2023 Ivano Bilenchi <https://ivanobilenchi.com>
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * @file
+ */
+
+#ifndef UTRACE_TESTS_H
+#define UTRACE_TESTS_H
+
+#include "ustd.h"
+
+bool utrace_test_ticks(void);
+bool utrace_test_span(void);
+bool utrace_test_threads(void);
+bool utrace_test_export(void);
+bool utrace_test_concurrent_export(void);
+
+#define UTRACE_TESTS                                                                               \
+    utrace_test_ticks, utrace_test_span, utrace_test_threads, utrace_test_export,                  \
+        utrace_test_concurrent_export
+
+#endif // UTRACE_TESTS_H
@@ -8,6 +8,8 @@
  */
 
 #include "umacros.h"
+#include "urand.h"
+#include "userial.h"
 #include "utest.h"
 #include "uvec_builtin.h"
 
@@ -29,6 +31,46 @@
         uvec_append_array(T, vec, p_items, ulib_array_count(p_items));                             \
     } while (0)
 
+typedef int32_t AllocInt;
+UVEC_INIT_ALLOC(AllocInt, uvec_growth_1_5)
+
+typedef int32_t SboInt;
+UVEC_INIT_SBO(SboInt, 16)
+UVEC_INIT_SERIAL(SboInt)
+UVEC_INIT_SERIAL(ulib_int)
+UVEC_INIT_SERIAL(ulib_byte)
+
+#define UVEC_SERIAL_FILE "uvec_serial.bin"
+
+typedef struct TestAllocStats {
+    size_t allocs, live_bytes;
+} TestAllocStats;
+
+static void *test_alloc(void *ctx, void *ptr, size_t old_size, size_t size) {
+    TestAllocStats *stats = (TestAllocStats *)ctx;
+    void *ret = ulib_realloc(ptr, size);
+    if (!ret) return NULL;
+    stats->allocs++;
+    stats->live_bytes += size - old_size;
+    return ret;
+}
+
+static void test_dealloc(void *ctx, void *ptr, size_t size) {
+    ((TestAllocStats *)ctx)->live_bytes -= size;
+    ulib_free(ptr);
+}
+
+static bool test_is_multiple(ulib_int item, void *ctx) {
+    return item % *(ulib_int *)ctx == 0;
+}
+
+static void test_random_set(UVec(ulib_uint) *v, ulib_uint n, ulib_uint max) {
+    uvec_remove_all(ulib_uint, v);
+    for (ulib_uint i = 0; i < n; ++i) uvec_push(ulib_uint, v, (ulib_uint)urand() % max);
+    uvec_sort(ulib_uint, v);
+    uvec_unique_sorted(ulib_uint, v);
+}
+
 /// @name Tests
 
 #define VTYPE ulib_int
@@ -103,6 +145,12 @@ bool uvec_test_capacity(void) {
     utest_assert(ret == UVEC_OK);
     utest_assert_uint(uvec_size(VTYPE, &v), >=, uvec_count(VTYPE, &v));
 
+    ret = uvec_expand(VTYPE, &v, ULIB_UINT_MAX);
+    utest_assert(ret == UVEC_ERR);
+    ret = uvec_append_array(VTYPE, &v, uvec_data(VTYPE, &v), ULIB_UINT_MAX);
+    utest_assert(ret == UVEC_ERR);
+    utest_assert_uint(uvec_count(VTYPE, &v), ==, 3);
+
     ret = uvec_expand(VTYPE, &v, capacity);
     utest_assert(ret == UVEC_OK);
     utest_assert_uint(uvec_size(VTYPE, &v), >=, uvec_count(VTYPE, &v) + capacity);
@@ -239,3 +287,490 @@ bool uvec_test_comparable(void) {
     uvec_deinit(VTYPE, &values);
     return true;
 }
+
+#define uvec_assert_sorted(T, vec)                                                                 \
+    do {                                                                                           \
+        T const *p_data = uvec_data(T, vec);                                                       \
+        for (ulib_uint p_i = 1; p_i < uvec_count(T, vec); ++p_i) {                                 \
+            utest_assert(p_data[p_i - 1] <= p_data[p_i]);                                          \
+        }                                                                                          \
+    } while (0)
+
+bool uvec_test_sort(void) {
+    ulib_uint const count = 2000;
+    UVec(VTYPE) v = uvec(VTYPE), r = uvec(VTYPE);
+
+    // Random, sorted, reverse sorted, constant and organ pipe inputs.
+    for (unsigned pattern = 0; pattern < 5; ++pattern) {
+        uvec_remove_all(VTYPE, &v);
+
+        for (ulib_uint i = 0; i < count; ++i) {
+            VTYPE item;
+            switch (pattern) {
+                case 0: item = urand(); break;
+                case 1: item = (VTYPE)i; break;
+                case 2: item = (VTYPE)(count - i); break;
+                case 3: item = 42; break;
+                default: item = (VTYPE)(i < count / 2 ? i : count - i); break;
+            }
+            utest_assert(uvec_push(VTYPE, &v, item) == UVEC_OK);
+        }
+
+        utest_assert(uvec_copy(VTYPE, &v, &r) == UVEC_OK);
+        uvec_sort(VTYPE, &v);
+        uvec_assert_sorted(VTYPE, &v);
+
+        uvec_radix_sort(VTYPE, &r);
+        utest_assert(uvec_equals(VTYPE, &v, &r));
+    }
+
+    UVec(ulib_uint) uv = uvec(ulib_uint);
+    UVec(ulib_byte) bv = uvec(ulib_byte);
+
+    for (ulib_uint i = 0; i < count; ++i) {
+        utest_assert(uvec_push(ulib_uint, &uv, (ulib_uint)urand()) == UVEC_OK);
+        utest_assert(uvec_push(ulib_byte, &bv, (ulib_byte)urand()) == UVEC_OK);
+    }
+
+    uvec_radix_sort(ulib_uint, &uv);
+    uvec_assert_sorted(ulib_uint, &uv);
+    uvec_radix_sort(ulib_byte, &bv);
+    uvec_assert_sorted(ulib_byte, &bv);
+    utest_assert_uint(uvec_count(ulib_byte, &bv), ==, count);
+
+    uvec_deinit(ulib_byte, &bv);
+    uvec_deinit(ulib_uint, &uv);
+    uvec_deinit(VTYPE, &r);
+    uvec_deinit(VTYPE, &v);
+    return true;
+}
+
+static void uvec_test_increment(VTYPE *items, ulib_uint n, ulib_unused void *ctx) {
+    for (ulib_uint i = 0; i < n; ++i) items[i]++;
+}
+
+bool uvec_test_parallel(void) {
+    ulib_uint const count = 20000;
+    UVec(VTYPE) v = uvec(VTYPE), r = uvec(VTYPE);
+
+    for (ulib_uint i = 0; i < count; ++i) {
+        utest_assert(uvec_push(VTYPE, &v, urand()) == UVEC_OK);
+    }
+
+    utest_assert(uvec_copy(VTYPE, &v, &r) == UVEC_OK);
+    uvec_sort(VTYPE, &r);
+
+    // An odd number of threads leaves an unpaired run in some merge rounds.
+    uvec_sort_parallel(VTYPE, &v, 7);
+    utest_assert(uvec_equals(VTYPE, &v, &r));
+
+    uvec_foreach_parallel(VTYPE, &v, 4, uvec_test_increment, NULL);
+
+    uvec_foreach (VTYPE, &r, loop) {
+        utest_assert(uvec_get(VTYPE, &v, loop.i) == (VTYPE)(*loop.item + 1));
+    }
+
+    uvec_deinit(VTYPE, &r);
+    uvec_deinit(VTYPE, &v);
+    return true;
+}
+
+#define uvec_test_search_type(T)                                                                   \
+    do {                                                                                           \
+        UVec(T) p_v = uvec(T);                                                                     \
+                                                                                                   \
+        for (ulib_uint p_n = 0; p_n < 70; ++p_n) {                                                 \
+            uvec_remove_all(T, &p_v);                                                              \
+            for (ulib_uint p_i = 0; p_i < p_n; ++p_i) uvec_push(T, &p_v, (T)(p_i % 23 + 1));       \
+                                                                                                   \
+            T const *p_data = uvec_data(T, &p_v);                                                  \
+            ulib_uint p_first = p_n, p_last = p_n;                                                 \
+            for (ulib_uint p_i = 0; p_i < p_n; ++p_i) {                                            \
+                if (p_data[p_i] != 5) continue;                                                    \
+                if (p_first == p_n) p_first = p_i;                                                 \
+                p_last = p_i;                                                                      \
+            }                                                                                      \
+                                                                                                   \
+            utest_assert_uint(uvec_index_of(T, &p_v, 5), ==, p_first);                             \
+            utest_assert_uint(uvec_index_of_reverse(T, &p_v, 5), ==, p_last);                      \
+            utest_assert_uint(uvec_index_of(T, &p_v, 42), ==, p_n);                                \
+            utest_assert_uint(uvec_index_of_reverse(T, &p_v, 42), ==, p_n);                        \
+            utest_assert_uint(uvec_index_of_min(T, &p_v), ==, 0);                                  \
+            ulib_uint const p_max = p_n > 22 ? 22 : (p_n ? p_n - 1 : 0);                           \
+            utest_assert_uint(uvec_index_of_max(T, &p_v), ==, p_max);                              \
+        }                                                                                          \
+                                                                                                   \
+        uvec_deinit(T, &p_v);                                                                      \
+    } while (0)
+
+bool uvec_test_search(void) {
+    uvec_test_search_type(char);
+    uvec_test_search_type(ulib_byte);
+    uvec_test_search_type(ulib_int);
+    uvec_test_search_type(ulib_uint);
+    uvec_test_search_type(ulib_float);
+
+    // Floating point elements are compared by value, not by representation.
+    UVec(ulib_float) v = uvec(ulib_float);
+    uvec_append_items(ulib_float, &v, 1, 2, 3, 4, 5, 6, 7, 8, 9, -0.0, 3, 2, 1);
+    utest_assert_uint(uvec_index_of(ulib_float, &v, 0.0), ==, 9);
+    utest_assert_uint(uvec_index_of_min(ulib_float, &v), ==, 9);
+    utest_assert_uint(uvec_index_of_max(ulib_float, &v), ==, 8);
+    utest_assert_uint(uvec_index_of_reverse(ulib_float, &v, 1), ==, 12);
+
+    uvec_deinit(ulib_float, &v);
+    return true;
+}
+
+bool uvec_test_allocator(void) {
+    TestAllocStats stats = { 0 };
+    UAllocator const alloc = { &stats, test_alloc, test_dealloc };
+    UVec(AllocInt) v = uvec_with_allocator(AllocInt, &alloc);
+
+    for (AllocInt i = 0; i < 100; ++i) {
+        utest_assert(uvec_push(AllocInt, &v, i) == UVEC_OK);
+    }
+
+    // Storage grows by 1.5x once the inline storage is exhausted.
+    ulib_uint size = p_uvec_inline_size(AllocInt), allocs = 0;
+    for (; size < 100; ++allocs) size = uvec_growth_1_5(size);
+
+    utest_assert_uint(uvec_size(AllocInt, &v), ==, size);
+    utest_assert_uint(stats.allocs, ==, allocs);
+    utest_assert_uint(stats.live_bytes, ==, size * sizeof(AllocInt));
+
+    utest_assert(uvec_shrink(AllocInt, &v) == UVEC_OK);
+    utest_assert_uint(stats.allocs, ==, ++allocs);
+    utest_assert_uint(stats.live_bytes, ==, 100 * sizeof(AllocInt));
+
+    for (AllocInt i = 0; i < 100; ++i) {
+        utest_assert(uvec_get(AllocInt, &v, i) == i);
+    }
+
+    // Both the moved vector and its source keep using the allocator.
+    UVec(AllocInt) moved = uvec_move(AllocInt, &v);
+    utest_assert_uint(uvec_count(AllocInt, &v), ==, 0);
+
+    for (AllocInt i = 0; i < 100; ++i) {
+        utest_assert(uvec_push(AllocInt, &v, i) == UVEC_OK);
+    }
+
+    utest_assert_uint(stats.live_bytes, ==, (100 + size) * sizeof(AllocInt));
+    uvec_deinit(AllocInt, &moved);
+    uvec_deinit(AllocInt, &v);
+    utest_assert_uint(stats.live_bytes, ==, 0);
+    allocs = stats.allocs;
+
+    // Vectors created via uvec(T) use the default allocator.
+    v = uvec(AllocInt);
+    utest_assert(uvec_push(AllocInt, &v, 1) == UVEC_OK);
+    utest_assert(uvec_push(AllocInt, &v, 2) == UVEC_OK);
+    utest_assert(uvec_push(AllocInt, &v, 3) == UVEC_OK);
+    utest_assert_uint(stats.allocs, ==, allocs);
+    uvec_deinit(AllocInt, &v);
+    return true;
+}
+
+bool uvec_test_sbo(void) {
+    UVec(SboInt) v = uvec(SboInt);
+    utest_assert_uint(uvec_size(SboInt, &v), ==, 16);
+
+    // Elements are stored inline until the inline capacity is exhausted.
+    for (SboInt i = 0; i < 16; ++i) {
+        utest_assert(uvec_push(SboInt, &v, i) == UVEC_OK);
+        utest_assert(p_uvec_inline(&v));
+    }
+
+    SboInt *data = uvec_data(SboInt, &v);
+    utest_assert((void *)data >= (void *)&v && (void *)data < (void *)(&v + 1));
+
+    utest_assert(uvec_push(SboInt, &v, 16) == UVEC_OK);
+    utest_assert(p_uvec_allocated(&v));
+    utest_assert_uint(uvec_size(SboInt, &v), >=, 17);
+
+    for (SboInt i = 0; i < 17; ++i) {
+        utest_assert(uvec_get(SboInt, &v, i) == i);
+    }
+
+    // Shrinking moves the elements back to the inline storage.
+    while (uvec_count(SboInt, &v) > 10) uvec_pop(SboInt, &v);
+    utest_assert(uvec_shrink(SboInt, &v) == UVEC_OK);
+    utest_assert(p_uvec_inline(&v));
+    utest_assert_uint(uvec_count(SboInt, &v), ==, 10);
+
+    for (SboInt i = 0; i < 10; ++i) {
+        utest_assert(uvec_get(SboInt, &v, i) == i);
+    }
+
+    UVec(SboInt) copy = uvec(SboInt);
+    utest_assert(uvec_copy(SboInt, &v, &copy) == UVEC_OK);
+    utest_assert(p_uvec_inline(&copy));
+    utest_assert_uint(uvec_count(SboInt, &copy), ==, 10);
+
+    uvec_deinit(SboInt, &copy);
+    uvec_deinit(SboInt, &v);
+    return true;
+}
+
+bool uvec_test_bulk(void) {
+    UVec(VTYPE) v = uvec(VTYPE);
+    uvec_append_items(VTYPE, &v, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10);
+
+    ulib_int div = 3;
+    utest_assert_uint(uvec_remove_if(VTYPE, &v, test_is_multiple, &div), ==, 3);
+    uvec_assert_elements(VTYPE, &v, 1, 2, 4, 5, 7, 8, 10);
+
+    div = 2;
+    utest_assert_uint(uvec_retain(VTYPE, &v, test_is_multiple, &div), ==, 3);
+    uvec_assert_elements(VTYPE, &v, 2, 4, 8, 10);
+
+    div = 1;
+    utest_assert_uint(uvec_retain(VTYPE, &v, test_is_multiple, &div), ==, 0);
+    uvec_assert_elements(VTYPE, &v, 2, 4, 8, 10);
+
+    VTYPE const range[] = { 5, 6, 7 };
+    utest_assert(uvec_insert_range_at(VTYPE, &v, 2, range, 3) == UVEC_OK);
+    uvec_assert_elements(VTYPE, &v, 2, 4, 5, 6, 7, 8, 10);
+    utest_assert(uvec_insert_range_at(VTYPE, &v, 0, range, 1) == UVEC_OK);
+    utest_assert(uvec_insert_range_at(VTYPE, &v, uvec_count(VTYPE, &v), range + 2, 1) == UVEC_OK);
+    uvec_assert_elements(VTYPE, &v, 5, 2, 4, 5, 6, 7, 8, 10, 7);
+    utest_assert(uvec_insert_range_at(VTYPE, &v, 3, range, 0) == UVEC_OK);
+    utest_assert_uint(uvec_count(VTYPE, &v), ==, 9);
+
+    uvec_remove_all(VTYPE, &v);
+    uvec_append_items(VTYPE, &v, 1, 1, 2, 3, 3, 3, 4, 5, 5);
+    utest_assert_uint(uvec_unique_sorted(VTYPE, &v), ==, 4);
+    uvec_assert_elements(VTYPE, &v, 1, 2, 3, 4, 5);
+    utest_assert_uint(uvec_unique_sorted(VTYPE, &v), ==, 0);
+
+    div = 1;
+    utest_assert_uint(uvec_remove_if(VTYPE, &v, test_is_multiple, &div), ==, 5);
+    utest_assert_uint(uvec_count(VTYPE, &v), ==, 0);
+    utest_assert_uint(uvec_unique_sorted(VTYPE, &v), ==, 0);
+
+    uvec_deinit(VTYPE, &v);
+    return true;
+}
+
+bool uvec_test_sorted_index(void) {
+    UVec(VTYPE) v = uvec(VTYPE);
+    UVec(VTYPE) e = uvec(VTYPE);
+    VTYPE items[64];
+    ulib_uint indices[64];
+
+    for (ulib_uint n = 0; n < 200; n += 7) {
+        uvec_remove_all(VTYPE, &v);
+        for (ulib_uint i = 0; i < n; ++i) {
+            utest_assert(uvec_push(VTYPE, &v, (VTYPE)(urand() % (n + 1)) * 2) == UVEC_OK);
+        }
+        uvec_sort(VTYPE, &v);
+        utest_assert(uvec_to_eytzinger(VTYPE, &v, &e) == UVEC_OK);
+        utest_assert_uint(uvec_count(VTYPE, &e), ==, n);
+
+        for (VTYPE item = -1; item < (VTYPE)(2 * n + 3); ++item) {
+            bool const found = uvec_contains_sorted(VTYPE, &v, item);
+            utest_assert(uvec_contains_eytzinger(VTYPE, &e, item) == found);
+            ulib_uint const i = uvec_index_of_eytzinger(VTYPE, &e, item);
+            if (found) utest_assert(uvec_get(VTYPE, &e, i) == item);
+        }
+
+        for (ulib_uint i = 0; i < ulib_array_count(items); ++i) {
+            items[i] = (VTYPE)(urand() % (2 * n + 3)) - 1;
+        }
+        uvec_index_of_sorted_batch(VTYPE, &v, items, ulib_array_count(items), indices);
+
+        for (ulib_uint i = 0; i < ulib_array_count(items); ++i) {
+            ulib_uint const idx = uvec_index_of_sorted(VTYPE, &v, items[i]);
+            if (idx < n) {
+                utest_assert_uint(indices[i], <, n);
+                utest_assert(uvec_get(VTYPE, &v, indices[i]) == items[i]);
+            } else {
+                utest_assert_uint(indices[i], ==, n);
+            }
+        }
+    }
+
+    uvec_deinit(VTYPE, &e);
+    uvec_deinit(VTYPE, &v);
+    return true;
+}
+
+bool uvec_test_set_ops(void) {
+    UVec(ulib_uint) a = uvec(ulib_uint), b = uvec(ulib_uint), r = uvec(ulib_uint);
+    ulib_uint const sizes[][2] = {
+        { 0, 0 }, { 0, 50 }, { 50, 0 }, { 100, 100 }, { 7, 3 }, { 10, 1000 }, { 1000, 10 },
+    };
+
+    for (ulib_uint s = 0; s < ulib_array_count(sizes); ++s) {
+        ulib_uint const max = (sizes[s][0] + sizes[s][1]) * 2 + 1;
+        test_random_set(&a, sizes[s][0], max);
+        test_random_set(&b, sizes[s][1], max);
+
+        utest_assert(uvec_sorted_union(ulib_uint, &a, &b, &r) == UVEC_OK);
+        uvec_assert_sorted(ulib_uint, &r);
+        utest_assert(uvec_sorted_is_subset(ulib_uint, &a, &r));
+        utest_assert(uvec_sorted_is_subset(ulib_uint, &b, &r));
+        uvec_foreach (ulib_uint, &r, item) {
+            utest_assert(uvec_contains_sorted(ulib_uint, &a, *item.item) ||
+                         uvec_contains_sorted(ulib_uint, &b, *item.item));
+        }
+
+        utest_assert(uvec_sorted_intersect(ulib_uint, &a, &b, &r) == UVEC_OK);
+        uvec_assert_sorted(ulib_uint, &r);
+        utest_assert(uvec_sorted_is_subset(ulib_uint, &r, &a));
+        utest_assert(uvec_sorted_is_subset(ulib_uint, &r, &b));
+        uvec_foreach (ulib_uint, &a, item) {
+            bool const in_b = uvec_contains_sorted(ulib_uint, &b, *item.item);
+            utest_assert(uvec_contains_sorted(ulib_uint, &r, *item.item) == in_b);
+        }
+
+        utest_assert(uvec_sorted_difference(ulib_uint, &a, &b, &r) == UVEC_OK);
+        uvec_assert_sorted(ulib_uint, &r);
+        utest_assert(uvec_sorted_is_subset(ulib_uint, &r, &a));
+        uvec_foreach (ulib_uint, &a, item) {
+            bool const in_b = uvec_contains_sorted(ulib_uint, &b, *item.item);
+            utest_assert(uvec_contains_sorted(ulib_uint, &r, *item.item) != in_b);
+        }
+
+        bool subset = true;
+        uvec_foreach (ulib_uint, &a, item) {
+            if (!uvec_contains_sorted(ulib_uint, &b, *item.item)) subset = false;
+        }
+        utest_assert(uvec_sorted_is_subset(ulib_uint, &a, &b) == subset);
+    }
+
+    // Galloping paths.
+    uvec_remove_all(ulib_uint, &a);
+    uvec_remove_all(ulib_uint, &b);
+    for (ulib_uint i = 0; i < 2000; ++i) uvec_push(ulib_uint, &a, i);
+    uvec_append_items(ulib_uint, &b, 0, 500, 1999, 2500);
+
+    utest_assert(uvec_sorted_intersect(ulib_uint, &a, &b, &r) == UVEC_OK);
+    uvec_assert_elements(ulib_uint, &r, 0, 500, 1999);
+    utest_assert(uvec_sorted_union(ulib_uint, &b, &a, &r) == UVEC_OK);
+    utest_assert_uint(uvec_count(ulib_uint, &r), ==, 2001);
+    utest_assert_uint(uvec_last(ulib_uint, &r), ==, 2500);
+    utest_assert(uvec_sorted_difference(ulib_uint, &a, &b, &r) == UVEC_OK);
+    utest_assert_uint(uvec_count(ulib_uint, &r), ==, 1997);
+    utest_assert(uvec_sorted_difference(ulib_uint, &b, &a, &r) == UVEC_OK);
+    uvec_assert_elements(ulib_uint, &r, 2500);
+    utest_assert(!uvec_sorted_is_subset(ulib_uint, &b, &a));
+    uvec_pop(ulib_uint, &b);
+    utest_assert(uvec_sorted_is_subset(ulib_uint, &b, &a));
+
+    uvec_deinit(ulib_uint, &a);
+    uvec_deinit(ulib_uint, &b);
+    uvec_deinit(ulib_uint, &r);
+    return true;
+}
+
+bool uvec_test_heap(void) {
+    UVec(VTYPE) v = uvec(VTYPE);
+    UVec(VTYPE) sorted = uvec(VTYPE);
+
+    for (ulib_uint i = 0; i < 500; ++i) {
+        VTYPE const item = (VTYPE)((ulib_uint)urand() % 1000);
+        utest_assert(uvec_heap_push(VTYPE, &v, item) == UVEC_OK);
+        utest_assert(uvec_push(VTYPE, &sorted, item) == UVEC_OK);
+    }
+    uvec_sort(VTYPE, &sorted);
+
+    for (ulib_uint i = 500; i-- != 0;) {
+        utest_assert_int(uvec_heap_pop(VTYPE, &v), ==, uvec_get(VTYPE, &sorted, i));
+    }
+    utest_assert_uint(uvec_count(VTYPE, &v), ==, 0);
+
+    // Bounded top-k: keep the 10 smallest elements in a max-heap.
+    uvec_append_array(VTYPE, &v, uvec_data(VTYPE, &sorted), 10);
+    uvec_reverse(VTYPE, &v);
+    uvec_heapify(VTYPE, &v);
+    utest_assert_int(uvec_first(VTYPE, &v), ==, uvec_get(VTYPE, &sorted, 9));
+    utest_assert_int(uvec_heap_replace_top(VTYPE, &v, -1), ==, uvec_get(VTYPE, &sorted, 9));
+    utest_assert_int(uvec_first(VTYPE, &v), ==, uvec_get(VTYPE, &sorted, 8));
+
+    uvec_deinit(VTYPE, &v);
+    uvec_deinit(VTYPE, &sorted);
+    return true;
+}
+
+bool uvec_test_select(void) {
+    UVec(VTYPE) v = uvec(VTYPE);
+    UVec(VTYPE) sorted = uvec(VTYPE);
+
+    for (ulib_uint n = 0; n < 300; n += 37) {
+        uvec_remove_all(VTYPE, &sorted);
+        for (ulib_uint i = 0; i < n; ++i) uvec_push(VTYPE, &sorted, (VTYPE)(urand() % 100));
+        uvec_copy(VTYPE, &sorted, &v);
+        uvec_sort(VTYPE, &sorted);
+
+        for (ulib_uint nth = 0; nth < n; nth += 5) {
+            uvec_copy(VTYPE, &sorted, &v);
+            uvec_reverse(VTYPE, &v);
+            uvec_nth_element(VTYPE, &v, nth);
+
+            VTYPE const item = uvec_get(VTYPE, &v, nth);
+            utest_assert_int(item, ==, uvec_get(VTYPE, &sorted, nth));
+            for (ulib_uint i = 0; i < nth; ++i) utest_assert(uvec_get(VTYPE, &v, i) <= item);
+            for (ulib_uint i = nth; i < n; ++i) utest_assert(uvec_get(VTYPE, &v, i) >= item);
+        }
+
+        ulib_uint const k = n / 3;
+        uvec_copy(VTYPE, &sorted, &v);
+        uvec_reverse(VTYPE, &v);
+        uvec_partial_sort(VTYPE, &v, k);
+        for (ulib_uint i = 0; i < k; ++i) {
+            utest_assert_int(uvec_get(VTYPE, &v, i), ==, uvec_get(VTYPE, &sorted, i));
+        }
+    }
+
+    uvec_partial_sort(VTYPE, &v, uvec_count(VTYPE, &v) + 1);
+    utest_assert(uvec_equals(VTYPE, &v, &sorted));
+
+    uvec_deinit(VTYPE, &v);
+    uvec_deinit(VTYPE, &sorted);
+    return true;
+}
+
+bool uvec_test_serial(void) {
+    UVec(ulib_int) v = uvec(ulib_int);
+    for (ulib_int i = 0; i < 1000; ++i) utest_assert(uvec_push(ulib_int, &v, i * 7) == UVEC_OK);
+
+    UVec(SboInt) sbo = uvec(SboInt);
+    uvec_append_items(SboInt, &sbo, 3, 2, 1);
+
+    UOStream out;
+    utest_assert(uostream_to_path(&out, UVEC_SERIAL_FILE) == USTREAM_OK);
+    utest_assert(uvec_write(ulib_int, &v, &out) == USTREAM_OK);
+    utest_assert(uvec_write(SboInt, &sbo, &out) == USTREAM_OK);
+    utest_assert(uostream_deinit(&out) == USTREAM_OK);
+
+    // Vectors are read directly from the mapped file, replacing their contents.
+    UIStream in;
+    utest_assert(uistream_from_path_mapped(&in, UVEC_SERIAL_FILE) == USTREAM_OK);
+    UVec(ulib_int) rv = uvec(ulib_int);
+    utest_assert(uvec_push(ulib_int, &rv, -1) == UVEC_OK);
+    utest_assert(uvec_read(ulib_int, &rv, &in) == USTREAM_OK);
+    utest_assert(uvec_equals(ulib_int, &v, &rv));
+
+    UVec(SboInt) rsbo = uvec(SboInt);
+    utest_assert(uvec_read(SboInt, &rsbo, &in) == USTREAM_OK);
+    uvec_assert_elements(SboInt, &rsbo, 3, 2, 1);
+
+    // Reading past the end of the stream fails.
+    utest_assert(uvec_read(SboInt, &rsbo, &in) == USTREAM_ERR_BOUNDS);
+    utest_assert(uistream_reset(&in) == USTREAM_OK);
+
+    // So does reading a vector of a different type.
+    UVec(ulib_byte) bytes = uvec(ulib_byte);
+    utest_assert(uvec_read(ulib_byte, &bytes, &in) == USTREAM_ERR);
+    utest_assert_uint(uvec_count(ulib_byte, &bytes), ==, 0);
+    uistream_deinit(&in);
+
+    uvec_deinit(ulib_byte, &bytes);
+    uvec_deinit(SboInt, &rsbo);
+    uvec_deinit(ulib_int, &rv);
+    uvec_deinit(SboInt, &sbo);
+    uvec_deinit(ulib_int, &v);
+    remove(UVEC_SERIAL_FILE);
+    return true;
+}
@@ -17,8 +17,22 @@ bool uvec_test_capacity(void);
 bool uvec_test_equality(void);
 bool uvec_test_contains(void);
 bool uvec_test_comparable(void);
+bool uvec_test_sort(void);
+bool uvec_test_parallel(void);
+bool uvec_test_search(void);
+bool uvec_test_allocator(void);
+bool uvec_test_sbo(void);
+bool uvec_test_bulk(void);
+bool uvec_test_sorted_index(void);
+bool uvec_test_set_ops(void);
+bool uvec_test_heap(void);
+bool uvec_test_select(void);
+bool uvec_test_serial(void);
 
 #define UVEC_TESTS                                                                                 \
-    uvec_test_base, uvec_test_capacity, uvec_test_equality, uvec_test_contains, uvec_test_comparable
+    uvec_test_base, uvec_test_capacity, uvec_test_equality, uvec_test_contains,                    \
+        uvec_test_comparable, uvec_test_sort, uvec_test_parallel, uvec_test_search,                \
+        uvec_test_allocator, uvec_test_sbo, uvec_test_bulk, uvec_test_sorted_index,                \
+        uvec_test_set_ops, uvec_test_heap, uvec_test_select, uvec_test_serial
 
 #endif // UVEC_TESTS_H